@@ -51,11 +51,22 @@ enum
 
 static GParamSpec *properties[NUM_PROPERTIES];
 
+/* Number of sessions kept around for resumption, on each side */
+#define SESSION_CACHE_SIZE 256
+
+static const guchar session_id_context[] = "gstdtls";
+
 struct _GstDtlsAgentPrivate
 {
   SSL_CTX *ssl_context;
 
   GstDtlsCertificate *certificate;
+
+  /* client sessions by connection id, the server side ones are cached by
+   * the ssl context itself */
+  GMutex session_lock;
+  GHashTable *sessions;
+  GQueue session_ids;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GstDtlsAgent, gst_dtls_agent, G_TYPE_OBJECT);
@@ -177,6 +188,11 @@ gst_dtls_agent_init (GstDtlsAgent * self)
   GstDtlsAgentPrivate *priv = gst_dtls_agent_get_instance_private (self);
   self->priv = priv;
 
+  g_mutex_init (&priv->session_lock);
+  priv->sessions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) SSL_SESSION_free);
+  g_queue_init (&priv->session_ids);
+
   ERR_clear_error ();
 
 #if OPENSSL_VERSION_NUMBER >= 0x1000200fL
@@ -204,6 +220,14 @@ gst_dtls_agent_init (GstDtlsAgent * self)
 #if (OPENSSL_VERSION_NUMBER >= 0x1000200fL) && (OPENSSL_VERSION_NUMBER < 0x10100000L)
   SSL_CTX_set_ecdh_auto (priv->ssl_context, 1);
 #endif
+
+  /* All connections of the agent share the server side session cache and the
+   * session ticket keys, so a peer reconnecting to any of them can skip the
+   * full handshake */
+  SSL_CTX_set_session_cache_mode (priv->ssl_context, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_sess_set_cache_size (priv->ssl_context, SESSION_CACHE_SIZE);
+  SSL_CTX_set_session_id_context (priv->ssl_context, session_id_context,
+      sizeof (session_id_context) - 1);
 }
 
 static void
@@ -211,6 +235,12 @@ gst_dtls_agent_finalize (GObject * gobject)
 {
   GstDtlsAgentPrivate *priv = GST_DTLS_AGENT (gobject)->priv;
 
+  g_hash_table_unref (priv->sessions);
+  priv->sessions = NULL;
+  g_queue_foreach (&priv->session_ids, (GFunc) g_free, NULL);
+  g_queue_clear (&priv->session_ids);
+  g_mutex_clear (&priv->session_lock);
+
   SSL_CTX_free (priv->ssl_context);
   priv->ssl_context = NULL;
 
@@ -286,3 +316,63 @@ _gst_dtls_agent_peek_context (GstDtlsAgent * self)
   g_return_val_if_fail (GST_IS_DTLS_AGENT (self), NULL);
   return self->priv->ssl_context;
 }
+
+void
+_gst_dtls_agent_store_session (GstDtlsAgent * self, const gchar * id,
+    gpointer session)
+{
+  GstDtlsAgentPrivate *priv;
+
+  g_return_if_fail (GST_IS_DTLS_AGENT (self));
+  g_return_if_fail (id);
+  g_return_if_fail (session);
+
+  priv = self->priv;
+
+  g_mutex_lock (&priv->session_lock);
+
+  if (!g_hash_table_contains (priv->sessions, id)) {
+    g_queue_push_tail (&priv->session_ids, g_strdup (id));
+
+    if (g_queue_get_length (&priv->session_ids) > SESSION_CACHE_SIZE) {
+      gchar *oldest = g_queue_pop_head (&priv->session_ids);
+
+      g_hash_table_remove (priv->sessions, oldest);
+      g_free (oldest);
+    }
+  }
+
+  g_hash_table_insert (priv->sessions, g_strdup (id), session);
+
+  GST_DEBUG_OBJECT (self, "stored session for connection %s, %u cached", id,
+      g_hash_table_size (priv->sessions));
+
+  g_mutex_unlock (&priv->session_lock);
+}
+
+gboolean
+_gst_dtls_agent_resume_session (GstDtlsAgent * self, const gchar * id,
+    gpointer ssl)
+{
+  GstDtlsAgentPrivate *priv;
+  SSL_SESSION *session;
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (GST_IS_DTLS_AGENT (self), FALSE);
+  g_return_val_if_fail (id, FALSE);
+
+  priv = self->priv;
+
+  g_mutex_lock (&priv->session_lock);
+
+  session = g_hash_table_lookup (priv->sessions, id);
+  if (session)
+    ret = SSL_set_session (ssl, session) == 1;
+
+  g_mutex_unlock (&priv->session_lock);
+
+  GST_DEBUG_OBJECT (self, "%s session for connection %s",
+      ret ? "resuming" : "no", id);
+
+  return ret;
+}
@@ -77,6 +77,18 @@ gchar *gst_dtls_agent_get_certificate_pem(GstDtlsAgent *self);
 void _gst_dtls_init_openssl(void);
 const GstDtlsAgentContext _gst_dtls_agent_peek_context(GstDtlsAgent *);
 
+/*
+ * Takes ownership of the client SSL_SESSION of the connection with the given
+ * id, so that the next connection with the same id can resume it.
+ */
+void _gst_dtls_agent_store_session(GstDtlsAgent *, const gchar *id, gpointer session);
+
+/*
+ * Sets the stored session for the given connection id on the SSL object,
+ * returns FALSE if there is none.
+ */
+gboolean _gst_dtls_agent_resume_session(GstDtlsAgent *, const gchar *id, gpointer ssl);
+
 G_END_DECLS
 
 #endif /* gstdtlsagent_h */
@@ -55,6 +55,17 @@ GST_DEBUG_CATEGORY_STATIC (gst_dtls_connection_debug);
 #define SRTP_KEY_LEN 16
 #define SRTP_SALT_LEN 14
 
+#define DTLS_RECORD_HEADER_LEN 13
+#define DTLS_CONTENT_TYPE_CHANGE_CIPHER_SPEC 20
+#define DTLS_CONTENT_TYPE_APPLICATION_DATA 23
+
+/* Work items for the thread pool */
+enum
+{
+  WORK_TIMEOUT = 1,
+  WORK_HANDSHAKE
+};
+
 enum
 {
   SIGNAL_ON_ENCODER_KEY,
@@ -69,6 +80,8 @@ enum
 {
   PROP_0,
   PROP_AGENT,
+  PROP_CONNECTION_ID,
+  PROP_SESSION_RESUMED,
   NUM_PROPERTIES
 };
 
@@ -76,16 +89,20 @@ static GParamSpec *properties[NUM_PROPERTIES];
 
 static int connection_ex_index;
 
-static void handle_timeout (gpointer data, gpointer user_data);
+static void handle_work (gpointer data, gpointer user_data);
 
 struct _GstDtlsConnectionPrivate
 {
   SSL *ssl;
   BIO *bio;
 
+  GstDtlsAgent *agent;
+  gchar *id;
+
   gboolean is_client;
   gboolean is_alive;
   gboolean keys_exported;
+  gboolean session_resumed;
 
   GMutex mutex;
   GCond condition;
@@ -97,6 +114,12 @@ struct _GstDtlsConnectionPrivate
 
   gboolean timeout_pending;
   GThreadPool *thread_pool;
+
+  /* handshake records waiting for the thread pool, protected by work_lock */
+  GMutex work_lock;
+  GCond work_cond;
+  GQueue work_queue;
+  gboolean working;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GstDtlsConnection, gst_dtls_connection, G_TYPE_OBJECT,
@@ -107,10 +130,13 @@ G_DEFINE_TYPE_WITH_CODE (GstDtlsConnection, gst_dtls_connection, G_TYPE_OBJECT,
 static void gst_dtls_connection_finalize (GObject * gobject);
 static void gst_dtls_connection_set_property (GObject *, guint prop_id,
     const GValue *, GParamSpec *);
+static void gst_dtls_connection_get_property (GObject *, guint prop_id,
+    GValue *, GParamSpec *);
 
 static void log_state (GstDtlsConnection *, const gchar * str);
 static void export_srtp_keys (GstDtlsConnection *);
 static void openssl_poll (GstDtlsConnection *);
+static gint process_locked (GstDtlsConnection *, gpointer data, gint len);
 static int openssl_verify_callback (int preverify_ok,
     X509_STORE_CTX * x509_ctx);
 
@@ -127,6 +153,7 @@ gst_dtls_connection_class_init (GstDtlsConnectionClass * klass)
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   gobject_class->set_property = gst_dtls_connection_set_property;
+  gobject_class->get_property = gst_dtls_connection_get_property;
 
   connection_ex_index =
       SSL_get_ex_new_index (0, (gpointer) "gstdtlsagent connection index", NULL,
@@ -156,6 +183,19 @@ gst_dtls_connection_class_init (GstDtlsConnectionClass * klass)
       GST_TYPE_DTLS_AGENT,
       G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
 
+  properties[PROP_CONNECTION_ID] =
+      g_param_spec_string ("connection-id",
+      "Connection id",
+      "Id of the connection, client connections with the same id resume the "
+      "previous session if the server still knows it",
+      NULL, G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_SESSION_RESUMED] =
+      g_param_spec_boolean ("session-resumed",
+      "Session resumed",
+      "Whether the completed handshake resumed a previous session",
+      FALSE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 
   _gst_dtls_init_openssl ();
@@ -178,6 +218,7 @@ gst_dtls_connection_init (GstDtlsConnection * self)
   priv->is_client = FALSE;
   priv->is_alive = TRUE;
   priv->keys_exported = FALSE;
+  priv->session_resumed = FALSE;
 
   priv->bio_buffer = NULL;
   priv->bio_buffer_len = 0;
@@ -186,10 +227,17 @@ gst_dtls_connection_init (GstDtlsConnection * self)
   g_mutex_init (&priv->mutex);
   g_cond_init (&priv->condition);
 
-  /* Thread pool for handling timeouts, we only need one thread for that
-   * really and share threads with all other thread pools around there as
-   * this is not going to happen very often */
-  priv->thread_pool = g_thread_pool_new (handle_timeout, self, 1, FALSE, NULL);
+  g_mutex_init (&priv->work_lock);
+  g_cond_init (&priv->work_cond);
+  g_queue_init (&priv->work_queue);
+  priv->working = FALSE;
+
+  /* Thread pool for handling timeouts and the handshake, so that the
+   * expensive parts of the handshake don't run on the streaming threads. We
+   * only need one thread for that really, which keeps the records in order,
+   * and share threads with all other thread pools around there so that
+   * many connections handshaking at once are spread over the shared threads */
+  priv->thread_pool = g_thread_pool_new (handle_work, self, 1, FALSE, NULL);
   g_assert (priv->thread_pool);
   priv->timeout_pending = FALSE;
 }
@@ -203,9 +251,22 @@ gst_dtls_connection_finalize (GObject * gobject)
   g_thread_pool_free (priv->thread_pool, TRUE, TRUE);
   priv->thread_pool = NULL;
 
+  g_queue_foreach (&priv->work_queue, (GFunc) g_bytes_unref, NULL);
+  g_queue_clear (&priv->work_queue);
+  g_mutex_clear (&priv->work_lock);
+  g_cond_clear (&priv->work_cond);
+
   SSL_free (priv->ssl);
   priv->ssl = NULL;
 
+  if (priv->agent) {
+    g_object_unref (priv->agent);
+    priv->agent = NULL;
+  }
+
+  g_free (priv->id);
+  priv->id = NULL;
+
   if (priv->send_closure) {
     g_closure_unref (priv->send_closure);
     priv->send_closure = NULL;
@@ -267,6 +328,7 @@ gst_dtls_connection_set_property (GObject * object, guint prop_id,
       g_return_if_fail (GST_IS_DTLS_AGENT (agent));
 
       ssl_context = _gst_dtls_agent_peek_context (agent);
+      priv->agent = g_object_ref (agent);
 
       priv->ssl = SSL_new (ssl_context);
       g_return_if_fail (priv->ssl);
@@ -284,11 +346,46 @@ gst_dtls_connection_set_property (GObject * object, guint prop_id,
 
       log_state (self, "connection created");
       break;
+    case PROP_CONNECTION_ID:
+      g_free (priv->id);
+      priv->id = g_value_dup_string (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
+  }
+}
+
+static void
+gst_dtls_connection_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstDtlsConnection *self = GST_DTLS_CONNECTION (object);
+  GstDtlsConnectionPrivate *priv = self->priv;
+
+  switch (prop_id) {
+    case PROP_SESSION_RESUMED:
+      g_mutex_lock (&priv->mutex);
+      g_value_set_boolean (value, priv->session_resumed);
+      g_mutex_unlock (&priv->mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
   }
 }
 
+static void
+queue_handshake_work (GstDtlsConnection * self, GBytes * bytes)
+{
+  GstDtlsConnectionPrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->work_lock);
+  g_queue_push_tail (&priv->work_queue, bytes);
+  g_mutex_unlock (&priv->work_lock);
+
+  g_thread_pool_push (priv->thread_pool, GINT_TO_POINTER (WORK_HANDSHAKE),
+      NULL);
+}
+
 void
 gst_dtls_connection_start (GstDtlsConnection * self, gboolean is_client)
 {
@@ -309,27 +406,69 @@ gst_dtls_connection_start (GstDtlsConnection * self, gboolean is_client)
   priv->bio_buffer_len = 0;
   priv->bio_buffer_offset = 0;
   priv->keys_exported = FALSE;
+  priv->session_resumed = FALSE;
 
   priv->is_client = is_client;
   if (priv->is_client) {
+    if (priv->id)
+      _gst_dtls_agent_resume_session (priv->agent, priv->id, priv->ssl);
     SSL_set_connect_state (priv->ssl);
   } else {
     SSL_set_accept_state (priv->ssl);
   }
   log_state (self, "initial state set");
 
-  openssl_poll (self);
-
-  log_state (self, "first poll done");
-
   GST_TRACE_OBJECT (self, "unlocking @ start");
   g_mutex_unlock (&priv->mutex);
+
+  /* An empty record makes the thread pool send our first flight, if any */
+  queue_handshake_work (self, g_bytes_new (NULL, 0));
 }
 
 static void
-handle_timeout (gpointer data, gpointer user_data)
+handle_handshake (GstDtlsConnection * self)
+{
+  GstDtlsConnectionPrivate *priv = self->priv;
+  GBytes *bytes;
+
+  g_mutex_lock (&priv->work_lock);
+  bytes = g_queue_pop_head (&priv->work_queue);
+  priv->working = TRUE;
+  g_mutex_unlock (&priv->work_lock);
+
+  if (bytes) {
+    gconstpointer data;
+    gsize len;
+
+    data = g_bytes_get_data (bytes, &len);
+
+    g_mutex_lock (&priv->mutex);
+    if (priv->is_alive) {
+      if (len == 0) {
+        openssl_poll (self);
+        log_state (self, "first poll done");
+      } else {
+        /* never contains application data, see needs_inline_processing() */
+        gpointer out = g_memdup (data, len);
+
+        process_locked (self, out, len);
+        g_free (out);
+      }
+    }
+    g_mutex_unlock (&priv->mutex);
+
+    g_bytes_unref (bytes);
+  }
+
+  g_mutex_lock (&priv->work_lock);
+  priv->working = FALSE;
+  g_cond_broadcast (&priv->work_cond);
+  g_mutex_unlock (&priv->work_lock);
+}
+
+static void
+handle_timeout (GstDtlsConnection * self)
 {
-  GstDtlsConnection *self = user_data;
   GstDtlsConnectionPrivate *priv;
   gint ret;
 
@@ -354,6 +493,17 @@ handle_timeout (gpointer data, gpointer user_data)
   g_mutex_unlock (&priv->mutex);
 }
 
+static void
+handle_work (gpointer data, gpointer user_data)
+{
+  GstDtlsConnection *self = user_data;
+
+  if (GPOINTER_TO_INT (data) == WORK_TIMEOUT)
+    handle_timeout (self);
+  else
+    handle_handshake (self);
+}
+
 static gboolean
 schedule_timeout_handling (GstClock * clock, GstClockTime time, GstClockID id,
     gpointer user_data)
@@ -365,8 +515,8 @@ schedule_timeout_handling (GstClock * clock, GstClockTime time, GstClockID id,
     self->priv->timeout_pending = TRUE;
 
     GST_TRACE_OBJECT (self, "Schedule timeout now");
-    g_thread_pool_push (self->priv->thread_pool, GINT_TO_POINTER (0xc0ffee),
-        NULL);
+    g_thread_pool_push (self->priv->thread_pool,
+        GINT_TO_POINTER (WORK_TIMEOUT), NULL);
   }
   g_mutex_unlock (&self->priv->mutex);
 
@@ -413,8 +563,8 @@ gst_dtls_connection_check_timeout_locked (GstDtlsConnection * self)
         self->priv->timeout_pending = TRUE;
         GST_TRACE_OBJECT (self, "Schedule timeout now");
 
-        g_thread_pool_push (self->priv->thread_pool, GINT_TO_POINTER (0xc0ffee),
-            NULL);
+        g_thread_pool_push (self->priv->thread_pool,
+            GINT_TO_POINTER (WORK_TIMEOUT), NULL);
       }
     }
   } else {
@@ -511,22 +661,15 @@ gst_dtls_connection_set_send_callback (GstDtlsConnection * self,
   g_mutex_unlock (&self->priv->mutex);
 }
 
-gint
-gst_dtls_connection_process (GstDtlsConnection * self, gpointer data, gint len)
+/*
+ * This function should be called while holding the connection mutex
+ */
+static gint
+process_locked (GstDtlsConnection * self, gpointer data, gint len)
 {
-  GstDtlsConnectionPrivate *priv;
+  GstDtlsConnectionPrivate *priv = self->priv;
   gint result;
 
-  g_return_val_if_fail (GST_IS_DTLS_CONNECTION (self), 0);
-  g_return_val_if_fail (self->priv->ssl, 0);
-  g_return_val_if_fail (self->priv->bio, 0);
-
-  priv = self->priv;
-
-  GST_TRACE_OBJECT (self, "locking @ process");
-  g_mutex_lock (&priv->mutex);
-  GST_TRACE_OBJECT (self, "locked @ process");
-
   g_warn_if_fail (!priv->bio_buffer);
 
   priv->bio_buffer = data;
@@ -550,6 +693,68 @@ gst_dtls_connection_process (GstDtlsConnection * self, gpointer data, gint len)
 
   GST_DEBUG_OBJECT (self, "read result: %d", result);
 
+  return result;
+}
+
+/*
+ * Whether the datagram has to be handled by the caller of
+ * gst_dtls_connection_process() instead of the thread pool: application data
+ * has to be returned to it, and a change cipher spec record means that the
+ * peer sent its last flight, which completes our side of the handshake. The
+ * keys are then exported before the caller goes on with any SRTP packets
+ * that followed.
+ */
+static gboolean
+needs_inline_processing (const guint8 * data, gint len)
+{
+  while (len >= DTLS_RECORD_HEADER_LEN) {
+    gint record_len;
+
+    if (data[0] == DTLS_CONTENT_TYPE_APPLICATION_DATA ||
+        data[0] == DTLS_CONTENT_TYPE_CHANGE_CIPHER_SPEC)
+      return TRUE;
+
+    record_len = DTLS_RECORD_HEADER_LEN + ((data[11] << 8) | data[12]);
+    data += record_len;
+    len -= record_len;
+  }
+
+  return FALSE;
+}
+
+gint
+gst_dtls_connection_process (GstDtlsConnection * self, gpointer data, gint len)
+{
+  GstDtlsConnectionPrivate *priv;
+  gint result;
+
+  g_return_val_if_fail (GST_IS_DTLS_CONNECTION (self), 0);
+  g_return_val_if_fail (self->priv->ssl, 0);
+  g_return_val_if_fail (self->priv->bio, 0);
+
+  priv = self->priv;
+
+  if (!needs_inline_processing (data, len)) {
+    /* The expensive parts of the handshake are handled by the thread pool,
+     * these records never produce any data for the caller */
+    GST_LOG_OBJECT (self, "queueing %d bytes of handshake records", len);
+    queue_handshake_work (self, g_bytes_new (data, len));
+    return 0;
+  }
+
+  /* Application data and the end of the handshake can only be handled once
+   * the handshake records received before them have been */
+  g_mutex_lock (&priv->work_lock);
+  while (priv->working || !g_queue_is_empty (&priv->work_queue))
+    g_cond_wait (&priv->work_cond, &priv->work_lock);
+  g_mutex_unlock (&priv->work_lock);
+
+  GST_TRACE_OBJECT (self, "locking @ process");
+  g_mutex_lock (&priv->mutex);
+  GST_TRACE_OBJECT (self, "locked @ process");
+
+  result = process_locked (self, data, len);
+
   GST_TRACE_OBJECT (self, "unlocking @ process");
   g_mutex_unlock (&priv->mutex);
 
@@ -630,6 +835,33 @@ log_state (GstDtlsConnection * self, const gchar * str)
 #endif
 }
 
+/*
+ * The verify callback is not called for resumed sessions, so check the
+ * certificate that the peer had in the original session instead.
+ */
+static gboolean
+check_resumed_peer_certificate (GstDtlsConnection * self)
+{
+  X509 *certificate;
+  gchar *pem;
+  gboolean accepted = FALSE;
+
+  certificate = SSL_get_peer_certificate (self->priv->ssl);
+  if (!certificate)
+    return FALSE;
+
+  pem = _gst_dtls_x509_to_pem (certificate);
+  X509_free (certificate);
+
+  if (pem) {
+    g_signal_emit (self, signals[SIGNAL_ON_PEER_CERTIFICATE], 0, pem,
+        &accepted);
+    g_free (pem);
+  }
+
+  return accepted;
+}
+
 static void
 export_srtp_keys (GstDtlsConnection * self)
 {
@@ -744,6 +976,21 @@ openssl_poll (GstDtlsConnection * self)
   switch (ret) {
     case 1:
       if (!self->priv->keys_exported) {
+        if (SSL_session_reused (self->priv->ssl)) {
+          if (!check_resumed_peer_certificate (self)) {
+            GST_WARNING_OBJECT (self,
+                "peer certificate of resumed session was not accepted");
+            self->priv->keys_exported = TRUE;
+            return;
+          }
+          GST_INFO_OBJECT (self, "session resumed");
+          self->priv->session_resumed = TRUE;
+        }
+
+        if (self->priv->is_client && self->priv->id)
+          _gst_dtls_agent_store_session (self->priv->agent, self->priv->id,
+              SSL_get1_session (self->priv->ssl));
+
         GST_INFO_OBJECT (self,
             "handshake just completed successfully, exporting keys");
         export_srtp_keys (self);
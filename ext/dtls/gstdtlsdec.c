@@ -67,6 +67,7 @@ enum
   PROP_DECODER_KEY,
   PROP_SRTP_CIPHER,
   PROP_SRTP_AUTH,
+  PROP_SESSION_RESUMED,
   NUM_PROPERTIES
 };
 
@@ -79,6 +80,7 @@ static GParamSpec *properties[NUM_PROPERTIES];
 #define DEFAULT_DECODER_KEY NULL
 #define DEFAULT_SRTP_CIPHER 0
 #define DEFAULT_SRTP_AUTH 0
+#define DEFAULT_SESSION_RESUMED FALSE
 
 
 static void gst_dtls_dec_finalize (GObject *);
@@ -171,6 +173,13 @@ gst_dtls_dec_class_init (GstDtlsDecClass * klass)
       0, GST_DTLS_SRTP_AUTH_HMAC_SHA1_80, DEFAULT_SRTP_AUTH,
       G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
+  properties[PROP_SESSION_RESUMED] =
+      g_param_spec_boolean ("session-resumed",
+      "Session resumed",
+      "Whether the DTLS handshake resumed a previous session instead of "
+      "doing a full handshake",
+      DEFAULT_SESSION_RESUMED, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 
   gst_element_class_add_static_pad_template (element_class, &src_template);
@@ -301,6 +310,13 @@ gst_dtls_dec_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_SRTP_AUTH:
       g_value_set_uint (value, self->srtp_auth);
       break;
+    case PROP_SESSION_RESUMED:
+      if (self->connection)
+        g_object_get_property (G_OBJECT (self->connection), "session-resumed",
+            value);
+      else
+        g_value_set_boolean (value, DEFAULT_SESSION_RESUMED);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
   }
@@ -698,7 +714,8 @@ create_connection (GstDtlsDec * self, gchar * id)
   }
 
   self->connection =
-      g_object_new (GST_TYPE_DTLS_CONNECTION, "agent", self->agent, NULL);
+      g_object_new (GST_TYPE_DTLS_CONNECTION, "agent", self->agent,
+      "connection-id", id, NULL);
 
   g_object_weak_ref (G_OBJECT (self->connection),
       (GWeakNotify) connection_weak_ref_notify, g_strdup (id));
@@ -62,6 +62,7 @@ enum
 
   PROP_GST_SCTP_ASSOCIATION_ID,
   PROP_LOCAL_SCTP_PORT,
+  PROP_MAX_MESSAGE_SIZE,
 
   NUM_PROPERTIES
 };
@@ -70,6 +71,7 @@ static GParamSpec *properties[NUM_PROPERTIES];
 
 #define DEFAULT_GST_SCTP_ASSOCIATION_ID 1
 #define DEFAULT_LOCAL_SCTP_PORT 0
+#define DEFAULT_MAX_MESSAGE_SIZE 0
 #define MAX_SCTP_PORT 65535
 #define MAX_GST_SCTP_ASSOCIATION_ID 65535
 #define MAX_STREAM_ID 65535
@@ -203,6 +205,14 @@ gst_sctp_dec_class_init (GstSctpDecClass * klass)
       0, MAX_SCTP_PORT, DEFAULT_LOCAL_SCTP_PORT,
       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  properties[PROP_MAX_MESSAGE_SIZE] =
+      g_param_spec_uint64 ("max-message-size",
+      "Maximum message size",
+      "Largest message accepted from the peer. Larger messages are dropped "
+      "and their stream is reset (0 = no limit)",
+      0, G_MAXUINT64, DEFAULT_MAX_MESSAGE_SIZE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 
   signals[SIGNAL_RESET_STREAM] = g_signal_new ("reset-stream",
@@ -222,6 +232,7 @@ gst_sctp_dec_init (GstSctpDec * self)
 {
   self->sctp_association_id = DEFAULT_GST_SCTP_ASSOCIATION_ID;
   self->local_sctp_port = DEFAULT_LOCAL_SCTP_PORT;
+  self->max_message_size = DEFAULT_MAX_MESSAGE_SIZE;
 
   self->sink_pad = gst_pad_new_from_static_template (&sink_template, "sink");
   gst_pad_set_chain_function (self->sink_pad,
@@ -245,6 +256,9 @@ gst_sctp_dec_set_property (GObject * object, guint prop_id,
     case PROP_LOCAL_SCTP_PORT:
       self->local_sctp_port = g_value_get_uint (value);
       break;
+    case PROP_MAX_MESSAGE_SIZE:
+      self->max_message_size = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
       break;
@@ -264,6 +278,9 @@ gst_sctp_dec_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_LOCAL_SCTP_PORT:
       g_value_set_uint (value, self->local_sctp_port);
       break;
+    case PROP_MAX_MESSAGE_SIZE:
+      g_value_set_uint64 (value, self->max_message_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
       break;
@@ -427,6 +444,8 @@ configure_association (GstSctpDec * self)
 
   g_object_bind_property (self, "local-sctp-port", self->sctp_association,
       "local-port", G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self, "max-message-size", self->sctp_association,
+      "max-message-size", G_BINDING_SYNC_CREATE);
 
   gst_sctp_association_set_on_packet_received (self->sctp_association,
       on_receive, self);
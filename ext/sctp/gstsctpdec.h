@@ -47,6 +47,7 @@ struct _GstSctpDec
   GstPad *sink_pad;
   guint sctp_association_id;
   guint local_sctp_port;
+  guint64 max_message_size;
 
   GstSctpAssociation *sctp_association;
   gulong signal_handler_stream_reset;
@@ -61,6 +61,7 @@ enum
   PROP_GST_SCTP_ASSOCIATION_ID,
   PROP_REMOTE_SCTP_PORT,
   PROP_USE_SOCK_STREAM,
+  PROP_INTERLEAVING,
 
   NUM_PROPERTIES
 };
@@ -72,6 +73,7 @@ static GParamSpec *properties[NUM_PROPERTIES];
 #define DEFAULT_GST_SCTP_ORDERED TRUE
 #define DEFAULT_SCTP_PPID 1
 #define DEFAULT_USE_SOCK_STREAM FALSE
+#define DEFAULT_INTERLEAVING TRUE
 
 #define BUFFER_FULL_SLEEP_TIME 100000
 
@@ -95,6 +97,11 @@ struct _GstSctpEncPad
   guint32 ppid;
   GstSctpAssociationPartialReliability reliability;
   guint32 reliability_param;
+  /* Data channel priority (RFC 8831), higher is more important, 0 if unset.
+   * Protected by lock, applied again once the association is connected if
+   * setting it failed */
+  guint32 priority;
+  gboolean priority_applied;
 
   guint64 bytes_sent;
 
@@ -155,11 +162,18 @@ static void on_sctp_association_state_changed (GstSctpAssociation *
 static gboolean configure_association (GstSctpEnc * self);
 static void on_sctp_packet_out (GstSctpAssociation * sctp_association,
     const guint8 * buf, gsize length, gpointer user_data);
+static void on_sctp_send_ready (GstSctpAssociation * sctp_association,
+    gpointer user_data);
 static void stop_srcpad_task (GstPad * pad, GstSctpEnc * self);
 static void sctpenc_cleanup (GstSctpEnc * self);
 static void get_config_from_caps (const GstCaps * caps, gboolean * ordered,
     GstSctpAssociationPartialReliability * reliability,
-    guint32 * reliability_param, guint32 * ppid, gboolean * ppid_available);
+    guint32 * reliability_param, guint32 * ppid, gboolean * ppid_available,
+    guint32 * priority);
+static void update_stream_priority (GstSctpEnc * self,
+    GstSctpEncPad * sctpenc_pad, guint32 priority);
+static void apply_stream_priority (GstSctpEnc * self,
+    GstSctpEncPad * sctpenc_pad);
 static guint64 on_get_stream_bytes_sent (GstSctpEnc * self, guint stream_id);
 
 static void
@@ -211,6 +225,14 @@ gst_sctp_enc_class_init (GstSctpEncClass * klass)
       "When TRUE the partial reliability parameters of the channel are ignored.",
       DEFAULT_USE_SOCK_STREAM, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  properties[PROP_INTERLEAVING] =
+      g_param_spec_boolean ("interleaving",
+      "Interleaving",
+      "Offer I-DATA chunks (RFC 8260) so that a large message on one stream "
+      "does not hold back the messages of the other streams. Only used if "
+      "the remote SCTP stack supports it too.",
+      DEFAULT_INTERLEAVING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 
   signals[SIGNAL_SCTP_ASSOCIATION_ESTABLISHED] =
@@ -257,6 +279,8 @@ gst_sctp_enc_init (GstSctpEnc * self)
 {
   self->sctp_association_id = DEFAULT_GST_SCTP_ASSOCIATION_ID;
   self->remote_sctp_port = DEFAULT_REMOTE_SCTP_PORT;
+  self->use_sock_stream = DEFAULT_USE_SOCK_STREAM;
+  self->interleaving = DEFAULT_INTERLEAVING;
 
   self->sctp_association = NULL;
   self->outbound_sctp_packet_queue =
@@ -298,6 +322,9 @@ gst_sctp_enc_set_property (GObject * object, guint prop_id,
     case PROP_USE_SOCK_STREAM:
       self->use_sock_stream = g_value_get_boolean (value);
       break;
+    case PROP_INTERLEAVING:
+      self->interleaving = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
       break;
@@ -320,6 +347,9 @@ gst_sctp_enc_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_USE_SOCK_STREAM:
       g_value_set_boolean (value, self->use_sock_stream);
       break;
+    case PROP_INTERLEAVING:
+      g_value_set_boolean (value, self->interleaving);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
       break;
@@ -386,6 +416,7 @@ gst_sctp_enc_request_new_pad (GstElement * element, GstPadTemplate * template,
   gint state;
   guint32 new_ppid;
   gboolean is_new_ppid;
+  guint32 priority = 0;
 
   g_object_get (self->sctp_association, "state", &state, NULL);
 
@@ -424,10 +455,11 @@ gst_sctp_enc_request_new_pad (GstElement * element, GstPadTemplate * template,
   if (caps) {
     get_config_from_caps (caps, &sctpenc_pad->ordered,
         &sctpenc_pad->reliability, &sctpenc_pad->reliability_param, &new_ppid,
-        &is_new_ppid);
+        &is_new_ppid, &priority);
 
     if (is_new_ppid)
       sctpenc_pad->ppid = new_ppid;
+    update_stream_priority (self, sctpenc_pad, priority);
   }
 
   sctpenc_pad->flushing = FALSE;
@@ -617,9 +649,10 @@ error:
 static gboolean
 gst_sctp_enc_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
+  GstSctpEnc *self = GST_SCTP_ENC (parent);
   GstSctpEncPad *sctpenc_pad = GST_SCTP_ENC_PAD (pad);
   gboolean ret, is_new_ppid;
-  guint32 new_ppid;
+  guint32 new_ppid, priority;
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_CAPS:{
@@ -628,9 +661,10 @@ gst_sctp_enc_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       gst_event_parse_caps (event, &caps);
       get_config_from_caps (caps, &sctpenc_pad->ordered,
           &sctpenc_pad->reliability, &sctpenc_pad->reliability_param, &new_ppid,
-          &is_new_ppid);
+          &is_new_ppid, &priority);
       if (is_new_ppid)
         sctpenc_pad->ppid = new_ppid;
+      update_stream_priority (self, sctpenc_pad, priority);
       gst_event_unref (event);
       ret = TRUE;
       break;
@@ -755,14 +789,27 @@ configure_association (GstSctpEnc * self)
   g_object_bind_property (self, "use-sock-stream", self->sctp_association,
       "use-sock-stream", G_BINDING_SYNC_CREATE);
 
+  g_object_bind_property (self, "interleaving", self->sctp_association,
+      "interleaving", G_BINDING_SYNC_CREATE);
+
   gst_sctp_association_set_on_packet_out (self->sctp_association,
       on_sctp_packet_out, self);
+  gst_sctp_association_set_on_send_ready (self->sctp_association,
+      on_sctp_send_ready, self);
 
   return TRUE;
 error:
   return FALSE;
 }
 
+static gboolean
+apply_pad_priority (GstElement * element, GstPad * pad, gpointer user_data)
+{
+  apply_stream_priority (GST_SCTP_ENC (element), GST_SCTP_ENC_PAD (pad));
+
+  return TRUE;
+}
+
 static void
 on_sctp_association_state_changed (GstSctpAssociation * sctp_association,
     GParamSpec * pspec, GstSctpEnc * self)
@@ -779,6 +826,8 @@ on_sctp_association_state_changed (GstSctpAssociation * sctp_association,
     case GST_SCTP_ASSOCIATION_STATE_CONNECTING:
       break;
     case GST_SCTP_ASSOCIATION_STATE_CONNECTED:
+      gst_element_foreach_sink_pad (GST_ELEMENT (self), apply_pad_priority,
+          NULL);
       g_signal_emit_by_name (self, "sctp-association-established", TRUE);
       break;
     case GST_SCTP_ASSOCIATION_STATE_DISCONNECTING:
@@ -800,6 +849,29 @@ data_queue_item_free (GstDataQueueItem * item)
   g_free (item);
 }
 
+static void
+wake_pending_pads (GstSctpEnc * self)
+{
+  GList *pending_pads, *l;
+  GstSctpEncPad *sctpenc_pad;
+
+  /* Wake up pads in the order they waited, oldest pad first */
+  GST_OBJECT_LOCK (self);
+  pending_pads = NULL;
+  while ((sctpenc_pad = g_queue_pop_tail (&self->pending_pads))) {
+    pending_pads = g_list_prepend (pending_pads, sctpenc_pad);
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  for (l = pending_pads; l; l = l->next) {
+    sctpenc_pad = l->data;
+    g_mutex_lock (&sctpenc_pad->lock);
+    g_cond_signal (&sctpenc_pad->cond);
+    g_mutex_unlock (&sctpenc_pad->lock);
+  }
+  g_list_free (pending_pads);
+}
+
 static void
 on_sctp_packet_out (GstSctpAssociation * _association, const guint8 * buf,
     gsize length, gpointer user_data)
@@ -807,8 +879,6 @@ on_sctp_packet_out (GstSctpAssociation * _association, const guint8 * buf,
   GstSctpEnc *self = user_data;
   GstBuffer *gstbuf;
   GstDataQueueItem *item;
-  GList *pending_pads, *l;
-  GstSctpEncPad *sctpenc_pad;
 
   gstbuf = gst_buffer_new_wrapped (g_memdup (buf, length), length);
 
@@ -823,21 +893,19 @@ on_sctp_packet_out (GstSctpAssociation * _association, const guint8 * buf,
     GST_DEBUG_OBJECT (self, "Failed to push item because we're flushing");
   }
 
-  /* Wake up pads in the order they waited, oldest pad first */
-  GST_OBJECT_LOCK (self);
-  pending_pads = NULL;
-  while ((sctpenc_pad = g_queue_pop_tail (&self->pending_pads))) {
-    pending_pads = g_list_prepend (pending_pads, sctpenc_pad);
-  }
-  GST_OBJECT_UNLOCK (self);
+  wake_pending_pads (self);
+}
 
-  for (l = pending_pads; l; l = l->next) {
-    sctpenc_pad = l->data;
-    g_mutex_lock (&sctpenc_pad->lock);
-    g_cond_signal (&sctpenc_pad->cond);
-    g_mutex_unlock (&sctpenc_pad->lock);
-  }
-  g_list_free (pending_pads);
+/* Called when the remote acknowledged data and the send buffer has room
+ * again, so waiting pads can retry right away instead of after
+ * BUFFER_FULL_SLEEP_TIME */
+static void
+on_sctp_send_ready (GstSctpAssociation * _association, gpointer user_data)
+{
+  GstSctpEnc *self = user_data;
+
+  GST_LOG_OBJECT (self, "Send buffer has room again");
+  wake_pending_pads (self);
 }
 
 static void
@@ -882,7 +950,8 @@ sctpenc_cleanup (GstSctpEnc * self)
 static void
 get_config_from_caps (const GstCaps * caps, gboolean * ordered,
     GstSctpAssociationPartialReliability * reliability,
-    guint32 * reliability_param, guint32 * ppid, gboolean * ppid_available)
+    guint32 * reliability_param, guint32 * ppid, gboolean * ppid_available,
+    guint32 * priority)
 {
   GstStructure *s;
   guint i, n;
@@ -891,6 +960,7 @@ get_config_from_caps (const GstCaps * caps, gboolean * ordered,
   *reliability = GST_SCTP_ASSOCIATION_PARTIAL_RELIABILITY_NONE;
   *reliability_param = 0;
   *ppid_available = FALSE;
+  *priority = 0;
 
   n = gst_caps_get_size (caps);
   for (i = 0; i < n; i++) {
@@ -921,7 +991,52 @@ get_config_from_caps (const GstCaps * caps, gboolean * ordered,
       *ppid = g_value_get_uint (v);
       *ppid_available = TRUE;
     }
+    if (gst_structure_has_field (s, "priority")) {
+      const GValue *v = gst_structure_get_value (s, "priority");
+      *priority = g_value_get_uint (v);
+    }
+  }
+}
+
+static void
+update_stream_priority (GstSctpEnc * self, GstSctpEncPad * sctpenc_pad,
+    guint32 priority)
+{
+  g_mutex_lock (&sctpenc_pad->lock);
+  if (priority != 0 && priority != sctpenc_pad->priority) {
+    sctpenc_pad->priority = priority;
+    sctpenc_pad->priority_applied = FALSE;
   }
+  g_mutex_unlock (&sctpenc_pad->lock);
+
+  apply_stream_priority (self, sctpenc_pad);
+}
+
+static void
+apply_stream_priority (GstSctpEnc * self, GstSctpEncPad * sctpenc_pad)
+{
+  guint32 priority;
+
+  g_mutex_lock (&sctpenc_pad->lock);
+  priority = sctpenc_pad->priority_applied ? 0 : sctpenc_pad->priority;
+  g_mutex_unlock (&sctpenc_pad->lock);
+
+  if (priority == 0)
+    return;
+
+  /* The SCTP stream scheduler sends lower values first */
+  GST_DEBUG_OBJECT (sctpenc_pad, "Setting priority %u", priority);
+  if (!gst_sctp_association_set_stream_priority (self->sctp_association,
+          sctpenc_pad->stream_id, G_MAXUINT16 - MIN (priority, G_MAXUINT16))) {
+    GST_DEBUG_OBJECT (sctpenc_pad, "Could not set priority %u, retrying once "
+        "the association is connected", priority);
+    return;
+  }
+
+  g_mutex_lock (&sctpenc_pad->lock);
+  if (sctpenc_pad->priority == priority)
+    sctpenc_pad->priority_applied = TRUE;
+  g_mutex_unlock (&sctpenc_pad->lock);
 }
 
 static guint64
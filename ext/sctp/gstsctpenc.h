@@ -50,6 +50,7 @@ struct _GstSctpEnc
   guint32 sctp_association_id;
   guint16 remote_sctp_port;
   gboolean use_sock_stream;
+  gboolean interleaving;
 
   GstSctpAssociation *sctp_association;
   GstDataQueue *outbound_sctp_packet_queue;
@@ -80,6 +80,8 @@ enum
   PROP_REMOTE_PORT,
   PROP_STATE,
   PROP_USE_SOCK_STREAM,
+  PROP_INTERLEAVING,
+  PROP_MAX_MESSAGE_SIZE,
 
   NUM_PROPERTIES
 };
@@ -91,6 +93,8 @@ static GParamSpec *properties[NUM_PROPERTIES];
 #define DEFAULT_NUMBER_OF_SCTP_STREAMS 10
 #define DEFAULT_LOCAL_SCTP_PORT 0
 #define DEFAULT_REMOTE_SCTP_PORT 0
+#define DEFAULT_INTERLEAVING TRUE
+#define DEFAULT_MAX_MESSAGE_SIZE 0
 
 static GHashTable *associations = NULL;
 G_LOCK_DEFINE_STATIC (associations_lock);
@@ -120,8 +124,12 @@ static void handle_association_changed (GstSctpAssociation * self,
     const struct sctp_assoc_change *sac);
 static void handle_stream_reset_event (GstSctpAssociation * self,
     const struct sctp_stream_reset_event *ssr);
+static void handle_partial_delivery_event (GstSctpAssociation * self,
+    const struct sctp_pdapi_event *pdapi);
 static void handle_message (GstSctpAssociation * self, guint8 * data,
     guint32 datalen, guint16 stream_id, guint32 ppid);
+static void handle_data (GstSctpAssociation * self, guint8 * data,
+    guint32 datalen, gint flags, guint16 stream_id, guint32 ppid);
 
 static void maybe_set_state_to_ready (GstSctpAssociation * self);
 static void gst_sctp_association_change_state (GstSctpAssociation * self,
@@ -168,6 +176,19 @@ gst_sctp_association_class_init (GstSctpAssociationClass * klass)
       "When TRUE the partial reliability parameters of the channel is ignored.",
       FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  properties[PROP_INTERLEAVING] =
+      g_param_spec_boolean ("interleaving", "Interleaving",
+      "Offer I-DATA chunks (RFC 8260) so that fragments of large messages "
+      "on different streams can be interleaved. Only used if the peer "
+      "supports it too.",
+      DEFAULT_INTERLEAVING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_MAX_MESSAGE_SIZE] =
+      g_param_spec_uint64 ("max-message-size", "Maximum message size",
+      "Incoming messages larger than this are dropped and their stream is "
+      "reset (0 = no limit)", 0, G_MAXUINT64, DEFAULT_MAX_MESSAGE_SIZE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 }
 
@@ -196,6 +217,12 @@ gst_sctp_association_init (GstSctpAssociation * self)
   self->state = GST_SCTP_ASSOCIATION_STATE_NEW;
 
   self->use_sock_stream = FALSE;
+  self->interleaving = DEFAULT_INTERLEAVING;
+  self->max_message_size = DEFAULT_MAX_MESSAGE_SIZE;
+
+  self->partial_messages = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, NULL, (GDestroyNotify) g_byte_array_unref);
+  self->discarded_messages = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   usrsctp_register_address ((void *) self);
 }
@@ -219,6 +246,9 @@ gst_sctp_association_finalize (GObject * object)
   if (self->connection_thread)
     g_thread_join (self->connection_thread);
 
+  g_hash_table_destroy (self->partial_messages);
+  g_hash_table_destroy (self->discarded_messages);
+
   G_OBJECT_CLASS (gst_sctp_association_parent_class)->finalize (object);
 }
 
@@ -233,6 +263,7 @@ gst_sctp_association_set_property (GObject * object, guint prop_id,
     switch (prop_id) {
       case PROP_LOCAL_PORT:
       case PROP_REMOTE_PORT:
+      case PROP_INTERLEAVING:
         g_warning ("These properties cannot be set in this state");
         goto error;
     }
@@ -254,6 +285,12 @@ gst_sctp_association_set_property (GObject * object, guint prop_id,
     case PROP_USE_SOCK_STREAM:
       self->use_sock_stream = g_value_get_boolean (value);
       break;
+    case PROP_INTERLEAVING:
+      self->interleaving = g_value_get_boolean (value);
+      break;
+    case PROP_MAX_MESSAGE_SIZE:
+      self->max_message_size = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
       break;
@@ -315,6 +352,14 @@ gst_sctp_association_get_property (GObject * object, guint prop_id,
     case PROP_USE_SOCK_STREAM:
       g_value_set_boolean (value, self->use_sock_stream);
       break;
+    case PROP_INTERLEAVING:
+      g_value_set_boolean (value, self->interleaving);
+      break;
+    case PROP_MAX_MESSAGE_SIZE:
+      g_mutex_lock (&self->association_mutex);
+      g_value_set_uint64 (value, self->max_message_size);
+      g_mutex_unlock (&self->association_mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
       break;
@@ -426,11 +471,42 @@ gst_sctp_association_set_on_packet_received (GstSctpAssociation * self,
   maybe_set_state_to_ready (self);
 }
 
+void
+gst_sctp_association_set_on_send_ready (GstSctpAssociation * self,
+    GstSctpAssociationSendReadyCb send_ready_cb, gpointer user_data)
+{
+  g_return_if_fail (GST_SCTP_IS_ASSOCIATION (self));
+
+  g_mutex_lock (&self->association_mutex);
+  if (self->state == GST_SCTP_ASSOCIATION_STATE_NEW) {
+    self->send_ready_cb = send_ready_cb;
+    self->send_ready_user_data = user_data;
+  } else {
+    /* This is to be thread safe. The Association might try to call the closure already */
+    g_warning ("It is not possible to change send ready callback in this state");
+  }
+  g_mutex_unlock (&self->association_mutex);
+}
+
 void
 gst_sctp_association_incoming_packet (GstSctpAssociation * self, guint8 * buf,
     guint32 length)
 {
+  gboolean send_ready = FALSE;
+
   usrsctp_conninput ((void *) self, (const void *) buf, (size_t) length, 0);
+
+  /* Acknowledged data was removed from the send buffer while handling the
+   * packet, so senders that found it full can try again */
+  g_mutex_lock (&self->association_mutex);
+  if (self->send_blocked && self->send_ready_cb) {
+    self->send_blocked = FALSE;
+    send_ready = TRUE;
+  }
+  g_mutex_unlock (&self->association_mutex);
+
+  if (send_ready)
+    self->send_ready_cb (self, self->send_ready_user_data);
 }
 
 gboolean
@@ -473,7 +549,9 @@ gst_sctp_association_send_data (GstSctpAssociation * self, guint8 * buf,
       (socklen_t) sizeof (struct sctp_sendv_spa), SCTP_SENDV_SPA, 0);
   if (bytes_sent < 0) {
     if (errno == EAGAIN || errno == EWOULDBLOCK) {
-      /* Resending this buffer is taken care of by the gstsctpenc */
+      /* Resending this buffer is taken care of by the gstsctpenc once the
+       * send ready callback was called */
+      self->send_blocked = TRUE;
       goto end;
     } else {
       g_warning ("Error sending data on stream %u: (%u) %s", stream_id, errno,
@@ -488,6 +566,38 @@ end:
   return result;
 }
 
+/* Lower values are sent first, streams with the same priority take turns */
+gboolean
+gst_sctp_association_set_stream_priority (GstSctpAssociation * self,
+    guint16 stream_id, guint16 priority)
+{
+#if defined(SCTP_SS_VALUE)
+  struct sctp_stream_value stream_value;
+  gboolean result = FALSE;
+
+  g_mutex_lock (&self->association_mutex);
+  if (self->state != GST_SCTP_ASSOCIATION_STATE_CONNECTED)
+    goto end;
+
+  memset (&stream_value, 0, sizeof (stream_value));
+  stream_value.assoc_id = self->sctp_assoc_id;
+  stream_value.stream_id = stream_id;
+  stream_value.stream_value = priority;
+  if (usrsctp_setsockopt (self->sctp_ass_sock, IPPROTO_SCTP, SCTP_SS_VALUE,
+          &stream_value, sizeof (stream_value)) < 0) {
+    g_warning ("Could not set priority of stream %u: (%u) %s", stream_id,
+        errno, strerror (errno));
+    goto end;
+  }
+
+  result = TRUE;
+end:
+  g_mutex_unlock (&self->association_mutex);
+  return result;
+#else
+  return FALSE;
+#endif
+}
 
 void
 gst_sctp_association_reset_stream (GstSctpAssociation * self, guint16 stream_id)
@@ -528,6 +638,12 @@ create_sctp_socket (GstSctpAssociation * self)
   struct linger l;
   struct sctp_event event;
   struct sctp_assoc_value stream_reset;
+#if defined(SCTP_PLUGGABLE_SS) && defined(SCTP_SS_PRIORITY)
+  struct sctp_assoc_value scheduler;
+#endif
+#if defined(SCTP_INTERLEAVING_SUPPORTED)
+  struct sctp_assoc_value interleaving;
+#endif
   int value = 1;
   guint16 event_types[] = {
     SCTP_ASSOC_CHANGE,
@@ -536,7 +652,7 @@ create_sctp_socket (GstSctpAssociation * self)
     SCTP_SEND_FAILED,
     SCTP_SHUTDOWN_EVENT,
     SCTP_ADAPTATION_INDICATION,
-    /*SCTP_PARTIAL_DELIVERY_EVENT, */
+    SCTP_PARTIAL_DELIVERY_EVENT,
     /*SCTP_AUTHENTICATION_EVENT, */
     SCTP_STREAM_RESET_EVENT,
     /*SCTP_SENDER_DRY_EVENT, */
@@ -581,6 +697,33 @@ create_sctp_socket (GstSctpAssociation * self)
     goto error;
   }
 
+#if defined(SCTP_PLUGGABLE_SS) && defined(SCTP_SS_PRIORITY)
+  /* Let streams with a higher priority go first instead of sending the
+   * queued messages in order, see gst_sctp_association_set_stream_priority() */
+  memset (&scheduler, 0, sizeof (scheduler));
+  scheduler.assoc_id = SCTP_ALL_ASSOC;
+  scheduler.assoc_value = SCTP_SS_PRIORITY;
+  if (usrsctp_setsockopt (sock, IPPROTO_SCTP, SCTP_PLUGGABLE_SS, &scheduler,
+          sizeof (scheduler)))
+    g_warning ("Could not set SCTP_PLUGGABLE_SS");
+#endif
+
+#if defined(SCTP_INTERLEAVING_SUPPORTED)
+  /* Without I-DATA all fragments of a message have to be sent before
+   * anything else, so one large message delays all other streams */
+  if (self->interleaving) {
+    value = 2;
+    memset (&interleaving, 0, sizeof (interleaving));
+    interleaving.assoc_id = SCTP_FUTURE_ASSOC;
+    interleaving.assoc_value = 1;
+    if (usrsctp_setsockopt (sock, IPPROTO_SCTP, SCTP_FRAGMENT_INTERLEAVE,
+            &value, sizeof (int)) ||
+        usrsctp_setsockopt (sock, IPPROTO_SCTP, SCTP_INTERLEAVING_SUPPORTED,
+            &interleaving, sizeof (interleaving)))
+      g_warning ("Could not enable SCTP interleaving");
+  }
+#endif
+
   memset (&event, 0, sizeof (event));
   event.se_assoc_id = SCTP_ALL_ASSOC;
   event.se_on = 1;
@@ -688,7 +831,7 @@ receive_cb (struct socket *sock, union sctp_sockstore addr, void *data,
           datalen);
       free (data);
     } else {
-      handle_message (self, data, datalen, rcv_info.rcv_sid,
+      handle_data (self, data, datalen, flags, rcv_info.rcv_sid,
           ntohl (rcv_info.rcv_ppid));
     }
   }
@@ -726,6 +869,7 @@ handle_notification (GstSctpAssociation * self,
     case SCTP_PARTIAL_DELIVERY_EVENT:
       g_log (G_LOG_DOMAIN, G_LOG_LEVEL_INFO,
           "Event: SCTP_PARTIAL_DELIVERY_EVENT");
+      handle_partial_delivery_event (self, &notification->sn_pdapi_event);
       break;
     case SCTP_AUTHENTICATION_EVENT:
       g_log (G_LOG_DOMAIN, G_LOG_LEVEL_INFO,
@@ -768,6 +912,7 @@ handle_association_changed (GstSctpAssociation * self,
       g_log (G_LOG_DOMAIN, G_LOG_LEVEL_INFO, "SCTP_COMM_UP()");
       g_mutex_lock (&self->association_mutex);
       if (self->state == GST_SCTP_ASSOCIATION_STATE_CONNECTING) {
+        self->sctp_assoc_id = sac->sac_assoc_id;
         change_state = TRUE;
         new_state = GST_SCTP_ASSOCIATION_STATE_CONNECTED;
         g_log (G_LOG_DOMAIN, G_LOG_LEVEL_INFO, "SCTP association connected!");
@@ -810,6 +955,10 @@ handle_stream_reset_event (GstSctpAssociation * self,
         sizeof (struct sctp_stream_reset_event)) / sizeof (uint16_t);
     for (i = 0; i < n; i++) {
       if (sr->strreset_flags & SCTP_STREAM_RESET_INCOMING_SSN) {
+        g_hash_table_remove (self->partial_messages,
+            GUINT_TO_POINTER (sr->strreset_stream_list[i]));
+        g_hash_table_remove (self->discarded_messages,
+            GUINT_TO_POINTER (sr->strreset_stream_list[i]));
         g_signal_emit (self, signals[SIGNAL_STREAM_RESET], 0,
             sr->strreset_stream_list[i]);
       }
@@ -817,6 +966,19 @@ handle_stream_reset_event (GstSctpAssociation * self,
   }
 }
 
+static void
+handle_partial_delivery_event (GstSctpAssociation * self,
+    const struct sctp_pdapi_event *pdapi)
+{
+  if (pdapi->pdapi_indication == SCTP_PARTIAL_DELIVERY_ABORTED) {
+    g_warning ("Partial delivery on stream %u aborted", pdapi->pdapi_stream);
+    g_hash_table_remove (self->partial_messages,
+        GUINT_TO_POINTER ((guint) pdapi->pdapi_stream));
+    g_hash_table_remove (self->discarded_messages,
+        GUINT_TO_POINTER ((guint) pdapi->pdapi_stream));
+  }
+}
+
 static void
 handle_message (GstSctpAssociation * self, guint8 * data, guint32 datalen,
     guint16 stream_id, guint32 ppid)
@@ -835,3 +997,65 @@ gst_sctp_association_change_state (GstSctpAssociation * self,
   if (notify)
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_STATE]);
 }
+
+/* Large messages are delivered in pieces, and with interleaving the pieces
+ * of messages on different streams can arrive in any order. Put them back
+ * together per stream until the end of the message is seen.
+ *
+ * A message that grows beyond max-message-size is dropped, together with
+ * the rest of its pieces, and the stream is reset so that the peer closes
+ * the data channel instead of sending more of it. */
+static void
+handle_data (GstSctpAssociation * self, guint8 * data, guint32 datalen,
+    gint flags, guint16 stream_id, guint32 ppid)
+{
+  gpointer key = GUINT_TO_POINTER ((guint) stream_id);
+  GByteArray *partial;
+  guint64 max_message_size;
+
+  if (g_hash_table_contains (self->discarded_messages, key)) {
+    free (data);
+    if (flags & MSG_EOR)
+      g_hash_table_remove (self->discarded_messages, key);
+    return;
+  }
+
+  g_mutex_lock (&self->association_mutex);
+  max_message_size = self->max_message_size;
+  g_mutex_unlock (&self->association_mutex);
+
+  partial = g_hash_table_lookup (self->partial_messages, key);
+
+  if (max_message_size != 0 &&
+      (partial ? partial->len : 0) + (guint64) datalen > max_message_size) {
+    g_log (G_LOG_DOMAIN, G_LOG_LEVEL_MESSAGE, "Message on stream %u is "
+        "larger than %" G_GUINT64_FORMAT " bytes, dropping it and resetting "
+        "the stream", stream_id, max_message_size);
+    free (data);
+    g_hash_table_remove (self->partial_messages, key);
+    if (!(flags & MSG_EOR))
+      g_hash_table_add (self->discarded_messages, key);
+    gst_sctp_association_reset_stream (self, stream_id);
+    return;
+  }
+
+  if (!partial && (flags & MSG_EOR)) {
+    handle_message (self, data, datalen, stream_id, ppid);
+    return;
+  }
+
+  if (!partial) {
+    partial = g_byte_array_sized_new (2 * datalen);
+    g_hash_table_insert (self->partial_messages, key, partial);
+  }
+  g_byte_array_append (partial, data, datalen);
+  free (data);
+
+  if (flags & MSG_EOR) {
+    guint len = partial->len;
+
+    g_hash_table_steal (self->partial_messages, key);
+    handle_message (self, g_byte_array_free (partial, FALSE), len, stream_id,
+        ppid);
+  }
+}
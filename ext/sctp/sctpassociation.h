@@ -67,6 +67,8 @@ typedef void (*GstSctpAssociationPacketReceivedCb) (GstSctpAssociation *
     guint ppid, gpointer user_data);
 typedef void (*GstSctpAssociationPacketOutCb) (GstSctpAssociation *
     sctp_association, const guint8 * data, gsize length, gpointer user_data);
+typedef void (*GstSctpAssociationSendReadyCb) (GstSctpAssociation *
+    sctp_association, gpointer user_data);
 
 struct _GstSctpAssociation
 {
@@ -76,7 +78,19 @@ struct _GstSctpAssociation
   guint16 local_port;
   guint16 remote_port;
   gboolean use_sock_stream;
+  gboolean interleaving;
   struct socket *sctp_ass_sock;
+  sctp_assoc_t sctp_assoc_id;
+
+  /* Whether a send failed because the send buffer was full */
+  gboolean send_blocked;
+
+  /* stream id -> GByteArray of a partially delivered message */
+  GHashTable *partial_messages;
+  /* stream ids whose current message is dropped until its end */
+  GHashTable *discarded_messages;
+  /* incoming messages larger than this are dropped, 0 for no limit */
+  guint64 max_message_size;
 
   GMutex association_mutex;
 
@@ -89,6 +103,9 @@ struct _GstSctpAssociation
 
   GstSctpAssociationPacketOutCb packet_out_cb;
   gpointer packet_out_user_data;
+
+  GstSctpAssociationSendReadyCb send_ready_cb;
+  gpointer send_ready_user_data;
 };
 
 struct _GstSctpAssociationClass
@@ -108,12 +125,16 @@ void gst_sctp_association_set_on_packet_out (GstSctpAssociation * self,
     GstSctpAssociationPacketOutCb packet_out_cb, gpointer user_data);
 void gst_sctp_association_set_on_packet_received (GstSctpAssociation * self,
     GstSctpAssociationPacketReceivedCb packet_received_cb, gpointer user_data);
+void gst_sctp_association_set_on_send_ready (GstSctpAssociation * self,
+    GstSctpAssociationSendReadyCb send_ready_cb, gpointer user_data);
 void gst_sctp_association_incoming_packet (GstSctpAssociation * self,
     guint8 * buf, guint32 length);
 gboolean gst_sctp_association_send_data (GstSctpAssociation * self,
     guint8 * buf, guint32 length, guint16 stream_id, guint32 ppid,
     gboolean ordered, GstSctpAssociationPartialReliability pr,
     guint32 reliability_param);
+gboolean gst_sctp_association_set_stream_priority (GstSctpAssociation * self,
+    guint16 stream_id, guint16 priority);
 void gst_sctp_association_reset_stream (GstSctpAssociation * self,
     guint16 stream_id);
 void gst_sctp_association_force_close (GstSctpAssociation * self);
@@ -27,6 +27,7 @@
 
 #include <gio/gnetworking.h>
 #include <stdlib.h>
+#include <string.h>
 
 GST_DEBUG_CATEGORY_EXTERN (gst_debug_srtobject);
 #define GST_CAT_DEFAULT gst_debug_srtobject
@@ -43,15 +44,82 @@ enum
   PROP_LATENCY,
   PROP_MSG_SIZE,
   PROP_STATS,
+  PROP_CALLER_QUEUE_SIZE,
+  PROP_CALLER_DROP_POLICY,
+  PROP_REDUNDANT_URIS,
   PROP_LAST
 };
 
+/* How long the sender thread waits for blocked callers at once if it can't
+ * be woken up through a file descriptor when new data arrives, in ms */
+#define SENDER_POLL_TIMEOUT 5
+
+/* Writable callers handled per wakeup of the sender thread, the others are
+ * reported again by the next wait */
+#define SENDER_MAX_EVENTS 64
+
+/* A buffer mapped once and shared by the queues of all callers */
+typedef struct
+{
+  gint refcount;
+  gboolean is_header;
+  GstBuffer *buffer;
+  GstMapInfo map;
+} SRTMessage;
+
+static SRTMessage *
+srt_message_new (GstBuffer * buffer)
+{
+  SRTMessage *msg = g_slice_new (SRTMessage);
+
+  if (!gst_buffer_map (buffer, &msg->map, GST_MAP_READ)) {
+    g_slice_free (SRTMessage, msg);
+    return NULL;
+  }
+
+  msg->refcount = 1;
+  msg->is_header = FALSE;
+  msg->buffer = gst_buffer_ref (buffer);
+
+  return msg;
+}
+
+static SRTMessage *
+srt_message_ref (SRTMessage * msg)
+{
+  g_atomic_int_inc (&msg->refcount);
+  return msg;
+}
+
+static void
+srt_message_unref (SRTMessage * msg)
+{
+  if (g_atomic_int_dec_and_test (&msg->refcount)) {
+    gst_buffer_unmap (msg->buffer, &msg->map);
+    gst_buffer_unref (msg->buffer);
+    g_slice_free (SRTMessage, msg);
+  }
+}
+
 typedef struct
 {
   SRTSOCKET sock;
   gint poll_id;
   GSocketAddress *sockaddr;
   gboolean sent_headers;
+
+  /* SRTMessage queued for sending, and how much of the head of the queue
+   * has been sent already */
+  GQueue queue;
+  gsize offset;
+  guint64 dropped;
+
+  /* the sender thread is sending the head of the queue without the object
+   * lock, is waiting for the socket to be writable, or has to disconnect
+   * the caller */
+  gboolean sending;
+  gboolean blocked;
+  gboolean disconnect;
 } SRTCaller;
 
 static SRTCaller *
@@ -61,6 +129,7 @@ srt_caller_new (void)
   caller->sock = SRT_INVALID_SOCK;
   caller->poll_id = SRT_ERROR;
   caller->sent_headers = FALSE;
+  g_queue_init (&caller->queue);
 
   return caller;
 }
@@ -70,6 +139,9 @@ srt_caller_free (SRTCaller * caller)
 {
   g_return_if_fail (caller != NULL);
 
+  g_queue_foreach (&caller->queue, (GFunc) srt_message_unref, NULL);
+  g_queue_clear (&caller->queue);
+
   g_clear_object (&caller->sockaddr);
 
   if (caller->sock != SRT_INVALID_SOCK) {
@@ -104,6 +176,8 @@ srt_caller_invoke_removed_closure (SRTCaller * caller, GstSRTObject * srtobject)
   g_value_unset (&values[1]);
 }
 
+static void gst_srt_object_stop_sender (GstSRTObject * srtobject);
+
 struct srt_constant_params
 {
   const gchar *name;
@@ -187,10 +261,16 @@ gst_srt_object_new (GstElement * element)
   srtobject->poll_id = srt_epoll_create ();
   srtobject->listener_sock = SRT_INVALID_SOCK;
   srtobject->listener_poll_id = SRT_ERROR;
+  srtobject->merge_poll_id = SRT_ERROR;
+  srtobject->sender_poll_id = SRT_ERROR;
+  srtobject->sender_wakeup_fd = -1;
   srtobject->sent_headers = FALSE;
 
   g_mutex_init (&srtobject->sock_lock);
   g_cond_init (&srtobject->sock_cond);
+  g_cond_init (&srtobject->sender_cond);
+  g_mutex_init (&srtobject->merge_lock);
+  g_cond_init (&srtobject->merge_cond);
   return srtobject;
 }
 
@@ -206,11 +286,15 @@ gst_srt_object_destroy (GstSRTObject * srtobject)
 
   g_mutex_clear (&srtobject->sock_lock);
   g_cond_clear (&srtobject->sock_cond);
+  g_cond_clear (&srtobject->sender_cond);
+  g_mutex_clear (&srtobject->merge_lock);
+  g_cond_clear (&srtobject->merge_cond);
 
   GST_DEBUG_OBJECT (srtobject->element, "Destroying srtobject");
   gst_structure_free (srtobject->parameters);
 
   g_free (srtobject->passphrase);
+  g_strfreev (srtobject->redundant_uris);
 
   if (g_atomic_int_dec_and_test (&srt_init_refcount)) {
     srt_cleanup ();
@@ -257,6 +341,22 @@ gst_srt_object_set_property_helper (GstSRTObject * srtobject,
     case PROP_PBKEYLEN:
       gst_structure_set_value (srtobject->parameters, "pbkeylen", value);
       break;
+    case PROP_CALLER_QUEUE_SIZE:
+      GST_OBJECT_LOCK (srtobject->element);
+      gst_structure_set_value (srtobject->parameters, "caller-queue-size",
+          value);
+      GST_OBJECT_UNLOCK (srtobject->element);
+      break;
+    case PROP_CALLER_DROP_POLICY:
+      GST_OBJECT_LOCK (srtobject->element);
+      gst_structure_set_value (srtobject->parameters, "caller-drop-policy",
+          value);
+      GST_OBJECT_UNLOCK (srtobject->element);
+      break;
+    case PROP_REDUNDANT_URIS:
+      g_strfreev (srtobject->redundant_uris);
+      srtobject->redundant_uris = g_value_dup_boxed (value);
+      break;
     default:
       return FALSE;
   }
@@ -334,6 +434,31 @@ gst_srt_object_get_property_helper (GstSRTObject * srtobject,
     case PROP_STATS:
       g_value_take_boxed (value, gst_srt_object_get_stats (srtobject));
       break;
+    case PROP_CALLER_QUEUE_SIZE:{
+      guint v;
+      GST_OBJECT_LOCK (srtobject->element);
+      if (!gst_structure_get_uint (srtobject->parameters, "caller-queue-size",
+              &v)) {
+        v = GST_SRT_DEFAULT_CALLER_QUEUE_SIZE;
+      }
+      GST_OBJECT_UNLOCK (srtobject->element);
+      g_value_set_uint (value, v);
+      break;
+    }
+    case PROP_CALLER_DROP_POLICY:{
+      GstSRTCallerDropPolicy v;
+      GST_OBJECT_LOCK (srtobject->element);
+      if (!gst_structure_get_enum (srtobject->parameters, "caller-drop-policy",
+              GST_TYPE_SRT_CALLER_DROP_POLICY, (gint *) & v)) {
+        v = GST_SRT_DEFAULT_CALLER_DROP_POLICY;
+      }
+      GST_OBJECT_UNLOCK (srtobject->element);
+      g_value_set_enum (value, v);
+      break;
+    }
+    case PROP_REDUNDANT_URIS:
+      g_value_set_boxed (value, srtobject->redundant_uris);
+      break;
     default:
       return FALSE;
   }
@@ -466,6 +591,53 @@ gst_srt_object_install_properties_helper (GObjectClass * gobject_class)
 
 }
 
+void
+gst_srt_object_install_sink_properties_helper (GObjectClass * gobject_class)
+{
+  /**
+   * GstSRTSink:caller-queue-size:
+   *
+   * The number of buffers queued for each caller in listener mode before
+   * #GstSRTSink:caller-drop-policy applies (0 = unlimited).
+   */
+  g_object_class_install_property (gobject_class, PROP_CALLER_QUEUE_SIZE,
+      g_param_spec_uint ("caller-queue-size", "Caller queue size",
+          "Maximum number of buffers queued per caller (0 = unlimited)", 0,
+          G_MAXUINT, GST_SRT_DEFAULT_CALLER_QUEUE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSRTSink:caller-drop-policy:
+   *
+   * What to do when a caller in listener mode can't keep up and its
+   * queue is full.
+   */
+  g_object_class_install_property (gobject_class, PROP_CALLER_DROP_POLICY,
+      g_param_spec_enum ("caller-drop-policy", "Caller drop policy",
+          "What to do when the queue of a caller is full",
+          GST_TYPE_SRT_CALLER_DROP_POLICY, GST_SRT_DEFAULT_CALLER_DROP_POLICY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+void
+gst_srt_object_install_src_properties_helper (GObjectClass * gobject_class)
+{
+  /**
+   * GstSRTSrc:redundant-uris:
+   *
+   * Additional caller or rendezvous URIs receiving the same stream as
+   * #GstSRTSrc:uri, for example over another network path. All links are
+   * read together and the first copy of every message is output, so
+   * losing a link doesn't interrupt the stream. Links that fail or get
+   * lost are reconnected in the background.
+   */
+  g_object_class_install_property (gobject_class, PROP_REDUNDANT_URIS,
+      g_param_spec_boxed ("redundant-uris", "Redundant URIs",
+          "Additional SRT URIs carrying the same stream", G_TYPE_STRV,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+}
+
 static void
 gst_srt_object_set_enum_value (GstStructure * s, GType enum_type,
     gconstpointer key, gconstpointer value)
@@ -950,6 +1122,348 @@ gst_srt_object_open_connection (GstSRTObject * srtobject,
   return ret;
 }
 
+/* Upper bound of the messages remembered to drop the copies arriving late
+ * over the other links, about 1.5 s of a 30 Mbit/s stream of 1316 bytes
+ * messages */
+#define MERGE_WINDOW_SIZE 4096
+
+/* A message not received again on any link for this long won't come
+ * anymore, unless the receive latency is longer */
+#define MERGE_WINDOW_MIN_TIME (500 * G_TIME_SPAN_MILLISECOND)
+
+/* How often the links that are down are reconnected */
+#define MERGE_RECONNECT_INTERVAL (1 * G_TIME_SPAN_SECOND)
+
+/* A message recently received, with how many times it came over each link */
+typedef struct
+{
+  guint64 hash;
+  gint64 last_seen;
+  GList *node;
+  guint counts[];
+} SRTMergeEntry;
+
+static void
+gst_srt_object_link_free (GstSRTObject * link)
+{
+  gst_srt_object_close (link);
+  gst_srt_object_destroy (link);
+}
+
+/* Creates the link with index @index of the source, with the same settings
+ * as the main link. The URI can override them except for the local binding,
+ * which only the main link itself may keep as it can't be shared */
+static GstSRTObject *
+gst_srt_object_link_new (GstSRTObject * srtobject, const gchar * uri,
+    guint index)
+{
+  GstSRTObject *link = gst_srt_object_new (srtobject->element);
+  GstSRTConnectionMode connection_mode = GST_SRT_CONNECTION_MODE_NONE;
+  GError *error = NULL;
+
+  gst_structure_free (link->parameters);
+  link->parameters = gst_structure_copy (srtobject->parameters);
+  if (index > 0) {
+    gst_structure_remove_fields (link->parameters, "localaddress",
+        "localport", NULL);
+  }
+  link->passphrase = g_strdup (srtobject->passphrase);
+  link->link_index = index;
+
+  if (!gst_srt_object_set_uri (link, uri, &error))
+    goto failed;
+
+  gst_structure_get_enum (link->parameters, "mode",
+      GST_TYPE_SRT_CONNECTION_MODE, (gint *) & connection_mode);
+  if (connection_mode == GST_SRT_CONNECTION_MODE_LISTENER) {
+    g_set_error (&error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_SETTINGS,
+        "redundant links can't be listeners");
+    goto failed;
+  }
+
+  return link;
+
+failed:
+  GST_WARNING_OBJECT (srtobject->element, "Invalid redundant link %s: %s",
+      uri, error->message);
+  g_clear_error (&error);
+  gst_srt_object_link_free (link);
+
+  return NULL;
+}
+
+/* Called with the merge lock, starts connecting a link that is down and
+ * reads it together with the others. The connection completes in the
+ * background, a failure is reported by the poll like any lost link. */
+static void
+gst_srt_object_link_connect (GstSRTObject * srtobject, GstSRTObject * link)
+{
+  gint flags = SRT_EPOLL_IN | SRT_EPOLL_ERR;
+  GError *error = NULL;
+
+  /* a failed connect releases the poll of the link and every open creates
+   * a new listener poll */
+  if (link->poll_id == SRT_ERROR)
+    link->poll_id = srt_epoll_create ();
+  if (link->listener_poll_id != SRT_ERROR) {
+    srt_epoll_release (link->listener_poll_id);
+    link->listener_poll_id = SRT_ERROR;
+  }
+
+  if (!gst_srt_object_open (link, NULL, &error))
+    goto failed;
+
+  if (srt_epoll_add_usock (srtobject->merge_poll_id, link->sock, &flags)) {
+    g_set_error (&error, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_SETTINGS,
+        "%s", srt_getlasterror_str ());
+    gst_srt_object_close (link);
+    goto failed;
+  }
+
+  GST_DEBUG_OBJECT (srtobject->element, "Connecting redundant link %u (0x%x)",
+      link->link_index, link->sock);
+  srtobject->merge_n_polled++;
+  g_cond_broadcast (&srtobject->merge_cond);
+  return;
+
+failed:
+  GST_DEBUG_OBJECT (srtobject->element,
+      "Failed to connect redundant link %u: %s", link->link_index,
+      error->message);
+  g_clear_error (&error);
+}
+
+static gpointer
+gst_srt_object_merge_thread_func (GstSRTObject * srtobject)
+{
+  g_mutex_lock (&srtobject->merge_lock);
+  while (srtobject->merge_running) {
+    gint64 end_time = g_get_monotonic_time () + MERGE_RECONNECT_INTERVAL;
+    guint i;
+
+    for (i = 0; i < srtobject->links->len; i++) {
+      GstSRTObject *link = g_ptr_array_index (srtobject->links, i);
+
+      if (link->sock == SRT_INVALID_SOCK)
+        gst_srt_object_link_connect (srtobject, link);
+    }
+
+    while (srtobject->merge_running &&
+        g_cond_wait_until (&srtobject->merge_cond, &srtobject->merge_lock,
+            end_time));
+  }
+  g_mutex_unlock (&srtobject->merge_lock);
+
+  return NULL;
+}
+
+static void
+gst_srt_object_close_links (GstSRTObject * srtobject)
+{
+  if (!srtobject->links)
+    return;
+
+  g_mutex_lock (&srtobject->merge_lock);
+  srtobject->merge_running = FALSE;
+  g_cond_broadcast (&srtobject->merge_cond);
+  g_mutex_unlock (&srtobject->merge_lock);
+
+  if (srtobject->merge_thread) {
+    g_thread_join (srtobject->merge_thread);
+    srtobject->merge_thread = NULL;
+  }
+
+  g_clear_pointer (&srtobject->links, g_ptr_array_unref);
+
+  if (srtobject->merge_poll_id != SRT_ERROR) {
+    srt_epoll_release (srtobject->merge_poll_id);
+    srtobject->merge_poll_id = SRT_ERROR;
+  }
+
+  /* the entries are owned by the hash table */
+  g_queue_clear (&srtobject->merge_entries);
+  g_clear_pointer (&srtobject->merge_seen, g_hash_table_unref);
+  srtobject->merge_n_polled = 0;
+}
+
+/* Sets up the additional links of a source, the streams of all the
+ * connected sockets are then read through a single epoll. The links are
+ * connected by the merge thread, which keeps reconnecting those that fail
+ * or get lost later, including the main one. */
+static void
+gst_srt_object_open_links (GstSRTObject * srtobject)
+{
+  gint flags = SRT_EPOLL_IN | SRT_EPOLL_ERR;
+  gint latency;
+  gchar **uri;
+  guint index;
+
+  if (!gst_structure_get_int (srtobject->parameters, "latency", &latency))
+    latency = GST_SRT_DEFAULT_LATENCY;
+
+  srtobject->links =
+      g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_srt_object_link_free);
+  srtobject->merge_poll_id = srt_epoll_create ();
+  g_queue_init (&srtobject->merge_entries);
+  srtobject->merge_seen =
+      g_hash_table_new_full (g_int64_hash, g_int64_equal, NULL, g_free);
+  srtobject->merge_window_time =
+      MAX (2 * latency * G_TIME_SPAN_MILLISECOND, MERGE_WINDOW_MIN_TIME);
+  srtobject->merge_duplicates = 0;
+  srtobject->merge_n_polled = 0;
+
+  if (srt_epoll_add_usock (srtobject->merge_poll_id, srtobject->sock,
+          &flags) == 0)
+    srtobject->merge_n_polled++;
+
+  /* the main link has index 0 */
+  for (uri = srtobject->redundant_uris, index = 1; *uri; uri++, index++) {
+    GstSRTObject *link = gst_srt_object_link_new (srtobject, *uri, index);
+
+    if (link)
+      g_ptr_array_add (srtobject->links, link);
+  }
+  srtobject->merge_n_links = index;
+
+  srtobject->merge_running = TRUE;
+  srtobject->merge_thread = g_thread_new ("srt-merge",
+      (GThreadFunc) gst_srt_object_merge_thread_func, srtobject);
+}
+
+/* Called with the merge lock, returns the link index of @sock or -1 if it
+ * was already closed */
+static gint
+gst_srt_object_merge_find_link (GstSRTObject * srtobject, SRTSOCKET sock,
+    GstSRTObject ** link)
+{
+  guint i;
+
+  *link = NULL;
+
+  if (sock == srtobject->sock)
+    return 0;
+
+  for (i = 0; i < srtobject->links->len; i++) {
+    GstSRTObject *l = g_ptr_array_index (srtobject->links, i);
+
+    if (l->sock == sock) {
+      *link = l;
+      return l->link_index;
+    }
+  }
+
+  return -1;
+}
+
+/* Closes a lost link so that the merge thread reconnects it. The main
+ * socket is replaced by a link to the same URI. */
+static void
+gst_srt_object_merge_link_lost (GstSRTObject * srtobject, SRTSOCKET sock)
+{
+  GstSRTObject *link;
+  gint index;
+
+  g_mutex_lock (&srtobject->merge_lock);
+
+  index = gst_srt_object_merge_find_link (srtobject, sock, &link);
+  srt_epoll_remove_usock (srtobject->merge_poll_id, sock);
+  if (index < 0)
+    goto out;
+
+  srtobject->merge_n_polled--;
+  GST_WARNING_OBJECT (srtobject->element, "Lost link %d (0x%x), %u links "
+      "left, reconnecting", index, sock, srtobject->merge_n_polled);
+
+  if (link) {
+    gst_srt_object_close (link);
+  } else {
+    gchar *uri = gst_uri_to_string (srtobject->uri);
+
+    srt_epoll_remove_usock (srtobject->poll_id, srtobject->sock);
+    srt_close (srtobject->sock);
+    srtobject->sock = SRT_INVALID_SOCK;
+
+    link = gst_srt_object_link_new (srtobject, uri, 0);
+    if (link)
+      g_ptr_array_add (srtobject->links, link);
+    g_free (uri);
+  }
+
+out:
+  g_mutex_unlock (&srtobject->merge_lock);
+}
+
+/* Messages are merged by their content: the links are independent SRT
+ * connections so neither their sequence nor their message numbers can be
+ * compared, and the source time is stamped by each of them. The same
+ * sender emits the same payloads on all of them though. */
+static guint64
+srt_payload_hash (const guint8 * data, gsize size)
+{
+  guint64 hash = G_GUINT64_CONSTANT (0xcbf29ce484222325) ^ size;
+
+  for (; size >= 8; data += 8, size -= 8) {
+    guint64 v;
+
+    memcpy (&v, data, 8);
+    hash = (hash ^ v) * G_GUINT64_CONSTANT (0x100000001b3);
+    hash ^= hash >> 32;
+  }
+
+  for (; size > 0; data++, size--)
+    hash = (hash ^ *data) * G_GUINT64_CONSTANT (0x100000001b3);
+
+  return hash;
+}
+
+/* A payload can legitimately repeat in the stream (e.g. MPEG-TS null
+ * packets), so it is counted per link: the n-th copy received over a link
+ * is only new if no other link delivered its n-th copy yet. A payload is
+ * forgotten once no link received it for the merge window time. */
+static gboolean
+gst_srt_object_merge_is_duplicate (GstSRTObject * srtobject, guint index,
+    const guint8 * data, gsize size)
+{
+  gint64 now = g_get_monotonic_time ();
+  guint64 hash = srt_payload_hash (data, size);
+  SRTMergeEntry *entry;
+  gboolean duplicate = FALSE;
+  guint i;
+
+  while ((entry = g_queue_peek_head (&srtobject->merge_entries)) &&
+      (now - entry->last_seen > srtobject->merge_window_time ||
+          srtobject->merge_entries.length >= MERGE_WINDOW_SIZE)) {
+    g_queue_pop_head (&srtobject->merge_entries);
+    g_hash_table_remove (srtobject->merge_seen, &entry->hash);
+  }
+
+  entry = g_hash_table_lookup (srtobject->merge_seen, &hash);
+  if (entry) {
+    g_queue_unlink (&srtobject->merge_entries, entry->node);
+    g_queue_push_tail_link (&srtobject->merge_entries, entry->node);
+  } else {
+    entry = g_malloc0 (sizeof (SRTMergeEntry) +
+        srtobject->merge_n_links * sizeof (guint));
+    entry->hash = hash;
+    g_hash_table_insert (srtobject->merge_seen, &entry->hash, entry);
+    g_queue_push_tail (&srtobject->merge_entries, entry);
+    entry->node = srtobject->merge_entries.tail;
+  }
+
+  entry->last_seen = now;
+  entry->counts[index]++;
+  for (i = 0; i < srtobject->merge_n_links; i++) {
+    if (i != index && entry->counts[i] >= entry->counts[index])
+      duplicate = TRUE;
+  }
+
+  if (duplicate)
+    srtobject->merge_duplicates++;
+
+  return duplicate;
+}
+
 gboolean
 gst_srt_object_open (GstSRTObject * srtobject, GCancellable * cancellable,
     GError ** error)
@@ -1036,6 +1550,16 @@ gst_srt_object_open_full (GstSRTObject * srtobject,
       gst_srt_object_open_connection
       (srtobject, cancellable, connection_mode, sa, sa_len, error);
 
+  if (srtobject->opened && srtobject->redundant_uris
+      && srtobject->redundant_uris[0]) {
+    if (connection_mode == GST_SRT_CONNECTION_MODE_LISTENER) {
+      GST_WARNING_OBJECT (srtobject->element,
+          "Redundant links are not supported in listener mode");
+    } else {
+      gst_srt_object_open_links (srtobject);
+    }
+  }
+
 out:
   g_clear_object (&socket_address);
 
@@ -1045,6 +1569,8 @@ out:
 void
 gst_srt_object_close (GstSRTObject * srtobject)
 {
+  gst_srt_object_close_links (srtobject);
+
   if (srtobject->poll_id != SRT_ERROR) {
     srt_epoll_remove_usock (srtobject->poll_id, srtobject->sock);
   }
@@ -1082,9 +1608,13 @@ gst_srt_object_close (GstSRTObject * srtobject)
     srtobject->listener_sock = SRT_INVALID_SOCK;
   }
 
+  gst_srt_object_stop_sender (srtobject);
+
   g_list_foreach (srtobject->callers, (GFunc) srt_caller_invoke_removed_closure,
       srtobject);
   g_list_free_full (srtobject->callers, (GDestroyNotify) srt_caller_free);
+  srtobject->callers = NULL;
+  srtobject->callers_dropped = 0;
 
   g_clear_pointer (&srtobject->caller_added_closure, g_closure_unref);
   g_clear_pointer (&srtobject->caller_removed_closure, g_closure_unref);
@@ -1109,6 +1639,94 @@ gst_srt_object_wait_caller (GstSRTObject * srtobject,
   return TRUE;
 }
 
+/* Reads from the main socket and the redundant links at once, skipping the
+ * messages already received over another link */
+static gssize
+gst_srt_object_read_merged (GstSRTObject * srtobject,
+    guint8 * data, gsize size, GCancellable * cancellable, GError ** error)
+{
+  gssize len = 0;
+  gint poll_timeout;
+  gint msg_size;
+
+  if (!gst_structure_get_int (srtobject->parameters, "poll-timeout",
+          &poll_timeout)) {
+    poll_timeout = GST_SRT_DEFAULT_POLL_TIMEOUT;
+  }
+
+  if (!gst_structure_get_int (srtobject->parameters, "msg-size", &msg_size)) {
+    msg_size = GST_SRT_DEFAULT_MSG_SIZE;
+  }
+
+  while (!g_cancellable_is_cancelled (cancellable)) {
+    SRTSOCKET rsocks[16];
+    gint rsocklen = G_N_ELEMENTS (rsocks);
+    gint i;
+
+    /* all links are down, wait for the merge thread to reconnect one */
+    g_mutex_lock (&srtobject->merge_lock);
+    while (srtobject->merge_n_polled == 0 &&
+        !g_cancellable_is_cancelled (cancellable))
+      g_cond_wait (&srtobject->merge_cond, &srtobject->merge_lock);
+    g_mutex_unlock (&srtobject->merge_lock);
+
+    if (srt_epoll_wait (srtobject->merge_poll_id, rsocks,
+            &rsocklen, 0, 0, poll_timeout, NULL, 0, NULL, 0) < 0) {
+      continue;
+    }
+
+    for (i = 0; i < rsocklen; i++) {
+      SRTSOCKET rsock = rsocks[i];
+      GstSRTObject *link;
+      gint index;
+
+      switch (srt_getsockstate (rsock)) {
+        case SRTS_BROKEN:
+        case SRTS_NONEXIST:
+        case SRTS_CLOSED:
+          gst_srt_object_merge_link_lost (srtobject, rsock);
+          continue;
+        case SRTS_CONNECTED:
+          /* good to go */
+          break;
+        default:
+          /* not-ready */
+          continue;
+      }
+
+      g_mutex_lock (&srtobject->merge_lock);
+      index = gst_srt_object_merge_find_link (srtobject, rsock, &link);
+      g_mutex_unlock (&srtobject->merge_lock);
+      if (index < 0)
+        continue;
+
+      /* Same workaround as in gst_srt_object_read() for SRT being unhappy
+       * about buffers that are less than the chunk size */
+      while (size - len >= msg_size) {
+        gint recv;
+
+        recv = srt_recvmsg (rsock, (char *) (data + len), size - len);
+        if (recv <= 0)
+          break;
+
+        if (gst_srt_object_merge_is_duplicate (srtobject, index, data + len,
+                recv)) {
+          GST_TRACE_OBJECT (srtobject->element,
+              "Dropping duplicate of %d bytes from link %d", recv, index);
+          continue;
+        }
+
+        len += recv;
+      }
+    }
+
+    if (len > 0 || size < msg_size)
+      break;
+  }
+
+  return len;
+}
+
 gssize
 gst_srt_object_read (GstSRTObject * srtobject,
     guint8 * data, gsize size, GCancellable * cancellable, GError ** error)
@@ -1123,6 +1741,11 @@ gst_srt_object_read (GstSRTObject * srtobject,
   g_return_val_if_fail (gst_uri_handler_get_uri_type (GST_URI_HANDLER
           (srtobject->element)) == GST_URI_SRC, -1);
 
+  if (srtobject->links) {
+    return gst_srt_object_read_merged (srtobject, data, size, cancellable,
+        error);
+  }
+
   gst_structure_get_enum (srtobject->parameters, "mode",
       GST_TYPE_SRT_CONNECTION_MODE, (gint *) & connection_mode);
 
@@ -1224,6 +1847,19 @@ gst_srt_object_wakeup (GstSRTObject * srtobject)
    * wakes up SRT's threads. We only have one to remove. */
   srt_epoll_remove_usock (srtobject->poll_id, srtobject->sock);
 
+  if (srtobject->links) {
+    guint i;
+
+    g_mutex_lock (&srtobject->merge_lock);
+    srt_epoll_remove_usock (srtobject->merge_poll_id, srtobject->sock);
+    for (i = 0; i < srtobject->links->len; i++) {
+      GstSRTObject *link = g_ptr_array_index (srtobject->links, i);
+      srt_epoll_remove_usock (srtobject->merge_poll_id, link->sock);
+    }
+    g_cond_broadcast (&srtobject->merge_cond);
+    g_mutex_unlock (&srtobject->merge_lock);
+  }
+
   gst_structure_get_enum (srtobject->parameters, "mode",
       GST_TYPE_SRT_CONNECTION_MODE, (gint *) & connection_mode);
 
@@ -1287,57 +1923,472 @@ gst_srt_object_send_headers (GstSRTObject * srtobject, SRTSOCKET sock,
   return TRUE;
 }
 
-static gssize
-gst_srt_object_write_to_callers (GstSRTObject * srtobject,
-    GstBufferList * headers,
-    const GstMapInfo * mapinfo, GCancellable * cancellable, GError ** error)
+typedef enum
 {
-  GList *callers = srtobject->callers;
+  SRT_CALLER_SEND_DONE,
+  SRT_CALLER_SEND_BLOCKED,
+  SRT_CALLER_SEND_FAILED,
+} SRTCallerSendResult;
+
+/* Called from the sender thread with the object lock held, which is released
+ * around each send. The head of the queue stays in place meanwhile, see
+ * srt_caller_enqueue(), and callers are only removed by the sender thread
+ * while it runs */
+static SRTCallerSendResult
+srt_caller_send_queued (GstSRTObject * srtobject, SRTCaller * caller)
+{
+  SRTMessage *msg;
 
-  GST_OBJECT_LOCK (srtobject->element);
-  while (callers != NULL) {
-    gssize len = 0;
-    const guint8 *msg = mapinfo->data;
+  while ((msg = g_queue_peek_head (&caller->queue)) != NULL) {
+    gsize offset = caller->offset;
     gint sent;
 
+    caller->sending = TRUE;
+    GST_OBJECT_UNLOCK (srtobject->element);
+
+    sent = srt_sendmsg2 (caller->sock, (char *) (msg->map.data + offset),
+        msg->map.size - offset, 0);
+
+    GST_OBJECT_LOCK (srtobject->element);
+    caller->sending = FALSE;
+
+    if (sent < 0) {
+      if (srt_getlasterror (NULL) == SRT_EASYNCSND)
+        return SRT_CALLER_SEND_BLOCKED;
+
+      GST_WARNING_OBJECT (srtobject->element,
+          "Failed to send to caller (0x%x): %s", caller->sock,
+          srt_getlasterror_str ());
+      return SRT_CALLER_SEND_FAILED;
+    }
+
+    caller->offset += sent;
+    if (caller->offset < msg->map.size)
+      continue;
+
+    caller->offset = 0;
+    g_queue_pop_head (&caller->queue);
+    srt_message_unref (msg);
+  }
+
+  return SRT_CALLER_SEND_DONE;
+}
+
+/* Called with the object lock held, returns FALSE if the caller has to be
+ * disconnected */
+static gboolean
+srt_caller_enqueue (GstSRTObject * srtobject, SRTCaller * caller,
+    SRTMessage * msg, guint max_queue, GstSRTCallerDropPolicy drop_policy)
+{
+  if (max_queue > 0 && g_queue_get_length (&caller->queue) >= max_queue) {
+    switch (drop_policy) {
+      case GST_SRT_CALLER_DROP_POLICY_DISCONNECT:
+        return FALSE;
+      case GST_SRT_CALLER_DROP_POLICY_DROP_NEWEST:
+        caller->dropped++;
+        srtobject->callers_dropped++;
+        GST_LOG_OBJECT (srtobject->element, "Caller (0x%x) queue full, "
+            "dropping new buffer (%" G_GUINT64_FORMAT " dropped)",
+            caller->sock, caller->dropped);
+        return TRUE;
+      case GST_SRT_CALLER_DROP_POLICY_DROP_OLDEST:{
+        GList *l;
+
+        /* Keep the stream headers and a message that is being sent */
+        l = caller->queue.head;
+        if (l && (caller->offset > 0 || caller->sending))
+          l = l->next;
+        while (l && ((SRTMessage *) l->data)->is_header)
+          l = l->next;
+
+        if (l) {
+          srt_message_unref (l->data);
+          g_queue_delete_link (&caller->queue, l);
+          caller->dropped++;
+          srtobject->callers_dropped++;
+          GST_LOG_OBJECT (srtobject->element, "Caller (0x%x) queue full, "
+              "dropping oldest buffer (%" G_GUINT64_FORMAT " dropped)",
+              caller->sock, caller->dropped);
+        }
+        break;
+      }
+    }
+  }
+
+  g_queue_push_tail (&caller->queue, srt_message_ref (msg));
+
+  return TRUE;
+}
+
+/* Called with the object lock held, adds the caller to or removes it from
+ * the sockets the sender thread waits for */
+static void
+srt_caller_set_blocked (GstSRTObject * srtobject, SRTCaller * caller,
+    gboolean blocked)
+{
+  gint flags = SRT_EPOLL_OUT | SRT_EPOLL_ERR;
+
+  if (caller->blocked == blocked)
+    return;
+
+  if (blocked) {
+    if (srt_epoll_add_usock (srtobject->sender_poll_id, caller->sock,
+            &flags)) {
+      GST_WARNING_OBJECT (srtobject->element, "Could not wait for caller "
+          "(0x%x): %s", caller->sock, srt_getlasterror_str ());
+      return;
+    }
+    srtobject->sender_n_blocked++;
+  } else {
+    srt_epoll_remove_usock (srtobject->sender_poll_id, caller->sock);
+    srtobject->sender_n_blocked--;
+  }
+
+  caller->blocked = blocked;
+}
+
+/* Called with the object lock held, the caller is freed by the caller of
+ * this function after releasing the lock */
+static void
+gst_srt_object_remove_caller_locked (GstSRTObject * srtobject,
+    SRTCaller * caller)
+{
+  srt_caller_set_blocked (srtobject, caller, FALSE);
+  srtobject->callers = g_list_remove (srtobject->callers, caller);
+  srt_caller_invoke_removed_closure (caller, srtobject);
+}
+
+/* Called with the object lock held */
+static void
+gst_srt_object_wake_sender_locked (GstSRTObject * srtobject)
+{
+  srtobject->sender_pending = TRUE;
+  g_cond_signal (&srtobject->sender_cond);
+  if (srtobject->sender_wakeup)
+    g_cancellable_cancel (srtobject->sender_wakeup);
+}
+
+/* Called from the sender thread with the object lock held, which is released
+ * while sending */
+static void
+gst_srt_object_send_to_callers_locked (GstSRTObject * srtobject)
+{
+  GList *callers, *removed = NULL;
+
+  callers = srtobject->callers;
+  while (callers != NULL) {
     SRTCaller *caller = callers->data;
     callers = callers->next;
 
-    if (g_cancellable_is_cancelled (cancellable)) {
-      GST_OBJECT_UNLOCK (srtobject->element);
-      return -1;
+    if (caller->disconnect) {
+      GST_WARNING_OBJECT (srtobject->element,
+          "Caller (0x%x) queue full, disconnecting", caller->sock);
+      gst_srt_object_remove_caller_locked (srtobject, caller);
+      removed = g_list_prepend (removed, caller);
+      continue;
     }
 
-    if (!caller->sent_headers) {
-      if (!gst_srt_object_send_headers (srtobject, caller->sock, -1,
-              -1, headers, cancellable)) {
-        goto err;
-      }
-      caller->sent_headers = TRUE;
+    if (caller->blocked)
+      continue;
+
+    /* The listener may append callers while the lock is released, but
+     * nothing else removes them from the list, so callers stays valid */
+    switch (srt_caller_send_queued (srtobject, caller)) {
+      case SRT_CALLER_SEND_DONE:
+        break;
+      case SRT_CALLER_SEND_BLOCKED:
+        srt_caller_set_blocked (srtobject, caller, TRUE);
+        break;
+      case SRT_CALLER_SEND_FAILED:
+        gst_srt_object_remove_caller_locked (srtobject, caller);
+        removed = g_list_prepend (removed, caller);
+        break;
     }
+  }
+
+  if (removed) {
+    GST_OBJECT_UNLOCK (srtobject->element);
+    g_list_free_full (removed, (GDestroyNotify) srt_caller_free);
+    GST_OBJECT_LOCK (srtobject->element);
+  }
+}
 
-    while (len < mapinfo->size) {
-      gint rest = mapinfo->size - len;
-      sent = srt_sendmsg2 (caller->sock, (char *) (msg + len), rest, 0);
-      if (sent < 0) {
-        goto err;
+/* Called from the sender thread without the object lock, waits until a
+ * blocked caller can be written to again or new data is queued. Returns
+ * FALSE if waiting failed */
+static gboolean
+gst_srt_object_sender_wait (GstSRTObject * srtobject)
+{
+  SRTSOCKET wsocks[SENDER_MAX_EVENTS];
+  SYSSOCKET rfds[1];
+  gint wsockslen = G_N_ELEMENTS (wsocks);
+  gint rfdslen = G_N_ELEMENTS (rfds);
+  gint64 timeout;
+  GList *callers;
+  gint i;
+
+  timeout = srtobject->sender_wakeup_fd >= 0 ? -1 : SENDER_POLL_TIMEOUT;
+
+  if (srt_epoll_wait (srtobject->sender_poll_id, NULL, NULL, wsocks,
+          &wsockslen, timeout, rfds, &rfdslen, NULL, NULL) < 0) {
+    if (srt_getlasterror (NULL) == SRT_ETIMEOUT)
+      return TRUE;
+
+    GST_WARNING_OBJECT (srtobject->element, "Waiting for callers failed: %s",
+        srt_getlasterror_str ());
+    return FALSE;
+  }
+
+  GST_OBJECT_LOCK (srtobject->element);
+  for (i = 0; i < MIN (wsockslen, (gint) G_N_ELEMENTS (wsocks)); i++) {
+    for (callers = srtobject->callers; callers; callers = callers->next) {
+      SRTCaller *caller = callers->data;
+
+      if (caller->sock == wsocks[i]) {
+        srt_caller_set_blocked (srtobject, caller, FALSE);
+        srtobject->sender_pending = TRUE;
+        break;
       }
-      len += sent;
     }
+  }
+  GST_OBJECT_UNLOCK (srtobject->element);
+
+  return TRUE;
+}
+
+static gpointer
+gst_srt_object_sender_thread_func (GstSRTObject * srtobject)
+{
+  GMutex *lock = GST_OBJECT_GET_LOCK (srtobject->element);
+  GList *callers;
+
+  GST_DEBUG_OBJECT (srtobject->element, "Sender thread started");
+
+  GST_OBJECT_LOCK (srtobject->element);
+  while (srtobject->sender_running) {
+    srtobject->sender_pending = FALSE;
+    if (srtobject->sender_wakeup)
+      g_cancellable_reset (srtobject->sender_wakeup);
+
+    gst_srt_object_send_to_callers_locked (srtobject);
+
+    if (srtobject->sender_pending || !srtobject->sender_running)
+      continue;
 
-    continue;
+    if (srtobject->sender_n_blocked == 0) {
+      g_cond_wait (&srtobject->sender_cond, lock);
+      continue;
+    }
 
-  err:
-    srtobject->callers = g_list_remove (srtobject->callers, caller);
-    srt_caller_invoke_removed_closure (caller, srtobject);
     GST_OBJECT_UNLOCK (srtobject->element);
-    srt_caller_free (caller);
+    if (gst_srt_object_sender_wait (srtobject)) {
+      GST_OBJECT_LOCK (srtobject->element);
+      continue;
+    }
     GST_OBJECT_LOCK (srtobject->element);
+
+    /* don't spin on a failing wait, just retry the blocked callers */
+    if (!srtobject->sender_pending && srtobject->sender_running)
+      g_cond_wait_until (&srtobject->sender_cond, lock,
+          g_get_monotonic_time () +
+          SENDER_POLL_TIMEOUT * G_TIME_SPAN_MILLISECOND);
+    for (callers = srtobject->callers; callers; callers = callers->next)
+      srt_caller_set_blocked (srtobject, callers->data, FALSE);
   }
+  GST_OBJECT_UNLOCK (srtobject->element);
+
+  GST_DEBUG_OBJECT (srtobject->element, "Sender thread stopped");
+
+  return NULL;
+}
+
+/* Called with the object lock held */
+static gboolean
+gst_srt_object_start_sender_locked (GstSRTObject * srtobject, GError ** error)
+{
+  srtobject->sender_poll_id = srt_epoll_create ();
+  srtobject->sender_n_blocked = 0;
+
+  /* Where the cancellable has a file descriptor, new data wakes up the
+   * sender thread while it waits for blocked callers, otherwise it checks
+   * for new data every SENDER_POLL_TIMEOUT then */
+  srtobject->sender_wakeup = g_cancellable_new ();
+  srtobject->sender_wakeup_fd = g_cancellable_get_fd (srtobject->sender_wakeup);
+  if (srtobject->sender_wakeup_fd >= 0) {
+    gint flags = SRT_EPOLL_IN;
+
+    if (srt_epoll_add_ssock (srtobject->sender_poll_id,
+            srtobject->sender_wakeup_fd, &flags)) {
+      g_cancellable_release_fd (srtobject->sender_wakeup);
+      srtobject->sender_wakeup_fd = -1;
+    }
+  }
+
+  srtobject->sender_running = TRUE;
+  srtobject->sender_thread = g_thread_try_new ("GstSRTObjectSender",
+      (GThreadFunc) gst_srt_object_sender_thread_func, srtobject, error);
+
+  if (!srtobject->sender_thread) {
+    srtobject->sender_running = FALSE;
+    if (srtobject->sender_wakeup_fd >= 0) {
+      g_cancellable_release_fd (srtobject->sender_wakeup);
+      srtobject->sender_wakeup_fd = -1;
+    }
+    g_clear_object (&srtobject->sender_wakeup);
+    srt_epoll_release (srtobject->sender_poll_id);
+    srtobject->sender_poll_id = SRT_ERROR;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+gst_srt_object_stop_sender (GstSRTObject * srtobject)
+{
+  GList *callers;
+
+  if (srtobject->sender_poll_id == SRT_ERROR)
+    return;
+
+  GST_OBJECT_LOCK (srtobject->element);
+  srtobject->sender_running = FALSE;
+  gst_srt_object_wake_sender_locked (srtobject);
+  GST_OBJECT_UNLOCK (srtobject->element);
+
+  if (srtobject->sender_thread) {
+    g_thread_join (srtobject->sender_thread);
+    srtobject->sender_thread = NULL;
+  }
+
+  for (callers = srtobject->callers; callers; callers = callers->next)
+    ((SRTCaller *) callers->data)->blocked = FALSE;
+
+  if (srtobject->sender_wakeup_fd >= 0) {
+    g_cancellable_release_fd (srtobject->sender_wakeup);
+    srtobject->sender_wakeup_fd = -1;
+  }
+  g_clear_object (&srtobject->sender_wakeup);
+
+  srt_epoll_release (srtobject->sender_poll_id);
+  srtobject->sender_poll_id = SRT_ERROR;
+
+  g_clear_pointer (&srtobject->header_messages, g_ptr_array_unref);
+  g_clear_pointer (&srtobject->headers, gst_buffer_list_unref);
+}
+
+/* Called with the object lock held */
+static void
+gst_srt_object_update_header_messages (GstSRTObject * srtobject,
+    GstBufferList * headers)
+{
+  guint i, size;
+
+  if (srtobject->headers == headers)
+    return;
+
+  g_clear_pointer (&srtobject->header_messages, g_ptr_array_unref);
+  g_clear_pointer (&srtobject->headers, gst_buffer_list_unref);
+
+  if (!headers)
+    return;
+
+  srtobject->headers = gst_buffer_list_ref (headers);
+
+  size = gst_buffer_list_length (headers);
+  srtobject->header_messages =
+      g_ptr_array_new_full (size, (GDestroyNotify) srt_message_unref);
+
+  for (i = 0; i < size; i++) {
+    SRTMessage *msg = srt_message_new (gst_buffer_list_get (headers, i));
+
+    if (!msg) {
+      GST_WARNING_OBJECT (srtobject->element, "Could not map header %u", i);
+      continue;
+    }
+
+    msg->is_header = TRUE;
+    g_ptr_array_add (srtobject->header_messages, msg);
+  }
+}
+
+static gssize
+gst_srt_object_write_to_callers (GstSRTObject * srtobject,
+    GstBufferList * headers,
+    GstBuffer * buffer, GCancellable * cancellable, GError ** error)
+{
+  GList *callers;
+  SRTMessage *msg;
+  guint max_queue;
+  GstSRTCallerDropPolicy drop_policy;
+
+  /* Map once, the message is shared by the queues of all callers */
+  msg = srt_message_new (buffer);
+  if (!msg) {
+    GST_ELEMENT_ERROR (srtobject->element, RESOURCE, READ,
+        ("Could not map the input stream"), (NULL));
+    return -1;
+  }
+
+  GST_OBJECT_LOCK (srtobject->element);
+
+  if (g_cancellable_is_cancelled (cancellable)) {
+    GST_OBJECT_UNLOCK (srtobject->element);
+    srt_message_unref (msg);
+    return -1;
+  }
+
+  if (!srtobject->sender_thread &&
+      !gst_srt_object_start_sender_locked (srtobject, error)) {
+    GST_OBJECT_UNLOCK (srtobject->element);
+    srt_message_unref (msg);
+    return -1;
+  }
+
+  if (!gst_structure_get_uint (srtobject->parameters, "caller-queue-size",
+          &max_queue)) {
+    max_queue = GST_SRT_DEFAULT_CALLER_QUEUE_SIZE;
+  }
+
+  if (!gst_structure_get_enum (srtobject->parameters, "caller-drop-policy",
+          GST_TYPE_SRT_CALLER_DROP_POLICY, (gint *) & drop_policy)) {
+    drop_policy = GST_SRT_DEFAULT_CALLER_DROP_POLICY;
+  }
+
+  gst_srt_object_update_header_messages (srtobject, headers);
+
+  callers = srtobject->callers;
+  while (callers != NULL) {
+    SRTCaller *caller = callers->data;
+    callers = callers->next;
+
+    if (caller->disconnect)
+      continue;
+
+    if (!caller->sent_headers) {
+      guint i;
+
+      for (i = 0; srtobject->header_messages &&
+          i < srtobject->header_messages->len; i++) {
+        g_queue_push_tail (&caller->queue,
+            srt_message_ref (g_ptr_array_index (srtobject->header_messages,
+                    i)));
+      }
+      caller->sent_headers = TRUE;
+    }
+
+    /* the sender thread disconnects it, it may be sending to it right now */
+    if (!srt_caller_enqueue (srtobject, caller, msg, max_queue, drop_policy))
+      caller->disconnect = TRUE;
+  }
+
+  gst_srt_object_wake_sender_locked (srtobject);
 
   GST_OBJECT_UNLOCK (srtobject->element);
 
-  return mapinfo->size;
+  srt_message_unref (msg);
+
+  return gst_buffer_get_size (buffer);
 }
 
 static gssize
@@ -1414,7 +2465,7 @@ gst_srt_object_write_one (GstSRTObject * srtobject,
 gssize
 gst_srt_object_write (GstSRTObject * srtobject,
     GstBufferList * headers,
-    const GstMapInfo * mapinfo, GCancellable * cancellable, GError ** error)
+    GstBuffer * buffer, GCancellable * cancellable, GError ** error)
 {
   gssize len = 0;
   GstSRTConnectionMode connection_mode = GST_SRT_CONNECTION_MODE_NONE;
@@ -1433,12 +2484,22 @@ gst_srt_object_write (GstSRTObject * srtobject,
       }
     }
     len =
-        gst_srt_object_write_to_callers (srtobject, headers, mapinfo,
+        gst_srt_object_write_to_callers (srtobject, headers, buffer,
         cancellable, error);
   } else {
+    GstMapInfo mapinfo;
+
+    if (!gst_buffer_map (buffer, &mapinfo, GST_MAP_READ)) {
+      GST_ELEMENT_ERROR (srtobject->element, RESOURCE, READ,
+          ("Could not map the input stream"), (NULL));
+      return -1;
+    }
+
     len =
-        gst_srt_object_write_one (srtobject, headers, mapinfo, cancellable,
+        gst_srt_object_write_one (srtobject, headers, &mapinfo, cancellable,
         error);
+
+    gst_buffer_unmap (buffer, &mapinfo);
   }
 
   return len;
@@ -1451,6 +2512,47 @@ gst_srt_object_get_stats (GstSRTObject * srtobject)
   int ret;
   GstStructure *s = gst_structure_new_empty ("application/x-srt-statistics");
 
+  if (srtobject->listener_sock != SRT_INVALID_SOCK) {
+    guint n_callers = 0;
+    GList *callers;
+
+    GST_OBJECT_LOCK (srtobject->element);
+    for (callers = srtobject->callers; callers; callers = callers->next) {
+      if (!((SRTCaller *) callers->data)->disconnect)
+        n_callers++;
+    }
+    gst_structure_set (s,
+        /* number of connected callers, without those being disconnected */
+        "callers", G_TYPE_UINT, n_callers,
+        /* number of buffers dropped for callers that couldn't keep up */
+        "caller-buffers-dropped", G_TYPE_UINT64, srtobject->callers_dropped,
+        NULL);
+    GST_OBJECT_UNLOCK (srtobject->element);
+  }
+
+  if (srtobject->links) {
+    guint n_links = 0, i;
+
+    g_mutex_lock (&srtobject->merge_lock);
+    if (srtobject->sock != SRT_INVALID_SOCK &&
+        srt_getsockstate (srtobject->sock) == SRTS_CONNECTED)
+      n_links++;
+    for (i = 0; i < srtobject->links->len; i++) {
+      GstSRTObject *link = g_ptr_array_index (srtobject->links, i);
+
+      if (link->sock != SRT_INVALID_SOCK &&
+          srt_getsockstate (link->sock) == SRTS_CONNECTED)
+        n_links++;
+    }
+    gst_structure_set (s,
+        /* number of links connected, including the main one */
+        "links", G_TYPE_UINT, n_links,
+        /* number of messages dropped as already received on another link */
+        "duplicates-dropped", G_TYPE_UINT64, srtobject->merge_duplicates,
+        NULL);
+    g_mutex_unlock (&srtobject->merge_lock);
+  }
+
   /* FIXME: what if ruinning on listener mode */
   if (srtobject->sock == SRT_INVALID_SOCK)
     return s;
@@ -41,6 +41,8 @@ G_BEGIN_DECLS
 #define GST_SRT_DEFAULT_POLL_TIMEOUT -1
 #define GST_SRT_DEFAULT_LATENCY 125
 #define GST_SRT_DEFAULT_MSG_SIZE 1316
+#define GST_SRT_DEFAULT_CALLER_QUEUE_SIZE 64
+#define GST_SRT_DEFAULT_CALLER_DROP_POLICY GST_SRT_CALLER_DROP_POLICY_DROP_OLDEST
 
 typedef struct _GstSRTObject GstSRTObject;
 
@@ -73,6 +75,41 @@ struct _GstSRTObject
   GClosure                     *caller_removed_closure;
 
   gchar                        *passphrase;
+
+  /* sends the queued messages to the callers in listener mode,
+   * protected by the element's object lock. Blocked callers are waited
+   * for through sender_poll_id, which sender_wakeup also wakes up */
+  GThread                      *sender_thread;
+  GCond                         sender_cond;
+  gboolean                      sender_running;
+  gboolean                      sender_pending;
+  gint                          sender_poll_id;
+  GCancellable                 *sender_wakeup;
+  gint                          sender_wakeup_fd;
+  guint                         sender_n_blocked;
+  /* buffers dropped by the caller-drop-policy, over all callers */
+  guint64                       callers_dropped;
+  GstBufferList                *headers;
+  GPtrArray                    *header_messages;
+
+  /* additional links carrying the same stream in a source, read together
+   * with the main socket through merge_poll_id and deduplicated. The links
+   * that are down are reconnected by merge_thread, which also protects
+   * the links, the main socket and merge_n_polled with merge_lock */
+  gchar                       **redundant_uris;
+  GPtrArray                    *links;
+  guint                         link_index;
+  gint                          merge_poll_id;
+  guint                         merge_n_polled;
+  guint                         merge_n_links;
+  GMutex                        merge_lock;
+  GCond                         merge_cond;
+  GThread                      *merge_thread;
+  gboolean                      merge_running;
+  GQueue                        merge_entries;
+  GHashTable                   *merge_seen;
+  gint64                        merge_window_time;
+  guint64                       merge_duplicates;
 };
 
 
@@ -106,6 +143,10 @@ gboolean        gst_srt_object_get_property_helper (GstSRTObject *srtobject,
 
 void            gst_srt_object_install_properties_helper (GObjectClass *gobject_class);
 
+void            gst_srt_object_install_sink_properties_helper (GObjectClass *gobject_class);
+
+void            gst_srt_object_install_src_properties_helper (GObjectClass *gobject_class);
+
 gboolean        gst_srt_object_set_uri (GstSRTObject * srtobject, const gchar *uri, GError ** err);
 
 gssize          gst_srt_object_read     (GstSRTObject * srtobject, 
@@ -115,7 +156,7 @@ gssize          gst_srt_object_read     (GstSRTObject * srtobject,
 
 gssize          gst_srt_object_write    (GstSRTObject * srtobject, 
                                          GstBufferList * headers,
-                                         const GstMapInfo * mapinfo,
+                                         GstBuffer * buffer,
                                          GCancellable *cancellable,
                                          GError **err);
 
@@ -35,6 +35,11 @@
  * |[
  * gst-launch-1.0 -v audiotestsrc ! srtsink uri=srt://:port
  * ]| This pipeline shows how to wait SRT callers.
+ *
+ * In listener mode every buffer is queued once for all connected callers
+ * and sent from a separate thread, so a slow caller does not hold back the
+ * others. See #GstSRTSink:caller-queue-size and
+ * #GstSRTSink:caller-drop-policy.
  * </refsect2>
  * 
  */
@@ -177,7 +182,6 @@ gst_srt_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
   GstSRTSink *self = GST_SRT_SINK (sink);
   GstFlowReturn ret = GST_FLOW_OK;
-  GstMapInfo info;
   GError *error = NULL;
 
   if (g_cancellable_is_cancelled (self->cancellable)) {
@@ -190,19 +194,15 @@ gst_srt_sink_render (GstBaseSink * sink, GstBuffer * buffer)
     return GST_FLOW_OK;
   }
 
-  if (!gst_buffer_map (buffer, &info, GST_MAP_READ)) {
-    GST_ELEMENT_ERROR (self, RESOURCE, READ,
-        ("Could not map the input stream"), (NULL));
-    return GST_FLOW_ERROR;
-  }
-
-  if (gst_srt_object_write (self->srtobject, self->headers, &info,
+  if (gst_srt_object_write (self->srtobject, self->headers, buffer,
           self->cancellable, &error) < 0) {
+    if (error) {
+      GST_ELEMENT_ERROR (self, RESOURCE, WRITE, NULL, ("%s", error->message));
+      g_clear_error (&error);
+    }
     ret = GST_FLOW_ERROR;
   }
 
-  gst_buffer_unmap (buffer, &info);
-
   GST_TRACE_OBJECT (self, "sending buffer %p, offset %"
       G_GINT64_FORMAT ", offset_end %" G_GINT64_FORMAT
       ", timestamp %" GST_TIME_FORMAT ", duration %" GST_TIME_FORMAT
@@ -327,6 +327,7 @@ gst_srt_sink_class_init (GstSRTSinkClass * klass)
       2, G_TYPE_INT, G_TYPE_SOCKET_ADDRESS);
 
   gst_srt_object_install_properties_helper (gobject_class);
+  gst_srt_object_install_sink_properties_helper (gobject_class);
 
   gst_element_class_add_static_pad_template (gstelement_class, &sink_template);
   gst_element_class_set_metadata (gstelement_class,
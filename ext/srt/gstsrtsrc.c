@@ -297,6 +297,7 @@ gst_srt_src_class_init (GstSRTSrcClass * klass)
       2, G_TYPE_INT, G_TYPE_SOCKET_ADDRESS);
 
   gst_srt_object_install_properties_helper (gobject_class);
+  gst_srt_object_install_src_properties_helper (gobject_class);
 
   gst_element_class_add_static_pad_template (gstelement_class, &src_template);
   gst_element_class_set_metadata (gstelement_class,
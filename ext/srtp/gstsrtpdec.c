@@ -205,6 +205,10 @@ static GstIterator *gst_srtp_dec_iterate_internal_links_rtcp (GstPad * pad,
 
 static GstFlowReturn gst_srtp_dec_chain_rtp (GstPad * pad,
     GstObject * parent, GstBuffer * buf);
+static GstFlowReturn gst_srtp_dec_chain_list_rtp (GstPad * pad,
+    GstObject * parent, GstBufferList * buf_list);
+static GstFlowReturn gst_srtp_dec_chain_list_rtcp (GstPad * pad,
+    GstObject * parent, GstBufferList * buf_list);
 static GstFlowReturn gst_srtp_dec_chain_rtcp (GstPad * pad,
     GstObject * parent, GstBuffer * buf);
 
@@ -379,6 +383,8 @@ gst_srtp_dec_init (GstSrtpDec * filter)
       GST_DEBUG_FUNCPTR (gst_srtp_dec_iterate_internal_links_rtp));
   gst_pad_set_chain_function (filter->rtp_sinkpad,
       GST_DEBUG_FUNCPTR (gst_srtp_dec_chain_rtp));
+  gst_pad_set_chain_list_function (filter->rtp_sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_dec_chain_list_rtp));
 
   filter->rtp_srcpad =
       gst_pad_new_from_static_template (&rtp_src_template, "rtp_src");
@@ -402,6 +408,8 @@ gst_srtp_dec_init (GstSrtpDec * filter)
       GST_DEBUG_FUNCPTR (gst_srtp_dec_iterate_internal_links_rtcp));
   gst_pad_set_chain_function (filter->rtcp_sinkpad,
       GST_DEBUG_FUNCPTR (gst_srtp_dec_chain_rtcp));
+  gst_pad_set_chain_list_function (filter->rtcp_sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_dec_chain_list_rtcp));
 
   filter->rtcp_srcpad =
       gst_pad_new_from_static_template (&rtcp_src_template, "rtcp_src");
@@ -1315,22 +1323,24 @@ gst_srtp_dec_push_early_events (GstSrtpDec * filter, GstPad * pad,
 }
 
 /*
+ * Decrypts *buf in place, replacing it with a writable copy if needed.
  * This function should be called while holding the filter lock
  */
 static gboolean
-gst_srtp_dec_decode_buffer (GstSrtpDec * filter, GstPad * pad, GstBuffer * buf,
-    gboolean is_rtcp, guint32 ssrc)
+gst_srtp_dec_decode_buffer (GstSrtpDec * filter, GstPad * pad,
+    GstBuffer ** bufptr, gboolean is_rtcp, guint32 ssrc)
 {
+  GstBuffer *buf;
   GstMapInfo map;
   srtp_err_status_t err;
   gint size;
 
   GST_LOG_OBJECT (pad, "Received %s buffer of size %" G_GSIZE_FORMAT
-      " with SSRC = %u", is_rtcp ? "RTCP" : "RTP", gst_buffer_get_size (buf),
-      ssrc);
+      " with SSRC = %u", is_rtcp ? "RTCP" : "RTP",
+      gst_buffer_get_size (*bufptr), ssrc);
 
   /* Change buffer to remove protection */
-  buf = gst_buffer_make_writable (buf);
+  buf = *bufptr = gst_buffer_make_writable (*bufptr);
 
   gst_buffer_map (buf, &map, GST_MAP_READWRITE);
   size = map.size;
@@ -1440,65 +1450,163 @@ err:
   return FALSE;
 }
 
-static GstFlowReturn
-gst_srtp_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
-    gboolean is_rtcp)
+/*
+ * Validates and decrypts *buf. Returns FALSE if the buffer has to be dropped.
+ * is_rtcp is updated if the packet turns out to be of the other kind.
+ * This function should be called while holding the filter lock
+ */
+static gboolean
+gst_srtp_dec_process_buffer (GstSrtpDec * filter, GstPad * pad,
+    GstBuffer ** buf, gboolean * is_rtcp)
 {
-  GstSrtpDec *filter = GST_SRTP_DEC (parent);
-  GstPad *otherpad;
   GstSrtpDecSsrcStream *stream = NULL;
-  GstFlowReturn ret = GST_FLOW_OK;
   guint32 ssrc = 0;
 
-  GST_OBJECT_LOCK (filter);
-
   /* Check if this stream exists, if not create a new stream */
 
-  if (!(stream = validate_buffer (filter, buf, &ssrc, &is_rtcp))) {
-    GST_OBJECT_UNLOCK (filter);
+  if (!(stream = validate_buffer (filter, *buf, &ssrc, is_rtcp))) {
     GST_WARNING_OBJECT (filter, "Invalid buffer, dropping");
-    goto drop_buffer;
-  }
-
-  if (!STREAM_HAS_CRYPTO (stream)) {
-    GST_OBJECT_UNLOCK (filter);
-    goto push_out;
+    return FALSE;
   }
 
-  if (!gst_srtp_dec_decode_buffer (filter, pad, buf, is_rtcp, ssrc)) {
-    GST_OBJECT_UNLOCK (filter);
-    goto drop_buffer;
-  }
+  if (!STREAM_HAS_CRYPTO (stream))
+    return TRUE;
 
-  GST_OBJECT_UNLOCK (filter);
+  if (!gst_srtp_dec_decode_buffer (filter, pad, buf, *is_rtcp, ssrc))
+    return FALSE;
 
   /* If all is well, we may have reached soft limit */
-  if (gst_srtp_get_soft_limit_reached ())
+  if (gst_srtp_get_soft_limit_reached ()) {
+    GST_OBJECT_UNLOCK (filter);
     request_key_with_signal (filter, ssrc, SIGNAL_SOFT_LIMIT);
+    GST_OBJECT_LOCK (filter);
+  }
 
-push_out:
-  /* Push buffer to source pad */
+  return TRUE;
+}
+
+static GstPad *
+gst_srtp_dec_get_srcpad (GstSrtpDec * filter, gboolean is_rtcp)
+{
   if (is_rtcp) {
-    otherpad = filter->rtcp_srcpad;
     if (!filter->rtcp_has_segment)
       gst_srtp_dec_push_early_events (filter, filter->rtcp_srcpad,
           filter->rtp_srcpad, TRUE);
+    return filter->rtcp_srcpad;
   } else {
-    otherpad = filter->rtp_srcpad;
     if (!filter->rtp_has_segment)
       gst_srtp_dec_push_early_events (filter, filter->rtp_srcpad,
           filter->rtcp_srcpad, FALSE);
+    return filter->rtp_srcpad;
   }
-  ret = gst_pad_push (otherpad, buf);
+}
 
-  return ret;
+static GstFlowReturn
+gst_srtp_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
+    gboolean is_rtcp)
+{
+  GstSrtpDec *filter = GST_SRTP_DEC (parent);
+  gboolean keep;
 
-drop_buffer:
-  /* Drop buffer, except if gst_pad_push returned OK or an error */
+  GST_OBJECT_LOCK (filter);
+  keep = gst_srtp_dec_process_buffer (filter, pad, &buf, &is_rtcp);
+  GST_OBJECT_UNLOCK (filter);
 
-  gst_buffer_unref (buf);
+  if (!keep) {
+    gst_buffer_unref (buf);
+    return GST_FLOW_OK;
+  }
 
-  return ret;
+  /* Push buffer to source pad */
+  return gst_pad_push (gst_srtp_dec_get_srcpad (filter, is_rtcp), buf);
+}
+
+typedef struct
+{
+  GstSrtpDec *filter;
+  GstPad *pad;
+  gboolean is_rtcp;
+  GstBufferList *other_list;
+} ProcessListItData;
+
+static gboolean
+process_list_it (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  ProcessListItData *data = user_data;
+  gboolean is_rtcp = data->is_rtcp;
+
+  if (!gst_srtp_dec_process_buffer (data->filter, data->pad, buffer,
+          &is_rtcp)) {
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+  } else if (is_rtcp != data->is_rtcp) {
+    /* Muxed packet of the other kind, goes to the other source pad */
+    if (!data->other_list)
+      data->other_list = gst_buffer_list_new ();
+    gst_buffer_list_add (data->other_list, *buffer);
+    *buffer = NULL;
+  }
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_srtp_dec_push_list (GstSrtpDec * filter, GstBufferList * buf_list,
+    gboolean is_rtcp)
+{
+  if (gst_buffer_list_length (buf_list) == 0) {
+    gst_buffer_list_unref (buf_list);
+    return GST_FLOW_OK;
+  }
+
+  return gst_pad_push_list (gst_srtp_dec_get_srcpad (filter, is_rtcp),
+      buf_list);
+}
+
+/* Decrypts the whole list in place under a single lock and pushes it on as a
+ * list, which avoids taking the lock and pushing downstream per packet */
+static GstFlowReturn
+gst_srtp_dec_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * buf_list, gboolean is_rtcp)
+{
+  GstSrtpDec *filter = GST_SRTP_DEC (parent);
+  ProcessListItData data;
+  GstFlowReturn ret, other_ret = GST_FLOW_OK;
+
+  GST_LOG_OBJECT (pad, "Buffer chain with list of %d",
+      gst_buffer_list_length (buf_list));
+
+  buf_list = gst_buffer_list_make_writable (buf_list);
+
+  data.filter = filter;
+  data.pad = pad;
+  data.is_rtcp = is_rtcp;
+  data.other_list = NULL;
+
+  GST_OBJECT_LOCK (filter);
+  gst_buffer_list_foreach (buf_list, process_list_it, &data);
+  GST_OBJECT_UNLOCK (filter);
+
+  ret = gst_srtp_dec_push_list (filter, buf_list, is_rtcp);
+
+  if (data.other_list)
+    other_ret = gst_srtp_dec_push_list (filter, data.other_list, !is_rtcp);
+
+  return ret != GST_FLOW_OK ? ret : other_ret;
+}
+
+static GstFlowReturn
+gst_srtp_dec_chain_list_rtp (GstPad * pad, GstObject * parent,
+    GstBufferList * buf_list)
+{
+  return gst_srtp_dec_chain_list (pad, parent, buf_list, FALSE);
+}
+
+static GstFlowReturn
+gst_srtp_dec_chain_list_rtcp (GstPad * pad, GstObject * parent,
+    GstBufferList * buf_list)
+{
+  return gst_srtp_dec_chain_list (pad, parent, buf_list, TRUE);
 }
 
 static GstFlowReturn
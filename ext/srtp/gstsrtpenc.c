@@ -160,12 +160,14 @@ enum
   PROP_MKI
 };
 
+/* room needed after the packet for the auth tag, MKI and SRTCP index */
+#define SRTP_TAILROOM (SRTP_MAX_TRAILER_LEN + 10)
+
 typedef struct ProcessBufferItData
 {
   GstSrtpEnc *filter;
   GstPad *pad;
-  GstBufferList *out_list;
-  GstFlowReturn flowret;
+  srtp_err_status_t err;
   gboolean is_rtcp;
 } ProcessBufferItData;
 
@@ -975,6 +977,33 @@ gst_srtp_enc_sink_query (GstPad * pad, GstObject * parent, GstQuery * query,
 
       return TRUE;
     }
+    case GST_QUERY_ALLOCATION:
+    {
+      GstAllocator *allocator;
+      GstAllocationParams params;
+      guint i, n;
+
+      /* Whatever downstream answers, ask upstream for enough padding after
+       * each buffer so that we can protect it in place */
+      gst_pad_query_default (pad, parent, query);
+
+      n = gst_query_get_n_allocation_params (query);
+      if (n == 0) {
+        gst_allocation_params_init (&params);
+        params.padding = SRTP_TAILROOM;
+        gst_query_add_allocation_param (query, NULL, &params);
+      }
+
+      for (i = 0; i < n; i++) {
+        gst_query_parse_nth_allocation_param (query, i, &allocator, &params);
+        params.padding = MAX (params.padding, SRTP_TAILROOM);
+        gst_query_set_nth_allocation_param (query, i, allocator, &params);
+        if (allocator)
+          gst_object_unref (allocator);
+      }
+
+      return TRUE;
+    }
     default:
       return gst_pad_query_default (pad, parent, query);
   }
@@ -1097,35 +1126,54 @@ gst_srtp_enc_check_set_caps (GstSrtpEnc * filter, GstPad * pad,
   return GST_FLOW_OK;
 }
 
-static GstFlowReturn
-gst_srtp_enc_process_buffer (GstSrtpEnc * filter, GstPad * pad,
-    GstBuffer * buf, gboolean is_rtcp, GstBuffer ** outbuf_ptr)
+/* Whether the buffer can be protected without copying it, which is the case
+ * if we own it and its memory has enough room after the packet for the
+ * trailer. Upstream can provide that room through the allocation query */
+static gboolean
+gst_srtp_enc_can_protect_in_place (GstBuffer * buf, gsize size)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
-  gint size_max, size;
-  GstBuffer *bufout = NULL;
-  GstMapInfo mapout;
-  srtp_err_status_t err;
+  GstMemory *mem;
+  gsize offset, maxsize;
 
-  /* Create a bigger buffer to add protection */
-  size = gst_buffer_get_size (buf);
-  size_max = size + SRTP_MAX_TRAILER_LEN + 10;
-  bufout = gst_buffer_new_allocate (NULL, size_max, NULL);
+  if (!gst_buffer_is_writable (buf) || gst_buffer_n_memory (buf) != 1)
+    return FALSE;
 
-  gst_buffer_map (bufout, &mapout, GST_MAP_READWRITE);
+  mem = gst_buffer_peek_memory (buf, 0);
+  if (!gst_memory_is_writable (mem))
+    return FALSE;
 
-  gst_buffer_extract (buf, 0, mapout.data, size);
+  gst_memory_get_sizes (mem, &offset, &maxsize);
 
-  GST_OBJECT_LOCK (filter);
+  return maxsize - offset >= size + SRTP_TAILROOM;
+}
 
-  gst_srtp_init_event_reporter ();
+/*
+ * Protects *buf, replacing it with a new buffer if it can't be done in place.
+ * This function should be called while holding the filter lock and after
+ * gst_srtp_init_event_reporter()
+ */
+static srtp_err_status_t
+gst_srtp_enc_protect_buffer (GstSrtpEnc * filter, GstPad * pad,
+    GstBuffer ** buf, gboolean is_rtcp)
+{
+  GstBuffer *bufin = *buf, *bufout;
+  GstMapInfo mapout;
+  srtp_err_status_t err;
+  gint size;
 
-  if (filter->session == NULL) {
-    /* The rtcp session disappeared (element shutting down) */
-    GST_OBJECT_UNLOCK (filter);
-    ret = GST_FLOW_FLUSHING;
-    goto fail;
+  size = gst_buffer_get_size (bufin);
+
+  if (gst_srtp_enc_can_protect_in_place (bufin, size)) {
+    bufout = bufin;
+    gst_buffer_set_size (bufout, size + SRTP_TAILROOM);
+    gst_buffer_map (bufout, &mapout, GST_MAP_READWRITE);
+  } else {
+    /* Create a bigger buffer to add protection */
+    bufout = gst_buffer_new_allocate (NULL, size + SRTP_TAILROOM, NULL);
+    gst_buffer_map (bufout, &mapout, GST_MAP_READWRITE);
+    gst_buffer_extract (bufin, 0, mapout.data, size);
   }
+
 #ifdef HAVE_SRTP2
   if (is_rtcp)
     err = srtp_protect_rtcp_mki (filter->session, mapout.data, &size,
@@ -1140,40 +1188,64 @@ gst_srtp_enc_process_buffer (GstSrtpEnc * filter, GstPad * pad,
     err = srtp_protect (filter->session, mapout.data, &size);
 #endif
 
-  GST_OBJECT_UNLOCK (filter);
-
   gst_buffer_unmap (bufout, &mapout);
 
   if (err == srtp_err_status_ok) {
     /* Buffer protected */
     gst_buffer_set_size (bufout, size);
-    gst_buffer_copy_into (bufout, buf, GST_BUFFER_COPY_METADATA, 0, -1);
 
-    GST_LOG_OBJECT (pad, "Encoding %s buffer of size %d",
-        is_rtcp ? "RTCP" : "RTP", size);
+    GST_LOG_OBJECT (pad, "Encoding %s buffer of size %d%s",
+        is_rtcp ? "RTCP" : "RTP", size, bufout == bufin ? " in place" : "");
+  }
 
-  } else if (err == srtp_err_status_key_expired) {
+  if (bufout != bufin) {
+    gst_buffer_copy_into (bufout, bufin, GST_BUFFER_COPY_METADATA, 0, -1);
+    gst_buffer_unref (bufin);
+    *buf = bufout;
+  }
+
+  return err;
+}
 
+static GstFlowReturn
+gst_srtp_enc_protect_error (GstSrtpEnc * filter, srtp_err_status_t err)
+{
+  if (err == srtp_err_status_ok) {
+    return GST_FLOW_OK;
+  } else if (err == srtp_err_status_key_expired) {
     GST_ELEMENT_ERROR (GST_ELEMENT_CAST (filter), STREAM, ENCODE,
         ("Key usage limit has been reached"),
         ("Unable to protect buffer (hard key usage limit reached)"));
-    ret = GST_FLOW_ERROR;
-    goto fail;
-
   } else {
     /* srtp_protect failed */
     GST_ELEMENT_ERROR (filter, LIBRARY, FAILED, (NULL),
         ("Unable to protect buffer (protect failed) code %d", err));
-    ret = GST_FLOW_ERROR;
-    goto fail;
   }
 
-  *outbuf_ptr = bufout;
-  return ret;
+  return GST_FLOW_ERROR;
+}
 
-fail:
-  gst_buffer_unref (bufout);
-  return ret;
+static GstFlowReturn
+gst_srtp_enc_process_buffer (GstSrtpEnc * filter, GstPad * pad,
+    GstBuffer ** buf, gboolean is_rtcp)
+{
+  srtp_err_status_t err;
+
+  GST_OBJECT_LOCK (filter);
+
+  gst_srtp_init_event_reporter ();
+
+  if (filter->session == NULL) {
+    /* The rtcp session disappeared (element shutting down) */
+    GST_OBJECT_UNLOCK (filter);
+    return GST_FLOW_FLUSHING;
+  }
+
+  err = gst_srtp_enc_protect_buffer (filter, pad, buf, is_rtcp);
+
+  GST_OBJECT_UNLOCK (filter);
+
+  return gst_srtp_enc_protect_error (filter, err);
 }
 
 static GstFlowReturn
@@ -1183,7 +1255,6 @@ gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
   GstSrtpEnc *filter = GST_SRTP_ENC (parent);
   GstFlowReturn ret = GST_FLOW_OK;
   GstPad *otherpad;
-  GstBuffer *bufout = NULL;
 
   if ((ret = gst_srtp_enc_check_set_caps (filter, pad, is_rtcp)) != GST_FLOW_OK) {
     goto out;
@@ -1199,14 +1270,14 @@ gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
 
   GST_OBJECT_UNLOCK (filter);
 
-  ret = gst_srtp_enc_process_buffer (filter, pad, buf, is_rtcp, &bufout);
+  ret = gst_srtp_enc_process_buffer (filter, pad, &buf, is_rtcp);
   if (ret != GST_FLOW_OK)
     goto out;
 
   /* Push buffer to source pad */
   otherpad = get_rtp_other_pad (pad);
-  ret = gst_pad_push (otherpad, bufout);
-  bufout = NULL;
+  ret = gst_pad_push (otherpad, buf);
+  buf = NULL;
 
   if (ret != GST_FLOW_OK)
     goto out;
@@ -1224,7 +1295,8 @@ gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
   GST_OBJECT_UNLOCK (filter);
 
 out:
-  gst_buffer_unref (buf);
+  if (buf)
+    gst_buffer_unref (buf);
   return ret;
 }
 
@@ -1232,19 +1304,11 @@ static gboolean
 process_buffer_it (GstBuffer ** buffer, guint index, gpointer user_data)
 {
   ProcessBufferItData *data = user_data;
-  GstBuffer *bufout;
-  GstFlowReturn ret;
-
-  ret = gst_srtp_enc_process_buffer (data->filter, data->pad, *buffer,
-      data->is_rtcp, &bufout);
-  if (ret != GST_FLOW_OK) {
-    data->flowret = ret;
-    return FALSE;
-  }
 
-  gst_buffer_list_add (data->out_list, bufout);
+  data->err = gst_srtp_enc_protect_buffer (data->filter, data->pad, buffer,
+      data->is_rtcp);
 
-  return TRUE;
+  return data->err == srtp_err_status_ok;
 }
 
 static GstFlowReturn
@@ -1254,7 +1318,6 @@ gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
   GstSrtpEnc *filter = GST_SRTP_ENC (parent);
   GstFlowReturn ret = GST_FLOW_OK;
   GstPad *otherpad;
-  GstBufferList *out_list = NULL;
   ProcessBufferItData process_data;
 
   GST_LOG_OBJECT (pad, "Buffer chain with list of %d",
@@ -1274,32 +1337,38 @@ gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
     return gst_pad_push_list (otherpad, buf_list);
   }
 
-  GST_OBJECT_UNLOCK (filter);
+  /* Protect the whole list in place in one go, with a single lock and
+   * event reporter setup, only copying the buffers that lack tailroom */
+  buf_list = gst_buffer_list_make_writable (buf_list);
 
-  out_list = gst_buffer_list_new ();
+  gst_srtp_init_event_reporter ();
+
+  if (filter->session == NULL) {
+    /* The rtcp session disappeared (element shutting down) */
+    GST_OBJECT_UNLOCK (filter);
+    ret = GST_FLOW_FLUSHING;
+    goto out;
+  }
 
   process_data.filter = filter;
   process_data.pad = pad;
   process_data.is_rtcp = is_rtcp;
-  process_data.out_list = out_list;
-  process_data.flowret = GST_FLOW_OK;
+  process_data.err = srtp_err_status_ok;
 
-  if (!gst_buffer_list_foreach (buf_list, process_buffer_it, &process_data)) {
-    ret = process_data.flowret;
-    goto out;
-  }
+  gst_buffer_list_foreach (buf_list, process_buffer_it, &process_data);
 
-  if (!gst_buffer_list_length (out_list)) {
-    gst_buffer_list_unref (out_list);
-    ret = GST_FLOW_OK;
+  GST_OBJECT_UNLOCK (filter);
+
+  if ((ret = gst_srtp_enc_protect_error (filter,
+              process_data.err)) != GST_FLOW_OK)
     goto out;
-  }
 
   /* Push buffer to source pad */
   otherpad = get_rtp_other_pad (pad);
   GST_LOG_OBJECT (pad, "Pushing buffer chain of %d",
       gst_buffer_list_length (buf_list));
-  ret = gst_pad_push_list (otherpad, out_list);
+  ret = gst_pad_push_list (otherpad, buf_list);
+  buf_list = NULL;
 
   if (ret != GST_FLOW_OK) {
     goto out;
@@ -1319,7 +1388,8 @@ gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
 
 out:
 
-  gst_buffer_list_unref (buf_list);
+  if (buf_list)
+    gst_buffer_list_unref (buf_list);
 
   return ret;
 }
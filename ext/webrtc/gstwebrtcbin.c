@@ -327,6 +327,9 @@ enum
   PROP_TURN_SERVER,
   PROP_BUNDLE_POLICY,
   PROP_ICE_TRANSPORT_POLICY,
+  PROP_SHARED_THREADS,
+  PROP_STATS_CACHE_TIME,
+  PROP_STATS_INTERVAL,
 };
 
 static guint gst_webrtc_bin_signals[LAST_SIGNAL] = { 0 };
@@ -672,24 +675,164 @@ _gst_pc_thread (GstWebRTCBin * webrtc)
   return NULL;
 }
 
+static void _free_op (GstWebRTCBinTask * op);
+
+/* with PC_LOCK, returns a new reference */
+static GMainContext *
+_get_pc_context (GstWebRTCBin * webrtc)
+{
+  GMainContext *context;
+
+  g_mutex_lock (&webrtc->priv->ops_lock);
+  if (webrtc->priv->worker)
+    context = _shared_worker_get_context (webrtc->priv->worker);
+  else
+    context = webrtc->priv->main_context;
+  if (context)
+    g_main_context_ref (context);
+  g_mutex_unlock (&webrtc->priv->ops_lock);
+
+  return context;
+}
+
+/* The timer only holds a weak reference so that it never keeps us alive */
+static gboolean
+_post_stats (GWeakRef * ref)
+{
+  GstWebRTCBin *webrtc = g_weak_ref_get (ref);
+  GstStructure *s = NULL;
+
+  if (!webrtc)
+    return G_SOURCE_REMOVE;
+
+  PC_LOCK (webrtc);
+  if (!webrtc->priv->is_closed) {
+    gst_webrtc_bin_refresh_stats (webrtc, webrtc->priv->stats_cache_time);
+    s = gst_structure_copy (webrtc->priv->stats);
+  }
+  PC_UNLOCK (webrtc);
+
+  if (s)
+    gst_element_post_message (GST_ELEMENT (webrtc),
+        gst_message_new_element (GST_OBJECT (webrtc), s));
+
+  gst_object_unref (webrtc);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+_free_weak_ref (GWeakRef * ref)
+{
+  g_weak_ref_clear (ref);
+  g_free (ref);
+}
+
+static void
+_destroy_stats_timer (GstWebRTCBin * webrtc)
+{
+  if (webrtc->priv->stats_source) {
+    g_source_destroy (webrtc->priv->stats_source);
+    g_source_unref (webrtc->priv->stats_source);
+    webrtc->priv->stats_source = NULL;
+  }
+}
+
+/* with PC_LOCK. The timer runs on the peerconnection thread, so it is only
+ * armed while that thread or the shared worker exists and _start_thread()
+ * arms it again */
+static void
+_update_stats_timer (GstWebRTCBin * webrtc)
+{
+  GMainContext *context;
+  GWeakRef *ref;
+
+  _destroy_stats_timer (webrtc);
+
+  if (webrtc->priv->is_closed || webrtc->priv->stats_interval == 0)
+    return;
+
+  if (!(context = _get_pc_context (webrtc)))
+    return;
+
+  GST_DEBUG_OBJECT (webrtc, "posting stats every %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (webrtc->priv->stats_interval));
+
+  ref = g_new0 (GWeakRef, 1);
+  g_weak_ref_init (ref, webrtc);
+  webrtc->priv->stats_source =
+      g_timeout_source_new (MAX (webrtc->priv->stats_interval / GST_MSECOND,
+          1));
+  g_source_set_callback (webrtc->priv->stats_source, (GSourceFunc) _post_stats,
+      ref, (GDestroyNotify) _free_weak_ref);
+  g_source_attach (webrtc->priv->stats_source, context);
+  g_main_context_unref (context);
+}
+
 static void
 _start_thread (GstWebRTCBin * webrtc)
 {
   PC_LOCK (webrtc);
-  webrtc->priv->thread = g_thread_new ("gst-pc-ops",
-      (GThreadFunc) _gst_pc_thread, webrtc);
+  if (webrtc->priv->shared_threads) {
+    SharedWorker *worker = _shared_worker_acquire ("gst-pc-ops");
 
-  while (!webrtc->priv->loop)
-    PC_COND_WAIT (webrtc);
+    g_mutex_lock (&webrtc->priv->ops_lock);
+    webrtc->priv->worker = worker;
+    g_mutex_unlock (&webrtc->priv->ops_lock);
+  } else {
+    webrtc->priv->thread = g_thread_new ("gst-pc-ops",
+        (GThreadFunc) _gst_pc_thread, webrtc);
+
+    while (!webrtc->priv->loop)
+      PC_COND_WAIT (webrtc);
+  }
   webrtc->priv->is_closed = FALSE;
+  _update_stats_timer (webrtc);
   PC_UNLOCK (webrtc);
 }
 
+static void
+_stop_shared_worker (GstWebRTCBin * webrtc)
+{
+  SharedWorker *worker;
+  GSource *source;
+  GQueue ops = G_QUEUE_INIT;
+
+  /* once the worker is unset, gst_webrtc_bin_enqueue_task() drops new
+   * tasks instead of attaching them to its context */
+  g_mutex_lock (&webrtc->priv->ops_lock);
+  worker = webrtc->priv->worker;
+  webrtc->priv->worker = NULL;
+  source = webrtc->priv->ops_source;
+  webrtc->priv->ops_source = NULL;
+  ops = webrtc->priv->ops;
+  g_queue_init (&webrtc->priv->ops);
+  g_mutex_unlock (&webrtc->priv->ops_lock);
+
+  /* a task that is currently running keeps its reference to us until it
+   * returns and the remaining ones are never executed as we are closed */
+  if (source) {
+    g_source_destroy (source);
+    g_source_unref (source);
+  }
+  g_queue_foreach (&ops, (GFunc) _free_op, NULL);
+  g_queue_clear (&ops);
+
+  _shared_worker_release (worker);
+}
+
 static void
 _stop_thread (GstWebRTCBin * webrtc)
 {
   PC_LOCK (webrtc);
   webrtc->priv->is_closed = TRUE;
+  _update_stats_timer (webrtc);
+  if (webrtc->priv->worker) {
+    PC_UNLOCK (webrtc);
+    _stop_shared_worker (webrtc);
+    return;
+  }
+
   g_main_loop_quit (webrtc->priv->loop);
   while (webrtc->priv->loop)
     PC_COND_WAIT (webrtc);
@@ -723,6 +866,37 @@ _free_op (GstWebRTCBinTask * op)
   g_free (op);
 }
 
+/* Runs a single task per dispatch so that instances sharing a thread are
+ * served in turn while the tasks of each instance stay in order */
+static gboolean
+_execute_shared_ops (GstWebRTCBin * webrtc)
+{
+  GstWebRTCBinTask *op;
+  gboolean ret = G_SOURCE_CONTINUE;
+
+  g_mutex_lock (&webrtc->priv->ops_lock);
+  op = g_queue_pop_head (&webrtc->priv->ops);
+  g_mutex_unlock (&webrtc->priv->ops_lock);
+
+  if (op) {
+    _execute_op (op);
+    _free_op (op);
+  }
+
+  g_mutex_lock (&webrtc->priv->ops_lock);
+  if (webrtc->priv->ops_source != g_main_current_source ()) {
+    /* we were stopped in the meantime */
+    ret = G_SOURCE_REMOVE;
+  } else if (g_queue_is_empty (&webrtc->priv->ops)) {
+    g_source_unref (webrtc->priv->ops_source);
+    webrtc->priv->ops_source = NULL;
+    ret = G_SOURCE_REMOVE;
+  }
+  g_mutex_unlock (&webrtc->priv->ops_lock);
+
+  return ret;
+}
+
 void
 gst_webrtc_bin_enqueue_task (GstWebRTCBin * webrtc, GstWebRTCBinFunc func,
     gpointer data, GDestroyNotify notify)
@@ -744,6 +918,30 @@ gst_webrtc_bin_enqueue_task (GstWebRTCBin * webrtc, GstWebRTCBinFunc func,
   op->data = data;
   op->notify = notify;
 
+  g_mutex_lock (&webrtc->priv->ops_lock);
+  if (webrtc->priv->worker) {
+    g_queue_push_tail (&webrtc->priv->ops, op);
+    if (!webrtc->priv->ops_source) {
+      source = g_idle_source_new ();
+      g_source_set_priority (source, G_PRIORITY_DEFAULT);
+      g_source_set_callback (source, (GSourceFunc) _execute_shared_ops,
+          gst_object_ref (webrtc), (GDestroyNotify) gst_object_unref);
+      g_source_attach (source,
+          _shared_worker_get_context (webrtc->priv->worker));
+      webrtc->priv->ops_source = source;
+    }
+    g_mutex_unlock (&webrtc->priv->ops_lock);
+    return;
+  }
+  g_mutex_unlock (&webrtc->priv->ops_lock);
+
+  if (!webrtc->priv->main_context) {
+    /* the shared worker was released since we checked is_closed */
+    GST_DEBUG_OBJECT (webrtc, "Peerconnection is closed, aborting execution");
+    _free_op (op);
+    return;
+  }
+
   source = g_idle_source_new ();
   g_source_set_priority (source, G_PRIORITY_DEFAULT);
   g_source_set_callback (source, (GSourceFunc) _execute_op, op,
@@ -3317,8 +3515,10 @@ _update_data_channel_from_sdp_media (GstWebRTCBin * webrtc,
 
   webrtc->priv->sctp_transport->max_message_size = max_size;
 
+  /* The peer may send messages up to the size we advertised */
   g_object_set (webrtc->priv->sctp_transport->sctpdec, "local-sctp-port",
-      local_port, NULL);
+      local_port, "max-message-size",
+      local_max_size == G_MAXUINT64 ? (guint64) 0 : local_max_size, NULL);
   g_object_set (webrtc->priv->sctp_transport->sctpenc, "remote-sctp-port",
       remote_port, NULL);
 
@@ -3972,7 +4172,7 @@ _get_stats_task (GstWebRTCBin * webrtc, struct get_stats *stats)
   GstStructure *s;
   gpointer selector = NULL;
 
-  gst_webrtc_bin_update_stats (webrtc);
+  gst_webrtc_bin_refresh_stats (webrtc, webrtc->priv->stats_cache_time);
 
   if (stats->pad) {
     GstWebRTCBinPad *wpad = GST_WEBRTC_BIN_PAD (stats->pad);
@@ -4795,6 +4995,27 @@ gst_webrtc_bin_set_property (GObject * object, guint prop_id,
           webrtc->ice_transport_policy ==
           GST_WEBRTC_ICE_TRANSPORT_POLICY_RELAY ? TRUE : FALSE, NULL);
       break;
+    case PROP_SHARED_THREADS:
+      if (GST_STATE (webrtc) != GST_STATE_NULL) {
+        GST_WARNING_OBJECT (webrtc, "shared-threads can only be changed in "
+            "the NULL state");
+        break;
+      }
+      webrtc->priv->shared_threads = g_value_get_boolean (value);
+      gst_webrtc_ice_set_shared_thread (webrtc->priv->ice,
+          webrtc->priv->shared_threads);
+      break;
+    case PROP_STATS_CACHE_TIME:
+      PC_LOCK (webrtc);
+      webrtc->priv->stats_cache_time = g_value_get_uint64 (value);
+      PC_UNLOCK (webrtc);
+      break;
+    case PROP_STATS_INTERVAL:
+      PC_LOCK (webrtc);
+      webrtc->priv->stats_interval = g_value_get_uint64 (value);
+      _update_stats_timer (webrtc);
+      PC_UNLOCK (webrtc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -4859,6 +5080,15 @@ gst_webrtc_bin_get_property (GObject * object, guint prop_id,
     case PROP_ICE_TRANSPORT_POLICY:
       g_value_set_enum (value, webrtc->ice_transport_policy);
       break;
+    case PROP_SHARED_THREADS:
+      g_value_set_boolean (value, webrtc->priv->shared_threads);
+      break;
+    case PROP_STATS_CACHE_TIME:
+      g_value_set_uint64 (value, webrtc->priv->stats_cache_time);
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint64 (value, webrtc->priv->stats_interval);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -4895,6 +5125,8 @@ gst_webrtc_bin_finalize (GObject * object)
 {
   GstWebRTCBin *webrtc = GST_WEBRTC_BIN (object);
 
+  _destroy_stats_timer (webrtc);
+
   if (webrtc->priv->transports)
     g_array_free (webrtc->priv->transports, TRUE);
   webrtc->priv->transports = NULL;
@@ -4949,6 +5181,7 @@ gst_webrtc_bin_finalize (GObject * object)
 
   g_mutex_clear (PC_GET_LOCK (webrtc));
   g_cond_clear (PC_GET_COND (webrtc));
+  g_mutex_clear (&webrtc->priv->ops_lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -5052,6 +5285,48 @@ gst_webrtc_bin_class_init (GstWebRTCBinClass * klass)
           GST_WEBRTC_ICE_TRANSPORT_POLICY_ALL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstWebRTCBin:shared-threads:
+   *
+   * Run the peerconnection tasks and the ICE agent on threads shared with
+   * other webrtcbin instances in the process instead of two dedicated threads
+   * per instance. Useful when running many peer connections in one process.
+   * Can only be changed in the NULL state.
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_SHARED_THREADS,
+      g_param_spec_boolean ("shared-threads", "Shared Threads",
+          "Share the peerconnection and ICE threads with other instances",
+          FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstWebRTCBin:stats-cache-time:
+   *
+   * Maximum age of the RTP and codec statistics returned by
+   * #GstWebRTCBin::get-stats. Within that time only the transport counters
+   * and timestamps are refreshed without querying the RTP sessions. 0
+   * always updates everything.
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_STATS_CACHE_TIME,
+      g_param_spec_uint64 ("stats-cache-time", "Stats Cache Time",
+          "Maximum age in nanoseconds of the full statistics (0 = disabled)",
+          0, G_MAXUINT64, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstWebRTCBin:stats-interval:
+   *
+   * Interval at which an element message containing the same statistics
+   * structure as returned by #GstWebRTCBin::get-stats is posted on the bus.
+   * The stats-cache-time applies to these as well.
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_STATS_INTERVAL,
+      g_param_spec_uint64 ("stats-interval", "Stats Interval",
+          "Interval in nanoseconds between posting statistics on the bus "
+          "(0 = disabled)", 0, G_MAXUINT64, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstWebRTCBin::create-offer:
    * @object: the #GstWebRtcBin
@@ -5183,6 +5458,13 @@ gst_webrtc_bin_class_init (GstWebRTCBinClass * klass)
    *
    *  "local-id"            G_TYPE_STRING               identifier for the associated RTCInboundRTPSTreamStats
    *
+   * RTCTransportStats supported fields (https://w3c.github.io/webrtc-stats/#transportstats-dict*)
+   *
+   *  "packets-sent"        G_TYPE_UINT64               number of packets sent over the RTP and RTCP components
+   *  "packets-received"    G_TYPE_UINT64               number of packets received over the RTP and RTCP components
+   *  "bytes-sent"          G_TYPE_UINT64               number of bytes sent over the RTP and RTCP components
+   *  "bytes-received"      G_TYPE_UINT64               number of bytes received over the RTP and RTCP components
+   *
    */
   gst_webrtc_bin_signals[GET_STATS_SIGNAL] =
       g_signal_new_class_handler ("get-stats",
@@ -5350,6 +5632,8 @@ gst_webrtc_bin_init (GstWebRTCBin * webrtc)
   webrtc->priv = gst_webrtc_bin_get_instance_private (webrtc);
   g_mutex_init (PC_GET_LOCK (webrtc));
   g_cond_init (PC_GET_COND (webrtc));
+  g_mutex_init (&webrtc->priv->ops_lock);
+  g_queue_init (&webrtc->priv->ops);
 
   webrtc->rtpbin = _create_rtpbin (webrtc);
   gst_bin_add (GST_BIN (webrtc), webrtc->rtpbin);
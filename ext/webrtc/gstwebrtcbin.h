@@ -122,6 +122,15 @@ struct _GstWebRTCBinPrivate
   GMutex pc_lock;
   GCond pc_cond;
 
+  /* with shared-threads, tasks are queued here and run one at a time on a
+   * thread shared with other instances. worker, ops and ops_source are
+   * protected by ops_lock, which is taken after the PC lock */
+  gboolean shared_threads;
+  SharedWorker *worker;
+  GMutex ops_lock;
+  GQueue ops;
+  GSource *ops_source;
+
   gboolean running;
   gboolean async_pending;
 
@@ -133,6 +142,11 @@ struct _GstWebRTCBinPrivate
   guint media_counter;
 
   GstStructure *stats;
+  /* monotonic time of the last full stats update */
+  gint64 stats_time;
+  GstClockTime stats_cache_time;
+  GstClockTime stats_interval;
+  GSource *stats_source;
 };
 
 typedef void (*GstWebRTCBinFunc) (GstWebRTCBin * webrtc, gpointer data);
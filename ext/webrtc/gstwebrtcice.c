@@ -26,6 +26,7 @@
 #include <agent.h>
 #include "icestream.h"
 #include "nicetransport.h"
+#include "utils.h"
 
 /* XXX:
  *
@@ -75,6 +76,9 @@ struct _GstWebRTCICEPrivate
   GMainLoop *loop;
   GMutex lock;
   GCond cond;
+
+  /* non-NULL when the agent runs on a shared thread instead of ours */
+  SharedWorker *worker;
 };
 
 #define gst_webrtc_ice_parent_class parent_class
@@ -880,7 +884,10 @@ gst_webrtc_ice_finalize (GObject * object)
 
   g_signal_handlers_disconnect_by_data (ice->priv->nice_agent, ice);
 
-  _stop_thread (ice);
+  if (ice->priv->worker)
+    _shared_worker_release (ice->priv->worker);
+  else
+    _stop_thread (ice);
 
   if (ice->turn_server)
     gst_uri_unref (ice->turn_server);
@@ -899,6 +906,57 @@ gst_webrtc_ice_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+_create_agent (GstWebRTCICE * ice, GMainContext * context)
+{
+  ice->priv->nice_agent = nice_agent_new (context, NICE_COMPATIBILITY_RFC5245);
+  g_signal_connect (ice->priv->nice_agent, "new-candidate-full",
+      G_CALLBACK (_on_new_candidate), ice);
+}
+
+/* Run the nice agent on a thread shared with other instances instead of a
+ * dedicated one. The agent is recreated so this is only possible before any
+ * stream was added */
+gboolean
+gst_webrtc_ice_set_shared_thread (GstWebRTCICE * ice, gboolean shared)
+{
+  GMainContext *context;
+  gboolean force_relay;
+
+  g_return_val_if_fail (GST_IS_WEBRTC_ICE (ice), FALSE);
+
+  if (!ice->priv->worker == !shared)
+    return TRUE;
+
+  if (ice->priv->nice_stream_map->len > 0) {
+    GST_WARNING_OBJECT (ice, "Cannot change the agent thread after streams "
+        "have been added");
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (ice, "%s shared thread", shared ? "using" : "not using");
+
+  g_object_get (ice->priv->nice_agent, "force-relay", &force_relay, NULL);
+  g_signal_handlers_disconnect_by_data (ice->priv->nice_agent, ice);
+  g_object_unref (ice->priv->nice_agent);
+
+  if (shared) {
+    _stop_thread (ice);
+    ice->priv->worker = _shared_worker_acquire ("gst-nice-ops");
+    context = _shared_worker_get_context (ice->priv->worker);
+  } else {
+    _shared_worker_release (ice->priv->worker);
+    ice->priv->worker = NULL;
+    _start_thread (ice);
+    context = ice->priv->main_context;
+  }
+
+  _create_agent (ice, context);
+  g_object_set (ice->priv->nice_agent, "force-relay", force_relay, NULL);
+
+  return TRUE;
+}
+
 static void
 gst_webrtc_ice_class_init (GstWebRTCICEClass * klass)
 {
@@ -963,11 +1021,7 @@ gst_webrtc_ice_init (GstWebRTCICE * ice)
       (GDestroyNotify) gst_uri_unref);
 
   _start_thread (ice);
-
-  ice->priv->nice_agent = nice_agent_new (ice->priv->main_context,
-      NICE_COMPATIBILITY_RFC5245);
-  g_signal_connect (ice->priv->nice_agent, "new-candidate-full",
-      G_CALLBACK (_on_new_candidate), ice);
+  _create_agent (ice, ice->priv->main_context);
 
   ice->priv->nice_stream_map =
       g_array_new (FALSE, TRUE, sizeof (struct NiceStreamItem));
@@ -81,6 +81,8 @@ gboolean                    gst_webrtc_ice_set_remote_credentials   (GstWebRTCIC
                                                                      gchar * pwd);
 gboolean                    gst_webrtc_ice_add_turn_server          (GstWebRTCICE * ice,
                                                                      const gchar * uri);
+gboolean                    gst_webrtc_ice_set_shared_thread        (GstWebRTCICE * ice,
+                                                                     gboolean shared);
 
 G_END_DECLS
 
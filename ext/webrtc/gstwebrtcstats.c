@@ -345,10 +345,36 @@ _get_stats_from_ice_transport (GstWebRTCBin * webrtc,
   return id;
 }
 
+static void
+_set_transport_counters (GstStructure * stats, TransportStream * stream)
+{
+  guint64 packets_sent, packets_received, bytes_sent, bytes_received;
+
+  GST_OBJECT_LOCK (stream);
+  packets_sent = stream->packets_sent;
+  packets_received = stream->packets_received;
+  bytes_sent = stream->bytes_sent;
+  bytes_received = stream->bytes_received;
+  GST_OBJECT_UNLOCK (stream);
+
+  gst_structure_set (stats,
+      "packets-sent", G_TYPE_UINT64, packets_sent,
+      "packets-received", G_TYPE_UINT64, packets_received,
+      "bytes-sent", G_TYPE_UINT64, bytes_sent,
+      "bytes-received", G_TYPE_UINT64, bytes_received, NULL);
+}
+
+static gchar *
+_get_transport_stats_id (GstWebRTCDTLSTransport * transport)
+{
+  return g_strdup_printf ("transport-stats_%s", GST_OBJECT_NAME (transport));
+}
+
 /* https://www.w3.org/TR/webrtc-stats/#dom-rtctransportstats */
 static gchar *
 _get_stats_from_dtls_transport (GstWebRTCBin * webrtc,
-    GstWebRTCDTLSTransport * transport, GstStructure * s)
+    TransportStream * stream, GstWebRTCDTLSTransport * transport,
+    GstStructure * s)
 {
   GstStructure *stats;
   gchar *id;
@@ -356,15 +382,14 @@ _get_stats_from_dtls_transport (GstWebRTCBin * webrtc,
 
   gst_structure_get_double (s, "timestamp", &ts);
 
-  id = g_strdup_printf ("transport-stats_%s", GST_OBJECT_NAME (transport));
+  id = _get_transport_stats_id (transport);
   stats = gst_structure_new_empty (id);
   _set_base_stats (stats, GST_WEBRTC_STATS_TRANSPORT, ts, id);
 
+  /* RTCTransportStats, counted over both the RTP and RTCP components */
+  _set_transport_counters (stats, stream);
+
 /* XXX: RTCTransportStats
-    unsigned long         packetsSent;
-    unsigned long         packetsReceived;
-    unsigned long long    bytesSent;
-    unsigned long long    bytesReceived;
     DOMString             rtcpTransportStatsId;
     RTCIceRole            iceRole;
     RTCDtlsTransportState dtlsState;
@@ -433,7 +458,8 @@ _get_stats_from_transport_channel (GstWebRTCBin * webrtc,
       "transport %" GST_PTR_FORMAT, stream, rtp_session, source_stats->n_values,
       transport);
 
-  transport_id = _get_stats_from_dtls_transport (webrtc, transport, s);
+  transport_id = _get_stats_from_dtls_transport (webrtc, stream, transport,
+      s);
 
   /* construct stats objects */
   for (i = 0; i < source_stats->n_values; i++) {
@@ -565,4 +591,54 @@ gst_webrtc_bin_update_stats (GstWebRTCBin * webrtc)
   if (webrtc->priv->stats)
     gst_structure_free (webrtc->priv->stats);
   webrtc->priv->stats = s;
+  webrtc->priv->stats_time = g_get_monotonic_time ();
+}
+
+/* Only updates the counters that are kept up to date in place without
+ * querying any element, everything else is kept from the last full update */
+static void
+_refresh_stats (GstWebRTCBin * webrtc)
+{
+  double ts = monotonic_time_as_double_milliseconds ();
+  guint i;
+
+  GST_TRACE_OBJECT (webrtc, "refreshing stats at time %f", ts);
+
+  for (i = 0; i < webrtc->priv->transports->len; i++) {
+    TransportStream *stream =
+        g_array_index (webrtc->priv->transports, TransportStream *, i);
+    GstStructure *stats;
+    const GValue *val;
+    gchar *id;
+
+    if (!stream->transport)
+      continue;
+
+    id = _get_transport_stats_id (stream->transport);
+    val = gst_structure_get_value (webrtc->priv->stats, id);
+    g_free (id);
+    if (!val || !GST_VALUE_HOLDS_STRUCTURE (val))
+      continue;
+
+    /* we own the containing structure so this can be modified in place */
+    stats = (GstStructure *) gst_value_get_structure (val);
+    gst_structure_set (stats, "timestamp", G_TYPE_DOUBLE, ts, NULL);
+    _set_transport_counters (stats, stream);
+  }
+}
+
+void
+gst_webrtc_bin_refresh_stats (GstWebRTCBin * webrtc, GstClockTime max_age)
+{
+  gint64 age;
+
+  _init_debug ();
+
+  age = g_get_monotonic_time () - webrtc->priv->stats_time;
+  if (!webrtc->priv->stats || max_age == 0
+      || age * GST_USECOND >= max_age) {
+    gst_webrtc_bin_update_stats (webrtc);
+  } else {
+    _refresh_stats (webrtc);
+  }
 }
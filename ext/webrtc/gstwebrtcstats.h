@@ -29,6 +29,9 @@ G_BEGIN_DECLS
 
 G_GNUC_INTERNAL
 void        gst_webrtc_bin_update_stats         (GstWebRTCBin * webrtc);
+G_GNUC_INTERNAL
+void        gst_webrtc_bin_refresh_stats        (GstWebRTCBin * webrtc,
+                                                 GstClockTime max_age);
 
 G_END_DECLS
 
@@ -135,6 +135,12 @@ static void
 transport_stream_dispose (GObject * object)
 {
   TransportStream *stream = TRANSPORT_STREAM (object);
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (stream->counter_probes); i++) {
+    _free_pad_block (stream->counter_probes[i]);
+    stream->counter_probes[i] = NULL;
+  }
 
   if (stream->send_bin)
     gst_object_unref (stream->send_bin);
@@ -168,6 +174,51 @@ transport_stream_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static GstPadProbeReturn
+_count_packets (GstPad * pad, GstPadProbeInfo * info, TransportStream * stream)
+{
+  guint n_packets = 1;
+  gsize n_bytes;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+
+    n_packets = gst_buffer_list_length (list);
+    n_bytes = gst_buffer_list_calculate_size (list);
+  } else {
+    n_bytes = gst_buffer_get_size (GST_PAD_PROBE_INFO_BUFFER (info));
+  }
+
+  GST_OBJECT_LOCK (stream);
+  if (GST_PAD_IS_SINK (pad)) {
+    stream->packets_sent += n_packets;
+    stream->bytes_sent += n_bytes;
+  } else {
+    stream->packets_received += n_packets;
+    stream->bytes_received += n_bytes;
+  }
+  GST_OBJECT_UNLOCK (stream);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static struct pad_block *
+_add_counter_probe (TransportStream * stream, GstElement * element,
+    const gchar * pad_name)
+{
+  struct pad_block *block;
+  GstPad *pad;
+
+  pad = gst_element_get_static_pad (element, pad_name);
+  block = _create_pad_block (element, pad, 0, NULL, NULL);
+  block->block_id = gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) _count_packets, stream, NULL);
+  gst_object_unref (pad);
+
+  return block;
+}
+
 static void
 transport_stream_constructed (GObject * object)
 {
@@ -210,6 +261,16 @@ transport_stream_constructed (GObject * object)
   gst_webrtc_dtls_transport_set_transport (stream->rtcp_transport, ice_trans);
   gst_object_unref (ice_trans);
 
+  /* cheap transport level counters for the stats */
+  stream->counter_probes[0] = _add_counter_probe (stream,
+      stream->transport->transport->sink, "sink");
+  stream->counter_probes[1] = _add_counter_probe (stream,
+      stream->transport->transport->src, "src");
+  stream->counter_probes[2] = _add_counter_probe (stream,
+      stream->rtcp_transport->transport->sink, "sink");
+  stream->counter_probes[3] = _add_counter_probe (stream,
+      stream->rtcp_transport->transport->src, "src");
+
   stream->send_bin = g_object_new (transport_send_bin_get_type (), "stream",
       stream, NULL);
   gst_object_ref_sink (stream->send_bin);
@@ -61,6 +61,14 @@ struct _TransportStream
 
   GArray                   *ptmap;                  /* array of PtMapItem's */
   GArray                   *remote_ssrcmap;         /* array of SsrcMapItem's */
+
+  /* updated from the ICE elements' streaming threads with the object
+   * lock */
+  struct pad_block         *counter_probes[4];
+  guint64                   packets_sent;
+  guint64                   packets_received;
+  guint64                   bytes_sent;
+  guint64                   bytes_received;
 };
 
 struct _TransportStreamClass
@@ -142,3 +142,104 @@ _g_checksum_to_webrtc_string (GChecksumType type)
       return NULL;
   }
 }
+
+/* Process wide pool of threads each running a GMainContext that can be
+ * shared between webrtcbin instances instead of having one thread per
+ * instance. Workers are grouped by name, a new worker is only spawned while
+ * there are less workers than CPUs in the group and all of them are in use,
+ * otherwise the least used one is returned. */
+struct _SharedWorker
+{
+  gchar *name;
+  GThread *thread;
+  GMainContext *context;
+  GMainLoop *loop;
+  guint users;
+};
+
+static GMutex shared_workers_lock;
+static GPtrArray *shared_workers;
+
+static gboolean
+_quit_shared_worker (GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+_shared_worker_thread (SharedWorker * worker)
+{
+  g_main_loop_run (worker->loop);
+
+  g_main_loop_unref (worker->loop);
+  g_main_context_unref (worker->context);
+  g_free (worker->name);
+  g_free (worker);
+
+  return NULL;
+}
+
+SharedWorker *
+_shared_worker_acquire (const gchar * name)
+{
+  SharedWorker *worker = NULL;
+  guint i, n_workers = 0;
+
+  g_mutex_lock (&shared_workers_lock);
+  if (!shared_workers)
+    shared_workers = g_ptr_array_new ();
+
+  for (i = 0; i < shared_workers->len; i++) {
+    SharedWorker *w = g_ptr_array_index (shared_workers, i);
+
+    if (g_strcmp0 (w->name, name) != 0)
+      continue;
+
+    n_workers++;
+    if (!worker || w->users < worker->users)
+      worker = w;
+  }
+
+  if (!worker || (worker->users > 0 && n_workers < g_get_num_processors ())) {
+    worker = g_new0 (SharedWorker, 1);
+    worker->name = g_strdup (name);
+    worker->context = g_main_context_new ();
+    worker->loop = g_main_loop_new (worker->context, FALSE);
+    worker->thread = g_thread_new (name,
+        (GThreadFunc) _shared_worker_thread, worker);
+    g_ptr_array_add (shared_workers, worker);
+  }
+  worker->users++;
+  g_mutex_unlock (&shared_workers_lock);
+
+  return worker;
+}
+
+GMainContext *
+_shared_worker_get_context (SharedWorker * worker)
+{
+  return worker->context;
+}
+
+void
+_shared_worker_release (SharedWorker * worker)
+{
+  g_mutex_lock (&shared_workers_lock);
+  g_assert (worker->users > 0);
+  if (--worker->users == 0) {
+    GSource *source;
+
+    g_ptr_array_remove_fast (shared_workers, worker);
+    /* quit from inside the loop as it may not be running yet. The thread
+     * frees the worker once the loop returns, so we never join it in case
+     * we're called from the worker thread itself */
+    source = g_idle_source_new ();
+    g_source_set_callback (source, (GSourceFunc) _quit_shared_worker,
+        worker->loop, NULL);
+    g_source_attach (source, worker->context);
+    g_source_unref (source);
+    g_thread_unref (worker->thread);
+  }
+  g_mutex_unlock (&shared_workers_lock);
+}
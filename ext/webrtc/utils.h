@@ -70,6 +70,13 @@ struct pad_block *      _create_pad_block           (GstElement * element,
                                                      gpointer user_data,
                                                      GDestroyNotify notify);
 
+G_GNUC_INTERNAL
+SharedWorker *          _shared_worker_acquire      (const gchar * name);
+G_GNUC_INTERNAL
+GMainContext *          _shared_worker_get_context  (SharedWorker * worker);
+G_GNUC_INTERNAL
+void                    _shared_worker_release      (SharedWorker * worker);
+
 G_GNUC_INTERNAL
 gchar *                 _enum_value_to_string       (GType type, guint value);
 G_GNUC_INTERNAL
@@ -138,6 +138,23 @@ priority_uint_to_type (guint16 val)
   return GST_WEBRTC_PRIORITY_TYPE_HIGH;
 }
 
+/* sctpenc schedules the SCTP stream according to the priority in the caps */
+static void
+_update_appsrc_caps (GstWebRTCDataChannel * channel)
+{
+  GstCaps *caps;
+  guint16 priority;
+
+  GST_OBJECT_LOCK (channel);
+  priority = priority_type_to_uint (channel->priority);
+  GST_OBJECT_UNLOCK (channel);
+
+  caps = gst_caps_new_simple ("application/x-data-channel", "priority",
+      G_TYPE_UINT, (guint) priority, NULL);
+  gst_app_src_set_caps (GST_APP_SRC (channel->appsrc), caps);
+  gst_caps_unref (caps);
+}
+
 static GstBuffer *
 construct_open_packet (GstWebRTCDataChannel * channel)
 {
@@ -510,6 +527,8 @@ _parse_control_packet (GstWebRTCDataChannel * channel, guint8 * data,
 
     _channel_enqueue_task (channel, (ChannelTask) _emit_on_open, NULL, NULL);
 
+    _update_appsrc_caps (channel);
+
     GST_INFO_OBJECT (channel, "Sending channel ack");
     buffer = construct_ack_packet (channel);
 
@@ -923,6 +942,8 @@ gst_webrtc_data_channel_set_sctp_transport (GstWebRTCDataChannel * channel,
   g_return_if_fail (GST_IS_WEBRTC_DATA_CHANNEL (channel));
   g_return_if_fail (GST_IS_WEBRTC_SCTP_TRANSPORT (sctp));
 
+  _update_appsrc_caps (channel);
+
   GST_OBJECT_LOCK (channel);
   if (channel->sctp_transport)
     g_signal_handlers_disconnect_by_data (channel->sctp_transport, channel);
@@ -82,6 +82,12 @@ GST_DEBUG_CATEGORY_STATIC (gst_field_analysis_debug);
 #define DEFAULT_BLOCK_HEIGHT 16
 #define DEFAULT_BLOCK_THRESH 80
 #define DEFAULT_IGNORED_LINES 2
+#define DEFAULT_N_THREADS 0
+
+/* Don't bother other threads with less lines than this */
+#define MIN_LINES_PER_JOB 16
+/* Upper limit for the number of threads used to analyse a frame */
+#define MAX_THREADS 64
 
 enum
 {
@@ -96,7 +102,8 @@ enum
   PROP_BLOCK_WIDTH,
   PROP_BLOCK_HEIGHT,
   PROP_BLOCK_THRESH,
-  PROP_IGNORED_LINES
+  PROP_IGNORED_LINES,
+  PROP_N_THREADS
 };
 
 static GstStaticPadTemplate sink_factory =
@@ -125,6 +132,22 @@ static void gst_field_analysis_finalize (GObject * self);
 
 static GQueue *gst_field_analysis_flush_frames (GstFieldAnalysis * filter);
 
+typedef struct _FieldAnalysisJob FieldAnalysisJob;
+typedef void (*FieldAnalysisJobFunc) (FieldAnalysisJob * job);
+
+/* a band of lines or rows of blocks of the fields being compared, the metrics
+ * split each frame into these and hand them to the worker pool */
+struct _FieldAnalysisJob
+{
+  GstFieldAnalysis *filter;
+  FieldAnalysisFields (*history)[2];
+  FieldAnalysisJobFunc func;
+  gpointer data;
+  gint index;
+  gint start, end;
+  guint64 result;
+};
+
 typedef enum
 {
   GST_FIELDANALYSIS_SAD,
@@ -170,8 +193,7 @@ gst_fieldanalysis_frame_metric_get_type (void)
   if (!fieldanalysis_frame_metric_type) {
     static const GEnumValue fieldanalyis_frame_metrics[] = {
       {GST_FIELDANALYSIS_5_TAP, "5-tap [1,-3,4,-3,1] Vertical Filter", "5-tap"},
-      {GST_FIELDANALYSIS_WINDOWED_COMB,
-            "Windowed Comb Detection (not optimised)",
+      {GST_FIELDANALYSIS_WINDOWED_COMB, "Windowed Comb Detection",
           "windowed-comb"},
       {0, NULL, NULL},
     };
@@ -274,6 +296,19 @@ gst_field_analysis_class_init (GstFieldAnalysisClass * klass)
           "Ignore this many lines from the top and bottom for windowed comb detection",
           2, G_MAXUINT64, DEFAULT_IGNORED_LINES,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFieldAnalysis:n-threads:
+   *
+   * Number of threads the lines of each frame are analysed with, or 0 to use
+   * one thread per processor.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Number of threads to analyse with (0 = one per processor)",
+          0, MAX_THREADS, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_field_analysis_change_state);
@@ -297,12 +332,6 @@ static gfloat same_parity_3_tap (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2]);
 static gfloat opposite_parity_5_tap (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2]);
-static guint64 block_score_for_row_32detect (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1);
-static guint64 block_score_for_row_iscombed (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1);
-static guint64 block_score_for_row_5_tap (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1);
 static gfloat opposite_parity_windowed_comb (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2]);
 
@@ -327,8 +356,7 @@ gst_field_analysis_reset (GstFieldAnalysis * filter)
   gst_video_info_init (&filter->vinfo);
   g_free (filter->comb_mask);
   filter->comb_mask = NULL;
-  g_free (filter->block_scores);
-  filter->block_scores = NULL;
+  filter->comb_mask_size = 0;
 }
 
 static void
@@ -345,6 +373,9 @@ gst_field_analysis_init (GstFieldAnalysis * filter)
   gst_element_add_pad (GST_ELEMENT (filter), filter->sinkpad);
   gst_element_add_pad (GST_ELEMENT (filter), filter->srcpad);
 
+  g_mutex_init (&filter->lock);
+  g_cond_init (&filter->cond);
+
   filter->nframes = 0;
   gst_field_analysis_reset (filter);
   filter->same_field = &same_parity_ssd;
@@ -352,12 +383,13 @@ gst_field_analysis_init (GstFieldAnalysis * filter)
   filter->same_frame = &opposite_parity_5_tap;
   filter->frame_thresh = DEFAULT_FRAME_THRESH;
   filter->noise_floor = DEFAULT_NOISE_FLOOR;
-  filter->block_score_for_row = &block_score_for_row_5_tap;
+  filter->comb_method = DEFAULT_COMB_METHOD;
   filter->spatial_thresh = DEFAULT_SPATIAL_THRESH;
   filter->block_width = DEFAULT_BLOCK_WIDTH;
   filter->block_height = DEFAULT_BLOCK_HEIGHT;
   filter->block_thresh = DEFAULT_BLOCK_THRESH;
   filter->ignored_lines = DEFAULT_IGNORED_LINES;
+  filter->n_threads = DEFAULT_N_THREADS;
 }
 
 static void
@@ -404,37 +436,13 @@ gst_field_analysis_set_property (GObject * object, guint prop_id,
       filter->frame_thresh = g_value_get_float (value);
       break;
     case PROP_COMB_METHOD:
-      switch (g_value_get_enum (value)) {
-        case METHOD_32DETECT:
-          filter->block_score_for_row = &block_score_for_row_32detect;
-          break;
-        case METHOD_IS_COMBED:
-          filter->block_score_for_row = &block_score_for_row_iscombed;
-          break;
-        case METHOD_5_TAP:
-          filter->block_score_for_row = &block_score_for_row_5_tap;
-          break;
-        default:
-          break;
-      }
+      filter->comb_method = g_value_get_enum (value);
       break;
     case PROP_SPATIAL_THRESH:
       filter->spatial_thresh = g_value_get_int64 (value);
       break;
     case PROP_BLOCK_WIDTH:
       filter->block_width = g_value_get_uint64 (value);
-      if (GST_VIDEO_FRAME_WIDTH (&filter->frames[0].frame)) {
-        const gint frame_width =
-            GST_VIDEO_FRAME_WIDTH (&filter->frames[0].frame);
-        if (filter->block_scores) {
-          gsize nbytes = (frame_width / filter->block_width) * sizeof (guint);
-          filter->block_scores = g_realloc (filter->block_scores, nbytes);
-          memset (filter->block_scores, 0, nbytes);
-        } else {
-          filter->block_scores =
-              g_malloc0 ((frame_width / filter->block_width) * sizeof (guint));
-        }
-      }
       break;
     case PROP_BLOCK_HEIGHT:
       filter->block_height = g_value_get_uint64 (value);
@@ -445,6 +453,11 @@ gst_field_analysis_set_property (GObject * object, guint prop_id,
     case PROP_IGNORED_LINES:
       filter->ignored_lines = g_value_get_uint64 (value);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      filter->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -492,18 +505,8 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
       g_value_set_float (value, filter->frame_thresh);
       break;
     case PROP_COMB_METHOD:
-    {
-      FieldAnalysisCombMethod method = DEFAULT_COMB_METHOD;
-      if (filter->block_score_for_row == &block_score_for_row_32detect) {
-        method = METHOD_32DETECT;
-      } else if (filter->block_score_for_row == &block_score_for_row_iscombed) {
-        method = METHOD_IS_COMBED;
-      } else if (filter->block_score_for_row == &block_score_for_row_5_tap) {
-        method = METHOD_5_TAP;
-      }
-      g_value_set_enum (value, method);
+      g_value_set_enum (value, filter->comb_method);
       break;
-    }
     case PROP_SPATIAL_THRESH:
       g_value_set_int64 (value, filter->spatial_thresh);
       break;
@@ -519,6 +522,11 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
     case PROP_IGNORED_LINES:
       g_value_set_uint64 (value, filter->ignored_lines);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_uint (value, filter->n_threads);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -528,7 +536,6 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
 static void
 gst_field_analysis_update_format (GstFieldAnalysis * filter, GstCaps * caps)
 {
-  gint width;
   GQueue *outbufs;
   GstVideoInfo vinfo;
 
@@ -563,25 +570,7 @@ gst_field_analysis_update_format (GstFieldAnalysis * filter, GstCaps * caps)
 
   GST_OBJECT_LOCK (filter);
   filter->flushing = FALSE;
-
   filter->vinfo = vinfo;
-  width = GST_VIDEO_INFO_WIDTH (&filter->vinfo);
-
-  /* update allocations for metric scores */
-  if (filter->comb_mask) {
-    filter->comb_mask = g_realloc (filter->comb_mask, width);
-  } else {
-    filter->comb_mask = g_malloc (width);
-  }
-  if (filter->block_scores) {
-    gsize nbytes = (width / filter->block_width) * sizeof (guint);
-    filter->block_scores = g_realloc (filter->block_scores, nbytes);
-    memset (filter->block_scores, 0, nbytes);
-  } else {
-    filter->block_scores =
-        g_malloc0 ((width / filter->block_width) * sizeof (guint));
-  }
-
   GST_OBJECT_UNLOCK (filter);
   return;
 }
@@ -801,122 +790,196 @@ gst_field_analysis_sink_event (GstPad * pad, GstObject * parent,
   return ret;
 }
 
+/* first line of the field of interest of a frame */
+static inline guint8 *
+field_analysis_get_field (FieldAnalysisFields * field)
+{
+  return GST_VIDEO_FRAME_COMP_DATA (&field->frame, 0) +
+      GST_VIDEO_FRAME_COMP_OFFSET (&field->frame, 0) +
+      field->parity * GST_VIDEO_FRAME_COMP_STRIDE (&field->frame, 0);
+}
 
-static gfloat
-same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
+static void
+gst_field_analysis_job_func (gpointer data, gpointer user_data)
+{
+  GstFieldAnalysis *filter = GST_FIELDANALYSIS (user_data);
+  FieldAnalysisJob *job = data;
+
+  job->func (job);
+
+  g_mutex_lock (&filter->lock);
+  if (--filter->n_pending == 0)
+    g_cond_signal (&filter->cond);
+  g_mutex_unlock (&filter->lock);
+}
+
+static gint
+gst_field_analysis_get_max_jobs (GstFieldAnalysis * filter)
+{
+  if (!filter->pool)
+    return 1;
+
+  return g_thread_pool_get_max_threads (filter->pool) + 1;
+}
+
+/* splits n_items lines or rows of blocks into bands of at least min_items,
+ * runs func on each band, spread over the worker pool, and returns the number
+ * of bands. the results are left in jobs, which must have room for
+ * MAX_THREADS entries */
+static gint
+gst_field_analysis_run_jobs (GstFieldAnalysis * filter,
+    FieldAnalysisFields (*history)[2], FieldAnalysisJobFunc func,
+    gint n_items, gint min_items, gpointer data, FieldAnalysisJob * jobs)
+{
+  gint i, n_jobs;
+
+  n_jobs = gst_field_analysis_get_max_jobs (filter);
+  n_jobs = MIN (n_jobs, n_items / MAX (min_items, 1));
+  n_jobs = MAX (n_jobs, 1);
+
+  for (i = 0; i < n_jobs; i++) {
+    jobs[i].filter = filter;
+    jobs[i].history = history;
+    jobs[i].func = func;
+    jobs[i].data = data;
+    jobs[i].index = i;
+    jobs[i].start = (gint64) n_items * i / n_jobs;
+    jobs[i].end = (gint64) n_items * (i + 1) / n_jobs;
+    jobs[i].result = 0;
+  }
+
+  if (n_jobs == 1) {
+    func (&jobs[0]);
+    return 1;
+  }
+
+  filter->n_pending = n_jobs - 1;
+
+  /* the streaming thread does the first band itself */
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (filter->pool, &jobs[i], NULL);
+
+  func (&jobs[0]);
+
+  g_mutex_lock (&filter->lock);
+  while (filter->n_pending > 0)
+    g_cond_wait (&filter->cond, &filter->lock);
+  g_mutex_unlock (&filter->lock);
+
+  return n_jobs;
+}
+
+/* runs func over the n_lines lines of a field and adds up the results */
+static guint64
+gst_field_analysis_sum_jobs (GstFieldAnalysis * filter,
+    FieldAnalysisFields (*history)[2], FieldAnalysisJobFunc func,
+    gint n_lines)
 {
+  FieldAnalysisJob jobs[MAX_THREADS];
+  gint i, n_jobs;
+  guint64 sum = 0;
+
+  n_jobs = gst_field_analysis_run_jobs (filter, history, func, n_lines,
+      MIN_LINES_PER_JOB, NULL, jobs);
+  for (i = 0; i < n_jobs; i++)
+    sum += jobs[i].result;
+
+  return sum;
+}
+
+typedef void (*SameParityFunc) (guint32 * ORC_RESTRICT a1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    int p1, int n);
+
+static inline void
+same_parity_job (FieldAnalysisJob * job, SameParityFunc func,
+    guint32 noise_floor)
+{
+  FieldAnalysisFields (*history)[2] = job->history;
   gint j;
-  gfloat sum;
   guint8 *f1j, *f2j;
 
   const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
-  const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
   const gint stride0x2 =
       GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
   const gint stride1x2 =
       GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
-  const guint32 noise_floor = filter->noise_floor;
-
-  f1j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame,
-      0) +
-      (*history)[0].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame,
-      0);
-  f2j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
-      0) +
-      (*history)[1].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame,
-      0);
-
-  sum = 0.0f;
-  for (j = 0; j < (height >> 1); j++) {
+
+  f1j = field_analysis_get_field (&(*history)[0]) + job->start * stride0x2;
+  f2j = field_analysis_get_field (&(*history)[1]) + job->start * stride1x2;
+
+  for (j = job->start; j < job->end; j++) {
     guint32 tempsum = 0;
-    fieldanalysis_orc_same_parity_sad_planar_yuv (&tempsum, f1j, f2j,
-        noise_floor, width);
-    sum += tempsum;
+    func (&tempsum, f1j, f2j, noise_floor, width);
+    job->result += tempsum;
     f1j += stride0x2;
     f2j += stride1x2;
   }
+}
+
+static void
+same_parity_sad_job (FieldAnalysisJob * job)
+{
+  same_parity_job (job, fieldanalysis_orc_same_parity_sad_planar_yuv,
+      job->filter->noise_floor);
+}
+
+static gfloat
+same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
+{
+  guint64 sum;
+
+  const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
+  const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
+
+  sum = gst_field_analysis_sum_jobs (filter, history, same_parity_sad_job,
+      height >> 1);
 
   return sum / (0.5f * width * height);
 }
 
+static void
+same_parity_ssd_job (FieldAnalysisJob * job)
+{
+  /* noise floor needs to be squared for SSD */
+  same_parity_job (job, fieldanalysis_orc_same_parity_ssd_planar_yuv,
+      job->filter->noise_floor * job->filter->noise_floor);
+}
+
 static gfloat
 same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
 {
-  gint j;
-  gfloat sum;
-  guint8 *f1j, *f2j;
+  guint64 sum;
 
   const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
   const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
-  const gint stride0x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const gint stride1x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
-  /* noise floor needs to be squared for SSD */
-  const guint32 noise_floor = filter->noise_floor * filter->noise_floor;
-
-  f1j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame,
-      0) +
-      (*history)[0].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame,
-      0);
-  f2j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
-      0) +
-      (*history)[1].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame,
-      0);
-
-  sum = 0.0f;
-  for (j = 0; j < (height >> 1); j++) {
-    guint32 tempsum = 0;
-    fieldanalysis_orc_same_parity_ssd_planar_yuv (&tempsum, f1j, f2j,
-        noise_floor, width);
-    sum += tempsum;
-    f1j += stride0x2;
-    f2j += stride1x2;
-  }
+
+  sum = gst_field_analysis_sum_jobs (filter, history, same_parity_ssd_job,
+      height >> 1);
 
   return sum / (0.5f * width * height); /* field is half height */
 }
 
-/* horizontal [1,4,1] diff between fields - is this a good idea or should the
- * current sample be emphasised more or less? */
-static gfloat
-same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
+static void
+same_parity_3_tap_job (FieldAnalysisJob * job)
 {
+  FieldAnalysisFields (*history)[2] = job->history;
   gint i, j;
-  gfloat sum;
   guint8 *f1j, *f2j;
 
   const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
-  const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
   const gint stride0x2 =
       GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
   const gint stride1x2 =
       GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
   const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
   /* noise floor needs to be *6 for [1,4,1] */
-  const guint32 noise_floor = filter->noise_floor * 6;
-
-  f1j = GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame, 0) +
-      GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame, 0) +
-      (*history)[0].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame,
-      0);
-  f2j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
-      0) +
-      (*history)[1].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame,
-      0);
-
-  sum = 0.0f;
-  for (j = 0; j < (height >> 1); j++) {
+  const guint32 noise_floor = job->filter->noise_floor * 6;
+
+  f1j = field_analysis_get_field (&(*history)[0]) + job->start * stride0x2;
+  f2j = field_analysis_get_field (&(*history)[1]) + job->start * stride1x2;
+
+  for (j = job->start; j < job->end; j++) {
     guint32 tempsum = 0;
     guint32 diff;
 
@@ -924,49 +987,53 @@ same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
     diff = abs (((f1j[0] << 2) + (f1j[incr] << 1))
         - ((f2j[0] << 2) + (f2j[incr] << 1)));
     if (diff > noise_floor)
-      sum += diff;
+      job->result += diff;
 
     fieldanalysis_orc_same_parity_3_tap_planar_yuv (&tempsum, f1j, &f1j[incr],
         &f1j[incr << 1], f2j, &f2j[incr], &f2j[incr << 1], noise_floor,
         width - 1);
-    sum += tempsum;
+    job->result += tempsum;
 
     /* unroll last as it is a special case */
     i = width - 1;
     diff = abs (((f1j[i - incr] << 1) + (f1j[i] << 2))
         - ((f2j[i - incr] << 1) + (f2j[i] << 2)));
     if (diff > noise_floor)
-      sum += diff;
+      job->result += diff;
 
     f1j += stride0x2;
     f2j += stride1x2;
   }
+}
+
+/* horizontal [1,4,1] diff between fields - is this a good idea or should the
+ * current sample be emphasised more or less? */
+static gfloat
+same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
+{
+  guint64 sum;
+
+  const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
+  const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
+
+  sum = gst_field_analysis_sum_jobs (filter, history, same_parity_3_tap_job,
+      height >> 1);
 
   return sum / ((6.0f / 2.0f) * width * height);        /* 1 + 4 + 1 = 6; field is half height */
 }
 
-/* vertical [1,-3,4,-3,1] - same as is used in FieldDiff from TIVTC,
- * tritical's AVISynth IVTC filter */
-/* 0th field's parity defines operation */
-static gfloat
-opposite_parity_5_tap (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2])
+static void
+opposite_parity_5_tap_job (FieldAnalysisJob * job)
 {
+  FieldAnalysisFields (*history)[2] = job->history;
   gint j;
-  gfloat sum;
-  guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
-  guint32 tempsum;
+  guint8 *fa, *fb;
+  gint stridea2, strideb2;
 
   const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
-  const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
-  const gint stride0x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const gint stride1x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
+  const gint last = (GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame) >> 1) - 1;
   /* noise floor needs to be *6 for [1,-3,4,-3,1] */
-  const guint32 noise_floor = filter->noise_floor * 6;
-
-  sum = 0.0f;
+  const guint32 noise_floor = job->filter->noise_floor * 6;
 
   /* fj is line j of the combined frame made from the top field even lines of
    *   field 0 and the bottom field odd lines from field 1
@@ -974,348 +1041,240 @@ opposite_parity_5_tap (GstFieldAnalysis * filter,
    * fjm2 is two lines up from fj
    * fj with j == 0 is the 0th line of the top field
    * fj with j == 1 is the 0th line of the bottom field or the 1st field of
-   *   the frame*/
-
-  /* unroll first line as it is a special case */
+   *   the frame
+   * fa holds the lines of the top field and fb those of the bottom field */
   if ((*history)[0].parity == TOP_FIELD) {
-    fj = GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
+    fa = GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame, 0);
-    fjp1 =
-        GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
+    fb = GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
         0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0);
-    fjp2 = fj + stride0x2;
+    stridea2 = GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
+    strideb2 = GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
   } else {
-    fj = GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
+    fa = GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame, 0);
-    fjp1 =
-        GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
+    fb = GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame,
         0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
-    fjp2 = fj + stride1x2;
+    stridea2 = GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
+    strideb2 = GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
   }
 
-  tempsum = 0;
-  fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjp2, fjp1, fj,
-      fjp1, fjp2, noise_floor, width);
-  sum += tempsum;
-
-  for (j = 1; j < (height >> 1) - 1; j++) {
-    /* shift everything down a line in the field of interest (means += stridex2) */
-    fjm2 = fj;
-    fjm1 = fjp1;
-    fj = fjp2;
-    if ((*history)[0].parity == TOP_FIELD) {
-      fjp1 += stride1x2;
-      fjp2 += stride0x2;
+  for (j = job->start; j < job->end; j++) {
+    guint8 *fj = fa + j * stridea2;
+    guint8 *fjp1 = fb + j * strideb2;
+    guint32 tempsum = 0;
+
+    if (j == 0) {
+      /* the first line is a special case, mirror the lines below */
+      fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum,
+          fj + stridea2, fjp1, fj, fjp1, fj + stridea2, noise_floor, width);
+    } else if (j == last) {
+      /* as is the last line, mirror the lines above */
+      fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum,
+          fj - stridea2, fjp1 - strideb2, fj, fjp1 - strideb2, fj - stridea2,
+          noise_floor, width);
     } else {
-      fjp1 += stride0x2;
-      fjp2 += stride1x2;
+      fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum,
+          fj - stridea2, fjp1 - strideb2, fj, fjp1, fj + stridea2,
+          noise_floor, width);
     }
-
-    tempsum = 0;
-    fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjm2, fjm1,
-        fj, fjp1, fjp2, noise_floor, width);
-    sum += tempsum;
+    job->result += tempsum;
   }
+}
 
-  /* unroll the last line as it is a special case */
-  /* shift everything down a line in the field of interest (means += stridex2) */
-  fjm2 = fj;
-  fjm1 = fjp1;
-  fj = fjp2;
+/* vertical [1,-3,4,-3,1] - same as is used in FieldDiff from TIVTC,
+ * tritical's AVISynth IVTC filter */
+/* 0th field's parity defines operation */
+static gfloat
+opposite_parity_5_tap (GstFieldAnalysis * filter,
+    FieldAnalysisFields (*history)[2])
+{
+  guint64 sum;
 
-  tempsum = 0;
-  fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjm2, fjm1, fj,
-      fjm1, fjm2, noise_floor, width);
-  sum += tempsum;
+  const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
+  const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
+
+  sum = gst_field_analysis_sum_jobs (filter, history,
+      opposite_parity_5_tap_job, height >> 1);
 
   return sum / ((6.0f / 2.0f) * width * height);        /* 1 + 4 + 1 == 3 + 3 == 6; field is half height */
 }
 
-/* this metric was sourced from HandBrake but originally from transcode
- * the return value is the highest block score for the row of blocks */
-static inline guint64
-block_score_for_row_32detect (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1)
+/* parameters of one windowed comb pass, shared by all of its jobs */
+typedef struct
 {
-  guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
-  guint8 *fjm2, *fjm1, *fj, *fjp1;
-  const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
-  const gint stridex2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const guint64 block_width = filter->block_width;
-  const guint64 block_height = filter->block_height;
-  const gint64 spatial_thresh = filter->spatial_thresh;
-  const gint width =
-      GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
-      (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
-
-  fjm2 = base_fj - stridex2;
-  fjm1 = base_fjp1 - stridex2;
-  fj = base_fj;
-  fjp1 = base_fjp1;
-
-  for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
-
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
-    /* change in the same direction */
-    if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-        || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] = abs (fj[0] - fjm2[0]) < 10 && abs (fj[0] - fjm1[0]) > 15;
-    } else {
-      comb_mask[0] = FALSE;
-    }
-
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
+  FieldAnalysisCombMethod method;
+  const guint8 *base_fj, *base_fjp1;
+  gint stride, incr, width;
+  gint spatial_thresh;
+  guint64 ignored_lines;
+  guint64 block_width, block_height, block_thresh;
+  /* set once a band found a combed block, the others can stop then */
+  gint combed;
+} FieldAnalysisWindowedComb;
+
+/* line k of the frame made from the lines starting at base_fj and base_fjp1
+ * interleaved, k may be negative */
+static inline const guint8 *
+windowed_comb_line (const guint8 * base_fj, const guint8 * base_fjp1,
+    gint stridex2, gint k)
+{
+  if (k & 1)
+    return base_fjp1 + ((k - 1) / 2) * stridex2;
 
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] = abs (fj[idx] - fjm2[idx]) < 10
-            && abs (fj[idx] - fjm1[idx]) > 15;
-      } else {
-        comb_mask[i] = FALSE;
-      }
+  return base_fj + (k / 2) * stridex2;
+}
 
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
-    }
-    /* advance down a line */
-    fjm2 = fjm1;
-    fjm1 = fj;
-    fj = fjp1;
-    fjp1 = fjm1 + stridex2;
-  }
+/* the comb detection metrics for samples that are not contiguous, see
+ * windowed_comb_mask () */
+static void
+windowed_comb_mask_packed (FieldAnalysisCombMethod method, guint16 * mask,
+    const guint8 * fjm2, const guint8 * fjm1, const guint8 * fj,
+    const guint8 * fjp1, const guint8 * fjp2, gint incr, gint spatial_thresh,
+    gint width)
+{
+  gint i;
 
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
-  }
+  for (i = 0; i < width; i++) {
+    const gint idx = i * incr;
+    const gint diff1 = fj[idx] - fjm1[idx];
+    const gint diff2 = fj[idx] - fjp1[idx];
 
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
-}
+    mask[i] = 0;
 
-/* this metric was sourced from HandBrake but originally from
- * tritical's isCombedT Avisynth function
- * the return value is the highest block score for the row of blocks */
-static inline guint64
-block_score_for_row_iscombed (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1)
-{
-  guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
-  guint8 *fjm1, *fj, *fjp1;
-  const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
-  const gint stridex2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const guint64 block_width = filter->block_width;
-  const guint64 block_height = filter->block_height;
-  const gint64 spatial_thresh = filter->spatial_thresh;
-  const gint64 spatial_thresh_squared = spatial_thresh * spatial_thresh;
-  const gint width =
-      GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
-      (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
-
-  fjm1 = base_fjp1 - stridex2;
-  fj = base_fj;
-  fjp1 = base_fjp1;
-
-  for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
-
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
     /* change in the same direction */
     if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
         || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] =
-          (fjm1[0] - fj[0]) * (fjp1[0] - fj[0]) > spatial_thresh_squared;
-    } else {
-      comb_mask[0] = FALSE;
-    }
-
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] =
-            (fjm1[idx] - fj[idx]) * (fjp1[idx] - fj[idx]) >
-            spatial_thresh_squared;
-      } else {
-        comb_mask[i] = FALSE;
-      }
-
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
+      switch (method) {
+        case METHOD_32DETECT:
+          mask[i] = abs (fj[idx] - fjm2[idx]) < 10 && abs (diff1) > 15;
+          break;
+        case METHOD_IS_COMBED:
+          mask[i] = 1;
+          break;
+        case METHOD_5_TAP:
+          mask[i] = abs (fjm2[idx] + (fj[idx] << 2) + fjp2[idx] -
+              3 * (fjm1[idx] + fjp1[idx])) > 6 * spatial_thresh;
+          break;
       }
     }
-    /* advance down a line */
-    fjm1 = fj;
-    fj = fjp1;
-    fjp1 = fjm1 + stridex2;
   }
+}
 
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
+/* marks the combed samples of line k of a row of blocks with 1 in mask.
+ *
+ * 32-detect was sourced from HandBrake but originally from transcode:
+ * difference to above sample in same field small and difference to sample in
+ * other field large.
+ *
+ * isCombed was sourced from HandBrake but originally from tritical's isCombedT
+ * Avisynth function. it also requires the product of the differences to the
+ * samples above and below to be larger than the squared spatial threshold,
+ * which always holds when both differences are larger than the threshold in
+ * the same direction, so only that is tested.
+ *
+ * 5-tap runs a [1,-3,4,-3,1] vertical filter over the samples that change in
+ * the same direction. */
+static void
+windowed_comb_mask (FieldAnalysisWindowedComb * comb, guint16 * mask,
+    const guint8 * base_fj, const guint8 * base_fjp1, gint k)
+{
+  const gint stridex2 = comb->stride << 1;
+  const gint st = comb->spatial_thresh;
+  const guint8 *fjm2 = windowed_comb_line (base_fj, base_fjp1, stridex2, k - 2);
+  const guint8 *fjm1 = windowed_comb_line (base_fj, base_fjp1, stridex2, k - 1);
+  const guint8 *fj = windowed_comb_line (base_fj, base_fjp1, stridex2, k);
+  const guint8 *fjp1 = windowed_comb_line (base_fj, base_fjp1, stridex2, k + 1);
+  const guint8 *fjp2 = windowed_comb_line (base_fj, base_fjp1, stridex2, k + 2);
+
+  if (comb->incr != 1) {
+    windowed_comb_mask_packed (comb->method, mask, fjm2, fjm1, fj, fjp1, fjp2,
+        comb->incr, st, comb->width);
+    return;
   }
 
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
+  switch (comb->method) {
+    case METHOD_32DETECT:
+      fieldanalysis_orc_comb_mask_32detect (mask, fjm2, fjm1, fj, fjp1, st,
+          comb->width);
+      break;
+    case METHOD_IS_COMBED:
+      fieldanalysis_orc_comb_mask_iscombed (mask, fjm1, fj, fjp1, st,
+          comb->width);
+      break;
+    case METHOD_5_TAP:
+      fieldanalysis_orc_comb_mask_5_tap (mask, fjm2, fjm1, fj, fjp1, fjp2, st,
+          6 * st, comb->width);
+      break;
+  }
 }
 
-/* this metric was sourced from HandBrake but originally from
- * tritical's isCombedT Avisynth function
- * the return value is the highest block score for the row of blocks */
-static inline guint64
-block_score_for_row_5_tap (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1)
+/* scores the rows of blocks from job->start to job->end, leaving 2 in the
+ * result if a block is combed, 1 if one is slightly combed or 0 */
+static void
+windowed_comb_job (FieldAnalysisJob * job)
 {
-  guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
-  guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
-  const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
-  const gint stridex2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const guint64 block_width = filter->block_width;
-  const guint64 block_height = filter->block_height;
-  const gint64 spatial_thresh = filter->spatial_thresh;
-  const gint64 spatial_threshx6 = 6 * spatial_thresh;
-  const gint width =
-      GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
-      (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
-
-
-  fjm2 = base_fj - stridex2;
-  fjm1 = base_fjp1 - stridex2;
-  fj = base_fj;
-  fjp1 = base_fjp1;
-  fjp2 = fj + stridex2;
-
-  for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
-
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
-    /* change in the same direction */
-    if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-        || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] =
-          abs (fjm2[0] + (fj[0] << 2) + fjp2[0] - 3 * (fjm1[0] + fjp1[0])) >
-          spatial_threshx6;
-
-      /* motion detection that needs previous and next frames
-         this isn't really necessary, but acts as an optimisation if the
-         additional delay isn't a problem
-         if (motion_detection) {
-         if (abs(fpj[idx] - fj[idx]               ) > motion_thresh &&
-         abs(           fjm1[idx] - fnjm1[idx]) > motion_thresh &&
-         abs(           fjp1[idx] - fnjp1[idx]) > motion_thresh)
-         motion++;
-         if (abs(             fj[idx]   - fnj[idx]) > motion_thresh &&
-         abs(fpjm1[idx] - fjm1[idx]           ) > motion_thresh &&
-         abs(fpjp1[idx] - fjp1[idx]           ) > motion_thresh)
-         motion++;
-         } else {
-         motion = 1;
-         }
-       */
-    } else {
-      comb_mask[0] = FALSE;
+  FieldAnalysisWindowedComb *comb = job->data;
+  gint i, k, row;
+  guint16 *mask, *counts, *next_counts;
+
+  const gint width = comb->width;
+  const gint block_width = comb->block_width;
+  const gint block_height = comb->block_height;
+
+  /* the mask has one extra sample on each side, the samples beyond the edges
+   * count as combed */
+  mask = job->filter->comb_mask + job->index * (3 * width + 2);
+  counts = mask + width + 2;
+  next_counts = counts + width;
+  mask[0] = mask[width + 1] = 1;
+
+  for (row = job->start; row < job->end; row++) {
+    const gint64 line_offset =
+        (comb->ignored_lines + row * comb->block_height) * comb->stride;
+    const guint8 *base_fj = comb->base_fj + line_offset;
+    const guint8 *base_fjp1 = comb->base_fjp1 + line_offset;
+    guint64 block_score = 0;
+
+    /* another band already found the frame to be combed */
+    if (g_atomic_int_get (&comb->combed))
+      return;
+
+    /* a sample counts towards the score of its block if it is combed and so
+     * are its left and right neighbours */
+    memset (counts, 0, width * sizeof (guint16));
+    for (k = 0; k < block_height; k++) {
+      guint16 *tmp;
+
+      windowed_comb_mask (comb, mask + 1, base_fj, base_fjp1, k);
+      fieldanalysis_orc_comb_count (next_counts, counts, mask, mask + 1,
+          mask + 2, width);
+
+      tmp = counts;
+      counts = next_counts;
+      next_counts = tmp;
     }
 
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] =
-            abs (fjm2[idx] + (fj[idx] << 2) + fjp2[idx] - 3 * (fjm1[idx] +
-                fjp1[idx])) > spatial_threshx6;
-      } else {
-        comb_mask[i] = FALSE;
-      }
+    for (i = 0; i < width; i += block_width) {
+      guint64 score = 0;
+      gint x;
 
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
+      for (x = i; x < i + block_width; x++)
+        score += counts[x];
+      block_score = MAX (block_score, score);
     }
-    /* advance down a line */
-    fjm2 = fjm1;
-    fjm1 = fj;
-    fj = fjp1;
-    fjp1 = fjp2;
-    fjp2 = fj + stridex2;
-  }
 
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
+    if (block_score > comb->block_thresh) {
+      g_atomic_int_set (&comb->combed, TRUE);
+      job->result = 2;
+      return;
+    } else if (block_score > (comb->block_thresh >> 1)) {
+      /* blend if nothing more combed comes along */
+      job->result = 1;
+    }
   }
-
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
 }
 
 /* a pass is made over the field using one of three comb-detection metrics
@@ -1331,57 +1290,79 @@ static gfloat
 opposite_parity_windowed_comb (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2])
 {
-  gint j;
-  gboolean slightly_combed;
+  FieldAnalysisJob jobs[MAX_THREADS];
+  FieldAnalysisWindowedComb comb;
+  gint i, n_jobs, n_rows;
+  gsize mask_size;
+  guint64 result;
 
+  const gint frame_width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
   const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
-  const gint stride = GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
-  const guint64 block_thresh = filter->block_thresh;
-  const guint64 block_height = filter->block_height;
-  guint8 *base_fj, *base_fjp1;
 
   if ((*history)[0].parity == TOP_FIELD) {
-    base_fj =
+    comb.base_fj =
         GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame, 0);
-    base_fjp1 =
+    comb.base_fjp1 =
         GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
         0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0);
   } else {
-    base_fj =
+    comb.base_fj =
         GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame, 0);
-    base_fjp1 =
+    comb.base_fjp1 =
         GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame,
         0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
   }
 
-  /* we operate on a row of blocks of height block_height through each iteration */
-  slightly_combed = FALSE;
-  for (j = 0; j <= height - filter->ignored_lines - block_height;
-      j += block_height) {
-    guint64 line_offset = (filter->ignored_lines + j) * stride;
-    guint block_score =
-        filter->block_score_for_row (filter, history, base_fj + line_offset,
-        base_fjp1 + line_offset);
-
-    if (block_score > (block_thresh >> 1)
-        && block_score <= block_thresh) {
-      /* blend if nothing more combed comes along */
-      slightly_combed = TRUE;
-    } else if (block_score > block_thresh) {
-      if (GST_VIDEO_INFO_INTERLACE_MODE (&(*history)[0].frame.info) ==
-          GST_VIDEO_INTERLACE_MODE_INTERLEAVED) {
-        return 1.0f;            /* blend */
-      } else {
-        return 2.0f;            /* deinterlace */
-      }
+  comb.method = filter->comb_method;
+  comb.stride = GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
+  comb.incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
+  comb.width = frame_width - (frame_width % filter->block_width);
+  /* the differences of 8-bit samples are never larger than this */
+  comb.spatial_thresh = MIN (filter->spatial_thresh, 255);
+  comb.ignored_lines = filter->ignored_lines;
+  comb.block_width = filter->block_width;
+  comb.block_height = filter->block_height;
+  comb.block_thresh = filter->block_thresh;
+  comb.combed = FALSE;
+
+  /* we operate on a row of blocks of height block_height through each
+   * iteration. the metrics look up to two lines beyond the block, so the
+   * ignored lines at the bottom are skipped as well as those at the top */
+  if (comb.width == 0 || comb.block_height == 0
+      || 2 * comb.ignored_lines + comb.block_height > height)
+    return 0.0f;
+  n_rows = (height - 2 * comb.ignored_lines - comb.block_height) /
+      comb.block_height + 1;
+
+  /* per band masks and counts */
+  mask_size = gst_field_analysis_get_max_jobs (filter) * (3 * comb.width + 2);
+  if (mask_size > filter->comb_mask_size) {
+    g_free (filter->comb_mask);
+    filter->comb_mask = g_new (guint16, mask_size);
+    filter->comb_mask_size = mask_size;
+  }
+
+  n_jobs = gst_field_analysis_run_jobs (filter, history, windowed_comb_job,
+      n_rows, MIN_LINES_PER_JOB / comb.block_height, &comb, jobs);
+
+  result = 0;
+  for (i = 0; i < n_jobs; i++)
+    result = MAX (result, jobs[i].result);
+
+  if (result == 2) {
+    if (GST_VIDEO_INFO_INTERLACE_MODE (&(*history)[0].frame.info) ==
+        GST_VIDEO_INTERLACE_MODE_INTERLEAVED) {
+      return 1.0f;              /* blend */
+    } else {
+      return 2.0f;              /* deinterlace */
     }
   }
 
-  return (gfloat) slightly_combed;      /* TRUE means blend, else don't */
+  return (gfloat) result;       /* 1 means blend, else don't */
 }
 
 /* this is where the magic happens
@@ -1789,6 +1770,43 @@ unref_unlock_ret:
   return ret;
 }
 
+static void
+gst_field_analysis_start_pool (GstFieldAnalysis * filter)
+{
+  guint n_threads;
+  GError *err = NULL;
+
+  GST_OBJECT_LOCK (filter);
+  n_threads = filter->n_threads;
+  GST_OBJECT_UNLOCK (filter);
+
+  if (n_threads == 0)
+    n_threads = MIN (g_get_num_processors (), MAX_THREADS);
+
+  /* the streaming thread always analyses one band itself */
+  if (n_threads > 1) {
+    filter->pool = g_thread_pool_new (gst_field_analysis_job_func, filter,
+        n_threads - 1, TRUE, &err);
+    if (filter->pool == NULL) {
+      GST_WARNING_OBJECT (filter, "failed to create thread pool: %s",
+          err->message);
+      g_clear_error (&err);
+      n_threads = 1;
+    }
+  }
+
+  GST_DEBUG_OBJECT (filter, "analysing with %u threads", n_threads);
+}
+
+static void
+gst_field_analysis_stop_pool (GstFieldAnalysis * filter)
+{
+  if (filter->pool) {
+    g_thread_pool_free (filter->pool, FALSE, TRUE);
+    filter->pool = NULL;
+  }
+}
+
 static GstStateChangeReturn
 gst_field_analysis_change_state (GstElement * element,
     GstStateChange transition)
@@ -1800,6 +1818,7 @@ gst_field_analysis_change_state (GstElement * element,
     case GST_STATE_CHANGE_NULL_TO_READY:
       break;
     case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_field_analysis_start_pool (filter);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
       break;
@@ -1816,6 +1835,7 @@ gst_field_analysis_change_state (GstElement * element,
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_field_analysis_reset (filter);
+      gst_field_analysis_stop_pool (filter);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
     default:
@@ -1831,6 +1851,10 @@ gst_field_analysis_finalize (GObject * object)
   GstFieldAnalysis *filter = GST_FIELDANALYSIS (object);
 
   gst_field_analysis_reset (filter);
+  gst_field_analysis_stop_pool (filter);
+
+  g_mutex_clear (&filter->lock);
+  g_cond_clear (&filter->cond);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
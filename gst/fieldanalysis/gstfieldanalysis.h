@@ -119,12 +119,13 @@ struct _GstFieldAnalysis
   GstVideoInfo vinfo;
   gfloat (*same_field) (GstFieldAnalysis *, FieldAnalysisFields (*)[2]);
   gfloat (*same_frame) (GstFieldAnalysis *, FieldAnalysisFields (*)[2]);
-  guint64 (*block_score_for_row) (GstFieldAnalysis *, FieldAnalysisFields (*)[2], guint8 *, guint8 *);
+  FieldAnalysisCombMethod comb_method;
   gboolean is_telecine;
   gboolean first_buffer; /* indicates the first buffer for which a buffer will be output
                           * after a discont or flushing seek */
-  guint8 *comb_mask;
-  guint *block_scores;
+  /* per job comb masks and block counts of the windowed comb metric */
+  guint16 *comb_mask;
+  gsize comb_mask_size;
   gboolean flushing;     /* indicates whether we are flushing or not */
 
   /* properties */
@@ -135,6 +136,13 @@ struct _GstFieldAnalysis
   guint64 block_width, block_height; /* width/height of window used for comb clusted detection */
   guint64 block_thresh;
   guint64 ignored_lines;
+  guint n_threads;
+
+  /* worker pool, the metrics wait on cond until n_pending jobs are done */
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+  gint n_pending;
 };
 
 struct _GstFieldAnalysisClass
@@ -111,6 +111,21 @@ void fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (guint32 *
     const orc_uint8 * ORC_RESTRICT s2, const orc_uint8 * ORC_RESTRICT s3,
     const orc_uint8 * ORC_RESTRICT s4, const orc_uint8 * ORC_RESTRICT s5,
     int p1, int n);
+void fieldanalysis_orc_comb_mask_5_tap (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, int p1, int p2, int n);
+void fieldanalysis_orc_comb_mask_iscombed (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int p1, int n);
+void fieldanalysis_orc_comb_mask_32detect (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    int p1, int n);
+void fieldanalysis_orc_comb_count (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint16 * ORC_RESTRICT s1, const orc_uint16 * ORC_RESTRICT s2,
+    const orc_uint16 * ORC_RESTRICT s3, const orc_uint16 * ORC_RESTRICT s4,
+    int n);
 
 
 /* begin Orc C target preamble */
@@ -1181,3 +1196,1269 @@ fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (guint32 * ORC_RESTRICT a1,
   *a1 = orc_executor_get_accumulator (ex, ORC_VAR_A1);
 }
 #endif
+
+/* fieldanalysis_orc_comb_mask_5_tap */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_5_tap (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, int p1, int p2, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+  orc_int8 var43;
+  orc_int8 var44;
+  orc_union16 var45;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var46;
+#else
+  orc_union16 var46;
+#endif
+  orc_union16 var47;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var48;
+#else
+  orc_union16 var48;
+#endif
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+  orc_union16 var71;
+  orc_union16 var72;
+  orc_union16 var73;
+  orc_union16 var74;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+
+  /* 11: loadpw */
+  var45.i = p1;
+  /* 26: loadpw */
+  var46.i = 0x00000003;         /* 3 or 1.4822e-323f */
+  /* 30: loadpw */
+  var47.i = p2;
+  /* 33: loadpw */
+  var48.i = 0x00000001;         /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var40 = ptr4[i];
+    /* 1: convubw */
+    var50.i = (orc_uint8) var40;
+    /* 2: loadb */
+    var41 = ptr5[i];
+    /* 3: convubw */
+    var51.i = (orc_uint8) var41;
+    /* 4: loadb */
+    var42 = ptr6[i];
+    /* 5: convubw */
+    var52.i = (orc_uint8) var42;
+    /* 6: loadb */
+    var43 = ptr7[i];
+    /* 7: convubw */
+    var53.i = (orc_uint8) var43;
+    /* 8: loadb */
+    var44 = ptr8[i];
+    /* 9: convubw */
+    var54.i = (orc_uint8) var44;
+    /* 10: subw */
+    var55.i = var52.i - var51.i;
+    /* 12: cmpgtsw */
+    var56.i = (var55.i > var45.i) ? (~0) : 0;
+    /* 13: subw */
+    var57.i = var52.i - var53.i;
+    /* 14: cmpgtsw */
+    var58.i = (var57.i > var45.i) ? (~0) : 0;
+    /* 15: andw */
+    var59.i = var56.i & var58.i;
+    /* 16: subw */
+    var60.i = var51.i - var52.i;
+    /* 17: cmpgtsw */
+    var61.i = (var60.i > var45.i) ? (~0) : 0;
+    /* 18: subw */
+    var62.i = var53.i - var52.i;
+    /* 19: cmpgtsw */
+    var63.i = (var62.i > var45.i) ? (~0) : 0;
+    /* 20: andw */
+    var64.i = var61.i & var63.i;
+    /* 21: orw */
+    var65.i = var59.i | var64.i;
+    /* 22: addw */
+    var66.i = var50.i + var54.i;
+    /* 23: shlw */
+    var67.i = ((orc_uint16) var52.i) << 2;
+    /* 24: addw */
+    var68.i = var66.i + var67.i;
+    /* 25: addw */
+    var69.i = var51.i + var53.i;
+    /* 27: mullw */
+    var70.i = (var69.i * var46.i) & 0xffff;
+    /* 28: subw */
+    var71.i = var68.i - var70.i;
+    /* 29: absw */
+    var72.i = ORC_ABS (var71.i);
+    /* 31: cmpgtsw */
+    var73.i = (var72.i > var47.i) ? (~0) : 0;
+    /* 32: andw */
+    var74.i = var73.i & var65.i;
+    /* 34: andw */
+    var49.i = var74.i & var48.i;
+    /* 35: storew */
+    ptr0[i] = var49;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_5_tap (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+  orc_int8 var43;
+  orc_int8 var44;
+  orc_union16 var45;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var46;
+#else
+  orc_union16 var46;
+#endif
+  orc_union16 var47;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var48;
+#else
+  orc_union16 var48;
+#endif
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+  orc_union16 var71;
+  orc_union16 var72;
+  orc_union16 var73;
+  orc_union16 var74;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+
+  /* 11: loadpw */
+  var45.i = ex->params[24];
+  /* 26: loadpw */
+  var46.i = 0x00000003;         /* 3 or 1.4822e-323f */
+  /* 30: loadpw */
+  var47.i = ex->params[25];
+  /* 33: loadpw */
+  var48.i = 0x00000001;         /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var40 = ptr4[i];
+    /* 1: convubw */
+    var50.i = (orc_uint8) var40;
+    /* 2: loadb */
+    var41 = ptr5[i];
+    /* 3: convubw */
+    var51.i = (orc_uint8) var41;
+    /* 4: loadb */
+    var42 = ptr6[i];
+    /* 5: convubw */
+    var52.i = (orc_uint8) var42;
+    /* 6: loadb */
+    var43 = ptr7[i];
+    /* 7: convubw */
+    var53.i = (orc_uint8) var43;
+    /* 8: loadb */
+    var44 = ptr8[i];
+    /* 9: convubw */
+    var54.i = (orc_uint8) var44;
+    /* 10: subw */
+    var55.i = var52.i - var51.i;
+    /* 12: cmpgtsw */
+    var56.i = (var55.i > var45.i) ? (~0) : 0;
+    /* 13: subw */
+    var57.i = var52.i - var53.i;
+    /* 14: cmpgtsw */
+    var58.i = (var57.i > var45.i) ? (~0) : 0;
+    /* 15: andw */
+    var59.i = var56.i & var58.i;
+    /* 16: subw */
+    var60.i = var51.i - var52.i;
+    /* 17: cmpgtsw */
+    var61.i = (var60.i > var45.i) ? (~0) : 0;
+    /* 18: subw */
+    var62.i = var53.i - var52.i;
+    /* 19: cmpgtsw */
+    var63.i = (var62.i > var45.i) ? (~0) : 0;
+    /* 20: andw */
+    var64.i = var61.i & var63.i;
+    /* 21: orw */
+    var65.i = var59.i | var64.i;
+    /* 22: addw */
+    var66.i = var50.i + var54.i;
+    /* 23: shlw */
+    var67.i = ((orc_uint16) var52.i) << 2;
+    /* 24: addw */
+    var68.i = var66.i + var67.i;
+    /* 25: addw */
+    var69.i = var51.i + var53.i;
+    /* 27: mullw */
+    var70.i = (var69.i * var46.i) & 0xffff;
+    /* 28: subw */
+    var71.i = var68.i - var70.i;
+    /* 29: absw */
+    var72.i = ORC_ABS (var71.i);
+    /* 31: cmpgtsw */
+    var73.i = (var72.i > var47.i) ? (~0) : 0;
+    /* 32: andw */
+    var74.i = var73.i & var65.i;
+    /* 34: andw */
+    var49.i = var74.i & var48.i;
+    /* 35: storew */
+    ptr0[i] = var49;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_5_tap (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, int p1, int p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 33, 102, 105, 101, 108, 100, 97, 110, 97, 108, 121, 115, 105, 115,
+        95, 111, 114, 99, 95, 99, 111, 109, 98, 95, 109, 97, 115, 107, 95, 53,
+        95, 116, 97, 112, 11, 2, 2, 12, 1, 1, 12, 1, 1, 12, 1, 1,
+        12, 1, 1, 12, 1, 1, 14, 2, 2, 0, 0, 0, 14, 2, 3, 0,
+        0, 0, 14, 2, 1, 0, 0, 0, 16, 2, 16, 2, 20, 2, 20, 2,
+        20, 2, 20, 2, 20, 2, 20, 2, 20, 2, 20, 2, 150, 32, 4, 150,
+        33, 5, 150, 34, 6, 150, 35, 7, 150, 36, 8, 98, 37, 34, 33, 78,
+        37, 37, 24, 98, 38, 34, 35, 78, 38, 38, 24, 73, 37, 37, 38, 98,
+        38, 33, 34, 78, 38, 38, 24, 98, 39, 35, 34, 78, 39, 39, 24, 73,
+        38, 38, 39, 92, 37, 37, 38, 70, 32, 32, 36, 93, 34, 34, 16, 70,
+        32, 32, 34, 70, 33, 33, 35, 89, 33, 33, 17, 98, 32, 32, 33, 69,
+        32, 32, 78, 32, 32, 25, 73, 32, 32, 37, 73, 0, 32, 18, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_5_tap);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_5_tap");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_5_tap);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_constant (p, 2, 0x00000002, "c1");
+      orc_program_add_constant (p, 2, 0x00000003, "c2");
+      orc_program_add_constant (p, 2, 0x00000001, "c3");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+      orc_program_add_temporary (p, 2, "t7");
+      orc_program_add_temporary (p, 2, "t8");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T4, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T5, ORC_VAR_S5, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T6, ORC_VAR_T3, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T7, ORC_VAR_T3, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_T7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T7, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T8, ORC_VAR_T4, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_T7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_C3,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* fieldanalysis_orc_comb_mask_iscombed */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_iscombed (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int p1, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var42;
+#else
+  orc_union16 var42;
+#endif
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+
+  /* 7: loadpw */
+  var41.i = p1;
+  /* 18: loadpw */
+  var42.i = 0x00000001;         /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var38 = ptr4[i];
+    /* 1: convubw */
+    var44.i = (orc_uint8) var38;
+    /* 2: loadb */
+    var39 = ptr5[i];
+    /* 3: convubw */
+    var45.i = (orc_uint8) var39;
+    /* 4: loadb */
+    var40 = ptr6[i];
+    /* 5: convubw */
+    var46.i = (orc_uint8) var40;
+    /* 6: subw */
+    var47.i = var45.i - var44.i;
+    /* 8: cmpgtsw */
+    var48.i = (var47.i > var41.i) ? (~0) : 0;
+    /* 9: subw */
+    var49.i = var45.i - var46.i;
+    /* 10: cmpgtsw */
+    var50.i = (var49.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var51.i = var48.i & var50.i;
+    /* 12: subw */
+    var52.i = var44.i - var45.i;
+    /* 13: cmpgtsw */
+    var53.i = (var52.i > var41.i) ? (~0) : 0;
+    /* 14: subw */
+    var54.i = var46.i - var45.i;
+    /* 15: cmpgtsw */
+    var55.i = (var54.i > var41.i) ? (~0) : 0;
+    /* 16: andw */
+    var56.i = var53.i & var55.i;
+    /* 17: orw */
+    var57.i = var51.i | var56.i;
+    /* 19: andw */
+    var43.i = var57.i & var42.i;
+    /* 20: storew */
+    ptr0[i] = var43;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_iscombed (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var42;
+#else
+  orc_union16 var42;
+#endif
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+
+  /* 7: loadpw */
+  var41.i = ex->params[24];
+  /* 18: loadpw */
+  var42.i = 0x00000001;         /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var38 = ptr4[i];
+    /* 1: convubw */
+    var44.i = (orc_uint8) var38;
+    /* 2: loadb */
+    var39 = ptr5[i];
+    /* 3: convubw */
+    var45.i = (orc_uint8) var39;
+    /* 4: loadb */
+    var40 = ptr6[i];
+    /* 5: convubw */
+    var46.i = (orc_uint8) var40;
+    /* 6: subw */
+    var47.i = var45.i - var44.i;
+    /* 8: cmpgtsw */
+    var48.i = (var47.i > var41.i) ? (~0) : 0;
+    /* 9: subw */
+    var49.i = var45.i - var46.i;
+    /* 10: cmpgtsw */
+    var50.i = (var49.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var51.i = var48.i & var50.i;
+    /* 12: subw */
+    var52.i = var44.i - var45.i;
+    /* 13: cmpgtsw */
+    var53.i = (var52.i > var41.i) ? (~0) : 0;
+    /* 14: subw */
+    var54.i = var46.i - var45.i;
+    /* 15: cmpgtsw */
+    var55.i = (var54.i > var41.i) ? (~0) : 0;
+    /* 16: andw */
+    var56.i = var53.i & var55.i;
+    /* 17: orw */
+    var57.i = var51.i | var56.i;
+    /* 19: andw */
+    var43.i = var57.i & var42.i;
+    /* 20: storew */
+    ptr0[i] = var43;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_iscombed (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 36, 102, 105, 101, 108, 100, 97, 110, 97, 108, 121, 115, 105, 115,
+        95, 111, 114, 99, 95, 99, 111, 109, 98, 95, 109, 97, 115, 107, 95, 105,
+        115, 99, 111, 109, 98, 101, 100, 11, 2, 2, 12, 1, 1, 12, 1, 1,
+        12, 1, 1, 14, 2, 1, 0, 0, 0, 16, 2, 20, 2, 20, 2, 20,
+        2, 20, 2, 20, 2, 20, 2, 150, 32, 4, 150, 33, 5, 150, 34, 6,
+        98, 35, 33, 32, 78, 35, 35, 24, 98, 36, 33, 34, 78, 36, 36, 24,
+        73, 35, 35, 36, 98, 36, 32, 33, 78, 36, 36, 24, 98, 37, 34, 33,
+        78, 37, 37, 24, 73, 36, 36, 37, 92, 35, 35, 36, 73, 0, 35, 16,
+        2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_iscombed);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_iscombed");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_iscombed);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_constant (p, 2, 0x00000001, "c1");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T4, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T5, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T5, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T6, ORC_VAR_T3, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_D1, ORC_VAR_T4, ORC_VAR_C1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->params[ORC_VAR_P1] = p1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* fieldanalysis_orc_comb_mask_32detect */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_32detect (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    int p1, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+  orc_union16 var43;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var44;
+#else
+  orc_union16 var44;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var45;
+#else
+  orc_union16 var45;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var46;
+#else
+  orc_union16 var46;
+#endif
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+
+  /* 9: loadpw */
+  var43.i = p1;
+  /* 22: loadpw */
+  var44.i = 0x0000000f;         /* 15 or 7.41098e-323f */
+  /* 27: loadpw */
+  var45.i = 0x00000009;         /* 9 or 4.44659e-323f */
+  /* 30: loadpw */
+  var46.i = 0x00000001;         /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var39 = ptr4[i];
+    /* 1: convubw */
+    var48.i = (orc_uint8) var39;
+    /* 2: loadb */
+    var40 = ptr5[i];
+    /* 3: convubw */
+    var49.i = (orc_uint8) var40;
+    /* 4: loadb */
+    var41 = ptr6[i];
+    /* 5: convubw */
+    var50.i = (orc_uint8) var41;
+    /* 6: loadb */
+    var42 = ptr7[i];
+    /* 7: convubw */
+    var51.i = (orc_uint8) var42;
+    /* 8: subw */
+    var52.i = var50.i - var49.i;
+    /* 10: cmpgtsw */
+    var53.i = (var52.i > var43.i) ? (~0) : 0;
+    /* 11: subw */
+    var54.i = var50.i - var51.i;
+    /* 12: cmpgtsw */
+    var55.i = (var54.i > var43.i) ? (~0) : 0;
+    /* 13: andw */
+    var56.i = var53.i & var55.i;
+    /* 14: subw */
+    var57.i = var49.i - var50.i;
+    /* 15: cmpgtsw */
+    var58.i = (var57.i > var43.i) ? (~0) : 0;
+    /* 16: subw */
+    var59.i = var51.i - var50.i;
+    /* 17: cmpgtsw */
+    var60.i = (var59.i > var43.i) ? (~0) : 0;
+    /* 18: andw */
+    var61.i = var58.i & var60.i;
+    /* 19: orw */
+    var62.i = var56.i | var61.i;
+    /* 20: subw */
+    var63.i = var50.i - var49.i;
+    /* 21: absw */
+    var64.i = ORC_ABS (var63.i);
+    /* 23: cmpgtsw */
+    var65.i = (var64.i > var44.i) ? (~0) : 0;
+    /* 24: andw */
+    var66.i = var62.i & var65.i;
+    /* 25: subw */
+    var67.i = var50.i - var48.i;
+    /* 26: absw */
+    var68.i = ORC_ABS (var67.i);
+    /* 28: cmpgtsw */
+    var69.i = (var68.i > var45.i) ? (~0) : 0;
+    /* 29: andnw */
+    var70.i = (~var69.i) & var66.i;
+    /* 31: andw */
+    var47.i = var70.i & var46.i;
+    /* 32: storew */
+    ptr0[i] = var47;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_32detect (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+  orc_union16 var43;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var44;
+#else
+  orc_union16 var44;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var45;
+#else
+  orc_union16 var45;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var46;
+#else
+  orc_union16 var46;
+#endif
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+
+  /* 9: loadpw */
+  var43.i = ex->params[24];
+  /* 22: loadpw */
+  var44.i = 0x0000000f;         /* 15 or 7.41098e-323f */
+  /* 27: loadpw */
+  var45.i = 0x00000009;         /* 9 or 4.44659e-323f */
+  /* 30: loadpw */
+  var46.i = 0x00000001;         /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var39 = ptr4[i];
+    /* 1: convubw */
+    var48.i = (orc_uint8) var39;
+    /* 2: loadb */
+    var40 = ptr5[i];
+    /* 3: convubw */
+    var49.i = (orc_uint8) var40;
+    /* 4: loadb */
+    var41 = ptr6[i];
+    /* 5: convubw */
+    var50.i = (orc_uint8) var41;
+    /* 6: loadb */
+    var42 = ptr7[i];
+    /* 7: convubw */
+    var51.i = (orc_uint8) var42;
+    /* 8: subw */
+    var52.i = var50.i - var49.i;
+    /* 10: cmpgtsw */
+    var53.i = (var52.i > var43.i) ? (~0) : 0;
+    /* 11: subw */
+    var54.i = var50.i - var51.i;
+    /* 12: cmpgtsw */
+    var55.i = (var54.i > var43.i) ? (~0) : 0;
+    /* 13: andw */
+    var56.i = var53.i & var55.i;
+    /* 14: subw */
+    var57.i = var49.i - var50.i;
+    /* 15: cmpgtsw */
+    var58.i = (var57.i > var43.i) ? (~0) : 0;
+    /* 16: subw */
+    var59.i = var51.i - var50.i;
+    /* 17: cmpgtsw */
+    var60.i = (var59.i > var43.i) ? (~0) : 0;
+    /* 18: andw */
+    var61.i = var58.i & var60.i;
+    /* 19: orw */
+    var62.i = var56.i | var61.i;
+    /* 20: subw */
+    var63.i = var50.i - var49.i;
+    /* 21: absw */
+    var64.i = ORC_ABS (var63.i);
+    /* 23: cmpgtsw */
+    var65.i = (var64.i > var44.i) ? (~0) : 0;
+    /* 24: andw */
+    var66.i = var62.i & var65.i;
+    /* 25: subw */
+    var67.i = var50.i - var48.i;
+    /* 26: absw */
+    var68.i = ORC_ABS (var67.i);
+    /* 28: cmpgtsw */
+    var69.i = (var68.i > var45.i) ? (~0) : 0;
+    /* 29: andnw */
+    var70.i = (~var69.i) & var66.i;
+    /* 31: andw */
+    var47.i = var70.i & var46.i;
+    /* 32: storew */
+    ptr0[i] = var47;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_32detect (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    int p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 36, 102, 105, 101, 108, 100, 97, 110, 97, 108, 121, 115, 105, 115,
+        95, 111, 114, 99, 95, 99, 111, 109, 98, 95, 109, 97, 115, 107, 95, 51,
+        50, 100, 101, 116, 101, 99, 116, 11, 2, 2, 12, 1, 1, 12, 1, 1,
+        12, 1, 1, 12, 1, 1, 14, 2, 15, 0, 0, 0, 14, 2, 9, 0,
+        0, 0, 14, 2, 1, 0, 0, 0, 16, 2, 20, 2, 20, 2, 20, 2,
+        20, 2, 20, 2, 20, 2, 20, 2, 150, 32, 4, 150, 33, 5, 150, 34,
+        6, 150, 35, 7, 98, 36, 34, 33, 78, 36, 36, 24, 98, 37, 34, 35,
+        78, 37, 37, 24, 73, 36, 36, 37, 98, 37, 33, 34, 78, 37, 37, 24,
+        98, 38, 35, 34, 78, 38, 38, 24, 73, 37, 37, 38, 92, 36, 36, 37,
+        98, 37, 34, 33, 69, 37, 37, 78, 37, 37, 16, 73, 36, 36, 37, 98,
+        38, 34, 32, 69, 38, 38, 78, 38, 38, 17, 74, 36, 38, 36, 73, 0,
+        36, 18, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_32detect);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_32detect");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_32detect);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_constant (p, 2, 0x0000000f, "c1");
+      orc_program_add_constant (p, 2, 0x00000009, "c2");
+      orc_program_add_constant (p, 2, 0x00000001, "c3");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+      orc_program_add_temporary (p, 2, "t7");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T4, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T5, ORC_VAR_T3, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T6, ORC_VAR_T3, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T6, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T7, ORC_VAR_T4, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_T7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T6, ORC_VAR_T3, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T7, ORC_VAR_T3, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andnw", 0, ORC_VAR_T5, ORC_VAR_T7, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_D1, ORC_VAR_T5, ORC_VAR_C3,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->params[ORC_VAR_P1] = p1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* fieldanalysis_orc_comb_count */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_count (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint16 * ORC_RESTRICT s1, const orc_uint16 * ORC_RESTRICT s2,
+    const orc_uint16 * ORC_RESTRICT s3, const orc_uint16 * ORC_RESTRICT s4,
+    int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+  ptr6 = (orc_union16 *) s3;
+  ptr7 = (orc_union16 *) s4;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr5[i];
+    /* 1: loadw */
+    var34 = ptr6[i];
+    /* 2: andw */
+    var38.i = var33.i & var34.i;
+    /* 3: loadw */
+    var35 = ptr7[i];
+    /* 4: andw */
+    var39.i = var38.i & var35.i;
+    /* 5: loadw */
+    var36 = ptr4[i];
+    /* 6: addw */
+    var37.i = var36.i + var39.i;
+    /* 7: storew */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_count (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+  ptr6 = (orc_union16 *) ex->arrays[6];
+  ptr7 = (orc_union16 *) ex->arrays[7];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr5[i];
+    /* 1: loadw */
+    var34 = ptr6[i];
+    /* 2: andw */
+    var38.i = var33.i & var34.i;
+    /* 3: loadw */
+    var35 = ptr7[i];
+    /* 4: andw */
+    var39.i = var38.i & var35.i;
+    /* 5: loadw */
+    var36 = ptr4[i];
+    /* 6: addw */
+    var37.i = var36.i + var39.i;
+    /* 7: storew */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_count (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint16 * ORC_RESTRICT s1, const orc_uint16 * ORC_RESTRICT s2,
+    const orc_uint16 * ORC_RESTRICT s3, const orc_uint16 * ORC_RESTRICT s4,
+    int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 28, 102, 105, 101, 108, 100, 97, 110, 97, 108, 121, 115, 105, 115,
+        95, 111, 114, 99, 95, 99, 111, 109, 98, 95, 99, 111, 117, 110, 116, 11,
+        2, 2, 12, 2, 2, 12, 2, 2, 12, 2, 2, 12, 2, 2, 20, 2,
+        73, 32, 5, 6, 73, 32, 32, 7, 70, 0, 4, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_fieldanalysis_orc_comb_count);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_count");
+      orc_program_set_backup_function (p, _backup_fieldanalysis_orc_comb_count);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_source (p, 2, "s3");
+      orc_program_add_source (p, 2, "s4");
+      orc_program_add_temporary (p, 2, "t1");
+
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T1, ORC_VAR_S2, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_S4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_D1, ORC_VAR_S1, ORC_VAR_T1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
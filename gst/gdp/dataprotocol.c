@@ -58,6 +58,14 @@
  * the event as the payload.  In addition, GDP streams can now start with
  * events as well, as required by the new data stream model in GStreamer 0.10.
  *
+ * Version 2.0 serializes caps and event structures in a binary encoding that
+ * can be read back without parsing strings.  A caps packet can also define
+ * an entry in a small per-connection #GstDPDictionary, or refer to an entry
+ * defined earlier on the same connection instead of repeating the caps.
+ * Buffer packets are unchanged from version 1.0.  Version 1.0 receivers
+ * can't read 2.0 caps and event packets, so senders only use 2.0 when asked
+ * to.
+ *
  * Converting buffers, caps and events to GDP buffers is done using the
  * appropriate functions.
  *
@@ -71,6 +79,8 @@
 #endif
 
 #include <gst/gst.h>
+#include <gst/base/gstbytereader.h>
+#include <gst/base/gstbytewriter.h>
 #include "dataprotocol.h"
 #include <glib/gprintf.h>       /* g_sprintf */
 #include <string.h>             /* strlen */
@@ -82,13 +92,6 @@ GST_DEBUG_CATEGORY_STATIC (data_protocol_debug);
 #define GST_CAT_DEFAULT data_protocol_debug
 #endif
 
-/* The version of the GDP protocol being used */
-typedef enum
-{
-  GST_DP_VERSION_0_2 = 1,
-  GST_DP_VERSION_1_0,
-} GstDPVersion;
-
 /* helper macros */
 
 /* write first 6 bytes of header */
@@ -98,6 +101,7 @@ G_STMT_START {							\
   switch (version) {						\
     case GST_DP_VERSION_0_2: maj = 0; min = 2; break;		\
     case GST_DP_VERSION_1_0: maj = 1; min = 0; break;		\
+    case GST_DP_VERSION_2_0: maj = 2; min = 0; break;		\
   }								\
   h[0] = (guint8) maj;						\
   h[1] = (guint8) min;						\
@@ -136,6 +140,685 @@ static guint16 gst_dp_crc (const guint8 * buffer, guint length);
 static guint16 gst_dp_crc_from_memory_maps (const GstMapInfo * maps,
     guint n_maps);
 
+/* GDP 2.0 binary encoding
+ *
+ * Strings are written as a 32 bit length followed by the string bytes
+ * without terminator, all integers are big-endian.  A structure is its name,
+ * the number of fields and then the name and value of each field.  A value
+ * starts with a one byte tag for its type; fundamental and core GStreamer
+ * types are written in binary, other types as their type name and the
+ * gst_value_serialize() string. */
+
+typedef enum
+{
+  GST_DP_VALUE_INT = 'i',
+  GST_DP_VALUE_UINT = 'u',
+  GST_DP_VALUE_INT64 = 'l',
+  GST_DP_VALUE_UINT64 = 'L',
+  GST_DP_VALUE_FLOAT = 'f',
+  GST_DP_VALUE_DOUBLE = 'd',
+  GST_DP_VALUE_BOOLEAN = 'b',
+  GST_DP_VALUE_STRING = 's',
+  GST_DP_VALUE_NULL_STRING = 'n',
+  GST_DP_VALUE_ENUM = 'e',
+  GST_DP_VALUE_FLAGS = 'm',
+  GST_DP_VALUE_FRACTION = 'F',
+  GST_DP_VALUE_INT_RANGE = 'r',
+  GST_DP_VALUE_INT64_RANGE = 'R',
+  GST_DP_VALUE_DOUBLE_RANGE = 'D',
+  GST_DP_VALUE_FRACTION_RANGE = 'G',
+  GST_DP_VALUE_LIST = 'v',
+  GST_DP_VALUE_ARRAY = 'a',
+  GST_DP_VALUE_STRUCTURE = 'S',
+  GST_DP_VALUE_CAPS = 'C',
+  GST_DP_VALUE_BUFFER = 'B',
+  GST_DP_VALUE_SERIALIZED = 'g',
+} GstDPValueTag;
+
+/* first byte of a 2.0 caps payload; DEFINE and REFERENCE are followed by a
+ * 16 bit dictionary index, INLINE and DEFINE by the caps */
+typedef enum
+{
+  GST_DP_CAPS_INLINE = 0,
+  GST_DP_CAPS_DEFINE,
+  GST_DP_CAPS_REFERENCE,
+} GstDPCapsOp;
+
+#define GST_DP_CAPS_FLAG_ANY    (1 << 0)
+
+/* both ends of a connection must agree on this */
+#define GST_DP_DICTIONARY_SIZE  16
+
+/* nesting limit when reading lists, structures and caps in values */
+#define GST_DP_MAX_DEPTH        16
+
+struct _GstDPDictionary
+{
+  GstCaps *caps[GST_DP_DICTIONARY_SIZE];
+  /* slot the next definition goes to, the oldest entry is replaced */
+  guint next;
+};
+
+static gboolean gst_dp_write_structure (GstByteWriter * bw,
+    const GstStructure * structure);
+static gboolean gst_dp_write_caps (GstByteWriter * bw, const GstCaps * caps);
+static GstStructure *gst_dp_read_structure (GstByteReader * br, guint depth);
+static GstCaps *gst_dp_read_caps (GstByteReader * br, guint depth);
+
+static gboolean
+gst_dp_write_string (GstByteWriter * bw, const gchar * str)
+{
+  guint32 len = strlen (str);
+
+  return gst_byte_writer_put_uint32_be (bw, len) &&
+      gst_byte_writer_put_data (bw, (const guint8 *) str, len);
+}
+
+static gboolean
+gst_dp_write_fraction (GstByteWriter * bw, const GValue * value)
+{
+  return gst_byte_writer_put_int32_be (bw,
+      gst_value_get_fraction_numerator (value)) &&
+      gst_byte_writer_put_int32_be (bw,
+      gst_value_get_fraction_denominator (value));
+}
+
+static gboolean
+gst_dp_write_value (GstByteWriter * bw, const GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+  gboolean ok = TRUE;
+
+  if (type == G_TYPE_INT) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_INT);
+    ok &= gst_byte_writer_put_int32_be (bw, g_value_get_int (value));
+  } else if (type == G_TYPE_UINT) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_UINT);
+    ok &= gst_byte_writer_put_uint32_be (bw, g_value_get_uint (value));
+  } else if (type == G_TYPE_INT64) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_INT64);
+    ok &= gst_byte_writer_put_int64_be (bw, g_value_get_int64 (value));
+  } else if (type == G_TYPE_UINT64) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_UINT64);
+    ok &= gst_byte_writer_put_uint64_be (bw, g_value_get_uint64 (value));
+  } else if (type == G_TYPE_FLOAT) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_FLOAT);
+    ok &= gst_byte_writer_put_float32_be (bw, g_value_get_float (value));
+  } else if (type == G_TYPE_DOUBLE) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_DOUBLE);
+    ok &= gst_byte_writer_put_float64_be (bw, g_value_get_double (value));
+  } else if (type == G_TYPE_BOOLEAN) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_BOOLEAN);
+    ok &= gst_byte_writer_put_uint8 (bw, g_value_get_boolean (value) ? 1 : 0);
+  } else if (type == G_TYPE_STRING) {
+    const gchar *str = g_value_get_string (value);
+
+    if (str) {
+      ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_STRING);
+      ok &= gst_dp_write_string (bw, str);
+    } else {
+      ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_NULL_STRING);
+    }
+  } else if (G_TYPE_IS_ENUM (type)) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_ENUM);
+    ok &= gst_dp_write_string (bw, g_type_name (type));
+    ok &= gst_byte_writer_put_int32_be (bw, g_value_get_enum (value));
+  } else if (G_TYPE_IS_FLAGS (type)) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_FLAGS);
+    ok &= gst_dp_write_string (bw, g_type_name (type));
+    ok &= gst_byte_writer_put_uint32_be (bw, g_value_get_flags (value));
+  } else if (type == GST_TYPE_FRACTION) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_FRACTION);
+    ok &= gst_dp_write_fraction (bw, value);
+  } else if (type == GST_TYPE_INT_RANGE) {
+    gint min, max, step;
+
+    min = gst_value_get_int_range_min (value);
+    max = gst_value_get_int_range_max (value);
+    step = gst_value_get_int_range_step (value);
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_INT_RANGE);
+    ok &= gst_byte_writer_put_int32_be (bw, min);
+    ok &= gst_byte_writer_put_int32_be (bw, max);
+    ok &= gst_byte_writer_put_int32_be (bw, step);
+  } else if (type == GST_TYPE_INT64_RANGE) {
+    gint64 min, max, step;
+
+    min = gst_value_get_int64_range_min (value);
+    max = gst_value_get_int64_range_max (value);
+    step = gst_value_get_int64_range_step (value);
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_INT64_RANGE);
+    ok &= gst_byte_writer_put_int64_be (bw, min);
+    ok &= gst_byte_writer_put_int64_be (bw, max);
+    ok &= gst_byte_writer_put_int64_be (bw, step);
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    gdouble min, max;
+
+    min = gst_value_get_double_range_min (value);
+    max = gst_value_get_double_range_max (value);
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_DOUBLE_RANGE);
+    ok &= gst_byte_writer_put_float64_be (bw, min);
+    ok &= gst_byte_writer_put_float64_be (bw, max);
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_FRACTION_RANGE);
+    ok &= gst_dp_write_fraction (bw, gst_value_get_fraction_range_min (value));
+    ok &= gst_dp_write_fraction (bw, gst_value_get_fraction_range_max (value));
+  } else if (type == GST_TYPE_LIST) {
+    guint i, n = gst_value_list_get_size (value);
+
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_LIST);
+    ok &= gst_byte_writer_put_uint32_be (bw, n);
+    for (i = 0; ok && i < n; i++)
+      ok &= gst_dp_write_value (bw, gst_value_list_get_value (value, i));
+  } else if (type == GST_TYPE_ARRAY) {
+    guint i, n = gst_value_array_get_size (value);
+
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_ARRAY);
+    ok &= gst_byte_writer_put_uint32_be (bw, n);
+    for (i = 0; ok && i < n; i++)
+      ok &= gst_dp_write_value (bw, gst_value_array_get_value (value, i));
+  } else if (type == GST_TYPE_STRUCTURE && gst_value_get_structure (value)) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_STRUCTURE);
+    ok &= gst_dp_write_structure (bw, gst_value_get_structure (value));
+  } else if (type == GST_TYPE_CAPS && gst_value_get_caps (value)) {
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_CAPS);
+    ok &= gst_dp_write_caps (bw, gst_value_get_caps (value));
+  } else if (type == GST_TYPE_BUFFER && gst_value_get_buffer (value)) {
+    GstBuffer *buffer = gst_value_get_buffer (value);
+    GstMapInfo map;
+
+    if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+      return FALSE;
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_BUFFER);
+    ok &= gst_byte_writer_put_uint32_be (bw, map.size);
+    ok &= gst_byte_writer_put_data (bw, map.data, map.size);
+    gst_buffer_unmap (buffer, &map);
+  } else {
+    gchar *str;
+
+    str = gst_value_serialize (value);
+    if (str == NULL) {
+      GST_WARNING ("Can't serialize value of type %s", g_type_name (type));
+      return FALSE;
+    }
+    ok &= gst_byte_writer_put_uint8 (bw, GST_DP_VALUE_SERIALIZED);
+    ok &= gst_dp_write_string (bw, g_type_name (type));
+    ok &= gst_dp_write_string (bw, str);
+    g_free (str);
+  }
+
+  return ok;
+}
+
+static gboolean
+gst_dp_write_field (GQuark field_id, const GValue * value, gpointer user_data)
+{
+  GstByteWriter *bw = user_data;
+
+  return gst_dp_write_string (bw, g_quark_to_string (field_id)) &&
+      gst_dp_write_value (bw, value);
+}
+
+static gboolean
+gst_dp_write_structure (GstByteWriter * bw, const GstStructure * structure)
+{
+  guint n_fields = gst_structure_n_fields (structure);
+
+  return gst_dp_write_string (bw, gst_structure_get_name (structure)) &&
+      gst_byte_writer_put_uint32_be (bw, n_fields) &&
+      gst_structure_foreach (structure, gst_dp_write_field, bw);
+}
+
+static gboolean
+gst_dp_write_caps (GstByteWriter * bw, const GstCaps * caps)
+{
+  gboolean ok = TRUE;
+  guint i, n;
+
+  if (gst_caps_is_any (caps))
+    return gst_byte_writer_put_uint8 (bw, GST_DP_CAPS_FLAG_ANY);
+
+  n = gst_caps_get_size (caps);
+  ok &= gst_byte_writer_put_uint8 (bw, 0);
+  ok &= gst_byte_writer_put_uint32_be (bw, n);
+
+  for (i = 0; ok && i < n; i++) {
+    GstCapsFeatures *features;
+
+    ok &= gst_dp_write_structure (bw, gst_caps_get_structure (caps, i));
+
+    /* system memory is implied when no features are written */
+    features = gst_caps_get_features (caps, i);
+    if (features && !gst_caps_features_is_equal (features,
+            GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY)) {
+      gchar *str = gst_caps_features_to_string (features);
+
+      ok &= gst_byte_writer_put_uint8 (bw, 1);
+      ok &= gst_dp_write_string (bw, str);
+      g_free (str);
+    } else {
+      ok &= gst_byte_writer_put_uint8 (bw, 0);
+    }
+  }
+
+  return ok;
+}
+
+static gchar *
+gst_dp_read_string (GstByteReader * br)
+{
+  const guint8 *data;
+  guint32 len;
+
+  if (!gst_byte_reader_get_uint32_be (br, &len) ||
+      !gst_byte_reader_get_data (br, len, &data))
+    return NULL;
+
+  return g_strndup ((const gchar *) data, len);
+}
+
+static GType
+gst_dp_read_type (GstByteReader * br)
+{
+  gchar *name;
+  GType type;
+
+  name = gst_dp_read_string (br);
+  if (name == NULL)
+    return G_TYPE_INVALID;
+
+  type = g_type_from_name (name);
+  if (type == G_TYPE_INVALID)
+    GST_WARNING ("Unknown type %s", name);
+  g_free (name);
+
+  return type;
+}
+
+/* the same rules gst_structure_new_empty() checks names against */
+static gboolean
+gst_dp_structure_name_is_valid (const gchar * name)
+{
+  const gchar *p;
+
+  if (!g_ascii_isalpha (*name))
+    return FALSE;
+
+  for (p = name + 1; *p; p++) {
+    if (!g_ascii_isalnum (*p) && strchr ("/-_.:+", *p) == NULL)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* reads a value into an unset @value, checking everything the GValue
+ * setters would otherwise complain about */
+static gboolean
+gst_dp_read_value (GstByteReader * br, GValue * value, guint depth)
+{
+  guint8 tag;
+
+  if (depth > GST_DP_MAX_DEPTH || !gst_byte_reader_get_uint8 (br, &tag))
+    return FALSE;
+
+  switch (tag) {
+    case GST_DP_VALUE_INT:{
+      gint32 v;
+
+      if (!gst_byte_reader_get_int32_be (br, &v))
+        return FALSE;
+      g_value_init (value, G_TYPE_INT);
+      g_value_set_int (value, v);
+      break;
+    }
+    case GST_DP_VALUE_UINT:{
+      guint32 v;
+
+      if (!gst_byte_reader_get_uint32_be (br, &v))
+        return FALSE;
+      g_value_init (value, G_TYPE_UINT);
+      g_value_set_uint (value, v);
+      break;
+    }
+    case GST_DP_VALUE_INT64:{
+      gint64 v;
+
+      if (!gst_byte_reader_get_int64_be (br, &v))
+        return FALSE;
+      g_value_init (value, G_TYPE_INT64);
+      g_value_set_int64 (value, v);
+      break;
+    }
+    case GST_DP_VALUE_UINT64:{
+      guint64 v;
+
+      if (!gst_byte_reader_get_uint64_be (br, &v))
+        return FALSE;
+      g_value_init (value, G_TYPE_UINT64);
+      g_value_set_uint64 (value, v);
+      break;
+    }
+    case GST_DP_VALUE_FLOAT:{
+      gfloat v;
+
+      if (!gst_byte_reader_get_float32_be (br, &v))
+        return FALSE;
+      g_value_init (value, G_TYPE_FLOAT);
+      g_value_set_float (value, v);
+      break;
+    }
+    case GST_DP_VALUE_DOUBLE:{
+      gdouble v;
+
+      if (!gst_byte_reader_get_float64_be (br, &v))
+        return FALSE;
+      g_value_init (value, G_TYPE_DOUBLE);
+      g_value_set_double (value, v);
+      break;
+    }
+    case GST_DP_VALUE_BOOLEAN:{
+      guint8 v;
+
+      if (!gst_byte_reader_get_uint8 (br, &v))
+        return FALSE;
+      g_value_init (value, G_TYPE_BOOLEAN);
+      g_value_set_boolean (value, v != 0);
+      break;
+    }
+    case GST_DP_VALUE_STRING:{
+      gchar *str;
+
+      str = gst_dp_read_string (br);
+      if (str == NULL || !g_utf8_validate (str, -1, NULL)) {
+        g_free (str);
+        return FALSE;
+      }
+      g_value_init (value, G_TYPE_STRING);
+      g_value_take_string (value, str);
+      break;
+    }
+    case GST_DP_VALUE_NULL_STRING:
+      g_value_init (value, G_TYPE_STRING);
+      break;
+    case GST_DP_VALUE_ENUM:
+    case GST_DP_VALUE_FLAGS:{
+      GType type;
+      guint32 v;
+
+      type = gst_dp_read_type (br);
+      if (!gst_byte_reader_get_uint32_be (br, &v))
+        return FALSE;
+
+      if (tag == GST_DP_VALUE_ENUM && G_TYPE_IS_ENUM (type)) {
+        g_value_init (value, type);
+        g_value_set_enum (value, (gint) v);
+      } else if (tag == GST_DP_VALUE_FLAGS && G_TYPE_IS_FLAGS (type)) {
+        g_value_init (value, type);
+        g_value_set_flags (value, v);
+      } else {
+        return FALSE;
+      }
+      break;
+    }
+    case GST_DP_VALUE_FRACTION:{
+      gint32 num, den;
+
+      if (!gst_byte_reader_get_int32_be (br, &num) ||
+          !gst_byte_reader_get_int32_be (br, &den) || den == 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION);
+      gst_value_set_fraction (value, num, den);
+      break;
+    }
+    case GST_DP_VALUE_INT_RANGE:{
+      gint32 min, max, step;
+
+      if (!gst_byte_reader_get_int32_be (br, &min) ||
+          !gst_byte_reader_get_int32_be (br, &max) ||
+          !gst_byte_reader_get_int32_be (br, &step))
+        return FALSE;
+      if (step <= 0 || min >= max || min % step != 0 || max % step != 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_INT_RANGE);
+      gst_value_set_int_range_step (value, min, max, step);
+      break;
+    }
+    case GST_DP_VALUE_INT64_RANGE:{
+      gint64 min, max, step;
+
+      if (!gst_byte_reader_get_int64_be (br, &min) ||
+          !gst_byte_reader_get_int64_be (br, &max) ||
+          !gst_byte_reader_get_int64_be (br, &step))
+        return FALSE;
+      if (step <= 0 || min >= max || min % step != 0 || max % step != 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_INT64_RANGE);
+      gst_value_set_int64_range_step (value, min, max, step);
+      break;
+    }
+    case GST_DP_VALUE_DOUBLE_RANGE:{
+      gdouble min, max;
+
+      if (!gst_byte_reader_get_float64_be (br, &min) ||
+          !gst_byte_reader_get_float64_be (br, &max) || !(min < max))
+        return FALSE;
+      g_value_init (value, GST_TYPE_DOUBLE_RANGE);
+      gst_value_set_double_range (value, min, max);
+      break;
+    }
+    case GST_DP_VALUE_FRACTION_RANGE:{
+      gint32 n1, d1, n2, d2;
+
+      if (!gst_byte_reader_get_int32_be (br, &n1) ||
+          !gst_byte_reader_get_int32_be (br, &d1) ||
+          !gst_byte_reader_get_int32_be (br, &n2) ||
+          !gst_byte_reader_get_int32_be (br, &d2))
+        return FALSE;
+      if (d1 == 0 || d2 == 0 || gst_util_fraction_compare (n1, d1, n2, d2) >= 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION_RANGE);
+      gst_value_set_fraction_range_full (value, n1, d1, n2, d2);
+      break;
+    }
+    case GST_DP_VALUE_LIST:
+    case GST_DP_VALUE_ARRAY:{
+      guint32 i, n;
+
+      if (!gst_byte_reader_get_uint32_be (br, &n))
+        return FALSE;
+
+      g_value_init (value,
+          tag == GST_DP_VALUE_LIST ? GST_TYPE_LIST : GST_TYPE_ARRAY);
+      for (i = 0; i < n; i++) {
+        GValue item = G_VALUE_INIT;
+
+        if (!gst_dp_read_value (br, &item, depth + 1)) {
+          g_value_unset (value);
+          return FALSE;
+        }
+        if (tag == GST_DP_VALUE_LIST)
+          gst_value_list_append_and_take_value (value, &item);
+        else
+          gst_value_array_append_and_take_value (value, &item);
+      }
+      break;
+    }
+    case GST_DP_VALUE_STRUCTURE:{
+      GstStructure *structure;
+
+      structure = gst_dp_read_structure (br, depth + 1);
+      if (structure == NULL)
+        return FALSE;
+      g_value_init (value, GST_TYPE_STRUCTURE);
+      g_value_take_boxed (value, structure);
+      break;
+    }
+    case GST_DP_VALUE_CAPS:{
+      GstCaps *caps;
+
+      caps = gst_dp_read_caps (br, depth + 1);
+      if (caps == NULL)
+        return FALSE;
+      g_value_init (value, GST_TYPE_CAPS);
+      g_value_take_boxed (value, caps);
+      break;
+    }
+    case GST_DP_VALUE_BUFFER:{
+      GstBuffer *buffer;
+      const guint8 *data;
+      guint32 size;
+
+      if (!gst_byte_reader_get_uint32_be (br, &size) ||
+          !gst_byte_reader_get_data (br, size, &data))
+        return FALSE;
+      buffer = gst_buffer_new_allocate (NULL, size, NULL);
+      gst_buffer_fill (buffer, 0, data, size);
+      g_value_init (value, GST_TYPE_BUFFER);
+      gst_value_take_buffer (value, buffer);
+      break;
+    }
+    case GST_DP_VALUE_SERIALIZED:{
+      GType type;
+      gchar *str;
+
+      type = gst_dp_read_type (br);
+      str = gst_dp_read_string (br);
+      if (type == G_TYPE_INVALID || str == NULL) {
+        g_free (str);
+        return FALSE;
+      }
+      /* the type comes from the stream, only instantiable value types can
+       * be initialized */
+      if (!G_TYPE_IS_VALUE_TYPE (type) || G_TYPE_IS_ABSTRACT (type)) {
+        GST_WARNING ("Can't deserialize a value of type %s",
+            g_type_name (type));
+        g_free (str);
+        return FALSE;
+      }
+      g_value_init (value, type);
+      if (!gst_value_deserialize (value, str)) {
+        GST_WARNING ("Could not deserialize %s from '%s'",
+            g_type_name (type), str);
+        g_value_unset (value);
+        g_free (str);
+        return FALSE;
+      }
+      g_free (str);
+      break;
+    }
+    default:
+      GST_WARNING ("Unknown value tag 0x%02x", tag);
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static GstStructure *
+gst_dp_read_structure (GstByteReader * br, guint depth)
+{
+  GstStructure *structure;
+  guint32 i, n_fields;
+  gchar *name;
+
+  name = gst_dp_read_string (br);
+  if (name == NULL || !gst_dp_structure_name_is_valid (name) ||
+      !gst_byte_reader_get_uint32_be (br, &n_fields)) {
+    g_free (name);
+    return NULL;
+  }
+
+  structure = gst_structure_new_empty (name);
+  g_free (name);
+
+  for (i = 0; i < n_fields; i++) {
+    GValue value = G_VALUE_INIT;
+
+    name = gst_dp_read_string (br);
+    if (name == NULL || *name == '\0' ||
+        !gst_dp_read_value (br, &value, depth + 1)) {
+      g_free (name);
+      gst_structure_free (structure);
+      return NULL;
+    }
+    gst_structure_take_value (structure, name, &value);
+    g_free (name);
+  }
+
+  return structure;
+}
+
+static GstCaps *
+gst_dp_read_caps (GstByteReader * br, guint depth)
+{
+  GstCaps *caps;
+  guint32 i, n;
+  guint8 flags;
+
+  if (depth > GST_DP_MAX_DEPTH || !gst_byte_reader_get_uint8 (br, &flags))
+    return NULL;
+
+  if (flags & GST_DP_CAPS_FLAG_ANY)
+    return gst_caps_new_any ();
+
+  if (!gst_byte_reader_get_uint32_be (br, &n))
+    return NULL;
+
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < n; i++) {
+    GstCapsFeatures *features = NULL;
+    GstStructure *structure;
+    guint8 has_features;
+
+    structure = gst_dp_read_structure (br, depth + 1);
+    if (structure == NULL)
+      goto error;
+
+    if (!gst_byte_reader_get_uint8 (br, &has_features)) {
+      gst_structure_free (structure);
+      goto error;
+    }
+
+    if (has_features) {
+      gchar *str;
+
+      str = gst_dp_read_string (br);
+      if (str != NULL)
+        features = gst_caps_features_from_string (str);
+      g_free (str);
+
+      if (features == NULL) {
+        gst_structure_free (structure);
+        goto error;
+      }
+    }
+
+    gst_caps_append_structure_full (caps, structure, features);
+  }
+
+  return caps;
+
+error:
+  gst_caps_unref (caps);
+  return NULL;
+}
+
+static gint
+gst_dp_dictionary_lookup (GstDPDictionary * dict, const GstCaps * caps)
+{
+  guint i;
+
+  for (i = 0; i < GST_DP_DICTIONARY_SIZE; i++) {
+    if (dict->caps[i] == NULL)
+      continue;
+    if (dict->caps[i] == caps || gst_caps_is_strictly_equal (dict->caps[i],
+            caps))
+      return i;
+  }
+
+  return -1;
+}
+
 /* payloading functions */
 
 GstBuffer *
@@ -220,12 +903,41 @@ gst_dp_payload_buffer (GstBuffer * buffer, GstDPHeaderFlag flags)
   /* header */
   gst_buffer_append_memory (ret_buf, mem);
 
-  /* buffer data */
-  return gst_buffer_append (ret_buf, gst_buffer_ref (buffer));
+  /* buffer data; this only adds references to the memory of @buffer, unlike
+   * gst_buffer_append() which needs a writable copy of @buffer first. The
+   * payload only gets merged into one memory when it already uses all
+   * memory slots a buffer has */
+  if (gst_buffer_n_memory (buffer) >= gst_buffer_get_max_memory ())
+    GST_DEBUG ("buffer %p has no room for the header memory, payload is "
+        "copied", buffer);
+  gst_buffer_copy_into (ret_buf, buffer, GST_BUFFER_COPY_MEMORY, 0, -1);
+
+  return ret_buf;
 }
 
 GstBuffer *
 gst_dp_payload_caps (const GstCaps * caps, GstDPHeaderFlag flags)
+{
+  return gst_dp_payload_caps_full (caps, flags, GST_DP_VERSION_1_0, NULL);
+}
+
+/**
+ * gst_dp_payload_caps_full:
+ * @caps: the #GstCaps to payload
+ * @flags: the #GstDPHeaderFlag to use
+ * @version: the #GstDPVersion of the packet
+ * @dict: (allow-none): the #GstDPDictionary of the connection, or %NULL
+ *
+ * Creates a caps packet of the given GDP version. For version 2.0, caps
+ * already in @dict are sent as a reference to the entry, other caps are
+ * added to it. Without @dict the packet is self-contained, which is what
+ * packets that might be the first a receiver sees need.
+ *
+ * Returns: a #GstBuffer holding the packet, or %NULL on error.
+ */
+GstBuffer *
+gst_dp_payload_caps_full (const GstCaps * caps, GstDPHeaderFlag flags,
+    GstDPVersion version, GstDPDictionary * dict)
 {
   GstBuffer *buf;
   GstMapInfo map;
@@ -236,17 +948,57 @@ gst_dp_payload_caps (const GstCaps * caps, GstDPHeaderFlag flags)
 
   g_assert (GST_IS_CAPS (caps));
 
+  if (version == GST_DP_VERSION_2_0) {
+    GstByteWriter bw;
+    gboolean ok = TRUE;
+    gint id = -1;
+
+    gst_byte_writer_init (&bw);
+    if (dict)
+      id = gst_dp_dictionary_lookup (dict, caps);
+
+    if (id >= 0) {
+      GST_LOG ("caps %" GST_PTR_FORMAT " are dictionary entry %d", caps, id);
+      ok &= gst_byte_writer_put_uint8 (&bw, GST_DP_CAPS_REFERENCE);
+      ok &= gst_byte_writer_put_uint16_be (&bw, id);
+    } else if (dict) {
+      ok &= gst_byte_writer_put_uint8 (&bw, GST_DP_CAPS_DEFINE);
+      ok &= gst_byte_writer_put_uint16_be (&bw, dict->next);
+      ok &= gst_dp_write_caps (&bw, caps);
+    } else {
+      ok &= gst_byte_writer_put_uint8 (&bw, GST_DP_CAPS_INLINE);
+      ok &= gst_dp_write_caps (&bw, caps);
+    }
+
+    if (!ok) {
+      GST_WARNING ("Could not encode caps %" GST_PTR_FORMAT, caps);
+      gst_byte_writer_reset (&bw);
+      return NULL;
+    }
+
+    /* only take the dictionary slot once the definition is encoded */
+    if (id < 0 && dict) {
+      GST_LOG ("defining caps %" GST_PTR_FORMAT " as dictionary entry %u",
+          caps, dict->next);
+      gst_caps_replace (&dict->caps[dict->next], (GstCaps *) caps);
+      dict->next = (dict->next + 1) % GST_DP_DICTIONARY_SIZE;
+    }
+
+    payload_length = gst_byte_writer_get_size (&bw);
+    string = gst_byte_writer_reset_and_get_data (&bw);
+  } else {
+    string = (guchar *) gst_caps_to_string (caps);
+    payload_length = strlen ((gchar *) string) + 1;     /* include trailing 0 */
+  }
+
   buf = gst_buffer_new ();
 
   mem = gst_allocator_alloc (NULL, GST_DP_HEADER_LENGTH, NULL);
   gst_memory_map (mem, &map, GST_MAP_READWRITE);
   h = memset (map.data, 0, map.size);
 
-  string = (guchar *) gst_caps_to_string (caps);
-  payload_length = strlen ((gchar *) string) + 1;       /* include trailing 0 */
-
   /* version, flags, type */
-  GST_DP_INIT_HEADER (h, GST_DP_VERSION_1_0, flags, GST_DP_PAYLOAD_CAPS);
+  GST_DP_INIT_HEADER (h, version, flags, GST_DP_PAYLOAD_CAPS);
 
   /* buffer properties */
   GST_WRITE_UINT32_BE (h + 6, payload_length);
@@ -263,7 +1015,7 @@ gst_dp_payload_caps (const GstCaps * caps, GstDPHeaderFlag flags)
   /* header */
   gst_buffer_append_memory (buf, mem);
 
-  /* caps string */
+  /* caps string or encoding */
   gst_buffer_append_memory (buf,
       gst_memory_new_wrapped (0, string, payload_length, 0, payload_length,
           string, g_free));
@@ -273,6 +1025,23 @@ gst_dp_payload_caps (const GstCaps * caps, GstDPHeaderFlag flags)
 
 GstBuffer *
 gst_dp_payload_event (const GstEvent * event, GstDPHeaderFlag flags)
+{
+  return gst_dp_payload_event_full (event, flags, GST_DP_VERSION_1_0);
+}
+
+/**
+ * gst_dp_payload_event_full:
+ * @event: the #GstEvent to payload
+ * @flags: the #GstDPHeaderFlag to use
+ * @version: the #GstDPVersion of the packet
+ *
+ * Creates an event packet of the given GDP version.
+ *
+ * Returns: a #GstBuffer holding the packet, or %NULL on error.
+ */
+GstBuffer *
+gst_dp_payload_event_full (const GstEvent * event, GstDPHeaderFlag flags,
+    GstDPVersion version)
 {
   GstBuffer *buf;
   GstMapInfo map;
@@ -284,14 +1053,20 @@ gst_dp_payload_event (const GstEvent * event, GstDPHeaderFlag flags)
 
   g_assert (GST_IS_EVENT (event));
 
-  buf = gst_buffer_new ();
-
-  mem = gst_allocator_alloc (NULL, GST_DP_HEADER_LENGTH, NULL);
-  gst_memory_map (mem, &map, GST_MAP_READWRITE);
-  h = memset (map.data, 0, map.size);
-
   structure = gst_event_get_structure ((GstEvent *) event);
-  if (structure) {
+  if (structure && version == GST_DP_VERSION_2_0) {
+    GstByteWriter bw;
+
+    gst_byte_writer_init (&bw);
+    if (!gst_dp_write_structure (&bw, structure)) {
+      GST_WARNING ("Could not encode event structure %" GST_PTR_FORMAT,
+          structure);
+      gst_byte_writer_reset (&bw);
+      return NULL;
+    }
+    pl_length = gst_byte_writer_get_size (&bw);
+    string = gst_byte_writer_reset_and_get_data (&bw);
+  } else if (structure) {
     string = (guchar *) gst_structure_to_string (structure);
     GST_LOG ("event %p has structure, string %s", event, string);
     pl_length = strlen ((gchar *) string) + 1;  /* include trailing 0 */
@@ -300,8 +1075,14 @@ gst_dp_payload_event (const GstEvent * event, GstDPHeaderFlag flags)
     pl_length = 0;
   }
 
+  buf = gst_buffer_new ();
+
+  mem = gst_allocator_alloc (NULL, GST_DP_HEADER_LENGTH, NULL);
+  gst_memory_map (mem, &map, GST_MAP_READWRITE);
+  h = memset (map.data, 0, map.size);
+
   /* version, flags, type */
-  GST_DP_INIT_HEADER (h, GST_DP_VERSION_1_0, flags,
+  GST_DP_INIT_HEADER (h, version, flags,
       GST_DP_PAYLOAD_EVENT_NONE + GST_EVENT_TYPE (event));
 
   /* length */
@@ -318,7 +1099,7 @@ gst_dp_payload_event (const GstEvent * event, GstDPHeaderFlag flags)
   /* header */
   gst_buffer_append_memory (buf, mem);
 
-  /* event string */
+  /* event string or encoding */
   if (pl_length > 0) {
     gst_buffer_append_memory (buf,
         gst_memory_new_wrapped (0, string, pl_length, 0, pl_length,
@@ -365,6 +1146,55 @@ static const guint16 gst_dp_crc_table[256] = {
   0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
 };
 
+/* gst_dp_crc_table extended for slice-by-8: entry [k][i] is the CRC of byte
+ * i followed by k + 1 zero bytes, so that 8 input bytes can be folded into
+ * the register with 8 independent lookups instead of 8 dependent ones */
+static guint16 gst_dp_crc_slice_table[7][256];
+
+static void
+gst_dp_crc_init_slice_table (void)
+{
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized)) {
+    guint i, k;
+
+    for (i = 0; i < 256; i++) {
+      guint16 crc = gst_dp_crc_table[i];
+
+      for (k = 0; k < 7; k++) {
+        crc = (guint16) ((crc << 8) ^ gst_dp_crc_table[crc >> 8]);
+        gst_dp_crc_slice_table[k][i] = crc;
+      }
+    }
+    g_once_init_leave (&initialized, 1);
+  }
+}
+
+static guint16
+gst_dp_crc_update (guint16 crc_register, const guint8 * buffer, gsize length)
+{
+  gst_dp_crc_init_slice_table ();
+
+  for (; length >= 8; length -= 8, buffer += 8) {
+    crc_register =
+        gst_dp_crc_slice_table[6][buffer[0] ^ (crc_register >> 8)] ^
+        gst_dp_crc_slice_table[5][buffer[1] ^ (crc_register & 0x00ff)] ^
+        gst_dp_crc_slice_table[4][buffer[2]] ^
+        gst_dp_crc_slice_table[3][buffer[3]] ^
+        gst_dp_crc_slice_table[2][buffer[4]] ^
+        gst_dp_crc_slice_table[1][buffer[5]] ^
+        gst_dp_crc_slice_table[0][buffer[6]] ^ gst_dp_crc_table[buffer[7]];
+  }
+
+  while (length-- > 0) {
+    crc_register = (guint16) ((crc_register << 8) ^
+        gst_dp_crc_table[((crc_register >> 8) & 0x00ff) ^ *buffer++]);
+  }
+
+  return crc_register;
+}
+
 /**
  * gst_dp_crc:
  * @buffer: array of bytes
@@ -387,10 +1217,8 @@ gst_dp_crc (const guint8 * buffer, guint length)
   g_assert (buffer != NULL);
 
   /* calc CRC */
-  for (; length--;) {
-    crc_register = (guint16) ((crc_register << 8) ^
-        gst_dp_crc_table[((crc_register >> 8) & 0x00ff) ^ *buffer++]);
-  }
+  crc_register = gst_dp_crc_update (crc_register, buffer, length);
+
   return (0xffff ^ crc_register);
 }
 
@@ -407,15 +1235,9 @@ gst_dp_crc_from_memory_maps (const GstMapInfo * maps, guint n_maps)
 
   /* calc CRC */
   while (n_maps > 0) {
-    guint8 *buffer = maps->data;
-    gsize length = maps->size;
+    crc_register = gst_dp_crc_update (crc_register, maps->data, maps->size);
+    total_length += maps->size;
 
-    total_length += length;
-
-    while (length-- > 0) {
-      crc_register = (guint16) ((crc_register << 8) ^
-          gst_dp_crc_table[((crc_register >> 8) & 0x00ff) ^ *buffer++]);
-    }
     --n_maps;
     ++maps;
   }
@@ -441,6 +1263,55 @@ gst_dp_init (void)
       "GStreamer Data Protocol");
 }
 
+/**
+ * gst_dp_dictionary_new:
+ *
+ * Creates an empty dictionary for one GDP 2.0 connection. The sender passes
+ * it to gst_dp_payload_caps_full() and the receiver to
+ * gst_dp_caps_from_packet_full(), so that both add the same entries in the
+ * same order.
+ *
+ * Returns: a new #GstDPDictionary, free with gst_dp_dictionary_free().
+ */
+GstDPDictionary *
+gst_dp_dictionary_new (void)
+{
+  return g_new0 (GstDPDictionary, 1);
+}
+
+/**
+ * gst_dp_dictionary_clear:
+ * @dict: a #GstDPDictionary
+ *
+ * Removes all entries, for when the connection starts over.
+ */
+void
+gst_dp_dictionary_clear (GstDPDictionary * dict)
+{
+  guint i;
+
+  g_return_if_fail (dict != NULL);
+
+  for (i = 0; i < GST_DP_DICTIONARY_SIZE; i++)
+    gst_caps_replace (&dict->caps[i], NULL);
+  dict->next = 0;
+}
+
+/**
+ * gst_dp_dictionary_free:
+ * @dict: a #GstDPDictionary
+ *
+ * Frees @dict and the caps it holds.
+ */
+void
+gst_dp_dictionary_free (GstDPDictionary * dict)
+{
+  g_return_if_fail (dict != NULL);
+
+  gst_dp_dictionary_clear (dict);
+  g_free (dict);
+}
+
 /**
  * gst_dp_header_payload_length:
  * @header: the byte header of the packet array
@@ -536,6 +1407,84 @@ gst_dp_buffer_from_header (guint header_length, const guint8 * header,
 GstCaps *
 gst_dp_caps_from_packet (guint header_length, const guint8 * header,
     const guint8 * payload)
+{
+  return gst_dp_caps_from_packet_full (header_length, header, payload, NULL);
+}
+
+static GstCaps *
+gst_dp_caps_from_packet_2_0 (guint header_length, const guint8 * header,
+    const guint8 * payload, GstDPDictionary * dict)
+{
+  GstByteReader br;
+  GstCaps *caps;
+  guint16 id = 0;
+  guint8 op;
+
+  gst_byte_reader_init (&br, payload, GST_DP_HEADER_PAYLOAD_LENGTH (header));
+
+  if (!gst_byte_reader_get_uint8 (&br, &op))
+    goto parse_error;
+
+  if (op != GST_DP_CAPS_INLINE) {
+    if (!gst_byte_reader_get_uint16_be (&br, &id) ||
+        id >= GST_DP_DICTIONARY_SIZE)
+      goto parse_error;
+  }
+
+  switch (op) {
+    case GST_DP_CAPS_INLINE:
+    case GST_DP_CAPS_DEFINE:
+      caps = gst_dp_read_caps (&br, 0);
+      if (caps == NULL)
+        goto parse_error;
+      if (op == GST_DP_CAPS_DEFINE && dict != NULL)
+        gst_caps_replace (&dict->caps[id], caps);
+      break;
+    case GST_DP_CAPS_REFERENCE:
+      if (dict == NULL || dict->caps[id] == NULL)
+        goto unknown_entry;
+      caps = gst_caps_ref (dict->caps[id]);
+      break;
+    default:
+      goto parse_error;
+  }
+
+  return caps;
+
+  /* ERRORS */
+parse_error:
+  {
+    GST_WARNING ("Could not parse GDP 2.0 caps payload");
+    return NULL;
+  }
+unknown_entry:
+  {
+    GST_WARNING ("Caps packet refers to unknown dictionary entry %u", id);
+    return NULL;
+  }
+}
+
+/**
+ * gst_dp_caps_from_packet_full:
+ * @header_length: the length of the packet header
+ * @header: the byte array of the packet header
+ * @payload: the byte array of the packet payload
+ * @dict: (allow-none): the #GstDPDictionary of the connection, or %NULL
+ *
+ * Creates a newly allocated #GstCaps from the given packet, looking up and
+ * storing GDP 2.0 dictionary entries in @dict. Without @dict, packets
+ * referring to a dictionary entry can't be read.
+ *
+ * This function does not check the arguments passed to it, use
+ * gst_dp_validate_packet() first if the header and payload data are
+ * unchecked.
+ *
+ * Returns: A #GstCaps containing the caps represented in the packet,
+ *          or NULL if the packet could not be converted.
+ */
+GstCaps *
+gst_dp_caps_from_packet_full (guint header_length, const guint8 * header,
+    const guint8 * payload, GstDPDictionary * dict)
 {
   GstCaps *caps;
   gchar *string;
@@ -546,6 +1495,9 @@ gst_dp_caps_from_packet (guint header_length, const guint8 * header,
       GST_DP_PAYLOAD_CAPS, NULL);
   g_return_val_if_fail (payload, NULL);
 
+  if (GST_DP_HEADER_MAJOR_VERSION (header) == 2)
+    return gst_dp_caps_from_packet_2_0 (header_length, header, payload, dict);
+
   /* 0 sized payload length will work create NULL string */
   string = g_strndup ((gchar *) payload, GST_DP_HEADER_PAYLOAD_LENGTH (header));
   caps = gst_caps_from_string (string);
@@ -637,6 +1589,29 @@ gst_dp_event_from_packet_1_0 (guint header_length, const guint8 * header,
   return event;
 }
 
+static GstEvent *
+gst_dp_event_from_packet_2_0 (guint header_length, const guint8 * header,
+    const guint8 * payload)
+{
+  GstEventType type;
+  GstStructure *s = NULL;
+
+  type = GST_DP_HEADER_PAYLOAD_TYPE (header) - GST_DP_PAYLOAD_EVENT_NONE;
+  if (payload) {
+    GstByteReader br;
+
+    gst_byte_reader_init (&br, payload, GST_DP_HEADER_PAYLOAD_LENGTH (header));
+    s = gst_dp_read_structure (&br, 0);
+    if (s == NULL) {
+      GST_WARNING ("Could not parse GDP 2.0 event payload");
+      return NULL;
+    }
+  }
+  GST_LOG ("Creating event of type 0x%x with structure '%" GST_PTR_FORMAT "'",
+      type, s);
+  return gst_event_new_custom (type, s);
+}
+
 
 /**
  * gst_dp_event_from_packet:
@@ -669,6 +1644,8 @@ gst_dp_event_from_packet (guint header_length, const guint8 * header,
     return gst_dp_event_from_packet_0_2 (header_length, header, payload);
   else if (major == 1 && minor == 0)
     return gst_dp_event_from_packet_1_0 (header_length, header, payload);
+  else if (major == 2 && minor == 0)
+    return gst_dp_event_from_packet_2_0 (header_length, header, payload);
   else {
     GST_ERROR ("Unknown GDP version %d.%d", major, minor);
     return NULL;
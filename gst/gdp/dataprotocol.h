@@ -69,8 +69,36 @@ typedef enum {
   GST_DP_PAYLOAD_EVENT_NONE      = 64,
 } GstDPPayloadType;
 
+/**
+ * GstDPVersion:
+ * @GST_DP_VERSION_0_2: GDP 0.2, only a few event types.
+ * @GST_DP_VERSION_1_0: GDP 1.0, caps and events serialized as strings.
+ * @GST_DP_VERSION_2_0: GDP 2.0, caps and events in binary encoding, with
+ *     caps that were sent before referenced from a #GstDPDictionary.
+ *
+ * The version of the GDP protocol being used.
+ */
+typedef enum {
+  GST_DP_VERSION_0_2 = 1,
+  GST_DP_VERSION_1_0,
+  GST_DP_VERSION_2_0,
+} GstDPVersion;
+
+/**
+ * GstDPDictionary:
+ *
+ * Caps already sent over a GDP 2.0 connection. Payloader and depayloader
+ * each keep one for the lifetime of the connection.
+ */
+typedef struct _GstDPDictionary GstDPDictionary;
+
 void            gst_dp_init                     (void);
 
+GstDPDictionary *
+                gst_dp_dictionary_new           (void);
+void            gst_dp_dictionary_clear         (GstDPDictionary * dict);
+void            gst_dp_dictionary_free          (GstDPDictionary * dict);
+
 /* payload information from header */
 guint32         gst_dp_header_payload_length    (const guint8 * header);
 GstDPPayloadType
@@ -84,6 +112,10 @@ GstBuffer *     gst_dp_buffer_from_header       (guint header_length,
 GstCaps *       gst_dp_caps_from_packet         (guint header_length,
                                                 const guint8 * header,
                                                 const guint8 * payload);
+GstCaps *       gst_dp_caps_from_packet_full    (guint header_length,
+                                                const guint8 * header,
+                                                const guint8 * payload,
+                                                GstDPDictionary * dict);
 GstEvent *      gst_dp_event_from_packet        (guint header_length,
                                                 const guint8 * header,
                                                 const guint8 * payload);
@@ -98,6 +130,15 @@ GstBuffer *     gst_dp_payload_caps             (const GstCaps  * caps,
 GstBuffer *     gst_dp_payload_event            (const GstEvent * event,
                                                  GstDPHeaderFlag  flags);
 
+GstBuffer *     gst_dp_payload_caps_full        (const GstCaps  * caps,
+                                                 GstDPHeaderFlag  flags,
+                                                 GstDPVersion     version,
+                                                 GstDPDictionary * dict);
+
+GstBuffer *     gst_dp_payload_event_full       (const GstEvent * event,
+                                                 GstDPHeaderFlag  flags,
+                                                 GstDPVersion     version);
+
 /* validation */
 gboolean        gst_dp_validate_header          (guint header_length,
                                                 const guint8 * header);
@@ -30,6 +30,9 @@
  * ]| This pipeline plays back a serialized video stream as created in the
  * example for gdppay.
  *
+ * Streams of GDP version 1.0 and 2.0 are both accepted, the version is
+ * read from each packet.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -144,6 +147,8 @@ gst_gdp_depay_init (GstGDPDepay * gdpdepay)
 
   gdpdepay->allocator = NULL;
   gst_allocation_params_init (&gdpdepay->allocation_params);
+
+  gdpdepay->dictionary = gst_dp_dictionary_new ();
 }
 
 static void
@@ -159,6 +164,7 @@ gst_gdp_depay_finalize (GObject * gobject)
   g_object_unref (this->adapter);
   if (this->allocator)
     gst_object_unref (this->allocator);
+  gst_dp_dictionary_free (this->dictionary);
 
   GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (gobject));
 }
@@ -277,7 +283,8 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
   /* On DISCONT, get rid of accumulated data. We assume a buffer after the
    * DISCONT contains (part of) a new valid header, if not we error because we
-   * lost sync */
+   * lost sync. The payloader doesn't know about the DISCONT and keeps
+   * referring to the caps it defined before, so keep the dictionary */
   if (GST_BUFFER_IS_DISCONT (buffer)) {
     gst_adapter_clear (this->adapter);
     this->state = GST_GDP_DEPAY_STATE_HEADER;
@@ -414,8 +421,8 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
         /* take the payload of the caps */
         GST_LOG_OBJECT (this, "reading GDP caps from adapter");
         payload = gst_adapter_take (this->adapter, this->payload_length);
-        caps = gst_dp_caps_from_packet (GST_DP_HEADER_LENGTH, this->header,
-            payload);
+        caps = gst_dp_caps_from_packet_full (GST_DP_HEADER_LENGTH,
+            this->header, payload, this->dictionary);
         g_free (payload);
         if (!caps)
           goto caps_failed;
@@ -534,6 +541,7 @@ gst_gdp_depay_change_state (GstElement * element, GstStateChange transition)
         this->caps = NULL;
       }
       gst_adapter_clear (this->adapter);
+      gst_dp_dictionary_clear (this->dictionary);
       if (this->allocator)
         gst_object_unref (this->allocator);
       this->allocator = NULL;
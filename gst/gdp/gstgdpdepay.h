@@ -71,6 +71,8 @@ struct _GstGDPDepay
 
   GstAllocator *allocator;
   GstAllocationParams allocation_params;
+
+  GstDPDictionary *dictionary; /* caps received in the stream, for GDP 2.0 */
 };
 
 struct _GstGDPDepayClass
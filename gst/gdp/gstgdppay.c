@@ -31,6 +31,11 @@
  * ]| This pipeline creates a serialized video stream that can be played back
  * with the example shown in gdpdepay.
  *
+ * Setting #GstGDPPay:version to 2.0 makes gdppay send caps and events in
+ * a binary encoding that is cheaper to create and to read back, and refer
+ * to caps it sent before instead of repeating them. Only receivers that
+ * know GDP 2.0 can read such a stream, so the default stays 1.0.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -58,14 +63,34 @@ GST_DEBUG_CATEGORY_STATIC (gst_gdp_pay_debug);
 
 #define DEFAULT_CRC_HEADER TRUE
 #define DEFAULT_CRC_PAYLOAD FALSE
+#define DEFAULT_VERSION GST_DP_VERSION_1_0
 
 enum
 {
   PROP_0,
   PROP_CRC_HEADER,
-  PROP_CRC_PAYLOAD
+  PROP_CRC_PAYLOAD,
+  PROP_VERSION
 };
 
+#define GST_TYPE_GDP_PAY_VERSION (gst_gdp_pay_version_get_type ())
+static GType
+gst_gdp_pay_version_get_type (void)
+{
+  static GType gdp_pay_version_type = 0;
+  static const GEnumValue gdp_pay_version[] = {
+    {GST_DP_VERSION_1_0, "GDP 1.0, caps and events as strings", "1.0"},
+    {GST_DP_VERSION_2_0, "GDP 2.0, binary caps and events", "2.0"},
+    {0, NULL, NULL},
+  };
+
+  if (!gdp_pay_version_type) {
+    gdp_pay_version_type =
+        g_enum_register_static ("GstGDPPayVersion", gdp_pay_version);
+  }
+  return gdp_pay_version_type;
+}
+
 #define _do_init \
     GST_DEBUG_CATEGORY_INIT (gst_gdp_pay_debug, "gdppay", 0, \
     "GDP payloader");
@@ -112,6 +137,17 @@ gst_gdp_pay_class_init (GstGDPPayClass * klass)
       g_param_spec_boolean ("crc-payload", "CRC Payload",
           "Calculate and store a CRC checksum on the payload",
           DEFAULT_CRC_PAYLOAD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstGDPPay:version:
+   *
+   * The GDP version of caps and event packets. Receivers before GDP 2.0
+   * can't read 2.0 caps and event packets.
+   */
+  g_object_class_install_property (gobject_class, PROP_VERSION,
+      g_param_spec_enum ("version", "Version",
+          "GDP version of caps and event packets", GST_TYPE_GDP_PAY_VERSION,
+          DEFAULT_VERSION, G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
   gst_element_class_set_static_metadata (gstelement_class,
       "GDP Payloader", "GDP/Payloader",
       "Payloads GStreamer Data Protocol buffers",
@@ -146,6 +182,8 @@ gst_gdp_pay_init (GstGDPPay * gdppay)
   gdppay->crc_payload = DEFAULT_CRC_PAYLOAD;
   gdppay->header_flag = gdppay->crc_header | gdppay->crc_payload;
   gdppay->offset = 0;
+  gdppay->version = DEFAULT_VERSION;
+  gdppay->dictionary = gst_dp_dictionary_new ();
 }
 
 static void
@@ -154,6 +192,7 @@ gst_gdp_pay_finalize (GObject * gobject)
   GstGDPPay *this = GST_GDP_PAY (gobject);
 
   gst_gdp_pay_reset (this);
+  gst_dp_dictionary_free (this->dictionary);
 
   GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (gobject));
 }
@@ -183,6 +222,7 @@ gst_gdp_pay_reset (GstGDPPay * this)
   this->sent_streamheader = FALSE;
   this->reset_streamheader = FALSE;
   this->offset = 0;
+  gst_dp_dictionary_clear (this->dictionary);
 }
 
 /* set OFFSET and OFFSET_END with running count */
@@ -194,10 +234,14 @@ gst_gdp_stamp_buffer (GstGDPPay * this, GstBuffer * buffer)
   this->offset = GST_BUFFER_OFFSET_END (buffer);
 }
 
+/* caps packets on the streamheader are the first ones new clients see, so
+ * they must not refer to the dictionary */
 static GstBuffer *
-gst_gdp_buffer_from_caps (GstGDPPay * this, GstCaps * caps)
+gst_gdp_buffer_from_caps (GstGDPPay * this, GstCaps * caps,
+    gboolean use_dictionary)
 {
-  return gst_dp_payload_caps (caps, this->header_flag);
+  return gst_dp_payload_caps_full (caps, this->header_flag, this->version,
+      use_dictionary ? this->dictionary : NULL);
 }
 
 static GstBuffer *
@@ -209,7 +253,7 @@ gst_gdp_pay_buffer_from_buffer (GstGDPPay * this, GstBuffer * buffer)
 static GstBuffer *
 gst_gdp_buffer_from_event (GstGDPPay * this, GstEvent * event)
 {
-  return gst_dp_payload_event (event, this->header_flag);
+  return gst_dp_payload_event_full (event, this->header_flag, this->version);
 }
 
 static void
@@ -242,7 +286,7 @@ gdp_streamheader_array_store_events (GstPad * pad, GstEvent ** event,
     GstCaps *caps;
 
     gst_event_parse_caps (*event, &caps);
-    buf = gst_gdp_buffer_from_caps (this, caps);
+    buf = gst_gdp_buffer_from_caps (this, caps, FALSE);
   } else {
     buf = gst_gdp_buffer_from_event (this, *event);
   }
@@ -546,7 +590,7 @@ gst_gdp_pay_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       if (this->caps == NULL || !gst_caps_is_equal (this->caps, caps)) {
         GST_INFO_OBJECT (pad, "caps changed to %" GST_PTR_FORMAT, caps);
         gst_caps_replace (&this->caps, caps);
-        outbuffer = gst_gdp_buffer_from_caps (this, caps);
+        outbuffer = gst_gdp_buffer_from_caps (this, caps, TRUE);
         if (outbuffer == NULL)
           goto no_buffer_from_caps;
 
@@ -655,6 +699,9 @@ gst_gdp_pay_set_property (GObject * object, guint prop_id,
           g_value_get_boolean (value) ? GST_DP_HEADER_FLAG_CRC_PAYLOAD : 0;
       this->header_flag = this->crc_header | this->crc_payload;
       break;
+    case PROP_VERSION:
+      this->version = g_value_get_enum (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -677,6 +724,9 @@ gst_gdp_pay_get_property (GObject * object, guint prop_id,
     case PROP_CRC_PAYLOAD:
       g_value_set_boolean (value, this->crc_payload);
       break;
+    case PROP_VERSION:
+      g_value_set_enum (value, this->version);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -65,6 +65,9 @@ struct _GstGDPPay
   gboolean crc_header;
   gboolean crc_payload;
   GstDPHeaderFlag header_flag;
+
+  GstDPVersion version;
+  GstDPDictionary *dictionary; /* caps sent in the stream, for GDP 2.0 */
 };
 
 struct _GstGDPPayClass
@@ -63,8 +63,6 @@ static gboolean gst_inter_audio_sink_start (GstBaseSink * sink);
 static gboolean gst_inter_audio_sink_stop (GstBaseSink * sink);
 static gboolean gst_inter_audio_sink_set_caps (GstBaseSink * sink,
     GstCaps * caps);
-static gboolean gst_inter_audio_sink_event (GstBaseSink * sink,
-    GstEvent * event);
 static GstFlowReturn gst_inter_audio_sink_render (GstBaseSink * sink,
     GstBuffer * buffer);
 static gboolean gst_inter_audio_sink_query (GstBaseSink * sink,
@@ -115,7 +113,6 @@ gst_inter_audio_sink_class_init (GstInterAudioSinkClass * klass)
       GST_DEBUG_FUNCPTR (gst_inter_audio_sink_get_times);
   base_sink_class->start = GST_DEBUG_FUNCPTR (gst_inter_audio_sink_start);
   base_sink_class->stop = GST_DEBUG_FUNCPTR (gst_inter_audio_sink_stop);
-  base_sink_class->event = GST_DEBUG_FUNCPTR (gst_inter_audio_sink_event);
   base_sink_class->set_caps = GST_DEBUG_FUNCPTR (gst_inter_audio_sink_set_caps);
   base_sink_class->render = GST_DEBUG_FUNCPTR (gst_inter_audio_sink_render);
   base_sink_class->query = GST_DEBUG_FUNCPTR (gst_inter_audio_sink_query);
@@ -130,7 +127,6 @@ static void
 gst_inter_audio_sink_init (GstInterAudioSink * interaudiosink)
 {
   interaudiosink->channel = g_strdup (DEFAULT_CHANNEL);
-  interaudiosink->input_adapter = gst_adapter_new ();
 }
 
 void
@@ -173,7 +169,6 @@ gst_inter_audio_sink_finalize (GObject * object)
 
   /* clean up object here */
   g_free (interaudiosink->channel);
-  gst_object_unref (interaudiosink->input_adapter);
 
   G_OBJECT_CLASS (gst_inter_audio_sink_parent_class)->finalize (object);
 }
@@ -208,6 +203,9 @@ gst_inter_audio_sink_start (GstBaseSink * sink)
   interaudiosink->surface = gst_inter_surface_get (interaudiosink->channel);
   g_mutex_lock (&interaudiosink->surface->mutex);
   memset (&interaudiosink->surface->audio_info, 0, sizeof (GstAudioInfo));
+  gst_inter_surface_reset_audio_ring (interaudiosink->surface);
+  interaudiosink->ring_cookie =
+      g_atomic_int_get (&interaudiosink->surface->audio_cookie) - 1;
 
   /* We want to write latency-time before syncing has happened */
   /* FIXME: The other side can change this value when it starts */
@@ -226,14 +224,16 @@ gst_inter_audio_sink_stop (GstBaseSink * sink)
   GST_DEBUG_OBJECT (interaudiosink, "stop");
 
   g_mutex_lock (&interaudiosink->surface->mutex);
-  gst_adapter_clear (interaudiosink->surface->audio_adapter);
   memset (&interaudiosink->surface->audio_info, 0, sizeof (GstAudioInfo));
+  gst_inter_surface_reset_audio_ring (interaudiosink->surface);
   g_mutex_unlock (&interaudiosink->surface->mutex);
 
   gst_inter_surface_unref (interaudiosink->surface);
   interaudiosink->surface = NULL;
 
-  gst_adapter_clear (interaudiosink->input_adapter);
+  if (interaudiosink->ring)
+    gst_inter_audio_ring_unref (interaudiosink->ring);
+  interaudiosink->ring = NULL;
 
   return TRUE;
 }
@@ -253,93 +253,56 @@ gst_inter_audio_sink_set_caps (GstBaseSink * sink, GstCaps * caps)
   interaudiosink->surface->audio_info = info;
   interaudiosink->info = info;
   /* TODO: Ideally we would drain the source here */
-  gst_adapter_clear (interaudiosink->surface->audio_adapter);
+  gst_inter_surface_reset_audio_ring (interaudiosink->surface);
   g_mutex_unlock (&interaudiosink->surface->mutex);
 
   return TRUE;
 }
 
-static gboolean
-gst_inter_audio_sink_event (GstBaseSink * sink, GstEvent * event)
-{
-  GstInterAudioSink *interaudiosink = GST_INTER_AUDIO_SINK (sink);
-
-  switch (GST_EVENT_TYPE (event)) {
-    case GST_EVENT_EOS:{
-      GstBuffer *tmp;
-      guint n;
-
-      if ((n = gst_adapter_available (interaudiosink->input_adapter)) > 0) {
-        g_mutex_lock (&interaudiosink->surface->mutex);
-        tmp = gst_adapter_take_buffer (interaudiosink->input_adapter, n);
-        gst_adapter_push (interaudiosink->surface->audio_adapter, tmp);
-        g_mutex_unlock (&interaudiosink->surface->mutex);
-      }
-      break;
-    }
-    default:
-      break;
-  }
-
-  return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
-}
-
 static GstFlowReturn
 gst_inter_audio_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
   GstInterAudioSink *interaudiosink = GST_INTER_AUDIO_SINK (sink);
-  guint n, bpf;
-  guint64 period_time, buffer_time;
-  guint64 period_samples, buffer_samples;
+  GstInterSurface *surface = interaudiosink->surface;
+  GstMapInfo map;
 
   GST_DEBUG_OBJECT (interaudiosink, "render %" G_GSIZE_FORMAT,
       gst_buffer_get_size (buffer));
-  bpf = interaudiosink->info.bpf;
 
-  g_mutex_lock (&interaudiosink->surface->mutex);
+  if (gst_inter_surface_update_audio_ring (surface, &interaudiosink->ring,
+          &interaudiosink->ring_cookie)) {
+    guint64 period_time, buffer_time;
+
+    g_mutex_lock (&surface->mutex);
+    buffer_time = surface->audio_buffer_time;
+    period_time = surface->audio_period_time;
+    g_mutex_unlock (&surface->mutex);
+
+    if (buffer_time < period_time) {
+      GST_ERROR_OBJECT (interaudiosink,
+          "Buffer time smaller than period time (%" GST_TIME_FORMAT " < %"
+          GST_TIME_FORMAT ")", GST_TIME_ARGS (buffer_time),
+          GST_TIME_ARGS (period_time));
+      return GST_FLOW_ERROR;
+    }
+  }
 
-  buffer_time = interaudiosink->surface->audio_buffer_time;
-  period_time = interaudiosink->surface->audio_period_time;
+  if (interaudiosink->ring == NULL ||
+      interaudiosink->ring->bpf != interaudiosink->info.bpf)
+    return GST_FLOW_OK;
 
-  if (buffer_time < period_time) {
-    GST_ERROR_OBJECT (interaudiosink,
-        "Buffer time smaller than period time (%" GST_TIME_FORMAT " < %"
-        GST_TIME_FORMAT ")", GST_TIME_ARGS (buffer_time),
-        GST_TIME_ARGS (period_time));
-    g_mutex_unlock (&interaudiosink->surface->mutex);
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    GST_ERROR_OBJECT (interaudiosink, "Failed to map buffer");
     return GST_FLOW_ERROR;
   }
 
-  buffer_samples =
-      gst_util_uint64_scale (buffer_time, interaudiosink->info.rate,
-      GST_SECOND);
-  period_samples =
-      gst_util_uint64_scale (period_time, interaudiosink->info.rate,
-      GST_SECOND);
-
-  n = gst_adapter_available (interaudiosink->surface->audio_adapter) / bpf;
-  while (n > buffer_samples) {
-    GST_DEBUG_OBJECT (interaudiosink, "flushing %" GST_TIME_FORMAT,
-        GST_TIME_ARGS (period_time));
-    gst_adapter_flush (interaudiosink->surface->audio_adapter,
-        period_samples * bpf);
-    n -= period_samples;
-  }
-
-  n = gst_adapter_available (interaudiosink->input_adapter);
-  if (period_samples * bpf > gst_buffer_get_size (buffer) + n) {
-    gst_adapter_push (interaudiosink->input_adapter, gst_buffer_ref (buffer));
-  } else {
-    GstBuffer *tmp;
+  /* The source trims the ring down to buffer-time, so this only overwrites
+   * unread samples if the source stopped reading for a while. It then gets
+   * the most recent ones, the oldest are dropped. */
+  gst_inter_audio_ring_write (interaudiosink->ring, map.data,
+      map.size / interaudiosink->info.bpf);
 
-    if (n > 0) {
-      tmp = gst_adapter_take_buffer (interaudiosink->input_adapter, n);
-      gst_adapter_push (interaudiosink->surface->audio_adapter, tmp);
-    }
-    gst_adapter_push (interaudiosink->surface->audio_adapter,
-        gst_buffer_ref (buffer));
-  }
-  g_mutex_unlock (&interaudiosink->surface->mutex);
+  gst_buffer_unmap (buffer, &map);
 
   return GST_FLOW_OK;
 }
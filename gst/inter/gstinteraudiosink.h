@@ -41,8 +41,10 @@ struct _GstInterAudioSink
   GstInterSurface *surface;
   char *channel;
 
-  GstAdapter *input_adapter;
   GstAudioInfo info;
+
+  GstInterAudioRing *ring;
+  gint ring_cookie;
 };
 
 struct _GstInterAudioSinkClass
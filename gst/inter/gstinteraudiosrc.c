@@ -33,6 +33,16 @@
  * See the gstintertest.c example in the gst-plugins-bad source code for
  * more details.
  *
+ * Samples are handed over through a ring buffer that holds up to
+ * #GstInterAudioSrc:buffer-time of audio; neither side takes a lock while
+ * streaming. If interaudiosrc stops reading for a while, the sink keeps
+ * writing and the oldest samples are dropped, so reading resumes with the
+ * most recent audio. If the two pipelines run off different clocks, the
+ * ring slowly fills up or drains. With
+ * #GstInterAudioSrc:drift-compensation enabled, interaudiosrc tracks the
+ * fill level and repeats or drops single samples to keep it stable instead
+ * of running into overruns or underruns.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -77,10 +87,17 @@ enum
   PROP_CHANNEL,
   PROP_BUFFER_TIME,
   PROP_LATENCY_TIME,
-  PROP_PERIOD_TIME
+  PROP_PERIOD_TIME,
+  PROP_DRIFT_COMPENSATION,
+  PROP_STATS
 };
 
 #define DEFAULT_CHANNEL ("default")
+#define DEFAULT_DRIFT_COMPENSATION FALSE
+
+/* number of periods to average the ring fill level over before using it
+ * as the reference for drift compensation */
+#define DRIFT_SETTLE_PERIODS 32
 
 /* pad templates */
 static GstStaticPadTemplate gst_inter_audio_src_src_template =
@@ -148,6 +165,18 @@ gst_inter_audio_src_class_init (GstInterAudioSrcClass * klass)
           "The minimum amount of data to read in each iteration",
           1, G_MAXUINT64, DEFAULT_AUDIO_PERIOD_TIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_DRIFT_COMPENSATION,
+      g_param_spec_boolean ("drift-compensation", "Drift Compensation",
+          "Repeat or drop samples to compensate for clock drift between "
+          "the interaudiosink and interaudiosrc pipelines",
+          DEFAULT_DRIFT_COMPENSATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Sample statistics of this source", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -161,6 +190,23 @@ gst_inter_audio_src_init (GstInterAudioSrc * interaudiosrc)
   interaudiosrc->buffer_time = DEFAULT_AUDIO_BUFFER_TIME;
   interaudiosrc->latency_time = DEFAULT_AUDIO_LATENCY_TIME;
   interaudiosrc->period_time = DEFAULT_AUDIO_PERIOD_TIME;
+  interaudiosrc->drift_compensation = DEFAULT_DRIFT_COMPENSATION;
+}
+
+static GstStructure *
+gst_inter_audio_src_get_stats (GstInterAudioSrc * interaudiosrc)
+{
+  GstStructure *s;
+
+  GST_OBJECT_LOCK (interaudiosrc);
+  s = gst_structure_new ("application/x-inter-audio-src-stats",
+      "silence-samples", G_TYPE_UINT64, interaudiosrc->silence_samples,
+      "dropped-samples", G_TYPE_UINT64, interaudiosrc->dropped_samples,
+      "inserted-samples", G_TYPE_UINT64, interaudiosrc->inserted_samples,
+      "removed-samples", G_TYPE_UINT64, interaudiosrc->removed_samples, NULL);
+  GST_OBJECT_UNLOCK (interaudiosrc);
+
+  return s;
 }
 
 void
@@ -183,6 +229,9 @@ gst_inter_audio_src_set_property (GObject * object, guint property_id,
     case PROP_PERIOD_TIME:
       interaudiosrc->period_time = g_value_get_uint64 (value);
       break;
+    case PROP_DRIFT_COMPENSATION:
+      interaudiosrc->drift_compensation = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -208,6 +257,12 @@ gst_inter_audio_src_get_property (GObject * object, guint property_id,
     case PROP_PERIOD_TIME:
       g_value_set_uint64 (value, interaudiosrc->period_time);
       break;
+    case PROP_DRIFT_COMPENSATION:
+      g_value_set_boolean (value, interaudiosrc->drift_compensation);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_inter_audio_src_get_stats (interaudiosrc));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -287,8 +342,21 @@ gst_inter_audio_src_start (GstBaseSrc * src)
   interaudiosrc->surface->audio_buffer_time = interaudiosrc->buffer_time;
   interaudiosrc->surface->audio_latency_time = interaudiosrc->latency_time;
   interaudiosrc->surface->audio_period_time = interaudiosrc->period_time;
+  gst_inter_surface_reset_audio_ring (interaudiosrc->surface);
+  interaudiosrc->ring_cookie =
+      g_atomic_int_get (&interaudiosrc->surface->audio_cookie) - 1;
   g_mutex_unlock (&interaudiosrc->surface->mutex);
 
+  interaudiosrc->overrun = 0;
+  interaudiosrc->fill_periods = 0;
+
+  GST_OBJECT_LOCK (interaudiosrc);
+  interaudiosrc->silence_samples = 0;
+  interaudiosrc->dropped_samples = 0;
+  interaudiosrc->inserted_samples = 0;
+  interaudiosrc->removed_samples = 0;
+  GST_OBJECT_UNLOCK (interaudiosrc);
+
   return TRUE;
 }
 
@@ -302,6 +370,10 @@ gst_inter_audio_src_stop (GstBaseSrc * src)
   gst_inter_surface_unref (interaudiosrc->surface);
   interaudiosrc->surface = NULL;
 
+  if (interaudiosrc->ring)
+    gst_inter_audio_ring_unref (interaudiosrc->ring);
+  interaudiosrc->ring = NULL;
+
   return TRUE;
 }
 
@@ -330,84 +402,177 @@ gst_inter_audio_src_get_times (GstBaseSrc * src, GstBuffer * buffer,
   }
 }
 
+/* Decides whether to repeat (insert) or drop (remove) a sample in this
+ * period, based on how far the smoothed ring fill level moved away from
+ * where it settled */
+static void
+gst_inter_audio_src_track_drift (GstInterAudioSrc * interaudiosrc,
+    guint avail, guint period_samples, gboolean * insert, gboolean * remove)
+{
+  gdouble tolerance = period_samples / 2.0;
+
+  if (avail < period_samples) {
+    /* underrun, settle again once data is flowing */
+    interaudiosrc->fill_periods = 0;
+    return;
+  }
+
+  if (interaudiosrc->fill_periods == 0)
+    interaudiosrc->fill_avg = avail;
+  else
+    interaudiosrc->fill_avg += (avail - interaudiosrc->fill_avg) / 16.0;
+
+  if (interaudiosrc->fill_periods < DRIFT_SETTLE_PERIODS) {
+    if (++interaudiosrc->fill_periods == DRIFT_SETTLE_PERIODS) {
+      interaudiosrc->fill_target = interaudiosrc->fill_avg;
+      GST_DEBUG_OBJECT (interaudiosrc, "ring fill level settled at %.1f",
+          interaudiosrc->fill_target);
+    }
+    return;
+  }
+
+  if (interaudiosrc->fill_avg > interaudiosrc->fill_target + tolerance)
+    *remove = TRUE;
+  else if (interaudiosrc->fill_avg < interaudiosrc->fill_target - tolerance)
+    *insert = TRUE;
+}
+
 static GstFlowReturn
 gst_inter_audio_src_create (GstBaseSrc * src, guint64 offset, guint size,
     GstBuffer ** buf)
 {
   GstInterAudioSrc *interaudiosrc = GST_INTER_AUDIO_SRC (src);
+  GstInterSurface *surface = interaudiosrc->surface;
+  GstInterAudioRing *ring;
   GstCaps *caps;
   GstBuffer *buffer;
-  guint n, bpf;
-  guint64 period_time;
-  guint64 period_samples;
+  GstMapInfo map;
+  guint n, bpf, avail, silence;
+  guint skipped = 0, overrun = 0;
+  guint64 period_samples, buffer_samples;
+  gboolean insert = FALSE, remove = FALSE;
+  guint inserted = 0, removed = 0;
 
   GST_DEBUG_OBJECT (interaudiosrc, "create");
 
-  buffer = NULL;
   caps = NULL;
 
-  g_mutex_lock (&interaudiosrc->surface->mutex);
-  if (interaudiosrc->surface->audio_info.finfo) {
-    if (!gst_audio_info_is_equal (&interaudiosrc->surface->audio_info,
-            &interaudiosrc->info)) {
-      caps = gst_audio_info_to_caps (&interaudiosrc->surface->audio_info);
-      interaudiosrc->timestamp_offset +=
-          gst_util_uint64_scale (interaudiosrc->n_samples, GST_SECOND,
-          interaudiosrc->info.rate);
-      interaudiosrc->n_samples = 0;
+  if (gst_inter_surface_update_audio_ring (surface, &interaudiosrc->ring,
+          &interaudiosrc->ring_cookie)) {
+    g_mutex_lock (&surface->mutex);
+    if (surface->audio_info.finfo) {
+      if (!gst_audio_info_is_equal (&surface->audio_info,
+              &interaudiosrc->info)) {
+        caps = gst_audio_info_to_caps (&surface->audio_info);
+        interaudiosrc->timestamp_offset +=
+            gst_util_uint64_scale (interaudiosrc->n_samples, GST_SECOND,
+            interaudiosrc->info.rate);
+        interaudiosrc->n_samples = 0;
+      }
     }
-  }
-
-  bpf = interaudiosrc->surface->audio_info.bpf;
-  period_time = interaudiosrc->surface->audio_period_time;
-  period_samples =
-      gst_util_uint64_scale (period_time, interaudiosrc->info.rate, GST_SECOND);
+    g_mutex_unlock (&surface->mutex);
 
-  if (bpf > 0)
-    n = gst_adapter_available (interaudiosrc->surface->audio_adapter) / bpf;
-  else
-    n = 0;
-
-  if (n > period_samples)
-    n = period_samples;
-  if (n > 0) {
-    buffer = gst_adapter_take_buffer (interaudiosrc->surface->audio_adapter,
-        n * bpf);
-  } else {
-    buffer = gst_buffer_new ();
-    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
+    interaudiosrc->overrun = 0;
+    interaudiosrc->fill_periods = 0;
   }
-  g_mutex_unlock (&interaudiosrc->surface->mutex);
 
   if (caps) {
     gboolean ret = gst_base_src_set_caps (src, caps);
-    gst_caps_unref (caps);
+
     if (!ret) {
       GST_ERROR_OBJECT (src, "Failed to set caps %" GST_PTR_FORMAT, caps);
-      if (buffer)
-        gst_buffer_unref (buffer);
+      gst_caps_unref (caps);
       return GST_FLOW_NOT_NEGOTIATED;
     }
+    gst_caps_unref (caps);
   }
 
-  buffer = gst_buffer_make_writable (buffer);
-
   bpf = interaudiosrc->info.bpf;
-  if (n < period_samples) {
-    GstMapInfo map;
-    GstMemory *mem;
-
-    GST_DEBUG_OBJECT (interaudiosrc,
-        "creating %" G_GUINT64_FORMAT " samples of silence",
-        period_samples - n);
-    mem = gst_allocator_alloc (NULL, (period_samples - n) * bpf, NULL);
-    if (gst_memory_map (mem, &map, GST_MAP_WRITE)) {
-      gst_audio_format_fill_silence (interaudiosrc->info.finfo, map.data,
-          map.size);
-      gst_memory_unmap (mem, &map);
+  period_samples = gst_util_uint64_scale (interaudiosrc->period_time,
+      interaudiosrc->info.rate, GST_SECOND);
+  buffer_samples = gst_util_uint64_scale (interaudiosrc->buffer_time,
+      interaudiosrc->info.rate, GST_SECOND);
+
+  ring = interaudiosrc->ring;
+  if (ring && ring->bpf != bpf)
+    ring = NULL;
+
+  avail = 0;
+  if (ring) {
+    /* Keep the latency bounded to buffer-time */
+    avail = gst_inter_audio_ring_available (ring);
+    if (avail > buffer_samples) {
+      GST_DEBUG_OBJECT (interaudiosrc, "flushing %" G_GUINT64_FORMAT
+          " samples", avail - buffer_samples);
+      skipped = gst_inter_audio_ring_skip (ring, avail - buffer_samples);
+      avail -= skipped;
     }
-    gst_buffer_prepend_memory (buffer, mem);
+
+    if (interaudiosrc->drift_compensation)
+      gst_inter_audio_src_track_drift (interaudiosrc, avail, period_samples,
+          &insert, &remove);
   }
+
+  buffer = gst_buffer_new_allocate (NULL, period_samples * bpf, NULL);
+  if (!gst_buffer_map (buffer, &map, GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT (interaudiosrc, "Failed to map buffer");
+    gst_buffer_unref (buffer);
+    return GST_FLOW_ERROR;
+  }
+
+  n = 0;
+  if (ring) {
+    guint want, total;
+
+    /* Less than available comes out of the ring if the sink overwrote some
+     * of it meanwhile, the samples are always moved to the end of the
+     * buffer with silence before them */
+    if (insert && period_samples > 1 && avail >= period_samples - 1) {
+      want = period_samples - 1;
+      n = gst_inter_audio_ring_read (ring, map.data, want);
+      if (n == want) {
+        memcpy (map.data + n * bpf, map.data + (n - 1) * bpf, bpf);
+        n++;
+        inserted = 1;
+      } else {
+        memmove (map.data + (period_samples - n) * bpf, map.data, n * bpf);
+      }
+    } else {
+      want = MIN (avail, period_samples);
+      n = gst_inter_audio_ring_read (ring,
+          map.data + (period_samples - want) * bpf, want);
+      if (n < want)
+        memmove (map.data + (period_samples - n) * bpf,
+            map.data + (period_samples - want) * bpf, n * bpf);
+      if (remove && gst_inter_audio_ring_skip (ring, 1) == 1)
+        removed = 1;
+    }
+
+    /* samples the sink overwrote before we got to them */
+    total = g_atomic_int_get (&ring->overrun);
+    overrun = total - interaudiosrc->overrun;
+    interaudiosrc->overrun = total;
+  }
+
+  silence = period_samples - n;
+  if (silence > 0) {
+    GST_DEBUG_OBJECT (interaudiosrc, "creating %u samples of silence",
+        silence);
+    gst_audio_format_fill_silence (interaudiosrc->info.finfo, map.data,
+        silence * bpf);
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  if (n == 0)
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
+
+  GST_OBJECT_LOCK (interaudiosrc);
+  interaudiosrc->silence_samples += silence;
+  interaudiosrc->dropped_samples += skipped + overrun;
+  interaudiosrc->inserted_samples += inserted;
+  interaudiosrc->removed_samples += removed;
+  GST_OBJECT_UNLOCK (interaudiosrc);
+
   n = period_samples;
 
   GST_BUFFER_OFFSET (buffer) = interaudiosrc->n_samples;
@@ -46,6 +46,22 @@ struct _GstInterAudioSrc
   GstClockTime timestamp_offset;
   GstAudioInfo info;
   guint64 buffer_time, latency_time, period_time;
+  gboolean drift_compensation;
+
+  GstInterAudioRing *ring;
+  gint ring_cookie;
+  guint overrun;
+
+  /* smoothed ring fill level and the level it settled at, in frames */
+  gdouble fill_avg;
+  gdouble fill_target;
+  guint fill_periods;
+
+  /* statistics, protected by the object lock */
+  guint64 silence_samples;
+  guint64 dropped_samples;
+  guint64 inserted_samples;
+  guint64 removed_samples;
 };
 
 struct _GstInterAudioSrcClass
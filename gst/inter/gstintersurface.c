@@ -33,6 +33,7 @@ gst_inter_surface_get (const char *name)
 {
   GList *g;
   GstInterSurface *surface;
+  gint i;
 
   g_mutex_lock (&mutex);
   for (g = list; g; g = g_list_next (g)) {
@@ -48,10 +49,11 @@ gst_inter_surface_get (const char *name)
   surface->ref_count = 1;
   surface->name = g_strdup (name);
   g_mutex_init (&surface->mutex);
-  surface->audio_adapter = gst_adapter_new ();
   surface->audio_buffer_time = DEFAULT_AUDIO_BUFFER_TIME;
   surface->audio_latency_time = DEFAULT_AUDIO_LATENCY_TIME;
   surface->audio_period_time = DEFAULT_AUDIO_PERIOD_TIME;
+  for (i = 0; i < GST_INTER_SURFACE_VIDEO_SLOTS; i++)
+    surface->video_slots[i].clock_time = GST_CLOCK_TIME_NONE;
 
   list = g_list_append (list, surface);
   g_mutex_unlock (&mutex);
@@ -68,6 +70,7 @@ gst_inter_surface_unref (GstInterSurface * surface)
   g_mutex_lock (&mutex);
   if ((--surface->ref_count) == 0) {
     GList *g;
+    gint i;
 
     for (g = list; g; g = g_list_next (g)) {
       GstInterSurface *tmp = g->data;
@@ -78,11 +81,300 @@ gst_inter_surface_unref (GstInterSurface * surface)
     }
 
     g_mutex_clear (&surface->mutex);
-    gst_buffer_replace (&surface->video_buffer, NULL);
+    for (i = 0; i < GST_INTER_SURFACE_VIDEO_SLOTS; i++)
+      gst_buffer_replace (&surface->video_slots[i].buffer, NULL);
     gst_buffer_replace (&surface->sub_buffer, NULL);
-    gst_object_unref (surface->audio_adapter);
+    if (surface->audio_ring)
+      gst_inter_audio_ring_unref (surface->audio_ring);
     g_free (surface->name);
     g_free (surface);
   }
   g_mutex_unlock (&mutex);
 }
+
+/* Must be called with the surface mutex held */
+void
+gst_inter_surface_set_video_info (GstInterSurface * surface,
+    const GstVideoInfo * info)
+{
+  if (info)
+    surface->video_info = *info;
+  else
+    memset (&surface->video_info, 0, sizeof (GstVideoInfo));
+  g_atomic_int_inc (&surface->video_info_cookie);
+}
+
+/* Publishes a new video frame (or NULL when the sink goes away). Sinks are
+ * serialized with the surface mutex, sources never take it here: the new
+ * frame is stored in the slot following the current one and only then made
+ * visible by bumping video_seq. A source can only still be looking at that
+ * slot if it read video_seq three frames ago, so the wait below is almost
+ * never taken. The number of slots is a power of two so that the mapping
+ * stays the same when video_seq wraps around. */
+void
+gst_inter_surface_push_video (GstInterSurface * surface, GstBuffer * buffer,
+    GstClockTime clock_time)
+{
+  GstInterVideoSlot *slot;
+  GstBuffer *old;
+  guint seq;
+
+  g_mutex_lock (&surface->mutex);
+  seq = g_atomic_int_get (&surface->video_seq);
+  slot = &surface->video_slots[(seq + 1) % GST_INTER_SURFACE_VIDEO_SLOTS];
+
+  while (!g_atomic_int_compare_and_exchange (&slot->lock, 0, -1))
+    g_thread_yield ();
+
+  old = slot->buffer;
+  slot->buffer = buffer ? gst_buffer_ref (buffer) : NULL;
+  slot->clock_time = clock_time;
+  slot->video_info = surface->video_info;
+  slot->video_info_cookie = g_atomic_int_get (&surface->video_info_cookie);
+
+  g_atomic_int_set (&slot->lock, 0);
+  g_atomic_int_set (&surface->video_seq, seq + 1);
+  g_mutex_unlock (&surface->mutex);
+
+  if (old)
+    gst_buffer_unref (old);
+}
+
+/* Returns a new reference to the latest video frame, or NULL if there is
+ * none, together with its sequence number. Lock-free, any number of sources
+ * can call this concurrently; the returned buffer shares its memory with
+ * the one the sink rendered. The video info the frame was pushed with and
+ * its cookie are read under the same slot lock as the buffer. */
+GstBuffer *
+gst_inter_surface_peek_video (GstInterSurface * surface, guint * seq,
+    GstClockTime * clock_time, gint * cookie, GstVideoInfo * info)
+{
+  GstInterVideoSlot *slot;
+  GstBuffer *buffer;
+  guint cur;
+  gint lock;
+
+  for (;;) {
+    cur = g_atomic_int_get (&surface->video_seq);
+    slot = &surface->video_slots[cur % GST_INTER_SURFACE_VIDEO_SLOTS];
+
+    lock = g_atomic_int_get (&slot->lock);
+    if (lock < 0 ||
+        !g_atomic_int_compare_and_exchange (&slot->lock, lock, lock + 1))
+      continue;
+
+    /* the sink may have come around to this slot again before we got it */
+    if ((guint) g_atomic_int_get (&surface->video_seq) - cur >=
+        GST_INTER_SURFACE_VIDEO_SLOTS - 1) {
+      g_atomic_int_add (&slot->lock, -1);
+      continue;
+    }
+
+    buffer = slot->buffer ? gst_buffer_ref (slot->buffer) : NULL;
+    if (clock_time)
+      *clock_time = slot->clock_time;
+    *cookie = slot->video_info_cookie;
+    *info = slot->video_info;
+    g_atomic_int_add (&slot->lock, -1);
+    break;
+  }
+
+  if (seq)
+    *seq = cur;
+
+  return buffer;
+}
+
+static GstInterAudioRing *
+gst_inter_audio_ring_new (guint bpf, guint min_frames)
+{
+  GstInterAudioRing *ring;
+
+  ring = g_new0 (GstInterAudioRing, 1);
+  ring->ref_count = 1;
+  ring->bpf = bpf;
+  ring->size = 1;
+  while (ring->size < min_frames && ring->size < (1U << 31))
+    ring->size <<= 1;
+  ring->data = g_malloc ((gsize) ring->size * bpf);
+
+  return ring;
+}
+
+GstInterAudioRing *
+gst_inter_audio_ring_ref (GstInterAudioRing * ring)
+{
+  g_atomic_int_inc (&ring->ref_count);
+
+  return ring;
+}
+
+void
+gst_inter_audio_ring_unref (GstInterAudioRing * ring)
+{
+  if (g_atomic_int_dec_and_test (&ring->ref_count)) {
+    g_free (ring->data);
+    g_free (ring);
+  }
+}
+
+/* Must be called with the surface mutex held. Drops whatever is queued and
+ * sets up a new ring for the current audio caps and buffer time, the sink
+ * and source pick it up through gst_inter_surface_update_audio_ring(). */
+void
+gst_inter_surface_reset_audio_ring (GstInterSurface * surface)
+{
+  guint64 frames;
+
+  if (surface->audio_ring)
+    gst_inter_audio_ring_unref (surface->audio_ring);
+  surface->audio_ring = NULL;
+
+  if (surface->audio_info.finfo && surface->audio_info.rate > 0 &&
+      surface->audio_info.bpf > 0) {
+    /* leave room for one more period so that the sink can keep writing
+     * while the source trims the ring down to buffer-time */
+    frames = gst_util_uint64_scale_ceil (surface->audio_buffer_time +
+        surface->audio_period_time, surface->audio_info.rate, GST_SECOND);
+    surface->audio_ring = gst_inter_audio_ring_new (surface->audio_info.bpf,
+        MIN (frames, G_MAXUINT / 2));
+  }
+
+  g_atomic_int_inc (&surface->audio_cookie);
+}
+
+/* Makes *ring the current ring of the surface if it changed since *cookie
+ * was taken. Only takes the surface mutex in that case. Returns TRUE if
+ * *ring was replaced. */
+gboolean
+gst_inter_surface_update_audio_ring (GstInterSurface * surface,
+    GstInterAudioRing ** ring, gint * cookie)
+{
+  if (g_atomic_int_get (&surface->audio_cookie) == *cookie)
+    return FALSE;
+
+  g_mutex_lock (&surface->mutex);
+  if (*ring)
+    gst_inter_audio_ring_unref (*ring);
+  *ring = surface->audio_ring ?
+      gst_inter_audio_ring_ref (surface->audio_ring) : NULL;
+  *cookie = g_atomic_int_get (&surface->audio_cookie);
+  g_mutex_unlock (&surface->mutex);
+
+  return TRUE;
+}
+
+/* Source side. Moves the read position past the frames the sink
+ * overwrote or may be overwriting right now and accounts them in
+ * ring->overrun. Returns the number of frames that can be read. */
+static guint
+gst_inter_audio_ring_sync (GstInterAudioRing * ring)
+{
+  guint rpos, wpos, reserve, lost;
+
+  rpos = ring->read_pos;
+  wpos = g_atomic_int_get (&ring->write_pos);
+  reserve = g_atomic_int_get (&ring->write_reserve);
+
+  if (reserve - rpos > ring->size) {
+    lost = reserve - ring->size - rpos;
+    rpos += lost;
+    g_atomic_int_set (&ring->read_pos, rpos);
+    g_atomic_int_add (&ring->overrun, lost);
+  }
+
+  /* write_reserve may already be a full ring ahead of the write_pos we
+   * read before it */
+  if ((gint) (wpos - rpos) < 0)
+    return 0;
+
+  return wpos - rpos;
+}
+
+/* Source side */
+guint
+gst_inter_audio_ring_available (GstInterAudioRing * ring)
+{
+  return gst_inter_audio_ring_sync (ring);
+}
+
+/* Sink side. Never blocks and never fails: if the source does not keep up,
+ * the oldest frames are overwritten and the source finds out when it gets
+ * to them. */
+void
+gst_inter_audio_ring_write (GstInterAudioRing * ring, const guint8 * data,
+    guint frames)
+{
+  guint wpos, offset, first;
+
+  wpos = ring->write_pos;
+
+  /* only the last ring size worth of frames can survive anyway */
+  if (frames > ring->size) {
+    data += (gsize) (frames - ring->size) * ring->bpf;
+    wpos += frames - ring->size;
+    frames = ring->size;
+  }
+
+  /* tells the source that everything older than a ring size before this
+   * can't be trusted anymore */
+  g_atomic_int_set (&ring->write_reserve, wpos + frames);
+
+  offset = wpos & (ring->size - 1);
+  first = MIN (frames, ring->size - offset);
+  memcpy (ring->data + (gsize) offset * ring->bpf, data,
+      (gsize) first * ring->bpf);
+  if (frames > first)
+    memcpy (ring->data, data + (gsize) first * ring->bpf,
+        (gsize) (frames - first) * ring->bpf);
+
+  /* publishes the samples written above to the source */
+  g_atomic_int_set (&ring->write_pos, wpos + frames);
+}
+
+/* Source side */
+guint
+gst_inter_audio_ring_read (GstInterAudioRing * ring, guint8 * data,
+    guint frames)
+{
+  guint rpos, reserve, offset, n, first, torn;
+
+  n = MIN (frames, gst_inter_audio_ring_sync (ring));
+  rpos = ring->read_pos;
+
+  offset = rpos & (ring->size - 1);
+  first = MIN (n, ring->size - offset);
+  memcpy (data, ring->data + (gsize) offset * ring->bpf,
+      (gsize) first * ring->bpf);
+  if (n > first)
+    memcpy (data + (gsize) first * ring->bpf, ring->data,
+        (gsize) (n - first) * ring->bpf);
+
+  /* The sink may have started overwriting the oldest of these frames while
+   * we copied them, drop those */
+  reserve = g_atomic_int_get (&ring->write_reserve);
+  if (reserve - rpos > ring->size) {
+    torn = MIN (n, reserve - ring->size - rpos);
+    memmove (data, data + (gsize) torn * ring->bpf,
+        (gsize) (n - torn) * ring->bpf);
+    g_atomic_int_add (&ring->overrun, torn);
+    rpos += torn;
+    n -= torn;
+  }
+
+  g_atomic_int_set (&ring->read_pos, rpos + n);
+
+  return n;
+}
+
+/* Source side */
+guint
+gst_inter_audio_ring_skip (GstInterAudioRing * ring, guint frames)
+{
+  guint n;
+
+  n = MIN (frames, gst_inter_audio_ring_sync (ring));
+  g_atomic_int_set (&ring->read_pos, ring->read_pos + n);
+
+  return n;
+}
@@ -20,13 +20,51 @@
 #ifndef _GST_INTER_SURFACE_H_
 #define _GST_INTER_SURFACE_H_
 
-#include <gst/base/gstadapter.h>
 #include <gst/audio/audio.h>
 #include <gst/video/video.h>
 
 G_BEGIN_DECLS
 
 typedef struct _GstInterSurface GstInterSurface;
+typedef struct _GstInterVideoSlot GstInterVideoSlot;
+typedef struct _GstInterAudioRing GstInterAudioRing;
+
+#define GST_INTER_SURFACE_VIDEO_SLOTS 4
+
+/* One entry of the video frame ring. @lock is -1 while the sink replaces
+ * the buffer, otherwise the number of sources currently taking a reference
+ * on it. The video info the frame was rendered with is stored along with
+ * it, so that a source never pairs a frame with the caps of another one. */
+struct _GstInterVideoSlot
+{
+  gint lock;
+  GstBuffer *buffer;
+  GstClockTime clock_time;
+  GstVideoInfo video_info;
+  gint video_info_cookie;
+};
+
+/* Single producer, single consumer sample ring. The positions are in
+ * frames and wrap around at G_MAXUINT, write_pos and write_reserve are only
+ * advanced by the sink and read_pos only by the source. The sink never
+ * waits for the source: when the ring is full it overwrites the oldest
+ * frames, write_reserve tells the source which frames may be overwritten
+ * while it copies them. */
+struct _GstInterAudioRing
+{
+  gint ref_count;
+
+  guint8 *data;
+  guint bpf;
+  /* in frames, a power of two */
+  guint size;
+
+  guint write_pos;
+  guint write_reserve;
+  guint read_pos;
+  /* frames that were overwritten before the source read them */
+  guint overrun;
+};
 
 struct _GstInterSurface
 {
@@ -37,17 +75,24 @@ struct _GstInterSurface
 
   /* video */
   GstVideoInfo video_info;
-  int video_buffer_count;
+  /* bumped whenever video_info changes, copied into every slot */
+  gint video_info_cookie;
+  /* number of frames published so far, the latest one lives in
+   * video_slots[video_seq % GST_INTER_SURFACE_VIDEO_SLOTS] */
+  gint video_seq;
+  GstInterVideoSlot video_slots[GST_INTER_SURFACE_VIDEO_SLOTS];
 
   /* audio */
   GstAudioInfo audio_info;
   guint64 audio_buffer_time;
   guint64 audio_latency_time;
   guint64 audio_period_time;
+  /* replaced under the mutex whenever the audio caps or buffer sizes
+   * change, which also bumps audio_cookie */
+  GstInterAudioRing *audio_ring;
+  gint audio_cookie;
 
-  GstBuffer *video_buffer;
   GstBuffer *sub_buffer;
-  GstAdapter *audio_adapter;
 };
 
 #define DEFAULT_AUDIO_BUFFER_TIME  (GST_SECOND)
@@ -58,6 +103,26 @@ struct _GstInterSurface
 GstInterSurface * gst_inter_surface_get (const char *name);
 void gst_inter_surface_unref (GstInterSurface *surface);
 
+void gst_inter_surface_set_video_info (GstInterSurface *surface,
+    const GstVideoInfo *info);
+void gst_inter_surface_push_video (GstInterSurface *surface,
+    GstBuffer *buffer, GstClockTime clock_time);
+GstBuffer * gst_inter_surface_peek_video (GstInterSurface *surface,
+    guint *seq, GstClockTime *clock_time, gint *cookie, GstVideoInfo *info);
+
+void gst_inter_surface_reset_audio_ring (GstInterSurface *surface);
+gboolean gst_inter_surface_update_audio_ring (GstInterSurface *surface,
+    GstInterAudioRing **ring, gint *cookie);
+
+GstInterAudioRing * gst_inter_audio_ring_ref (GstInterAudioRing *ring);
+void gst_inter_audio_ring_unref (GstInterAudioRing *ring);
+guint gst_inter_audio_ring_available (GstInterAudioRing *ring);
+void gst_inter_audio_ring_write (GstInterAudioRing *ring,
+    const guint8 *data, guint frames);
+guint gst_inter_audio_ring_read (GstInterAudioRing *ring, guint8 *data,
+    guint frames);
+guint gst_inter_audio_ring_skip (GstInterAudioRing *ring, guint frames);
+
 
 G_END_DECLS
 
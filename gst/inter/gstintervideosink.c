@@ -198,7 +198,7 @@ gst_inter_video_sink_start (GstBaseSink * sink)
 
   intervideosink->surface = gst_inter_surface_get (intervideosink->channel);
   g_mutex_lock (&intervideosink->surface->mutex);
-  memset (&intervideosink->surface->video_info, 0, sizeof (GstVideoInfo));
+  gst_inter_surface_set_video_info (intervideosink->surface, NULL);
   g_mutex_unlock (&intervideosink->surface->mutex);
 
   return TRUE;
@@ -209,12 +209,10 @@ gst_inter_video_sink_stop (GstBaseSink * sink)
 {
   GstInterVideoSink *intervideosink = GST_INTER_VIDEO_SINK (sink);
 
+  gst_inter_surface_push_video (intervideosink->surface, NULL,
+      GST_CLOCK_TIME_NONE);
   g_mutex_lock (&intervideosink->surface->mutex);
-  if (intervideosink->surface->video_buffer) {
-    gst_buffer_unref (intervideosink->surface->video_buffer);
-  }
-  intervideosink->surface->video_buffer = NULL;
-  memset (&intervideosink->surface->video_info, 0, sizeof (GstVideoInfo));
+  gst_inter_surface_set_video_info (intervideosink->surface, NULL);
   g_mutex_unlock (&intervideosink->surface->mutex);
 
   gst_inter_surface_unref (intervideosink->surface);
@@ -235,7 +233,7 @@ gst_inter_video_sink_set_caps (GstBaseSink * sink, GstCaps * caps)
   }
 
   g_mutex_lock (&intervideosink->surface->mutex);
-  intervideosink->surface->video_info = info;
+  gst_inter_surface_set_video_info (intervideosink->surface, &info);
   intervideosink->info = info;
   g_mutex_unlock (&intervideosink->surface->mutex);
 
@@ -246,17 +244,25 @@ static GstFlowReturn
 gst_inter_video_sink_show_frame (GstVideoSink * sink, GstBuffer * buffer)
 {
   GstInterVideoSink *intervideosink = GST_INTER_VIDEO_SINK (sink);
+  GstBaseSink *basesink = GST_BASE_SINK (sink);
+  GstClockTime clock_time = GST_CLOCK_TIME_NONE;
 
   GST_DEBUG_OBJECT (intervideosink, "render ts %" GST_TIME_FORMAT,
       GST_TIME_ARGS (GST_BUFFER_PTS (buffer)));
 
-  g_mutex_lock (&intervideosink->surface->mutex);
-  if (intervideosink->surface->video_buffer) {
-    gst_buffer_unref (intervideosink->surface->video_buffer);
+  /* Pass the frame's clock time along so that sources can keep the
+   * original timestamps if they share the clock with us */
+  if (GST_BUFFER_PTS_IS_VALID (buffer)) {
+    GstClockTime running_time;
+
+    running_time = gst_segment_to_running_time (&basesink->segment,
+        GST_FORMAT_TIME, GST_BUFFER_PTS (buffer));
+    if (GST_CLOCK_TIME_IS_VALID (running_time))
+      clock_time = running_time +
+          gst_element_get_base_time (GST_ELEMENT (sink));
   }
-  intervideosink->surface->video_buffer = gst_buffer_ref (buffer);
-  intervideosink->surface->video_buffer_count = 0;
-  g_mutex_unlock (&intervideosink->surface->mutex);
+
+  gst_inter_surface_push_video (intervideosink->surface, buffer, clock_time);
 
   return GST_FLOW_OK;
 }
@@ -32,6 +32,19 @@
  * The intersubsrc element cannot be used effectively with gst-launch-1.0,
  * as it requires a second pipeline in the application to send subtitles.
  *
+ * Any number of intervideosrc elements can read from the same channel.
+ * Frames are picked up without taking any lock shared with the other
+ * sources or the sink, and the output buffers share their memory with the
+ * buffer the intervideosink rendered, so no video data is copied. The
+ * #GstInterVideoSrc:stats property reports how many frames this particular
+ * source dropped or repeated.
+ *
+ * By default the frames are timestamped by intervideosrc itself. With
+ * #GstInterVideoSrc:preserve-timestamps the timestamps of the intervideosink
+ * pipeline are kept instead. This only makes sense if both pipelines use
+ * the same clock, and downstream has to allow for the latency between the
+ * two pipelines.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -71,11 +84,14 @@ enum
 {
   PROP_0,
   PROP_CHANNEL,
-  PROP_TIMEOUT
+  PROP_TIMEOUT,
+  PROP_PRESERVE_TIMESTAMPS,
+  PROP_STATS
 };
 
 #define DEFAULT_CHANNEL ("default")
 #define DEFAULT_TIMEOUT (GST_SECOND)
+#define DEFAULT_PRESERVE_TIMESTAMPS FALSE
 
 /* pad templates */
 static GstStaticPadTemplate gst_inter_video_src_src_template =
@@ -130,6 +146,18 @@ gst_inter_video_src_class_init (GstInterVideoSrcClass * klass)
           "Timeout after which to start outputting black frames",
           0, G_MAXUINT64, DEFAULT_TIMEOUT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PRESERVE_TIMESTAMPS,
+      g_param_spec_boolean ("preserve-timestamps", "Preserve timestamps",
+          "Keep the timestamps of the intervideosink pipeline instead of "
+          "generating new ones (both pipelines need to use the same clock)",
+          DEFAULT_PRESERVE_TIMESTAMPS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Frame statistics of this source", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -140,6 +168,23 @@ gst_inter_video_src_init (GstInterVideoSrc * intervideosrc)
 
   intervideosrc->channel = g_strdup (DEFAULT_CHANNEL);
   intervideosrc->timeout = DEFAULT_TIMEOUT;
+  intervideosrc->preserve_timestamps = DEFAULT_PRESERVE_TIMESTAMPS;
+}
+
+static GstStructure *
+gst_inter_video_src_get_stats (GstInterVideoSrc * intervideosrc)
+{
+  GstStructure *s;
+
+  GST_OBJECT_LOCK (intervideosrc);
+  s = gst_structure_new ("application/x-inter-video-src-stats",
+      "frames-pushed", G_TYPE_UINT64, intervideosrc->frames_pushed,
+      "frames-repeated", G_TYPE_UINT64, intervideosrc->frames_repeated,
+      "frames-dropped", G_TYPE_UINT64, intervideosrc->frames_dropped,
+      "frames-black", G_TYPE_UINT64, intervideosrc->frames_black, NULL);
+  GST_OBJECT_UNLOCK (intervideosrc);
+
+  return s;
 }
 
 void
@@ -156,6 +201,9 @@ gst_inter_video_src_set_property (GObject * object, guint property_id,
     case PROP_TIMEOUT:
       intervideosrc->timeout = g_value_get_uint64 (value);
       break;
+    case PROP_PRESERVE_TIMESTAMPS:
+      intervideosrc->preserve_timestamps = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -175,6 +223,12 @@ gst_inter_video_src_get_property (GObject * object, guint property_id,
     case PROP_TIMEOUT:
       g_value_set_uint64 (value, intervideosrc->timeout);
       break;
+    case PROP_PRESERVE_TIMESTAMPS:
+      g_value_set_boolean (value, intervideosrc->preserve_timestamps);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_inter_video_src_get_stats (intervideosrc));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -263,6 +317,9 @@ gst_inter_video_src_set_caps (GstBaseSrc * base, GstCaps * caps)
   gst_buffer_unref (src);
   intervideosrc->black_frame = dest;
 
+  /* compare against the surface caps again in the next create() */
+  intervideosrc->have_video_info_cookie = FALSE;
+
   return TRUE;
 }
 
@@ -276,6 +333,19 @@ gst_inter_video_src_start (GstBaseSrc * src)
   intervideosrc->surface = gst_inter_surface_get (intervideosrc->channel);
   intervideosrc->timestamp_offset = 0;
   intervideosrc->n_frames = 0;
+  /* make sure the first create() looks at the surface caps */
+  intervideosrc->have_video_info_cookie = FALSE;
+  intervideosrc->have_seq = FALSE;
+  intervideosrc->repeat_count = 0;
+  intervideosrc->pts_shift = 0;
+  intervideosrc->last_pts = GST_CLOCK_TIME_NONE;
+
+  GST_OBJECT_LOCK (intervideosrc);
+  intervideosrc->frames_pushed = 0;
+  intervideosrc->frames_repeated = 0;
+  intervideosrc->frames_dropped = 0;
+  intervideosrc->frames_black = 0;
+  GST_OBJECT_UNLOCK (intervideosrc);
 
   return TRUE;
 }
@@ -324,10 +394,18 @@ gst_inter_video_src_create (GstBaseSrc * src, guint64 offset, guint size,
     GstBuffer ** buf)
 {
   GstInterVideoSrc *intervideosrc = GST_INTER_VIDEO_SRC (src);
+  GstInterSurface *surface = intervideosrc->surface;
   GstCaps *caps;
   GstBuffer *buffer;
   guint64 frames;
   gboolean is_gap = FALSE;
+  gboolean new_frame = FALSE;
+  guint64 dropped = 0;
+  GstClockTime clock_time = GST_CLOCK_TIME_NONE;
+  GstClockTime pts;
+  GstVideoInfo video_info;
+  guint seq;
+  gint cookie;
 
   GST_DEBUG_OBJECT (intervideosrc, "create");
 
@@ -338,48 +416,56 @@ gst_inter_video_src_create (GstBaseSrc * src, guint64 offset, guint size,
       GST_VIDEO_INFO_FPS_N (&intervideosrc->info),
       GST_VIDEO_INFO_FPS_D (&intervideosrc->info) * GST_SECOND);
 
-  g_mutex_lock (&intervideosrc->surface->mutex);
-  if (intervideosrc->surface->video_info.finfo) {
-    GstVideoInfo tmp_info = intervideosrc->surface->video_info;
-
-    /* We negotiate the framerate ourselves */
-    tmp_info.fps_n = intervideosrc->info.fps_n;
-    tmp_info.fps_d = intervideosrc->info.fps_d;
-    if (intervideosrc->info.flags & GST_VIDEO_FLAG_VARIABLE_FPS)
-      tmp_info.flags |= GST_VIDEO_FLAG_VARIABLE_FPS;
-    else
-      tmp_info.flags &= ~GST_VIDEO_FLAG_VARIABLE_FPS;
-
-    if (!gst_video_info_is_equal (&tmp_info, &intervideosrc->info)) {
-      caps = gst_video_info_to_caps (&tmp_info);
-      intervideosrc->timestamp_offset +=
-          gst_util_uint64_scale (GST_SECOND * intervideosrc->n_frames,
-          GST_VIDEO_INFO_FPS_D (&intervideosrc->info),
-          GST_VIDEO_INFO_FPS_N (&intervideosrc->info));
-      intervideosrc->n_frames = 0;
+  /* The caps are taken from the slot the frame was read from, a format
+   * change right after this can't make us push the frame with other caps */
+  buffer = gst_inter_surface_peek_video (surface, &seq, &clock_time, &cookie,
+      &video_info);
+
+  if (!intervideosrc->have_video_info_cookie ||
+      cookie != intervideosrc->video_info_cookie) {
+    if (video_info.finfo) {
+      /* We negotiate the framerate ourselves */
+      video_info.fps_n = intervideosrc->info.fps_n;
+      video_info.fps_d = intervideosrc->info.fps_d;
+      if (intervideosrc->info.flags & GST_VIDEO_FLAG_VARIABLE_FPS)
+        video_info.flags |= GST_VIDEO_FLAG_VARIABLE_FPS;
+      else
+        video_info.flags &= ~GST_VIDEO_FLAG_VARIABLE_FPS;
+
+      if (!gst_video_info_is_equal (&video_info, &intervideosrc->info)) {
+        caps = gst_video_info_to_caps (&video_info);
+        intervideosrc->timestamp_offset +=
+            gst_util_uint64_scale (GST_SECOND * intervideosrc->n_frames,
+            GST_VIDEO_INFO_FPS_D (&intervideosrc->info),
+            GST_VIDEO_INFO_FPS_N (&intervideosrc->info));
+        intervideosrc->n_frames = 0;
+      }
     }
   }
 
-  if (intervideosrc->surface->video_buffer) {
-    /* We have a buffer to push */
-    buffer = gst_buffer_ref (intervideosrc->surface->video_buffer);
+  if (intervideosrc->have_seq && seq == intervideosrc->last_seq) {
+    intervideosrc->repeat_count++;
+  } else {
+    if (intervideosrc->have_seq)
+      dropped = (guint) (seq - intervideosrc->last_seq) - 1;
+    intervideosrc->last_seq = seq;
+    intervideosrc->have_seq = TRUE;
+    intervideosrc->repeat_count = 0;
+    new_frame = TRUE;
+  }
 
-    /* Can only be true if timeout > 0 */
-    if (intervideosrc->surface->video_buffer_count == frames) {
-      gst_buffer_unref (intervideosrc->surface->video_buffer);
-      intervideosrc->surface->video_buffer = NULL;
-    }
+  /* Switch to black frames once the timeout expired */
+  if (buffer && intervideosrc->repeat_count > frames) {
+    gst_buffer_unref (buffer);
+    buffer = NULL;
   }
 
-  if (intervideosrc->surface->video_buffer_count != 0 &&
-      intervideosrc->surface->video_buffer_count != (frames + 1)) {
+  if (intervideosrc->repeat_count != 0 &&
+      intervideosrc->repeat_count != (frames + 1)) {
     /* This is a repeat of the stored buffer or of a black frame */
     is_gap = TRUE;
   }
 
-  intervideosrc->surface->video_buffer_count++;
-  g_mutex_unlock (&intervideosrc->surface->mutex);
-
   if (caps) {
     gboolean ret;
     GstStructure *s;
@@ -440,28 +526,63 @@ gst_inter_video_src_create (GstBaseSrc * src, guint64 offset, guint size,
     }
     gst_caps_unref (negotiated_caps);
   }
+  intervideosrc->video_info_cookie = cookie;
+  intervideosrc->have_video_info_cookie = TRUE;
+
+  GST_OBJECT_LOCK (intervideosrc);
+  intervideosrc->frames_pushed++;
+  intervideosrc->frames_dropped += dropped;
+  if (!new_frame)
+    intervideosrc->frames_repeated++;
+  if (buffer == NULL)
+    intervideosrc->frames_black++;
+  GST_OBJECT_UNLOCK (intervideosrc);
 
   if (buffer == NULL) {
     GST_DEBUG_OBJECT (intervideosrc, "Creating black frame");
     buffer = gst_buffer_copy (intervideosrc->black_frame);
   }
 
+  /* The surface still holds a reference, this only copies the metadata and
+   * keeps sharing the video memory */
   buffer = gst_buffer_make_writable (buffer);
 
   if (is_gap)
     GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
 
-  GST_BUFFER_PTS (buffer) = intervideosrc->timestamp_offset +
+  pts = intervideosrc->timestamp_offset +
       gst_util_uint64_scale (GST_SECOND * intervideosrc->n_frames,
       GST_VIDEO_INFO_FPS_D (&intervideosrc->info),
       GST_VIDEO_INFO_FPS_N (&intervideosrc->info));
-  GST_BUFFER_DTS (buffer) = GST_CLOCK_TIME_NONE;
-  GST_DEBUG_OBJECT (intervideosrc, "create ts %" GST_TIME_FORMAT,
-      GST_TIME_ARGS (GST_BUFFER_PTS (buffer)));
   GST_BUFFER_DURATION (buffer) = intervideosrc->timestamp_offset +
       gst_util_uint64_scale (GST_SECOND * (intervideosrc->n_frames + 1),
       GST_VIDEO_INFO_FPS_D (&intervideosrc->info),
-      GST_VIDEO_INFO_FPS_N (&intervideosrc->info)) - GST_BUFFER_PTS (buffer);
+      GST_VIDEO_INFO_FPS_N (&intervideosrc->info)) - pts;
+
+  if (intervideosrc->preserve_timestamps) {
+    /* Map the sink's clock time to our running time, repeated frames keep
+     * the same distance to our own frame grid */
+    if (new_frame && GST_CLOCK_TIME_IS_VALID (clock_time)) {
+      GstClockTime base_time = gst_element_get_base_time (GST_ELEMENT (src));
+
+      if (clock_time >= base_time)
+        intervideosrc->pts_shift =
+            GST_CLOCK_DIFF (pts, clock_time - base_time);
+    }
+    if (intervideosrc->pts_shift < 0 && -intervideosrc->pts_shift > pts)
+      pts = 0;
+    else
+      pts += intervideosrc->pts_shift;
+    if (GST_CLOCK_TIME_IS_VALID (intervideosrc->last_pts) &&
+        pts < intervideosrc->last_pts)
+      pts = intervideosrc->last_pts;
+  }
+  intervideosrc->last_pts = pts;
+
+  GST_BUFFER_PTS (buffer) = pts;
+  GST_BUFFER_DTS (buffer) = GST_CLOCK_TIME_NONE;
+  GST_DEBUG_OBJECT (intervideosrc, "create ts %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (GST_BUFFER_PTS (buffer)));
   GST_BUFFER_OFFSET (buffer) = intervideosrc->n_frames;
   GST_BUFFER_OFFSET_END (buffer) = -1;
   GST_BUFFER_FLAG_UNSET (buffer, GST_BUFFER_FLAG_DISCONT);
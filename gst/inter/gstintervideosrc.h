@@ -43,11 +43,27 @@ struct _GstInterVideoSrc
 
   char *channel;
   guint64 timeout;
+  gboolean preserve_timestamps;
 
   GstVideoInfo info;
   GstBuffer *black_frame;
   int n_frames;
   GstClockTime timestamp_offset;
+
+  /* surface state as last seen by this source */
+  gint video_info_cookie;
+  gboolean have_video_info_cookie;
+  gboolean have_seq;
+  guint last_seq;
+  guint64 repeat_count;
+  GstClockTimeDiff pts_shift;
+  GstClockTime last_pts;
+
+  /* statistics, protected by the object lock */
+  guint64 frames_pushed;
+  guint64 frames_repeated;
+  guint64 frames_dropped;
+  guint64 frames_black;
 };
 
 struct _GstInterVideoSrcClass
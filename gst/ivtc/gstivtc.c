@@ -47,6 +47,7 @@
 #include <gst/base/gstbasetransform.h>
 #include <gst/video/video.h>
 #include "gstivtc.h"
+#include "gstivtcorc.h"
 #include <string.h>
 #include <math.h>
 
@@ -73,7 +74,8 @@ static void gst_ivtc_flush (GstIvtc * ivtc);
 static void gst_ivtc_retire_fields (GstIvtc * ivtc, int n_fields);
 static void gst_ivtc_construct_frame (GstIvtc * itvc, GstBuffer * outbuf);
 
-static int get_comb_score (GstVideoFrame * top, GstVideoFrame * bottom);
+static int get_comb_score (GstVideoFrame * top, GstVideoFrame * bottom,
+    int limit);
 
 enum
 {
@@ -306,8 +308,9 @@ add_field (GstIvtc * ivtc, GstBuffer * buffer, int parity, int index)
   ivtc->n_fields++;
 }
 
+/* scoring stops once the score reaches @limit */
 static int
-similarity (GstIvtc * ivtc, int i1, int i2)
+similarity (GstIvtc * ivtc, int i1, int i2, int limit)
 {
   GstIvtcField *f1, *f2;
   int score;
@@ -319,9 +322,9 @@ similarity (GstIvtc * ivtc, int i1, int i2)
   f2 = &ivtc->fields[i2];
 
   if (f1->parity == TOP_FIELD) {
-    score = get_comb_score (&f1->frame, &f2->frame);
+    score = get_comb_score (&f1->frame, &f2->frame, limit);
   } else {
-    score = get_comb_score (&f2->frame, &f1->frame);
+    score = get_comb_score (&f2->frame, &f1->frame, limit);
   }
 
   GST_DEBUG ("score %d", score);
@@ -366,23 +369,57 @@ reconstruct (GstIvtc * ivtc, GstVideoFrame * dest_frame, int i1, int i2)
 
 }
 
-static int
-reconstruct_line (guint8 * line1, guint8 * line2, int i, int a, int b, int c,
-    int d)
+typedef struct
 {
-  int x;
-
-  x = line1[i - 3] * a;
-  x += line1[i - 2] * b;
-  x += line1[i - 1] * c;
-  x += line1[i - 0] * d;
-  x += line2[i + 0] * d;
-  x += line2[i + 1] * c;
-  x += line2[i + 2] * b;
-  x += line2[i + 3] * a;
-  return (x + 16) >> 5;
-}
+  guint16 sum[MAX_WIDTH];
+  guint16 sum2[MAX_WIDTH];
+  guint16 direction[MAX_WIDTH];
+  guint16 weight2[MAX_WIDTH];
+  guint16 weight3[MAX_WIDTH];
+} EdgeScratch;
+
+#define MARGIN 3
+
+/* Interpolates a missing line from the lines above and below it along the
+ * edge direction found from the gradients around each sample.  The output
+ * is an 8-tap filter with weights (a, b, c, d, d, c, b, a) / 32 applied to
+ * line1[i - 3 .. i] and line2[i .. i + 3], or mirrored, where steeper edges
+ * use taps closer to the centre:
+ *
+ *   |dx| > 2|dy|  (0, 0, 0, 16)
+ *   |dx| > |dy|   (0, 0, 8, 8)
+ *   2|dx| > |dy|  (0, 4, 8, 4)
+ *   3|dx| > |dy|  (1, 7, 7, 1)
+ *   otherwise     (4, 8, 4, 0)
+ *
+ * The weights and the direction are worked out for the whole line first,
+ * then the taps are added up pairwise so each pass fits in the number of
+ * arrays an orc function can take. */
+static void
+reconstruct_line_edge (guint8 * dest, guint8 * line1, guint8 * line2,
+    int width, EdgeScratch * scratch)
+{
+  int n = width - 2 * MARGIN;
+
+  if (n > 0) {
+    ivtc_orc_edge_direction (scratch->sum, scratch->direction,
+        scratch->weight2, scratch->weight3, line1 + MARGIN - 1, line1 + MARGIN,
+        line1 + MARGIN + 1, line2 + MARGIN - 1, line2 + MARGIN,
+        line2 + MARGIN + 1, n);
+    ivtc_orc_edge_tap (scratch->sum2, scratch->sum, scratch->direction,
+        scratch->weight2, line1 + MARGIN - 2, line2 + MARGIN + 2,
+        line2 + MARGIN - 2, line1 + MARGIN + 2, n);
+    ivtc_orc_edge_tap_final (dest + MARGIN, scratch->sum2,
+        scratch->direction, scratch->weight3, line1, line2 + 2 * MARGIN,
+        line2, line1 + 2 * MARGIN, n);
+  }
 
+  ivtc_orc_average_line (dest, line1, line2, MIN (width, MARGIN));
+  if (width > MARGIN) {
+    ivtc_orc_average_line (dest + width - MARGIN, line1 + width - MARGIN,
+        line2 + width - MARGIN, MARGIN);
+  }
+}
 
 static void
 reconstruct_single (GstIvtc * ivtc, GstVideoFrame * dest_frame, int i1)
@@ -392,6 +429,7 @@ reconstruct_single (GstIvtc * ivtc, GstVideoFrame * dest_frame, int i1)
   int height;
   int width;
   GstIvtcField *field = &ivtc->fields[i1];
+  EdgeScratch scratch;
 
   for (k = 0; k < 1; k++) {
     height = GST_VIDEO_FRAME_COMP_HEIGHT (dest_frame, k);
@@ -405,60 +443,9 @@ reconstruct_single (GstIvtc * ivtc, GstVideoFrame * dest_frame, int i1)
           memcpy (GET_LINE (dest_frame, k, j),
               GET_LINE (&field->frame, k, (j ^ 1)), width);
         } else {
-          guint8 *dest = GET_LINE (dest_frame, k, j);
-          guint8 *line1 = GET_LINE (&field->frame, k, j - 1);
-          guint8 *line2 = GET_LINE (&field->frame, k, j + 1);
-          int i;
-
-#define MARGIN 3
-          for (i = MARGIN; i < width - MARGIN; i++) {
-            int dx, dy;
-
-            dx = -line1[i - 1] - line2[i - 1] + line1[i + 1] + line2[i + 1];
-            dx *= 2;
-
-            dy = -line1[i - 1] - 2 * line1[i] - line1[i + 1]
-                + line2[i - 1] + 2 * line2[i] + line2[i + 1];
-            if (dy < 0) {
-              dy = -dy;
-              dx = -dx;
-            }
-
-            if (dx == 0 && dy == 0) {
-              dest[i] = (line1[i] + line2[i] + 1) >> 1;
-            } else if (dx < 0) {
-              if (dx < -2 * dy) {
-                dest[i] = reconstruct_line (line1, line2, i, 0, 0, 0, 16);
-              } else if (dx < -dy) {
-                dest[i] = reconstruct_line (line1, line2, i, 0, 0, 8, 8);
-              } else if (2 * dx < -dy) {
-                dest[i] = reconstruct_line (line1, line2, i, 0, 4, 8, 4);
-              } else if (3 * dx < -dy) {
-                dest[i] = reconstruct_line (line1, line2, i, 1, 7, 7, 1);
-              } else {
-                dest[i] = reconstruct_line (line1, line2, i, 4, 8, 4, 0);
-              }
-            } else {
-              if (dx > 2 * dy) {
-                dest[i] = reconstruct_line (line2, line1, i, 0, 0, 0, 16);
-              } else if (dx > dy) {
-                dest[i] = reconstruct_line (line2, line1, i, 0, 0, 8, 8);
-              } else if (2 * dx > dy) {
-                dest[i] = reconstruct_line (line2, line1, i, 0, 4, 8, 4);
-              } else if (3 * dx > dy) {
-                dest[i] = reconstruct_line (line2, line1, i, 1, 7, 7, 1);
-              } else {
-                dest[i] = reconstruct_line (line2, line1, i, 4, 8, 4, 0);
-              }
-            }
-          }
-
-          for (i = 0; i < MARGIN; i++) {
-            dest[i] = (line1[i] + line2[i] + 1) >> 1;
-          }
-          for (i = width - MARGIN; i < width; i++) {
-            dest[i] = (line1[i] + line2[i] + 1) >> 1;
-          }
+          reconstruct_line_edge (GET_LINE (dest_frame, k, j),
+              GET_LINE (&field->frame, k, j - 1),
+              GET_LINE (&field->frame, k, j + 1), width, &scratch);
         }
       }
     }
@@ -475,13 +462,9 @@ reconstruct_single (GstIvtc * ivtc, GstVideoFrame * dest_frame, int i1)
           memcpy (GET_LINE (dest_frame, k, j),
               GET_LINE (&field->frame, k, (j ^ 1)), width);
         } else {
-          guint8 *dest = GET_LINE (dest_frame, k, j);
-          guint8 *line1 = GET_LINE (&field->frame, k, j - 1);
-          guint8 *line2 = GET_LINE (&field->frame, k, j + 1);
-          int i;
-          for (i = 0; i < width; i++) {
-            dest[i] = (line1[i] + line2[i] + 1) >> 1;
-          }
+          ivtc_orc_average_line (GET_LINE (dest_frame, k, j),
+              GET_LINE (&field->frame, k, j - 1),
+              GET_LINE (&field->frame, k, j + 1), width);
         }
       }
     }
@@ -576,13 +559,22 @@ gst_ivtc_construct_frame (GstIvtc * ivtc, GstBuffer * outbuf)
     forward_ok = FALSE;
   }
 
-  prev_score = similarity (ivtc, anchor_index - 1, anchor_index);
-  next_score = similarity (ivtc, anchor_index, anchor_index + 1);
+#define THRESHOLD 100
+  /* no decision below depends on scores beyond THRESHOLD * 2, and the next
+   * pair is not looked at when the previous one matches and we can't move
+   * forward */
+  prev_score = similarity (ivtc, anchor_index - 1, anchor_index,
+      THRESHOLD * 2);
+  if (prev_score < THRESHOLD && !forward_ok) {
+    next_score = -1;
+  } else {
+    next_score = similarity (ivtc, anchor_index, anchor_index + 1,
+        THRESHOLD * 2);
+  }
 
   gst_video_frame_map (&dest_frame, &ivtc->src_video_info, outbuf,
       GST_MAP_WRITE);
 
-#define THRESHOLD 100
   if (prev_score < THRESHOLD) {
     if (forward_ok && next_score < prev_score) {
       reconstruct (ivtc, &dest_frame, anchor_index, anchor_index + 1);
@@ -629,11 +621,34 @@ gst_ivtc_construct_frame (GstIvtc * ivtc, GstBuffer * outbuf)
 
 }
 
+/* thisline[i] is the number of connected combed samples to the left of and
+ * above sample i, saturating at 1000 */
 static int
-get_comb_score (GstVideoFrame * top, GstVideoFrame * bottom)
+get_comb_score_line (guint16 * thisline, const guint8 * mask, int width)
+{
+  int i;
+  int run = 0;
+  int score = 0;
+
+  for (i = 0; i < width; i++) {
+    if (mask[i]) {
+      run = MIN (thisline[i] + run + 1, 1000);
+      score += (run > 100);
+    } else {
+      run = 0;
+    }
+    thisline[i] = run;
+  }
+
+  return score;
+}
+
+static int
+get_comb_score (GstVideoFrame * top, GstVideoFrame * bottom, int limit)
 {
   int j;
-  int thisline[MAX_WIDTH];
+  guint16 thisline[MAX_WIDTH];
+  guint8 mask[MAX_WIDTH];
   int score = 0;
   int height;
   int width;
@@ -647,28 +662,13 @@ get_comb_score (GstVideoFrame * top, GstVideoFrame * bottom)
   k = 0;
   /* remove a few lines from top and bottom, as they sometimes contain
    * artifacts */
-  for (j = 2; j < height - 2; j++) {
+  for (j = 2; j < height - 2 && score < limit; j++) {
     guint8 *src1 = GET_LINE_IL (top, bottom, 0, j - 1);
     guint8 *src2 = GET_LINE_IL (top, bottom, 0, j);
     guint8 *src3 = GET_LINE_IL (top, bottom, 0, j + 1);
-    int i;
 
-    for (i = 0; i < width; i++) {
-      if (src2[i] < MIN (src1[i], src3[i]) - 5 ||
-          src2[i] > MAX (src1[i], src3[i]) + 5) {
-        if (i > 0) {
-          thisline[i] += thisline[i - 1];
-        }
-        thisline[i]++;
-        if (thisline[i] > 1000)
-          thisline[i] = 1000;
-      } else {
-        thisline[i] = 0;
-      }
-      if (thisline[i] > 100) {
-        score++;
-      }
-    }
+    ivtc_orc_comb_mask (mask, src1, src2, src3, width);
+    score += get_comb_score_line (thisline, mask, width);
   }
 
   GST_DEBUG ("score %d", score);
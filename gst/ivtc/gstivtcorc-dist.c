@@ -0,0 +1,2005 @@
+
+/* autogenerated from gstivtcorc.orc */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <glib.h>
+
+#ifndef _ORC_INTEGER_TYPEDEFS_
+#define _ORC_INTEGER_TYPEDEFS_
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#include <stdint.h>
+typedef int8_t orc_int8;
+typedef int16_t orc_int16;
+typedef int32_t orc_int32;
+typedef int64_t orc_int64;
+typedef uint8_t orc_uint8;
+typedef uint16_t orc_uint16;
+typedef uint32_t orc_uint32;
+typedef uint64_t orc_uint64;
+#define ORC_UINT64_C(x) UINT64_C(x)
+#elif defined(_MSC_VER)
+typedef signed __int8 orc_int8;
+typedef signed __int16 orc_int16;
+typedef signed __int32 orc_int32;
+typedef signed __int64 orc_int64;
+typedef unsigned __int8 orc_uint8;
+typedef unsigned __int16 orc_uint16;
+typedef unsigned __int32 orc_uint32;
+typedef unsigned __int64 orc_uint64;
+#define ORC_UINT64_C(x) (x##Ui64)
+#define inline __inline
+#else
+#include <limits.h>
+typedef signed char orc_int8;
+typedef short orc_int16;
+typedef int orc_int32;
+typedef unsigned char orc_uint8;
+typedef unsigned short orc_uint16;
+typedef unsigned int orc_uint32;
+#if INT_MAX == LONG_MAX
+typedef long long orc_int64;
+typedef unsigned long long orc_uint64;
+#define ORC_UINT64_C(x) (x##ULL)
+#else
+typedef long orc_int64;
+typedef unsigned long orc_uint64;
+#define ORC_UINT64_C(x) (x##UL)
+#endif
+#endif
+typedef union
+{
+  orc_int16 i;
+  orc_int8 x2[2];
+} orc_union16;
+typedef union
+{
+  orc_int32 i;
+  float f;
+  orc_int16 x2[2];
+  orc_int8 x4[4];
+} orc_union32;
+typedef union
+{
+  orc_int64 i;
+  double f;
+  orc_int32 x2[2];
+  float x2f[2];
+  orc_int16 x4[4];
+} orc_union64;
+#endif
+#ifndef ORC_RESTRICT
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define ORC_RESTRICT restrict
+#elif defined(__GNUC__) && __GNUC__ >= 4
+#define ORC_RESTRICT __restrict__
+#else
+#define ORC_RESTRICT
+#endif
+#endif
+
+#ifndef ORC_INTERNAL
+#if defined(__SUNPRO_C) && (__SUNPRO_C >= 0x590)
+#define ORC_INTERNAL __attribute__((visibility("hidden")))
+#elif defined(__SUNPRO_C) && (__SUNPRO_C >= 0x550)
+#define ORC_INTERNAL __hidden
+#elif defined (__GNUC__)
+#define ORC_INTERNAL __attribute__((visibility("hidden")))
+#else
+#define ORC_INTERNAL
+#endif
+#endif
+
+
+#ifndef DISABLE_ORC
+#include <orc/orc.h>
+#endif
+void ivtc_orc_comb_mask (orc_uint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int n);
+void ivtc_orc_edge_direction (orc_uint16 * ORC_RESTRICT d1,
+    orc_uint16 * ORC_RESTRICT d2, orc_uint16 * ORC_RESTRICT d3,
+    orc_uint16 * ORC_RESTRICT d4, const orc_uint8 * ORC_RESTRICT s1,
+    const orc_uint8 * ORC_RESTRICT s2, const orc_uint8 * ORC_RESTRICT s3,
+    const orc_uint8 * ORC_RESTRICT s4, const orc_uint8 * ORC_RESTRICT s5,
+    const orc_uint8 * ORC_RESTRICT s6, int n);
+void ivtc_orc_edge_tap (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint16 * ORC_RESTRICT s1, const orc_uint16 * ORC_RESTRICT s2,
+    const orc_uint16 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, const orc_uint8 * ORC_RESTRICT s6,
+    const orc_uint8 * ORC_RESTRICT s7, int n);
+void ivtc_orc_edge_tap_final (orc_uint8 * ORC_RESTRICT d1,
+    const orc_uint16 * ORC_RESTRICT s1, const orc_uint16 * ORC_RESTRICT s2,
+    const orc_uint16 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, const orc_uint8 * ORC_RESTRICT s6,
+    const orc_uint8 * ORC_RESTRICT s7, int n);
+void ivtc_orc_average_line (orc_uint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    int n);
+
+
+/* begin Orc C target preamble */
+#define ORC_CLAMP(x,a,b) ((x)<(a) ? (a) : ((x)>(b) ? (b) : (x)))
+#define ORC_ABS(a) ((a)<0 ? -(a) : (a))
+#define ORC_MIN(a,b) ((a)<(b) ? (a) : (b))
+#define ORC_MAX(a,b) ((a)>(b) ? (a) : (b))
+#define ORC_SB_MAX 127
+#define ORC_SB_MIN (-1-ORC_SB_MAX)
+#define ORC_UB_MAX (orc_uint8) 255
+#define ORC_UB_MIN 0
+#define ORC_SW_MAX 32767
+#define ORC_SW_MIN (-1-ORC_SW_MAX)
+#define ORC_UW_MAX (orc_uint16)65535
+#define ORC_UW_MIN 0
+#define ORC_SL_MAX 2147483647
+#define ORC_SL_MIN (-1-ORC_SL_MAX)
+#define ORC_UL_MAX 4294967295U
+#define ORC_UL_MIN 0
+#define ORC_CLAMP_SB(x) ORC_CLAMP(x,ORC_SB_MIN,ORC_SB_MAX)
+#define ORC_CLAMP_UB(x) ORC_CLAMP(x,ORC_UB_MIN,ORC_UB_MAX)
+#define ORC_CLAMP_SW(x) ORC_CLAMP(x,ORC_SW_MIN,ORC_SW_MAX)
+#define ORC_CLAMP_UW(x) ORC_CLAMP(x,ORC_UW_MIN,ORC_UW_MAX)
+#define ORC_CLAMP_SL(x) ORC_CLAMP(x,ORC_SL_MIN,ORC_SL_MAX)
+#define ORC_CLAMP_UL(x) ORC_CLAMP(x,ORC_UL_MIN,ORC_UL_MAX)
+#define ORC_SWAP_W(x) ((((x)&0xffU)<<8) | (((x)&0xff00U)>>8))
+#define ORC_SWAP_L(x) ((((x)&0xffU)<<24) | (((x)&0xff00U)<<8) | (((x)&0xff0000U)>>8) | (((x)&0xff000000U)>>24))
+#define ORC_SWAP_Q(x) ((((x)&ORC_UINT64_C(0xff))<<56) | (((x)&ORC_UINT64_C(0xff00))<<40) | (((x)&ORC_UINT64_C(0xff0000))<<24) | (((x)&ORC_UINT64_C(0xff000000))<<8) | (((x)&ORC_UINT64_C(0xff00000000))>>8) | (((x)&ORC_UINT64_C(0xff0000000000))>>24) | (((x)&ORC_UINT64_C(0xff000000000000))>>40) | (((x)&ORC_UINT64_C(0xff00000000000000))>>56))
+#define ORC_PTR_OFFSET(ptr,offset) ((void *)(((unsigned char *)(ptr)) + (offset)))
+#define ORC_DENORMAL(x) ((x) & ((((x)&0x7f800000) == 0) ? 0xff800000 : 0xffffffff))
+#define ORC_ISNAN(x) ((((x)&0x7f800000) == 0x7f800000) && (((x)&0x007fffff) != 0))
+#define ORC_DENORMAL_DOUBLE(x) ((x) & ((((x)&ORC_UINT64_C(0x7ff0000000000000)) == 0) ? ORC_UINT64_C(0xfff0000000000000) : ORC_UINT64_C(0xffffffffffffffff)))
+#define ORC_ISNAN_DOUBLE(x) ((((x)&ORC_UINT64_C(0x7ff0000000000000)) == ORC_UINT64_C(0x7ff0000000000000)) && (((x)&ORC_UINT64_C(0x000fffffffffffff)) != 0))
+#ifndef ORC_RESTRICT
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define ORC_RESTRICT restrict
+#elif defined(__GNUC__) && __GNUC__ >= 4
+#define ORC_RESTRICT __restrict__
+#else
+#define ORC_RESTRICT
+#endif
+#endif
+/* end Orc C target preamble */
+
+
+/* ivtc_orc_comb_mask */
+#ifdef DISABLE_ORC
+void
+ivtc_orc_comb_mask (orc_uint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var41;
+#else
+  orc_union16 var41;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var42;
+#else
+  orc_union16 var42;
+#endif
+  orc_int8 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+
+  /* 7: loadpw */
+  var41.i = 0x00000005;         /* 5 or 2.47033e-323f */
+  /* 18: loadpw */
+  var42.i = 0x00000001;         /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var38 = ptr4[i];
+    /* 1: convubw */
+    var44.i = (orc_uint8) var38;
+    /* 2: loadb */
+    var39 = ptr5[i];
+    /* 3: convubw */
+    var45.i = (orc_uint8) var39;
+    /* 4: loadb */
+    var40 = ptr6[i];
+    /* 5: convubw */
+    var46.i = (orc_uint8) var40;
+    /* 6: subw */
+    var47.i = var45.i - var44.i;
+    /* 8: cmpgtsw */
+    var48.i = (var47.i > var41.i) ? (~0) : 0;
+    /* 9: subw */
+    var49.i = var45.i - var46.i;
+    /* 10: cmpgtsw */
+    var50.i = (var49.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var51.i = var48.i & var50.i;
+    /* 12: subw */
+    var52.i = var44.i - var45.i;
+    /* 13: cmpgtsw */
+    var53.i = (var52.i > var41.i) ? (~0) : 0;
+    /* 14: subw */
+    var54.i = var46.i - var45.i;
+    /* 15: cmpgtsw */
+    var55.i = (var54.i > var41.i) ? (~0) : 0;
+    /* 16: andw */
+    var56.i = var53.i & var55.i;
+    /* 17: orw */
+    var57.i = var51.i | var56.i;
+    /* 19: andw */
+    var58.i = var57.i & var42.i;
+    /* 20: convwb */
+    var43 = var58.i;
+    /* 21: storew */
+    ptr0[i] = var43;
+  }
+
+}
+
+#else
+static void
+_backup_ivtc_orc_comb_mask (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var41;
+#else
+  orc_union16 var41;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var42;
+#else
+  orc_union16 var42;
+#endif
+  orc_int8 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+
+  /* 7: loadpw */
+  var41.i = 0x00000005;         /* 5 or 2.47033e-323f */
+  /* 18: loadpw */
+  var42.i = 0x00000001;         /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var38 = ptr4[i];
+    /* 1: convubw */
+    var44.i = (orc_uint8) var38;
+    /* 2: loadb */
+    var39 = ptr5[i];
+    /* 3: convubw */
+    var45.i = (orc_uint8) var39;
+    /* 4: loadb */
+    var40 = ptr6[i];
+    /* 5: convubw */
+    var46.i = (orc_uint8) var40;
+    /* 6: subw */
+    var47.i = var45.i - var44.i;
+    /* 8: cmpgtsw */
+    var48.i = (var47.i > var41.i) ? (~0) : 0;
+    /* 9: subw */
+    var49.i = var45.i - var46.i;
+    /* 10: cmpgtsw */
+    var50.i = (var49.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var51.i = var48.i & var50.i;
+    /* 12: subw */
+    var52.i = var44.i - var45.i;
+    /* 13: cmpgtsw */
+    var53.i = (var52.i > var41.i) ? (~0) : 0;
+    /* 14: subw */
+    var54.i = var46.i - var45.i;
+    /* 15: cmpgtsw */
+    var55.i = (var54.i > var41.i) ? (~0) : 0;
+    /* 16: andw */
+    var56.i = var53.i & var55.i;
+    /* 17: orw */
+    var57.i = var51.i | var56.i;
+    /* 19: andw */
+    var58.i = var57.i & var42.i;
+    /* 20: convwb */
+    var43 = var58.i;
+    /* 21: storew */
+    ptr0[i] = var43;
+  }
+
+}
+
+void
+ivtc_orc_comb_mask (orc_uint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 18, 105, 118, 116, 99, 95, 111, 114, 99, 95, 99, 111, 109, 98,
+        95, 109, 97, 115, 107, 11, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1,
+        1, 14, 2, 5, 0, 0, 0, 14, 2, 1, 0, 0, 0, 20, 2, 20,
+        2, 20, 2, 20, 2, 20, 2, 20, 2, 150, 32, 4, 150, 33, 5, 150,
+        34, 6, 98, 35, 33, 32, 78, 35, 35, 16, 98, 36, 33, 34, 78, 36,
+        36, 16, 73, 35, 35, 36, 98, 36, 32, 33, 78, 36, 36, 16, 98, 37,
+        34, 33, 78, 37, 37, 16, 73, 36, 36, 37, 92, 35, 35, 36, 73, 35,
+        35, 17, 157, 0, 35, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_ivtc_orc_comb_mask);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "ivtc_orc_comb_mask");
+      orc_program_set_backup_function (p, _backup_ivtc_orc_comb_mask);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_constant (p, 2, 0x00000005, "c1");
+      orc_program_add_constant (p, 2, 0x00000001, "c2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T4, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T5, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T5, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T6, ORC_VAR_T3, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T4, ORC_VAR_D1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* ivtc_orc_edge_direction */
+#ifdef DISABLE_ORC
+void
+ivtc_orc_edge_direction (orc_uint16 * ORC_RESTRICT d1,
+    orc_uint16 * ORC_RESTRICT d2, orc_uint16 * ORC_RESTRICT d3,
+    orc_uint16 * ORC_RESTRICT d4, const orc_uint8 * ORC_RESTRICT s1,
+    const orc_uint8 * ORC_RESTRICT s2, const orc_uint8 * ORC_RESTRICT s3,
+    const orc_uint8 * ORC_RESTRICT s4, const orc_uint8 * ORC_RESTRICT s5,
+    const orc_uint8 * ORC_RESTRICT s6, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 *ORC_RESTRICT ptr1;
+  orc_union16 *ORC_RESTRICT ptr2;
+  orc_union16 *ORC_RESTRICT ptr3;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  orc_int8 var43;
+  orc_int8 var44;
+  orc_int8 var45;
+  orc_int8 var46;
+  orc_int8 var47;
+  orc_int8 var48;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var49;
+#else
+  orc_union16 var49;
+#endif
+  orc_union16 var50;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var51;
+#else
+  orc_union16 var51;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var52;
+#else
+  orc_union16 var52;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var53;
+#else
+  orc_union16 var53;
+#endif
+  orc_union16 var54;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var55;
+#else
+  orc_union16 var55;
+#endif
+  orc_union16 var56;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var57;
+#else
+  orc_union16 var57;
+#endif
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+  orc_union16 var71;
+  orc_union16 var72;
+  orc_union16 var73;
+  orc_union16 var74;
+  orc_union16 var75;
+  orc_union16 var76;
+  orc_union16 var77;
+  orc_union16 var78;
+  orc_union16 var79;
+  orc_union16 var80;
+  orc_union16 var81;
+  orc_union16 var82;
+  orc_union16 var83;
+  orc_union16 var84;
+  orc_union16 var85;
+  orc_union16 var86;
+  orc_union16 var87;
+  orc_union16 var88;
+  orc_union16 var89;
+  orc_union16 var90;
+  orc_union16 var91;
+  orc_union16 var92;
+  orc_union16 var93;
+  orc_union16 var94;
+  orc_union16 var95;
+  orc_union16 var96;
+  orc_union16 var97;
+  orc_union16 var98;
+  orc_union16 var99;
+  orc_union16 var100;
+  orc_union16 var101;
+  orc_union16 var102;
+  orc_union16 var103;
+  orc_union16 var104;
+  orc_union16 var105;
+  orc_union16 var106;
+  orc_union16 var107;
+  orc_union16 var108;
+  orc_union16 var109;
+  orc_union16 var110;
+  orc_union16 var111;
+  orc_union16 var112;
+  orc_union16 var113;
+  orc_union16 var114;
+  orc_union16 var115;
+  orc_union16 var116;
+  orc_union16 var117;
+  orc_union16 var118;
+  orc_union16 var119;
+  orc_union16 var120;
+  orc_union16 var121;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr1 = (orc_union16 *) d2;
+  ptr2 = (orc_union16 *) d3;
+  ptr3 = (orc_union16 *) d4;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+  ptr9 = (orc_int8 *) s6;
+
+  /* 26: loadpw */
+  var49.i = 0x00000000;         /* 0 or 0f */
+  /* 41: loadpw */
+  var51.i = 0x00000001;         /* 1 or 4.94066e-324f */
+  /* 51: loadpw */
+  var52.i = 0x00000003;         /* 3 or 1.4822e-323f */
+  /* 57: loadpw */
+  var53.i = 0x00000004;         /* 4 or 1.97626e-323f */
+  /* 64: loadpw */
+  var55.i = 0x00000008;         /* 8 or 3.95253e-323f */
+  /* 75: loadpw */
+  var57.i = 0x00000010;         /* 16 or 7.90505e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var43 = ptr4[i];
+    /* 1: convubw */
+    var59.i = (orc_uint8) var43;
+    /* 2: loadb */
+    var44 = ptr6[i];
+    /* 3: convubw */
+    var60.i = (orc_uint8) var44;
+    /* 4: loadb */
+    var45 = ptr7[i];
+    /* 5: convubw */
+    var61.i = (orc_uint8) var45;
+    /* 6: loadb */
+    var46 = ptr9[i];
+    /* 7: convubw */
+    var62.i = (orc_uint8) var46;
+    /* 8: loadb */
+    var47 = ptr5[i];
+    /* 9: convubw */
+    var63.i = (orc_uint8) var47;
+    /* 10: loadb */
+    var48 = ptr8[i];
+    /* 11: convubw */
+    var64.i = (orc_uint8) var48;
+    /* 12: addw */
+    var65.i = var60.i + var62.i;
+    /* 13: addw */
+    var66.i = var59.i + var61.i;
+    /* 14: subw */
+    var67.i = var65.i - var66.i;
+    /* 15: shlw */
+    var68.i = ((orc_uint16) var67.i) << 1;
+    /* 16: shlw */
+    var69.i = ((orc_uint16) var64.i) << 1;
+    /* 17: addw */
+    var70.i = var69.i + var61.i;
+    /* 18: addw */
+    var71.i = var70.i + var62.i;
+    /* 19: shlw */
+    var72.i = ((orc_uint16) var63.i) << 1;
+    /* 20: addw */
+    var73.i = var72.i + var59.i;
+    /* 21: addw */
+    var74.i = var73.i + var60.i;
+    /* 22: subw */
+    var75.i = var71.i - var74.i;
+    /* 23: addw */
+    var76.i = var63.i + var64.i;
+    /* 24: addw */
+    var77.i = var59.i + var62.i;
+    /* 25: addw */
+    var78.i = var60.i + var61.i;
+    /* 27: cmpgtsw */
+    var79.i = (var49.i > var68.i) ? (~0) : 0;
+    /* 28: cmpgtsw */
+    var80.i = (var68.i > var49.i) ? (~0) : 0;
+    /* 29: cmpgtsw */
+    var81.i = (var49.i > var75.i) ? (~0) : 0;
+    /* 30: andnw */
+    var82.i = (~var81.i) & var79.i;
+    /* 31: andw */
+    var83.i = var80.i & var81.i;
+    /* 32: orw */
+    var84.i = var82.i | var83.i;
+    /* 33: copyw */
+    var50.i = var84.i;
+    /* 34: storew */
+    ptr1[i] = var50;
+    /* 35: andw */
+    var85.i = var84.i & var77.i;
+    /* 36: andnw */
+    var86.i = (~var84.i) & var78.i;
+    /* 37: orw */
+    var87.i = var85.i | var86.i;
+    /* 38: absw */
+    var88.i = ORC_ABS (var68.i);
+    /* 39: absw */
+    var89.i = ORC_ABS (var75.i);
+    /* 40: orw */
+    var90.i = var88.i | var89.i;
+    /* 42: cmpgtsw */
+    var91.i = (var51.i > var90.i) ? (~0) : 0;
+    /* 43: shlw */
+    var92.i = ((orc_uint16) var89.i) << 1;
+    /* 44: cmpgtsw */
+    var93.i = (var88.i > var92.i) ? (~0) : 0;
+    /* 45: orw */
+    var94.i = var93.i | var91.i;
+    /* 46: cmpgtsw */
+    var95.i = (var88.i > var89.i) ? (~0) : 0;
+    /* 47: orw */
+    var96.i = var95.i | var91.i;
+    /* 48: shlw */
+    var97.i = ((orc_uint16) var88.i) << 1;
+    /* 49: cmpgtsw */
+    var98.i = (var97.i > var89.i) ? (~0) : 0;
+    /* 50: orw */
+    var99.i = var98.i | var91.i;
+    /* 52: mullw */
+    var100.i = (var88.i * var52.i) & 0xffff;
+    /* 53: cmpgtsw */
+    var101.i = (var100.i > var89.i) ? (~0) : 0;
+    /* 54: orw */
+    var102.i = var101.i | var91.i;
+    /* 55: andw */
+    var103.i = var102.i & var52.i;
+    /* 56: andw */
+    var104.i = var99.i & var51.i;
+    /* 58: subw */
+    var105.i = var53.i - var103.i;
+    /* 59: subw */
+    var106.i = var105.i - var104.i;
+    /* 60: copyw */
+    var54.i = var106.i;
+    /* 61: storew */
+    ptr3[i] = var54;
+    /* 62: addw */
+    var107.i = var103.i + var104.i;
+    /* 63: addw */
+    var108.i = var107.i + var53.i;
+    /* 65: andw */
+    var109.i = var94.i & var55.i;
+    /* 66: subw */
+    var110.i = var108.i - var109.i;
+    /* 67: andw */
+    var111.i = var102.i & var51.i;
+    /* 68: andw */
+    var112.i = var99.i & var52.i;
+    /* 69: andw */
+    var113.i = var96.i & var53.i;
+    /* 70: subw */
+    var114.i = var55.i - var111.i;
+    /* 71: subw */
+    var115.i = var114.i - var112.i;
+    /* 72: subw */
+    var116.i = var115.i - var113.i;
+    /* 73: copyw */
+    var56.i = var116.i;
+    /* 74: storew */
+    ptr2[i] = var56;
+    /* 76: subw */
+    var117.i = var57.i - var110.i;
+    /* 77: subw */
+    var118.i = var117.i - var116.i;
+    /* 78: subw */
+    var119.i = var118.i - var106.i;
+    /* 79: mullw */
+    var120.i = (var119.i * var76.i) & 0xffff;
+    /* 80: mullw */
+    var121.i = (var110.i * var87.i) & 0xffff;
+    /* 81: addw */
+    var58.i = var120.i + var121.i;
+    /* 82: storew */
+    ptr0[i] = var58;
+  }
+
+}
+
+#else
+static void
+_backup_ivtc_orc_edge_direction (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 *ORC_RESTRICT ptr1;
+  orc_union16 *ORC_RESTRICT ptr2;
+  orc_union16 *ORC_RESTRICT ptr3;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  orc_int8 var43;
+  orc_int8 var44;
+  orc_int8 var45;
+  orc_int8 var46;
+  orc_int8 var47;
+  orc_int8 var48;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var49;
+#else
+  orc_union16 var49;
+#endif
+  orc_union16 var50;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var51;
+#else
+  orc_union16 var51;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var52;
+#else
+  orc_union16 var52;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var53;
+#else
+  orc_union16 var53;
+#endif
+  orc_union16 var54;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var55;
+#else
+  orc_union16 var55;
+#endif
+  orc_union16 var56;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var57;
+#else
+  orc_union16 var57;
+#endif
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+  orc_union16 var71;
+  orc_union16 var72;
+  orc_union16 var73;
+  orc_union16 var74;
+  orc_union16 var75;
+  orc_union16 var76;
+  orc_union16 var77;
+  orc_union16 var78;
+  orc_union16 var79;
+  orc_union16 var80;
+  orc_union16 var81;
+  orc_union16 var82;
+  orc_union16 var83;
+  orc_union16 var84;
+  orc_union16 var85;
+  orc_union16 var86;
+  orc_union16 var87;
+  orc_union16 var88;
+  orc_union16 var89;
+  orc_union16 var90;
+  orc_union16 var91;
+  orc_union16 var92;
+  orc_union16 var93;
+  orc_union16 var94;
+  orc_union16 var95;
+  orc_union16 var96;
+  orc_union16 var97;
+  orc_union16 var98;
+  orc_union16 var99;
+  orc_union16 var100;
+  orc_union16 var101;
+  orc_union16 var102;
+  orc_union16 var103;
+  orc_union16 var104;
+  orc_union16 var105;
+  orc_union16 var106;
+  orc_union16 var107;
+  orc_union16 var108;
+  orc_union16 var109;
+  orc_union16 var110;
+  orc_union16 var111;
+  orc_union16 var112;
+  orc_union16 var113;
+  orc_union16 var114;
+  orc_union16 var115;
+  orc_union16 var116;
+  orc_union16 var117;
+  orc_union16 var118;
+  orc_union16 var119;
+  orc_union16 var120;
+  orc_union16 var121;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr1 = (orc_union16 *) ex->arrays[1];
+  ptr2 = (orc_union16 *) ex->arrays[2];
+  ptr3 = (orc_union16 *) ex->arrays[3];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+  ptr9 = (orc_int8 *) ex->arrays[9];
+
+  /* 26: loadpw */
+  var49.i = 0x00000000;         /* 0 or 0f */
+  /* 41: loadpw */
+  var51.i = 0x00000001;         /* 1 or 4.94066e-324f */
+  /* 51: loadpw */
+  var52.i = 0x00000003;         /* 3 or 1.4822e-323f */
+  /* 57: loadpw */
+  var53.i = 0x00000004;         /* 4 or 1.97626e-323f */
+  /* 64: loadpw */
+  var55.i = 0x00000008;         /* 8 or 3.95253e-323f */
+  /* 75: loadpw */
+  var57.i = 0x00000010;         /* 16 or 7.90505e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var43 = ptr4[i];
+    /* 1: convubw */
+    var59.i = (orc_uint8) var43;
+    /* 2: loadb */
+    var44 = ptr6[i];
+    /* 3: convubw */
+    var60.i = (orc_uint8) var44;
+    /* 4: loadb */
+    var45 = ptr7[i];
+    /* 5: convubw */
+    var61.i = (orc_uint8) var45;
+    /* 6: loadb */
+    var46 = ptr9[i];
+    /* 7: convubw */
+    var62.i = (orc_uint8) var46;
+    /* 8: loadb */
+    var47 = ptr5[i];
+    /* 9: convubw */
+    var63.i = (orc_uint8) var47;
+    /* 10: loadb */
+    var48 = ptr8[i];
+    /* 11: convubw */
+    var64.i = (orc_uint8) var48;
+    /* 12: addw */
+    var65.i = var60.i + var62.i;
+    /* 13: addw */
+    var66.i = var59.i + var61.i;
+    /* 14: subw */
+    var67.i = var65.i - var66.i;
+    /* 15: shlw */
+    var68.i = ((orc_uint16) var67.i) << 1;
+    /* 16: shlw */
+    var69.i = ((orc_uint16) var64.i) << 1;
+    /* 17: addw */
+    var70.i = var69.i + var61.i;
+    /* 18: addw */
+    var71.i = var70.i + var62.i;
+    /* 19: shlw */
+    var72.i = ((orc_uint16) var63.i) << 1;
+    /* 20: addw */
+    var73.i = var72.i + var59.i;
+    /* 21: addw */
+    var74.i = var73.i + var60.i;
+    /* 22: subw */
+    var75.i = var71.i - var74.i;
+    /* 23: addw */
+    var76.i = var63.i + var64.i;
+    /* 24: addw */
+    var77.i = var59.i + var62.i;
+    /* 25: addw */
+    var78.i = var60.i + var61.i;
+    /* 27: cmpgtsw */
+    var79.i = (var49.i > var68.i) ? (~0) : 0;
+    /* 28: cmpgtsw */
+    var80.i = (var68.i > var49.i) ? (~0) : 0;
+    /* 29: cmpgtsw */
+    var81.i = (var49.i > var75.i) ? (~0) : 0;
+    /* 30: andnw */
+    var82.i = (~var81.i) & var79.i;
+    /* 31: andw */
+    var83.i = var80.i & var81.i;
+    /* 32: orw */
+    var84.i = var82.i | var83.i;
+    /* 33: copyw */
+    var50.i = var84.i;
+    /* 34: storew */
+    ptr1[i] = var50;
+    /* 35: andw */
+    var85.i = var84.i & var77.i;
+    /* 36: andnw */
+    var86.i = (~var84.i) & var78.i;
+    /* 37: orw */
+    var87.i = var85.i | var86.i;
+    /* 38: absw */
+    var88.i = ORC_ABS (var68.i);
+    /* 39: absw */
+    var89.i = ORC_ABS (var75.i);
+    /* 40: orw */
+    var90.i = var88.i | var89.i;
+    /* 42: cmpgtsw */
+    var91.i = (var51.i > var90.i) ? (~0) : 0;
+    /* 43: shlw */
+    var92.i = ((orc_uint16) var89.i) << 1;
+    /* 44: cmpgtsw */
+    var93.i = (var88.i > var92.i) ? (~0) : 0;
+    /* 45: orw */
+    var94.i = var93.i | var91.i;
+    /* 46: cmpgtsw */
+    var95.i = (var88.i > var89.i) ? (~0) : 0;
+    /* 47: orw */
+    var96.i = var95.i | var91.i;
+    /* 48: shlw */
+    var97.i = ((orc_uint16) var88.i) << 1;
+    /* 49: cmpgtsw */
+    var98.i = (var97.i > var89.i) ? (~0) : 0;
+    /* 50: orw */
+    var99.i = var98.i | var91.i;
+    /* 52: mullw */
+    var100.i = (var88.i * var52.i) & 0xffff;
+    /* 53: cmpgtsw */
+    var101.i = (var100.i > var89.i) ? (~0) : 0;
+    /* 54: orw */
+    var102.i = var101.i | var91.i;
+    /* 55: andw */
+    var103.i = var102.i & var52.i;
+    /* 56: andw */
+    var104.i = var99.i & var51.i;
+    /* 58: subw */
+    var105.i = var53.i - var103.i;
+    /* 59: subw */
+    var106.i = var105.i - var104.i;
+    /* 60: copyw */
+    var54.i = var106.i;
+    /* 61: storew */
+    ptr3[i] = var54;
+    /* 62: addw */
+    var107.i = var103.i + var104.i;
+    /* 63: addw */
+    var108.i = var107.i + var53.i;
+    /* 65: andw */
+    var109.i = var94.i & var55.i;
+    /* 66: subw */
+    var110.i = var108.i - var109.i;
+    /* 67: andw */
+    var111.i = var102.i & var51.i;
+    /* 68: andw */
+    var112.i = var99.i & var52.i;
+    /* 69: andw */
+    var113.i = var96.i & var53.i;
+    /* 70: subw */
+    var114.i = var55.i - var111.i;
+    /* 71: subw */
+    var115.i = var114.i - var112.i;
+    /* 72: subw */
+    var116.i = var115.i - var113.i;
+    /* 73: copyw */
+    var56.i = var116.i;
+    /* 74: storew */
+    ptr2[i] = var56;
+    /* 76: subw */
+    var117.i = var57.i - var110.i;
+    /* 77: subw */
+    var118.i = var117.i - var116.i;
+    /* 78: subw */
+    var119.i = var118.i - var106.i;
+    /* 79: mullw */
+    var120.i = (var119.i * var76.i) & 0xffff;
+    /* 80: mullw */
+    var121.i = (var110.i * var87.i) & 0xffff;
+    /* 81: addw */
+    var58.i = var120.i + var121.i;
+    /* 82: storew */
+    ptr0[i] = var58;
+  }
+
+}
+
+void
+ivtc_orc_edge_direction (orc_uint16 * ORC_RESTRICT d1,
+    orc_uint16 * ORC_RESTRICT d2, orc_uint16 * ORC_RESTRICT d3,
+    orc_uint16 * ORC_RESTRICT d4, const orc_uint8 * ORC_RESTRICT s1,
+    const orc_uint8 * ORC_RESTRICT s2, const orc_uint8 * ORC_RESTRICT s3,
+    const orc_uint8 * ORC_RESTRICT s4, const orc_uint8 * ORC_RESTRICT s5,
+    const orc_uint8 * ORC_RESTRICT s6, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 23, 105, 118, 116, 99, 95, 111, 114, 99, 95, 101, 100, 103, 101,
+        95, 100, 105, 114, 101, 99, 116, 105, 111, 110, 11, 2, 2, 11, 2, 2,
+        11, 2, 2, 11, 2, 2, 12, 1, 1, 12, 1, 1, 12, 1, 1, 12,
+        1, 1, 12, 1, 1, 12, 1, 1, 14, 2, 1, 0, 0, 0, 14, 2,
+        0, 0, 0, 0, 14, 2, 3, 0, 0, 0, 14, 2, 4, 0, 0, 0,
+        14, 2, 8, 0, 0, 0, 14, 2, 16, 0, 0, 0, 20, 2, 20, 2,
+        20, 2, 20, 2, 20, 2, 20, 2, 20, 2, 20, 2, 20, 2, 20, 2,
+        20, 2, 150, 32, 4, 150, 33, 6, 150, 34, 7, 150, 35, 9, 150, 36,
+        5, 150, 37, 8, 70, 38, 33, 35, 70, 39, 32, 34, 98, 38, 38, 39,
+        93, 38, 38, 16, 93, 39, 37, 16, 70, 39, 39, 34, 70, 39, 39, 35,
+        93, 40, 36, 16, 70, 40, 40, 32, 70, 40, 40, 33, 98, 39, 39, 40,
+        70, 36, 36, 37, 70, 32, 32, 35, 70, 33, 33, 34, 78, 34, 17, 38,
+        78, 35, 38, 17, 78, 37, 17, 39, 74, 34, 37, 34, 73, 35, 35, 37,
+        92, 34, 34, 35, 79, 1, 34, 73, 32, 34, 32, 74, 33, 34, 33, 92,
+        32, 32, 33, 69, 38, 38, 69, 39, 39, 92, 40, 38, 39, 78, 40, 16,
+        40, 93, 37, 39, 16, 78, 37, 38, 37, 92, 37, 37, 40, 78, 35, 38,
+        39, 92, 35, 35, 40, 93, 33, 38, 16, 78, 33, 33, 39, 92, 33, 33,
+        40, 89, 38, 38, 18, 78, 38, 38, 39, 92, 38, 38, 40, 73, 39, 38,
+        18, 73, 40, 33, 16, 98, 41, 19, 39, 98, 41, 41, 40, 79, 3, 41,
+        70, 39, 39, 40, 70, 39, 39, 19, 73, 37, 37, 20, 98, 39, 39, 37,
+        73, 38, 38, 16, 73, 33, 33, 18, 73, 35, 35, 19, 98, 40, 20, 38,
+        98, 40, 40, 33, 98, 40, 40, 35, 79, 2, 40, 98, 42, 21, 39, 98,
+        42, 42, 40, 98, 42, 42, 41, 89, 42, 42, 36, 89, 39, 39, 32, 70,
+        0, 42, 39, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_ivtc_orc_edge_direction);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "ivtc_orc_edge_direction");
+      orc_program_set_backup_function (p, _backup_ivtc_orc_edge_direction);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_destination (p, 2, "d2");
+      orc_program_add_destination (p, 2, "d3");
+      orc_program_add_destination (p, 2, "d4");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_source (p, 1, "s6");
+      orc_program_add_constant (p, 2, 0x00000001, "c1");
+      orc_program_add_constant (p, 2, 0x00000000, "c2");
+      orc_program_add_constant (p, 2, 0x00000003, "c3");
+      orc_program_add_constant (p, 2, 0x00000004, "c4");
+      orc_program_add_constant (p, 2, 0x00000008, "c5");
+      orc_program_add_constant (p, 2, 0x00000010, "c6");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+      orc_program_add_temporary (p, 2, "t7");
+      orc_program_add_temporary (p, 2, "t8");
+      orc_program_add_temporary (p, 2, "t9");
+      orc_program_add_temporary (p, 2, "t10");
+      orc_program_add_temporary (p, 2, "t11");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T4, ORC_VAR_S6, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T5, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T6, ORC_VAR_S5, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T7, ORC_VAR_T2, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T8, ORC_VAR_T1, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T8, ORC_VAR_T6, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T9, ORC_VAR_T5, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T3, ORC_VAR_C2, ORC_VAR_T7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T7, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_C2, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andnw", 0, ORC_VAR_T3, ORC_VAR_T6, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "copyw", 0, ORC_VAR_D2, ORC_VAR_T3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T1, ORC_VAR_T3, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andnw", 0, ORC_VAR_T2, ORC_VAR_T3, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T9, ORC_VAR_T7, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T9, ORC_VAR_C1, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T6, ORC_VAR_T8, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_T7, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T7, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T2, ORC_VAR_T7, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T8, ORC_VAR_T7, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T9, ORC_VAR_T2, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T10, ORC_VAR_C4, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T10, ORC_VAR_T10, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "copyw", 0, ORC_VAR_D4, ORC_VAR_T10, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_C4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_C5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T9, ORC_VAR_C5, ORC_VAR_T7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "copyw", 0, ORC_VAR_D3, ORC_VAR_T9, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T11, ORC_VAR_C6, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T11, ORC_VAR_T11, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T11, ORC_VAR_T11, ORC_VAR_T10,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T11, ORC_VAR_T11, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_D1, ORC_VAR_T11, ORC_VAR_T8,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_D2] = d2;
+  ex->arrays[ORC_VAR_D3] = d3;
+  ex->arrays[ORC_VAR_D4] = d4;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* ivtc_orc_edge_tap */
+#ifdef DISABLE_ORC
+void
+ivtc_orc_edge_tap (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint16 * ORC_RESTRICT s1, const orc_uint16 * ORC_RESTRICT s2,
+    const orc_uint16 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, const orc_uint8 * ORC_RESTRICT s6,
+    const orc_uint8 * ORC_RESTRICT s7, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  const orc_int8 *ORC_RESTRICT ptr10;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+  ptr6 = (orc_union16 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+  ptr9 = (orc_int8 *) s6;
+  ptr10 = (orc_int8 *) s7;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var35 = ptr7[i];
+    /* 1: convubw */
+    var43.i = (orc_uint8) var35;
+    /* 2: loadb */
+    var36 = ptr8[i];
+    /* 3: convubw */
+    var44.i = (orc_uint8) var36;
+    /* 4: addw */
+    var45.i = var43.i + var44.i;
+    /* 5: loadb */
+    var37 = ptr9[i];
+    /* 6: convubw */
+    var46.i = (orc_uint8) var37;
+    /* 7: loadb */
+    var38 = ptr10[i];
+    /* 8: convubw */
+    var47.i = (orc_uint8) var38;
+    /* 9: addw */
+    var48.i = var46.i + var47.i;
+    /* 10: loadw */
+    var39 = ptr5[i];
+    /* 11: andw */
+    var49.i = var39.i & var45.i;
+    /* 12: andnw */
+    var50.i = (~var39.i) & var48.i;
+    /* 13: orw */
+    var51.i = var49.i | var50.i;
+    /* 14: loadw */
+    var40 = ptr6[i];
+    /* 15: mullw */
+    var52.i = (var51.i * var40.i) & 0xffff;
+    /* 16: loadw */
+    var41 = ptr4[i];
+    /* 17: addw */
+    var42.i = var41.i + var52.i;
+    /* 18: storew */
+    ptr0[i] = var42;
+  }
+
+}
+
+#else
+static void
+_backup_ivtc_orc_edge_tap (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  const orc_int8 *ORC_RESTRICT ptr10;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+  ptr6 = (orc_union16 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+  ptr9 = (orc_int8 *) ex->arrays[9];
+  ptr10 = (orc_int8 *) ex->arrays[10];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var35 = ptr7[i];
+    /* 1: convubw */
+    var43.i = (orc_uint8) var35;
+    /* 2: loadb */
+    var36 = ptr8[i];
+    /* 3: convubw */
+    var44.i = (orc_uint8) var36;
+    /* 4: addw */
+    var45.i = var43.i + var44.i;
+    /* 5: loadb */
+    var37 = ptr9[i];
+    /* 6: convubw */
+    var46.i = (orc_uint8) var37;
+    /* 7: loadb */
+    var38 = ptr10[i];
+    /* 8: convubw */
+    var47.i = (orc_uint8) var38;
+    /* 9: addw */
+    var48.i = var46.i + var47.i;
+    /* 10: loadw */
+    var39 = ptr5[i];
+    /* 11: andw */
+    var49.i = var39.i & var45.i;
+    /* 12: andnw */
+    var50.i = (~var39.i) & var48.i;
+    /* 13: orw */
+    var51.i = var49.i | var50.i;
+    /* 14: loadw */
+    var40 = ptr6[i];
+    /* 15: mullw */
+    var52.i = (var51.i * var40.i) & 0xffff;
+    /* 16: loadw */
+    var41 = ptr4[i];
+    /* 17: addw */
+    var42.i = var41.i + var52.i;
+    /* 18: storew */
+    ptr0[i] = var42;
+  }
+
+}
+
+void
+ivtc_orc_edge_tap (orc_uint16 * ORC_RESTRICT d1,
+    const orc_uint16 * ORC_RESTRICT s1, const orc_uint16 * ORC_RESTRICT s2,
+    const orc_uint16 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, const orc_uint8 * ORC_RESTRICT s6,
+    const orc_uint8 * ORC_RESTRICT s7, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 17, 105, 118, 116, 99, 95, 111, 114, 99, 95, 101, 100, 103, 101,
+        95, 116, 97, 112, 11, 2, 2, 12, 2, 2, 12, 2, 2, 12, 2, 2,
+        12, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 20, 2, 20, 2,
+        20, 2, 150, 32, 7, 150, 33, 8, 70, 32, 32, 33, 150, 33, 9, 150,
+        34, 10, 70, 33, 33, 34, 73, 32, 5, 32, 74, 33, 5, 33, 92, 32,
+        32, 33, 89, 32, 32, 6, 70, 0, 4, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_ivtc_orc_edge_tap);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "ivtc_orc_edge_tap");
+      orc_program_set_backup_function (p, _backup_ivtc_orc_edge_tap);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_source (p, 2, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_source (p, 1, "s6");
+      orc_program_add_source (p, 1, "s7");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S5, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S6, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S7, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T1, ORC_VAR_S2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andnw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_D1, ORC_VAR_S1, ORC_VAR_T1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+  ex->arrays[ORC_VAR_S7] = (void *) s7;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* ivtc_orc_edge_tap_final */
+#ifdef DISABLE_ORC
+void
+ivtc_orc_edge_tap_final (orc_uint8 * ORC_RESTRICT d1,
+    const orc_uint16 * ORC_RESTRICT s1, const orc_uint16 * ORC_RESTRICT s2,
+    const orc_uint16 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, const orc_uint8 * ORC_RESTRICT s6,
+    const orc_uint8 * ORC_RESTRICT s7, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  const orc_int8 *ORC_RESTRICT ptr10;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var42;
+#else
+  orc_union16 var42;
+#endif
+  orc_int8 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+  ptr6 = (orc_union16 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+  ptr9 = (orc_int8 *) s6;
+  ptr10 = (orc_int8 *) s7;
+
+  /* 18: loadpw */
+  var42.i = 0x00000010;         /* 16 or 7.90505e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var35 = ptr7[i];
+    /* 1: convubw */
+    var44.i = (orc_uint8) var35;
+    /* 2: loadb */
+    var36 = ptr8[i];
+    /* 3: convubw */
+    var45.i = (orc_uint8) var36;
+    /* 4: addw */
+    var46.i = var44.i + var45.i;
+    /* 5: loadb */
+    var37 = ptr9[i];
+    /* 6: convubw */
+    var47.i = (orc_uint8) var37;
+    /* 7: loadb */
+    var38 = ptr10[i];
+    /* 8: convubw */
+    var48.i = (orc_uint8) var38;
+    /* 9: addw */
+    var49.i = var47.i + var48.i;
+    /* 10: loadw */
+    var39 = ptr5[i];
+    /* 11: andw */
+    var50.i = var39.i & var46.i;
+    /* 12: andnw */
+    var51.i = (~var39.i) & var49.i;
+    /* 13: orw */
+    var52.i = var50.i | var51.i;
+    /* 14: loadw */
+    var40 = ptr6[i];
+    /* 15: mullw */
+    var53.i = (var52.i * var40.i) & 0xffff;
+    /* 16: loadw */
+    var41 = ptr4[i];
+    /* 17: addw */
+    var54.i = var41.i + var53.i;
+    /* 19: addw */
+    var55.i = var54.i + var42.i;
+    /* 20: shruw */
+    var56.i = ((orc_uint16) var55.i) >> 5;
+    /* 21: convwb */
+    var43 = var56.i;
+    /* 22: storew */
+    ptr0[i] = var43;
+  }
+
+}
+
+#else
+static void
+_backup_ivtc_orc_edge_tap_final (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  const orc_int8 *ORC_RESTRICT ptr10;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var42;
+#else
+  orc_union16 var42;
+#endif
+  orc_int8 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+  ptr6 = (orc_union16 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+  ptr9 = (orc_int8 *) ex->arrays[9];
+  ptr10 = (orc_int8 *) ex->arrays[10];
+
+  /* 18: loadpw */
+  var42.i = 0x00000010;         /* 16 or 7.90505e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var35 = ptr7[i];
+    /* 1: convubw */
+    var44.i = (orc_uint8) var35;
+    /* 2: loadb */
+    var36 = ptr8[i];
+    /* 3: convubw */
+    var45.i = (orc_uint8) var36;
+    /* 4: addw */
+    var46.i = var44.i + var45.i;
+    /* 5: loadb */
+    var37 = ptr9[i];
+    /* 6: convubw */
+    var47.i = (orc_uint8) var37;
+    /* 7: loadb */
+    var38 = ptr10[i];
+    /* 8: convubw */
+    var48.i = (orc_uint8) var38;
+    /* 9: addw */
+    var49.i = var47.i + var48.i;
+    /* 10: loadw */
+    var39 = ptr5[i];
+    /* 11: andw */
+    var50.i = var39.i & var46.i;
+    /* 12: andnw */
+    var51.i = (~var39.i) & var49.i;
+    /* 13: orw */
+    var52.i = var50.i | var51.i;
+    /* 14: loadw */
+    var40 = ptr6[i];
+    /* 15: mullw */
+    var53.i = (var52.i * var40.i) & 0xffff;
+    /* 16: loadw */
+    var41 = ptr4[i];
+    /* 17: addw */
+    var54.i = var41.i + var53.i;
+    /* 19: addw */
+    var55.i = var54.i + var42.i;
+    /* 20: shruw */
+    var56.i = ((orc_uint16) var55.i) >> 5;
+    /* 21: convwb */
+    var43 = var56.i;
+    /* 22: storew */
+    ptr0[i] = var43;
+  }
+
+}
+
+void
+ivtc_orc_edge_tap_final (orc_uint8 * ORC_RESTRICT d1,
+    const orc_uint16 * ORC_RESTRICT s1, const orc_uint16 * ORC_RESTRICT s2,
+    const orc_uint16 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, const orc_uint8 * ORC_RESTRICT s6,
+    const orc_uint8 * ORC_RESTRICT s7, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 23, 105, 118, 116, 99, 95, 111, 114, 99, 95, 101, 100, 103, 101,
+        95, 116, 97, 112, 95, 102, 105, 110, 97, 108, 11, 1, 1, 12, 2, 2,
+        12, 2, 2, 12, 2, 2, 12, 1, 1, 12, 1, 1, 12, 1, 1, 12,
+        1, 1, 14, 2, 16, 0, 0, 0, 14, 2, 5, 0, 0, 0, 20, 2,
+        20, 2, 20, 2, 150, 32, 7, 150, 33, 8, 70, 32, 32, 33, 150, 33,
+        9, 150, 34, 10, 70, 33, 33, 34, 73, 32, 5, 32, 74, 33, 5, 33,
+        92, 32, 32, 33, 89, 32, 32, 6, 70, 32, 4, 32, 70, 32, 32, 16,
+        95, 32, 32, 17, 157, 0, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_ivtc_orc_edge_tap_final);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "ivtc_orc_edge_tap_final");
+      orc_program_set_backup_function (p, _backup_ivtc_orc_edge_tap_final);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_source (p, 2, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_source (p, 1, "s6");
+      orc_program_add_source (p, 1, "s7");
+      orc_program_add_constant (p, 2, 0x00000010, "c1");
+      orc_program_add_constant (p, 2, 0x00000005, "c2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S5, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S6, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S7, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T1, ORC_VAR_S2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andnw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shruw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+  ex->arrays[ORC_VAR_S7] = (void *) s7;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* ivtc_orc_average_line */
+#ifdef DISABLE_ORC
+void
+ivtc_orc_average_line (orc_uint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: avgub */
+    var34 = ((orc_uint8) var32 + (orc_uint8) var33 + 1) >> 1;
+    /* 3: storew */
+    ptr0[i] = var34;
+  }
+
+}
+
+#else
+static void
+_backup_ivtc_orc_average_line (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: avgub */
+    var34 = ((orc_uint8) var32 + (orc_uint8) var33 + 1) >> 1;
+    /* 3: storew */
+    ptr0[i] = var34;
+  }
+
+}
+
+void
+ivtc_orc_average_line (orc_uint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 21, 105, 118, 116, 99, 95, 111, 114, 99, 95, 97, 118, 101, 114,
+        97, 103, 101, 95, 108, 105, 110, 101, 11, 1, 1, 12, 1, 1, 12, 1,
+        1, 39, 0, 4, 5, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_ivtc_orc_average_line);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "ivtc_orc_average_line");
+      orc_program_set_backup_function (p, _backup_ivtc_orc_average_line);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+
+      orc_program_append_2 (p, "avgub", 0, ORC_VAR_D1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
@@ -66,6 +66,11 @@ enum
   PROP_MAX_KBPS,
   PROP_MAX_BUCKET_SIZE,
   PROP_ALLOW_REORDERING,
+  PROP_TRACE_FILE,
+  PROP_BURST_ENTER_PROBABILITY,
+  PROP_BURST_EXIT_PROBABILITY,
+  PROP_BURST_DROP_PROBABILITY,
+  PROP_SEED,
 };
 
 /* these numbers are nothing but wild guesses and dont reflect any reality */
@@ -79,6 +84,14 @@ enum
 #define DEFAULT_MAX_KBPS -1
 #define DEFAULT_MAX_BUCKET_SIZE -1
 #define DEFAULT_ALLOW_REORDERING TRUE
+#define DEFAULT_TRACE_FILE NULL
+#define DEFAULT_BURST_ENTER_PROBABILITY 0.0
+#define DEFAULT_BURST_EXIT_PROBABILITY 0.5
+#define DEFAULT_BURST_DROP_PROBABILITY 1.0
+#define DEFAULT_SEED 0
+
+/* Bytes a link trace lets through per delivery opportunity, as in Mahimahi */
+#define TRACE_MTU 1500
 
 static GstStaticPadTemplate gst_net_sim_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
@@ -98,8 +111,7 @@ static gboolean
 gst_net_sim_source_dispatch (GSource * source,
     GSourceFunc callback, gpointer user_data)
 {
-  callback (user_data);
-  return FALSE;
+  return callback (user_data);
 }
 
 GSourceFuncs gst_net_sim_source_funcs = {
@@ -109,6 +121,252 @@ GSourceFuncs gst_net_sim_source_funcs = {
   NULL                          /* finalize */
 };
 
+typedef struct
+{
+  GstBuffer *buf;
+  gint64 ready_time;
+} NetSimPacket;
+
+static gboolean gst_net_sim_tick (GstNetSim * netsim);
+
+static GstBuffer *
+net_sim_packet_steal_buffer (NetSimPacket * packet)
+{
+  GstBuffer *buf = packet->buf;
+
+  g_slice_free (NetSimPacket, packet);
+
+  return buf;
+}
+
+/* Called with the loop_mutex held, takes ownership of buf */
+static void
+gst_net_sim_wheel_insert (GstNetSim * netsim, GstBuffer * buf,
+    gint64 ready_time, gint64 now)
+{
+  gint64 slot = ready_time / 1000;
+  NetSimPacket *packet;
+  GList *l;
+
+  if (netsim->wheel_count == 0 && g_queue_is_empty (&netsim->wheel_overflow))
+    netsim->wheel_base = MAX (netsim->wheel_base, now / 1000);
+
+  if (slot < netsim->wheel_base)
+    slot = netsim->wheel_base;
+
+  if (slot - netsim->wheel_base < NET_SIM_WHEEL_SLOTS) {
+    g_queue_push_tail (&netsim->wheel[slot % NET_SIM_WHEEL_SLOTS], buf);
+    netsim->wheel_count++;
+    return;
+  }
+
+  /* Too far ahead for the wheel, keep it sorted by time until it gets in
+   * range. Delays are mostly increasing, so look from the end */
+  packet = g_slice_new (NetSimPacket);
+  packet->buf = buf;
+  packet->ready_time = ready_time;
+
+  for (l = netsim->wheel_overflow.tail; l; l = l->prev) {
+    if (((NetSimPacket *) l->data)->ready_time <= ready_time)
+      break;
+  }
+
+  if (l)
+    g_queue_insert_after (&netsim->wheel_overflow, l, packet);
+  else
+    g_queue_push_head (&netsim->wheel_overflow, packet);
+}
+
+/* Called with the loop_mutex held, moves the buffers of all the slots that
+ * have expired to due */
+static void
+gst_net_sim_wheel_collect (GstNetSim * netsim, gint64 now, GQueue * due)
+{
+  gint64 now_slot = now / 1000;
+
+  while (netsim->wheel_base < now_slot && (netsim->wheel_count > 0 ||
+          !g_queue_is_empty (&netsim->wheel_overflow))) {
+    GQueue *slot = &netsim->wheel[netsim->wheel_base % NET_SIM_WHEEL_SLOTS];
+    NetSimPacket *packet;
+
+    netsim->wheel_count -= slot->length;
+    while (!g_queue_is_empty (slot))
+      g_queue_push_tail (due, g_queue_pop_head (slot));
+
+    netsim->wheel_base++;
+
+    while ((packet = g_queue_peek_head (&netsim->wheel_overflow)) &&
+        packet->ready_time / 1000 - netsim->wheel_base < NET_SIM_WHEEL_SLOTS) {
+      g_queue_pop_head (&netsim->wheel_overflow);
+      g_queue_push_tail (&netsim->wheel[(packet->ready_time / 1000) %
+              NET_SIM_WHEEL_SLOTS], net_sim_packet_steal_buffer (packet));
+      netsim->wheel_count++;
+    }
+  }
+
+  if (netsim->wheel_count == 0 && g_queue_is_empty (&netsim->wheel_overflow))
+    netsim->wheel_base = MAX (netsim->wheel_base, now_slot);
+}
+
+/* Called with the loop_mutex held. While anything is pending, the wheel
+ * ticks every millisecond whatever the packet rate, else it sleeps. */
+static void
+gst_net_sim_update_tick (GstNetSim * netsim, gint64 now)
+{
+  gboolean pending = netsim->wheel_count > 0 ||
+      !g_queue_is_empty (&netsim->wheel_overflow) ||
+      !g_queue_is_empty (&netsim->trace_queue);
+
+  if (netsim->tick_source == NULL)
+    return;
+
+  if (pending) {
+    g_source_set_ready_time (netsim->tick_source, (now / 1000 + 1) * 1000);
+  } else if (netsim->tick_scheduled) {
+    g_source_set_ready_time (netsim->tick_source, -1);
+  }
+  netsim->tick_scheduled = pending;
+}
+
+/* Called with the loop_mutex held */
+static void
+gst_net_sim_flush_scheduled (GstNetSim * netsim)
+{
+  guint i;
+
+  for (i = 0; i < NET_SIM_WHEEL_SLOTS; i++) {
+    g_queue_foreach (&netsim->wheel[i], (GFunc) gst_buffer_unref, NULL);
+    g_queue_clear (&netsim->wheel[i]);
+  }
+  netsim->wheel_count = 0;
+
+  while (!g_queue_is_empty (&netsim->wheel_overflow))
+    gst_buffer_unref (net_sim_packet_steal_buffer (g_queue_pop_head
+            (&netsim->wheel_overflow)));
+
+  g_queue_foreach (&netsim->trace_queue, (GFunc) gst_buffer_unref, NULL);
+  g_queue_clear (&netsim->trace_queue);
+
+  netsim->tick_scheduled = FALSE;
+}
+
+/* Loads a Mahimahi link trace: every line holds the time in ms of an
+ * opportunity to deliver TRACE_MTU bytes, the trace loops after the last
+ * one. Optional second and third columns set the delay in ms and the loss
+ * probability from that opportunity on. */
+static gboolean
+gst_net_sim_load_trace (GstNetSim * netsim, GError ** error)
+{
+  gchar *contents, **lines, **line;
+  NetSimTraceEntry entry = { 0, 0, 0.0 };
+  GArray *trace;
+  guint lineno = 0;
+
+  if (!g_file_get_contents (netsim->trace_file, &contents, NULL, error))
+    return FALSE;
+
+  trace = g_array_new (FALSE, FALSE, sizeof (NetSimTraceEntry));
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  for (line = lines; *line; line++) {
+    gchar *str = g_strstrip (*line), *end;
+    gint64 time;
+
+    lineno++;
+    if (*str == '\0' || *str == '#')
+      continue;
+
+    time = g_ascii_strtoll (str, &end, 10);
+    if (end == str || time < 0 || time * 1000 < entry.time)
+      goto parse_error;
+    entry.time = time * 1000;
+
+    str = end;
+    if (*str != '\0') {
+      entry.delay = g_ascii_strtoll (str, &end, 10);
+      if (end == str || entry.delay < 0)
+        goto parse_error;
+
+      str = end;
+      if (*str != '\0') {
+        entry.loss = g_ascii_strtod (str, &end);
+        if (end == str || *g_strstrip (end) != '\0' || entry.loss < 0.0
+            || entry.loss > 1.0)
+          goto parse_error;
+      }
+    }
+
+    g_array_append_val (trace, entry);
+  }
+  g_strfreev (lines);
+
+  if (trace->len == 0) {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+        "No delivery opportunity in trace");
+    g_array_unref (trace);
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (netsim, "Loaded %u delivery opportunities from %s",
+      trace->len, netsim->trace_file);
+
+  if (netsim->trace)
+    g_array_unref (netsim->trace);
+  netsim->trace = trace;
+  netsim->trace_period =
+      MAX (g_array_index (trace, NetSimTraceEntry, trace->len - 1).time, 1000);
+
+  return TRUE;
+
+parse_error:
+  g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+      "Invalid trace at line %u", lineno);
+  g_strfreev (lines);
+  g_array_unref (trace);
+  return FALSE;
+}
+
+/* Called with the loop_mutex held, accounts for the delivery opportunities
+ * up to now */
+static void
+gst_net_sim_trace_advance (GstNetSim * netsim, gint64 now)
+{
+  if (netsim->trace_cycle_start < 0) {
+    NetSimTraceEntry *first = &g_array_index (netsim->trace,
+        NetSimTraceEntry, 0);
+
+    netsim->trace_cycle_start = now;
+    netsim->trace_pos = 0;
+    netsim->trace_delay = first->delay;
+    netsim->trace_loss = first->loss;
+  }
+
+  /* Opportunities missed while idle are lost anyway, skip whole cycles */
+  if (now - netsim->trace_cycle_start > 2 * netsim->trace_period) {
+    netsim->trace_cycle_start += ((now - netsim->trace_cycle_start) /
+        netsim->trace_period - 1) * netsim->trace_period;
+    netsim->trace_pos = 0;
+  }
+
+  while (TRUE) {
+    NetSimTraceEntry *entry = &g_array_index (netsim->trace,
+        NetSimTraceEntry, netsim->trace_pos);
+
+    if (netsim->trace_cycle_start + entry->time > now)
+      break;
+
+    netsim->trace_credit += TRACE_MTU;
+    netsim->trace_delay = entry->delay;
+    netsim->trace_loss = entry->loss;
+
+    if (++netsim->trace_pos == netsim->trace->len) {
+      netsim->trace_pos = 0;
+      netsim->trace_cycle_start += netsim->trace_period;
+    }
+  }
+}
+
 static void
 gst_net_sim_loop (GstNetSim * netsim)
 {
@@ -157,8 +415,34 @@ gst_net_sim_src_activatemode (GstPad * pad, GstObject * parent,
   g_mutex_lock (&netsim->loop_mutex);
   if (active) {
     if (netsim->main_loop == NULL) {
-      GMainContext *main_context = g_main_context_new ();
+      GMainContext *main_context;
+      GError *error = NULL;
+
+      if (netsim->trace_file && !gst_net_sim_load_trace (netsim, &error)) {
+        g_mutex_unlock (&netsim->loop_mutex);
+        GST_ELEMENT_ERROR (netsim, RESOURCE, OPEN_READ,
+            ("Could not load trace file \"%s\"", netsim->trace_file),
+            ("%s", error->message));
+        g_clear_error (&error);
+        return FALSE;
+      }
+      /* don't keep replaying a trace after trace-file was unset */
+      if (!netsim->trace_file && netsim->trace) {
+        g_array_unref (netsim->trace);
+        netsim->trace = NULL;
+      }
+      netsim->trace_cycle_start = -1;
+      netsim->trace_credit = 0;
+
+      main_context = g_main_context_new ();
       netsim->main_loop = g_main_loop_new (main_context, FALSE);
+
+      netsim->wheel_base = g_get_monotonic_time () / 1000;
+      netsim->tick_source =
+          g_source_new (&gst_net_sim_source_funcs, sizeof (GSource));
+      g_source_set_callback (netsim->tick_source,
+          (GSourceFunc) gst_net_sim_tick, netsim, NULL);
+      g_source_attach (netsim->tick_source, main_context);
       g_main_context_unref (main_context);
 
       GST_TRACE_OBJECT (netsim, "ACT: Starting task on srcpad");
@@ -198,6 +482,10 @@ gst_net_sim_src_activatemode (GstPad * pad, GstObject * parent,
       GST_TRACE_OBJECT (netsim, "DEACT: Stopping task on srcpad");
       result = gst_pad_stop_task (netsim->srcpad);
       GST_TRACE_OBJECT (netsim, "DEACT: Mainloop and GstTask stopped");
+
+      g_source_destroy (netsim->tick_source);
+      g_clear_pointer (&netsim->tick_source, g_source_unref);
+      gst_net_sim_flush_scheduled (netsim);
     }
   }
   g_mutex_unlock (&netsim->loop_mutex);
@@ -205,39 +493,6 @@ gst_net_sim_src_activatemode (GstPad * pad, GstObject * parent,
   return result;
 }
 
-typedef struct
-{
-  GstPad *pad;
-  GstBuffer *buf;
-} PushBufferCtx;
-
-static inline PushBufferCtx *
-push_buffer_ctx_new (GstPad * pad, GstBuffer * buf)
-{
-  PushBufferCtx *ctx = g_slice_new (PushBufferCtx);
-  ctx->pad = gst_object_ref (pad);
-  ctx->buf = gst_buffer_ref (buf);
-  return ctx;
-}
-
-static inline void
-push_buffer_ctx_free (PushBufferCtx * ctx)
-{
-  if (G_LIKELY (ctx != NULL)) {
-    gst_buffer_unref (ctx->buf);
-    gst_object_unref (ctx->pad);
-    g_slice_free (PushBufferCtx, ctx);
-  }
-}
-
-static gboolean
-push_buffer_ctx_push (PushBufferCtx * ctx)
-{
-  GST_DEBUG_OBJECT (ctx->pad, "Pushing buffer now");
-  gst_pad_push (ctx->pad, gst_buffer_ref (ctx->buf));
-  return FALSE;
-}
-
 static gint
 get_random_value_uniform (GRand * rand_seed, gint32 min_value, gint32 max_value)
 {
@@ -326,63 +581,144 @@ get_random_value_gamma (GRand * rand_seed, gint32 low, gint32 high,
   return round (x + low);
 }
 
+static gint
+gst_net_sim_get_random_delay (GstNetSim * netsim)
+{
+  switch (netsim->delay_distribution) {
+    case DISTRIBUTION_UNIFORM:
+      return get_random_value_uniform (netsim->rand_seed, netsim->min_delay,
+          netsim->max_delay);
+    case DISTRIBUTION_NORMAL:
+      return get_random_value_normal (netsim->rand_seed, netsim->min_delay,
+          netsim->max_delay, &netsim->delay_state);
+    case DISTRIBUTION_GAMMA:
+      return get_random_value_gamma (netsim->rand_seed, netsim->min_delay,
+          netsim->max_delay, &netsim->delay_state);
+    default:
+      g_assert_not_reached ();
+      return 0;
+  }
+}
+
+/* Called with the loop_mutex held. Returns FALSE if the buffer should be
+ * pushed right away, else takes ownership of it. */
+static gboolean
+gst_net_sim_schedule (GstNetSim * netsim, GstBuffer * buf, gint delay,
+    gint64 now)
+{
+  gint64 ready_time;
+
+  if (netsim->main_loop == NULL)
+    return FALSE;
+
+  if (netsim->delay_probability > 0 &&
+      g_rand_double (netsim->rand_seed) < netsim->delay_probability)
+    delay += MAX (gst_net_sim_get_random_delay (netsim), 0);
+
+  /* Not delayed, unless that would overtake the buffers already delayed */
+  if (delay <= 0 && (netsim->allow_reordering ||
+          netsim->last_ready_time <= now))
+    return FALSE;
+
+  ready_time = now + delay * 1000;
+  if (!netsim->allow_reordering && ready_time < netsim->last_ready_time)
+    ready_time = netsim->last_ready_time + 1;
+
+  netsim->last_ready_time = ready_time;
+  GST_DEBUG_OBJECT (netsim, "Delaying packet by %" G_GINT64_FORMAT "ms",
+      (ready_time - now) / 1000);
+
+  gst_net_sim_wheel_insert (netsim, buf, ready_time, now);
+  if (!netsim->tick_scheduled)
+    gst_net_sim_update_tick (netsim, now);
+
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_net_sim_delay_buffer (GstNetSim * netsim, GstBuffer * buf)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
+  gboolean scheduled;
 
   g_mutex_lock (&netsim->loop_mutex);
-  if (netsim->main_loop != NULL && netsim->delay_probability > 0 &&
-      g_rand_double (netsim->rand_seed) < netsim->delay_probability) {
-    gint delay;
-    PushBufferCtx *ctx;
-    GSource *source;
-    gint64 ready_time, now_time;
-
-    switch (netsim->delay_distribution) {
-      case DISTRIBUTION_UNIFORM:
-        delay = get_random_value_uniform (netsim->rand_seed, netsim->min_delay,
-            netsim->max_delay);
-        break;
-      case DISTRIBUTION_NORMAL:
-        delay = get_random_value_normal (netsim->rand_seed, netsim->min_delay,
-            netsim->max_delay, &netsim->delay_state);
-        break;
-      case DISTRIBUTION_GAMMA:
-        delay = get_random_value_gamma (netsim->rand_seed, netsim->min_delay,
-            netsim->max_delay, &netsim->delay_state);
-        break;
-      default:
-        g_assert_not_reached ();
-        break;
-    }
+  scheduled = gst_net_sim_schedule (netsim, gst_buffer_ref (buf), 0,
+      g_get_monotonic_time ());
+  g_mutex_unlock (&netsim->loop_mutex);
+
+  if (scheduled)
+    return GST_FLOW_OK;
 
-    if (delay < 0)
-      delay = 0;
+  /* the ref taken for scheduling goes downstream */
+  return gst_pad_push (netsim->srcpad, buf);
+}
 
-    ctx = push_buffer_ctx_new (netsim->srcpad, buf);
+/* Queues the buffer until the trace has a delivery opportunity for it */
+static GstFlowReturn
+gst_net_sim_trace_buffer (GstNetSim * netsim, GstBuffer * buf)
+{
+  gint64 now = g_get_monotonic_time ();
 
-    source = g_source_new (&gst_net_sim_source_funcs, sizeof (GSource));
-    now_time = g_get_monotonic_time ();
-    ready_time = now_time + delay * 1000;
-    if (!netsim->allow_reordering && ready_time < netsim->last_ready_time)
-      ready_time = netsim->last_ready_time + 1;
+  g_mutex_lock (&netsim->loop_mutex);
+  if (netsim->main_loop == NULL) {
+    g_mutex_unlock (&netsim->loop_mutex);
+    return GST_FLOW_FLUSHING;
+  }
 
-    netsim->last_ready_time = ready_time;
-    GST_DEBUG_OBJECT (netsim, "Delaying packet by %" G_GINT64_FORMAT "ms",
-        (ready_time - now_time) / 1000);
+  gst_net_sim_trace_advance (netsim, now);
 
-    g_source_set_ready_time (source, ready_time);
-    g_source_set_callback (source, (GSourceFunc) push_buffer_ctx_push,
-        ctx, (GDestroyNotify) push_buffer_ctx_free);
-    g_source_attach (source, g_main_loop_get_context (netsim->main_loop));
-    g_source_unref (source);
-  } else {
-    ret = gst_pad_push (netsim->srcpad, gst_buffer_ref (buf));
+  if (netsim->trace_loss > 0 &&
+      g_rand_double (netsim->rand_seed) < netsim->trace_loss) {
+    GST_DEBUG_OBJECT (netsim, "Dropping packet (trace)");
+    g_mutex_unlock (&netsim->loop_mutex);
+    return GST_FLOW_OK;
   }
+
+  /* Opportunities are wasted while there is nothing to send */
+  if (g_queue_is_empty (&netsim->trace_queue))
+    netsim->trace_credit = 0;
+
+  g_queue_push_tail (&netsim->trace_queue, gst_buffer_ref (buf));
+  if (!netsim->tick_scheduled)
+    gst_net_sim_update_tick (netsim, now);
   g_mutex_unlock (&netsim->loop_mutex);
 
-  return ret;
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_net_sim_tick (GstNetSim * netsim)
+{
+  GQueue due = G_QUEUE_INIT;
+  gint64 now = g_get_monotonic_time ();
+  GstBuffer *buf;
+
+  g_mutex_lock (&netsim->loop_mutex);
+  if (netsim->trace && !g_queue_is_empty (&netsim->trace_queue)) {
+    gst_net_sim_trace_advance (netsim, now);
+
+    while ((buf = g_queue_peek_head (&netsim->trace_queue)) &&
+        gst_buffer_get_size (buf) <= netsim->trace_credit) {
+      g_queue_pop_head (&netsim->trace_queue);
+      netsim->trace_credit -= gst_buffer_get_size (buf);
+
+      if (!gst_net_sim_schedule (netsim, buf, netsim->trace_delay, now))
+        g_queue_push_tail (&due, buf);
+    }
+
+    if (g_queue_is_empty (&netsim->trace_queue))
+      netsim->trace_credit = 0;
+  }
+
+  gst_net_sim_wheel_collect (netsim, now, &due);
+  gst_net_sim_update_tick (netsim, now);
+  g_mutex_unlock (&netsim->loop_mutex);
+
+  while ((buf = g_queue_pop_head (&due))) {
+    GST_LOG_OBJECT (netsim, "Pushing buffer now");
+    gst_pad_push (netsim->srcpad, buf);
+  }
+
+  return G_SOURCE_CONTINUE;
 }
 
 static gint
@@ -468,6 +804,40 @@ gst_net_sim_token_bucket (GstNetSim * netsim, GstBuffer * buf)
   return TRUE;
 }
 
+/* Random loss, following a Gilbert-Elliott model when bursts are enabled:
+ * drop-probability applies in the good state and burst-drop-probability in
+ * the bad one */
+static gboolean
+gst_net_sim_random_drop (GstNetSim * netsim)
+{
+  gdouble probability = netsim->drop_probability;
+
+  if (netsim->burst_enter_probability > 0) {
+    if (netsim->burst_bad) {
+      if (g_rand_double (netsim->rand_seed) <
+          (gdouble) netsim->burst_exit_probability)
+        netsim->burst_bad = FALSE;
+    } else if (g_rand_double (netsim->rand_seed) <
+        (gdouble) netsim->burst_enter_probability) {
+      netsim->burst_bad = TRUE;
+    }
+
+    if (netsim->burst_bad)
+      probability = netsim->burst_drop_probability;
+  }
+
+  return probability > 0 && g_rand_double (netsim->rand_seed) < probability;
+}
+
+static GstFlowReturn
+gst_net_sim_forward (GstNetSim * netsim, GstBuffer * buf)
+{
+  if (netsim->trace)
+    return gst_net_sim_trace_buffer (netsim, buf);
+
+  return gst_net_sim_delay_buffer (netsim, buf);
+}
+
 static GstFlowReturn
 gst_net_sim_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
@@ -481,18 +851,16 @@ gst_net_sim_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     netsim->drop_packets--;
     GST_DEBUG_OBJECT (netsim, "Dropping packet (%d left)",
         netsim->drop_packets);
-  } else if (netsim->drop_probability > 0
-      && g_rand_double (netsim->rand_seed) <
-      (gdouble) netsim->drop_probability) {
+  } else if (gst_net_sim_random_drop (netsim)) {
     GST_DEBUG_OBJECT (netsim, "Dropping packet");
   } else if (netsim->duplicate_probability > 0 &&
       g_rand_double (netsim->rand_seed) <
       (gdouble) netsim->duplicate_probability) {
     GST_DEBUG_OBJECT (netsim, "Duplicating packet");
-    gst_net_sim_delay_buffer (netsim, buf);
-    ret = gst_net_sim_delay_buffer (netsim, buf);
+    gst_net_sim_forward (netsim, buf);
+    ret = gst_net_sim_forward (netsim, buf);
   } else {
-    ret = gst_net_sim_delay_buffer (netsim, buf);
+    ret = gst_net_sim_forward (netsim, buf);
   }
 
 done:
@@ -540,6 +908,24 @@ gst_net_sim_set_property (GObject * object,
     case PROP_ALLOW_REORDERING:
       netsim->allow_reordering = g_value_get_boolean (value);
       break;
+    case PROP_TRACE_FILE:
+      g_free (netsim->trace_file);
+      netsim->trace_file = g_value_dup_string (value);
+      break;
+    case PROP_BURST_ENTER_PROBABILITY:
+      netsim->burst_enter_probability = g_value_get_float (value);
+      break;
+    case PROP_BURST_EXIT_PROBABILITY:
+      netsim->burst_exit_probability = g_value_get_float (value);
+      break;
+    case PROP_BURST_DROP_PROBABILITY:
+      netsim->burst_drop_probability = g_value_get_float (value);
+      break;
+    case PROP_SEED:
+      netsim->seed = g_value_get_uint (value);
+      if (netsim->seed != 0)
+        g_rand_set_seed (netsim->rand_seed, netsim->seed);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -583,6 +969,21 @@ gst_net_sim_get_property (GObject * object,
     case PROP_ALLOW_REORDERING:
       g_value_set_boolean (value, netsim->allow_reordering);
       break;
+    case PROP_TRACE_FILE:
+      g_value_set_string (value, netsim->trace_file);
+      break;
+    case PROP_BURST_ENTER_PROBABILITY:
+      g_value_set_float (value, netsim->burst_enter_probability);
+      break;
+    case PROP_BURST_EXIT_PROBABILITY:
+      g_value_set_float (value, netsim->burst_exit_probability);
+      break;
+    case PROP_BURST_DROP_PROBABILITY:
+      g_value_set_float (value, netsim->burst_drop_probability);
+      break;
+    case PROP_SEED:
+      g_value_set_uint (value, netsim->seed);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -606,6 +1007,7 @@ gst_net_sim_init (GstNetSim * netsim)
   netsim->rand_seed = g_rand_new ();
   netsim->main_loop = NULL;
   netsim->prev_time = GST_CLOCK_TIME_NONE;
+  netsim->trace_cycle_start = -1;
 
   GST_OBJECT_FLAG_SET (netsim->sinkpad,
       GST_PAD_FLAG_PROXY_CAPS | GST_PAD_FLAG_PROXY_ALLOCATION);
@@ -622,6 +1024,9 @@ gst_net_sim_finalize (GObject * object)
   GstNetSim *netsim = GST_NET_SIM (object);
 
   g_rand_free (netsim->rand_seed);
+  g_free (netsim->trace_file);
+  if (netsim->trace)
+    g_array_unref (netsim->trace);
   g_mutex_clear (&netsim->loop_mutex);
   g_cond_clear (&netsim->start_cond);
 
@@ -755,6 +1160,84 @@ gst_net_sim_class_init (GstNetSimClass * klass)
           DEFAULT_ALLOW_REORDERING,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstNetSim:trace-file:
+   *
+   * A link trace to replay, in the format of Mahimahi: each line holds the
+   * time in ms of an opportunity to deliver 1500 bytes, and the trace loops
+   * after its last line. An optional second column sets the delay in ms
+   * and a third one the loss probability from that point on. Buffers wait
+   * in an unlimited queue for their delivery opportunity, the delay then
+   * adds up with the one from the delay properties.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_TRACE_FILE,
+      g_param_spec_string ("trace-file", "Trace File",
+          "Link trace to replay (Mahimahi format)", DEFAULT_TRACE_FILE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:burst-enter-probability:
+   *
+   * The probability, for every buffer, to go from the good to the bad state
+   * of a Gilbert-Elliott loss model. Setting it to a positive value enables
+   * bursty losses: "drop-probability" then applies in the good state and
+   * "burst-drop-probability" in the bad one.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_BURST_ENTER_PROBABILITY,
+      g_param_spec_float ("burst-enter-probability",
+          "Burst Enter Probability",
+          "The probability to enter a loss burst (0 = no bursts)",
+          0.0, 1.0, DEFAULT_BURST_ENTER_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:burst-exit-probability:
+   *
+   * The probability, for every buffer, to go back from the bad to the good
+   * state of the Gilbert-Elliott loss model.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_BURST_EXIT_PROBABILITY,
+      g_param_spec_float ("burst-exit-probability", "Burst Exit Probability",
+          "The probability to leave a loss burst",
+          0.0, 1.0, DEFAULT_BURST_EXIT_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:burst-drop-probability:
+   *
+   * The probability a buffer is dropped in the bad state of the
+   * Gilbert-Elliott loss model.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_BURST_DROP_PROBABILITY,
+      g_param_spec_float ("burst-drop-probability", "Burst Drop Probability",
+          "The probability a buffer is dropped during a loss burst",
+          0.0, 1.0, DEFAULT_BURST_DROP_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:seed:
+   *
+   * The seed of the random number generator, to reproduce the same drops,
+   * duplicates and delays from one run to the next.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_SEED,
+      g_param_spec_uint ("seed", "Seed",
+          "Seed of the random number generator (0 = random)",
+          0, G_MAXUINT, DEFAULT_SEED,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
   GST_DEBUG_CATEGORY_INIT (netsim_debug, "netsim", 0, "Network simulator");
 }
 
@@ -60,6 +60,16 @@ typedef struct
   gdouble z1;
 } NormalDistributionState;
 
+/* One delivery opportunity of a link trace */
+typedef struct
+{
+  gint64 time;                  /* us since the start of the trace */
+  gint delay;                   /* ms */
+  gdouble loss;
+} NetSimTraceEntry;
+
+#define NET_SIM_WHEEL_SLOTS 1024
+
 struct _GstNetSim
 {
   GstElement parent;
@@ -77,6 +87,28 @@ struct _GstNetSim
   NormalDistributionState delay_state;
   gint64 last_ready_time;
 
+  /* delayed buffers, in a timer wheel with one slot per millisecond and
+   * a sorted overflow queue for the ones beyond the wheel */
+  GSource *tick_source;
+  gboolean tick_scheduled;
+  GQueue wheel[NET_SIM_WHEEL_SLOTS];
+  gint64 wheel_base;
+  guint wheel_count;
+  GQueue wheel_overflow;
+
+  /* link trace replay */
+  GArray *trace;
+  guint trace_pos;
+  gint64 trace_cycle_start;
+  gint64 trace_period;
+  gint trace_delay;
+  gdouble trace_loss;
+  gsize trace_credit;
+  GQueue trace_queue;
+
+  /* Gilbert-Elliott burst loss */
+  gboolean burst_bad;
+
   /* properties */
   gint min_delay;
   gint max_delay;
@@ -88,6 +120,11 @@ struct _GstNetSim
   gint max_kbps;
   gint max_bucket_size;
   gboolean allow_reordering;
+  gchar *trace_file;
+  gfloat burst_enter_probability;
+  gfloat burst_exit_probability;
+  gfloat burst_drop_probability;
+  guint seed;
 };
 
 struct _GstNetSimClass
@@ -26,9 +26,24 @@
  * #GstPcapParse:src-port and #GstPcapParse:dst-port to restrict which packets
  * should be included.
  *
- * The supported data format is the classical <ulink
+ * The supported data formats are the classical <ulink
  * url="https://wiki.wireshark.org/Development/LibpcapFileFormat">libpcap file
- * format</ulink>.
+ * format</ulink> and <ulink
+ * url="https://github.com/pcapng/pcapng">pcapng</ulink>.
+ *
+ * Packets of a single UDP or TCP flow can be sent out on their own source pad
+ * by requesting a pad named
+ * src_&lt;udp|tcp&gt;_&lt;src-ip&gt;_&lt;src-port&gt;_&lt;dst-ip&gt;_&lt;dst-port&gt;,
+ * for example src_udp_10.0.0.1_5004_10.0.0.2_5004. With
+ * #GstPcapParse:split-flows enabled, such a pad is also added for every new
+ * flow found in the capture, so a single pass over the file can feed one
+ * depayloader per flow. All pads share the same time base. Packets that don't
+ * belong to any flow pad go to the always source pad, subject to the filter
+ * properties.
+ *
+ * When upstream supports it, the file is read in pull mode in large blocks
+ * and the output buffers reference those blocks instead of copying every
+ * packet.
  *
  * ## Example pipelines
  * |[
@@ -36,6 +51,11 @@
  * ! ffdec_h264 ! fakesink
  * ]| Read from a pcap dump file using filesrc, extract the raw UDP packets,
  * depayload and decode them.
+ * |[
+ * gst-launch-1.0 filesrc location=call.pcapng ! pcapparse name=p
+ *   p.src_udp_10.0.0.1_5004_10.0.0.2_5004 ! application/x-rtp,media=audio,clock-rate=8000,encoding-name=PCMA ! rtppcmadepay ! fakesink
+ *   p.src_udp_10.0.0.1_5006_10.0.0.2_5006 ! application/x-rtp,media=video,clock-rate=90000,encoding-name=H264 ! rtph264depay ! fakesink
+ * ]| Demultiplex the audio and video flows of a call in one pass.
  *
  */
 
@@ -65,6 +85,18 @@ const guint GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN = 0xa1b23c4d;
 const guint GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN = 0xd4c3b2a1;
 const guint GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN = 0x4d3cb2a1;
 
+#define PCAPNG_BLOCK_SHB 0x0a0d0d0a
+#define PCAPNG_BLOCK_IDB 0x00000001
+#define PCAPNG_BLOCK_SPB 0x00000003
+#define PCAPNG_BLOCK_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1a2b3c4d
+#define PCAPNG_OPT_ENDOFOPT 0
+#define PCAPNG_OPT_IF_TSRESOL 9
+#define PCAPNG_DEFAULT_TSRESOL 6
+
+/* How much to read at once in pull mode */
+#define PULL_BLOCK_SIZE (1024 * 1024)
+
 
 enum
 {
@@ -74,7 +106,8 @@ enum
   PROP_SRC_PORT,
   PROP_DST_PORT,
   PROP_CAPS,
-  PROP_TS_OFFSET
+  PROP_TS_OFFSET,
+  PROP_SPLIT_FLOWS
 };
 
 GST_DEBUG_CATEGORY_STATIC (gst_pcap_parse_debug);
@@ -90,6 +123,12 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS_ANY);
 
+static GstStaticPadTemplate flow_src_template =
+GST_STATIC_PAD_TEMPLATE ("src_%s",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS_ANY);
+
 static void gst_pcap_parse_finalize (GObject * object);
 static void gst_pcap_parse_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
@@ -97,11 +136,19 @@ static void gst_pcap_parse_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static GstStateChangeReturn
 gst_pcap_parse_change_state (GstElement * element, GstStateChange transition);
+static GstPad *gst_pcap_parse_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps);
+static void gst_pcap_parse_release_pad (GstElement * element, GstPad * pad);
 
 static void gst_pcap_parse_reset (GstPcapParse * self);
 
+static gboolean gst_pcap_parse_sink_activate (GstPad * sinkpad,
+    GstObject * parent);
+static gboolean gst_pcap_parse_sink_activate_mode (GstPad * sinkpad,
+    GstObject * parent, GstPadMode mode, gboolean active);
 static GstFlowReturn gst_pcap_parse_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buffer);
+static void gst_pcap_parse_loop (GstPad * pad);
 static gboolean gst_pcap_sink_event (GstPad * pad,
     GstObject * parent, GstEvent * event);
 
@@ -149,10 +196,28 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
           "Relative timestamp offset (ns) to apply (-1 = use absolute packet time)",
           -1, G_MAXINT64, -1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPcapParse:split-flows:
+   *
+   * Add a source pad for every UDP or TCP flow that doesn't have one yet,
+   * instead of sending its packets to the always source pad.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_SPLIT_FLOWS,
+      g_param_spec_boolean ("split-flows", "Split flows",
+          "Add a source pad for each new flow", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (element_class, &sink_template);
   gst_element_class_add_static_pad_template (element_class, &src_template);
+  gst_element_class_add_static_pad_template (element_class,
+      &flow_src_template);
 
   element_class->change_state = gst_pcap_parse_change_state;
+  element_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_request_new_pad);
+  element_class->release_pad = GST_DEBUG_FUNCPTR (gst_pcap_parse_release_pad);
 
   gst_element_class_set_static_metadata (element_class, "PCapParse",
       "Raw/Parser",
@@ -162,10 +227,38 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
   GST_DEBUG_CATEGORY_INIT (gst_pcap_parse_debug, "pcapparse", 0, "pcap parser");
 }
 
+static void
+gst_pcap_parse_flow_free (GstPcapParseFlow * flow)
+{
+  if (flow->pending)
+    gst_buffer_list_unref (flow->pending);
+  gst_object_unref (flow->pad);
+  g_free (flow);
+}
+
+static guint
+gst_pcap_parse_flow_key_hash (gconstpointer v)
+{
+  const GstPcapParseFlowKey *key = v;
+
+  return key->src_ip ^ (key->dst_ip * 31) ^
+      ((key->src_port << 16) | key->dst_port) ^ key->proto;
+}
+
+static gboolean
+gst_pcap_parse_flow_key_equal (gconstpointer a, gconstpointer b)
+{
+  return memcmp (a, b, sizeof (GstPcapParseFlowKey)) == 0;
+}
+
 static void
 gst_pcap_parse_init (GstPcapParse * self)
 {
   self->sink_pad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_activate_function (self->sink_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_sink_activate));
+  gst_pad_set_activatemode_function (self->sink_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_sink_activate_mode));
   gst_pad_set_chain_function (self->sink_pad,
       GST_DEBUG_FUNCPTR (gst_pcap_parse_chain));
   gst_pad_use_fixed_caps (self->sink_pad);
@@ -183,7 +276,12 @@ gst_pcap_parse_init (GstPcapParse * self)
   self->dst_port = -1;
   self->offset = -1;
 
-  self->adapter = gst_adapter_new ();
+  self->interfaces = g_array_new (FALSE, FALSE, sizeof (GstPcapParseInterface));
+  self->flows = g_hash_table_new_full (gst_pcap_parse_flow_key_hash,
+      gst_pcap_parse_flow_key_equal, NULL,
+      (GDestroyNotify) gst_pcap_parse_flow_free);
+  self->flow_combiner = gst_flow_combiner_new ();
+  gst_flow_combiner_add_pad (self->flow_combiner, self->src_pad);
 
   gst_pcap_parse_reset (self);
 }
@@ -193,7 +291,10 @@ gst_pcap_parse_finalize (GObject * object)
 {
   GstPcapParse *self = GST_PCAP_PARSE (object);
 
-  g_object_unref (self->adapter);
+  gst_buffer_replace (&self->leftover, NULL);
+  g_array_free (self->interfaces, TRUE);
+  g_hash_table_destroy (self->flows);
+  gst_flow_combiner_free (self->flow_combiner);
   if (self->caps)
     gst_caps_unref (self->caps);
 
@@ -255,6 +356,12 @@ gst_pcap_parse_get_property (GObject * object, guint prop_id,
       g_value_set_int64 (value, self->offset);
       break;
 
+    case PROP_SPLIT_FLOWS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, self->split_flows);
+      GST_OBJECT_UNLOCK (self);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -309,6 +416,12 @@ gst_pcap_parse_set_property (GObject * object, guint prop_id,
       self->offset = g_value_get_int64 (value);
       break;
 
+    case PROP_SPLIT_FLOWS:
+      GST_OBJECT_LOCK (self);
+      self->split_flows = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -318,6 +431,9 @@ gst_pcap_parse_set_property (GObject * object, guint prop_id,
 static void
 gst_pcap_parse_reset (GstPcapParse * self)
 {
+  GHashTableIter iter;
+  gpointer value;
+
   self->initialized = FALSE;
   self->swap_endian = FALSE;
   self->nanosecond_timestamp = FALSE;
@@ -325,8 +441,26 @@ gst_pcap_parse_reset (GstPcapParse * self)
   self->cur_ts = GST_CLOCK_TIME_NONE;
   self->base_ts = GST_CLOCK_TIME_NONE;
   self->newsegment_sent = FALSE;
-
-  gst_adapter_clear (self->adapter);
+  self->pcapng = FALSE;
+  g_array_set_size (self->interfaces, 0);
+  self->needed = 0;
+  self->pull_offset = 0;
+  self->stream_start_sent = FALSE;
+
+  gst_buffer_replace (&self->leftover, NULL);
+
+  GST_OBJECT_LOCK (self);
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    GstPcapParseFlow *flow = value;
+
+    if (flow->pending)
+      gst_buffer_list_unref (flow->pending);
+    flow->pending = NULL;
+    flow->newsegment_sent = FALSE;
+  }
+  gst_flow_combiner_reset (self->flow_combiner);
+  GST_OBJECT_UNLOCK (self);
 }
 
 static guint32
@@ -345,6 +479,17 @@ gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
   }
 }
 
+static guint16
+gst_pcap_parse_read_uint16 (GstPcapParse * self, const guint8 * p)
+{
+  guint16 val = *((guint16 *) p);
+
+  if (self->swap_endian)
+    return GUINT16_SWAP_LE_BE (val);
+  else
+    return val;
+}
+
 #define ETH_MAC_ADDRESSES_LEN    12
 #define ETH_HEADER_LEN    14
 #define ETH_VLAN_HEADER_LEN    4
@@ -359,7 +504,8 @@ gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
 static gboolean
 gst_pcap_parse_scan_frame (GstPcapParse * self,
     const guint8 * buf,
-    gint buf_size, const guint8 ** payload, gint * payload_size)
+    gint buf_size, const guint8 ** payload, gint * payload_size,
+    GstPcapParseFlowKey * key)
 {
   const guint8 *buf_ip = 0;
   const guint8 *buf_proto;
@@ -473,201 +619,922 @@ gst_pcap_parse_scan_frame (GstPcapParse * self,
     *payload_size = self->cur_packet_size - (buf_proto - buf) - len;
   }
 
-  /* but still filter as configured */
-  if (self->src_ip >= 0 && ip_src_addr != self->src_ip)
+  memset (key, 0, sizeof (GstPcapParseFlowKey));
+  key->src_ip = ip_src_addr;
+  key->dst_ip = ip_dst_addr;
+  key->src_port = src_port;
+  key->dst_port = dst_port;
+  key->proto = ip_protocol;
+
+  return TRUE;
+}
+
+/* Whether a packet that no flow pad claimed goes out on the always pad */
+static gboolean
+gst_pcap_parse_filter (GstPcapParse * self, const GstPcapParseFlowKey * key)
+{
+  if (self->src_ip >= 0 && key->src_ip != self->src_ip)
     return FALSE;
 
-  if (self->dst_ip >= 0 && ip_dst_addr != self->dst_ip)
+  if (self->dst_ip >= 0 && key->dst_ip != self->dst_ip)
     return FALSE;
 
-  if (self->src_port >= 0 && src_port != self->src_port)
+  if (self->src_port >= 0 && key->src_port != self->src_port)
     return FALSE;
 
-  if (self->dst_port >= 0 && dst_port != self->dst_port)
+  if (self->dst_port >= 0 && key->dst_port != self->dst_port)
     return FALSE;
 
   return TRUE;
 }
 
+static gchar *
+gst_pcap_parse_flow_key_to_string (const GstPcapParseFlowKey * key)
+{
+  gchar *src, *dst, *ret;
+
+  /* inet_ntoa() returns a static buffer */
+  src = g_strdup (get_ip_address_as_string (key->src_ip));
+  dst = g_strdup (get_ip_address_as_string (key->dst_ip));
+  ret = g_strdup_printf ("%s_%s_%u_%s_%u",
+      key->proto == IP_PROTO_UDP ? "udp" : "tcp", src, key->src_port, dst,
+      key->dst_port);
+  g_free (src);
+  g_free (dst);
+
+  return ret;
+}
+
+/* Parses <udp|tcp>_<src-ip>_<src-port>_<dst-ip>_<dst-port> */
+static gboolean
+gst_pcap_parse_flow_key_from_string (GstPcapParseFlowKey * key,
+    const gchar * str)
+{
+  gchar **parts;
+  gulong src_ip, dst_ip;
+  guint64 src_port, dst_port;
+  gchar *end_src, *end_dst;
+  gboolean ret = FALSE;
+
+  memset (key, 0, sizeof (GstPcapParseFlowKey));
+
+  parts = g_strsplit (str, "_", -1);
+  if (g_strv_length (parts) != 5)
+    goto done;
+
+  if (strcmp (parts[0], "udp") == 0)
+    key->proto = IP_PROTO_UDP;
+  else if (strcmp (parts[0], "tcp") == 0)
+    key->proto = IP_PROTO_TCP;
+  else
+    goto done;
+
+  src_ip = inet_addr (parts[1]);
+  dst_ip = inet_addr (parts[3]);
+  if (src_ip == INADDR_NONE || dst_ip == INADDR_NONE)
+    goto done;
+
+  src_port = g_ascii_strtoull (parts[2], &end_src, 10);
+  dst_port = g_ascii_strtoull (parts[4], &end_dst, 10);
+  if (*end_src != '\0' || *end_dst != '\0' || src_port > G_MAXUINT16
+      || dst_port > G_MAXUINT16)
+    goto done;
+
+  key->src_ip = src_ip;
+  key->dst_ip = dst_ip;
+  key->src_port = src_port;
+  key->dst_port = dst_port;
+  ret = TRUE;
+
+done:
+  g_strfreev (parts);
+
+  return ret;
+}
+
+/* Creates the pad for a flow, unless the flow already has one. The pad is
+ * added to the element outside of the object lock so that pad-added handlers
+ * can link it right away. */
+static GstPad *
+gst_pcap_parse_add_flow (GstPcapParse * self, const GstPcapParseFlowKey * key,
+    const gchar * name)
+{
+  GstPcapParseFlow *flow;
+  GstPad *pad;
+  gchar *flow_name = NULL;
+  gchar *pad_name;
+
+  if (name) {
+    pad_name = g_strdup (name);
+  } else {
+    flow_name = gst_pcap_parse_flow_key_to_string (key);
+    pad_name = g_strdup_printf ("src_%s", flow_name);
+    g_free (flow_name);
+  }
+
+  GST_OBJECT_LOCK (self);
+  if (g_hash_table_lookup (self->flows, key)) {
+    GST_OBJECT_UNLOCK (self);
+    GST_WARNING_OBJECT (self, "Flow %s already has a pad", pad_name);
+    g_free (pad_name);
+    return NULL;
+  }
+
+  pad = gst_pad_new_from_static_template (&flow_src_template, pad_name);
+  g_free (pad_name);
+  gst_pad_use_fixed_caps (pad);
+
+  flow = g_new0 (GstPcapParseFlow, 1);
+  flow->key = *key;
+  flow->pad = gst_object_ref (pad);
+  gst_pad_set_element_private (pad, flow);
+
+  g_hash_table_insert (self->flows, &flow->key, flow);
+  gst_flow_combiner_add_pad (self->flow_combiner, pad);
+  GST_OBJECT_UNLOCK (self);
+
+  GST_DEBUG_OBJECT (self, "Adding pad %s:%s", GST_DEBUG_PAD_NAME (pad));
+  gst_element_add_pad (GST_ELEMENT_CAST (self), pad);
+
+  return pad;
+}
+
+static GstPad *
+gst_pcap_parse_request_new_pad (GstElement * element, GstPadTemplate * templ,
+    const gchar * name, const GstCaps * caps)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (element);
+  GstPcapParseFlowKey key;
+
+  if (name == NULL || !g_str_has_prefix (name, "src_") ||
+      !gst_pcap_parse_flow_key_from_string (&key, name + 4)) {
+    GST_WARNING_OBJECT (self, "Invalid pad name %s, expected "
+        "src_<udp|tcp>_<src-ip>_<src-port>_<dst-ip>_<dst-port>",
+        GST_STR_NULL (name));
+    return NULL;
+  }
+
+  return gst_pcap_parse_add_flow (self, &key, name);
+}
+
+static void
+gst_pcap_parse_release_pad (GstElement * element, GstPad * pad)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (element);
+  GstPcapParseFlow *flow;
+
+  GST_OBJECT_LOCK (self);
+  flow = gst_pad_get_element_private (pad);
+  if (flow == NULL) {
+    GST_OBJECT_UNLOCK (self);
+    return;
+  }
+  gst_pad_set_element_private (pad, NULL);
+  gst_flow_combiner_remove_pad (self->flow_combiner, pad);
+  g_hash_table_remove (self->flows, &flow->key);
+  GST_OBJECT_UNLOCK (self);
+
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+}
+
+static void
+gst_pcap_parse_init_segment (GstPcapParse * self, GstSegment * segment)
+{
+  gst_segment_init (segment, GST_FORMAT_TIME);
+
+  /* relative timestamps start at the offset, absolute ones at the first
+   * packet */
+  if (self->offset >= 0)
+    segment->start = self->offset;
+  else if (GST_CLOCK_TIME_IS_VALID (self->base_ts))
+    segment->start = self->base_ts;
+}
+
+static void
+gst_pcap_parse_start_flow_pad (GstPcapParse * self, GstPad * pad)
+{
+  GstSegment segment;
+  gchar *stream_id;
+
+  /* the stream id is the flow part of the pad name */
+  stream_id = gst_pad_create_stream_id (pad, GST_ELEMENT_CAST (self),
+      GST_PAD_NAME (pad) + 4);
+  gst_pad_push_event (pad, gst_event_new_stream_start (stream_id));
+  g_free (stream_id);
+
+  if (self->caps)
+    gst_pad_push_event (pad, gst_event_new_caps (self->caps));
+
+  gst_pcap_parse_init_segment (self, &segment);
+  gst_pad_push_event (pad, gst_event_new_segment (&segment));
+}
+
+static GstClockTime
+gst_pcap_parse_get_timestamp (GstPcapParse * self)
+{
+  GstClockTime ts = self->cur_ts;
+
+  if (GST_CLOCK_TIME_IS_VALID (ts)) {
+    if (!GST_CLOCK_TIME_IS_VALID (self->base_ts))
+      self->base_ts = ts;
+    if (self->offset >= 0) {
+      ts -= self->base_ts;
+      ts += self->offset;
+    }
+  }
+
+  return ts;
+}
+
+/* Queues the payload of the packet at data, which lies within block, on the
+ * pad of its flow or on the always pad */
+static void
+gst_pcap_parse_add_packet (GstPcapParse * self, GstBuffer * block,
+    const guint8 * block_data, const guint8 * data, guint32 size)
+{
+  const guint8 *payload;
+  gint payload_size;
+  GstPcapParseFlowKey key;
+  GstPcapParseFlow *flow;
+  GstBufferList **list;
+  GstBuffer *out_buf;
+  GstClockTime ts;
+
+  if (size == 0)
+    return;
+
+  GST_LOG_OBJECT (self, "examining packet size %u", size);
+
+  self->cur_packet_size = size;
+  if (!gst_pcap_parse_scan_frame (self, data, size, &payload, &payload_size,
+          &key))
+    return;
+
+  GST_OBJECT_LOCK (self);
+  flow = g_hash_table_lookup (self->flows, &key);
+  if (flow == NULL && self->split_flows) {
+    GST_OBJECT_UNLOCK (self);
+    gst_pcap_parse_add_flow (self, &key, NULL);
+    GST_OBJECT_LOCK (self);
+    flow = g_hash_table_lookup (self->flows, &key);
+  }
+
+  if (flow) {
+    list = &flow->pending;
+  } else if (gst_pcap_parse_filter (self, &key)) {
+    list = &self->pending;
+  } else {
+    GST_OBJECT_UNLOCK (self);
+    return;
+  }
+
+  /* The block is a single memory, so are the subbuffers of it. The RTP
+   * depayloaders expect the complete RTP header to be in the first memory if
+   * there are multiple ones. */
+  if (payload_size > 0) {
+    out_buf = gst_buffer_copy_region (block, GST_BUFFER_COPY_MEMORY,
+        payload - block_data, payload_size);
+  } else {
+    out_buf = gst_buffer_new ();
+  }
+
+  ts = gst_pcap_parse_get_timestamp (self);
+  GST_BUFFER_TIMESTAMP (out_buf) = ts;
+
+  if (*list == NULL)
+    *list = gst_buffer_list_new ();
+  gst_buffer_list_add (*list, out_buf);
+  GST_OBJECT_UNLOCK (self);
+}
+
+typedef struct
+{
+  GstPad *pad;
+  GstBufferList *list;
+  gboolean start;
+} GstPcapParsePush;
+
 static GstFlowReturn
-gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_pcap_parse_push_pending (GstPcapParse * self)
 {
-  GstPcapParse *self = GST_PCAP_PARSE (parent);
   GstFlowReturn ret = GST_FLOW_OK;
-  GstBufferList *list = NULL;
+  GArray *pushes;
+  GHashTableIter iter;
+  gpointer value;
+  guint i;
 
-  gst_adapter_push (self->adapter, buffer);
+  if (self->pending) {
+    if (!self->newsegment_sent) {
+      GstSegment segment;
 
-  while (ret == GST_FLOW_OK) {
-    gint avail;
-    const guint8 *data;
+      if (self->caps)
+        gst_pad_set_caps (self->src_pad, self->caps);
+      gst_pcap_parse_init_segment (self, &segment);
+      gst_pad_push_event (self->src_pad, gst_event_new_segment (&segment));
+      self->newsegment_sent = TRUE;
+    }
 
-    avail = gst_adapter_available (self->adapter);
+    ret = gst_pad_push_list (self->src_pad, self->pending);
+    self->pending = NULL;
 
-    if (self->initialized) {
-      if (self->cur_packet_size >= 0) {
-        /* Parse the Packet Data */
-        if (avail < self->cur_packet_size)
-          break;
+    GST_OBJECT_LOCK (self);
+    ret = gst_flow_combiner_update_pad_flow (self->flow_combiner,
+        self->src_pad, ret);
+    GST_OBJECT_UNLOCK (self);
+  }
 
-        if (self->cur_packet_size > 0) {
-          const guint8 *payload_data;
-          gint payload_size;
-
-          data = gst_adapter_map (self->adapter, self->cur_packet_size);
-
-          GST_LOG_OBJECT (self, "examining packet size %" G_GINT64_FORMAT,
-              self->cur_packet_size);
-
-          if (gst_pcap_parse_scan_frame (self, data, self->cur_packet_size,
-                  &payload_data, &payload_size)) {
-            GstBuffer *out_buf;
-            guintptr offset = payload_data - data;
-
-            gst_adapter_unmap (self->adapter);
-            gst_adapter_flush (self->adapter, offset);
-            /* we don't use _take_buffer_fast() on purpose here, we need a
-             * buffer with a single memory, since the RTP depayloaders expect
-             * the complete RTP header to be in the first memory if there are
-             * multiple ones and we can't guarantee that with _fast() */
-            if (payload_size > 0) {
-              out_buf = gst_adapter_take_buffer (self->adapter, payload_size);
-            } else {
-              out_buf = gst_buffer_new ();
-            }
-            gst_adapter_flush (self->adapter,
-                self->cur_packet_size - offset - payload_size);
-
-            if (GST_CLOCK_TIME_IS_VALID (self->cur_ts)) {
-              if (!GST_CLOCK_TIME_IS_VALID (self->base_ts))
-                self->base_ts = self->cur_ts;
-              if (self->offset >= 0) {
-                self->cur_ts -= self->base_ts;
-                self->cur_ts += self->offset;
-              }
-            }
-            GST_BUFFER_TIMESTAMP (out_buf) = self->cur_ts;
-
-
-            if (list == NULL)
-              list = gst_buffer_list_new ();
-            gst_buffer_list_add (list, out_buf);
-          } else {
-            gst_adapter_unmap (self->adapter);
-            gst_adapter_flush (self->adapter, self->cur_packet_size);
-          }
-        }
-
-        self->cur_packet_size = -1;
-      } else {
-        /* Parse the Record (Packet) Header */
-        guint32 ts_sec;
-        guint32 ts_usec;
-        guint32 incl_len;
+  pushes = g_array_new (FALSE, FALSE, sizeof (GstPcapParsePush));
 
-        /* sizeof(pcaprec_hdr_t) == 16 */
-        if (avail < 16)
-          break;
+  GST_OBJECT_LOCK (self);
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    GstPcapParseFlow *flow = value;
+    GstPcapParsePush push;
+
+    if (flow->pending == NULL)
+      continue;
+
+    push.pad = gst_object_ref (flow->pad);
+    push.list = flow->pending;
+    push.start = !flow->newsegment_sent;
+    flow->pending = NULL;
+    flow->newsegment_sent = TRUE;
+    g_array_append_val (pushes, push);
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  for (i = 0; i < pushes->len; i++) {
+    GstPcapParsePush *push = &g_array_index (pushes, GstPcapParsePush, i);
+    GstFlowReturn flow_ret;
+
+    if (push->start)
+      gst_pcap_parse_start_flow_pad (self, push->pad);
+
+    flow_ret = gst_pad_push_list (push->pad, push->list);
+
+    GST_OBJECT_LOCK (self);
+    ret = gst_flow_combiner_update_pad_flow (self->flow_combiner, push->pad,
+        flow_ret);
+    GST_OBJECT_UNLOCK (self);
+
+    gst_object_unref (push->pad);
+  }
+
+  g_array_free (pushes, TRUE);
+
+  return ret;
+}
+
+static void
+gst_pcap_parse_push_eos (GstPcapParse * self)
+{
+  GArray *pushes;
+  GHashTableIter iter;
+  gpointer value;
+  guint i;
+
+  gst_pad_push_event (self->src_pad, gst_event_new_eos ());
+
+  pushes = g_array_new (FALSE, FALSE, sizeof (GstPcapParsePush));
+
+  GST_OBJECT_LOCK (self);
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    GstPcapParseFlow *flow = value;
+    GstPcapParsePush push;
+
+    /* requested pads might not have seen any data yet */
+    push.pad = gst_object_ref (flow->pad);
+    push.list = NULL;
+    push.start = !flow->newsegment_sent;
+    flow->newsegment_sent = TRUE;
+    g_array_append_val (pushes, push);
+  }
+  GST_OBJECT_UNLOCK (self);
 
-        data = gst_adapter_map (self->adapter, 16);
+  for (i = 0; i < pushes->len; i++) {
+    GstPcapParsePush *push = &g_array_index (pushes, GstPcapParsePush, i);
 
-        ts_sec = gst_pcap_parse_read_uint32 (self, data + 0);
-        ts_usec = gst_pcap_parse_read_uint32 (self, data + 4);
-        incl_len = gst_pcap_parse_read_uint32 (self, data + 8);
-        /* orig_len = gst_pcap_parse_read_uint32 (self, data + 12); */
+    if (push->start)
+      gst_pcap_parse_start_flow_pad (self, push->pad);
+    gst_pad_push_event (push->pad, gst_event_new_eos ());
+    gst_object_unref (push->pad);
+  }
+
+  g_array_free (pushes, TRUE);
+}
+
+static gboolean
+gst_pcap_parse_read_global_header (GstPcapParse * self, const guint8 * data)
+{
+  guint32 magic;
+  guint32 linktype;
+  guint16 major_version;
+
+  magic = *((guint32 *) data);
+  major_version = *((guint16 *) (data + 4));
+  linktype = *((guint32 *) (data + 20));
+
+  if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_NO_SWAP_ENDIAN ||
+      magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN) {
+    self->swap_endian = FALSE;
+    if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN)
+      self->nanosecond_timestamp = TRUE;
+  } else if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN ||
+      magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN) {
+    self->swap_endian = TRUE;
+    if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN)
+      self->nanosecond_timestamp = TRUE;
+    major_version = GUINT16_SWAP_LE_BE (major_version);
+    linktype = GUINT32_SWAP_LE_BE (linktype);
+  } else {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("File is not a libpcap file, magic is %X", magic));
+    return FALSE;
+  }
+
+  if (major_version != 2) {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("File is not a libpcap major version 2, but %u", major_version));
+    return FALSE;
+  }
+
+  if (linktype != LINKTYPE_ETHER && linktype != LINKTYPE_SLL &&
+      linktype != LINKTYPE_RAW) {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("Only dumps of type Ethernet, raw IP or Linux Cooked (SLL) "
+            "understood; type %d unknown", linktype));
+    return FALSE;
+  }
 
-        gst_adapter_unmap (self->adapter);
-        gst_adapter_flush (self->adapter, 16);
+  GST_DEBUG_OBJECT (self, "linktype %u", linktype);
+  self->linktype = linktype;
 
-        self->cur_ts =
-            ts_sec * GST_SECOND +
-            ts_usec * (self->nanosecond_timestamp ? 1 : GST_USECOND);
-        self->cur_packet_size = incl_len;
+  return TRUE;
+}
+
+/* Converts a timestamp in if_tsresol units to nanoseconds */
+static GstClockTime
+gst_pcap_parse_pcapng_timestamp (guint8 tsresol, guint64 ts)
+{
+  guint exp = tsresol & 0x7f;
+  guint64 scale = 1;
+  guint i;
+
+  if (tsresol & 0x80) {
+    if (exp > 63)
+      return GST_CLOCK_TIME_NONE;
+    return gst_util_uint64_scale (ts, GST_SECOND,
+        G_GUINT64_CONSTANT (1) << exp);
+  }
+
+  if (exp <= 9) {
+    for (i = exp; i < 9; i++)
+      scale *= 10;
+    return ts * scale;
+  }
+
+  if (exp > 19)
+    return GST_CLOCK_TIME_NONE;
+  for (i = 9; i < exp; i++)
+    scale *= 10;
+  return ts / scale;
+}
+
+static const GstPcapParseInterface *
+gst_pcap_parse_get_interface (GstPcapParse * self, guint32 id)
+{
+  if (id >= self->interfaces->len) {
+    GST_WARNING_OBJECT (self, "Packet for unknown interface %u", id);
+    return NULL;
+  }
+
+  return &g_array_index (self->interfaces, GstPcapParseInterface, id);
+}
+
+static void
+gst_pcap_parse_read_interface (GstPcapParse * self, const guint8 * data,
+    guint32 len)
+{
+  GstPcapParseInterface iface;
+  const guint8 *opt, *end;
+
+  iface.linktype = gst_pcap_parse_read_uint16 (self, data + 8);
+  iface.tsresol = PCAPNG_DEFAULT_TSRESOL;
+
+  /* options run up to the trailing block length */
+  opt = data + 16;
+  end = data + len - 4;
+  while (opt + 4 <= end) {
+    guint16 code = gst_pcap_parse_read_uint16 (self, opt);
+    guint16 opt_len = gst_pcap_parse_read_uint16 (self, opt + 2);
+
+    if (code == PCAPNG_OPT_ENDOFOPT || opt + 4 + opt_len > end)
+      break;
+    if (code == PCAPNG_OPT_IF_TSRESOL && opt_len >= 1)
+      iface.tsresol = opt[4];
+
+    opt += 4 + GST_ROUND_UP_4 (opt_len);
+  }
+
+  if (iface.linktype != LINKTYPE_ETHER && iface.linktype != LINKTYPE_SLL &&
+      iface.linktype != LINKTYPE_RAW)
+    GST_WARNING_OBJECT (self, "Ignoring packets of interface %u with "
+        "unknown link type %d", self->interfaces->len, iface.linktype);
+
+  GST_DEBUG_OBJECT (self, "interface %u linktype %u tsresol %u",
+      self->interfaces->len, iface.linktype, iface.tsresol);
+  g_array_append_val (self->interfaces, iface);
+}
+
+/* Handles one complete pcapng block of len bytes at data */
+static gboolean
+gst_pcap_parse_read_block (GstPcapParse * self, GstBuffer * block,
+    const guint8 * block_data, const guint8 * data, guint32 type, guint32 len)
+{
+  const GstPcapParseInterface *iface;
+  guint32 caplen;
+
+  switch (type) {
+    case PCAPNG_BLOCK_SHB:
+      if (len < 28 || gst_pcap_parse_read_uint16 (self, data + 12) != 1) {
+        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+            ("Unsupported pcapng section header"));
+        return FALSE;
       }
-    } else {
-      /* Parse the Global Header */
-      guint32 magic;
-      guint32 linktype;
-      guint16 major_version;
+      /* interface ids are per section */
+      g_array_set_size (self->interfaces, 0);
+      break;
+    case PCAPNG_BLOCK_IDB:
+      if (len < 20)
+        goto invalid;
+      gst_pcap_parse_read_interface (self, data, len);
+      break;
+    case PCAPNG_BLOCK_EPB:{
+      guint32 ts_high, ts_low;
+
+      if (len < 32)
+        goto invalid;
+      caplen = gst_pcap_parse_read_uint32 (self, data + 20);
+      if (caplen > len - 32)
+        goto invalid;
+      iface = gst_pcap_parse_get_interface (self,
+          gst_pcap_parse_read_uint32 (self, data + 8));
+      if (iface == NULL)
+        break;
 
-      /* sizeof(pcap_hdr_t) == 24 */
-      if (avail < 24)
+      ts_high = gst_pcap_parse_read_uint32 (self, data + 12);
+      ts_low = gst_pcap_parse_read_uint32 (self, data + 16);
+      self->cur_ts = gst_pcap_parse_pcapng_timestamp (iface->tsresol,
+          ((guint64) ts_high << 32) | ts_low);
+      self->linktype = iface->linktype;
+      gst_pcap_parse_add_packet (self, block, block_data, data + 28, caplen);
+      break;
+    }
+    case PCAPNG_BLOCK_SPB:
+      if (len < 16)
+        goto invalid;
+      iface = gst_pcap_parse_get_interface (self, 0);
+      if (iface == NULL)
         break;
 
-      data = gst_adapter_map (self->adapter, 24);
-
-      magic = *((guint32 *) data);
-      major_version = *((guint16 *) (data + 4));
-      linktype = *((guint32 *) (data + 20));
-      gst_adapter_unmap (self->adapter);
-
-      if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_NO_SWAP_ENDIAN ||
-          magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN) {
-        self->swap_endian = FALSE;
-        if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN)
-          self->nanosecond_timestamp = TRUE;
-      } else if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN ||
-          magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN) {
-        self->swap_endian = TRUE;
-        if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN)
-          self->nanosecond_timestamp = TRUE;
-        major_version = GUINT16_SWAP_LE_BE (major_version);
-        linktype = GUINT32_SWAP_LE_BE (linktype);
-      } else {
-        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
-            ("File is not a libpcap file, magic is %X", magic));
+      /* no timestamp here, keep the one of the previous packet */
+      caplen = MIN (gst_pcap_parse_read_uint32 (self, data + 8), len - 16);
+      self->linktype = iface->linktype;
+      gst_pcap_parse_add_packet (self, block, block_data, data + 12, caplen);
+      break;
+    default:
+      GST_LOG_OBJECT (self, "skipping block type 0x%08x", type);
+      break;
+  }
+
+  return TRUE;
+
+invalid:
+  GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+      ("Invalid pcapng block of type 0x%08x and length %u", type, len));
+  return FALSE;
+}
+
+static gboolean
+gst_pcap_parse_read_byte_order (GstPcapParse * self, const guint8 * data)
+{
+  guint32 magic = *((guint32 *) data);
+
+  if (magic == PCAPNG_BYTE_ORDER_MAGIC) {
+    self->swap_endian = FALSE;
+  } else if (magic == GUINT32_SWAP_LE_BE (PCAPNG_BYTE_ORDER_MAGIC)) {
+    self->swap_endian = TRUE;
+  } else {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("File is not a pcapng file, byte order magic is %X", magic));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Parses all complete records of block, a buffer with a single memory, and
+ * sets self->needed to the size of the first incomplete one */
+static GstFlowReturn
+gst_pcap_parse_process (GstPcapParse * self, GstBuffer * block,
+    gsize * consumed)
+{
+  GstFlowReturn ret = GST_FLOW_OK, push_ret;
+  GstMapInfo map;
+  gsize pos = 0;
+
+  if (!gst_buffer_map (block, &map, GST_MAP_READ)) {
+    GST_ELEMENT_ERROR (self, RESOURCE, READ, (NULL),
+        ("Failed to map input buffer"));
+    return GST_FLOW_ERROR;
+  }
+
+  self->needed = 0;
+
+  while (ret == GST_FLOW_OK) {
+    const guint8 *data = map.data + pos;
+    gsize avail = map.size - pos;
+
+    if (!self->initialized) {
+      /* a pcapng section header, or the pcap global header which is
+       * sizeof(pcap_hdr_t) == 24 */
+      if (avail < 4) {
+        self->needed = 4;
+        break;
+      }
+
+      if (*((guint32 *) data) == PCAPNG_BLOCK_SHB) {
+        GST_DEBUG_OBJECT (self, "pcapng file");
+        self->pcapng = TRUE;
+        self->initialized = TRUE;
+        continue;
+      }
+
+      if (avail < 24) {
+        self->needed = 24;
+        break;
+      }
+
+      if (!gst_pcap_parse_read_global_header (self, data)) {
         ret = GST_FLOW_ERROR;
-        goto out;
+        break;
       }
+      self->initialized = TRUE;
+      pos += 24;
+    } else if (self->pcapng) {
+      guint32 type, len;
 
-      if (major_version != 2) {
-        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
-            ("File is not a libpcap major version 2, but %u", major_version));
+      if (avail < 12) {
+        self->needed = 12;
+        break;
+      }
+
+      /* the section header type reads the same in both byte orders and
+       * tells the byte order of the rest of the section */
+      if (*((guint32 *) data) == PCAPNG_BLOCK_SHB &&
+          !gst_pcap_parse_read_byte_order (self, data + 8)) {
         ret = GST_FLOW_ERROR;
-        goto out;
+        break;
       }
 
-      if (linktype != LINKTYPE_ETHER && linktype != LINKTYPE_SLL &&
-          linktype != LINKTYPE_RAW) {
-        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
-            ("Only dumps of type Ethernet, raw IP or Linux Cooked (SLL) "
-                "understood; type %d unknown", linktype));
+      type = gst_pcap_parse_read_uint32 (self, data);
+      len = gst_pcap_parse_read_uint32 (self, data + 4);
+      if (len < 12 || len % 4 != 0) {
+        GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+            ("Invalid pcapng block length %u", len));
         ret = GST_FLOW_ERROR;
-        goto out;
+        break;
       }
 
-      GST_DEBUG_OBJECT (self, "linktype %u", linktype);
-      self->linktype = linktype;
+      if (avail < len) {
+        self->needed = len;
+        break;
+      }
 
-      gst_adapter_flush (self->adapter, 24);
-      self->initialized = TRUE;
+      if (!gst_pcap_parse_read_block (self, block, map.data, data, type, len)) {
+        ret = GST_FLOW_ERROR;
+        break;
+      }
+      pos += len;
+    } else {
+      /* Parse the Record (Packet) Header, sizeof(pcaprec_hdr_t) == 16 */
+      guint32 ts_sec;
+      guint32 ts_usec;
+      guint32 incl_len;
+
+      if (avail < 16) {
+        self->needed = 16;
+        break;
+      }
+
+      incl_len = gst_pcap_parse_read_uint32 (self, data + 8);
+      if (avail - 16 < incl_len) {
+        self->needed = (gsize) incl_len + 16;
+        break;
+      }
+
+      ts_sec = gst_pcap_parse_read_uint32 (self, data + 0);
+      ts_usec = gst_pcap_parse_read_uint32 (self, data + 4);
+      /* orig_len = gst_pcap_parse_read_uint32 (self, data + 12); */
+
+      self->cur_ts =
+          ts_sec * GST_SECOND +
+          ts_usec * (self->nanosecond_timestamp ? 1 : GST_USECOND);
+      gst_pcap_parse_add_packet (self, block, map.data, data + 16, incl_len);
+      pos += 16 + incl_len;
     }
   }
 
-  if (list) {
-    if (!self->newsegment_sent && GST_CLOCK_TIME_IS_VALID (self->cur_ts)) {
-      GstSegment segment;
+  gst_buffer_unmap (block, &map);
+  *consumed = pos;
 
-      if (self->caps)
-        gst_pad_set_caps (self->src_pad, self->caps);
-      gst_segment_init (&segment, GST_FORMAT_TIME);
-      segment.start = self->base_ts;
-      gst_pad_push_event (self->src_pad, gst_event_new_segment (&segment));
-      self->newsegment_sent = TRUE;
+  /* push what was parsed before an error, too */
+  push_ret = gst_pcap_parse_push_pending (self);
+  if (ret == GST_FLOW_OK)
+    ret = push_ret;
+
+  return ret;
+}
+
+/* Parses buffer together with whatever was left over from the previous ones.
+ * Only a record split across two buffers gets copied, everything else is
+ * handed out as subbuffers of the input. */
+static GstFlowReturn
+gst_pcap_parse_handle_data (GstPcapParse * self, GstBuffer * buffer)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  while (ret == GST_FLOW_OK) {
+    GstBuffer *block;
+    gsize size, consumed;
+
+    if (self->leftover == NULL) {
+      if (buffer == NULL)
+        break;
+      block = buffer;
+      buffer = NULL;
+    } else if (buffer == NULL) {
+      break;
+    } else {
+      gsize leftover_size = gst_buffer_get_size (self->leftover);
+      gsize missing = self->needed - leftover_size;
+
+      if (gst_buffer_get_size (buffer) <= missing) {
+        self->leftover = gst_buffer_append (self->leftover, buffer);
+        buffer = NULL;
+        if (leftover_size + missing > gst_buffer_get_size (self->leftover))
+          break;
+      } else {
+        GstBuffer *head, *rest;
+
+        head = gst_buffer_copy_region (buffer, GST_BUFFER_COPY_MEMORY, 0,
+            missing);
+        rest = gst_buffer_copy_region (buffer, GST_BUFFER_COPY_MEMORY,
+            missing, -1);
+        gst_buffer_unref (buffer);
+        buffer = rest;
+        self->leftover = gst_buffer_append (self->leftover, head);
+      }
+      block = self->leftover;
+      self->leftover = NULL;
     }
 
-    ret = gst_pad_push_list (self->src_pad, list);
-    list = NULL;
-  }
+    if (gst_buffer_n_memory (block) > 1) {
+      GstBuffer *merged = gst_buffer_new ();
+
+      gst_buffer_append_memory (merged, gst_buffer_get_all_memory (block));
+      gst_buffer_unref (block);
+      block = merged;
+    }
 
-out:
+    size = gst_buffer_get_size (block);
+    ret = gst_pcap_parse_process (self, block, &consumed);
+    /* nothing is needed after a parse error, don't keep what's left of
+     * the block as the start of a record */
+    if (consumed < size && self->needed > size - consumed)
+      self->leftover = gst_buffer_copy_region (block, GST_BUFFER_COPY_MEMORY,
+          consumed, size - consumed);
+    gst_buffer_unref (block);
+  }
 
-  if (list)
-    gst_buffer_list_unref (list);
+  if (buffer)
+    gst_buffer_unref (buffer);
 
   return ret;
 }
 
+static GstFlowReturn
+gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (parent);
+
+  return gst_pcap_parse_handle_data (self, buffer);
+}
+
+static void
+gst_pcap_parse_loop (GstPad * pad)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (GST_PAD_PARENT (pad));
+  GstBuffer *buffer = NULL;
+  GstFlowReturn ret;
+
+  /* nothing upstream sends one in pull mode */
+  if (!self->stream_start_sent) {
+    gchar *stream_id;
+
+    stream_id = gst_pad_create_stream_id (self->src_pad,
+        GST_ELEMENT_CAST (self), NULL);
+    gst_pad_push_event (self->src_pad, gst_event_new_stream_start (stream_id));
+    g_free (stream_id);
+    self->stream_start_sent = TRUE;
+  }
+
+  ret = gst_pad_pull_range (pad, self->pull_offset, PULL_BLOCK_SIZE, &buffer);
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  self->pull_offset += gst_buffer_get_size (buffer);
+  ret = gst_pcap_parse_handle_data (self, buffer);
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  return;
+
+pause:
+  GST_DEBUG_OBJECT (self, "pausing task, reason %s", gst_flow_get_name (ret));
+  gst_pad_pause_task (pad);
+
+  if (ret == GST_FLOW_EOS) {
+    if (self->leftover)
+      GST_WARNING_OBJECT (self, "Dropping %" G_GSIZE_FORMAT " bytes of "
+          "truncated record", gst_buffer_get_size (self->leftover));
+    gst_pcap_parse_push_eos (self);
+  } else if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS) {
+    GST_ELEMENT_FLOW_ERROR (self, ret);
+    gst_pcap_parse_push_eos (self);
+  }
+}
+
+static gboolean
+gst_pcap_parse_sink_activate (GstPad * sinkpad, GstObject * parent)
+{
+  GstQuery *query;
+  gboolean pull_mode;
+
+  query = gst_query_new_scheduling ();
+
+  if (!gst_pad_peer_query (sinkpad, query)) {
+    gst_query_unref (query);
+    goto activate_push;
+  }
+
+  pull_mode = gst_query_has_scheduling_mode_with_flags (query,
+      GST_PAD_MODE_PULL, GST_SCHEDULING_FLAG_SEEKABLE);
+  gst_query_unref (query);
+
+  if (!pull_mode)
+    goto activate_push;
+
+  GST_DEBUG_OBJECT (sinkpad, "activating pull");
+  return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PULL, TRUE);
+
+activate_push:
+  GST_DEBUG_OBJECT (sinkpad, "activating push");
+  return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, TRUE);
+}
+
+static gboolean
+gst_pcap_parse_sink_activate_mode (GstPad * sinkpad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (parent);
+  gboolean res;
+
+  switch (mode) {
+    case GST_PAD_MODE_PUSH:
+      self->pull_mode = FALSE;
+      res = TRUE;
+      break;
+    case GST_PAD_MODE_PULL:
+      if (active) {
+        self->pull_mode = TRUE;
+        self->pull_offset = 0;
+        res = gst_pad_start_task (sinkpad,
+            (GstTaskFunction) gst_pcap_parse_loop, sinkpad, NULL);
+      } else {
+        res = gst_pad_stop_task (sinkpad);
+      }
+      break;
+    default:
+      res = FALSE;
+      break;
+  }
+
+  return res;
+}
+
 static gboolean
 gst_pcap_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -679,10 +1546,19 @@ gst_pcap_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       /* Drop it, we'll replace it with our own */
       gst_event_unref (event);
       break;
+    case GST_EVENT_EOS:
+      /* flow pads start their own streams */
+      gst_event_unref (event);
+      gst_pcap_parse_push_eos (self);
+      break;
+    case GST_EVENT_FLUSH_START:
+      ret = gst_pad_event_default (pad, parent, event);
+      break;
     case GST_EVENT_FLUSH_STOP:
       gst_pcap_parse_reset (self);
       /* Push event down the pipeline so that other elements stop flushing */
-      /* fall through */
+      ret = gst_pad_event_default (pad, parent, event);
+      break;
     default:
       ret = gst_pad_push_event (self->src_pad, event);
       break;
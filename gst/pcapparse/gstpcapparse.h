@@ -21,7 +21,7 @@
 #define __GST_PCAP_PARSE_H__
 
 #include <gst/gst.h>
-#include <gst/base/gstadapter.h>
+#include <gst/base/gstflowcombiner.h>
 
 G_BEGIN_DECLS
 
@@ -52,6 +52,32 @@ typedef enum
   LINKTYPE_SLL = 113
 } GstPcapParseLinktype;
 
+/* Identifies one flow, zero-initialised so it can be hashed bytewise */
+typedef struct
+{
+  guint32 src_ip;
+  guint32 dst_ip;
+  guint16 src_port;
+  guint16 dst_port;
+  guint8 proto;
+  guint8 padding[3];
+} GstPcapParseFlowKey;
+
+typedef struct
+{
+  GstPcapParseFlowKey key;
+  GstPad *pad;
+  GstBufferList *pending;
+  gboolean newsegment_sent;
+} GstPcapParseFlow;
+
+/* pcapng keeps the link type and timestamp resolution per interface */
+typedef struct
+{
+  GstPcapParseLinktype linktype;
+  guint8 tsresol;
+} GstPcapParseInterface;
+
 /**
  * GstPcapParse:
  *
@@ -73,9 +99,11 @@ struct _GstPcapParse
   gint32 dst_port;
   GstCaps *caps;
   gint64 offset;
+  gboolean split_flows;
 
   /* state */
-  GstAdapter * adapter;
+  /* unparsed tail of the data seen so far */
+  GstBuffer * leftover;
   gboolean initialized;
   gboolean swap_endian;
   gboolean nanosecond_timestamp;
@@ -84,6 +112,24 @@ struct _GstPcapParse
   GstClockTime base_ts;
   GstPcapParseLinktype linktype;
 
+  /* pcapng sections */
+  gboolean pcapng;
+  GArray *interfaces;
+
+  /* bytes needed before the next record can be parsed */
+  gsize needed;
+
+  /* pull mode */
+  gboolean pull_mode;
+  guint64 pull_offset;
+  gboolean stream_start_sent;
+
+  /* GstPcapParseFlowKey -> GstPcapParseFlow, protected by the sink pad
+   * stream lock */
+  GHashTable *flows;
+  GstFlowCombiner *flow_combiner;
+  GstBufferList *pending;
+
   gboolean newsegment_sent;
 };
 
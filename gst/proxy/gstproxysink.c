@@ -30,6 +30,16 @@
  *
  * This element also copies sticky events onto the matching proxysrc element.
  *
+ * By default buffers are pushed into proxysrc from the streaming thread of
+ * the proxysink pipeline, so a downstream pipeline that blocks also blocks
+ * the upstream one. Setting #GstProxySink:max-size-buffers,
+ * #GstProxySink:max-size-bytes or #GstProxySink:max-size-time puts a bounded
+ * queue in front of proxysrc that is emptied by a thread of its own. Once it
+ * is full, upstream waits for space or, depending on #GstProxySink:leaky, new
+ * or old buffers are dropped. How long pushes into the other pipeline took,
+ * how long buffers waited in the queue and how long upstream was blocked is
+ * reported by the #GstProxySink:stats property in both modes.
+ *
  * For example usage, see proxysrc.
  */
 
@@ -48,6 +58,51 @@ static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS_ANY);
 
+#define DEFAULT_MAX_SIZE_BUFFERS 0
+#define DEFAULT_MAX_SIZE_BYTES 0
+#define DEFAULT_MAX_SIZE_TIME 0
+#define DEFAULT_LEAKY GST_PROXY_SINK_LEAKY_NONE
+
+enum
+{
+  PROP_0,
+  PROP_MAX_SIZE_BUFFERS,
+  PROP_MAX_SIZE_BYTES,
+  PROP_MAX_SIZE_TIME,
+  PROP_LEAKY,
+  PROP_STATS
+};
+
+#define GST_TYPE_PROXY_SINK_LEAKY (gst_proxy_sink_leaky_get_type ())
+static GType
+gst_proxy_sink_leaky_get_type (void)
+{
+  static GType leaky_type = 0;
+  static const GEnumValue leaky[] = {
+    {GST_PROXY_SINK_LEAKY_NONE, "Not Leaky", "no"},
+    {GST_PROXY_SINK_LEAKY_UPSTREAM, "Leaky on upstream (new buffers)",
+        "upstream"},
+    {GST_PROXY_SINK_LEAKY_DOWNSTREAM, "Leaky on downstream (old buffers)",
+        "downstream"},
+    {0, NULL, NULL},
+  };
+
+  if (!leaky_type) {
+    leaky_type = g_enum_register_static ("GstProxySinkLeaky", leaky);
+  }
+  return leaky_type;
+}
+
+/* An item of the hand-off queue; a buffer, buffer list or serialized event */
+typedef struct
+{
+  GstMiniObject *object;
+  guint n_buffers;
+  gsize n_bytes;
+  GstClockTime duration;
+  GstClockTime enqueued;
+} GstProxySinkItem;
+
 /* We're not subclassing from basesink because we don't want any of the special
  * handling it has for events/queries/etc. We just pass-through everything. */
 
@@ -63,17 +118,97 @@ static GstFlowReturn gst_proxy_sink_sink_chain_list (GstPad * pad,
     GstObject * parent, GstBufferList * list);
 static gboolean gst_proxy_sink_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
+static gboolean gst_proxy_sink_push_event (GstProxySink * self,
+    GstEvent * event);
 
 static GstStateChangeReturn gst_proxy_sink_change_state (GstElement * element,
     GstStateChange transition);
+static void gst_proxy_sink_finalize (GObject * object);
+static void gst_proxy_sink_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_proxy_sink_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+
+static void gst_proxy_sink_loop (GstProxySink * self);
 
 static void
 gst_proxy_sink_class_init (GstProxySinkClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
   GstElementClass *gstelement_class = (GstElementClass *) klass;
 
   GST_DEBUG_CATEGORY_INIT (gst_proxy_sink_debug, "proxysink", 0, "proxy sink");
 
+  gobject_class->finalize = gst_proxy_sink_finalize;
+  gobject_class->get_property = gst_proxy_sink_get_property;
+  gobject_class->set_property = gst_proxy_sink_set_property;
+
+  /**
+   * GstProxySink:max-size-buffers:
+   *
+   * Maximum number of buffers queued in front of proxysrc. If all limits
+   * are 0, buffers are pushed into proxysrc directly from the streaming
+   * thread.
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_SIZE_BUFFERS,
+      g_param_spec_uint ("max-size-buffers", "Max. size (buffers)",
+          "Max. number of buffers queued for proxysrc (0 = no limit)",
+          0, G_MAXUINT, DEFAULT_MAX_SIZE_BUFFERS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+  /**
+   * GstProxySink:max-size-bytes:
+   *
+   * Maximum number of bytes queued in front of proxysrc. If all limits are
+   * 0, buffers are pushed into proxysrc directly from the streaming thread.
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_SIZE_BYTES,
+      g_param_spec_uint ("max-size-bytes", "Max. size (bytes)",
+          "Max. amount of data queued for proxysrc (bytes, 0 = no limit)",
+          0, G_MAXUINT, DEFAULT_MAX_SIZE_BYTES,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+  /**
+   * GstProxySink:max-size-time:
+   *
+   * Maximum duration of the buffers queued in front of proxysrc. Buffers
+   * without a duration count for the distance of their timestamp to the one
+   * of the buffer queued before, buffers without either don't count, so
+   * also set #GstProxySink:max-size-buffers or #GstProxySink:max-size-bytes
+   * for such streams. If all limits are 0, buffers are pushed into proxysrc
+   * directly from the streaming thread.
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_SIZE_TIME,
+      g_param_spec_uint64 ("max-size-time", "Max. size (ns)",
+          "Max. amount of data queued for proxysrc (in ns, 0 = no limit)",
+          0, G_MAXUINT64, DEFAULT_MAX_SIZE_TIME,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+  /**
+   * GstProxySink:leaky:
+   *
+   * What to do when the queue in front of proxysrc is full: block upstream,
+   * drop the new buffers or drop the oldest queued buffers. Events are
+   * never dropped.
+   */
+  g_object_class_install_property (gobject_class, PROP_LEAKY,
+      g_param_spec_enum ("leaky", "Leaky",
+          "Where the queue leaks, if at all", GST_TYPE_PROXY_SINK_LEAKY,
+          DEFAULT_LEAKY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstProxySink:stats:
+   *
+   * Statistics about the hand-off to proxysrc. push-time and max-push-time
+   * are the time spent pushing into the proxysrc pipeline, blocked-time the
+   * time upstream waited for space in the queue and average-latency and
+   * max-latency the time buffers spent in the queue. All times are in
+   * nanoseconds.
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Statistics about the hand-off to proxysrc", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = gst_proxy_sink_change_state;
 
   gst_element_class_add_pad_template (gstelement_class,
@@ -97,6 +232,174 @@ gst_proxy_sink_init (GstProxySink * self)
   gst_pad_set_query_function (self->sinkpad,
       GST_DEBUG_FUNCPTR (gst_proxy_sink_sink_query));
   gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->max_size_buffers = DEFAULT_MAX_SIZE_BUFFERS;
+  self->max_size_bytes = DEFAULT_MAX_SIZE_BYTES;
+  self->max_size_time = DEFAULT_MAX_SIZE_TIME;
+  self->leaky = DEFAULT_LEAKY;
+
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->item_add);
+  g_cond_init (&self->item_del);
+  g_queue_init (&self->queue);
+  self->flushing = TRUE;
+
+  /* Not a pad task: the sinkpad's stream lock is held by upstream while it
+   * waits for space in the queue */
+  g_rec_mutex_init (&self->task_lock);
+  self->task = gst_task_new ((GstTaskFunction) gst_proxy_sink_loop, self,
+      NULL);
+  gst_task_set_lock (self->task, &self->task_lock);
+}
+
+static void
+gst_proxy_sink_item_free (GstProxySinkItem * item)
+{
+  gst_mini_object_unref (item->object);
+  g_slice_free (GstProxySinkItem, item);
+}
+
+/* With lock */
+static void
+gst_proxy_sink_flush_queue (GstProxySink * self)
+{
+  GstProxySinkItem *item;
+
+  while ((item = g_queue_pop_head (&self->queue)))
+    gst_proxy_sink_item_free (item);
+  self->cur_level_buffers = 0;
+  self->cur_level_bytes = 0;
+  self->cur_level_time = 0;
+  self->last_pts = GST_CLOCK_TIME_NONE;
+  g_cond_broadcast (&self->item_del);
+}
+
+static void
+gst_proxy_sink_finalize (GObject * object)
+{
+  GstProxySink *self = GST_PROXY_SINK (object);
+
+  gst_proxy_sink_flush_queue (self);
+  gst_object_unref (self->task);
+  g_rec_mutex_clear (&self->task_lock);
+  g_cond_clear (&self->item_add);
+  g_cond_clear (&self->item_del);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static GstStructure *
+gst_proxy_sink_get_stats (GstProxySink * self)
+{
+  GstStructure *s;
+
+  g_mutex_lock (&self->lock);
+  s = gst_structure_new ("application/x-proxy-sink-stats",
+      "buffers-pushed", G_TYPE_UINT64, self->buffers_pushed,
+      "buffers-dropped", G_TYPE_UINT64, self->buffers_dropped,
+      "current-level-buffers", G_TYPE_UINT, self->cur_level_buffers,
+      "current-level-bytes", G_TYPE_UINT64, (guint64) self->cur_level_bytes,
+      "current-level-time", G_TYPE_UINT64, self->cur_level_time,
+      "max-level-buffers", G_TYPE_UINT, self->max_level_buffers,
+      "push-time", G_TYPE_UINT64, self->push_time,
+      "max-push-time", G_TYPE_UINT64, self->max_push_time,
+      "blocked-time", G_TYPE_UINT64, self->blocked_time,
+      "average-latency", G_TYPE_UINT64, self->latency_count ?
+      self->total_latency / self->latency_count : (guint64) 0,
+      "max-latency", G_TYPE_UINT64, self->max_latency, NULL);
+  g_mutex_unlock (&self->lock);
+
+  return s;
+}
+
+static void
+gst_proxy_sink_reset_stats (GstProxySink * self)
+{
+  g_mutex_lock (&self->lock);
+  self->buffers_pushed = 0;
+  self->buffers_dropped = 0;
+  self->max_level_buffers = 0;
+  self->push_time = 0;
+  self->max_push_time = 0;
+  self->blocked_time = 0;
+  self->total_latency = 0;
+  self->max_latency = 0;
+  self->latency_count = 0;
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+gst_proxy_sink_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstProxySink *self = GST_PROXY_SINK (object);
+
+  switch (prop_id) {
+    case PROP_MAX_SIZE_BUFFERS:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->max_size_buffers);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MAX_SIZE_BYTES:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->max_size_bytes);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MAX_SIZE_TIME:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint64 (value, self->max_size_time);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_LEAKY:
+      g_mutex_lock (&self->lock);
+      g_value_set_enum (value, self->leaky);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_proxy_sink_get_stats (self));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_proxy_sink_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstProxySink *self = GST_PROXY_SINK (object);
+
+  switch (prop_id) {
+    case PROP_MAX_SIZE_BUFFERS:
+      g_mutex_lock (&self->lock);
+      self->max_size_buffers = g_value_get_uint (value);
+      g_cond_broadcast (&self->item_del);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MAX_SIZE_BYTES:
+      g_mutex_lock (&self->lock);
+      self->max_size_bytes = g_value_get_uint (value);
+      g_cond_broadcast (&self->item_del);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MAX_SIZE_TIME:
+      g_mutex_lock (&self->lock);
+      self->max_size_time = g_value_get_uint64 (value);
+      g_cond_broadcast (&self->item_del);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_LEAKY:
+      g_mutex_lock (&self->lock);
+      self->leaky = g_value_get_enum (value);
+      g_cond_broadcast (&self->item_del);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 static GstStateChangeReturn
@@ -106,10 +409,33 @@ gst_proxy_sink_change_state (GstElement * element, GstStateChange transition)
       GST_ELEMENT_CLASS (gst_proxy_sink_parent_class);
   GstProxySink *self = GST_PROXY_SINK (element);
   GstStateChangeReturn ret;
+  gboolean unblock = FALSE;
 
   switch (transition) {
     case GST_STATE_CHANGE_READY_TO_PAUSED:
       self->pending_sticky_events = FALSE;
+      gst_proxy_sink_reset_stats (self);
+      g_mutex_lock (&self->lock);
+      self->queued = self->max_size_buffers > 0 || self->max_size_bytes > 0
+          || self->max_size_time > 0;
+      self->last_pts = GST_CLOCK_TIME_NONE;
+      self->flushing = FALSE;
+      g_mutex_unlock (&self->lock);
+      if (self->queued) {
+        GST_DEBUG_OBJECT (self, "Starting hand-off thread");
+        gst_task_start (self->task);
+      }
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* Wake up upstream if it waits for space in the queue, so that the
+       * sinkpad can be deactivated */
+      g_mutex_lock (&self->lock);
+      self->flushing = TRUE;
+      gst_proxy_sink_flush_queue (self);
+      g_cond_broadcast (&self->item_add);
+      /* busy can't become TRUE anymore once flushing is set */
+      unblock = self->busy;
+      g_mutex_unlock (&self->lock);
       break;
     default:
       break;
@@ -117,6 +443,60 @@ gst_proxy_sink_change_state (GstElement * element, GstStateChange transition)
 
   ret = gstelement_class->change_state (element, transition);
 
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_task_stop (self->task);
+      /* The hand-off thread may be blocked in a push into the proxysrc
+       * pipeline, flush that to let it return before joining */
+      if (unblock) {
+        GST_DEBUG_OBJECT (self, "Unblocking hand-off thread");
+        gst_proxy_sink_push_event (self, gst_event_new_flush_start ());
+      }
+      gst_task_join (self->task);
+      if (unblock)
+        gst_proxy_sink_push_event (self, gst_event_new_flush_stop (TRUE));
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+/* With lock */
+static gboolean
+gst_proxy_sink_is_full (GstProxySink * self)
+{
+  return (self->max_size_buffers > 0 &&
+      self->cur_level_buffers >= self->max_size_buffers) ||
+      (self->max_size_bytes > 0 &&
+      self->cur_level_bytes >= self->max_size_bytes) ||
+      (self->max_size_time > 0 && self->cur_level_time >= self->max_size_time);
+}
+
+/* With lock */
+static void
+gst_proxy_sink_record_push (GstProxySink * self, guint n_buffers,
+    GstClockTime elapsed)
+{
+  self->buffers_pushed += n_buffers;
+  self->push_time += elapsed;
+  if (elapsed > self->max_push_time)
+    self->max_push_time = elapsed;
+}
+
+/* Waits until everything queued so far was pushed into proxysrc */
+static gboolean
+gst_proxy_sink_drain (GstProxySink * self)
+{
+  gboolean ret;
+
+  g_mutex_lock (&self->lock);
+  while (!self->flushing && (self->busy || !g_queue_is_empty (&self->queue)))
+    g_cond_wait (&self->item_del, &self->lock);
+  ret = !self->flushing;
+  g_mutex_unlock (&self->lock);
+
   return ret;
 }
 
@@ -130,6 +510,12 @@ gst_proxy_sink_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
   GST_LOG_OBJECT (pad, "Handling query of type '%s'",
       gst_query_type_get_name (GST_QUERY_TYPE (query)));
 
+  /* Serialized queries have to be answered after the data before them
+   * reached proxysrc */
+  if (GST_QUERY_IS_SERIALIZED (query) && self->queued &&
+      !gst_proxy_sink_drain (self))
+    return FALSE;
+
   src = g_weak_ref_get (&self->proxysrc);
   if (src) {
     GstPad *srcpad;
@@ -161,18 +547,12 @@ copy_sticky_events (G_GNUC_UNUSED GstPad * pad, GstEvent ** event,
 }
 
 static gboolean
-gst_proxy_sink_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+gst_proxy_sink_push_event (GstProxySink * self, GstEvent * event)
 {
-  GstProxySink *self = GST_PROXY_SINK (parent);
   GstProxySrc *src;
   gboolean ret = FALSE;
   gboolean sticky = GST_EVENT_IS_STICKY (event);
 
-  GST_LOG_OBJECT (pad, "Got %s event", GST_EVENT_TYPE_NAME (event));
-
-  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP)
-    self->pending_sticky_events = FALSE;
-
   src = g_weak_ref_get (&self->proxysrc);
   if (src) {
     GstPad *srcpad;
@@ -181,7 +561,7 @@ gst_proxy_sink_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
     if (sticky && self->pending_sticky_events) {
       CopyStickyEventsData data = { srcpad, GST_FLOW_OK };
 
-      gst_pad_sticky_events_foreach (pad, copy_sticky_events, &data);
+      gst_pad_sticky_events_foreach (self->sinkpad, copy_sticky_events, &data);
       self->pending_sticky_events = data.ret != GST_FLOW_OK;
     }
 
@@ -199,14 +579,14 @@ gst_proxy_sink_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return ret;
 }
 
+/* Pushes a buffer or buffer list into proxysrc */
 static GstFlowReturn
-gst_proxy_sink_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_proxy_sink_push_data (GstProxySink * self, GstMiniObject * data,
+    guint n_buffers)
 {
-  GstProxySink *self = GST_PROXY_SINK (parent);
   GstProxySrc *src;
   GstFlowReturn ret = GST_FLOW_OK;
-
-  GST_LOG_OBJECT (pad, "Chaining buffer %p", buffer);
+  GstClockTime start, elapsed;
 
   src = g_weak_ref_get (&self->proxysrc);
   if (src) {
@@ -216,21 +596,245 @@ gst_proxy_sink_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     if (self->pending_sticky_events) {
       CopyStickyEventsData data = { srcpad, GST_FLOW_OK };
 
-      gst_pad_sticky_events_foreach (pad, copy_sticky_events, &data);
+      gst_pad_sticky_events_foreach (self->sinkpad, copy_sticky_events, &data);
       self->pending_sticky_events = data.ret != GST_FLOW_OK;
     }
 
-    ret = gst_pad_push (srcpad, buffer);
+    start = gst_util_get_timestamp ();
+    if (GST_IS_BUFFER (data))
+      ret = gst_pad_push (srcpad, GST_BUFFER_CAST (data));
+    else
+      ret = gst_pad_push_list (srcpad, GST_BUFFER_LIST_CAST (data));
+    elapsed = gst_util_get_timestamp () - start;
     gst_object_unref (srcpad);
     gst_object_unref (src);
 
-    GST_LOG_OBJECT (pad, "Chained buffer %p: %s", buffer,
-        gst_flow_get_name (ret));
+    g_mutex_lock (&self->lock);
+    gst_proxy_sink_record_push (self, n_buffers, elapsed);
+    g_mutex_unlock (&self->lock);
+
+    GST_LOG_OBJECT (self, "Pushed %p in %" GST_TIME_FORMAT ": %s", data,
+        GST_TIME_ARGS (elapsed), gst_flow_get_name (ret));
   } else {
-    gst_buffer_unref (buffer);
-    GST_LOG_OBJECT (pad, "Dropped buffer %p: no otherpad", buffer);
+    gst_mini_object_unref (data);
+    GST_LOG_OBJECT (self, "Dropped %p: no otherpad", data);
+  }
+
+  return ret;
+}
+
+/* With lock. Drops the oldest queued buffer or buffer list, events stay */
+static gboolean
+gst_proxy_sink_drop_oldest (GstProxySink * self)
+{
+  GList *l;
+
+  for (l = self->queue.head; l; l = l->next) {
+    GstProxySinkItem *item = l->data;
+
+    if (item->n_buffers == 0)
+      continue;
+
+    GST_LOG_OBJECT (self, "Queue full, dropping old %p", item->object);
+    self->cur_level_buffers -= item->n_buffers;
+    self->cur_level_bytes -= item->n_bytes;
+    self->cur_level_time -= item->duration;
+    self->buffers_dropped += item->n_buffers;
+    g_queue_delete_link (&self->queue, l);
+    gst_proxy_sink_item_free (item);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* Queues a buffer, buffer list or serialized event for the hand-off thread.
+ * @duration is GST_CLOCK_TIME_NONE if the buffers have none, @pts is the one
+ * of the last buffer. Takes ownership of @object */
+static GstFlowReturn
+gst_proxy_sink_enqueue (GstProxySink * self, GstMiniObject * object,
+    guint n_buffers, gsize n_bytes, GstClockTime duration, GstClockTime pts)
+{
+  GstProxySinkItem *item;
+  GstClockTime start;
+
+  g_mutex_lock (&self->lock);
+  if (self->flushing)
+    goto flushing;
+
+  /* Only data counts towards the limits */
+  while (n_buffers > 0 && gst_proxy_sink_is_full (self)) {
+    if (self->leaky == GST_PROXY_SINK_LEAKY_UPSTREAM) {
+      GST_LOG_OBJECT (self, "Queue full, dropping new %p", object);
+      self->buffers_dropped += n_buffers;
+      g_mutex_unlock (&self->lock);
+      gst_mini_object_unref (object);
+      return GST_FLOW_OK;
+    }
+
+    if (self->leaky == GST_PROXY_SINK_LEAKY_DOWNSTREAM &&
+        gst_proxy_sink_drop_oldest (self))
+      continue;
+
+    GST_LOG_OBJECT (self, "Queue full, waiting for space");
+    start = gst_util_get_timestamp ();
+    g_cond_wait (&self->item_del, &self->lock);
+    self->blocked_time += gst_util_get_timestamp () - start;
+    if (self->flushing)
+      goto flushing;
+  }
+
+  /* Without a duration, the distance to the previous buffer is the best
+   * guess of how much time the buffer covers */
+  if (!GST_CLOCK_TIME_IS_VALID (duration)) {
+    duration = 0;
+    if (GST_CLOCK_TIME_IS_VALID (pts)
+        && GST_CLOCK_TIME_IS_VALID (self->last_pts) && pts > self->last_pts)
+      duration = pts - self->last_pts;
+  }
+  if (GST_CLOCK_TIME_IS_VALID (pts))
+    self->last_pts = pts;
+
+  item = g_slice_new (GstProxySinkItem);
+  item->object = object;
+  item->n_buffers = n_buffers;
+  item->n_bytes = n_bytes;
+  item->duration = duration;
+  item->enqueued = gst_util_get_timestamp ();
+  g_queue_push_tail (&self->queue, item);
+
+  self->cur_level_buffers += n_buffers;
+  self->cur_level_bytes += n_bytes;
+  self->cur_level_time += duration;
+  if (self->cur_level_buffers > self->max_level_buffers)
+    self->max_level_buffers = self->cur_level_buffers;
+
+  g_cond_signal (&self->item_add);
+  g_mutex_unlock (&self->lock);
+
+  return GST_FLOW_OK;
+
+flushing:
+  {
+    GST_LOG_OBJECT (self, "Flushing, dropping %p", object);
+    g_mutex_unlock (&self->lock);
+    gst_mini_object_unref (object);
+    return GST_FLOW_FLUSHING;
+  }
+}
+
+static void
+gst_proxy_sink_loop (GstProxySink * self)
+{
+  GstProxySinkItem *item;
+  GstClockTime latency;
+
+  g_mutex_lock (&self->lock);
+  while (!self->flushing && g_queue_is_empty (&self->queue))
+    g_cond_wait (&self->item_add, &self->lock);
+
+  if (self->flushing) {
+    g_mutex_unlock (&self->lock);
+    GST_DEBUG_OBJECT (self, "Flushing, pausing hand-off thread");
+    gst_task_pause (self->task);
+    return;
+  }
+
+  item = g_queue_pop_head (&self->queue);
+  self->cur_level_buffers -= item->n_buffers;
+  self->cur_level_bytes -= item->n_bytes;
+  self->cur_level_time -= item->duration;
+  self->busy = TRUE;
+  if (item->n_buffers > 0) {
+    latency = gst_util_get_timestamp () - item->enqueued;
+    self->total_latency += latency;
+    self->latency_count++;
+    if (latency > self->max_latency)
+      self->max_latency = latency;
+  }
+  g_cond_broadcast (&self->item_del);
+  g_mutex_unlock (&self->lock);
+
+  if (GST_IS_EVENT (item->object))
+    gst_proxy_sink_push_event (self, GST_EVENT_CAST (item->object));
+  else
+    gst_proxy_sink_push_data (self, item->object, item->n_buffers);
+  g_slice_free (GstProxySinkItem, item);
+
+  g_mutex_lock (&self->lock);
+  self->busy = FALSE;
+  g_cond_broadcast (&self->item_del);
+  g_mutex_unlock (&self->lock);
+}
+
+static gboolean
+gst_proxy_sink_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstProxySink *self = GST_PROXY_SINK (parent);
+  gboolean ret;
+
+  GST_LOG_OBJECT (pad, "Got %s event", GST_EVENT_TYPE_NAME (event));
+
+  if (!self->queued) {
+    if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP)
+      self->pending_sticky_events = FALSE;
+
+    return gst_proxy_sink_push_event (self, event);
+  }
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_START:
+      g_mutex_lock (&self->lock);
+      self->flushing = TRUE;
+      gst_proxy_sink_flush_queue (self);
+      g_cond_broadcast (&self->item_add);
+      g_mutex_unlock (&self->lock);
+
+      /* Unblocks the hand-off thread if it is pushing */
+      ret = gst_proxy_sink_push_event (self, event);
+      gst_task_pause (self->task);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      /* Wait for the hand-off thread to be paused */
+      g_rec_mutex_lock (&self->task_lock);
+      g_rec_mutex_unlock (&self->task_lock);
+
+      self->pending_sticky_events = FALSE;
+      ret = gst_proxy_sink_push_event (self, event);
+
+      g_mutex_lock (&self->lock);
+      self->flushing = FALSE;
+      g_mutex_unlock (&self->lock);
+      gst_task_start (self->task);
+      break;
+    default:
+      if (GST_EVENT_IS_SERIALIZED (event)) {
+        ret = gst_proxy_sink_enqueue (self, GST_MINI_OBJECT_CAST (event), 0,
+            0, 0, GST_CLOCK_TIME_NONE) == GST_FLOW_OK;
+      } else {
+        ret = gst_proxy_sink_push_event (self, event);
+      }
+      break;
+  }
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_proxy_sink_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstProxySink *self = GST_PROXY_SINK (parent);
+
+  GST_LOG_OBJECT (pad, "Chaining buffer %p", buffer);
+
+  if (self->queued) {
+    return gst_proxy_sink_enqueue (self, GST_MINI_OBJECT_CAST (buffer), 1,
+        gst_buffer_get_size (buffer), GST_BUFFER_DURATION (buffer),
+        GST_BUFFER_PTS (buffer));
   }
 
+  gst_proxy_sink_push_data (self, GST_MINI_OBJECT_CAST (buffer), 1);
+
   return GST_FLOW_OK;
 }
 
@@ -239,33 +843,33 @@ gst_proxy_sink_sink_chain_list (GstPad * pad, GstObject * parent,
     GstBufferList * list)
 {
   GstProxySink *self = GST_PROXY_SINK (parent);
-  GstProxySrc *src;
-  GstFlowReturn ret = GST_FLOW_OK;
+  GstClockTime duration = GST_CLOCK_TIME_NONE, pts = GST_CLOCK_TIME_NONE;
+  gsize n_bytes = 0;
+  guint i, n;
 
   GST_LOG_OBJECT (pad, "Chaining buffer list %p", list);
 
-  src = g_weak_ref_get (&self->proxysrc);
-  if (src) {
-    GstPad *srcpad;
-    srcpad = gst_proxy_src_get_internal_srcpad (src);
+  n = gst_buffer_list_length (list);
 
-    if (self->pending_sticky_events) {
-      CopyStickyEventsData data = { srcpad, GST_FLOW_OK };
+  if (self->queued) {
+    for (i = 0; i < n; i++) {
+      GstBuffer *buffer = gst_buffer_list_get (list, i);
 
-      gst_pad_sticky_events_foreach (pad, copy_sticky_events, &data);
-      self->pending_sticky_events = data.ret != GST_FLOW_OK;
+      n_bytes += gst_buffer_get_size (buffer);
+      if (GST_BUFFER_DURATION_IS_VALID (buffer)) {
+        if (!GST_CLOCK_TIME_IS_VALID (duration))
+          duration = 0;
+        duration += GST_BUFFER_DURATION (buffer);
+      }
+      if (GST_BUFFER_PTS_IS_VALID (buffer))
+        pts = GST_BUFFER_PTS (buffer);
     }
-
-    ret = gst_pad_push_list (srcpad, list);
-    gst_object_unref (srcpad);
-    gst_object_unref (src);
-    GST_LOG_OBJECT (pad, "Chained buffer list %p: %s", list,
-        gst_flow_get_name (ret));
-  } else {
-    gst_buffer_list_unref (list);
-    GST_LOG_OBJECT (pad, "Dropped buffer list %p: no otherpad", list);
+    return gst_proxy_sink_enqueue (self, GST_MINI_OBJECT_CAST (list), n,
+        n_bytes, duration, pts);
   }
 
+  gst_proxy_sink_push_data (self, GST_MINI_OBJECT_CAST (list), n);
+
   return GST_FLOW_OK;
 }
 
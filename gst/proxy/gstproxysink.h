@@ -37,6 +37,12 @@ typedef struct _GstProxySink GstProxySink;
 typedef struct _GstProxySinkClass GstProxySinkClass;
 typedef struct _GstProxySinkPrivate GstProxySinkPrivate;
 
+typedef enum {
+  GST_PROXY_SINK_LEAKY_NONE,
+  GST_PROXY_SINK_LEAKY_UPSTREAM,
+  GST_PROXY_SINK_LEAKY_DOWNSTREAM
+} GstProxySinkLeaky;
+
 struct _GstProxySink {
   GstElement parent;
 
@@ -48,6 +54,41 @@ struct _GstProxySink {
 
   /* Whether there are sticky events pending */
   gboolean pending_sticky_events;
+
+  /* Hand-off queue settings, all 0 pushes from the streaming thread of the
+   * proxysink pipeline */
+  guint max_size_buffers;
+  guint max_size_bytes;
+  guint64 max_size_time;
+  GstProxySinkLeaky leaky;
+
+  /* Protects the hand-off queue and the statistics */
+  GMutex lock;
+  GCond item_add;
+  GCond item_del;
+  GQueue queue;
+  gboolean queued;
+  gboolean flushing;
+  gboolean busy;
+  guint cur_level_buffers;
+  gsize cur_level_bytes;
+  GstClockTime cur_level_time;
+  GstClockTime last_pts;
+
+  /* Pushes the queued items into proxysrc */
+  GstTask *task;
+  GRecMutex task_lock;
+
+  /* Statistics */
+  guint64 buffers_pushed;
+  guint64 buffers_dropped;
+  guint max_level_buffers;
+  GstClockTime push_time;
+  GstClockTime max_push_time;
+  GstClockTime blocked_time;
+  GstClockTime total_latency;
+  GstClockTime max_latency;
+  guint64 latency_count;
 };
 
 struct _GstProxySinkClass {
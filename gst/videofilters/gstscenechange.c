@@ -33,6 +33,12 @@
  *
  * The scenechange element does not work with compressed video.
  *
+ * By default the decision is based on the mean absolute luma difference
+ * between consecutive frames.  The #GstSceneChange:metric property selects
+ * a luma histogram difference instead, which ignores motion within a shot
+ * better, and #GstSceneChange:subsample trades accuracy for speed on large
+ * frames.
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 -v filesrc location=some_file.ogv ! decodebin !
@@ -82,6 +88,7 @@
 #include <gst/video/gstvideofilter.h>
 #include <string.h>
 #include "gstscenechange.h"
+#include "gstvideofiltersbadorc.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_scene_change_debug_category);
 #define GST_CAT_DEFAULT gst_scene_change_debug_category
@@ -89,6 +96,11 @@ GST_DEBUG_CATEGORY_STATIC (gst_scene_change_debug_category);
 /* prototypes */
 
 
+static void gst_scene_change_set_property (GObject * object,
+    guint property_id, const GValue * value, GParamSpec * pspec);
+static void gst_scene_change_get_property (GObject * object,
+    guint property_id, GValue * value, GParamSpec * pspec);
+static gboolean gst_scene_change_stop (GstBaseTransform * trans);
 static GstFlowReturn gst_scene_change_transform_frame_ip (GstVideoFilter *
     filter, GstVideoFrame * frame);
 
@@ -99,9 +111,35 @@ static gboolean is_shot_change (int frame_number);
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_METRIC,
+  PROP_SUBSAMPLE
 };
 
+#define DEFAULT_METRIC GST_SCENE_CHANGE_METRIC_SAD
+#define DEFAULT_SUBSAMPLE 1
+
+#define GST_TYPE_SCENE_CHANGE_METRIC (gst_scene_change_metric_get_type())
+static GType
+gst_scene_change_metric_get_type (void)
+{
+  static GType scene_change_metric_type = 0;
+
+  if (!scene_change_metric_type) {
+    static const GEnumValue scene_change_metrics[] = {
+      {GST_SCENE_CHANGE_METRIC_SAD, "Mean absolute luma difference", "sad"},
+      {GST_SCENE_CHANGE_METRIC_HISTOGRAM, "Luma histogram difference",
+          "histogram"},
+      {0, NULL, NULL},
+    };
+
+    scene_change_metric_type =
+        g_enum_register_static ("GstSceneChangeMetric", scene_change_metrics);
+  }
+
+  return scene_change_metric_type;
+}
+
 #define VIDEO_CAPS \
     GST_VIDEO_CAPS_MAKE("{ I420, Y42B, Y41B, Y444 }")
 
@@ -115,6 +153,9 @@ G_DEFINE_TYPE_WITH_CODE (GstSceneChange, gst_scene_change,
 static void
 gst_scene_change_class_init (GstSceneChangeClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstBaseTransformClass *base_transform_class =
+      GST_BASE_TRANSFORM_CLASS (klass);
   GstVideoFilterClass *video_filter_class = GST_VIDEO_FILTER_CLASS (klass);
 
   gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
@@ -129,39 +170,186 @@ gst_scene_change_class_init (GstSceneChangeClass * klass)
       "Video/Filter", "Detects scene changes in video",
       "David Schleef <ds@entropywave.com>");
 
+  gobject_class->set_property = gst_scene_change_set_property;
+  gobject_class->get_property = gst_scene_change_get_property;
+  base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_scene_change_stop);
   video_filter_class->transform_frame_ip =
       GST_DEBUG_FUNCPTR (gst_scene_change_transform_frame_ip);
 
+  /**
+   * GstSceneChange:metric:
+   *
+   * How the difference between two frames is measured.  The histogram
+   * difference is the percentage of luma samples that moved to another
+   * histogram bin, and is compared against the same thresholds as the
+   * mean absolute difference.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_METRIC,
+      g_param_spec_enum ("metric", "Metric",
+          "Measure of the difference between two frames",
+          GST_TYPE_SCENE_CHANGE_METRIC, DEFAULT_METRIC,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstSceneChange:subsample:
+   *
+   * Only look at every n-th line of each frame, and for the histogram metric
+   * at every n-th sample of those lines.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_SUBSAMPLE,
+      g_param_spec_uint ("subsample", "Subsample",
+          "Only look at every n-th line and sample of each frame", 1, 16,
+          DEFAULT_SUBSAMPLE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
 gst_scene_change_init (GstSceneChange * scenechange)
 {
+  scenechange->metric = DEFAULT_METRIC;
+  scenechange->subsample = DEFAULT_SUBSAMPLE;
 }
 
+static void
+gst_scene_change_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (object);
+
+  GST_DEBUG_OBJECT (scenechange, "set_property");
+
+  switch (property_id) {
+    case PROP_METRIC:
+      GST_OBJECT_LOCK (scenechange);
+      scenechange->metric = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (scenechange);
+      break;
+    case PROP_SUBSAMPLE:
+      GST_OBJECT_LOCK (scenechange);
+      scenechange->subsample = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (scenechange);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+}
 
+static void
+gst_scene_change_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (object);
+
+  GST_DEBUG_OBJECT (scenechange, "get_property");
+
+  switch (property_id) {
+    case PROP_METRIC:
+      GST_OBJECT_LOCK (scenechange);
+      g_value_set_enum (value, scenechange->metric);
+      GST_OBJECT_UNLOCK (scenechange);
+      break;
+    case PROP_SUBSAMPLE:
+      GST_OBJECT_LOCK (scenechange);
+      g_value_set_uint (value, scenechange->subsample);
+      GST_OBJECT_UNLOCK (scenechange);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+}
+
+static gboolean
+gst_scene_change_stop (GstBaseTransform * trans)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (trans);
+
+  GST_DEBUG_OBJECT (scenechange, "stop");
+
+  gst_buffer_replace (&scenechange->oldbuf, NULL);
+  scenechange->have_histogram = FALSE;
+
+  if (GST_BASE_TRANSFORM_CLASS (gst_scene_change_parent_class)->stop)
+    return
+        GST_BASE_TRANSFORM_CLASS (gst_scene_change_parent_class)->stop (trans);
+  return TRUE;
+}
+
+
+/* Skipping samples within a line would not make this any cheaper, every
+ * cache line is loaded anyway, so only whole lines are skipped. The sum
+ * of a 4K frame does not fit into 32 bits */
 static double
-get_frame_score (GstVideoFrame * f1, GstVideoFrame * f2)
+get_frame_score (GstVideoFrame * f1, GstVideoFrame * f2, guint subsample)
 {
-  int i;
   int j;
-  int score = 0;
+  guint64 score = 0;
+  guint32 line_score;
   int width, height;
+  int n_lines = 0;
   guint8 *s1;
   guint8 *s2;
 
   width = f1->info.width;
   height = f1->info.height;
 
-  for (j = 0; j < height; j++) {
+  for (j = 0; j < height; j += subsample) {
     s1 = (guint8 *) f1->data[0] + f1->info.stride[0] * j;
     s2 = (guint8 *) f2->data[0] + f2->info.stride[0] * j;
-    for (i = 0; i < width; i++) {
-      score += ABS (s1[i] - s2[i]);
+    videofilters_orc_sad_u8 (&line_score, s1, s2, width);
+    score += line_score;
+    n_lines++;
+  }
+
+  return ((double) score) / ((guint64) width * n_lines);
+}
+
+static void
+get_frame_histogram (GstVideoFrame * frame, guint subsample,
+    guint32 * histogram)
+{
+  int i;
+  int j;
+  int width, height;
+  guint8 *s;
+
+  width = frame->info.width;
+  height = frame->info.height;
+
+  memset (histogram, 0, sizeof (guint32) * SC_N_BINS);
+  for (j = 0; j < height; j += subsample) {
+    s = (guint8 *) frame->data[0] + frame->info.stride[0] * j;
+    for (i = 0; i < width; i += subsample) {
+      histogram[s[i] >> SC_HISTOGRAM_SHIFT]++;
     }
   }
+}
+
+/* Each sample that moves to another bin is counted twice in the sum of
+ * differences, so half of it is the share of samples that moved */
+static double
+get_histogram_score (const guint32 * h1, const guint32 * h2)
+{
+  int i;
+  guint64 n1 = 0;
+  guint64 n2 = 0;
+  double score = 0;
+
+  for (i = 0; i < SC_N_BINS; i++) {
+    n1 += h1[i];
+    n2 += h2[i];
+  }
+  if (n1 == 0 || n2 == 0)
+    return 0;
 
-  return ((double) score) / (width * height);
+  for (i = 0; i < SC_N_BINS; i++) {
+    score += ABS ((double) h1[i] / n1 - (double) h2[i] / n2);
+  }
+
+  return 50.0 * score;
 }
 
 static GstFlowReturn
@@ -170,40 +358,65 @@ gst_scene_change_transform_frame_ip (GstVideoFilter * filter,
 {
   GstSceneChange *scenechange = GST_SCENE_CHANGE (filter);
   GstVideoFrame oldframe;
+  GstSceneChangeMetric metric;
+  guint subsample;
   double score_min;
   double score_max;
   double threshold;
-  double score;
+  double score = 0;
+  gboolean have_score;
   gboolean change;
   gboolean ret;
   int i;
 
   GST_DEBUG_OBJECT (scenechange, "transform_frame_ip");
 
+  GST_OBJECT_LOCK (scenechange);
+  metric = scenechange->metric;
+  subsample = scenechange->subsample;
+  GST_OBJECT_UNLOCK (scenechange);
+
   if (!scenechange->oldbuf) {
     scenechange->n_diffs = 0;
     memset (scenechange->diffs, 0, sizeof (double) * SC_N_DIFFS);
-    scenechange->oldbuf = gst_buffer_ref (frame->buffer);
-    memcpy (&scenechange->oldinfo, &frame->info, sizeof (GstVideoInfo));
-    return GST_FLOW_OK;
+    scenechange->have_histogram = FALSE;
   }
 
-  ret =
-      gst_video_frame_map (&oldframe, &scenechange->oldinfo,
-      scenechange->oldbuf, GST_MAP_READ);
-  if (!ret) {
-    GST_ERROR_OBJECT (scenechange, "failed to map old video frame");
-    return GST_FLOW_ERROR;
+  if (metric == GST_SCENE_CHANGE_METRIC_HISTOGRAM) {
+    guint32 histogram[SC_N_BINS];
+
+    /* the previous frame was binned when it came in, after switching from
+     * the other metric there is nothing to compare against yet */
+    get_frame_histogram (frame, subsample, histogram);
+    have_score = scenechange->have_histogram;
+    if (have_score)
+      score = get_histogram_score (scenechange->histogram, histogram);
+    memcpy (scenechange->histogram, histogram, sizeof (histogram));
+    scenechange->have_histogram = TRUE;
+  } else {
+    have_score = scenechange->oldbuf != NULL;
+    if (have_score) {
+      ret =
+          gst_video_frame_map (&oldframe, &scenechange->oldinfo,
+          scenechange->oldbuf, GST_MAP_READ);
+      if (!ret) {
+        GST_ERROR_OBJECT (scenechange, "failed to map old video frame");
+        return GST_FLOW_ERROR;
+      }
+
+      score = get_frame_score (&oldframe, frame, subsample);
+
+      gst_video_frame_unmap (&oldframe);
+    }
+    scenechange->have_histogram = FALSE;
   }
 
-  score = get_frame_score (&oldframe, frame);
-
-  gst_video_frame_unmap (&oldframe);
-
-  gst_buffer_unref (scenechange->oldbuf);
-  scenechange->oldbuf = gst_buffer_ref (frame->buffer);
+  gst_buffer_replace (&scenechange->oldbuf, frame->buffer);
   memcpy (&scenechange->oldinfo, &frame->info, sizeof (GstVideoInfo));
 
+  if (!have_score)
+    return GST_FLOW_OK;
+
   memmove (scenechange->diffs, scenechange->diffs + 1,
       sizeof (double) * (SC_N_DIFFS - 1));
   scenechange->diffs[SC_N_DIFFS - 1] = score;
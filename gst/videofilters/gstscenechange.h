@@ -35,15 +35,32 @@ typedef struct _GstSceneChange GstSceneChange;
 typedef struct _GstSceneChangeClass GstSceneChangeClass;
 
 #define SC_N_DIFFS 5
+/* luma levels are binned 8 to a bin for the histogram metric */
+#define SC_HISTOGRAM_SHIFT 3
+#define SC_N_BINS (256 >> SC_HISTOGRAM_SHIFT)
+
+typedef enum
+{
+  GST_SCENE_CHANGE_METRIC_SAD,
+  GST_SCENE_CHANGE_METRIC_HISTOGRAM
+} GstSceneChangeMetric;
 
 struct _GstSceneChange
 {
   GstVideoFilter base_scenechange;
 
+  /* properties */
+  GstSceneChangeMetric metric;
+  guint subsample;
+
+  /* state */
   int n_diffs;
   double diffs[SC_N_DIFFS];
   GstBuffer *oldbuf;
   GstVideoInfo oldinfo;
+  /* histogram of oldbuf, so every frame is binned only once */
+  gboolean have_histogram;
+  guint32 histogram[SC_N_BINS];
   int count;
 };
 
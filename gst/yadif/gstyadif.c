@@ -34,6 +34,19 @@
  * This pipeline creates an interlaced test pattern, and then deinterlaces
  * it using the yadif filter.
  *
+ * Besides planar 8 bit YUV, packed YUY2/UYVY, NV12 and the 10 bit planar
+ * and P010 formats are handled. Each frame is split into bands of lines
+ * that are filtered in parallel by #GstYadif:n-threads threads.
+ *
+ * With #GstYadif:field-rate enabled one progressive frame is produced for
+ * each field, doubling the framerate, e.g. turning 50i into 50p. Each
+ * output then uses the previous and the next input frame as temporal
+ * references, which delays the output by one frame.
+ *
+ * |[
+ * gst-launch-1.0 -v videotestsrc pattern=ball ! interlace ! yadif field-rate=true ! xvimagesink
+ * ]|
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -68,14 +81,39 @@ static gboolean gst_yadif_start (GstBaseTransform * trans);
 static gboolean gst_yadif_stop (GstBaseTransform * trans);
 static GstFlowReturn gst_yadif_transform (GstBaseTransform * trans,
     GstBuffer * inbuf, GstBuffer * outbuf);
+static gboolean gst_yadif_sink_event (GstBaseTransform * trans,
+    GstEvent * event);
+static gboolean gst_yadif_query (GstBaseTransform * trans,
+    GstPadDirection direction, GstQuery * query);
+static GstFlowReturn gst_yadif_submit_input_buffer (GstBaseTransform * trans,
+    gboolean is_discont, GstBuffer * input);
+static GstFlowReturn gst_yadif_generate_output (GstBaseTransform * trans,
+    GstBuffer ** outbuf);
 
 enum
 {
   PROP_0,
-  PROP_MODE
+  PROP_MODE,
+  PROP_N_THREADS,
+  PROP_FIELD_RATE
 };
 
 #define DEFAULT_MODE GST_DEINTERLACE_MODE_AUTO
+#define DEFAULT_N_THREADS 0
+#define DEFAULT_FIELD_RATE FALSE
+
+/* Don't bother other threads with less lines than this */
+#define MIN_LINES_PER_SLICE 32
+/* Upper limit for the number of threads used to filter a frame */
+#define MAX_THREADS 64
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define YADIF_FORMATS "{Y42B,I420,Y444,YUY2,UYVY,NV12," \
+    "I420_10LE,I422_10LE,Y444_10LE,P010_10LE}"
+#else
+#define YADIF_FORMATS "{Y42B,I420,Y444,YUY2,UYVY,NV12," \
+    "I420_10BE,I422_10BE,Y444_10BE,P010_10BE}"
+#endif
 
 /* pad templates */
 
@@ -83,7 +121,7 @@ static GstStaticPadTemplate gst_yadif_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{Y42B,I420,Y444}")
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (YADIF_FORMATS)
         ",interlace-mode=(string){interleaved,mixed,progressive}")
     );
 
@@ -91,7 +129,7 @@ static GstStaticPadTemplate gst_yadif_src_template =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{Y42B,I420,Y444}")
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (YADIF_FORMATS)
         ",interlace-mode=(string)progressive")
     );
 
@@ -152,6 +190,12 @@ gst_yadif_class_init (GstYadifClass * klass)
   base_transform_class->start = GST_DEBUG_FUNCPTR (gst_yadif_start);
   base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_yadif_stop);
   base_transform_class->transform = GST_DEBUG_FUNCPTR (gst_yadif_transform);
+  base_transform_class->sink_event = GST_DEBUG_FUNCPTR (gst_yadif_sink_event);
+  base_transform_class->query = GST_DEBUG_FUNCPTR (gst_yadif_query);
+  base_transform_class->submit_input_buffer =
+      GST_DEBUG_FUNCPTR (gst_yadif_submit_input_buffer);
+  base_transform_class->generate_output =
+      GST_DEBUG_FUNCPTR (gst_yadif_generate_output);
 
   g_object_class_install_property (gobject_class, PROP_MODE,
       g_param_spec_enum ("mode", "Deinterlace Mode",
@@ -160,11 +204,41 @@ gst_yadif_class_init (GstYadifClass * klass)
           DEFAULT_MODE,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstYadif:n-threads:
+   *
+   * Number of threads the lines of each frame are split over, or 0 to use
+   * one thread per processor.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Number of threads to filter with (0 = one per processor)",
+          0, MAX_THREADS, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstYadif:field-rate:
+   *
+   * Output one frame per field instead of one per frame, doubling the
+   * framerate.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_FIELD_RATE,
+      g_param_spec_boolean ("field-rate", "Field rate",
+          "Output one frame per field, at twice the input framerate",
+          DEFAULT_FIELD_RATE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
 gst_yadif_init (GstYadif * yadif)
 {
+  yadif->n_threads = DEFAULT_N_THREADS;
+  yadif->field_rate = DEFAULT_FIELD_RATE;
+  g_mutex_init (&yadif->lock);
+  g_cond_init (&yadif->cond);
 }
 
 void
@@ -177,6 +251,17 @@ gst_yadif_set_property (GObject * object, guint property_id,
     case PROP_MODE:
       yadif->mode = g_value_get_enum (value);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (yadif);
+      yadif->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (yadif);
+      break;
+    case PROP_FIELD_RATE:
+      GST_OBJECT_LOCK (yadif);
+      yadif->field_rate = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (yadif);
+      gst_base_transform_reconfigure_src (GST_BASE_TRANSFORM (yadif));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -193,6 +278,16 @@ gst_yadif_get_property (GObject * object, guint property_id,
     case PROP_MODE:
       g_value_set_enum (value, yadif->mode);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (yadif);
+      g_value_set_uint (value, yadif->n_threads);
+      GST_OBJECT_UNLOCK (yadif);
+      break;
+    case PROP_FIELD_RATE:
+      GST_OBJECT_LOCK (yadif);
+      g_value_set_boolean (value, yadif->field_rate);
+      GST_OBJECT_UNLOCK (yadif);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -212,19 +307,52 @@ gst_yadif_dispose (GObject * object)
 void
 gst_yadif_finalize (GObject * object)
 {
-  /* GstYadif *yadif = GST_YADIF (object); */
+  GstYadif *yadif = GST_YADIF (object);
 
-  /* clean up object here */
+  g_mutex_clear (&yadif->lock);
+  g_cond_clear (&yadif->cond);
 
   G_OBJECT_CLASS (gst_yadif_parent_class)->finalize (object);
 }
 
+/* Doubles the framerates in caps when going to field rate, halves them
+ * otherwise */
+static void
+gst_yadif_scale_framerate (GstCaps * caps, gboolean to_field_rate)
+{
+  guint i;
+
+  for (i = 0; i < gst_caps_get_size (caps); i++) {
+    GstStructure *s = gst_caps_get_structure (caps, i);
+    const GValue *fps = gst_structure_get_value (s, "framerate");
+    gint n, d;
+
+    if (fps == NULL)
+      continue;
+
+    if (GST_VALUE_HOLDS_FRACTION (fps)) {
+      n = gst_value_get_fraction_numerator (fps);
+      d = gst_value_get_fraction_denominator (fps);
+
+      if (gst_util_fraction_multiply (n, d, to_field_rate ? 2 : 1,
+              to_field_rate ? 1 : 2, &n, &d)) {
+        gst_structure_set (s, "framerate", GST_TYPE_FRACTION, n, d, NULL);
+        continue;
+      }
+    }
+
+    gst_structure_set (s, "framerate", GST_TYPE_FRACTION_RANGE, 0, 1,
+        G_MAXINT, 1, NULL);
+  }
+}
 
 static GstCaps *
 gst_yadif_transform_caps (GstBaseTransform * trans,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter)
 {
+  GstYadif *yadif = GST_YADIF (trans);
   GstCaps *othercaps;
+  gboolean field_rate;
 
   othercaps = gst_caps_copy (caps);
 
@@ -250,6 +378,13 @@ gst_yadif_transform_caps (GstBaseTransform * trans,
         "progressive", NULL);
   }
 
+  GST_OBJECT_LOCK (yadif);
+  field_rate = yadif->field_rate;
+  GST_OBJECT_UNLOCK (yadif);
+
+  if (field_rate)
+    gst_yadif_scale_framerate (othercaps, direction == GST_PAD_SINK);
+
   return othercaps;
 }
 
@@ -261,6 +396,10 @@ gst_yadif_set_caps (GstBaseTransform * trans, GstCaps * incaps,
 
   gst_video_info_from_caps (&yadif->video_info, incaps);
 
+  GST_OBJECT_LOCK (yadif);
+  yadif->field_rate_active = yadif->field_rate;
+  GST_OBJECT_UNLOCK (yadif);
+
   return TRUE;
 }
 
@@ -277,46 +416,158 @@ gst_yadif_get_unit_size (GstBaseTransform * trans, GstCaps * caps, gsize * size)
   return FALSE;
 }
 
+void yadif_filter (GstYadif * yadif, int parity, int tff, int slice,
+    int n_slices);
+
+static void
+gst_yadif_slice_func (gpointer data, gpointer user_data)
+{
+  GstYadif *yadif = GST_YADIF (user_data);
+  int slice = GPOINTER_TO_INT (data);
+
+  yadif_filter (yadif, yadif->parity, yadif->tff, slice, yadif->n_slices);
+
+  g_mutex_lock (&yadif->lock);
+  if (--yadif->n_pending == 0)
+    g_cond_signal (&yadif->cond);
+  g_mutex_unlock (&yadif->lock);
+}
+
 static gboolean
 gst_yadif_start (GstBaseTransform * trans)
 {
+  GstYadif *yadif = GST_YADIF (trans);
+  guint n_threads;
+  GError *err = NULL;
+
+  GST_OBJECT_LOCK (yadif);
+  n_threads = yadif->n_threads;
+  GST_OBJECT_UNLOCK (yadif);
+
+  if (n_threads == 0)
+    n_threads = MIN (g_get_num_processors (), MAX_THREADS);
+
+  /* the streaming thread always does one slice itself */
+  if (n_threads > 1) {
+    yadif->pool = g_thread_pool_new (gst_yadif_slice_func, yadif,
+        n_threads - 1, TRUE, &err);
+    if (yadif->pool == NULL) {
+      GST_WARNING_OBJECT (yadif, "failed to create thread pool: %s",
+          err->message);
+      g_clear_error (&err);
+      n_threads = 1;
+    }
+  }
+
+  GST_DEBUG_OBJECT (yadif, "filtering with %u threads", n_threads);
 
   return TRUE;
 }
 
+static void
+gst_yadif_clear_history (GstYadif * yadif)
+{
+  gst_buffer_replace (&yadif->prev_buf, NULL);
+  gst_buffer_replace (&yadif->cur_buf, NULL);
+  gst_buffer_replace (&yadif->next_buf, NULL);
+  yadif->n_fields_left = 0;
+}
+
 static gboolean
 gst_yadif_stop (GstBaseTransform * trans)
 {
+  GstYadif *yadif = GST_YADIF (trans);
+
+  gst_yadif_clear_history (yadif);
+
+  if (yadif->pool) {
+    g_thread_pool_free (yadif->pool, FALSE, TRUE);
+    yadif->pool = NULL;
+  }
 
   return TRUE;
 }
 
-void yadif_filter (GstYadif * yadif, int parity, int tff);
+/* Filters the current frames, spreading bands of lines over the pool */
+static void
+gst_yadif_filter_frame (GstYadif * yadif, int parity, int tff)
+{
+  int n_slices = 1;
+  int i;
+
+  if (yadif->pool) {
+    n_slices = g_thread_pool_get_max_threads (yadif->pool) + 1;
+    n_slices = MIN (n_slices,
+        GST_VIDEO_INFO_HEIGHT (&yadif->video_info) / MIN_LINES_PER_SLICE);
+    n_slices = MAX (n_slices, 1);
+  }
 
-static GstFlowReturn
-gst_yadif_transform (GstBaseTransform * trans, GstBuffer * inbuf,
-    GstBuffer * outbuf)
+  if (n_slices == 1) {
+    yadif_filter (yadif, parity, tff, 0, 1);
+    return;
+  }
+
+  yadif->parity = parity;
+  yadif->tff = tff;
+  yadif->n_slices = n_slices;
+  yadif->n_pending = n_slices - 1;
+
+  /* slice 0 can't be pushed as NULL, and is done right here anyway */
+  for (i = 1; i < n_slices; i++)
+    g_thread_pool_push (yadif->pool, GINT_TO_POINTER (i), NULL);
+
+  yadif_filter (yadif, parity, tff, 0, n_slices);
+
+  g_mutex_lock (&yadif->lock);
+  while (yadif->n_pending > 0)
+    g_cond_wait (&yadif->cond, &yadif->lock);
+  g_mutex_unlock (&yadif->lock);
+}
+
+/* Maps a reference frame, sharing the mapping of the current frame when
+ * it is the same buffer */
+static gboolean
+gst_yadif_map_ref (GstYadif * yadif, GstVideoFrame * frame, GstBuffer * buf)
 {
-  GstYadif *yadif = GST_YADIF (trans);
-  int parity;
-  int tff;
+  if (buf == yadif->cur_frame.buffer) {
+    *frame = yadif->cur_frame;
+    return TRUE;
+  }
 
-  parity = 0;
-  tff = 0;
+  return gst_video_frame_map (frame, &yadif->video_info, buf, GST_MAP_READ);
+}
 
+static void
+gst_yadif_unmap_ref (GstYadif * yadif, GstVideoFrame * frame)
+{
+  if (frame->buffer != yadif->cur_frame.buffer)
+    gst_video_frame_unmap (frame);
+}
+
+/* Filters cur into outbuf, with prev and next as temporal references. The
+ * buffers are mapped in place, nothing is copied. */
+static GstFlowReturn
+gst_yadif_process (GstYadif * yadif, GstBuffer * prev, GstBuffer * cur,
+    GstBuffer * next, GstBuffer * outbuf, int parity, int tff)
+{
   if (!gst_video_frame_map (&yadif->dest_frame, &yadif->video_info, outbuf,
           GST_MAP_WRITE))
     goto dest_map_failed;
 
-  if (!gst_video_frame_map (&yadif->cur_frame, &yadif->video_info, inbuf,
+  if (!gst_video_frame_map (&yadif->cur_frame, &yadif->video_info, cur,
           GST_MAP_READ))
     goto src_map_failed;
 
-  yadif->next_frame = yadif->cur_frame;
-  yadif->prev_frame = yadif->cur_frame;
+  if (!gst_yadif_map_ref (yadif, &yadif->prev_frame, prev))
+    goto prev_map_failed;
+
+  if (!gst_yadif_map_ref (yadif, &yadif->next_frame, next))
+    goto next_map_failed;
 
-  yadif_filter (yadif, parity, tff);
+  gst_yadif_filter_frame (yadif, parity, tff);
 
+  gst_yadif_unmap_ref (yadif, &yadif->next_frame);
+  gst_yadif_unmap_ref (yadif, &yadif->prev_frame);
   gst_video_frame_unmap (&yadif->dest_frame);
   gst_video_frame_unmap (&yadif->cur_frame);
   return GST_FLOW_OK;
@@ -326,6 +577,16 @@ dest_map_failed:
     GST_ERROR_OBJECT (yadif, "failed to map dest");
     return GST_FLOW_ERROR;
   }
+next_map_failed:
+  {
+    gst_yadif_unmap_ref (yadif, &yadif->prev_frame);
+    /* fall through */
+  }
+prev_map_failed:
+  {
+    gst_video_frame_unmap (&yadif->cur_frame);
+    /* fall through */
+  }
 src_map_failed:
   {
     GST_ERROR_OBJECT (yadif, "failed to map src");
@@ -334,6 +595,245 @@ src_map_failed:
   }
 }
 
+static GstFlowReturn
+gst_yadif_transform (GstBaseTransform * trans, GstBuffer * inbuf,
+    GstBuffer * outbuf)
+{
+  GstYadif *yadif = GST_YADIF (trans);
+  int parity;
+  int tff;
+
+  parity = 0;
+  tff = 0;
+
+  return gst_yadif_process (yadif, inbuf, inbuf, inbuf, outbuf, parity, tff);
+}
+
+/* Duration of the current frame, used to place its two fields */
+static GstClockTime
+gst_yadif_frame_duration (GstYadif * yadif)
+{
+  GstBuffer *cur = yadif->cur_buf;
+  GstBuffer *next = yadif->next_buf;
+  const GstVideoInfo *vi = &yadif->video_info;
+
+  if (GST_BUFFER_DURATION_IS_VALID (cur))
+    return GST_BUFFER_DURATION (cur);
+
+  if (next && GST_BUFFER_PTS_IS_VALID (cur) && GST_BUFFER_PTS_IS_VALID (next)
+      && GST_BUFFER_PTS (next) > GST_BUFFER_PTS (cur))
+    return GST_BUFFER_PTS (next) - GST_BUFFER_PTS (cur);
+
+  if (GST_VIDEO_INFO_FPS_N (vi) > 0)
+    return gst_util_uint64_scale_int (GST_SECOND, GST_VIDEO_INFO_FPS_D (vi),
+        GST_VIDEO_INFO_FPS_N (vi));
+
+  return GST_CLOCK_TIME_NONE;
+}
+
+/* Moves the history one frame on, buf becoming the next frame. The
+ * current frame then has both of its fields pending. */
+static void
+gst_yadif_push_history (GstYadif * yadif, GstBuffer * buf)
+{
+  gst_buffer_replace (&yadif->prev_buf, NULL);
+  yadif->prev_buf = yadif->cur_buf;
+  yadif->cur_buf = yadif->next_buf;
+  yadif->next_buf = buf;
+  yadif->n_fields_left = yadif->cur_buf ? 2 : 0;
+}
+
+/* Produces the frame for the next pending field of the current frame */
+static GstFlowReturn
+gst_yadif_output_field (GstYadif * yadif, GstBuffer ** outbuf)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM (yadif);
+  GstBuffer *cur = yadif->cur_buf;
+  GstBuffer *prev = yadif->prev_buf ? yadif->prev_buf : cur;
+  GstBuffer *next = yadif->next_buf ? yadif->next_buf : cur;
+  GstClockTime duration, half;
+  gboolean first, tff;
+  GstFlowReturn ret;
+
+  first = yadif->n_fields_left == 2;
+  yadif->n_fields_left--;
+
+  ret = GST_BASE_TRANSFORM_CLASS (gst_yadif_parent_class)->prepare_output_buffer
+      (trans, cur, outbuf);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  duration = gst_yadif_frame_duration (yadif);
+  if (GST_CLOCK_TIME_IS_VALID (duration)) {
+    half = duration / 2;
+    if (first) {
+      GST_BUFFER_DURATION (*outbuf) = half;
+    } else {
+      if (GST_BUFFER_PTS_IS_VALID (cur))
+        GST_BUFFER_PTS (*outbuf) = GST_BUFFER_PTS (cur) + half;
+      GST_BUFFER_DURATION (*outbuf) = duration - half;
+    }
+  } else if (!first) {
+    GST_BUFFER_PTS (*outbuf) = GST_CLOCK_TIME_NONE;
+  }
+
+  if (!first) {
+    GST_BUFFER_DTS (*outbuf) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_FLAG_UNSET (*outbuf, GST_BUFFER_FLAG_DISCONT);
+  }
+  GST_BUFFER_FLAG_UNSET (*outbuf, GST_VIDEO_BUFFER_FLAG_INTERLACED |
+      GST_VIDEO_BUFFER_FLAG_TFF | GST_VIDEO_BUFFER_FLAG_RFF |
+      GST_VIDEO_BUFFER_FLAG_ONEFIELD);
+
+  tff = GST_BUFFER_FLAG_IS_SET (cur, GST_VIDEO_BUFFER_FLAG_TFF);
+
+  GST_LOG_OBJECT (yadif, "field %d of %" GST_PTR_FORMAT, first ? 1 : 2, cur);
+
+  /* the first field in time is kept first, the other one interpolated */
+  ret = gst_yadif_process (yadif, prev, cur, next, *outbuf, tff ^ first, tff);
+  if (ret != GST_FLOW_OK)
+    gst_buffer_replace (outbuf, NULL);
+
+  return ret;
+}
+
+/* Pushes out both fields of the frames still in the history */
+static GstFlowReturn
+gst_yadif_drain (GstYadif * yadif)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM (yadif);
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *outbuf;
+
+  if (yadif->next_buf == NULL) {
+    gst_yadif_clear_history (yadif);
+    return GST_FLOW_OK;
+  }
+
+  GST_DEBUG_OBJECT (yadif, "draining");
+
+  /* fields of the current frame may still be pending if a push failed */
+  while (ret == GST_FLOW_OK && yadif->n_fields_left > 0) {
+    ret = gst_yadif_output_field (yadif, &outbuf);
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (trans->srcpad, outbuf);
+  }
+
+  gst_yadif_push_history (yadif, NULL);
+  while (ret == GST_FLOW_OK && yadif->n_fields_left > 0) {
+    ret = gst_yadif_output_field (yadif, &outbuf);
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (trans->srcpad, outbuf);
+  }
+
+  gst_yadif_clear_history (yadif);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_yadif_submit_input_buffer (GstBaseTransform * trans, gboolean is_discont,
+    GstBuffer * input)
+{
+  GstYadif *yadif = GST_YADIF (trans);
+  GstFlowReturn ret;
+
+  if (!yadif->field_rate_active)
+    return GST_BASE_TRANSFORM_CLASS (gst_yadif_parent_class)->
+        submit_input_buffer (trans, is_discont, input);
+
+  /* frames before a discont are no reference for the ones after it */
+  if (is_discont) {
+    ret = gst_yadif_drain (yadif);
+    if (ret != GST_FLOW_OK) {
+      gst_buffer_unref (input);
+      return ret;
+    }
+  }
+
+  gst_yadif_push_history (yadif, input);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_yadif_generate_output (GstBaseTransform * trans, GstBuffer ** outbuf)
+{
+  GstYadif *yadif = GST_YADIF (trans);
+
+  if (!yadif->field_rate_active)
+    return GST_BASE_TRANSFORM_CLASS (gst_yadif_parent_class)->generate_output
+        (trans, outbuf);
+
+  *outbuf = NULL;
+  if (yadif->n_fields_left == 0)
+    return GST_FLOW_OK;
+
+  return gst_yadif_output_field (yadif, outbuf);
+}
+
+static gboolean
+gst_yadif_sink_event (GstBaseTransform * trans, GstEvent * event)
+{
+  GstYadif *yadif = GST_YADIF (trans);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:{
+      GstCaps *caps, *current;
+
+      /* the history has to go out with the caps it was received with */
+      gst_event_parse_caps (event, &caps);
+      current = gst_pad_get_current_caps (trans->sinkpad);
+      if (current) {
+        if (!gst_caps_is_equal (caps, current))
+          gst_yadif_drain (yadif);
+        gst_caps_unref (current);
+      }
+      break;
+    }
+    case GST_EVENT_EOS:
+      gst_yadif_drain (yadif);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_yadif_clear_history (yadif);
+      break;
+    default:
+      break;
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (gst_yadif_parent_class)->sink_event (trans,
+      event);
+}
+
+static gboolean
+gst_yadif_query (GstBaseTransform * trans, GstPadDirection direction,
+    GstQuery * query)
+{
+  GstYadif *yadif = GST_YADIF (trans);
+  const GstVideoInfo *vi = &yadif->video_info;
+  GstClockTime min, max, latency;
+  gboolean live;
+  gboolean ret;
+
+  ret = GST_BASE_TRANSFORM_CLASS (gst_yadif_parent_class)->query (trans,
+      direction, query);
+
+  /* at field rate a frame is only filtered once the next one arrived */
+  if (ret && direction == GST_PAD_SRC
+      && GST_QUERY_TYPE (query) == GST_QUERY_LATENCY
+      && yadif->field_rate_active && GST_VIDEO_INFO_FPS_N (vi) > 0) {
+    latency = gst_util_uint64_scale_int (GST_SECOND,
+        GST_VIDEO_INFO_FPS_D (vi), GST_VIDEO_INFO_FPS_N (vi));
+
+    gst_query_parse_latency (query, &live, &min, &max);
+    min += latency;
+    if (GST_CLOCK_TIME_IS_VALID (max))
+      max += latency;
+    gst_query_set_latency (query, live, min, max);
+  }
+
+  return ret;
+}
 
 static gboolean
 plugin_init (GstPlugin * plugin)
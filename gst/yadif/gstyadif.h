@@ -26,6 +26,10 @@
 
 G_BEGIN_DECLS
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAVE_YADIF_NEON 1
+#endif
+
 #define GST_TYPE_YADIF   (gst_yadif_get_type())
 #define GST_YADIF(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_YADIF,GstYadif))
 #define GST_YADIF_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_YADIF,GstYadifClass))
@@ -53,6 +57,24 @@ struct _GstYadif
   GstVideoFrame cur_frame;
   GstVideoFrame next_frame;
   GstVideoFrame dest_frame;
+
+  /* field rate output, one frame per field of the input */
+  gboolean field_rate;
+  gboolean field_rate_active;
+  GstBuffer *prev_buf;
+  GstBuffer *cur_buf;
+  GstBuffer *next_buf;
+  gint n_fields_left;
+
+  /* slice threading */
+  guint n_threads;
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+  gint n_pending;
+  gint parity;
+  gint tff;
+  gint n_slices;
 };
 
 struct _GstYadifClass
@@ -62,6 +84,14 @@ struct _GstYadifClass
 
 GType gst_yadif_get_type (void);
 
+typedef void (*YadifFilterLineFunc) (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+
+void yadif_filter_short_line (YadifFilterLineFunc filter_line, int n,
+    guint8 * dst, guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+
 G_END_DECLS
 
 #endif
@@ -38,13 +38,15 @@
 
 #define PERM_RWP AV_PERM_WRITE | AV_PERM_PRESERVE | AV_PERM_REUSE
 
+/* s is the distance between two horizontally neighbouring samples, which
+ * is 1 for planar formats */
 #define CHECK(j)\
-    {   int score = FFABS(cur[mrefs-1+(j)] - cur[prefs-1-(j)])\
-                  + FFABS(cur[mrefs  +(j)] - cur[prefs  -(j)])\
-                  + FFABS(cur[mrefs+1+(j)] - cur[prefs+1-(j)]);\
+    {   int score = FFABS(cur[mrefs-s+(j)*s] - cur[prefs-s-(j)*s])\
+                  + FFABS(cur[mrefs  +(j)*s] - cur[prefs  -(j)*s])\
+                  + FFABS(cur[mrefs+s+(j)*s] - cur[prefs+s-(j)*s]);\
         if (score < spatial_score) {\
             spatial_score= score;\
-            spatial_pred= (cur[mrefs  +(j)] + cur[prefs  -(j)])>>1;\
+            spatial_pred= (cur[mrefs  +(j)*s] + cur[prefs  -(j)*s])>>1;\
 
 #define FILTER \
     for (x = 0;  x < w; x++) { \
@@ -59,8 +61,8 @@
         int spatial_score = -1; \
  \
         if (mrefs > 0 && prefs > 0) { \
-            spatial_score = FFABS(cur[mrefs - 1] - cur[prefs - 1]) + FFABS(c-e) \
-                            + FFABS(cur[mrefs + 1] - cur[prefs + 1]) - 1; \
+            spatial_score = FFABS(cur[mrefs - s] - cur[prefs - s]) + FFABS(c-e) \
+                            + FFABS(cur[mrefs + s] - cur[prefs + s]) - 1; \
  \
             CHECK(-1) CHECK(-2) }} }} \
             CHECK( 1) CHECK( 2) }} }} \
@@ -81,18 +83,31 @@
  \
         dst[0] = spatial_pred; \
  \
-        dst++; \
-        cur++; \
-        prev++; \
-        next++; \
-        prev2++; \
-        next2++; \
+        dst += s; \
+        cur += s; \
+        prev += s; \
+        next += s; \
+        prev2 += s; \
+        next2 += s; \
     }
 
 static void
 filter_line_c (guint8 * dst,
     guint8 * prev, guint8 * cur, guint8 * next,
     int w, int prefs, int mrefs, int parity, int mode)
+{
+  const int s = 1;
+  int x;
+  guint8 *prev2 = parity ? prev : cur;
+  guint8 *next2 = parity ? cur : next;
+
+FILTER}
+
+/* 8 bit samples interleaved with other components, like in YUY2 or NV12 */
+static void
+filter_line_c_packed (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode, int s)
 {
   int x;
   guint8 *prev2 = parity ? prev : cur;
@@ -100,11 +115,10 @@ filter_line_c (guint8 * dst,
 
 FILTER}
 
-#if 0
 static void
 filter_line_c_16bit (guint16 * dst,
     guint16 * prev, guint16 * cur, guint16 * next,
-    int w, int prefs, int mrefs, int parity, int mode)
+    int w, int prefs, int mrefs, int parity, int mode, int s)
 {
   int x;
   guint16 *prev2 = parity ? prev : cur;
@@ -113,54 +127,157 @@ filter_line_c_16bit (guint16 * dst,
   prefs /= 2;
 
 FILTER}
-#endif
 
-void yadif_filter (GstYadif * yadif, int parity, int tff);
+/* Room around the w <= 16 samples of a short line, for the 3 samples the
+ * kernels read on each side */
+#define SHORT_LINE_PAD 8
+#define SHORT_LINE_STRIDE (SHORT_LINE_PAD + 16 + SHORT_LINE_PAD)
+
+static void
+copy_short_line (guint8 * dst, const guint8 * src, int w)
+{
+  memset (dst, src[0], SHORT_LINE_PAD);
+  memcpy (dst + SHORT_LINE_PAD, src, w);
+  memset (dst + SHORT_LINE_PAD + w, src[w - 1],
+      SHORT_LINE_STRIDE - SHORT_LINE_PAD - w);
+}
+
+/* For the SIMD kernels, which always filter n samples at once: a line of
+ * w < n samples is filtered from copies of the lines around it, with the
+ * edge samples repeated, so that nothing beyond the frame is read */
+void
+yadif_filter_short_line (YadifFilterLineFunc filter_line, int n,
+    guint8 * dst, guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode)
+{
+  guint8 lines[3][5][SHORT_LINE_STRIDE];
+  guint8 *srcs[3] = { prev, cur, next };
+  guint8 out[16];
+  int i;
+
+  g_assert (w < n && n <= 16);
+
+  memset (lines, 0, sizeof (lines));
+  for (i = 0; i < 3; i++) {
+    copy_short_line (lines[i][1], srcs[i] + mrefs, w);
+    copy_short_line (lines[i][2], srcs[i], w);
+    copy_short_line (lines[i][3], srcs[i] + prefs, w);
+    /* the lines two away are only read outside of the edges */
+    if (mode < 2) {
+      copy_short_line (lines[i][0], srcs[i] + 2 * mrefs, w);
+      copy_short_line (lines[i][4], srcs[i] + 2 * prefs, w);
+    }
+  }
+
+  filter_line (out, lines[0][2] + SHORT_LINE_PAD,
+      lines[1][2] + SHORT_LINE_PAD, lines[2][2] + SHORT_LINE_PAD, n,
+      SHORT_LINE_STRIDE, -SHORT_LINE_STRIDE, parity, mode);
+  memcpy (dst, out, w);
+}
+
+void yadif_filter (GstYadif * yadif, int parity, int tff, int slice,
+    int n_slices);
 #ifdef HAVE_CPU_X86_64
 void filter_line_x86_64 (guint8 * dst,
     guint8 * prev, guint8 * cur, guint8 * next,
     int w, int prefs, int mrefs, int parity, int mode);
+gboolean filter_line_avx2_supported (void);
+void filter_line_avx2 (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+#endif
+#ifdef HAVE_YADIF_NEON
+void filter_line_neon (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+#endif
+
+/* The fastest line filter for planar 8 bit samples. All of them only write
+ * the w samples of their line, so neighbouring slices never touch each
+ * other's lines. */
+static gpointer
+yadif_find_filter_line (gpointer data)
+{
+  YadifFilterLineFunc func = filter_line_c;
+
+#ifdef HAVE_CPU_X86_64
+  func = filter_line_x86_64;
+  if (filter_line_avx2_supported ())
+    func = filter_line_avx2;
+#endif
+#ifdef HAVE_YADIF_NEON
+  func = filter_line_neon;
 #endif
 
+  return func;
+}
+
+static YadifFilterLineFunc
+yadif_get_filter_line (void)
+{
+  static GOnce once = G_ONCE_INIT;
+
+  g_once (&once, yadif_find_filter_line, NULL);
+
+  return (YadifFilterLineFunc) once.retval;
+}
+
+/* Filters the lines of slice out of n_slices, which are consecutive bands
+ * of lines in each component */
 void
-yadif_filter (GstYadif * yadif, int parity, int tff)
+yadif_filter (GstYadif * yadif, int parity, int tff, int slice, int n_slices)
 {
   int y, i;
   const GstVideoInfo *vi = &yadif->video_info;
   const GstVideoFormatInfo *vfi = vi->finfo;
+  YadifFilterLineFunc filter_line = yadif_get_filter_line ();
+  guint copied_planes = 0;
 
   for (i = 0; i < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (vfi); i++) {
     int w = GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (vfi, i, vi->width);
     int h = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (vfi, i, vi->height);
     int refs = GST_VIDEO_INFO_COMP_STRIDE (vi, i);
     int df = GST_VIDEO_INFO_COMP_PSTRIDE (vi, i);
+    int plane = GST_VIDEO_FORMAT_INFO_PLANE (vfi, i);
+    int bytes = GST_VIDEO_FORMAT_INFO_BITS (vfi) > 8 ? 2 : 1;
+    int y_start = h * slice / n_slices;
+    int y_end = h * (slice + 1) / n_slices;
+    gboolean copy_lines = !(copied_planes & (1 << plane));
     guint8 *prev_data = GST_VIDEO_FRAME_COMP_DATA (&yadif->prev_frame, i);
     guint8 *cur_data = GST_VIDEO_FRAME_COMP_DATA (&yadif->cur_frame, i);
     guint8 *next_data = GST_VIDEO_FRAME_COMP_DATA (&yadif->next_frame, i);
     guint8 *dest_data = GST_VIDEO_FRAME_COMP_DATA (&yadif->dest_frame, i);
+    guint8 *cur_plane = GST_VIDEO_FRAME_PLANE_DATA (&yadif->cur_frame, plane);
+    guint8 *dest_plane = GST_VIDEO_FRAME_PLANE_DATA (&yadif->dest_frame, plane);
+
+    /* the lines we don't interpolate are copied once per plane, and with all
+     * the components sharing it */
+    copied_planes |= 1 << plane;
 
-    for (y = 0; y < h; y++) {
+    for (y = y_start; y < y_end; y++) {
       if ((y ^ parity) & 1) {
         guint8 *prev = prev_data + y * refs;
         guint8 *cur = cur_data + y * refs;
         guint8 *next = next_data + y * refs;
         guint8 *dst = dest_data + y * refs;
         int mode = ((y == 1) || (y + 2 == h)) ? 2 : yadif->mode;
-#if HAVE_CPU_X86_64
-        if (0) {
-          filter_line_c (dst, prev, cur, next, w,
-              y + 1 < h ? refs : -refs, y ? -refs : refs, parity ^ tff, mode);
+        int mrefs = y ? -refs : refs;
+        int prefs = y + 1 < h ? refs : -refs;
+
+        if (bytes == 2) {
+          filter_line_c_16bit ((guint16 *) dst, (guint16 *) prev,
+              (guint16 *) cur, (guint16 *) next, w, prefs, mrefs,
+              parity ^ tff, mode, df / 2);
+        } else if (df == 1) {
+          filter_line (dst, prev, cur, next, w, prefs, mrefs, parity ^ tff,
+              mode);
         } else {
-          filter_line_x86_64 (dst, prev, cur, next, w,
-              y + 1 < h ? refs : -refs, y ? -refs : refs, parity ^ tff, mode);
+          filter_line_c_packed (dst, prev, cur, next, w, prefs, mrefs,
+              parity ^ tff, mode, df);
         }
-#else
-        filter_line_c (dst, prev, cur, next, w,
-            y + 1 < h ? refs : -refs, y ? -refs : refs, parity ^ tff, mode);
-#endif
-      } else {
-        guint8 *dst = dest_data + y * refs;
-        guint8 *cur = cur_data + y * refs;
+      } else if (copy_lines) {
+        guint8 *dst = dest_plane + y * refs;
+        guint8 *cur = cur_plane + y * refs;
 
         memcpy (dst, cur, w * df);
       }
@@ -20,7 +20,9 @@
 
 #include "config.h"
 
-#include <glib.h>
+#include "gstyadif.h"
+
+#include <string.h>
 
 #if HAVE_CPU_X86_64
 
@@ -82,6 +84,9 @@ void filter_line_x86_64 (guint8 * dst,
     guint8 * prev, guint8 * cur, guint8 * next,
     int w, int prefs, int mrefs, int parity, int mode);
 
+/* The asm always handles 8 pixels at a time, so the last few pixels of a
+ * line are redone as the last 8 and short lines go through padded copies,
+ * to never read beyond the frame or write beyond the line */
 void
 filter_line_x86_64 (guint8 * dst,
     guint8 * prev, guint8 * cur, guint8 * next,
@@ -101,7 +106,201 @@ filter_line_x86_64 (guint8 * dst,
     yadif->filter_line = yadif_filter_line_ssse3;
 #endif
 #endif
-  yadif_filter_line_sse2 (dst, prev, cur, next, w, prefs, mrefs, parity, mode);
+  int body = w & ~7;
+
+  if (w < 8) {
+    yadif_filter_short_line (filter_line_x86_64, 8, dst, prev, cur, next, w,
+        prefs, mrefs, parity, mode);
+    return;
+  }
+
+  yadif_filter_line_sse2 (dst, prev, cur, next, body, prefs, mrefs, parity,
+      mode);
+  if (body < w) {
+    int x = w - 8;
+
+    yadif_filter_line_sse2 (dst + x, prev + x, cur + x, next + x, 8, prefs,
+        mrefs, parity, mode);
+  }
+}
+
+#if defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__))
+#include <immintrin.h>
+
+#define AVX2_FUNC __attribute__ ((target ("avx2")))
+
+/* Same algorithm as the asm above, 16 pixels at a time */
+
+static inline AVX2_FUNC __m256i
+avx2_load (const guint8 * p)
+{
+  return _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) p));
+}
+
+static inline AVX2_FUNC __m256i
+avx2_absdiff (__m256i a, __m256i b)
+{
+  return _mm256_abs_epi16 (_mm256_sub_epi16 (a, b));
+}
+
+static inline AVX2_FUNC __m256i
+avx2_avg (__m256i a, __m256i b)
+{
+  return _mm256_srli_epi16 (_mm256_add_epi16 (a, b), 1);
+}
+
+/* ABS(cur[x-refs-1+j] - cur[x+refs-1-j]) + ... + ABS(cur[x-refs+1+j] -
+ * cur[x+refs+1-j]) */
+static inline AVX2_FUNC __m256i
+avx2_score (const guint8 * cur, int mrefs, int prefs, int j)
+{
+  __m256i s0, s1, s2;
+
+  s0 = avx2_absdiff (avx2_load (cur + mrefs - 1 + j),
+      avx2_load (cur + prefs - 1 - j));
+  s1 = avx2_absdiff (avx2_load (cur + mrefs + j), avx2_load (cur + prefs - j));
+  s2 = avx2_absdiff (avx2_load (cur + mrefs + 1 + j),
+      avx2_load (cur + prefs + 1 - j));
+
+  return _mm256_add_epi16 (_mm256_add_epi16 (s0, s1), s2);
+}
+
+static inline AVX2_FUNC void
+avx2_check (const guint8 * cur, int mrefs, int prefs, int dir,
+    __m256i * spatial_score, __m256i * spatial_pred)
+{
+  __m256i score, pred, mask;
+
+  score = avx2_score (cur, mrefs, prefs, dir);
+  mask = _mm256_cmpgt_epi16 (*spatial_score, score);
+  *spatial_score = _mm256_min_epi16 (*spatial_score, score);
+  pred = avx2_avg (avx2_load (cur + mrefs + dir),
+      avx2_load (cur + prefs - dir));
+  *spatial_pred = _mm256_blendv_epi8 (*spatial_pred, pred, mask);
+
+  /* only look further in this direction where the first step was better */
+  score = avx2_score (cur, mrefs, prefs, 2 * dir);
+  mask = _mm256_and_si256 (mask, _mm256_cmpgt_epi16 (*spatial_score, score));
+  *spatial_score = _mm256_blendv_epi8 (*spatial_score, score, mask);
+  pred = avx2_avg (avx2_load (cur + mrefs + 2 * dir),
+      avx2_load (cur + prefs - 2 * dir));
+  *spatial_pred = _mm256_blendv_epi8 (*spatial_pred, pred, mask);
+}
+
+static inline AVX2_FUNC void
+avx2_filter_pixels (guint8 * dst, const guint8 * prev, const guint8 * cur,
+    const guint8 * next, const guint8 * prev2, const guint8 * next2,
+    int prefs, int mrefs, int mode)
+{
+  __m256i c, d, e, p2, n2, diff, t1, t2;
+  __m256i spatial_pred, spatial_score, res;
+
+  c = avx2_load (cur + mrefs);
+  e = avx2_load (cur + prefs);
+  p2 = avx2_load (prev2);
+  n2 = avx2_load (next2);
+  d = avx2_avg (p2, n2);
+
+  t1 = avx2_avg (avx2_absdiff (avx2_load (prev + mrefs), c),
+      avx2_absdiff (avx2_load (prev + prefs), e));
+  t2 = avx2_avg (avx2_absdiff (avx2_load (next + mrefs), c),
+      avx2_absdiff (avx2_load (next + prefs), e));
+  diff = _mm256_srli_epi16 (avx2_absdiff (p2, n2), 1);
+  diff = _mm256_max_epi16 (_mm256_max_epi16 (diff, t1), t2);
+
+  spatial_pred = avx2_avg (c, e);
+  spatial_score = _mm256_add_epi16 (avx2_absdiff (avx2_load (cur + mrefs - 1),
+          avx2_load (cur + prefs - 1)), avx2_absdiff (c, e));
+  spatial_score = _mm256_add_epi16 (spatial_score,
+      avx2_absdiff (avx2_load (cur + mrefs + 1), avx2_load (cur + prefs + 1)));
+  spatial_score = _mm256_sub_epi16 (spatial_score, _mm256_set1_epi16 (1));
+
+  avx2_check (cur, mrefs, prefs, -1, &spatial_score, &spatial_pred);
+  avx2_check (cur, mrefs, prefs, 1, &spatial_score, &spatial_pred);
+
+  if (mode < 2) {
+    __m256i b, f, dc, de, max, min;
+
+    b = avx2_avg (avx2_load (prev2 + 2 * mrefs), avx2_load (next2 + 2 * mrefs));
+    f = avx2_avg (avx2_load (prev2 + 2 * prefs), avx2_load (next2 + 2 * prefs));
+    dc = _mm256_sub_epi16 (d, c);
+    de = _mm256_sub_epi16 (d, e);
+    b = _mm256_sub_epi16 (b, c);
+    f = _mm256_sub_epi16 (f, e);
+    max = _mm256_max_epi16 (_mm256_max_epi16 (de, dc), _mm256_min_epi16 (b, f));
+    min = _mm256_min_epi16 (_mm256_min_epi16 (de, dc), _mm256_max_epi16 (b, f));
+    diff = _mm256_max_epi16 (_mm256_max_epi16 (diff, min),
+        _mm256_sub_epi16 (_mm256_setzero_si256 (), max));
+  }
+
+  res = _mm256_max_epi16 (spatial_pred, _mm256_sub_epi16 (d, diff));
+  res = _mm256_min_epi16 (res, _mm256_add_epi16 (d, diff));
+
+  _mm_storeu_si128 ((__m128i *) dst,
+      _mm_packus_epi16 (_mm256_castsi256_si128 (res),
+          _mm256_extracti128_si256 (res, 1)));
+}
+
+gboolean filter_line_avx2_supported (void);
+void filter_line_avx2 (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+
+gboolean
+filter_line_avx2_supported (void)
+{
+  __builtin_cpu_init ();
+
+  return __builtin_cpu_supports ("avx2");
+}
+
+AVX2_FUNC void
+filter_line_avx2 (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode)
+{
+  guint8 *prev2 = parity ? prev : cur;
+  guint8 *next2 = parity ? cur : next;
+  int x;
+
+  if (w < 16) {
+    yadif_filter_short_line (filter_line_avx2, 16, dst, prev, cur, next, w,
+        prefs, mrefs, parity, mode);
+    return;
+  }
+
+  for (x = 0; x + 16 <= w; x += 16)
+    avx2_filter_pixels (dst + x, prev + x, cur + x, next + x, prev2 + x,
+        next2 + x, prefs, mrefs, mode);
+
+  if (x < w) {
+    x = w - 16;
+    avx2_filter_pixels (dst + x, prev + x, cur + x, next + x, prev2 + x,
+        next2 + x, prefs, mrefs, mode);
+  }
+}
+
+#else
+
+gboolean filter_line_avx2_supported (void);
+void filter_line_avx2 (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+
+gboolean
+filter_line_avx2_supported (void)
+{
+  return FALSE;
 }
 
+void
+filter_line_avx2 (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode)
+{
+  filter_line_x86_64 (dst, prev, cur, next, w, prefs, mrefs, parity, mode);
+}
+
+#endif
+
 #endif
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2006 Michael Niedermayer <michaelni@gmx.at>
+ *
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with Libav; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstyadif.h"
+
+#ifdef HAVE_YADIF_NEON
+
+#include <arm_neon.h>
+
+/* Same algorithm as the x86 asm, 8 pixels at a time */
+
+static inline int16x8_t
+neon_load (const guint8 * p)
+{
+  return vreinterpretq_s16_u16 (vmovl_u8 (vld1_u8 (p)));
+}
+
+static inline int16x8_t
+neon_avg (int16x8_t a, int16x8_t b)
+{
+  return vshrq_n_s16 (vaddq_s16 (a, b), 1);
+}
+
+/* ABS(cur[x-refs-1+j] - cur[x+refs-1-j]) + ... + ABS(cur[x-refs+1+j] -
+ * cur[x+refs+1-j]) */
+static inline int16x8_t
+neon_score (const guint8 * cur, int mrefs, int prefs, int j)
+{
+  int16x8_t s0, s1, s2;
+
+  s0 = vabdq_s16 (neon_load (cur + mrefs - 1 + j),
+      neon_load (cur + prefs - 1 - j));
+  s1 = vabdq_s16 (neon_load (cur + mrefs + j), neon_load (cur + prefs - j));
+  s2 = vabdq_s16 (neon_load (cur + mrefs + 1 + j),
+      neon_load (cur + prefs + 1 - j));
+
+  return vaddq_s16 (vaddq_s16 (s0, s1), s2);
+}
+
+static inline void
+neon_check (const guint8 * cur, int mrefs, int prefs, int dir,
+    int16x8_t * spatial_score, int16x8_t * spatial_pred)
+{
+  int16x8_t score, pred;
+  uint16x8_t mask;
+
+  score = neon_score (cur, mrefs, prefs, dir);
+  mask = vcltq_s16 (score, *spatial_score);
+  *spatial_score = vminq_s16 (*spatial_score, score);
+  pred = neon_avg (neon_load (cur + mrefs + dir),
+      neon_load (cur + prefs - dir));
+  *spatial_pred = vbslq_s16 (mask, pred, *spatial_pred);
+
+  /* only look further in this direction where the first step was better */
+  score = neon_score (cur, mrefs, prefs, 2 * dir);
+  mask = vandq_u16 (mask, vcltq_s16 (score, *spatial_score));
+  *spatial_score = vbslq_s16 (mask, score, *spatial_score);
+  pred = neon_avg (neon_load (cur + mrefs + 2 * dir),
+      neon_load (cur + prefs - 2 * dir));
+  *spatial_pred = vbslq_s16 (mask, pred, *spatial_pred);
+}
+
+static inline void
+neon_filter_pixels (guint8 * dst, const guint8 * prev, const guint8 * cur,
+    const guint8 * next, const guint8 * prev2, const guint8 * next2,
+    int prefs, int mrefs, int mode)
+{
+  int16x8_t c, d, e, p2, n2, diff, t1, t2;
+  int16x8_t spatial_pred, spatial_score, res;
+
+  c = neon_load (cur + mrefs);
+  e = neon_load (cur + prefs);
+  p2 = neon_load (prev2);
+  n2 = neon_load (next2);
+  d = neon_avg (p2, n2);
+
+  t1 = neon_avg (vabdq_s16 (neon_load (prev + mrefs), c),
+      vabdq_s16 (neon_load (prev + prefs), e));
+  t2 = neon_avg (vabdq_s16 (neon_load (next + mrefs), c),
+      vabdq_s16 (neon_load (next + prefs), e));
+  diff = vshrq_n_s16 (vabdq_s16 (p2, n2), 1);
+  diff = vmaxq_s16 (vmaxq_s16 (diff, t1), t2);
+
+  spatial_pred = neon_avg (c, e);
+  spatial_score = vaddq_s16 (vabdq_s16 (neon_load (cur + mrefs - 1),
+          neon_load (cur + prefs - 1)), vabdq_s16 (c, e));
+  spatial_score = vaddq_s16 (spatial_score,
+      vabdq_s16 (neon_load (cur + mrefs + 1), neon_load (cur + prefs + 1)));
+  spatial_score = vsubq_s16 (spatial_score, vdupq_n_s16 (1));
+
+  neon_check (cur, mrefs, prefs, -1, &spatial_score, &spatial_pred);
+  neon_check (cur, mrefs, prefs, 1, &spatial_score, &spatial_pred);
+
+  if (mode < 2) {
+    int16x8_t b, f, dc, de, max, min;
+
+    b = neon_avg (neon_load (prev2 + 2 * mrefs), neon_load (next2 + 2 * mrefs));
+    f = neon_avg (neon_load (prev2 + 2 * prefs), neon_load (next2 + 2 * prefs));
+    dc = vsubq_s16 (d, c);
+    de = vsubq_s16 (d, e);
+    b = vsubq_s16 (b, c);
+    f = vsubq_s16 (f, e);
+    max = vmaxq_s16 (vmaxq_s16 (de, dc), vminq_s16 (b, f));
+    min = vminq_s16 (vminq_s16 (de, dc), vmaxq_s16 (b, f));
+    diff = vmaxq_s16 (vmaxq_s16 (diff, min), vnegq_s16 (max));
+  }
+
+  res = vmaxq_s16 (spatial_pred, vsubq_s16 (d, diff));
+  res = vminq_s16 (res, vaddq_s16 (d, diff));
+
+  vst1_u8 (dst, vqmovun_s16 (res));
+}
+
+void filter_line_neon (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+
+void
+filter_line_neon (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode)
+{
+  guint8 *prev2 = parity ? prev : cur;
+  guint8 *next2 = parity ? cur : next;
+  int x;
+
+  if (w < 8) {
+    yadif_filter_short_line (filter_line_neon, 8, dst, prev, cur, next, w,
+        prefs, mrefs, parity, mode);
+    return;
+  }
+
+  for (x = 0; x + 8 <= w; x += 8)
+    neon_filter_pixels (dst + x, prev + x, cur + x, next + x, prev2 + x,
+        next2 + x, prefs, mrefs, mode);
+
+  /* redo the last 8 instead of writing beyond the line */
+  if (x < w) {
+    x = w - 8;
+    neon_filter_pixels (dst + x, prev + x, cur + x, next + x, prev2 + x,
+        next2 + x, prefs, mrefs, mode);
+  }
+}
+
+#endif
@@ -24,10 +24,20 @@
 #  include "config.h"
 #endif
 
+#define _GNU_SOURCE             /* for memfd_create() */
+
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#ifdef HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#endif
 #include <gst/base/gstbytewriter.h>
+#include <gst/allocators/gstfdmemory.h>
 #include <gst/gstprotection.h>
 #include "gstipcpipelinecomm.h"
 
@@ -36,7 +46,37 @@ GST_DEBUG_CATEGORY_STATIC (gst_ipc_pipeline_comm_debug);
 
 #define DEFAULT_ACK_TIME (10 * G_TIME_SPAN_SECOND)
 
+/* maximum number of fds we expect to receive with a single read */
+#define MAX_FDS_PER_READ 16
+
 GQuark QUARK_ID;
+static GQuark QUARK_RELEASE;
+
+/* Lets memory received as memfd tell the peer when it is freed, even if
+ * that happens after the element went away.
+ *
+ * The lock is taken before comm->mutex when writing the release, so memory
+ * that may carry a releaser, including the buffers in sent_fd_buffers, must
+ * never be unreffed with comm->mutex held */
+struct _GstIpcPipelineCommReleaser
+{
+  gint ref_count;
+  GMutex lock;
+  GstIpcPipelineComm *comm;
+};
+
+typedef struct
+{
+  GstIpcPipelineCommReleaser *releaser;
+  guint32 id;
+} CommReleaseData;
+
+static void gst_ipc_pipeline_comm_write_release_to_fd (GstIpcPipelineComm *
+    comm, guint32 id);
+static gboolean write_to_fd_raw (GstIpcPipelineComm * comm, const void *data,
+    size_t size);
+static gboolean set_field (GQuark field_id, const GValue * value,
+    gpointer user_data);
 
 typedef enum
 {
@@ -63,6 +103,7 @@ typedef struct
   GstQuery *query;
   CommRequestType type;
   GCond cond;
+  gint64 send_time;
 } CommRequest;
 
 static const gchar *comm_request_ret_get_name (CommRequestType type,
@@ -82,6 +123,7 @@ comm_request_new (guint32 id, CommRequestType type, GstQuery * query)
   req->query = query;
   req->ret = comm_request_ret_get_failure_value (type);
   req->type = type;
+  req->send_time = g_get_monotonic_time ();
 
   return req;
 }
@@ -121,6 +163,22 @@ comm_request_wait (GstIpcPipelineComm * comm, CommRequest * req,
   return ret;
 }
 
+static void
+comm_rtt_stats_add (GstIpcPipelineCommRttStats * stats, gint64 rtt)
+{
+  guint bucket = 0;
+
+  rtt = MAX (rtt, 0);
+  stats->count++;
+  stats->total += rtt;
+  stats->max = MAX (stats->max, (guint64) rtt);
+
+  /* bucket n holds [2^n, 2^(n+1)) microseconds, the last one is open */
+  while ((rtt >>= 1) && bucket < GST_IPC_PIPELINE_COMM_RTT_BUCKETS - 1)
+    bucket++;
+  stats->buckets[bucket]++;
+}
+
 static void
 comm_request_free (CommRequest * req)
 {
@@ -186,6 +244,10 @@ gst_ipc_pipeline_comm_data_type_get_name (GstIpcPipelineCommDataType type)
       return "MESSAGE";
     case GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE:
       return "GERROR_MESSAGE";
+    case GST_IPC_PIPELINE_COMM_DATA_TYPE_FD_BUFFER:
+      return "FD_BUFFER";
+    case GST_IPC_PIPELINE_COMM_DATA_TYPE_RELEASE_BUFFER:
+      return "RELEASE_BUFFER";
     default:
       return "UNKNOWN";
   }
@@ -212,6 +274,177 @@ gst_ipc_pipeline_comm_sync_fd (GstIpcPipelineComm * comm, guint32 id,
   return !comm_error;
 }
 
+static GstIpcPipelineCommReleaser *
+comm_releaser_new (GstIpcPipelineComm * comm)
+{
+  GstIpcPipelineCommReleaser *releaser;
+
+  releaser = g_new0 (GstIpcPipelineCommReleaser, 1);
+  releaser->ref_count = 1;
+  g_mutex_init (&releaser->lock);
+  releaser->comm = comm;
+
+  return releaser;
+}
+
+static GstIpcPipelineCommReleaser *
+comm_releaser_ref (GstIpcPipelineCommReleaser * releaser)
+{
+  g_atomic_int_inc (&releaser->ref_count);
+  return releaser;
+}
+
+static void
+comm_releaser_unref (GstIpcPipelineCommReleaser * releaser)
+{
+  if (g_atomic_int_dec_and_test (&releaser->ref_count)) {
+    g_mutex_clear (&releaser->lock);
+    g_free (releaser);
+  }
+}
+
+static void
+comm_release_memory (gpointer data)
+{
+  CommReleaseData *release = data;
+  GstIpcPipelineCommReleaser *releaser = release->releaser;
+
+  g_mutex_lock (&releaser->lock);
+  if (releaser->comm)
+    gst_ipc_pipeline_comm_write_release_to_fd (releaser->comm, release->id);
+  g_mutex_unlock (&releaser->lock);
+
+  comm_releaser_unref (releaser);
+  g_slice_free (CommReleaseData, release);
+}
+
+/*******************
+ * MEMFD ALLOCATOR *
+ *******************/
+
+#define GST_TYPE_IPC_PIPELINE_MEMFD_ALLOCATOR \
+  (gst_ipc_pipeline_memfd_allocator_get_type())
+
+typedef struct _GstIpcPipelineMemfdAllocator
+{
+  GstFdAllocator parent;
+} GstIpcPipelineMemfdAllocator;
+
+typedef struct _GstIpcPipelineMemfdAllocatorClass
+{
+  GstFdAllocatorClass parent;
+} GstIpcPipelineMemfdAllocatorClass;
+
+GType gst_ipc_pipeline_memfd_allocator_get_type (void);
+
+G_DEFINE_TYPE (GstIpcPipelineMemfdAllocator, gst_ipc_pipeline_memfd_allocator,
+    GST_TYPE_FD_ALLOCATOR);
+
+static GstMemory *
+gst_ipc_pipeline_memfd_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+#ifdef HAVE_MEMFD_CREATE
+  GstMemory *mem;
+  gsize maxsize = size + params->prefix + params->padding;
+  int fd;
+
+  fd = memfd_create ("gst-ipcpipeline", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    GST_ERROR_OBJECT (allocator, "memfd_create failed: %s", strerror (errno));
+    return NULL;
+  }
+
+  if (ftruncate (fd, maxsize) < 0) {
+    GST_ERROR_OBJECT (allocator, "ftruncate failed: %s", strerror (errno));
+    close (fd);
+    return NULL;
+  }
+
+  /* The size can't change anymore, so the peer can safely map it without
+   * risking a SIGBUS. Writes are sealed once the memory is sent, see
+   * gst_ipc_pipeline_comm_seal_memfd() */
+  if (fcntl (fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) < 0)
+    GST_WARNING_OBJECT (allocator, "Could not seal memfd: %s",
+        strerror (errno));
+
+  mem = gst_fd_allocator_alloc (allocator, fd, maxsize,
+      GST_FD_MEMORY_FLAG_KEEP_MAPPED);
+  if (!mem) {
+    close (fd);
+    return NULL;
+  }
+
+  gst_memory_resize (mem, params->prefix, size);
+
+  return mem;
+#else
+  return NULL;
+#endif
+}
+
+static void
+gst_ipc_pipeline_memfd_allocator_class_init (GstIpcPipelineMemfdAllocatorClass
+    * klass)
+{
+  GstAllocatorClass *allocator_class = GST_ALLOCATOR_CLASS (klass);
+
+  allocator_class->alloc = gst_ipc_pipeline_memfd_allocator_alloc;
+}
+
+static void
+gst_ipc_pipeline_memfd_allocator_init (GstIpcPipelineMemfdAllocator * self)
+{
+  GST_OBJECT_FLAG_UNSET (self, GST_ALLOCATOR_FLAG_CUSTOM_ALLOC);
+}
+
+static gboolean
+write_to_fd_with_fd (GstIpcPipelineComm * comm, const void *data,
+    size_t size, int fd)
+{
+  struct msghdr msg = { 0, };
+  struct iovec iov;
+  union
+  {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE (sizeof (int))];
+  } cmsgbuf;
+  struct cmsghdr *cmsg;
+  ssize_t written;
+
+  memset (&cmsgbuf, 0, sizeof (cmsgbuf));
+  iov.iov_base = (void *) data;
+  iov.iov_len = size;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cmsgbuf.buf;
+  msg.msg_controllen = sizeof (cmsgbuf.buf);
+  cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (int));
+  memcpy (CMSG_DATA (cmsg), &fd, sizeof (int));
+
+  GST_TRACE_OBJECT (comm->element, "Writing %zu bytes and fd %d to fdout",
+      size, fd);
+  do {
+    written = sendmsg (comm->fdout, &msg, 0);
+  } while (written < 0 && (errno == EAGAIN || errno == EINTR));
+
+  if (written < 0) {
+    GST_ERROR_OBJECT (comm->element, "Failed to send fd: %s",
+        strerror (errno));
+    return FALSE;
+  }
+
+  /* the fd went with the first byte, the rest is plain data */
+  if ((size_t) written < size)
+    return write_to_fd_raw (comm, (const guint8 *) data + written,
+        size - written);
+
+  return TRUE;
+}
+
 static gboolean
 write_to_fd_raw (GstIpcPipelineComm * comm, const void *data, size_t size)
 {
@@ -292,6 +525,40 @@ write_failed:
   goto done;
 }
 
+static void
+gst_ipc_pipeline_comm_write_release_to_fd (GstIpcPipelineComm * comm,
+    guint32 id)
+{
+  const unsigned char payload_type =
+      GST_IPC_PIPELINE_COMM_DATA_TYPE_RELEASE_BUFFER;
+  GstByteWriter bw;
+
+  g_mutex_lock (&comm->mutex);
+
+  GST_TRACE_OBJECT (comm->element, "Writing release for buffer %u", id);
+  gst_byte_writer_init (&bw);
+  if (!gst_byte_writer_put_uint8 (&bw, payload_type))
+    goto write_failed;
+  if (!gst_byte_writer_put_uint32_le (&bw, id))
+    goto write_failed;
+  if (!gst_byte_writer_put_uint32_le (&bw, 0))
+    goto write_failed;
+
+  if (!write_byte_writer_to_fd (comm, &bw))
+    goto write_failed;
+
+done:
+  g_mutex_unlock (&comm->mutex);
+  gst_byte_writer_reset (&bw);
+  return;
+
+write_failed:
+  /* the peer is probably gone already, nothing to release then */
+  GST_WARNING_OBJECT (comm->element, "Failed to write release for buffer %u",
+      id);
+  goto done;
+}
+
 void
 gst_ipc_pipeline_comm_write_flow_ack_to_fd (GstIpcPipelineComm * comm,
     guint32 id, GstFlowReturn ret)
@@ -496,6 +763,127 @@ typedef struct
   guint64 flags;
 } CommBufferMetadata;
 
+/* Forbids new writable mappings of a memfd from our allocator before it is
+ * passed to the peer, so that the peer can't write into our pages. The
+ * mapping the memory keeps on this side stays writable, which lets pooled
+ * buffers be reused once the peer released them */
+static void
+gst_ipc_pipeline_comm_seal_memfd (GstIpcPipelineComm * comm, GstMemory * mem)
+{
+#ifdef HAVE_MEMFD_CREATE
+  int fd, seals;
+
+  if (mem->allocator != comm->memfd_allocator)
+    return;
+
+  fd = gst_fd_memory_get_fd (mem);
+  seals = fcntl (fd, F_GET_SEALS);
+  if (seals < 0 || (seals & F_SEAL_SEAL))
+    return;
+
+#ifdef F_SEAL_FUTURE_WRITE
+  seals = F_SEAL_FUTURE_WRITE | F_SEAL_SEAL;
+#else
+  seals = F_SEAL_SEAL;
+#endif
+  if (fcntl (fd, F_ADD_SEALS, seals) < 0)
+    GST_WARNING_OBJECT (comm->element, "Could not seal memfd: %s",
+        strerror (errno));
+#endif
+}
+
+/* Returns a buffer whose only memory is an fd that can be passed to the
+ * peer: either @buffer itself if it already is, or a copy in a new memfd.
+ * Either way, memfds from our allocator are sealed against writes */
+static GstBuffer *
+gst_ipc_pipeline_comm_make_fd_buffer (GstIpcPipelineComm * comm,
+    GstBuffer * buffer)
+{
+  GstBuffer *fd_buffer;
+  GstMemory *mem;
+  GstMapInfo map;
+  gsize size;
+
+  if (gst_buffer_n_memory (buffer) == 1) {
+    mem = gst_buffer_peek_memory (buffer, 0);
+    if (gst_memory_is_type (mem, GST_ALLOCATOR_FD)) {
+      gst_ipc_pipeline_comm_seal_memfd (comm, mem);
+      return gst_buffer_ref (buffer);
+    }
+  }
+
+  size = gst_buffer_get_size (buffer);
+  GST_LOG_OBJECT (comm->element, "Copying %" G_GSIZE_FORMAT " bytes into a "
+      "new memfd", size);
+
+  mem = gst_allocator_alloc (comm->memfd_allocator, MAX (size, 1), NULL);
+  if (!mem)
+    return NULL;
+  if (!gst_memory_map (mem, &map, GST_MAP_WRITE)) {
+    gst_memory_unref (mem);
+    return NULL;
+  }
+  gst_buffer_extract (buffer, 0, map.data, size);
+  gst_memory_unmap (mem, &map);
+  gst_memory_resize (mem, 0, size);
+  gst_ipc_pipeline_comm_seal_memfd (comm, mem);
+
+  fd_buffer = gst_buffer_new ();
+  gst_buffer_append_memory (fd_buffer, mem);
+
+  return fd_buffer;
+}
+
+/* Must be called with the mutex held. Collects the replies to the buffers
+ * and events sent without waiting, until at most @max_pending of them are
+ * left unanswered. The first non-OK flow return sticks until the next flush
+ * so that upstream sees it on the following buffer. */
+static GstFlowReturn
+gst_ipc_pipeline_comm_collect_acks (GstIpcPipelineComm * comm,
+    guint max_pending)
+{
+  GHashTable *waiting_ids;
+  CommRequest *req;
+  CommRequestType type;
+  guint32 id, ret32;
+
+  while (!g_queue_is_empty (&comm->pending_requests)) {
+    id = GPOINTER_TO_UINT (g_queue_peek_head (&comm->pending_requests));
+    waiting_ids = g_hash_table_ref (comm->waiting_ids);
+    req = g_hash_table_lookup (waiting_ids, GINT_TO_POINTER (id));
+
+    if (req && !req->replied &&
+        g_queue_get_length (&comm->pending_requests) <= max_pending) {
+      g_hash_table_unref (waiting_ids);
+      break;
+    }
+
+    g_queue_pop_head (&comm->pending_requests);
+    if (req) {
+      type = req->type;
+      ret32 = comm_request_wait (comm, req, ACK_TYPE_BLOCKING);
+      g_hash_table_remove (waiting_ids, GINT_TO_POINTER (id));
+    } else {
+      /* cancelled */
+      type = COMM_REQUEST_TYPE_BUFFER;
+      ret32 = GST_FLOW_FLUSHING;
+    }
+    g_hash_table_unref (waiting_ids);
+
+    if (type == COMM_REQUEST_TYPE_EVENT) {
+      /* sticky events are sent again by the pad if needed */
+      if (!ret32)
+        GST_WARNING_OBJECT (comm->element, "Event %u failed on the peer", id);
+    } else if (ret32 != GST_FLOW_OK && comm->buffer_ret == GST_FLOW_OK) {
+      GST_DEBUG_OBJECT (comm->element, "Buffer %u returned %s", id,
+          gst_flow_get_name (ret32));
+      comm->buffer_ret = ret32;
+    }
+  }
+
+  return comm->buffer_ret;
+}
+
 GstFlowReturn
 gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
     GstBuffer * buffer)
@@ -508,15 +896,39 @@ gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
   GstFlowReturn ret;
   MetaListRepresentation repr = { comm, 0, 4, NULL };   /* starts a 4 for n_meta */
   GstByteWriter bw;
+  GstBuffer *fd_buffer = NULL;
+  GstMemory *fd_mem = NULL;
+
+  /* copy outside of the lock if the data is not in an fd yet */
+  if (comm->send_fds) {
+    fd_buffer = gst_ipc_pipeline_comm_make_fd_buffer (comm, buffer);
+    if (!fd_buffer) {
+      GST_ELEMENT_ERROR (comm->element, RESOURCE, WRITE, (NULL),
+          ("Failed to copy buffer to memfd"));
+      return GST_FLOW_ERROR;
+    }
+    fd_mem = gst_buffer_peek_memory (fd_buffer, 0);
+  }
 
   g_mutex_lock (&comm->mutex);
+
+  gst_byte_writer_init (&bw);
+
+  /* don't bother sending if a previous buffer already failed. This also
+   * collects what is left over if buffer-window was just lowered to 0 */
+  if (comm->buffer_window > 0 ||
+      !g_queue_is_empty (&comm->pending_requests)) {
+    ret = gst_ipc_pipeline_comm_collect_acks (comm,
+        comm->buffer_window);
+    if (ret != GST_FLOW_OK)
+      goto done;
+  }
+
   ++comm->send_id;
 
   GST_TRACE_OBJECT (comm->element, "Writing buffer %u: %" GST_PTR_FORMAT,
       comm->send_id, buffer);
 
-  gst_byte_writer_init (&bw);
-
   meta.pts = GST_BUFFER_PTS (buffer);
   meta.dts = GST_BUFFER_DTS (buffer);
   meta.duration = GST_BUFFER_DURATION (buffer);
@@ -527,13 +939,17 @@ gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
   /* work out meta size */
   gst_buffer_foreach_meta (buffer, build_meta, &repr);
 
-  if (!gst_byte_writer_put_uint8 (&bw, payload_type))
+  if (!gst_byte_writer_put_uint8 (&bw, fd_mem ?
+          GST_IPC_PIPELINE_COMM_DATA_TYPE_FD_BUFFER : payload_type))
     goto write_failed;
   if (!gst_byte_writer_put_uint32_le (&bw, comm->send_id))
     goto write_failed;
-  size =
-      gst_buffer_get_size (buffer) + sizeof (guint32) +
-      sizeof (CommBufferMetadata) + repr.total_bytes;
+  if (fd_mem)
+    size = sizeof (guint64) + sizeof (guint32) +
+        sizeof (CommBufferMetadata) + repr.total_bytes;
+  else
+    size = gst_buffer_get_size (buffer) + sizeof (guint32) +
+        sizeof (CommBufferMetadata) + repr.total_bytes;
   if (!gst_byte_writer_put_uint32_le (&bw, size))
     goto write_failed;
   if (!gst_byte_writer_put_data (&bw, (const guint8 *) &meta, sizeof (meta)))
@@ -541,15 +957,36 @@ gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
   size = gst_buffer_get_size (buffer);
   if (!gst_byte_writer_put_uint32_le (&bw, size))
     goto write_failed;
-  if (!write_byte_writer_to_fd (comm, &bw))
-    goto write_failed;
 
-  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
-    goto map_failed;
-  ret = write_to_fd_raw (comm, map.data, map.size);
-  gst_buffer_unmap (buffer, &map);
-  if (!ret)
-    goto write_failed;
+  if (fd_mem) {
+    guint8 *data;
+
+    /* only the offset goes over the socket, the data stays in the fd */
+    if (!gst_byte_writer_put_uint64_le (&bw, fd_mem->offset))
+      goto write_failed;
+    size = gst_byte_writer_get_size (&bw);
+    data = gst_byte_writer_reset_and_get_data (&bw);
+    ret = write_to_fd_with_fd (comm, data, size,
+        gst_fd_memory_get_fd (fd_mem));
+    g_free (data);
+    if (!ret)
+      goto write_failed;
+
+    /* keep the memory alive until the peer released it */
+    g_hash_table_insert (comm->sent_fd_buffers,
+        GINT_TO_POINTER (comm->send_id), fd_buffer);
+    fd_buffer = NULL;
+  } else {
+    if (!write_byte_writer_to_fd (comm, &bw))
+      goto write_failed;
+
+    if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+      goto map_failed;
+    ret = write_to_fd_raw (comm, map.data, map.size);
+    gst_buffer_unmap (buffer, &map);
+    if (!ret)
+      goto write_failed;
+  }
 
   /* meta */
   gst_byte_writer_init (&bw);
@@ -588,6 +1025,20 @@ gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
   if (!write_byte_writer_to_fd (comm, &bw))
     goto write_failed;
 
+  if (comm->buffer_window > 0) {
+    CommRequest *req;
+
+    /* don't wait, the ack is collected later */
+    req = comm_request_new (comm->send_id, COMM_REQUEST_TYPE_BUFFER, NULL);
+    g_hash_table_insert (comm->waiting_ids, GINT_TO_POINTER (comm->send_id),
+        req);
+    g_queue_push_tail (&comm->pending_requests,
+        GUINT_TO_POINTER (comm->send_id));
+    ret = gst_ipc_pipeline_comm_collect_acks (comm,
+        comm->buffer_window);
+    goto done;
+  }
+
   if (!gst_ipc_pipeline_comm_sync_fd (comm, comm->send_id, NULL, &ret32,
           ACK_TYPE_BLOCKING, COMM_REQUEST_TYPE_BUFFER))
     goto wait_failed;
@@ -599,6 +1050,8 @@ done:
   for (n = 0; n < repr.n_meta; ++n)
     g_free (repr.info[n].str);
   g_free (repr.info);
+  if (fd_buffer)
+    gst_buffer_unref (fd_buffer);
   return ret;
 
 write_failed:
@@ -620,37 +1073,95 @@ map_failed:
   goto done;
 }
 
+/* Wraps @size bytes at @offset of a passed @fd in a buffer. The peer
+ * is told when the memory is freed, so that it can reuse it */
 static GstBuffer *
-gst_ipc_pipeline_comm_read_buffer (GstIpcPipelineComm * comm, guint32 size)
+gst_ipc_pipeline_comm_wrap_fd (GstIpcPipelineComm * comm, guint32 id, int fd,
+    guint64 offset, guint32 size)
+{
+  GstMemory *mem;
+  GstBuffer *buffer;
+  CommReleaseData *data;
+  struct stat st;
+
+  if (fstat (fd, &st) < 0 || st.st_size < 0
+      || (guint64) st.st_size < offset + size) {
+    GST_ERROR_OBJECT (comm->element, "fd %d is too small for %u bytes at "
+        "offset %" G_GUINT64_FORMAT, fd, size, offset);
+    close (fd);
+    return NULL;
+  }
+
+  /* takes ownership of the fd */
+  mem = gst_fd_allocator_alloc (comm->fd_allocator, fd, offset + size,
+      GST_FD_MEMORY_FLAG_NONE);
+  if (!mem) {
+    close (fd);
+    return NULL;
+  }
+  gst_memory_resize (mem, offset, size);
+  /* the pages are shared with the sender, never write into them */
+  GST_MINI_OBJECT_FLAG_SET (mem, GST_MEMORY_FLAG_READONLY);
+
+  data = g_slice_new (CommReleaseData);
+  data->releaser = comm_releaser_ref (comm->releaser);
+  data->id = id;
+  gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (mem), QUARK_RELEASE, data,
+      comm_release_memory);
+
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer, mem);
+
+  return buffer;
+}
+
+static GstBuffer *
+gst_ipc_pipeline_comm_read_buffer (GstIpcPipelineComm * comm, guint32 id,
+    guint32 size, int fd)
 {
   GstBuffer *buffer;
   CommBufferMetadata meta;
   guint32 n_meta, n;
   const guint8 *payload = NULL;
   guint32 mapped_size, buffer_data_size;
+  guint64 fd_offset = 0;
 
   /* this should not be called if we don't have enough yet */
   g_return_val_if_fail (gst_adapter_available (comm->adapter) >= size, NULL);
   g_return_val_if_fail (size >= sizeof (CommBufferMetadata), NULL);
 
   mapped_size = sizeof (CommBufferMetadata) + sizeof (buffer_data_size);
+  if (fd >= 0)
+    mapped_size += sizeof (fd_offset);
   payload = gst_adapter_map (comm->adapter, mapped_size);
-  if (!payload)
+  if (!payload) {
+    if (fd >= 0)
+      close (fd);
     return NULL;
+  }
   memcpy (&meta, payload, sizeof (CommBufferMetadata));
   payload += sizeof (CommBufferMetadata);
   memcpy (&buffer_data_size, payload, sizeof (buffer_data_size));
+  payload += sizeof (buffer_data_size);
+  if (fd >= 0)
+    fd_offset = GST_READ_UINT64_LE (payload);
   size -= mapped_size;
   gst_adapter_unmap (comm->adapter);
   gst_adapter_flush (comm->adapter, mapped_size);
 
-  if (buffer_data_size == 0) {
+  if (fd >= 0) {
+    buffer = gst_ipc_pipeline_comm_wrap_fd (comm, id, fd, fd_offset,
+        buffer_data_size);
+    if (!buffer)
+      return NULL;
+  } else if (buffer_data_size == 0) {
     buffer = gst_buffer_new ();
+    size -= buffer_data_size;
   } else {
     buffer = gst_adapter_get_buffer (comm->adapter, buffer_data_size);
     gst_adapter_flush (comm->adapter, buffer_data_size);
+    size -= buffer_data_size;
   }
-  size -= buffer_data_size;
 
   GST_BUFFER_PTS (buffer) = meta.pts;
   GST_BUFFER_DTS (buffer) = meta.dts;
@@ -892,6 +1403,37 @@ done:
   return event;
 }
 
+/* Must be called with the mutex held */
+static void
+gst_ipc_pipeline_comm_invalidate_queries (GstIpcPipelineComm * comm,
+    const gchar * reason)
+{
+  comm->query_cache_cookie++;
+  if (g_hash_table_size (comm->query_cache) == 0)
+    return;
+
+  GST_DEBUG_OBJECT (comm->element, "Dropping cached query answers: %s",
+      reason);
+  g_hash_table_remove_all (comm->query_cache);
+}
+
+/* Whether the event, in either direction, may change the answer to a
+ * CAPS or LATENCY query */
+static gboolean
+gst_ipc_pipeline_comm_event_invalidates_queries (GstEvent * event)
+{
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_STREAM_START:
+    case GST_EVENT_CAPS:
+    case GST_EVENT_FLUSH_STOP:
+    case GST_EVENT_RECONFIGURE:
+    case GST_EVENT_LATENCY:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
 gboolean
 gst_ipc_pipeline_comm_write_event_to_fd (GstIpcPipelineComm * comm,
     gboolean upstream, GstEvent * event)
@@ -961,6 +1503,34 @@ gst_ipc_pipeline_comm_write_event_to_fd (GstIpcPipelineComm * comm,
   if (!write_byte_writer_to_fd (comm, &bw))
     goto write_failed;
 
+  if (gst_ipc_pipeline_comm_event_invalidates_queries (event))
+    gst_ipc_pipeline_comm_invalidate_queries (comm,
+        GST_EVENT_TYPE_NAME (event));
+
+  /* Sticky events are stored on the peer's pads and sent again whenever
+   * needed, so their result can be collected later like a buffer's. EOS
+   * is the exception as nothing comes after it, and CAPS as upstream
+   * needs to know whether the peer accepted them */
+  if (comm->buffer_window > 0 && !upstream && GST_EVENT_IS_STICKY (event)
+      && GST_EVENT_TYPE (event) != GST_EVENT_EOS
+      && GST_EVENT_TYPE (event) != GST_EVENT_CAPS) {
+    CommRequest *req;
+
+    req = comm_request_new (comm->send_id, COMM_REQUEST_TYPE_EVENT, NULL);
+    g_hash_table_insert (comm->waiting_ids, GINT_TO_POINTER (comm->send_id),
+        req);
+    g_queue_push_tail (&comm->pending_requests,
+        GUINT_TO_POINTER (comm->send_id));
+    gst_ipc_pipeline_comm_collect_acks (comm, comm->buffer_window);
+    ret = TRUE;
+    goto done;
+  }
+
+  /* without a window, nothing collects the acks still pending from when
+   * there was one */
+  if (comm->buffer_window == 0 && !upstream && GST_EVENT_IS_SERIALIZED (event))
+    gst_ipc_pipeline_comm_collect_acks (comm, 0);
+
   /* Upstream events get serialized, this is required to send seeks only
    * one at a time. */
   if (!gst_ipc_pipeline_comm_sync_fd (comm, comm->send_id, NULL, &ret32,
@@ -969,6 +1539,13 @@ gst_ipc_pipeline_comm_write_event_to_fd (GstIpcPipelineComm * comm,
     goto write_failed;
   ret = ret32;
 
+  /* the peer handles buffers and events in order, so the acks of all the
+   * buffers sent before are in by now. A flush clears a sticky error */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+    gst_ipc_pipeline_comm_collect_acks (comm, 0);
+    comm->buffer_ret = GST_FLOW_OK;
+  }
+
 done:
   g_mutex_unlock (&comm->mutex);
   g_free (str);
@@ -1043,9 +1620,10 @@ gst_ipc_pipeline_comm_write_query_to_fd (GstIpcPipelineComm * comm,
   const unsigned char payload_type = GST_IPC_PIPELINE_COMM_DATA_TYPE_QUERY;
   gboolean ret;
   guint32 type, size, ret32 = TRUE, slen;
-  char *str = NULL;
+  char *str = NULL, *key = NULL;
   const GstStructure *structure;
   GstByteWriter bw;
+  guint cookie = 0;
 
   g_mutex_lock (&comm->mutex);
   ++comm->send_id;
@@ -1066,6 +1644,27 @@ gst_ipc_pipeline_comm_write_query_to_fd (GstIpcPipelineComm * comm,
     str = NULL;
     slen = 0;
   }
+
+  if (comm->cache_queries && str && (GST_QUERY_TYPE (query) == GST_QUERY_CAPS
+          || GST_QUERY_TYPE (query) == GST_QUERY_LATENCY)) {
+    const GstStructure *answer;
+
+    key = g_strdup_printf ("%c%s", upstream ? 'u' : 'd', str);
+    answer = g_hash_table_lookup (comm->query_cache, key);
+    if (answer) {
+      GstStructure *s = gst_query_writable_structure (query);
+
+      GST_TRACE_OBJECT (comm->element, "Answering query from cache");
+      gst_structure_remove_all_fields (s);
+      gst_structure_foreach (answer, set_field, s);
+      comm->query_cache_hits++;
+      ret = TRUE;
+      goto done;
+    }
+    comm->query_cache_misses++;
+    cookie = comm->query_cache_cookie;
+  }
+
   size = sizeof (type) + 1 + slen + 1;
   if (!gst_byte_writer_put_uint32_le (&bw, size))
     goto write_failed;
@@ -1095,9 +1694,17 @@ gst_ipc_pipeline_comm_write_query_to_fd (GstIpcPipelineComm * comm,
 
   ret = ret32;
 
+  /* don't store an answer that may have been made stale while waiting */
+  if (key && ret && cookie == comm->query_cache_cookie) {
+    g_hash_table_insert (comm->query_cache, key,
+        gst_structure_copy (gst_query_get_structure (query)));
+    key = NULL;
+  }
+
 done:
   g_mutex_unlock (&comm->mutex);
   g_free (str);
+  g_free (key);
   gst_byte_writer_reset (&bw);
   return ret;
 
@@ -1191,6 +1798,8 @@ gst_ipc_pipeline_comm_write_state_change_to_fd (GstIpcPipelineComm * comm,
       gst_element_state_get_name (GST_STATE_TRANSITION_CURRENT (transition)),
       gst_element_state_get_name (GST_STATE_TRANSITION_NEXT (transition)));
 
+  gst_ipc_pipeline_comm_invalidate_queries (comm, "state change");
+
   gst_byte_writer_init (&bw);
   if (!gst_byte_writer_put_uint8 (&bw, payload_type))
     goto write_failed;
@@ -1607,12 +2216,43 @@ gst_ipc_pipeline_comm_init (GstIpcPipelineComm * comm, GstElement * element)
   comm->adapter = gst_adapter_new ();
   comm->poll = gst_poll_new (TRUE);
   gst_poll_fd_init (&comm->pollFDin);
+  comm->sent_fd_buffers =
+      g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) gst_buffer_unref);
+  comm->fdin_is_socket = TRUE;
+  g_queue_init (&comm->received_fds);
+  comm->fd_allocator = gst_fd_allocator_new ();
+  comm->releaser = comm_releaser_new (comm);
+  g_queue_init (&comm->pending_requests);
+  comm->buffer_ret = GST_FLOW_OK;
+  comm->query_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) gst_structure_free);
+}
+
+static void
+close_received_fd (gpointer data, gpointer user_data)
+{
+  close (GPOINTER_TO_INT (data));
 }
 
 void
 gst_ipc_pipeline_comm_clear (GstIpcPipelineComm * comm)
 {
+  /* memory still out there may not talk to us anymore */
+  g_mutex_lock (&comm->releaser->lock);
+  comm->releaser->comm = NULL;
+  g_mutex_unlock (&comm->releaser->lock);
+  comm_releaser_unref (comm->releaser);
+
   g_hash_table_destroy (comm->waiting_ids);
+  g_hash_table_destroy (comm->sent_fd_buffers);
+  g_hash_table_destroy (comm->query_cache);
+  g_queue_foreach (&comm->received_fds, close_received_fd, NULL);
+  g_queue_clear (&comm->received_fds);
+  g_queue_clear (&comm->pending_requests);
+  gst_object_unref (comm->fd_allocator);
+  if (comm->memfd_allocator)
+    gst_object_unref (comm->memfd_allocator);
   gst_object_unref (comm->adapter);
   gst_poll_free (comm->poll);
   g_mutex_clear (&comm->mutex);
@@ -1652,10 +2292,140 @@ gst_ipc_pipeline_comm_cancel (GstIpcPipelineComm * comm, gboolean cleanup)
     comm->waiting_ids =
         g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
         (GDestroyNotify) comm_request_free);
+    g_queue_clear (&comm->pending_requests);
+    comm->buffer_ret = GST_FLOW_OK;
   }
+  gst_ipc_pipeline_comm_invalidate_queries (comm, "cancelled");
   g_mutex_unlock (&comm->mutex);
 }
 
+/* Drops the buffers sent as memfd that the peer did not release yet. This
+ * is only safe once the peer is gone, as it may still read from them
+ * until it sends the release otherwise */
+void
+gst_ipc_pipeline_comm_drop_sent_buffers (GstIpcPipelineComm * comm)
+{
+  GHashTable *sent_fd_buffers;
+
+  g_mutex_lock (&comm->mutex);
+  sent_fd_buffers = comm->sent_fd_buffers;
+  comm->sent_fd_buffers =
+      g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) gst_buffer_unref);
+  g_mutex_unlock (&comm->mutex);
+
+  GST_DEBUG_OBJECT (comm->element, "Dropping %u unreleased buffers",
+      g_hash_table_size (sent_fd_buffers));
+  g_hash_table_destroy (sent_fd_buffers);
+}
+
+void
+gst_ipc_pipeline_comm_set_cache_queries (GstIpcPipelineComm * comm,
+    gboolean cache_queries)
+{
+  g_mutex_lock (&comm->mutex);
+  comm->cache_queries = cache_queries;
+  if (!cache_queries)
+    gst_ipc_pipeline_comm_invalidate_queries (comm, "caching disabled");
+  g_mutex_unlock (&comm->mutex);
+}
+
+GstStructure *
+gst_ipc_pipeline_comm_get_stats (GstIpcPipelineComm * comm)
+{
+  static const gchar *names[] = {
+    [COMM_REQUEST_TYPE_BUFFER] = "buffer",
+    [COMM_REQUEST_TYPE_EVENT] = "event",
+    [COMM_REQUEST_TYPE_QUERY] = "query",
+    [COMM_REQUEST_TYPE_STATE_CHANGE] = "state-change",
+    [COMM_REQUEST_TYPE_MESSAGE] = "message",
+  };
+  GstStructure *s;
+  guint i, n;
+
+  G_STATIC_ASSERT (G_N_ELEMENTS (names) ==
+      GST_IPC_PIPELINE_COMM_N_REQUEST_TYPES);
+
+  g_mutex_lock (&comm->mutex);
+
+  s = gst_structure_new ("application/x-ipc-pipeline-stats",
+      "query-cache-hits", G_TYPE_UINT64, comm->query_cache_hits,
+      "query-cache-misses", G_TYPE_UINT64, comm->query_cache_misses, NULL);
+
+  /* for each request type, the number of replies, the mean and maximum
+   * round trip times in microseconds and a histogram of those, where
+   * entry n counts the replies that took between 2^n and 2^(n+1) us */
+  for (i = 0; i < G_N_ELEMENTS (names); i++) {
+    const GstIpcPipelineCommRttStats *stats = &comm->rtt_stats[i];
+    GValue histogram = G_VALUE_INIT;
+    GValue v = G_VALUE_INIT;
+    gchar *field;
+
+    g_value_init (&histogram, GST_TYPE_ARRAY);
+    g_value_init (&v, G_TYPE_UINT64);
+    for (n = 0; n < GST_IPC_PIPELINE_COMM_RTT_BUCKETS; n++) {
+      g_value_set_uint64 (&v, stats->buckets[n]);
+      gst_value_array_append_value (&histogram, &v);
+    }
+    g_value_unset (&v);
+
+    field = g_strdup_printf ("%s-rtt-histogram", names[i]);
+    gst_structure_take_value (s, field, &histogram);
+    g_free (field);
+
+    field = g_strdup_printf ("%s-rtt-count", names[i]);
+    gst_structure_set (s, field, G_TYPE_UINT64, stats->count, NULL);
+    g_free (field);
+
+    field = g_strdup_printf ("%s-rtt-mean", names[i]);
+    gst_structure_set (s, field, G_TYPE_UINT64,
+        stats->count ? stats->total / stats->count : 0, NULL);
+    g_free (field);
+
+    field = g_strdup_printf ("%s-rtt-max", names[i]);
+    gst_structure_set (s, field, G_TYPE_UINT64, stats->max, NULL);
+    g_free (field);
+  }
+
+  g_mutex_unlock (&comm->mutex);
+
+  return s;
+}
+
+/* Whether to send buffers as memfd instead of copying them over fdout */
+gboolean
+gst_ipc_pipeline_comm_set_send_fds (GstIpcPipelineComm * comm,
+    gboolean send_fds)
+{
+#ifdef HAVE_MEMFD_CREATE
+  g_mutex_lock (&comm->mutex);
+  if (send_fds && !comm->memfd_allocator)
+    comm->memfd_allocator =
+        g_object_new (GST_TYPE_IPC_PIPELINE_MEMFD_ALLOCATOR, NULL);
+  comm->send_fds = send_fds;
+  g_mutex_unlock (&comm->mutex);
+  return TRUE;
+#else
+  comm->send_fds = FALSE;
+  return !send_fds;
+#endif
+}
+
+/* Returns a new ref to the allocator backing the buffers sent as memfd, or
+ * NULL if buffers are copied */
+GstAllocator *
+gst_ipc_pipeline_comm_get_memfd_allocator (GstIpcPipelineComm * comm)
+{
+  GstAllocator *allocator = NULL;
+
+  g_mutex_lock (&comm->mutex);
+  if (comm->send_fds)
+    allocator = gst_object_ref (comm->memfd_allocator);
+  g_mutex_unlock (&comm->mutex);
+
+  return allocator;
+}
+
 static gboolean
 set_field (GQuark field_id, const GValue * value, gpointer user_data)
 {
@@ -1680,6 +2450,8 @@ gst_ipc_pipeline_comm_reply_request (GstIpcPipelineComm * comm, guint32 id,
 
   GST_TRACE_OBJECT (comm->element, "Got reply %d (%s) for request %u", ret,
       comm_request_ret_get_name (req->type, ret), req->id);
+  comm_rtt_stats_add (&comm->rtt_stats[req->type],
+      g_get_monotonic_time () - req->send_time);
   req->replied = TRUE;
   req->ret = ret;
   if (query) {
@@ -1699,6 +2471,60 @@ gst_ipc_pipeline_comm_reply_request (GstIpcPipelineComm * comm, guint32 id,
   return TRUE;
 }
 
+/* Reads like read(), but also collects the fds passed along with the data.
+ * Those are queued in the order they arrive, which is the order of the
+ * messages referring to them since each one is sent with its header. */
+static ssize_t
+read_from_fd (GstIpcPipelineComm * comm, void *data, size_t size)
+{
+  struct msghdr msg = { 0, };
+  struct iovec iov;
+  union
+  {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE (sizeof (int) * MAX_FDS_PER_READ)];
+  } cmsgbuf;
+  struct cmsghdr *cmsg;
+  ssize_t sz;
+
+  if (!comm->fdin_is_socket)
+    return read (comm->pollFDin.fd, data, size);
+
+  iov.iov_base = data;
+  iov.iov_len = size;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cmsgbuf.buf;
+  msg.msg_controllen = sizeof (cmsgbuf.buf);
+
+  sz = recvmsg (comm->pollFDin.fd, &msg, MSG_CMSG_CLOEXEC);
+  if (sz < 0 && errno == ENOTSOCK) {
+    GST_DEBUG_OBJECT (comm->element, "fdin is not a socket, no fd passing");
+    comm->fdin_is_socket = FALSE;
+    return read (comm->pollFDin.fd, data, size);
+  }
+
+  if (sz > 0) {
+    for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+      int *fds;
+      guint i, n_fds;
+
+      if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+        continue;
+      fds = (int *) CMSG_DATA (cmsg);
+      n_fds = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+      for (i = 0; i < n_fds; i++) {
+        GST_TRACE_OBJECT (comm->element, "Received fd %d", fds[i]);
+        g_queue_push_tail (&comm->received_fds, GINT_TO_POINTER (fds[i]));
+      }
+    }
+    if (msg.msg_flags & MSG_CTRUNC)
+      GST_WARNING_OBJECT (comm->element, "Some passed fds were dropped");
+  }
+
+  return sz;
+}
+
 static gint
 update_adapter (GstIpcPipelineComm * comm)
 {
@@ -1724,6 +2550,7 @@ again:
     if (comm->fdin != -1 && GST_OBJECT_PARENT (comm->element)) {
       GST_DEBUG_OBJECT (comm->element, "Start watching fd %d", comm->fdin);
       comm->pollFDin.fd = comm->fdin;
+      comm->fdin_is_socket = TRUE;
       gst_poll_add_fd (comm->poll, &comm->pollFDin);
       gst_poll_fd_ctl_read (comm->poll, &comm->pollFDin, TRUE);
     }
@@ -1745,7 +2572,7 @@ again:
       mem = gst_allocator_alloc (NULL, comm->read_chunk_size, NULL);
 
     gst_memory_map (mem, &map, GST_MAP_WRITE);
-    sz = read (comm->pollFDin.fd, map.data, map.size);
+    sz = read_from_fd (comm, map.data, map.size);
     gst_memory_unmap (mem, &map);
 
     if (sz <= 0) {
@@ -1810,6 +2637,8 @@ read_many (GstIpcPipelineComm * comm)
           case GST_IPC_PIPELINE_COMM_DATA_TYPE_STATE_LOST:
           case GST_IPC_PIPELINE_COMM_DATA_TYPE_MESSAGE:
           case GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE:
+          case GST_IPC_PIPELINE_COMM_DATA_TYPE_FD_BUFFER:
+          case GST_IPC_PIPELINE_COMM_DATA_TYPE_RELEASE_BUFFER:
             GST_TRACE_OBJECT (comm->element, "switching to state %s",
                 gst_ipc_pipeline_comm_data_type_get_name (type));
             comm->state = type;
@@ -1874,14 +2703,23 @@ read_many (GstIpcPipelineComm * comm)
         break;
       }
       case GST_IPC_PIPELINE_COMM_DATA_TYPE_BUFFER:
+      case GST_IPC_PIPELINE_COMM_DATA_TYPE_FD_BUFFER:
       {
         GstBuffer *buf;
+        int fd = -1;
 
         available = gst_adapter_available (comm->adapter);
         if (available < comm->payload_length)
           goto done;
 
-        buf = gst_ipc_pipeline_comm_read_buffer (comm, comm->payload_length);
+        if (comm->state == GST_IPC_PIPELINE_COMM_DATA_TYPE_FD_BUFFER) {
+          if (g_queue_is_empty (&comm->received_fds))
+            goto buffer_failed;
+          fd = GPOINTER_TO_INT (g_queue_pop_head (&comm->received_fds));
+        }
+
+        buf = gst_ipc_pipeline_comm_read_buffer (comm, comm->id,
+            comm->payload_length, fd);
         if (!buf)
           goto buffer_failed;
 
@@ -1922,6 +2760,13 @@ read_many (GstIpcPipelineComm * comm)
         GST_TRACE_OBJECT (comm->element, "deserialized event %p of type %s",
             event, gst_event_type_get_name (event->type));
 
+        if (gst_ipc_pipeline_comm_event_invalidates_queries (event)) {
+          g_mutex_lock (&comm->mutex);
+          gst_ipc_pipeline_comm_invalidate_queries (comm,
+              GST_EVENT_TYPE_NAME (event));
+          g_mutex_unlock (&comm->mutex);
+        }
+
         gst_mini_object_set_qdata (GST_MINI_OBJECT (event), QUARK_ID,
             GINT_TO_POINTER (comm->id), NULL);
 
@@ -2042,6 +2887,12 @@ read_many (GstIpcPipelineComm * comm)
         if (!message)
           goto message_failed;
 
+        if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_LATENCY) {
+          g_mutex_lock (&comm->mutex);
+          gst_ipc_pipeline_comm_invalidate_queries (comm, "latency message");
+          g_mutex_unlock (&comm->mutex);
+        }
+
         GST_TRACE_OBJECT (comm->element, "deserialized message %p of type %s",
             message, gst_message_type_get_name (message->type));
 
@@ -2052,6 +2903,37 @@ read_many (GstIpcPipelineComm * comm)
         comm->state = GST_IPC_PIPELINE_COMM_STATE_TYPE;
         break;
       }
+      case GST_IPC_PIPELINE_COMM_DATA_TYPE_RELEASE_BUFFER:
+      {
+        GstBuffer *released;
+
+        available = gst_adapter_available (comm->adapter);
+        if (available < comm->payload_length)
+          goto done;
+
+        gst_adapter_flush (comm->adapter, comm->payload_length);
+        GST_TRACE_OBJECT (comm->element, "Got release for buffer %u",
+            comm->id);
+
+        /* the peer is done with the memory, drop our ref outside of the
+         * lock, see GstIpcPipelineCommReleaser */
+        g_mutex_lock (&comm->mutex);
+        released = g_hash_table_lookup (comm->sent_fd_buffers,
+            GINT_TO_POINTER (comm->id));
+        if (released)
+          g_hash_table_steal (comm->sent_fd_buffers,
+              GINT_TO_POINTER (comm->id));
+        g_mutex_unlock (&comm->mutex);
+        if (released)
+          gst_buffer_unref (released);
+        else
+          GST_WARNING_OBJECT (comm->element, "Release for unknown buffer %u",
+              comm->id);
+
+        GST_TRACE_OBJECT (comm->element, "switching to state TYPE");
+        comm->state = GST_IPC_PIPELINE_COMM_STATE_TYPE;
+        break;
+      }
       case GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE:
       {
         GstMessage *message;
@@ -2317,6 +3199,7 @@ gst_ipc_pipeline_comm_plugin_init (void)
     GST_DEBUG_CATEGORY_INIT (gst_ipc_pipeline_comm_debug, "ipcpipelinecomm", 0,
         "ipc pipeline comm");
     QUARK_ID = g_quark_from_static_string ("ipcpipeline-id");
+    QUARK_RELEASE = g_quark_from_static_string ("ipcpipeline-release");
     REGISTER_SERIALIZATION_NO_COMPARE (gst_event_get_type (), event);
     g_once_init_leave (&once, (gsize) 1);
   }
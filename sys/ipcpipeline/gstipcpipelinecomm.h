@@ -51,8 +51,25 @@ typedef enum {
   GST_IPC_PIPELINE_COMM_DATA_TYPE_STATE_LOST,
   GST_IPC_PIPELINE_COMM_DATA_TYPE_MESSAGE,
   GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE,
+  GST_IPC_PIPELINE_COMM_DATA_TYPE_FD_BUFFER,
+  GST_IPC_PIPELINE_COMM_DATA_TYPE_RELEASE_BUFFER,
 } GstIpcPipelineCommDataType;
 
+typedef struct _GstIpcPipelineCommReleaser GstIpcPipelineCommReleaser;
+
+/* buffer, event, query, state change, message */
+#define GST_IPC_PIPELINE_COMM_N_REQUEST_TYPES 5
+#define GST_IPC_PIPELINE_COMM_RTT_BUCKETS 20
+
+/* round trip times of the requests of one type, in microseconds */
+typedef struct
+{
+  guint64 count;
+  guint64 total;
+  guint64 max;
+  guint64 buckets[GST_IPC_PIPELINE_COMM_RTT_BUCKETS];
+} GstIpcPipelineCommRttStats;
+
 typedef struct
 {
   GstElement *element;
@@ -76,6 +93,33 @@ typedef struct
   guint read_chunk_size;
   GstClockTime ack_time;
 
+  /* buffers sent as memfd, protected by mutex */
+  gboolean send_fds;
+  GstAllocator *memfd_allocator;
+  GHashTable *sent_fd_buffers;
+
+  /* fds received over fdin, in order, not yet matched with a buffer */
+  gboolean fdin_is_socket;
+  GQueue received_fds;
+  GstAllocator *fd_allocator;
+  GstIpcPipelineCommReleaser *releaser;
+
+  /* number of buffers and sticky events that may be waiting for their
+   * reply, and the ids of those that are, protected by mutex */
+  guint buffer_window;
+  GQueue pending_requests;
+  GstFlowReturn buffer_ret;
+
+  /* answers to CAPS and LATENCY queries, keyed by the query they answer,
+   * dropped when anything they depend on may have changed. Protected by
+   * mutex, like the stats */
+  gboolean cache_queries;
+  GHashTable *query_cache;
+  guint query_cache_cookie;
+  guint64 query_cache_hits;
+  guint64 query_cache_misses;
+  GstIpcPipelineCommRttStats rtt_stats[GST_IPC_PIPELINE_COMM_N_REQUEST_TYPES];
+
   void (*on_buffer) (guint32, GstBuffer *, gpointer);
   void (*on_event) (guint32, GstEvent *, gboolean, gpointer);
   void (*on_query) (guint32, GstQuery *, gboolean, gpointer);
@@ -92,6 +136,14 @@ void gst_ipc_pipeline_comm_init (GstIpcPipelineComm *comm, GstElement *e);
 void gst_ipc_pipeline_comm_clear (GstIpcPipelineComm *comm);
 void gst_ipc_pipeline_comm_cancel (GstIpcPipelineComm * comm,
     gboolean flushing);
+void gst_ipc_pipeline_comm_drop_sent_buffers (GstIpcPipelineComm * comm);
+gboolean gst_ipc_pipeline_comm_set_send_fds (GstIpcPipelineComm * comm,
+    gboolean send_fds);
+GstAllocator * gst_ipc_pipeline_comm_get_memfd_allocator (
+    GstIpcPipelineComm * comm);
+void gst_ipc_pipeline_comm_set_cache_queries (GstIpcPipelineComm * comm,
+    gboolean cache_queries);
+GstStructure * gst_ipc_pipeline_comm_get_stats (GstIpcPipelineComm * comm);
 
 void gst_ipc_pipeline_comm_write_flow_ack_to_fd (GstIpcPipelineComm * comm,
     guint32 id, GstFlowReturn ret);
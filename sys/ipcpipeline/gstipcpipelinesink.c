@@ -66,7 +66,21 @@
  * GError are serialized differently).
  *
  * Buffers are transported by writing their content directly on the socket.
- * More efficient ways for memory sharing could be implemented in the future.
+ * If #GstIpcPipelineSink:use-memfd is set and fdin and fdout are unix domain
+ * sockets, buffers are instead sent as memfd file descriptors alongside their
+ * metadata, and ipcpipelinesrc maps them without copying. Upstream is offered
+ * a memfd allocator in the ALLOCATION query, so that buffers allocated from it
+ * are not copied at all; other buffers are copied once into a new memfd.
+ *
+ * By default, each buffer waits for the flow return of the peer before the
+ * next one is sent. #GstIpcPipelineSink:buffer-window allows that many buffers
+ * and sticky events to be in flight instead, the flow return of a buffer then
+ * being reported on one of the following buffers.
+ *
+ * With #GstIpcPipelineSink:cache-queries, the answers to CAPS and LATENCY
+ * queries are remembered until a reconfiguration (caps, latency, reconfigure
+ * or flush events, state changes) so that the frequent ones do not need a
+ * round trip. #GstIpcPipelineSink:stats reports the round trip times.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -98,11 +112,18 @@ enum
   PROP_FDOUT,
   PROP_READ_CHUNK_SIZE,
   PROP_ACK_TIME,
+  PROP_USE_MEMFD,
+  PROP_BUFFER_WINDOW,
+  PROP_CACHE_QUERIES,
+  PROP_STATS,
 };
 
 
 #define DEFAULT_READ_CHUNK_SIZE 4096
 #define DEFAULT_ACK_TIME (10 * G_TIME_SPAN_SECOND)
+#define DEFAULT_USE_MEMFD FALSE
+#define DEFAULT_BUFFER_WINDOW 0
+#define DEFAULT_CACHE_QUERIES FALSE
 
 #define _do_init \
     GST_DEBUG_CATEGORY_INIT (gst_ipc_pipeline_sink_debug, "ipcpipelinesink", 0, "ipcpipelinesink element");
@@ -174,6 +195,37 @@ gst_ipc_pipeline_sink_class_init (GstIpcPipelineSinkClass * klass)
           "Maximum time to wait for a response to a message",
           0, G_MAXUINT64, DEFAULT_ACK_TIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_USE_MEMFD,
+      g_param_spec_boolean ("use-memfd", "Use memfd",
+          "Send buffers as memfd file descriptors instead of copying their "
+          "content to the socket (fdout must be a unix domain socket)",
+          DEFAULT_USE_MEMFD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (gobject_class, PROP_BUFFER_WINDOW,
+      g_param_spec_uint ("buffer-window", "Buffer window",
+          "Number of buffers and sticky events that may be sent before the "
+          "reply to the first one was received (0 = wait for each one)",
+          0, G_MAXUINT, DEFAULT_BUFFER_WINDOW,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_CACHE_QUERIES,
+      g_param_spec_boolean ("cache-queries", "Cache queries",
+          "Answer CAPS and LATENCY queries from a cache instead of asking the "
+          "peer every time. The cache is dropped on reconfiguration",
+          DEFAULT_CACHE_QUERIES, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstIpcPipelineSink:stats:
+   *
+   * Statistics about the requests sent to ipcpipelinesrc: the number of
+   * query cache hits and misses and, for each of buffer, event, query,
+   * state-change and message, the count, mean and max round trip time of
+   * the replies in microseconds, and a histogram of those where entry n
+   * counts the replies that took between 2^n and 2^(n+1) microseconds.
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Request round trip times and query cache statistics",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   gst_ipc_pipeline_sink_signals[SIGNAL_DISCONNECT] =
       g_signal_new ("disconnect",
@@ -271,6 +323,22 @@ gst_ipc_pipeline_sink_set_property (GObject * object, guint prop_id,
     case PROP_ACK_TIME:
       sink->comm.ack_time = g_value_get_uint64 (value);
       break;
+    case PROP_CACHE_QUERIES:
+      gst_ipc_pipeline_comm_set_cache_queries (&sink->comm,
+          g_value_get_boolean (value));
+      break;
+    case PROP_USE_MEMFD:
+      if (!gst_ipc_pipeline_comm_set_send_fds (&sink->comm,
+              g_value_get_boolean (value)))
+        GST_WARNING_OBJECT (sink, "memfd not available, copying buffers");
+      break;
+    case PROP_BUFFER_WINDOW:
+      /* the acks left over when it is lowered are collected on the next
+       * buffer or serialized event */
+      g_mutex_lock (&sink->comm.mutex);
+      sink->comm.buffer_window = g_value_get_uint (value);
+      g_mutex_unlock (&sink->comm.mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -296,6 +364,18 @@ gst_ipc_pipeline_sink_get_property (GObject * object, guint prop_id,
     case PROP_ACK_TIME:
       g_value_set_uint64 (value, sink->comm.ack_time);
       break;
+    case PROP_CACHE_QUERIES:
+      g_value_set_boolean (value, sink->comm.cache_queries);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_ipc_pipeline_comm_get_stats (&sink->comm));
+      break;
+    case PROP_USE_MEMFD:
+      g_value_set_boolean (value, sink->comm.send_fds);
+      break;
+    case PROP_BUFFER_WINDOW:
+      g_value_set_uint (value, sink->comm.buffer_window);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -344,8 +424,20 @@ gst_ipc_pipeline_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
 
   switch (GST_QUERY_TYPE (query)) {
     case GST_QUERY_ALLOCATION:
-      GST_DEBUG_OBJECT (sink, "Rejecting ALLOCATION query");
-      return FALSE;
+    {
+      GstAllocator *allocator;
+
+      /* buffers from this allocator are passed to the peer as they are */
+      allocator = gst_ipc_pipeline_comm_get_memfd_allocator (&sink->comm);
+      if (!allocator) {
+        GST_DEBUG_OBJECT (sink, "Rejecting ALLOCATION query");
+        return FALSE;
+      }
+      GST_DEBUG_OBJECT (sink, "Proposing memfd allocator");
+      gst_query_add_allocation_param (query, allocator, NULL);
+      gst_object_unref (allocator);
+      return TRUE;
+    }
     case GST_QUERY_CAPS:
     {
       /* caps queries occur even while linking the pipeline.
@@ -577,6 +669,8 @@ gst_ipc_pipeline_sink_disconnect (GstIpcPipelineSink * sink)
   sink->comm.fdin = -1;
   sink->comm.fdout = -1;
   gst_ipc_pipeline_comm_cancel (&sink->comm, FALSE);
+  /* the peer will not release what it still holds */
+  gst_ipc_pipeline_comm_drop_sent_buffers (&sink->comm);
   gst_ipc_pipeline_sink_start_reader_thread (sink);
 }
 
@@ -66,6 +66,8 @@ enum
   PROP_FDOUT,
   PROP_READ_CHUNK_SIZE,
   PROP_ACK_TIME,
+  PROP_CACHE_QUERIES,
+  PROP_STATS,
   PROP_LAST,
 };
 
@@ -73,6 +75,7 @@ static GQuark QUARK_UPSTREAM;
 
 #define DEFAULT_READ_CHUNK_SIZE 65536
 #define DEFAULT_ACK_TIME (10 * G_TIME_SPAN_SECOND)
+#define DEFAULT_CACHE_QUERIES FALSE
 
 #define _do_init \
     GST_DEBUG_CATEGORY_INIT (gst_ipc_pipeline_src_debug, "ipcpipelinesrc", 0, "ipcpipelinesrc element");
@@ -158,6 +161,24 @@ gst_ipc_pipeline_src_class_init (GstIpcPipelineSrcClass * klass)
           "Maximum time to wait for a response to a message",
           0, G_MAXUINT64, DEFAULT_ACK_TIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_CACHE_QUERIES,
+      g_param_spec_boolean ("cache-queries", "Cache queries",
+          "Answer CAPS and LATENCY queries from a cache instead of asking the "
+          "peer every time. The cache is dropped on reconfiguration",
+          DEFAULT_CACHE_QUERIES, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstIpcPipelineSrc:stats:
+   *
+   * Statistics about the requests sent to ipcpipelinesink: the number of
+   * query cache hits and misses and, for each of buffer, event, query,
+   * state-change and message, the count, mean and max round trip time of
+   * the replies in microseconds, and a histogram of those where entry n
+   * counts the replies that took between 2^n and 2^(n+1) microseconds.
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Request round trip times and query cache statistics",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   gst_ipc_pipeline_src_signals[SIGNAL_FORWARD_MESSAGE] =
       g_signal_new ("forward-message", G_TYPE_FROM_CLASS (klass),
@@ -245,6 +266,10 @@ gst_ipc_pipeline_src_set_property (GObject * object, guint prop_id,
     case PROP_ACK_TIME:
       src->comm.ack_time = g_value_get_uint64 (value);
       break;
+    case PROP_CACHE_QUERIES:
+      gst_ipc_pipeline_comm_set_cache_queries (&src->comm,
+          g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -272,6 +297,12 @@ gst_ipc_pipeline_src_get_property (GObject * object, guint prop_id,
     case PROP_ACK_TIME:
       g_value_set_uint64 (value, src->comm.ack_time);
       break;
+    case PROP_CACHE_QUERIES:
+      g_value_set_boolean (value, src->comm.cache_queries);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_ipc_pipeline_comm_get_stats (&src->comm));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -31,16 +31,46 @@
  * ! shmsink socket-path=/tmp/blah shm-size=2000000
  * ]| Send video to shm buffers.
  *
+ * When #GstShmSink:use-memfd is set, every buffer is sent in its own memfd
+ * whose file descriptor is passed to each client over the control socket,
+ * instead of being placed in the shared memory area. Buffers are then never
+ * limited by the size of the area and are released individually.
+ * |[
+ * gst-launch-1.0 -v videotestsrc ! "video/x-raw, format=I420, \
+ * width=(int)1920, height=(int)1080" ! shmsink socket-path=/tmp/blah \
+ * use-memfd=true
+ * ]| Send video in memfd backed buffers.
+ *
+ * By default, a client that is slow to release its buffers holds on to
+ * shared memory until the area is full, which then blocks all the other
+ * clients. #GstShmSink:max-client-buffers and #GstShmSink:max-client-time
+ * bound how much each client may have outstanding, and
+ * #GstShmSink:client-policy selects whether the sink then waits for that
+ * client, stops sending it new buffers until it catches up, or disconnects
+ * it. The per-client counters are available in #GstShmSink:client-stats.
+ *
  */
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#define _GNU_SOURCE             /* for memfd_create() */
+
 #include "gstshmsink.h"
 
 #include <gst/gst.h>
 
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+/* Linux >= 5.1, older headers don't know it yet */
+#if defined (F_ADD_SEALS) && !defined (F_SEAL_FUTURE_WRITE)
+#define F_SEAL_FUTURE_WRITE 0x0010
+#endif
 
 /* signals */
 enum
@@ -58,17 +88,33 @@ enum
   PROP_PERMS,
   PROP_SHM_SIZE,
   PROP_WAIT_FOR_CONNECTION,
-  PROP_BUFFER_TIME
+  PROP_BUFFER_TIME,
+  PROP_USE_MEMFD,
+  PROP_MAX_CLIENT_BUFFERS,
+  PROP_MAX_CLIENT_TIME,
+  PROP_CLIENT_POLICY,
+  PROP_CLIENT_STATS
 };
 
 struct GstShmClient
 {
   ShmClient *client;
   GstPollFD pollfd;
+
+  /* protected by the object lock */
+  gboolean skip;
+  gboolean disconnecting;
+  guint64 buffers_sent;
+  guint64 buffers_dropped;
+  guint64 bytes_sent;
 };
 
 #define DEFAULT_SIZE ( 64 * 1024 * 1024 )
 #define DEFAULT_WAIT_FOR_CONNECTION (TRUE)
+#define DEFAULT_USE_MEMFD (FALSE)
+#define DEFAULT_MAX_CLIENT_BUFFERS (0)
+#define DEFAULT_MAX_CLIENT_TIME (-1)
+#define DEFAULT_CLIENT_POLICY GST_SHM_SINK_CLIENT_POLICY_BLOCK
 /* Default is user read/write, group read */
 #define DEFAULT_PERMS ( S_IRUSR | S_IWUSR | S_IRGRP )
 
@@ -81,6 +127,28 @@ static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS_ANY);
 
+#define GST_TYPE_SHM_SINK_CLIENT_POLICY \
+  (gst_shm_sink_client_policy_get_type ())
+static GType
+gst_shm_sink_client_policy_get_type (void)
+{
+  static GType shm_sink_client_policy_type = 0;
+  static const GEnumValue client_policy[] = {
+    {GST_SHM_SINK_CLIENT_POLICY_BLOCK, "Wait for the client", "block"},
+    {GST_SHM_SINK_CLIENT_POLICY_DROP,
+        "Don't send new buffers to the client", "drop"},
+    {GST_SHM_SINK_CLIENT_POLICY_DISCONNECT, "Disconnect the client",
+        "disconnect"},
+    {0, NULL, NULL},
+  };
+
+  if (!shm_sink_client_policy_type) {
+    shm_sink_client_policy_type =
+        g_enum_register_static ("GstShmSinkClientPolicy", client_policy);
+  }
+  return shm_sink_client_policy_type;
+}
+
 #define gst_shm_sink_parent_class parent_class
 G_DEFINE_TYPE (GstShmSink, gst_shm_sink, GST_TYPE_BASE_SINK);
 
@@ -343,6 +411,113 @@ gst_shm_sink_allocator_new (GstShmSink * sink)
 }
 
 
+/*******************
+ * MEMFD ALLOCATOR *
+ *******************/
+
+#define GST_TYPE_SHM_SINK_MEMFD_ALLOCATOR \
+  (gst_shm_sink_memfd_allocator_get_type())
+
+typedef struct _GstShmSinkMemfdAllocator
+{
+  GstFdAllocator parent;
+} GstShmSinkMemfdAllocator;
+
+typedef struct _GstShmSinkMemfdAllocatorClass
+{
+  GstFdAllocatorClass parent;
+} GstShmSinkMemfdAllocatorClass;
+
+GType gst_shm_sink_memfd_allocator_get_type (void);
+
+G_DEFINE_TYPE (GstShmSinkMemfdAllocator, gst_shm_sink_memfd_allocator,
+    GST_TYPE_FD_ALLOCATOR);
+
+static GstMemory *
+gst_shm_sink_memfd_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+#ifdef HAVE_MEMFD_CREATE
+  GstMemory *mem;
+  GstMapInfo map;
+  gsize maxsize = size + params->prefix + params->padding;
+  int fd;
+
+  fd = memfd_create ("gst-shmsink", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    GST_ERROR_OBJECT (allocator, "memfd_create failed: %s", strerror (errno));
+    return NULL;
+  }
+
+  if (ftruncate (fd, maxsize) < 0) {
+    GST_ERROR_OBJECT (allocator, "ftruncate failed: %s", strerror (errno));
+    close (fd);
+    return NULL;
+  }
+
+  mem = gst_fd_allocator_alloc (allocator, fd, maxsize,
+      GST_FD_MEMORY_FLAG_KEEP_MAPPED);
+  if (!mem) {
+    close (fd);
+    return NULL;
+  }
+
+  /* Our writable mapping is kept for the lifetime of the memory, it is the
+   * only one that can exist once the memfd is sealed below */
+  if (!gst_memory_map (mem, &map, GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT (allocator, "Could not map memfd %d", fd);
+    gst_memory_unref (mem);
+    return NULL;
+  }
+  gst_memory_unmap (mem, &map);
+
+  /* The size can't change anymore, so the clients can safely map it
+   * without risking a SIGBUS, and nobody else can write to it */
+  if (fcntl (fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW |
+          F_SEAL_FUTURE_WRITE | F_SEAL_SEAL) < 0) {
+    GST_DEBUG_OBJECT (allocator, "Could not write-seal memfd: %s",
+        strerror (errno));
+    if (fcntl (fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0)
+      GST_WARNING_OBJECT (allocator, "Could not seal memfd: %s",
+          strerror (errno));
+  }
+
+  gst_memory_resize (mem, params->prefix, size);
+
+  GST_LOG_OBJECT (allocator, "Allocated memfd %d of %" G_GSIZE_FORMAT
+      " bytes", fd, maxsize);
+
+  return mem;
+#else
+  return NULL;
+#endif
+}
+
+static void
+gst_shm_sink_memfd_allocator_class_init (GstShmSinkMemfdAllocatorClass * klass)
+{
+  GstAllocatorClass *allocator_class = GST_ALLOCATOR_CLASS (klass);
+
+  allocator_class->alloc = gst_shm_sink_memfd_allocator_alloc;
+}
+
+static void
+gst_shm_sink_memfd_allocator_init (GstShmSinkMemfdAllocator * self)
+{
+  GST_OBJECT_FLAG_UNSET (self, GST_ALLOCATOR_FLAG_CUSTOM_ALLOC);
+}
+
+static GstAllocator *
+gst_shm_sink_memfd_allocator_new (void)
+{
+  GstAllocator *self = g_object_new (GST_TYPE_SHM_SINK_MEMFD_ALLOCATOR, NULL);
+
+  gst_object_ref_sink (self);
+
+  return self;
+}
+
+
 /***************
  * MAIN OBJECT *
  ***************/
@@ -355,6 +530,10 @@ gst_shm_sink_init (GstShmSink * self)
   self->unlock = FALSE;
   self->wait_for_connection = DEFAULT_WAIT_FOR_CONNECTION;
   self->perms = DEFAULT_PERMS;
+  self->use_memfd = DEFAULT_USE_MEMFD;
+  self->max_client_buffers = DEFAULT_MAX_CLIENT_BUFFERS;
+  self->max_client_time = DEFAULT_MAX_CLIENT_TIME;
+  self->client_policy = DEFAULT_CLIENT_POLICY;
 
   gst_allocation_params_init (&self->params);
 }
@@ -417,6 +596,49 @@ gst_shm_sink_class_init (GstShmSinkClass * klass)
           -1, G_MAXINT64, -1,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_USE_MEMFD,
+      g_param_spec_boolean ("use-memfd",
+          "Use memfd",
+          "Send each buffer as a sealed memfd passed over the control socket "
+          "instead of copying it into the shared memory area. "
+          "This may be modified during the NULL->READY transition",
+          DEFAULT_USE_MEMFD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_MAX_CLIENT_BUFFERS,
+      g_param_spec_uint ("max-client-buffers",
+          "Maximum buffers per client",
+          "Maximum number of buffers a client may hold before client-policy "
+          "is applied (0 = unlimited)",
+          0, G_MAXUINT, DEFAULT_MAX_CLIENT_BUFFERS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_MAX_CLIENT_TIME,
+      g_param_spec_int64 ("max-client-time",
+          "Maximum time per client",
+          "Maximum age in nanoseconds of the oldest buffer a client may hold "
+          "before client-policy is applied (-1 = unlimited)",
+          -1, G_MAXINT64, DEFAULT_MAX_CLIENT_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_CLIENT_POLICY,
+      g_param_spec_enum ("client-policy",
+          "Slow client policy",
+          "What to do with a client that holds too many buffers",
+          GST_TYPE_SHM_SINK_CLIENT_POLICY, DEFAULT_CLIENT_POLICY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstShmSink:client-stats:
+   *
+   * A #GstStructure with a "clients" array holding one structure per
+   * connected client with its "fd", "pending-buffers", "buffers-sent",
+   * "buffers-dropped" and "bytes-sent".
+   */
+  g_object_class_install_property (gobject_class, PROP_CLIENT_STATS,
+      g_param_spec_boxed ("client-stats", "Client statistics",
+          "Statistics for each connected client", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   signals[SIGNAL_CLIENT_CONNECTED] = g_signal_new ("client-connected",
       GST_TYPE_SHM_SINK, G_SIGNAL_RUN_LAST, 0, NULL, NULL,
       g_cclosure_marshal_VOID__INT, G_TYPE_NONE, 1, G_TYPE_INT);
@@ -505,11 +727,65 @@ gst_shm_sink_set_property (GObject * object, guint prop_id,
       GST_OBJECT_UNLOCK (object);
       g_cond_broadcast (&self->cond);
       break;
+    case PROP_USE_MEMFD:
+      GST_OBJECT_LOCK (object);
+      self->use_memfd = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
+    case PROP_MAX_CLIENT_BUFFERS:
+      GST_OBJECT_LOCK (object);
+      self->max_client_buffers = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (object);
+      g_cond_broadcast (&self->cond);
+      break;
+    case PROP_MAX_CLIENT_TIME:
+      GST_OBJECT_LOCK (object);
+      self->max_client_time = g_value_get_int64 (value);
+      GST_OBJECT_UNLOCK (object);
+      g_cond_broadcast (&self->cond);
+      break;
+    case PROP_CLIENT_POLICY:
+      GST_OBJECT_LOCK (object);
+      self->client_policy = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (object);
+      g_cond_broadcast (&self->cond);
+      break;
     default:
       break;
   }
 }
 
+/* Must be called with the object lock held */
+static GstStructure *
+gst_shm_sink_get_client_stats (GstShmSink * self)
+{
+  GstStructure *s;
+  GValue clients = G_VALUE_INIT;
+  GList *item;
+
+  g_value_init (&clients, GST_TYPE_ARRAY);
+
+  for (item = self->clients; item; item = item->next) {
+    struct GstShmClient *gclient = item->data;
+    GValue v = G_VALUE_INIT;
+
+    g_value_init (&v, GST_TYPE_STRUCTURE);
+    g_value_take_boxed (&v, gst_structure_new ("client",
+            "fd", G_TYPE_INT, gclient->pollfd.fd,
+            "pending-buffers", G_TYPE_INT,
+            sp_writer_client_get_pending (gclient->client),
+            "buffers-sent", G_TYPE_UINT64, gclient->buffers_sent,
+            "buffers-dropped", G_TYPE_UINT64, gclient->buffers_dropped,
+            "bytes-sent", G_TYPE_UINT64, gclient->bytes_sent, NULL));
+    gst_value_array_append_and_take_value (&clients, &v);
+  }
+
+  s = gst_structure_new_empty ("application/x-shm-sink-stats");
+  gst_structure_take_value (s, "clients", &clients);
+
+  return s;
+}
+
 static void
 gst_shm_sink_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
@@ -534,6 +810,21 @@ gst_shm_sink_get_property (GObject * object, guint prop_id,
     case PROP_BUFFER_TIME:
       g_value_set_int64 (value, self->buffer_time);
       break;
+    case PROP_USE_MEMFD:
+      g_value_set_boolean (value, self->use_memfd);
+      break;
+    case PROP_MAX_CLIENT_BUFFERS:
+      g_value_set_uint (value, self->max_client_buffers);
+      break;
+    case PROP_MAX_CLIENT_TIME:
+      g_value_set_int64 (value, self->max_client_time);
+      break;
+    case PROP_CLIENT_POLICY:
+      g_value_set_enum (value, self->client_policy);
+      break;
+    case PROP_CLIENT_STATS:
+      g_value_take_boxed (value, gst_shm_sink_get_client_stats (self));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -558,6 +849,14 @@ gst_shm_sink_start (GstBaseSink * bsink)
     return FALSE;
   }
 
+#ifndef HAVE_MEMFD_CREATE
+  if (self->use_memfd) {
+    GST_ELEMENT_ERROR (self, RESOURCE, SETTINGS,
+        ("memfd is not supported on this platform."), (NULL));
+    return FALSE;
+  }
+#endif
+
   GST_DEBUG_OBJECT (self, "Creating new socket at %s"
       " with shared memory of %d bytes", self->socket_path, self->size);
 
@@ -588,6 +887,8 @@ gst_shm_sink_start (GstBaseSink * bsink)
     goto thread_error;
 
   self->allocator = gst_shm_sink_allocator_new (self);
+  if (self->use_memfd)
+    self->memfd_allocator = gst_shm_sink_memfd_allocator_new ();
 
   return TRUE;
 
@@ -616,6 +917,10 @@ gst_shm_sink_stop (GstBaseSink * bsink)
     gst_object_unref (self->allocator);
   self->allocator = NULL;
 
+  if (self->memfd_allocator)
+    gst_object_unref (self->memfd_allocator);
+  self->memfd_allocator = NULL;
+
   g_thread_join (self->pollthread);
   self->pollthread = NULL;
 
@@ -658,6 +963,198 @@ gst_shm_sink_can_render (GstShmSink * self, GstClockTime time)
   return TRUE;
 }
 
+/* Must be called with the object lock held */
+static gboolean
+gst_shm_sink_client_is_late (GstShmSink * self,
+    struct GstShmClient *gclient, GstClockTime time)
+{
+  ShmBuffer *b;
+
+  if (self->max_client_buffers > 0 &&
+      sp_writer_client_get_pending (gclient->client) >=
+      self->max_client_buffers)
+    return TRUE;
+
+  if (self->max_client_time < 0 || !GST_CLOCK_TIME_IS_VALID (time))
+    return FALSE;
+
+  b = sp_writer_get_pending_buffers (self->pipe);
+  for (; b != NULL; b = sp_writer_get_next_buffer (b)) {
+    GstBuffer *buf = sp_writer_buf_get_tag (b);
+
+    if (GST_BUFFER_PTS_IS_VALID (buf) &&
+        GST_CLOCK_DIFF (GST_BUFFER_PTS (buf), time) > self->max_client_time &&
+        sp_writer_buf_has_client (b, gclient->client))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* Applies the client policy to the clients that hold too many buffers.
+ * Returns FALSE if the buffer must wait for a client to catch up.
+ * Must be called with the object lock held */
+static gboolean
+gst_shm_sink_check_clients (GstShmSink * self, GstClockTime time)
+{
+  GList *item;
+
+  if (self->max_client_buffers == 0 && self->max_client_time < 0)
+    return TRUE;
+
+  for (item = self->clients; item; item = item->next) {
+    struct GstShmClient *gclient = item->data;
+
+    gclient->skip = gclient->disconnecting;
+
+    if (gclient->skip || !gst_shm_sink_client_is_late (self, gclient, time))
+      continue;
+
+    switch (self->client_policy) {
+      case GST_SHM_SINK_CLIENT_POLICY_BLOCK:
+        GST_LOG_OBJECT (self, "Client %d is late, waiting for it",
+            gclient->pollfd.fd);
+        return FALSE;
+      case GST_SHM_SINK_CLIENT_POLICY_DROP:
+        GST_LOG_OBJECT (self, "Client %d is late, dropping buffer for it",
+            gclient->pollfd.fd);
+        gclient->skip = TRUE;
+        break;
+      case GST_SHM_SINK_CLIENT_POLICY_DISCONNECT:
+        GST_WARNING_OBJECT (self, "Client %d is late, disconnecting it",
+            gclient->pollfd.fd);
+        /* The poll thread will notice and close it */
+        shutdown (gclient->pollfd.fd, SHUT_RDWR);
+        gclient->disconnecting = TRUE;
+        gclient->skip = TRUE;
+        break;
+    }
+  }
+
+  return TRUE;
+}
+
+/* Must be called with the object lock held, right before and right after
+ * sending a buffer */
+static void
+gst_shm_sink_update_clients (GstShmSink * self, gsize size, gboolean sent)
+{
+  GList *item;
+
+  for (item = self->clients; item; item = item->next) {
+    struct GstShmClient *gclient = item->data;
+
+    if (!sent) {
+      sp_writer_client_set_skip (gclient->client, gclient->skip);
+      continue;
+    }
+
+    if (gclient->skip) {
+      gclient->buffers_dropped++;
+    } else {
+      gclient->buffers_sent++;
+      gclient->bytes_sent += size;
+    }
+    gclient->skip = FALSE;
+    sp_writer_client_set_skip (gclient->client, FALSE);
+  }
+}
+
+/* Reopen @fd read-only, so the clients can't write through it even where
+ * the kernel doesn't support write seals. Returns -1 if that's not
+ * possible. */
+static int
+gst_shm_sink_reopen_read_only (int fd)
+{
+  gchar path[64];
+
+  g_snprintf (path, sizeof (path), "/proc/self/fd/%d", fd);
+
+  return open (path, O_RDONLY | O_CLOEXEC);
+}
+
+/* Must be called with the object lock held */
+static GstFlowReturn
+gst_shm_sink_render_memfd (GstShmSink * self, GstBuffer * buf)
+{
+  GstMemory *memory = NULL;
+  GstBuffer *sendbuf;
+  gsize offset;
+  int fd, rofd;
+  int rv;
+
+  if (gst_buffer_n_memory (buf) == 1)
+    memory = gst_buffer_peek_memory (buf, 0);
+
+  /* Only our own memfds are sealed and stay unchanged until the clients
+   * are done with them, anything else is copied */
+  if (memory && memory->allocator == self->memfd_allocator) {
+    sendbuf = gst_buffer_ref (buf);
+  } else {
+    GstMapInfo map;
+    gsize size = gst_buffer_get_size (buf);
+
+    GST_LOG_OBJECT (self, "Buffer %p is not in one of our memfds, copying "
+        "%" G_GSIZE_FORMAT " bytes into a new memfd", buf, size);
+
+    memory = gst_allocator_alloc (self->memfd_allocator, size, &self->params);
+    if (!memory) {
+      GST_ELEMENT_ERROR (self, RESOURCE, NO_SPACE_LEFT, (NULL),
+          ("Could not allocate memfd of %" G_GSIZE_FORMAT " bytes", size));
+      return GST_FLOW_ERROR;
+    }
+
+    if (!gst_memory_map (memory, &map, GST_MAP_WRITE)) {
+      GST_ELEMENT_ERROR (self, STREAM, FAILED,
+          (NULL), ("Failed to map memory"));
+      gst_memory_unref (memory);
+      return GST_FLOW_ERROR;
+    }
+    gst_buffer_extract (buf, 0, map.data, map.size);
+    gst_memory_unmap (memory, &map);
+
+    sendbuf = gst_buffer_new ();
+    if (!gst_buffer_copy_into (sendbuf, buf, GST_BUFFER_COPY_METADATA, 0, -1)) {
+      GST_ELEMENT_ERROR (self, STREAM, FAILED,
+          (NULL), ("Failed to copy data into send buffer"));
+      gst_memory_unref (memory);
+      gst_buffer_unref (sendbuf);
+      return GST_FLOW_ERROR;
+    }
+    gst_buffer_append_memory (sendbuf, memory);
+  }
+
+  gst_memory_get_sizes (memory, &offset, NULL);
+
+  fd = gst_fd_memory_get_fd (memory);
+  rofd = gst_shm_sink_reopen_read_only (fd);
+  if (rofd < 0)
+    GST_LOG_OBJECT (self, "Could not reopen memfd %d read-only: %s", fd,
+        strerror (errno));
+
+  gst_shm_sink_update_clients (self, memory->size, FALSE);
+  rv = sp_writer_send_fd_buf (self->pipe, rofd >= 0 ? rofd : fd,
+      offset, memory->size, sendbuf);
+  gst_shm_sink_update_clients (self, memory->size, rv != -1);
+
+  /* sending duplicated it for the clients */
+  if (rofd >= 0)
+    close (rofd);
+  if (rv == -1) {
+    GST_ELEMENT_ERROR (self, STREAM, FAILED,
+        (NULL), ("Failed to send memfd over socket"));
+    gst_buffer_unref (sendbuf);
+    return GST_FLOW_ERROR;
+  }
+
+  if (rv == 0) {
+    GST_DEBUG_OBJECT (self, "No clients connected, unreffing buffer");
+    gst_buffer_unref (sendbuf);
+  }
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
 {
@@ -700,6 +1197,23 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     }
   }
 
+  while (!gst_shm_sink_check_clients (self, GST_BUFFER_TIMESTAMP (buf))) {
+    g_cond_wait (&self->cond, GST_OBJECT_GET_LOCK (self));
+    if (self->unlock) {
+      GST_OBJECT_UNLOCK (self);
+      ret = gst_base_sink_wait_preroll (bsink);
+      if (ret == GST_FLOW_OK)
+        GST_OBJECT_LOCK (self);
+      else
+        return ret;
+    }
+  }
+
+  if (self->memfd_allocator) {
+    ret = gst_shm_sink_render_memfd (self, buf);
+    GST_OBJECT_UNLOCK (self);
+    return ret;
+  }
 
   if (gst_buffer_n_memory (buf) > 1) {
     GST_LOG_OBJECT (self, "Buffer %p has %d GstMemory, we only support a single"
@@ -788,7 +1302,9 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
    * We know it's not mapped for writing anywhere as we just mapped it for
    * reading
    */
+  gst_shm_sink_update_clients (self, map.size, FALSE);
   rv = sp_writer_send_buf (self->pipe, (char *) map.data, map.size, sendbuf);
+  gst_shm_sink_update_clients (self, map.size, rv != -1);
   if (rv == -1) {
     GST_ELEMENT_ERROR (self, STREAM, FAILED,
         (NULL), ("Failed to send data over SHM"));
@@ -875,13 +1391,15 @@ pollthread_func (gpointer data)
         return NULL;
       }
 
-      gclient = g_slice_new (struct GstShmClient);
+      gclient = g_slice_new0 (struct GstShmClient);
       gclient->client = client;
       gst_poll_fd_init (&gclient->pollfd);
       gclient->pollfd.fd = sp_writer_get_client_fd (client);
       gst_poll_add_fd (self->poll, &gclient->pollfd);
       gst_poll_fd_ctl_read (self->poll, &gclient->pollfd, TRUE);
+      GST_OBJECT_LOCK (self);
       self->clients = g_list_prepend (self->clients, gclient);
+      GST_OBJECT_UNLOCK (self);
       g_signal_emit (self, signals[SIGNAL_CLIENT_CONNECTED], 0,
           gclient->pollfd.fd);
       /* we need to call gst_poll_wait before calling gst_poll_* status
@@ -930,14 +1448,16 @@ pollthread_func (gpointer data)
       {
         GSList *list = NULL;
         GST_OBJECT_LOCK (self);
+        /* the ShmClient is freed here, so nothing must find it through
+         * the list anymore once the lock is released */
         sp_writer_close_client (self->pipe, gclient->client,
             (sp_buffer_free_callback) free_buffer_locked, (void **) &list);
+        self->clients = g_list_remove (self->clients, gclient);
         GST_OBJECT_UNLOCK (self);
         g_slist_free_full (list, (GDestroyNotify) gst_buffer_unref);
       }
 
       gst_poll_remove_fd (self->poll, &gclient->pollfd);
-      self->clients = g_list_remove (self->clients, gclient);
 
       g_signal_emit (self, signals[SIGNAL_CLIENT_DISCONNECTED], 0,
           gclient->pollfd.fd);
@@ -1003,7 +1523,9 @@ gst_shm_sink_propose_allocation (GstBaseSink * sink, GstQuery * query)
 {
   GstShmSink *self = GST_SHM_SINK (sink);
 
-  if (self->allocator)
+  if (self->memfd_allocator)
+    gst_query_add_allocation_param (query, self->memfd_allocator, NULL);
+  else if (self->allocator)
     gst_query_add_allocation_param (query, GST_ALLOCATOR (self->allocator),
         NULL);
 
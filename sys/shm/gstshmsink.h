@@ -24,6 +24,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstbasesink.h>
+#include <gst/allocators/allocators.h>
 
 #include "shmpipe.h"
 
@@ -42,6 +43,23 @@ typedef struct _GstShmSink GstShmSink;
 typedef struct _GstShmSinkClass GstShmSinkClass;
 typedef struct _GstShmSinkAllocator GstShmSinkAllocator;
 
+/**
+ * GstShmSinkClientPolicy:
+ * @GST_SHM_SINK_CLIENT_POLICY_BLOCK: wait until the client catches up
+ * @GST_SHM_SINK_CLIENT_POLICY_DROP: don't send new buffers to the client
+ *   until it catches up
+ * @GST_SHM_SINK_CLIENT_POLICY_DISCONNECT: disconnect the client
+ *
+ * What to do with a client that has more buffers outstanding than
+ * allowed by #GstShmSink:max-client-buffers or #GstShmSink:max-client-time
+ */
+typedef enum
+{
+  GST_SHM_SINK_CLIENT_POLICY_BLOCK,
+  GST_SHM_SINK_CLIENT_POLICY_DROP,
+  GST_SHM_SINK_CLIENT_POLICY_DISCONNECT
+} GstShmSinkClientPolicy;
+
 struct _GstShmSink
 {
   GstBaseSink element;
@@ -64,10 +82,17 @@ struct _GstShmSink
   gboolean unlock;
   GstClockTimeDiff buffer_time;
 
+  guint max_client_buffers;
+  GstClockTimeDiff max_client_time;
+  GstShmSinkClientPolicy client_policy;
+
   GCond cond;
 
   GstShmSinkAllocator *allocator;
 
+  gboolean use_memfd;
+  GstAllocator *memfd_allocator;
+
   GstAllocationParams params;
 };
 
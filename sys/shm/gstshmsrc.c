@@ -62,6 +62,7 @@ enum
 struct GstShmBuffer
 {
   char *buf;
+  unsigned int fd_id;
   GstShmPipe *pipe;
 };
 
@@ -69,6 +70,8 @@ struct GstShmBuffer
 GST_DEBUG_CATEGORY_STATIC (shmsrc_debug);
 #define GST_CAT_DEFAULT shmsrc_debug
 
+static GQuark shm_fd_buffer_quark;
+
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
@@ -145,6 +148,8 @@ gst_shm_src_class_init (GstShmSrcClass * klass)
       "Olivier Crete <olivier.crete@collabora.co.uk>");
 
   GST_DEBUG_CATEGORY_INIT (shmsrc_debug, "shmsrc", 0, "Shared Memory Source");
+
+  shm_fd_buffer_quark = g_quark_from_static_string ("GstShmSrcFdBuffer");
 }
 
 static void
@@ -152,6 +157,7 @@ gst_shm_src_init (GstShmSrc * self)
 {
   self->poll = gst_poll_new (TRUE);
   gst_poll_fd_init (&self->pollfd);
+  self->fd_allocator = gst_fd_allocator_new ();
 }
 
 static void
@@ -160,6 +166,7 @@ gst_shm_src_finalize (GObject * object)
   GstShmSrc *self = GST_SHM_SRC (object);
 
   gst_poll_free (self->poll);
+  gst_object_unref (self->fd_allocator);
   g_free (self->socket_path);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -318,12 +325,33 @@ free_buffer (gpointer data)
   g_slice_free (struct GstShmBuffer, gsb);
 }
 
+static void
+free_fd_buffer (gpointer data)
+{
+  struct GstShmBuffer *gsb = data;
+  g_return_if_fail (gsb->pipe != NULL);
+  g_return_if_fail (gsb->pipe->src != NULL);
+
+  GST_LOG ("Freeing fd buffer %u", gsb->fd_id);
+
+  GST_OBJECT_LOCK (gsb->pipe->src);
+  sp_client_recv_fd_finish (gsb->pipe->pipe, gsb->fd_id);
+  GST_OBJECT_UNLOCK (gsb->pipe->src);
+
+  gst_shm_pipe_dec (gsb->pipe);
+
+  g_slice_free (struct GstShmBuffer, gsb);
+}
+
 static GstFlowReturn
 gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 {
   GstShmSrc *self = GST_SHM_SRC (psrc);
   GstShmPipe *pipe;
   gchar *buf = NULL;
+  int fd = -1;
+  unsigned long offset = 0;
+  unsigned int fd_id = 0;
   int rv = 0;
   struct GstShmBuffer *gsb;
 
@@ -367,7 +395,7 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
       buf = NULL;
       GST_LOG_OBJECT (self, "Reading from pipe");
       GST_OBJECT_LOCK (self);
-      rv = sp_client_recv (pipe->pipe, &buf);
+      rv = sp_client_recv_full (pipe->pipe, &buf, &fd, &offset, &fd_id);
       GST_OBJECT_UNLOCK (self);
       if (rv < 0) {
         GST_ELEMENT_ERROR (self, RESOURCE, READ, ("Failed to read from shmsrc"),
@@ -375,16 +403,37 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
         goto error;
       }
     }
-  } while (buf == NULL);
-
-  GST_LOG_OBJECT (self, "Got buffer %p of size %d", buf, rv);
+  } while (buf == NULL && fd < 0);
 
   gsb = g_slice_new0 (struct GstShmBuffer);
   gsb->buf = buf;
   gsb->pipe = pipe;
 
-  *outbuf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
-      buf, rv, 0, rv, gsb, free_buffer);
+  if (fd >= 0) {
+    GstMemory *mem;
+
+    GST_LOG_OBJECT (self, "Got fd buffer %u (fd %d) of size %d at offset %lu",
+        fd_id, fd, rv, offset);
+
+    gsb->fd_id = fd_id;
+
+    /* The memory takes ownership of the fd, and gives the buffer back to
+     * the writer once it is freed */
+    mem = gst_fd_allocator_alloc (self->fd_allocator, fd, offset + rv,
+        GST_FD_MEMORY_FLAG_NONE);
+    gst_memory_resize (mem, offset, rv);
+    GST_MINI_OBJECT_FLAG_SET (mem, GST_MEMORY_FLAG_READONLY);
+    gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (mem),
+        shm_fd_buffer_quark, gsb, free_fd_buffer);
+
+    *outbuf = gst_buffer_new ();
+    gst_buffer_append_memory (*outbuf, mem);
+  } else {
+    GST_LOG_OBJECT (self, "Got buffer %p of size %d", buf, rv);
+
+    *outbuf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+        buf, rv, 0, rv, gsb, free_buffer);
+  }
 
   return GST_FLOW_OK;
 
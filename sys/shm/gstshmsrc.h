@@ -25,6 +25,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstpushsrc.h>
 #include <gst/base/gstbasesrc.h>
+#include <gst/allocators/allocators.h>
 
 #include "shmpipe.h"
 
@@ -53,6 +54,7 @@ struct _GstShmSrc
   GstPoll *poll;
   GstPollFD pollfd;
 
+  GstAllocator *fd_allocator;
 
   GstFlowReturn flow_return;
   gboolean unlocked;
@@ -39,8 +39,12 @@ struct _ShmAllocSpace
   /* The total size of this space */
   size_t size;
 
-  /* chained list of the blocks contained in this space */
+  /* chained list of the blocks contained in this space, sorted by offset */
   ShmAllocBlock *blocks;
+
+  /* The most recently allocated block, the next allocation is tried
+   * right after it */
+  ShmAllocBlock *last;
 };
 
 /* A single block of data */
@@ -56,7 +60,8 @@ struct _ShmAllocBlock
   /* The size of the block */
   unsigned long size;
 
-  /* Pointer to the next block in the chain */
+  /* Pointers to the previous and next blocks in the chain */
+  ShmAllocBlock *prev;
   ShmAllocBlock *next;
 };
 
@@ -89,6 +94,31 @@ shm_alloc_space_alloc_block (ShmAllocSpace * self, unsigned long size)
   ShmAllocBlock *prev_item = NULL;
   unsigned long prev_end_offset = 0;
 
+  /* Streamed buffers are mostly released in the order they were allocated,
+   * so the space right after the previous allocation, or failing that at
+   * the start of the area, is usually free. This makes the common case
+   * behave like a ring buffer and avoids walking the whole list. */
+  if (self->last) {
+    unsigned long end_offset;
+
+    prev_item = self->last;
+    item = prev_item->next;
+    prev_end_offset = prev_item->offset + prev_item->size;
+    end_offset = item ? item->offset : self->size;
+
+    if (end_offset - prev_end_offset >= size)
+      goto found;
+
+    if (self->blocks->offset >= size) {
+      prev_item = NULL;
+      item = self->blocks;
+      prev_end_offset = 0;
+      goto found;
+    }
+
+    prev_item = NULL;
+    prev_end_offset = 0;
+  }
 
   for (item = self->blocks; item; item = item->next) {
     unsigned long max_size = 0;
@@ -108,6 +138,7 @@ shm_alloc_space_alloc_block (ShmAllocSpace * self, unsigned long size)
   if (!item && self->size - prev_end_offset < size)
     return NULL;
 
+found:
   block = spalloc_new (ShmAllocBlock);
   memset (block, 0, sizeof (ShmAllocBlock));
   block->offset = prev_end_offset;
@@ -120,8 +151,14 @@ shm_alloc_space_alloc_block (ShmAllocSpace * self, unsigned long size)
   else
     self->blocks = block;
 
+  if (item)
+    item->prev = block;
+
+  block->prev = prev_item;
   block->next = item;
 
+  self->last = block;
+
   return block;
 }
 
@@ -134,20 +171,19 @@ shm_alloc_space_alloc_block_get_offset (ShmAllocBlock * block)
 static void
 shm_alloc_space_free_block (ShmAllocBlock * block)
 {
-  ShmAllocBlock *item = NULL;
-  ShmAllocBlock *prev_item = NULL;
   ShmAllocSpace *self = block->space;
 
-  for (item = self->blocks; item; item = item->next) {
-    if (item == block) {
-      if (prev_item)
-        prev_item->next = item->next;
-      else
-        self->blocks = item->next;
-      break;
-    }
-    prev_item = item;
-  }
+  if (block->prev)
+    block->prev->next = block->next;
+  else
+    self->blocks = block->next;
+
+  if (block->next)
+    block->next->prev = block->prev;
+
+  /* Keep allocating from the same position in the area */
+  if (self->last == block)
+    self->last = block->prev;
 
   spalloc_free (ShmAllocBlock, block);
 }
@@ -157,6 +193,12 @@ shm_alloc_space_block_get (ShmAllocSpace * self, unsigned long offset)
 {
   ShmAllocBlock *block = NULL;
 
+  /* The block being looked up is usually the one that was just allocated */
+  block = self->last;
+  if (block && block->offset <= offset &&
+      (block->offset + block->size) > offset)
+    return block;
+
   for (block = self->blocks; block; block = block->next) {
     if (block->offset <= offset && (block->offset + block->size) > offset)
       return block;
@@ -67,7 +67,15 @@
  * type 4: ack buffer
  * offset
  *
- * Type 4 goes from the client to the server
+ * type 5: fd buffer (area id is the buffer id)
+ * offset
+ * bufsize
+ * The file descriptor is passed as SCM_RIGHTS ancillary data
+ *
+ * type 6: ack fd buffer (area id is the buffer id)
+ * No payload
+ *
+ * Types 4 and 6 go from the client to the server
  * The rest are from the server to the client
  * The client should never write in the SHM
  */
@@ -80,7 +88,9 @@ enum
   COMMAND_NEW_SHM_AREA = 1,
   COMMAND_CLOSE_SHM_AREA = 2,
   COMMAND_NEW_BUFFER = 3,
-  COMMAND_ACK_BUFFER = 4
+  COMMAND_ACK_BUFFER = 4,
+  COMMAND_NEW_FD_BUFFER = 5,
+  COMMAND_ACK_FD_BUFFER = 6
 };
 
 typedef struct _ShmArea ShmArea;
@@ -108,7 +118,10 @@ struct _ShmBuffer
 {
   int use_count;
 
+  /* NULL for buffers sent as a file descriptor, those are
+   * identified by their id instead */
   ShmArea *shm_area;
+  unsigned int id;
   unsigned long offset;
   size_t size;
 
@@ -135,7 +148,10 @@ struct _ShmPipe
 
   int next_area_id;
 
+  /* Pending buffers, oldest first, as acks usually arrive in that order */
   ShmBuffer *buffers;
+  ShmBuffer *buffers_tail;
+  unsigned int next_buffer_id;
 
   int num_clients;
   ShmClient *clients;
@@ -147,6 +163,11 @@ struct _ShmClient
 {
   int fd;
 
+  /* Number of buffers sent to this client that it has not acked yet */
+  int pending;
+  /* If set, new buffers are not sent to this client */
+  int skip;
+
   ShmClient *next;
 };
 
@@ -187,6 +208,7 @@ static void sp_close_shm (ShmArea * area);
 static int sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf,
     ShmBuffer * prev_buf, ShmClient * client, void **tag);
 static void sp_shm_area_dec (ShmPipe * self, ShmArea * area);
+static void sp_writer_append_buffer (ShmPipe * self, ShmBuffer * buf);
 
 
 
@@ -485,6 +507,44 @@ send_command (int fd, struct CommandBuffer *cb, unsigned short int type,
   return 1;
 }
 
+static int
+send_command_with_fd (int fd, struct CommandBuffer *cb,
+    unsigned short int type, int area_id, int passfd)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union
+  {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE (sizeof (int))];
+  } control;
+
+  cb->type = type;
+  cb->area_id = area_id;
+
+  memset (&msg, 0, sizeof (msg));
+  memset (&control, 0, sizeof (control));
+
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof (control.buf);
+
+  cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (int));
+  memcpy (CMSG_DATA (cmsg), &passfd, sizeof (int));
+
+  if (sendmsg (fd, &msg, MSG_NOSIGNAL) != sizeof (struct CommandBuffer))
+    return 0;
+
+  return 1;
+}
+
 int
 sp_writer_resize (ShmPipe * self, size_t size)
 {
@@ -615,11 +675,14 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
 
   for (client = self->clients; client; client = client->next) {
     struct CommandBuffer cb = { 0 };
+    if (client->skip)
+      continue;
     cb.payload.buffer.offset = offset;
     cb.payload.buffer.size = bsize;
     if (!send_command (client->fd, &cb, COMMAND_NEW_BUFFER, self->shm_area->id))
       continue;
     sb->clients[i++] = client->fd;
+    client->pending++;
     c++;
   }
 
@@ -633,8 +696,62 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
 
   sb->use_count = c;
 
-  sb->next = self->buffers;
-  self->buffers = sb;
+  sp_writer_append_buffer (self, sb);
+
+  return c;
+}
+
+/* Returns the number of client this has successfully been sent to, each
+ * client gets its own duplicate of @fd, the caller keeps ownership of @fd */
+
+int
+sp_writer_send_fd_buf (ShmPipe * self, int fd, unsigned long offset,
+    size_t size, void *tag)
+{
+  ShmBuffer *sb;
+  ShmClient *client = NULL;
+  unsigned int id;
+  int i = 0;
+  int c = 0;
+
+  if (self->num_clients == 0)
+    return 0;
+
+  if (fd < 0)
+    return -1;
+
+  id = self->next_buffer_id++;
+
+  sb = spalloc_alloc (sizeof (ShmBuffer) + sizeof (int) * self->num_clients);
+  memset (sb, 0, sizeof (ShmBuffer));
+  memset (sb->clients, -1, sizeof (int) * self->num_clients);
+  sb->id = id;
+  sb->offset = offset;
+  sb->size = size;
+  sb->num_clients = self->num_clients;
+  sb->tag = tag;
+
+  for (client = self->clients; client; client = client->next) {
+    struct CommandBuffer cb = { 0 };
+    if (client->skip)
+      continue;
+    cb.payload.buffer.offset = offset;
+    cb.payload.buffer.size = size;
+    if (!send_command_with_fd (client->fd, &cb, COMMAND_NEW_FD_BUFFER, id, fd))
+      continue;
+    sb->clients[i++] = client->fd;
+    client->pending++;
+    c++;
+  }
+
+  if (c == 0) {
+    spalloc_free1 (sizeof (ShmBuffer) + sizeof (int) * sb->num_clients, sb);
+    return 0;
+  }
+
+  sb->use_count = c;
+
+  sp_writer_append_buffer (self, sb);
 
   return c;
 }
@@ -652,18 +769,114 @@ recv_command (int fd, struct CommandBuffer *cb)
   }
 }
 
+/* Room for more descriptors than the writer ever sends, so that the
+ * surplus a misbehaving peer passes arrives here and can be closed */
+#define MAX_PASSED_FDS 8
+
+/* Same as recv_command(), but also picks up a file descriptor passed
+ * along with the command, @passfd is set to -1 if there was none. Any
+ * other descriptor is closed. */
+static int
+recv_command_with_fd (int fd, struct CommandBuffer *cb, int *passfd)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union
+  {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE (sizeof (int) * MAX_PASSED_FDS)];
+  } control;
+  int flags = MSG_DONTWAIT;
+  int retval;
+  int i, n_fds, passed[MAX_PASSED_FDS];
+
+#ifdef MSG_CMSG_CLOEXEC
+  flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+  *passfd = -1;
+
+  memset (&msg, 0, sizeof (msg));
+
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof (control.buf);
+
+  retval = recvmsg (fd, &msg, flags);
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); retval >= 0 && cmsg;
+      cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+      continue;
+
+    n_fds = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+    if (n_fds > MAX_PASSED_FDS)
+      n_fds = MAX_PASSED_FDS;
+    memcpy (passed, CMSG_DATA (cmsg), n_fds * sizeof (int));
+
+    for (i = 0; i < n_fds; i++) {
+      if (*passfd < 0)
+        *passfd = passed[i];
+      else
+        close (passed[i]);
+    }
+  }
+
+  if (retval == sizeof (struct CommandBuffer)) {
+    return 1;
+  } else {
+    if (*passfd >= 0)
+      close (*passfd);
+    *passfd = -1;
+    return 0;
+  }
+}
+
 long int
 sp_client_recv (ShmPipe * self, char **buf)
+{
+  return sp_client_recv_full (self, buf, NULL, NULL, NULL);
+}
+
+/**
+ * sp_client_recv_full:
+ * @buf: Set to the buffer data if it lives in a shm area, NULL otherwise
+ * @fd: Set to the file descriptor of the buffer if it was sent as a file
+ *  descriptor, -1 otherwise. May be NULL if the caller does not support
+ *  file descriptor buffers.
+ * @offset: Set to the offset of the buffer data inside @fd
+ * @id: Set to the id to pass to sp_client_recv_fd_finish()
+ *
+ * Returns: the size of the buffer, 0 if it was an internal message, a
+ *  negative value on error
+ */
+
+long int
+sp_client_recv_full (ShmPipe * self, char **buf, int *fd,
+    unsigned long *offset, unsigned int *id)
 {
   char *area_name = NULL;
   ShmArea *newarea;
   ShmArea *area;
   struct CommandBuffer cb;
   int retval;
+  int passfd = -1;
+
+  if (fd)
+    *fd = -1;
 
-  if (!recv_command (self->main_socket, &cb))
+  if (!recv_command_with_fd (self->main_socket, &cb, &passfd))
     return -1;
 
+  if (passfd >= 0 && cb.type != COMMAND_NEW_FD_BUFFER) {
+    close (passfd);
+    passfd = -1;
+  }
+
   switch (cb.type) {
     case COMMAND_NEW_SHM_AREA:
       assert (cb.payload.new_shm_area.path_size > 0);
@@ -709,6 +922,24 @@ sp_client_recv (ShmPipe * self, char **buf)
       }
       return -23;
 
+    case COMMAND_NEW_FD_BUFFER:
+      if (passfd < 0)
+        return -24;
+
+      if (!fd || !offset || !id) {
+        /* The caller can't handle it, give it back straight away */
+        close (passfd);
+        sp_client_recv_fd_finish (self, cb.area_id);
+        return 0;
+      }
+
+      assert (buf);
+      *buf = NULL;
+      *fd = passfd;
+      *offset = cb.payload.buffer.offset;
+      *id = cb.area_id;
+      return cb.payload.buffer.size;
+
     default:
       return -99;
   }
@@ -729,7 +960,7 @@ sp_writer_recv (ShmPipe * self, ShmClient * client, void **tag)
     case COMMAND_ACK_BUFFER:
 
       for (buf = self->buffers; buf; buf = buf->next) {
-        if (buf->shm_area->id == cb.area_id &&
+        if (buf->shm_area && buf->shm_area->id == cb.area_id &&
             buf->offset == cb.payload.ack_buffer.offset) {
           return sp_shmbuf_dec (self, buf, prev_buf, client, tag);
         }
@@ -737,6 +968,17 @@ sp_writer_recv (ShmPipe * self, ShmClient * client, void **tag)
       }
 
       return -2;
+
+    case COMMAND_ACK_FD_BUFFER:
+
+      for (buf = self->buffers; buf; buf = buf->next) {
+        if (buf->shm_area == NULL && buf->id == (unsigned int) cb.area_id)
+          return sp_shmbuf_dec (self, buf, prev_buf, client, tag);
+        prev_buf = buf;
+      }
+
+      return -2;
+
     default:
       return -99;
   }
@@ -768,6 +1010,14 @@ sp_client_recv_finish (ShmPipe * self, char *buf)
       self->shm_area->id);
 }
 
+int
+sp_client_recv_fd_finish (ShmPipe * self, unsigned int id)
+{
+  struct CommandBuffer cb = { 0 };
+
+  return send_command (self->main_socket, &cb, COMMAND_ACK_FD_BUFFER, id);
+}
+
 ShmPipe *
 sp_client_open (const char *path)
 {
@@ -835,6 +1085,7 @@ sp_writer_accept_client (ShmPipe * self)
   }
 
   client = spalloc_new (ShmClient);
+  memset (client, 0, sizeof (ShmClient));
   client->fd = fd;
 
   /* Prepend ot linked list */
@@ -850,6 +1101,19 @@ error:
   return NULL;
 }
 
+static void
+sp_writer_append_buffer (ShmPipe * self, ShmBuffer * buf)
+{
+  buf->next = NULL;
+
+  if (self->buffers_tail)
+    self->buffers_tail->next = buf;
+  else
+    self->buffers = buf;
+
+  self->buffers_tail = buf;
+}
+
 static int
 sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf, ShmBuffer * prev_buf,
     ShmClient * client, void **tag)
@@ -872,6 +1136,8 @@ sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf, ShmBuffer * prev_buf,
   }
   assert (had_client);
 
+  client->pending--;
+
   buf->use_count--;
 
   if (buf->use_count == 0) {
@@ -880,11 +1146,15 @@ sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf, ShmBuffer * prev_buf,
       prev_buf->next = buf->next;
     else
       self->buffers = buf->next;
+    if (self->buffers_tail == buf)
+      self->buffers_tail = prev_buf;
 
     if (tag)
       *tag = buf->tag;
-    shm_alloc_space_block_dec (buf->ablock);
-    sp_shm_area_dec (self, buf->shm_area);
+    if (buf->shm_area) {
+      shm_alloc_space_block_dec (buf->ablock);
+      sp_shm_area_dec (self, buf->shm_area);
+    }
     spalloc_free1 (sizeof (ShmBuffer) + sizeof (int) * buf->num_clients, buf);
     return 0;
   }
@@ -902,6 +1172,7 @@ sp_writer_close_client (ShmPipe * self, ShmClient * client,
   close (client->fd);
 
 again:
+  prev_buf = NULL;
   for (buffer = self->buffers; buffer; buffer = buffer->next) {
     int i;
     void *tag = NULL;
@@ -957,6 +1228,31 @@ sp_writer_get_client_fd (ShmClient * client)
   return client->fd;
 }
 
+int
+sp_writer_client_get_pending (ShmClient * client)
+{
+  return client->pending;
+}
+
+void
+sp_writer_client_set_skip (ShmClient * client, int skip)
+{
+  client->skip = skip;
+}
+
+int
+sp_writer_buf_has_client (ShmBuffer * buffer, ShmClient * client)
+{
+  int i;
+
+  for (i = 0; i < buffer->num_clients; i++) {
+    if (buffer->clients[i] == client->fd)
+      return 1;
+  }
+
+  return 0;
+}
+
 int
 sp_writer_pending_writes (ShmPipe * self)
 {
@@ -56,6 +56,14 @@
  * buffers are no longer valid. If was valid buffer was received, the
  * client must release it with sp_client_recv_finish() when it is done
  * reading from it.
+ *
+ * Alternatively, the writer can send a buffer living in its own file
+ * descriptor (for example a memfd) with sp_writer_send_fd_buf(). The
+ * descriptor is passed to each client over the control socket using
+ * SCM_RIGHTS, so no shm area space is used for it. The reader must then
+ * use sp_client_recv_full() which returns the received fd instead of a
+ * pointer, and release it with sp_client_recv_fd_finish() using the
+ * buffer id it was given. The reader owns the received fd.
  */
 
 
@@ -93,10 +101,14 @@ int sp_writer_resize (ShmPipe * self, size_t size);
 int sp_get_fd (ShmPipe * self);
 const char *sp_get_shm_area_name (ShmPipe *self);
 int sp_writer_get_client_fd (ShmClient * client);
+int sp_writer_client_get_pending (ShmClient * client);
+void sp_writer_client_set_skip (ShmClient * client, int skip);
 
 ShmBlock *sp_writer_alloc_block (ShmPipe * self, size_t size);
 void sp_writer_free_block (ShmBlock *block);
 int sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void * tag);
+int sp_writer_send_fd_buf (ShmPipe * self, int fd, unsigned long offset,
+    size_t size, void * tag);
 char *sp_writer_block_get_buf (ShmBlock *block);
 ShmPipe *sp_writer_block_get_pipe (ShmBlock *block);
 size_t sp_writer_get_max_buf_size (ShmPipe * self);
@@ -111,10 +123,14 @@ int sp_writer_pending_writes (ShmPipe * self);
 ShmBuffer *sp_writer_get_pending_buffers (ShmPipe * self);
 ShmBuffer *sp_writer_get_next_buffer (ShmBuffer * buffer);
 void *sp_writer_buf_get_tag (ShmBuffer * buffer);
+int sp_writer_buf_has_client (ShmBuffer * buffer, ShmClient * client);
 
 ShmPipe *sp_client_open (const char *path);
 long int sp_client_recv (ShmPipe * self, char **buf);
+long int sp_client_recv_full (ShmPipe * self, char **buf, int *fd,
+    unsigned long *offset, unsigned int *id);
 int sp_client_recv_finish (ShmPipe * self, char *buf);
+int sp_client_recv_fd_finish (ShmPipe * self, unsigned int id);
 void sp_client_close (ShmPipe * self);
 
 #ifdef __cplusplus
@@ -0,0 +1,67 @@
+/* GStreamer
+ *
+ * Helpers for the benchmarks of the element unit tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_CHECK_BENCHMARK_H__
+#define __GST_CHECK_BENCHMARK_H__
+
+#include <gst/check/gstcheck.h>
+
+#ifdef G_OS_UNIX
+# include <sys/resource.h>
+#endif
+
+/* Benchmarks take long and only log what they measured, so they are only
+ * run if GST_CHECK_BENCHMARKS is set in the environment, e.g.
+ *
+ *   GST_CHECK_BENCHMARKS=1 GST_DEBUG=check:4 make elements/yadif.check
+ *
+ * Returns the "benchmark" test case, already added to @s, or NULL if
+ * benchmarks are not run. */
+static inline TCase *
+benchmark_tcase_new (Suite * s, gint timeout)
+{
+  TCase *tc;
+
+  if (!g_getenv ("GST_CHECK_BENCHMARKS"))
+    return NULL;
+
+  tc = tcase_create ("benchmark");
+  tcase_set_timeout (tc, timeout);
+  suite_add_tcase (s, tc);
+
+  return tc;
+}
+
+/* Returns the user and system CPU time used by the process so far, in
+ * microseconds, or the monotonic time where that is not available */
+static inline gint64
+benchmark_cpu_time (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return (gint64) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+        G_USEC_PER_SEC + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#endif
+  return g_get_monotonic_time ();
+}
+
+#endif /* __GST_CHECK_BENCHMARK_H__ */
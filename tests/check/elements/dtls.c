@@ -31,6 +31,8 @@
 
 #include <gst/check/gstharness.h>
 
+#include "benchmark.h"
+
 GST_START_TEST (test_create_and_unref)
 {
   GstElement *e;
@@ -176,15 +178,138 @@ GST_START_TEST (test_data_transfer)
 
 GST_END_TEST;
 
+/* Runs a client/server handshake in a pipeline of its own, and returns
+ * whether both decoders got the peer certificate. @resumed is set if both
+ * sides resumed a previous session. */
+static gboolean
+run_handshake (const gchar * server_id, const gchar * client_id,
+    gboolean * resumed)
+{
+  GstElement *pipeline, *s_enc, *s_dec, *c_enc, *c_dec;
+  gchar *s_peer_pem, *c_peer_pem;
+  gboolean s_resumed, c_resumed;
+  gboolean ret;
+  int count;
+
+  pipeline = gst_pipeline_new (NULL);
+
+  s_dec = gst_element_factory_make ("dtlsdec", NULL);
+  g_object_set (s_dec, "connection-id", server_id, NULL);
+  s_enc = gst_element_factory_make ("dtlsenc", NULL);
+  g_object_set (s_enc, "connection-id", server_id, NULL);
+  c_dec = gst_element_factory_make ("dtlsdec", NULL);
+  g_object_set (c_dec, "connection-id", client_id, NULL);
+  c_enc = gst_element_factory_make ("dtlsenc", NULL);
+  g_object_set (c_enc, "connection-id", client_id, "is-client", TRUE, NULL);
+
+  g_signal_connect (s_dec, "on-key-received", G_CALLBACK (_on_key_received),
+      NULL);
+  g_signal_connect (s_enc, "on-key-received", G_CALLBACK (_on_key_received),
+      NULL);
+  g_signal_connect (c_dec, "on-key-received", G_CALLBACK (_on_key_received),
+      NULL);
+  g_signal_connect (c_enc, "on-key-received", G_CALLBACK (_on_key_received),
+      NULL);
+
+  gst_bin_add_many (GST_BIN (pipeline), s_dec, s_enc, c_dec, c_enc, NULL);
+  fail_unless (gst_element_link_pads (s_enc, "src", c_dec, "sink"));
+  fail_unless (gst_element_link_pads (c_enc, "src", s_dec, "sink"));
+
+  g_mutex_lock (&key_lock);
+  count = key_count;
+  g_mutex_unlock (&key_lock);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+  _wait_for_key_count_to_reach (count + 4);
+
+  g_object_get (s_dec, "peer-pem", &s_peer_pem, NULL);
+  g_object_get (c_dec, "peer-pem", &c_peer_pem, NULL);
+  ret = s_peer_pem != NULL && c_peer_pem != NULL;
+  g_free (s_peer_pem);
+  g_free (c_peer_pem);
+
+  g_object_get (s_dec, "session-resumed", &s_resumed, NULL);
+  g_object_get (c_dec, "session-resumed", &c_resumed, NULL);
+  fail_unless_equals_int (s_resumed, c_resumed);
+  if (resumed)
+    *resumed = s_resumed && c_resumed;
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return ret;
+}
+
+GST_START_TEST (test_session_resumption)
+{
+  gboolean resumed;
+
+  /* the second handshake resumes the session of the first one, the peer
+   * certificate still has to be reported for it */
+  fail_unless (run_handshake ("resume_server", "resume_client", &resumed));
+  fail_unless (!resumed);
+  fail_unless (run_handshake ("resume_server", "resume_client", &resumed));
+  fail_unless (resumed);
+}
+
+GST_END_TEST;
+
+#define BENCH_N_HANDSHAKES 50
+
+static void
+bench_handshakes (gboolean resume)
+{
+  gint64 start, end;
+  guint i;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCH_N_HANDSHAKES; i++) {
+    gchar *server_id, *client_id;
+
+    /* new connection ids never resume a previous session */
+    if (resume) {
+      server_id = g_strdup ("bench_server");
+      client_id = g_strdup ("bench_client");
+    } else {
+      server_id = g_strdup_printf ("bench_server_%u", i);
+      client_id = g_strdup_printf ("bench_client_%u", i);
+    }
+
+    run_handshake (server_id, client_id, NULL);
+
+    g_free (server_id);
+    g_free (client_id);
+  }
+  end = g_get_monotonic_time ();
+
+  GST_INFO ("%s: %u handshakes in %" G_GINT64_FORMAT " us, %.1f handshakes/s",
+      resume ? "resumed" : "full", BENCH_N_HANDSHAKES, end - start,
+      BENCH_N_HANDSHAKES * (gdouble) G_USEC_PER_SEC / MAX (end - start, 1));
+}
+
+GST_START_TEST (test_bench_handshakes)
+{
+  bench_handshakes (FALSE);
+  bench_handshakes (TRUE);
+}
+
+GST_END_TEST;
+
 static Suite *
 dtls_suite (void)
 {
   Suite *s = suite_create ("dtls");
   TCase *tc_chain = tcase_create ("general");
+  TCase *tc_bench;
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_create_and_unref);
   tcase_add_test (tc_chain, test_data_transfer);
+  tcase_add_test (tc_chain, test_session_resumption);
+
+  if ((tc_bench = benchmark_tcase_new (s, 120)))
+    tcase_add_test (tc_bench, test_bench_handshakes);
 
   return s;
 }
@@ -0,0 +1,399 @@
+/* GStreamer unit tests for the fieldanalysis element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#include <string.h>
+
+#include "benchmark.h"
+
+#define N_FRAMES 6
+
+static const gchar *comb_methods[] = { "32-detect", "isCombed", "5-tap" };
+
+enum
+{
+  PATTERN_GRADIENT,
+  PATTERN_COMBED,
+  PATTERN_RANDOM,
+  PATTERN_NEAR_THRESHOLDS
+};
+
+static GstHarness *
+fieldanalysis_harness_new (const gchar * format, gint width, gint height,
+    guint n_threads)
+{
+  GstHarness *h;
+  gchar *caps;
+
+  h = gst_harness_new ("fieldanalysis");
+  g_object_set (h->element, "n-threads", n_threads, NULL);
+
+  caps = g_strdup_printf ("video/x-raw,format=%s,width=%d,height=%d,"
+      "framerate=30/1", format, width, height);
+  gst_harness_set_src_caps_str (h, caps);
+  g_free (caps);
+
+  return h;
+}
+
+/* Fill the luma of a frame with a vertical gradient, with lines that
+ * alternate between two levels that change with every frame, with noise,
+ * or with a gradient where about a third of the samples are combed by
+ * around the default spatial threshold, so that the comb counts of the
+ * blocks are close to the default block threshold, and leave the chroma
+ * flat */
+static GstBuffer *
+frame_new (const gchar * format, gint width, gint height, gint pattern,
+    guint32 seed)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buf;
+  GRand *rand;
+  guint8 *line;
+  gint x, y, pstride, stride;
+
+  gst_video_info_set_format (&info, gst_video_format_from_string (format),
+      width, height);
+  buf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  gst_buffer_memset (buf, 0, 0x80, GST_VIDEO_INFO_SIZE (&info));
+
+  fail_unless (gst_video_frame_map (&frame, &info, buf, GST_MAP_WRITE));
+  pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, 0);
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+  rand = g_rand_new_with_seed (seed);
+
+  for (y = 0; y < height; y++) {
+    line = GST_VIDEO_FRAME_COMP_DATA (&frame, 0) + y * stride;
+    for (x = 0; x < width; x++) {
+      guint8 *p = line + x * pstride;
+
+      switch (pattern) {
+        case PATTERN_GRADIENT:
+          *p = 16 + y * 219 / height;
+          break;
+        case PATTERN_COMBED:
+          *p = (y & 1) ? 235 - (seed % 4) * 40 : 16 + (seed % 4) * 40;
+          break;
+        case PATTERN_NEAR_THRESHOLDS:{
+          gint v = 16 + y * 219 / height + g_rand_int_range (rand, -1, 2);
+
+          if (g_rand_int_range (rand, 0, 100) < 31) {
+            gint amplitude = g_rand_int_range (rand, 7, 12);
+
+            v += (y & 1) ? amplitude : -amplitude;
+          }
+          *p = CLAMP (v, 0, 255);
+          break;
+        }
+        default:
+          *p = g_rand_int (rand);
+          break;
+      }
+    }
+  }
+
+  g_rand_free (rand);
+  gst_video_frame_unmap (&frame);
+
+  return buf;
+}
+
+#ifndef GST_DISABLE_GST_DEBUG
+/* The "Scores" debug lines of one element, with all the metric values of
+ * a frame */
+typedef struct
+{
+  GstElement *element;
+  GMutex lock;
+  GPtrArray *scores;
+} ScoreLog;
+
+static void
+score_log_func (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer user_data)
+{
+  ScoreLog *log = user_data;
+  const gchar *msg;
+
+  if (object != G_OBJECT (log->element) ||
+      strcmp (gst_debug_category_get_name (category), "fieldanalysis") != 0)
+    return;
+
+  msg = gst_debug_message_get (message);
+  if (msg && g_str_has_prefix (msg, "Scores: ")) {
+    g_mutex_lock (&log->lock);
+    g_ptr_array_add (log->scores, g_strdup (msg));
+    g_mutex_unlock (&log->lock);
+  }
+}
+
+static GstDebugCategory *
+get_fieldanalysis_category (void)
+{
+  GSList *categories, *l;
+  GstDebugCategory *cat = NULL;
+
+  categories = gst_debug_get_all_categories ();
+  for (l = categories; l; l = l->next) {
+    if (strcmp (gst_debug_category_get_name (l->data), "fieldanalysis") == 0)
+      cat = l->data;
+  }
+  g_slist_free (categories);
+
+  return cat;
+}
+#endif
+
+/* Push N_FRAMES frames and EOS, and collect the flags of all output
+ * buffers in @flags and, if the debug system is active and @scores is not
+ * NULL, the metric values of every frame in @scores */
+static guint
+analyse (const gchar * format, gint width, gint height, guint n_threads,
+    const gchar * frame_metric, const gchar * comb_method, gint pattern,
+    GstBufferFlags * flags, GPtrArray * scores)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  guint i, n;
+#ifndef GST_DISABLE_GST_DEBUG
+  GstDebugCategory *cat = NULL;
+  GstDebugLevel threshold = GST_LEVEL_NONE;
+  ScoreLog log;
+
+  if (!gst_debug_is_active ())
+    scores = NULL;
+#endif
+
+  h = fieldanalysis_harness_new (format, width, height, n_threads);
+  gst_util_set_object_arg (G_OBJECT (h->element), "frame-metric",
+      frame_metric);
+  gst_util_set_object_arg (G_OBJECT (h->element), "comb-method", comb_method);
+
+#ifndef GST_DISABLE_GST_DEBUG
+  if (scores) {
+    log.element = h->element;
+    g_mutex_init (&log.lock);
+    log.scores = scores;
+    cat = get_fieldanalysis_category ();
+    fail_unless (cat != NULL);
+    threshold = gst_debug_category_get_threshold (cat);
+    if (threshold < GST_LEVEL_DEBUG)
+      gst_debug_category_set_threshold (cat, GST_LEVEL_DEBUG);
+    gst_debug_add_log_function (score_log_func, &log, NULL);
+  }
+#endif
+
+  for (i = 0; i < N_FRAMES; i++) {
+    buf = frame_new (format, width, height, pattern, i + 1);
+    GST_BUFFER_PTS (buf) = i * GST_SECOND / 30;
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+
+  n = gst_harness_buffers_received (h);
+  fail_unless_equals_int (n, N_FRAMES);
+  for (i = 0; i < n; i++) {
+    buf = gst_harness_pull (h);
+    flags[i] = GST_BUFFER_FLAGS (buf) & (GST_VIDEO_BUFFER_FLAG_INTERLACED |
+        GST_VIDEO_BUFFER_FLAG_TFF | GST_VIDEO_BUFFER_FLAG_RFF |
+        GST_VIDEO_BUFFER_FLAG_ONEFIELD);
+    gst_buffer_unref (buf);
+  }
+
+#ifndef GST_DISABLE_GST_DEBUG
+  if (scores) {
+    gst_debug_remove_log_function_by_data (&log);
+    if (threshold < GST_LEVEL_DEBUG)
+      gst_debug_category_set_threshold (cat, threshold);
+    g_mutex_clear (&log.lock);
+    fail_unless (scores->len > 0);
+  }
+#endif
+
+  gst_harness_teardown (h);
+
+  return n;
+}
+
+/* A smooth picture that does not change is progressive */
+GST_START_TEST (test_progressive)
+{
+  GstBufferFlags flags[N_FRAMES];
+  const gchar *metrics[] = { "5-tap", "windowed-comb" };
+  guint i, j, n;
+
+  for (i = 0; i < G_N_ELEMENTS (metrics); i++) {
+    n = analyse ("I420", 320, 240, 2, metrics[i], "5-tap", PATTERN_GRADIENT,
+        flags, NULL);
+    for (j = 0; j < n; j++)
+      fail_if (flags[j] & GST_VIDEO_BUFFER_FLAG_INTERLACED,
+          "%s: frame %u flagged interlaced", metrics[i], j);
+  }
+}
+
+GST_END_TEST;
+
+/* Frames whose fields differ from each other and from the previous frame
+ * are interlaced with every comb detection method */
+GST_START_TEST (test_interlaced)
+{
+  GstBufferFlags flags[N_FRAMES];
+  guint i, j, n;
+
+  for (i = 0; i < G_N_ELEMENTS (comb_methods); i++) {
+    n = analyse ("I420", 320, 240, 2, "windowed-comb", comb_methods[i],
+        PATTERN_COMBED, flags, NULL);
+    for (j = 0; j < n; j++)
+      fail_unless (flags[j] & GST_VIDEO_BUFFER_FLAG_INTERLACED,
+          "%s: frame %u not flagged interlaced", comb_methods[i], j);
+  }
+
+  n = analyse ("YUY2", 320, 240, 2, "windowed-comb", "5-tap", PATTERN_COMBED,
+      flags, NULL);
+  for (j = 0; j < n; j++)
+    fail_unless (flags[j] & GST_VIDEO_BUFFER_FLAG_INTERLACED);
+
+  n = analyse ("I420", 320, 240, 2, "5-tap", "5-tap", PATTERN_COMBED, flags,
+      NULL);
+  for (j = 0; j < n; j++)
+    fail_unless (flags[j] & GST_VIDEO_BUFFER_FLAG_INTERLACED);
+}
+
+GST_END_TEST;
+
+/* Splitting the frame over threads must not change any metric value, on
+ * content with the comb counts close to the thresholds as well as noise */
+GST_START_TEST (test_threads)
+{
+  GstBufferFlags single[N_FRAMES], threaded[N_FRAMES];
+  const gchar *formats[] = { "I420", "YUY2" };
+  const gchar *metrics[] = { "5-tap", "windowed-comb" };
+  const gint patterns[] = { PATTERN_NEAR_THRESHOLDS, PATTERN_RANDOM };
+  guint i, j, k, l, m, n;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    for (j = 0; j < G_N_ELEMENTS (metrics); j++) {
+      for (k = 0; k < G_N_ELEMENTS (comb_methods); k++) {
+        for (l = 0; l < G_N_ELEMENTS (patterns); l++) {
+          GPtrArray *single_scores, *threaded_scores;
+
+          GST_DEBUG ("testing %s %s %s pattern %d", formats[i], metrics[j],
+              comb_methods[k], patterns[l]);
+
+          single_scores = g_ptr_array_new_with_free_func (g_free);
+          threaded_scores = g_ptr_array_new_with_free_func (g_free);
+
+          n = analyse (formats[i], 720, 576, 1, metrics[j], comb_methods[k],
+              patterns[l], single, single_scores);
+          fail_unless_equals_int (analyse (formats[i], 720, 576, 4,
+                  metrics[j], comb_methods[k], patterns[l], threaded,
+                  threaded_scores), n);
+          fail_unless (memcmp (single, threaded, n * sizeof (single[0])) == 0,
+              "%s %s %s: threaded flags differ", formats[i], metrics[j],
+              comb_methods[k]);
+
+          fail_unless_equals_int (threaded_scores->len, single_scores->len);
+          for (m = 0; m < single_scores->len; m++) {
+            GST_LOG ("frame %u: %s", m,
+                (gchar *) g_ptr_array_index (single_scores, m));
+            fail_unless_equals_string (g_ptr_array_index (threaded_scores, m),
+                g_ptr_array_index (single_scores, m));
+          }
+
+          g_ptr_array_unref (single_scores);
+          g_ptr_array_unref (threaded_scores);
+        }
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+#define BENCH_N_FRAMES 100
+
+static void
+bench_analyse (const gchar * frame_metric, guint n_threads)
+{
+  GstHarness *h;
+  GstBuffer *in[4], *out;
+  gint64 start, end;
+  guint i;
+
+  h = fieldanalysis_harness_new ("I420", 1920, 1080, n_threads);
+  gst_util_set_object_arg (G_OBJECT (h->element), "frame-metric",
+      frame_metric);
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    in[i] = frame_new ("I420", 1920, 1080, PATTERN_RANDOM, i + 1);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCH_N_FRAMES; i++) {
+    fail_unless_equals_int (gst_harness_push (h,
+            gst_buffer_copy (in[i % G_N_ELEMENTS (in)])), GST_FLOW_OK);
+    while ((out = gst_harness_try_pull (h)))
+      gst_buffer_unref (out);
+  }
+  end = g_get_monotonic_time ();
+
+  GST_INFO ("%s 1080i, %u threads: %.2f ms/frame, %.1f fps", frame_metric,
+      n_threads, (end - start) / 1000.0 / BENCH_N_FRAMES,
+      BENCH_N_FRAMES * G_USEC_PER_SEC / (gdouble) (end - start));
+
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    gst_buffer_unref (in[i]);
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_bench_analyse)
+{
+  bench_analyse ("5-tap", 1);
+  bench_analyse ("5-tap", 0);
+  bench_analyse ("windowed-comb", 1);
+  bench_analyse ("windowed-comb", 0);
+}
+
+GST_END_TEST;
+
+static Suite *
+fieldanalysis_suite (void)
+{
+  Suite *s = suite_create ("fieldanalysis");
+  TCase *tc_chain = tcase_create ("general");
+  TCase *tc_bench;
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_progressive);
+  tcase_add_test (tc_chain, test_interlaced);
+  tcase_add_test (tc_chain, test_threads);
+
+  if ((tc_bench = benchmark_tcase_new (s, 120)))
+    tcase_add_test (tc_bench, test_bench_analyse);
+
+  return s;
+}
+
+GST_CHECK_MAIN (fieldanalysis);
@@ -400,6 +400,240 @@ GST_START_TEST (test_streamheader)
 
 GST_END_TEST;
 
+static GstCaps *
+caps_from_gdp_buffer (GstBuffer * buf, GstDPDictionary * dict)
+{
+  GstMapInfo map;
+  GstCaps *caps;
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  caps = gst_dp_caps_from_packet_full (GST_DP_HEADER_LENGTH, map.data,
+      map.data + GST_DP_HEADER_LENGTH, dict);
+  gst_buffer_unmap (buf, &map);
+
+  return caps;
+}
+
+/* checks the GDP 2.0 binary encoding reproduces caps and events exactly */
+GST_START_TEST (test_version_2_encoding)
+{
+  GstCaps *caps, *outcaps;
+  GstStructure *inner;
+  GstBuffer *buffer, *gdpbuffer;
+  GstDateTime *datetime;
+  GstEvent *event, *outevent;
+  GstMapInfo map;
+
+  caps = gst_caps_from_string ("test/x-types(memory:SystemMemory, meta:Foo), "
+      "i=(int)-5, u=(uint)7, l=(gint64)-1234567890123, "
+      "ul=(guint64)18446744073709551615, d=(double)0.25, f=(float)1.5, "
+      "b=(boolean)true, s=(string)\"hello world\", fr=(fraction)30000/1001, "
+      "ir=(int)[ 2, 10, 2 ], lr=(gint64)[ 1, 100 ], dr=(double)[ 0.5, 2.0 ], "
+      "frr=(fraction)[ 1/2, 60/1 ], list=(int){ 1, 2, 3 }, "
+      "arr=(string)< a, b >; test/x-other");
+  fail_unless (caps != NULL);
+
+  inner = gst_structure_new ("inner", "a", G_TYPE_INT, 1, NULL);
+  buffer = gst_buffer_new_and_alloc (4);
+  gst_buffer_fill (buffer, 0, "f00d", 4);
+  datetime = gst_date_time_new (0.0, 2020, 1, 2, 3, 4, 5.0);
+  gst_caps_set_simple (caps, "nested", GST_TYPE_STRUCTURE, inner,
+      "buffer", GST_TYPE_BUFFER, buffer, "date", GST_TYPE_DATE_TIME,
+      datetime, NULL);
+  gst_structure_free (inner);
+  gst_buffer_unref (buffer);
+  gst_date_time_unref (datetime);
+
+  gdpbuffer = gst_dp_payload_caps_full (caps, 0, GST_DP_VERSION_2_0, NULL);
+  fail_unless (gdpbuffer != NULL);
+  gst_buffer_map (gdpbuffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.data[0], 2);
+  fail_unless_equals_int (map.data[1], 0);
+  fail_unless_equals_int (map.data[GST_DP_HEADER_LENGTH],
+      GST_DP_CAPS_INLINE);
+  gst_buffer_unmap (gdpbuffer, &map);
+
+  outcaps = caps_from_gdp_buffer (gdpbuffer, NULL);
+  fail_unless (outcaps != NULL);
+  fail_unless (gst_caps_is_strictly_equal (caps, outcaps),
+      "%" GST_PTR_FORMAT " != %" GST_PTR_FORMAT, caps, outcaps);
+  gst_caps_unref (outcaps);
+  gst_buffer_unref (gdpbuffer);
+  gst_caps_unref (caps);
+
+  /* a seek event only has fundamental, enum and flags fields */
+  event = gst_event_new_seek (1.5, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH |
+      GST_SEEK_FLAG_ACCURATE, GST_SEEK_TYPE_SET, GST_SECOND,
+      GST_SEEK_TYPE_NONE, -1);
+  gdpbuffer = gst_dp_payload_event_full (event, 0, GST_DP_VERSION_2_0);
+  fail_unless (gdpbuffer != NULL);
+  gst_buffer_map (gdpbuffer, &map, GST_MAP_READ);
+  outevent = gst_dp_event_from_packet (GST_DP_HEADER_LENGTH, map.data,
+      map.data + GST_DP_HEADER_LENGTH);
+  gst_buffer_unmap (gdpbuffer, &map);
+  fail_unless (outevent != NULL);
+  fail_unless_equals_int (GST_EVENT_TYPE (outevent), GST_EVENT_SEEK);
+  fail_unless (gst_structure_is_equal (gst_event_get_structure (event),
+          gst_event_get_structure (outevent)));
+  gst_event_unref (outevent);
+  gst_buffer_unref (gdpbuffer);
+  gst_event_unref (event);
+}
+
+GST_END_TEST;
+
+/* a serialized value of a type that can't be instantiated is rejected */
+GST_START_TEST (test_version_2_abstract_type)
+{
+  GstCaps *caps, *outcaps;
+  GstDateTime *datetime;
+  GstBuffer *gdpbuffer;
+  GstMapInfo map;
+  gsize i;
+  gboolean replaced = FALSE;
+
+  datetime = gst_date_time_new (0.0, 2020, 1, 2, 3, 4, 5.0);
+  caps = gst_caps_new_simple ("test/x-date", "date", GST_TYPE_DATE_TIME,
+      datetime, NULL);
+  gst_date_time_unref (datetime);
+
+  gdpbuffer = gst_dp_payload_caps_full (caps, 0, GST_DP_VERSION_2_0, NULL);
+  fail_unless (gdpbuffer != NULL);
+  gst_caps_unref (caps);
+
+  /* turn the type name into the one of an abstract type of the same
+   * length, including the terminator */
+  fail_unless (gst_buffer_map (gdpbuffer, &map, GST_MAP_READWRITE));
+  for (i = 0; i + 11 <= map.size && !replaced; i++) {
+    if (memcmp (map.data + i, "GstDateTime", 11) == 0) {
+      memcpy (map.data + i, "GstElement", 11);
+      replaced = TRUE;
+    }
+  }
+  gst_buffer_unmap (gdpbuffer, &map);
+  fail_unless (replaced);
+
+  outcaps = caps_from_gdp_buffer (gdpbuffer, NULL);
+  fail_unless (outcaps == NULL);
+  gst_buffer_unref (gdpbuffer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_version_2)
+{
+  GstCaps *caps, *other_caps, *current_caps;
+  GstPad *srcpad;
+  GstElement *gdpdepay;
+  GstBuffer *buffer, *inbuffer, *outbuffer;
+  GstBuffer *caps_buf, *streamstart_buf, *segment_buf, *data_buf;
+  GstDPDictionary *dict;
+  GstEvent *event;
+  GstSegment segment;
+
+  gdpdepay = setup_gdpdepay ();
+  srcpad = gst_element_get_static_pad (gdpdepay, "src");
+
+  fail_unless (gst_element_set_state (gdpdepay,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_empty_simple ("application/x-gdp");
+  gst_check_setup_events (mysrcpad, gdpdepay, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  dict = gst_dp_dictionary_new ();
+
+  event = gst_event_new_stream_start ("s-s-id-1234");
+  streamstart_buf = gst_dp_payload_event_full (event, 0, GST_DP_VERSION_2_0);
+  gst_event_unref (event);
+
+  caps = gst_caps_from_string (AUDIO_CAPS_STRING);
+  caps_buf = gst_dp_payload_caps_full (caps, 0, GST_DP_VERSION_2_0, dict);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  event = gst_event_new_segment (&segment);
+  segment_buf = gst_dp_payload_event_full (event, 0, GST_DP_VERSION_2_0);
+  gst_event_unref (event);
+
+  buffer = gst_buffer_new_and_alloc (4);
+  gst_buffer_fill (buffer, 0, "f00d", 4);
+  data_buf = gst_dp_payload_buffer (buffer, 0);
+
+  inbuffer = gst_buffer_append (streamstart_buf, caps_buf);
+  inbuffer = gst_buffer_append (inbuffer, segment_buf);
+  inbuffer = gst_buffer_append (inbuffer, gst_buffer_ref (data_buf));
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  current_caps = gst_pad_get_current_caps (srcpad);
+  fail_unless (gst_caps_is_equal (current_caps, caps));
+  gst_caps_unref (current_caps);
+
+  /* new caps are defined in the dictionary too */
+  other_caps = gst_caps_copy (caps);
+  gst_caps_set_simple (other_caps, "rate", G_TYPE_INT, 2000, NULL);
+  caps_buf = gst_dp_payload_caps_full (other_caps, 0, GST_DP_VERSION_2_0,
+      dict);
+  inbuffer = gst_buffer_append (caps_buf, gst_buffer_ref (data_buf));
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  current_caps = gst_pad_get_current_caps (srcpad);
+  fail_unless (gst_caps_is_equal (current_caps, other_caps));
+  gst_caps_unref (current_caps);
+
+  /* going back to the first caps only sends a reference */
+  caps_buf = gst_dp_payload_caps_full (caps, 0, GST_DP_VERSION_2_0, dict);
+  fail_unless_equals_int (gst_buffer_get_size (caps_buf),
+      GST_DP_HEADER_LENGTH + 3);
+  inbuffer = gst_buffer_append (caps_buf, gst_buffer_ref (data_buf));
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 3);
+  current_caps = gst_pad_get_current_caps (srcpad);
+  fail_unless (gst_caps_is_equal (current_caps, caps));
+  gst_caps_unref (current_caps);
+
+  /* the dictionary outlives a DISCONT, the payloader keeps referring to
+   * what it defined before */
+  caps_buf = gst_dp_payload_caps_full (other_caps, 0, GST_DP_VERSION_2_0,
+      dict);
+  fail_unless_equals_int (gst_buffer_get_size (caps_buf),
+      GST_DP_HEADER_LENGTH + 3);
+  inbuffer = gst_buffer_append (caps_buf, gst_buffer_ref (data_buf));
+  GST_BUFFER_FLAG_SET (inbuffer, GST_BUFFER_FLAG_DISCONT);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 4);
+  current_caps = gst_pad_get_current_caps (srcpad);
+  fail_unless (gst_caps_is_equal (current_caps, other_caps));
+  gst_caps_unref (current_caps);
+
+  /* a receiver that missed the definition can't resolve the reference */
+  outbuffer = gst_dp_payload_caps_full (caps, 0, GST_DP_VERSION_2_0, dict);
+  current_caps = caps_from_gdp_buffer (outbuffer, NULL);
+  fail_unless (current_caps == NULL);
+  gst_buffer_unref (outbuffer);
+
+  fail_unless (gst_element_set_state (gdpdepay,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  gst_dp_dictionary_free (dict);
+  gst_buffer_unref (data_buf);
+  gst_buffer_unref (buffer);
+  gst_caps_unref (other_caps);
+  gst_caps_unref (caps);
+  gst_object_unref (srcpad);
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+  ASSERT_OBJECT_REFCOUNT (gdpdepay, "gdpdepay", 1);
+  cleanup_gdpdepay (gdpdepay);
+}
+
+GST_END_TEST;
+
 static Suite *
 gdpdepay_suite (void)
 {
@@ -410,6 +644,9 @@ gdpdepay_suite (void)
   tcase_add_test (tc_chain, test_audio_per_byte);
   tcase_add_test (tc_chain, test_audio_in_one_buffer);
   tcase_add_test (tc_chain, test_streamheader);
+  tcase_add_test (tc_chain, test_version_2_encoding);
+  tcase_add_test (tc_chain, test_version_2_abstract_type);
+  tcase_add_test (tc_chain, test_version_2);
 
   return s;
 }
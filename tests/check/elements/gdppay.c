@@ -25,6 +25,8 @@
 #include <gst/audio/audio.h>
 #include "../../gst/gdp/dataprotocol.c"
 
+#include "benchmark.h"
+
 /* For ease of programming we use globals to keep refs for our floating
  * src and sink pads we create; otherwise we always have to do get_pad,
  * get_peer, and then remove references in every test function */
@@ -555,12 +557,355 @@ GST_START_TEST (test_crc)
 
 GST_END_TEST;
 
+GST_START_TEST (test_version_2)
+{
+  GstCaps *caps, *sinkcaps;
+  GstElement *gdppay;
+  GstBuffer *inbuffer, *outbuffer;
+  GstStructure *structure;
+  const GValue *sh;
+  GstMapInfo map;
+
+  gdppay = setup_gdppay ();
+  g_object_set (gdppay, "version", GST_DP_VERSION_2_0, NULL);
+
+  fail_unless (gst_element_set_state (gdppay,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  inbuffer = gst_buffer_new_and_alloc (4);
+  gst_buffer_memset (inbuffer, 0, 0, 4);
+  caps = gst_caps_from_string (AUDIO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, gdppay, caps, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  /* stream-start, caps, segment and buffer */
+  fail_unless_equals_int (g_list_length (buffers), 4);
+
+  /* the caps packet in the stream defines a dictionary entry */
+  outbuffer = GST_BUFFER (g_list_nth_data (buffers, 1));
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.data[0], 2);
+  fail_unless_equals_int (GST_READ_UINT16_BE (map.data + 4),
+      GST_DP_PAYLOAD_CAPS);
+  fail_unless_equals_int (map.data[GST_DP_HEADER_LENGTH], GST_DP_CAPS_DEFINE);
+  gst_buffer_unmap (outbuffer, &map);
+
+  /* the one on the streamheader must be readable on its own */
+  sinkcaps = gst_pad_get_current_caps (mysinkpad);
+  structure = gst_caps_get_structure (sinkcaps, 0);
+  sh = gst_structure_get_value (structure, "streamheader");
+  fail_unless_equals_int (gst_value_array_get_size (sh), 3);
+  outbuffer = gst_value_get_buffer (gst_value_array_get_value (sh, 1));
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.data[0], 2);
+  fail_unless_equals_int (map.data[GST_DP_HEADER_LENGTH], GST_DP_CAPS_INLINE);
+  gst_buffer_unmap (outbuffer, &map);
+  gst_caps_unref (sinkcaps);
+
+  /* buffer packets don't change */
+  outbuffer = GST_BUFFER (g_list_nth_data (buffers, 3));
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.data[0], 1);
+  gst_buffer_unmap (outbuffer, &map);
+
+  fail_unless (gst_element_set_state (gdppay,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  gst_caps_unref (caps);
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+  ASSERT_OBJECT_REFCOUNT (gdppay, "gdppay", 1);
+  cleanup_gdppay (gdppay);
+}
+
+GST_END_TEST;
+
+/* the byte at a time CRC gst_dp_crc() used before slice-by-8 */
+static guint16
+bytewise_crc (const guint8 * data, gsize length)
+{
+  guint16 crc_register = CRC_INIT;
+
+  if (length == 0)
+    return 0;
+
+  while (length-- > 0) {
+    crc_register = (guint16) ((crc_register << 8) ^
+        gst_dp_crc_table[((crc_register >> 8) & 0x00ff) ^ *data++]);
+  }
+
+  return (0xffff ^ crc_register);
+}
+
+GST_START_TEST (test_crc_slice_by_8)
+{
+  guint8 data[256 + 8];
+  GstMapInfo maps[3];
+  guint i, len, offset;
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = g_random_int () & 0xff;
+
+  /* all tail lengths and alignments */
+  for (offset = 0; offset < 8; offset++) {
+    for (len = 0; len <= 256; len++) {
+      fail_unless_equals_int (gst_dp_crc (data + offset, len),
+          bytewise_crc (data + offset, len));
+    }
+  }
+
+  /* the register carries over between memories of odd sizes */
+  maps[0].data = data;
+  maps[0].size = 13;
+  maps[1].data = data + 13;
+  maps[1].size = 100;
+  maps[2].data = data + 113;
+  maps[2].size = 7;
+  fail_unless_equals_int (gst_dp_crc_from_memory_maps (maps, 3),
+      bytewise_crc (data, 120));
+}
+
+GST_END_TEST;
+
+#define FRAME_4K_SIZE (3840 * 2160 * 3 / 2)
+#define N_FRAMES 10
+
+/* an I420 frame with one memory per plane */
+static GstBuffer *
+create_4k_frame (GstMemory ** planes)
+{
+  GstBuffer *frame;
+  GstMapInfo map;
+  gsize plane_size[3] = { 3840 * 2160, 3840 * 2160 / 4, 3840 * 2160 / 4 };
+  gint i;
+
+  frame = gst_buffer_new ();
+  for (i = 0; i < 3; i++) {
+    planes[i] = gst_allocator_alloc (NULL, plane_size[i], NULL);
+    gst_memory_map (planes[i], &map, GST_MAP_WRITE);
+    memset (map.data, 0x10 * (i + 1), map.size);
+    gst_memory_unmap (planes[i], &map);
+    gst_buffer_append_memory (frame, planes[i]);
+  }
+  fail_unless_equals_int (gst_buffer_get_size (frame), FRAME_4K_SIZE);
+
+  return frame;
+}
+
+static GstElement *
+setup_gdppay_crc_payload (void)
+{
+  GstElement *gdppay;
+  GstCaps *caps;
+
+  gdppay = setup_gdppay ();
+  g_object_set (gdppay, "crc-payload", TRUE, NULL);
+
+  fail_unless (gst_element_set_state (gdppay,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (AUDIO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, gdppay, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  return gdppay;
+}
+
+static void
+cleanup_gdppay_crc_payload (GstElement * gdppay)
+{
+  fail_unless (gst_element_set_state (gdppay,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+  ASSERT_OBJECT_REFCOUNT (gdppay, "gdppay", 1);
+  cleanup_gdppay (gdppay);
+}
+
+GST_START_TEST (test_zero_copy_4k)
+{
+  GstElement *gdppay;
+  GstBuffer *frame, *outbuffer;
+  GstMemory *planes[3];
+  GstMapInfo map;
+  guint16 crc;
+  gint i;
+
+  gdppay = setup_gdppay_crc_payload ();
+  frame = create_4k_frame (planes);
+
+  gst_buffer_map (frame, &map, GST_MAP_READ);
+  crc = bytewise_crc (map.data, map.size);
+  gst_buffer_unmap (frame, &map);
+
+  fail_unless (gst_pad_push (mysrcpad, gst_buffer_ref (frame)) == GST_FLOW_OK);
+
+  /* stream-start, caps and segment before the frame */
+  fail_unless_equals_int (g_list_length (buffers), 4);
+  outbuffer = GST_BUFFER (g_list_last (buffers)->data);
+
+  /* the header in its own memory, then the planes as they came in */
+  fail_unless_equals_int (gst_buffer_n_memory (outbuffer), 4);
+  for (i = 0; i < 3; i++)
+    fail_unless (gst_buffer_peek_memory (outbuffer, i + 1) == planes[i]);
+
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (GST_READ_UINT16_BE (map.data + 60), crc);
+  gst_buffer_unmap (outbuffer, &map);
+
+  gst_buffer_unref (frame);
+  cleanup_gdppay_crc_payload (gdppay);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bench_zero_copy_4k)
+{
+  GstElement *gdppay;
+  GstBuffer *frame;
+  GstMemory *planes[3];
+  GstMapInfo map;
+  gint64 start, end;
+  guint16 crc;
+  gint i;
+
+  gdppay = setup_gdppay_crc_payload ();
+  frame = create_4k_frame (planes);
+
+  gst_buffer_map (frame, &map, GST_MAP_READ);
+  start = g_get_monotonic_time ();
+  crc = bytewise_crc (map.data, map.size);
+  end = g_get_monotonic_time ();
+  gst_buffer_unmap (frame, &map);
+  GST_INFO ("byte at a time CRC 0x%04x of a 4K frame: %" G_GINT64_FORMAT
+      " us, %.1f MB/s", crc, end - start,
+      (gdouble) FRAME_4K_SIZE / MAX (end - start, 1));
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_FRAMES; i++) {
+    fail_unless (gst_pad_push (mysrcpad,
+            gst_buffer_ref (frame)) == GST_FLOW_OK);
+  }
+  end = g_get_monotonic_time ();
+  GST_INFO ("payloaded %d 4K frames with payload CRC in %" G_GINT64_FORMAT
+      " us, %.1f frames/s, %.1f MB/s", N_FRAMES, end - start,
+      N_FRAMES * 1000000.0 / MAX (end - start, 1),
+      N_FRAMES * (gdouble) FRAME_4K_SIZE / MAX (end - start, 1));
+
+  fail_unless_equals_int (g_list_length (buffers), 3 + N_FRAMES);
+
+  gst_buffer_unref (frame);
+  cleanup_gdppay_crc_payload (gdppay);
+}
+
+GST_END_TEST;
+
+#define N_PACKETS 10000
+
+#define VIDEO_CAPS_STRING \
+  "video/x-raw, format=(string)I420, width=(int)1920, height=(int)1080, " \
+    "framerate=(fraction)30000/1001, pixel-aspect-ratio=(fraction)1/1, " \
+    "interlace-mode=(string)progressive, colorimetry=(string)bt709, " \
+    "chroma-site=(string)mpeg2, multiview-mode=(string)mono"
+
+static void
+serialize_caps_and_segment (GstDPVersion version)
+{
+  GstDPDictionary *pay_dict, *depay_dict;
+  GstCaps *caps, *outcaps;
+  GstEvent *event, *outevent;
+  GstSegment segment;
+  GstBuffer *buf;
+  GstMapInfo map;
+  gsize caps_size = 0, event_size = 0;
+  gint64 start, end;
+  gint i;
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  event = gst_event_new_segment (&segment);
+  pay_dict = gst_dp_dictionary_new ();
+  depay_dict = gst_dp_dictionary_new ();
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_PACKETS; i++) {
+    /* self-contained caps, as sent on the streamheader to new clients */
+    buf = gst_dp_payload_caps_full (caps, 0, version, NULL);
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    outcaps = gst_dp_caps_from_packet_full (GST_DP_HEADER_LENGTH, map.data,
+        map.data + GST_DP_HEADER_LENGTH, depay_dict);
+    caps_size = map.size;
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+    fail_unless (outcaps != NULL);
+    gst_caps_unref (outcaps);
+
+    buf = gst_dp_payload_event_full (event, 0, version);
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    outevent = gst_dp_event_from_packet (GST_DP_HEADER_LENGTH, map.data,
+        map.data + GST_DP_HEADER_LENGTH);
+    event_size = map.size;
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+    fail_unless (outevent != NULL);
+    gst_event_unref (outevent);
+  }
+  end = g_get_monotonic_time ();
+
+  GST_INFO ("GDP %s: %d caps (%" G_GSIZE_FORMAT " bytes) and segment (%"
+      G_GSIZE_FORMAT " bytes) round trips in %" G_GINT64_FORMAT " us, "
+      "%.0f packets/s", version == GST_DP_VERSION_2_0 ? "2.0" : "1.0",
+      N_PACKETS, caps_size, event_size, end - start,
+      2 * N_PACKETS * 1000000.0 / MAX (end - start, 1));
+
+  if (version == GST_DP_VERSION_2_0) {
+    /* repeated caps on the stream only cost a reference */
+    start = g_get_monotonic_time ();
+    for (i = 0; i < N_PACKETS; i++) {
+      buf = gst_dp_payload_caps_full (caps, 0, version, pay_dict);
+      gst_buffer_map (buf, &map, GST_MAP_READ);
+      outcaps = gst_dp_caps_from_packet_full (GST_DP_HEADER_LENGTH, map.data,
+          map.data + GST_DP_HEADER_LENGTH, depay_dict);
+      caps_size = map.size;
+      gst_buffer_unmap (buf, &map);
+      gst_buffer_unref (buf);
+      fail_unless (outcaps != NULL);
+      gst_caps_unref (outcaps);
+    }
+    end = g_get_monotonic_time ();
+
+    fail_unless_equals_int (caps_size, GST_DP_HEADER_LENGTH + 3);
+    GST_INFO ("GDP 2.0: %d dictionary caps round trips in %" G_GINT64_FORMAT
+        " us, %.0f packets/s", N_PACKETS, end - start,
+        N_PACKETS * 1000000.0 / MAX (end - start, 1));
+  }
+
+  gst_dp_dictionary_free (depay_dict);
+  gst_dp_dictionary_free (pay_dict);
+  gst_event_unref (event);
+  gst_caps_unref (caps);
+}
+
+GST_START_TEST (test_bench_serialization)
+{
+  serialize_caps_and_segment (GST_DP_VERSION_1_0);
+  serialize_caps_and_segment (GST_DP_VERSION_2_0);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gdppay_suite (void)
 {
   Suite *s = suite_create ("gdppay");
   TCase *tc_chain = tcase_create ("general");
+  TCase *tc_bench;
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_audio);
@@ -568,6 +913,14 @@ gdppay_suite (void)
   tcase_add_test (tc_chain, test_first_no_new_segment);
   tcase_add_test (tc_chain, test_streamheader);
   tcase_add_test (tc_chain, test_crc);
+  tcase_add_test (tc_chain, test_crc_slice_by_8);
+  tcase_add_test (tc_chain, test_zero_copy_4k);
+  tcase_add_test (tc_chain, test_version_2);
+
+  if ((tc_bench = benchmark_tcase_new (s, 120))) {
+    tcase_add_test (tc_bench, test_bench_zero_copy_4k);
+    tcase_add_test (tc_bench, test_bench_serialization);
+  }
 
   return s;
 }
@@ -0,0 +1,229 @@
+/* GStreamer unit tests for the interaudiosink and interaudiosrc elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/audio/audio.h>
+
+#define RATE 48000
+#define CAPS "audio/x-raw,format=" GST_AUDIO_NE (S16) ",layout=interleaved," \
+    "rate=48000,channels=1"
+
+/* 10 ms buffers */
+#define BUFFER_SAMPLES (RATE / 100)
+#define BUFFER_DURATION (10 * GST_MSECOND)
+
+/* Runs the element of @h against the system clock, with running time 0 at
+ * @base_time */
+static void
+use_clock (GstHarness * h, const gchar * name, GstClockTime base_time)
+{
+  GstElement *element;
+
+  gst_harness_use_systemclock (h);
+  gst_element_set_base_time (h->element, base_time);
+  element = gst_harness_find_element (h, name);
+  gst_element_set_base_time (element, base_time);
+  gst_object_unref (element);
+}
+
+static GstClockTime
+clock_time_from_now (GstClockTime delay)
+{
+  GstClock *clock = gst_system_clock_obtain ();
+  GstClockTime now = gst_clock_get_time (clock);
+
+  gst_object_unref (clock);
+
+  return now + delay;
+}
+
+/* A buffer of @value, with @impulse in the first sample if not 0 */
+static GstBuffer *
+audio_buffer_new (guint i, gint16 value, gint16 impulse)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint16 *samples;
+  guint j;
+
+  buf = gst_buffer_new_allocate (NULL, BUFFER_SAMPLES * 2, NULL);
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_WRITE));
+  samples = (gint16 *) map.data;
+  for (j = 0; j < BUFFER_SAMPLES; j++)
+    samples[j] = value;
+  if (impulse)
+    samples[0] = impulse;
+  gst_buffer_unmap (buf, &map);
+
+  GST_BUFFER_PTS (buf) = i * BUFFER_DURATION;
+  GST_BUFFER_DURATION (buf) = BUFFER_DURATION;
+
+  return buf;
+}
+
+static guint64
+get_dropped_samples (GstHarness * h)
+{
+  GstElement *src;
+  GstStructure *stats;
+  guint64 dropped;
+
+  src = gst_harness_find_element (h, "interaudiosrc");
+  g_object_get (src, "stats", &stats, NULL);
+  gst_object_unref (src);
+  fail_unless (gst_structure_get_uint64 (stats, "dropped-samples", &dropped));
+  gst_structure_free (stats);
+
+  return dropped;
+}
+
+/* If the source doesn't read for a while, it continues with the most recent
+ * samples once it does and the older ones are dropped */
+GST_START_TEST (test_overrun_drops_oldest)
+{
+  GstHarness *sink, *src;
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint16 value;
+  guint i;
+
+  /* The source produces its first buffer right away and then waits for
+   * the clock to reach it, the sink fills the ring meanwhile */
+  src = gst_harness_new_parse ("interaudiosrc channel=overrun "
+      "buffer-time=100000000 period-time=10000000");
+  use_clock (src, "interaudiosrc", clock_time_from_now (300 * GST_MSECOND));
+  gst_harness_play (src);
+
+  sink = gst_harness_new_parse ("interaudiosink channel=overrun sync=false");
+  gst_harness_set_src_caps_str (sink, CAPS);
+
+  /* 500 ms, five times buffer-time */
+  for (i = 0; i < 50; i++)
+    fail_unless_equals_int (gst_harness_push (sink, audio_buffer_new (i,
+                i + 1, 0)), GST_FLOW_OK);
+
+  do {
+    buf = gst_harness_pull (src);
+    fail_unless (buf != NULL);
+    if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_GAP)) {
+      gst_buffer_unref (buf);
+      buf = NULL;
+    }
+  } while (!buf);
+
+  /* only the last buffer-time of samples is left */
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+  value = ((gint16 *) map.data)[0];
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+  fail_unless_equals_int (value, 50 - 10 + 1);
+  fail_unless_equals_uint64 (get_dropped_samples (src),
+      (50 - 10) * BUFFER_SAMPLES);
+
+  gst_harness_teardown (sink);
+  gst_harness_teardown (src);
+}
+
+GST_END_TEST;
+
+#define IMPULSE_BUFFER 50
+#define IMPULSE 10000
+
+/* Measure the time it takes a sample to get from the sink to the source
+ * when both run in real time */
+GST_START_TEST (test_latency)
+{
+  GstHarness *sink, *src;
+  GstBuffer *buf;
+  GstClockTime base_time;
+  GstClockTimeDiff latency = 0;
+  gboolean found = FALSE;
+  guint i;
+
+  base_time = clock_time_from_now (100 * GST_MSECOND);
+
+  /* started first, the sink takes latency-time from the surface */
+  src = gst_harness_new_parse ("interaudiosrc channel=latency "
+      "buffer-time=200000000 latency-time=10000000 period-time=10000000");
+  use_clock (src, "interaudiosrc", base_time);
+  gst_harness_play (src);
+
+  sink = gst_harness_new_parse ("interaudiosink channel=latency");
+  use_clock (sink, "interaudiosink", base_time);
+  gst_harness_set_src_caps_str (sink, CAPS);
+
+  /* blocks for a second, the sink syncs every buffer */
+  for (i = 0; i < 100; i++)
+    fail_unless_equals_int (gst_harness_push (sink, audio_buffer_new (i, 0,
+                i == IMPULSE_BUFFER ? IMPULSE : 0)), GST_FLOW_OK);
+
+  while (!found && (buf = gst_harness_try_pull (src))) {
+    GstMapInfo map;
+    gint16 *samples;
+    guint j, n;
+
+    fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+    samples = (gint16 *) map.data;
+    n = map.size / 2;
+    for (j = 0; j < n && !found; j++) {
+      if (samples[j] == IMPULSE) {
+        latency = GST_CLOCK_DIFF (IMPULSE_BUFFER * BUFFER_DURATION,
+            GST_BUFFER_PTS (buf) + gst_util_uint64_scale_int (j, GST_SECOND,
+                RATE));
+        found = TRUE;
+      }
+    }
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+  }
+
+  fail_unless (found);
+  GST_INFO ("sink to source latency %" GST_STIME_FORMAT,
+      GST_STIME_ARGS (latency));
+
+  /* The sink renders latency-time early and the source may take up to
+   * two periods to pick the sample up, allow for some scheduling jitter */
+  fail_unless (latency > -20 * GST_MSECOND && latency < 100 * GST_MSECOND,
+      "latency %" GST_STIME_FORMAT, GST_STIME_ARGS (latency));
+  fail_unless_equals_uint64 (get_dropped_samples (src), 0);
+
+  gst_harness_teardown (sink);
+  gst_harness_teardown (src);
+}
+
+GST_END_TEST;
+
+static Suite *
+interaudio_suite (void)
+{
+  Suite *s = suite_create ("interaudio");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_overrun_drops_oldest);
+  tcase_add_test (tc_chain, test_latency);
+
+  return s;
+}
+
+GST_CHECK_MAIN (interaudio);
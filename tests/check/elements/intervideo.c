@@ -0,0 +1,256 @@
+/* GStreamer unit tests for the intervideosink and intervideosrc elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define N_SOURCES 3
+
+/* The sources run without a clock here, keep them from switching to black
+ * frames after the default timeout of one second worth of repeats */
+#define SRC_TIMEOUT (3600 * GST_SECOND)
+
+static GstHarness *
+sink_harness_new (const gchar * channel, gint width, gint height)
+{
+  GstHarness *h;
+  gchar *desc;
+
+  desc = g_strdup_printf ("intervideosink channel=%s", channel);
+  h = gst_harness_new_parse (desc);
+  g_free (desc);
+
+  desc = g_strdup_printf ("video/x-raw,format=I420,width=%d,height=%d,"
+      "framerate=30/1", width, height);
+  gst_harness_set_src_caps_str (h, desc);
+  g_free (desc);
+
+  return h;
+}
+
+static GstHarness *
+src_harness_new (const gchar * channel)
+{
+  GstHarness *h;
+  gchar *desc;
+
+  desc = g_strdup_printf ("intervideosrc channel=%s "
+      "timeout=%" G_GUINT64_FORMAT, channel, SRC_TIMEOUT);
+  h = gst_harness_new_parse (desc);
+  g_free (desc);
+
+  return h;
+}
+
+static GstBuffer *
+frame_new (gint width, gint height, guint8 level)
+{
+  GstVideoInfo info;
+  GstBuffer *buf;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, width, height);
+  buf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  gst_buffer_memset (buf, 0, level, GST_VIDEO_INFO_SIZE (&info));
+
+  return buf;
+}
+
+/* Pull from @h until the frame sharing the memory of @frame comes out */
+static void
+pull_until (GstHarness * h, GstBuffer * frame)
+{
+  GstBuffer *buf;
+  gboolean found = FALSE;
+
+  while (!found) {
+    buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+    found = gst_buffer_peek_memory (buf, 0) == gst_buffer_peek_memory (frame,
+        0);
+    gst_buffer_unref (buf);
+  }
+}
+
+static GstStructure *
+get_stats (GstHarness * h)
+{
+  GstElement *src;
+  GstStructure *stats;
+
+  src = gst_harness_find_element (h, "intervideosrc");
+  g_object_get (src, "stats", &stats, NULL);
+  gst_object_unref (src);
+
+  return stats;
+}
+
+/* All sources get every frame without copying it, and their stats add up
+ * to the number of frames the sink published */
+GST_START_TEST (test_multiple_sources)
+{
+  GstHarness *sink, *src[N_SOURCES];
+  GstBuffer *frames[4];
+  guint i, j;
+
+  sink = sink_harness_new ("multi", 320, 240);
+  for (i = 0; i < N_SOURCES; i++) {
+    src[i] = src_harness_new ("multi");
+    gst_harness_play (src[i]);
+    /* nothing was published yet, so this is a black frame */
+    gst_buffer_unref (gst_harness_pull (src[i]));
+  }
+
+  /* hand over one frame at a time */
+  for (i = 0; i < 2; i++) {
+    frames[i] = frame_new (320, 240, 16 + i);
+    fail_unless_equals_int (gst_harness_push (sink,
+            gst_buffer_ref (frames[i])), GST_FLOW_OK);
+    for (j = 0; j < N_SOURCES; j++)
+      pull_until (src[j], frames[i]);
+  }
+
+  /* and two in a row, the sources may or may not miss the first one */
+  for (i = 2; i < 4; i++) {
+    frames[i] = frame_new (320, 240, 16 + i);
+    fail_unless_equals_int (gst_harness_push (sink,
+            gst_buffer_ref (frames[i])), GST_FLOW_OK);
+  }
+  for (j = 0; j < N_SOURCES; j++)
+    pull_until (src[j], frames[3]);
+
+  for (j = 0; j < N_SOURCES; j++) {
+    GstStructure *stats;
+    guint64 pushed, repeated, dropped, black;
+
+    /* the counters are updated together, further repeats of the last
+     * frame don't change the sum below */
+    stats = get_stats (src[j]);
+    fail_unless (gst_structure_get_uint64 (stats, "frames-pushed", &pushed));
+    fail_unless (gst_structure_get_uint64 (stats, "frames-repeated",
+            &repeated));
+    fail_unless (gst_structure_get_uint64 (stats, "frames-dropped", &dropped));
+    fail_unless (gst_structure_get_uint64 (stats, "frames-black", &black));
+    gst_structure_free (stats);
+
+    GST_DEBUG ("source %u: %" G_GUINT64_FORMAT " pushed, %" G_GUINT64_FORMAT
+        " repeated, %" G_GUINT64_FORMAT " dropped, %" G_GUINT64_FORMAT
+        " black", j, pushed, repeated, dropped, black);
+
+    /* every frame published since the source started (including the
+     * initial empty one) was either output or counted as dropped */
+    fail_unless_equals_uint64 (pushed - repeated + dropped,
+        G_N_ELEMENTS (frames) + 1);
+    fail_unless (dropped <= 1);
+    fail_unless (black >= 1 && black <= pushed);
+  }
+
+  for (j = 0; j < N_SOURCES; j++)
+    gst_harness_teardown (src[j]);
+  gst_harness_teardown (sink);
+  for (i = 0; i < G_N_ELEMENTS (frames); i++)
+    gst_buffer_unref (frames[i]);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+check_size_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  gint *mismatches = user_data;
+  GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstVideoInfo vinfo;
+  GstCaps *caps;
+
+  /* runs in the streaming thread, only count here */
+  caps = gst_pad_get_current_caps (pad);
+  if (!caps || !gst_video_info_from_caps (&vinfo, caps) ||
+      gst_buffer_get_size (buf) != GST_VIDEO_INFO_SIZE (&vinfo))
+    g_atomic_int_inc (mismatches);
+  if (caps)
+    gst_caps_unref (caps);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Frames are always pushed with the caps they were rendered with, even if
+ * the sink changes the format while a source is reading */
+GST_START_TEST (test_caps_change)
+{
+  GstHarness *sink, *src;
+  GstElement *element;
+  GstBuffer *buf;
+  GstPad *pad;
+  gint mismatches = 0;
+  guint i;
+
+  sink = sink_harness_new ("caps", 320, 240);
+
+  src = src_harness_new ("caps");
+  element = gst_harness_find_element (src, "intervideosrc");
+  pad = gst_element_get_static_pad (element, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, check_size_probe,
+      &mismatches, NULL);
+  gst_object_unref (pad);
+  gst_object_unref (element);
+  gst_harness_play (src);
+
+  for (i = 0; i < 200; i++) {
+    gint width = (i & 1) ? 160 : 320;
+    gint height = (i & 1) ? 120 : 240;
+    gchar *caps;
+
+    caps = g_strdup_printf ("video/x-raw,format=I420,width=%d,height=%d,"
+        "framerate=30/1", width, height);
+    gst_harness_set_src_caps_str (sink, caps);
+    g_free (caps);
+
+    fail_unless_equals_int (gst_harness_push (sink, frame_new (width, height,
+                i)), GST_FLOW_OK);
+
+    /* keep the queue of the source harness short */
+    while ((buf = gst_harness_try_pull (src)))
+      gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (src);
+  gst_harness_teardown (sink);
+
+  fail_unless_equals_int (mismatches, 0);
+}
+
+GST_END_TEST;
+
+static Suite *
+intervideo_suite (void)
+{
+  Suite *s = suite_create ("intervideo");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_multiple_sources);
+  tcase_add_test (tc_chain, test_caps_change);
+
+  return s;
+}
+
+GST_CHECK_MAIN (intervideo);
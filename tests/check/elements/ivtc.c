@@ -0,0 +1,256 @@
+/* GStreamer unit tests for the ivtc element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#include "benchmark.h"
+
+/* 10 telecined frames carry 4 film frames A, B, C and D as
+ * At+Ab, Bt+Bb, Bt+Cb, Ct+Db, Dt+Db */
+#define N_CYCLES 10
+#define N_FRAMES (N_CYCLES * 5)
+
+static const guint8 film_levels[4] = { 40, 100, 160, 220 };
+
+static const gint pulldown[5][2] = {
+  {0, 0}, {1, 1}, {1, 2}, {2, 3}, {3, 3}
+};
+
+static GstHarness *
+ivtc_harness_new (gint width, gint height)
+{
+  GstHarness *h;
+  gchar *caps;
+
+  h = gst_harness_new ("ivtc");
+
+  caps = g_strdup_printf ("video/x-raw,format=I420,width=%d,height=%d,"
+      "framerate=30000/1001", width, height);
+  gst_harness_set_src_caps_str (h, caps);
+  g_free (caps);
+
+  return h;
+}
+
+/* Make a top field first frame with flat fields at @top and @bottom, or
+ * with a noisy luma if @top is negative */
+static GstBuffer *
+frame_new (gint width, gint height, gint top, gint bottom, guint32 seed)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buf;
+  GRand *rand;
+  guint8 *line;
+  gint x, y, stride;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, width, height);
+  buf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  gst_buffer_memset (buf, 0, 0x80, GST_VIDEO_INFO_SIZE (&info));
+  GST_BUFFER_FLAG_SET (buf, GST_VIDEO_BUFFER_FLAG_TFF);
+
+  fail_unless (gst_video_frame_map (&frame, &info, buf, GST_MAP_WRITE));
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+  rand = g_rand_new_with_seed (seed);
+
+  for (y = 0; y < height; y++) {
+    line = GST_VIDEO_FRAME_COMP_DATA (&frame, 0) + y * stride;
+    for (x = 0; x < width; x++) {
+      if (top < 0)
+        line[x] = g_rand_int (rand);
+      else
+        line[x] = (y & 1) ? bottom : top;
+    }
+  }
+
+  g_rand_free (rand);
+  gst_video_frame_unmap (&frame);
+
+  return buf;
+}
+
+static GstBuffer *
+telecined_frame_new (gint width, gint height, guint i)
+{
+  return frame_new (width, height, film_levels[pulldown[i % 5][0]],
+      film_levels[pulldown[i % 5][1]], i);
+}
+
+/* Return the luma level of a frame, or -1 if it is not flat */
+static gint
+frame_level (GstBuffer * buf, gint width, gint height)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  guint8 *line;
+  gint x, y, level;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, width, height);
+  fail_unless (gst_video_frame_map (&frame, &info, buf, GST_MAP_READ));
+
+  level = GST_VIDEO_FRAME_COMP_DATA (&frame, 0)[0];
+  for (y = 0; y < height && level >= 0; y++) {
+    line = GST_VIDEO_FRAME_COMP_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+    for (x = 0; x < width; x++) {
+      if (line[x] != level) {
+        GST_DEBUG ("line %d differs at %d: %d != %d", y, x, line[x], level);
+        level = -1;
+        break;
+      }
+    }
+  }
+
+  gst_video_frame_unmap (&frame);
+
+  return level;
+}
+
+/* Every film frame comes out once and whole, never woven from the fields
+ * of two different film frames */
+GST_START_TEST (test_telecine)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  guint i, n;
+
+  h = ivtc_harness_new (320, 240);
+
+  for (i = 0; i < N_FRAMES; i++) {
+    buf = telecined_frame_new (320, 240, i);
+    GST_BUFFER_PTS (buf) = gst_util_uint64_scale (i, GST_SECOND * 1001, 30000);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  n = gst_harness_buffers_received (h);
+  fail_unless_equals_int (n, N_CYCLES * 4);
+  for (i = 0; i < n; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless_equals_int (frame_level (buf, 320, 240), film_levels[i % 4]);
+    fail_if (GST_BUFFER_FLAG_IS_SET (buf, GST_VIDEO_BUFFER_FLAG_INTERLACED));
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* Unmatched fields are interpolated to full frames at the film rate */
+GST_START_TEST (test_interpolate)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  guint i, n;
+
+  h = ivtc_harness_new (320, 240);
+
+  for (i = 0; i < N_FRAMES; i++) {
+    buf = frame_new (320, 240, -1, -1, i + 1);
+    GST_BUFFER_PTS (buf) = gst_util_uint64_scale (i, GST_SECOND * 1001, 30000);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  n = gst_harness_buffers_received (h);
+  fail_unless (n >= N_CYCLES * 4 - 2 && n <= N_CYCLES * 4 + 2,
+      "%u frames out of %u", n, N_FRAMES);
+  for (i = 0; i < n; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf),
+        gst_util_uint64_scale (i, GST_SECOND * 1001, 24000));
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define BENCH_N_FRAMES 100
+
+/* Measure the frame rate for 1080i29.97, either telecined, where fields
+ * are paired up, or noise, where every field is interpolated */
+static void
+bench_ivtc (gboolean telecined)
+{
+  GstHarness *h;
+  GstBuffer *in[5], *out;
+  gint64 start, end;
+  guint i;
+
+  h = ivtc_harness_new (1920, 1080);
+  for (i = 0; i < G_N_ELEMENTS (in); i++) {
+    if (telecined)
+      in[i] = telecined_frame_new (1920, 1080, i);
+    else
+      in[i] = frame_new (1920, 1080, -1, -1, i + 1);
+  }
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCH_N_FRAMES; i++) {
+    GstBuffer *buf = gst_buffer_copy (in[i % G_N_ELEMENTS (in)]);
+
+    GST_BUFFER_PTS (buf) = gst_util_uint64_scale (i, GST_SECOND * 1001, 30000);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+    while ((out = gst_harness_try_pull (h)))
+      gst_buffer_unref (out);
+  }
+  end = g_get_monotonic_time ();
+
+  GST_INFO ("%s 1080i: %.2f ms/frame, %.1f fps",
+      telecined ? "telecined" : "noise",
+      (end - start) / 1000.0 / BENCH_N_FRAMES,
+      BENCH_N_FRAMES * G_USEC_PER_SEC / (gdouble) (end - start));
+
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    gst_buffer_unref (in[i]);
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_bench_ivtc)
+{
+  bench_ivtc (TRUE);
+  bench_ivtc (FALSE);
+}
+
+GST_END_TEST;
+
+static Suite *
+ivtc_suite (void)
+{
+  Suite *s = suite_create ("ivtc");
+  TCase *tc_chain = tcase_create ("general");
+  TCase *tc_bench;
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_telecine);
+  tcase_add_test (tc_chain, test_interpolate);
+
+  if ((tc_bench = benchmark_tcase_new (s, 120)))
+    tcase_add_test (tc_bench, test_bench_ivtc);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ivtc);
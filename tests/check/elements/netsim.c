@@ -1,6 +1,10 @@
 #include <gst/check/gstharness.h>
 #include <gst/check/gstcheck.h>
 
+#include <glib/gstdio.h>
+
+#include "benchmark.h"
+
 GST_START_TEST (netsim_stress)
 {
   GstHarness *h = gst_harness_new ("netsim");
@@ -49,6 +53,193 @@ GST_START_TEST (netsim_stress_delayed)
 
 GST_END_TEST;
 
+static GstHarness *
+netsim_harness_new (const gchar * launch_line)
+{
+  GstHarness *h = gst_harness_new_parse (launch_line);
+
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  return h;
+}
+
+static GstBuffer *
+netsim_buffer_new (GstHarness * h, gsize size, guint64 offset)
+{
+  GstBuffer *buf = gst_harness_create_buffer (h, size);
+
+  GST_BUFFER_OFFSET (buf) = offset;
+
+  return buf;
+}
+
+GST_START_TEST (netsim_trace_pacing)
+{
+  const gchar *trace = "# one 1500 bytes opportunity per ms\n1\n2\n3\n4\n5\n";
+  GstHarness *h;
+  gchar *filename, *launch_line;
+  gint fd;
+  gint64 start, end;
+  guint i;
+
+  fd = g_file_open_tmp ("netsim-XXXXXX.trace", &filename, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (filename, trace, -1, NULL));
+
+  launch_line = g_strdup_printf ("netsim trace-file=\"%s\"", filename);
+  h = netsim_harness_new (launch_line);
+  g_free (launch_line);
+
+  /* 20 buffers get through one per ms, in order */
+  start = g_get_monotonic_time ();
+  for (i = 0; i < 20; i++)
+    fail_unless_equals_int (gst_harness_push (h, netsim_buffer_new (h, 1500,
+                i)), GST_FLOW_OK);
+
+  for (i = 0; i < 20; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i);
+    gst_buffer_unref (buf);
+  }
+  end = g_get_monotonic_time ();
+
+  fail_unless (end - start >= 18 * G_TIME_SPAN_MILLISECOND);
+
+  gst_harness_teardown (h);
+  g_unlink (filename);
+  g_free (filename);
+}
+
+GST_END_TEST;
+
+/* A trace loaded once must not keep pacing after trace-file is unset */
+GST_START_TEST (netsim_trace_unset)
+{
+  const gchar *trace = "# one opportunity per second\n1000\n";
+  GstElement *netsim;
+  GstHarness *h;
+  gchar *filename;
+  gint fd;
+  gint64 start, end;
+  guint i;
+
+  fd = g_file_open_tmp ("netsim-XXXXXX.trace", &filename, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (filename, trace, -1, NULL));
+
+  netsim = gst_element_factory_make ("netsim", NULL);
+  g_object_set (netsim, "trace-file", filename, NULL);
+  fail_unless_equals_int (gst_element_set_state (netsim, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (gst_element_set_state (netsim, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  g_object_set (netsim, "trace-file", NULL, NULL);
+
+  h = gst_harness_new_with_element (netsim, "sink", "src");
+  gst_harness_set_src_caps_str (h, "mycaps");
+  gst_object_unref (netsim);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (gst_harness_push (h, netsim_buffer_new (h, 1500,
+                i)), GST_FLOW_OK);
+
+  for (i = 0; i < 10; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i);
+    gst_buffer_unref (buf);
+  }
+  end = g_get_monotonic_time ();
+
+  /* the trace would only let one buffer through per second */
+  fail_unless (end - start < G_USEC_PER_SEC);
+
+  gst_harness_teardown (h);
+  g_unlink (filename);
+  g_free (filename);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (netsim_burst_loss)
+{
+  GstHarness *h = netsim_harness_new ("netsim seed=42 "
+      "burst-enter-probability=0.05 burst-exit-probability=0.25 "
+      "burst-drop-probability=1.0");
+  guint64 expected = 0;
+  guint i, received, lost = 0, bursts = 0;
+
+  for (i = 0; i < 10000; i++)
+    fail_unless_equals_int (gst_harness_push (h, netsim_buffer_new (h, 100,
+                i)), GST_FLOW_OK);
+
+  received = gst_harness_buffers_in_queue (h);
+  fail_unless (received > 0 && received < 10000);
+
+  for (i = 0; i < received; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+
+    if (GST_BUFFER_OFFSET (buf) != expected) {
+      lost += GST_BUFFER_OFFSET (buf) - expected;
+      bursts++;
+    }
+    expected = GST_BUFFER_OFFSET (buf) + 1;
+    gst_buffer_unref (buf);
+  }
+
+  /* On average 4 buffers are lost in a row */
+  GST_INFO ("lost %u buffers in %u bursts", lost, bursts);
+  fail_unless (bursts > 0);
+  fail_unless (lost > 2 * bursts);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define BENCH_N_PACKETS 100000
+
+/* One second of a 100k packets/s flow, each buffer delayed */
+GST_START_TEST (netsim_bench_delay)
+{
+  GstHarness *h = netsim_harness_new ("netsim delay-probability=1.0 "
+      "min-delay=5 max-delay=20 allow-reordering=false");
+  gint64 start, pushed, end;
+  guint i;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCH_N_PACKETS; i++) {
+    gint64 ready = start + i * G_USEC_PER_SEC / BENCH_N_PACKETS;
+
+    /* Pace the input in chunks of 1ms */
+    if (i % (BENCH_N_PACKETS / 1000) == 0 && g_get_monotonic_time () < ready)
+      g_usleep (ready - g_get_monotonic_time ());
+
+    fail_unless_equals_int (gst_harness_push (h, netsim_buffer_new (h, 100,
+                i)), GST_FLOW_OK);
+  }
+  pushed = g_get_monotonic_time ();
+
+  for (i = 0; i < BENCH_N_PACKETS; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i);
+    gst_buffer_unref (buf);
+  }
+  end = g_get_monotonic_time ();
+
+  GST_INFO ("%u packets pushed in %" G_GINT64_FORMAT " us, all out after %"
+      G_GINT64_FORMAT " us", BENCH_N_PACKETS, pushed - start, end - start);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 netsim_suite (void)
 {
@@ -58,6 +249,12 @@ netsim_suite (void)
   suite_add_tcase (s, (tc_chain = tcase_create ("general")));
   tcase_add_test (tc_chain, netsim_stress);
   tcase_add_test (tc_chain, netsim_stress_delayed);
+  tcase_add_test (tc_chain, netsim_trace_pacing);
+  tcase_add_test (tc_chain, netsim_trace_unset);
+  tcase_add_test (tc_chain, netsim_burst_loss);
+
+  if ((tc_chain = benchmark_tcase_new (s, 60)))
+    tcase_add_test (tc_chain, netsim_bench_delay);
 
   return s;
 }
@@ -1,6 +1,8 @@
 #include "parser.h"
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstharness.h>
+#include <glib/gstdio.h>
+#include <string.h>
 
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -115,6 +117,391 @@ GST_START_TEST (test_parse_zerosize_frames)
 
 GST_END_TEST;
 
+/* Appends a pcap record holding an Ethernet/IPv4/UDP frame */
+static void
+append_udp_frame (GByteArray * pcap, guint32 ts_usec, guint32 src_ip,
+    guint16 src_port, guint32 dst_ip, guint16 dst_port, guint8 fill,
+    guint payload_size)
+{
+  guint frame_size = 14 + 20 + 8 + payload_size;
+  guint8 *p;
+
+  g_byte_array_set_size (pcap, pcap->len + 16 + frame_size);
+  p = pcap->data + pcap->len - 16 - frame_size;
+  memset (p, 0, 16 + frame_size);
+
+  GST_WRITE_UINT32_LE (p, ts_usec / G_USEC_PER_SEC);
+  GST_WRITE_UINT32_LE (p + 4, ts_usec % G_USEC_PER_SEC);
+  GST_WRITE_UINT32_LE (p + 8, frame_size);
+  GST_WRITE_UINT32_LE (p + 12, frame_size);
+  p += 16;
+
+  GST_WRITE_UINT16_BE (p + 12, 0x0800);
+  p += 14;
+
+  p[0] = 0x45;
+  GST_WRITE_UINT16_BE (p + 2, 20 + 8 + payload_size);
+  p[8] = 64;
+  p[9] = 17;
+  GST_WRITE_UINT32_BE (p + 12, src_ip);
+  GST_WRITE_UINT32_BE (p + 16, dst_ip);
+  p += 20;
+
+  GST_WRITE_UINT16_BE (p, src_port);
+  GST_WRITE_UINT16_BE (p + 2, dst_port);
+  GST_WRITE_UINT16_BE (p + 4, 8 + payload_size);
+  memset (p + 8, fill, payload_size);
+}
+
+#define FLOW_A_NAME "src_udp_10.0.0.1_5004_10.0.0.2_6000"
+#define FLOW_B_NAME "src_udp_10.0.0.3_5006_10.0.0.2_6002"
+
+/* Three packets of flow A every 20ms, two of flow B starting 10ms in */
+static GstBuffer *
+create_two_flow_pcap (void)
+{
+  GByteArray *pcap = g_byte_array_new ();
+  guint i, len;
+
+  g_byte_array_append (pcap, pcap_header, sizeof (pcap_header));
+  for (i = 0; i < 3; i++) {
+    append_udp_frame (pcap, 1000000 + i * 20000, 0x0a000001, 5004,
+        0x0a000002, 6000, 0xa0 + i, 100);
+    if (i < 2)
+      append_udp_frame (pcap, 1010000 + i * 20000, 0x0a000003, 5006,
+          0x0a000002, 6002, 0xb0 + i, 50);
+  }
+
+  len = pcap->len;
+
+  return gst_buffer_new_wrapped (g_byte_array_free (pcap, FALSE), len);
+}
+
+typedef struct
+{
+  GstPad *pad;
+  gchar *name;
+  guint n_buffers;
+  gsize size;
+  GstClockTime first_ts;
+  gboolean eos;
+} FlowSink;
+
+static GstFlowReturn
+flow_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  FlowSink *sink = gst_pad_get_element_private (pad);
+
+  if (sink->n_buffers == 0)
+    sink->first_ts = GST_BUFFER_TIMESTAMP (buffer);
+  sink->n_buffers++;
+  sink->size = gst_buffer_get_size (buffer);
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+flow_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  FlowSink *sink = gst_pad_get_element_private (pad);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS)
+    sink->eos = TRUE;
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+flow_sink_link (FlowSink * sink, GstPad * srcpad)
+{
+  sink->name = gst_pad_get_name (srcpad);
+  sink->pad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_element_private (sink->pad, sink);
+  gst_pad_set_chain_function (sink->pad, flow_sink_chain);
+  gst_pad_set_event_function (sink->pad, flow_sink_event);
+  gst_pad_set_active (sink->pad, TRUE);
+  fail_unless_equals_int (gst_pad_link (srcpad, sink->pad), GST_PAD_LINK_OK);
+}
+
+static void
+flow_sink_clear (FlowSink * sink)
+{
+  gst_pad_set_active (sink->pad, FALSE);
+  gst_object_unref (sink->pad);
+  g_free (sink->name);
+}
+
+static void
+pad_added_cb (GstElement * element, GstPad * pad, FlowSink * sinks)
+{
+  guint i;
+
+  for (i = 0; sinks[i].pad; i++);
+  fail_unless (i < 2);
+  flow_sink_link (&sinks[i], pad);
+}
+
+GST_START_TEST (test_split_flows)
+{
+  FlowSink sinks[3] = { {NULL,}, };
+  FlowSink *a, *b;
+  GstHarness *h;
+
+  h = gst_harness_new_with_padnames ("pcapparse", "sink", NULL);
+  g_object_set (h->element, "split-flows", TRUE, "ts-offset",
+      G_GINT64_CONSTANT (0), NULL);
+  g_signal_connect (h->element, "pad-added", G_CALLBACK (pad_added_cb), sinks);
+
+  gst_harness_set_src_caps_str (h, "raw/x-pcap");
+  fail_unless_equals_int (gst_harness_push (h, create_two_flow_pcap ()),
+      GST_FLOW_OK);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+
+  fail_unless (sinks[0].pad != NULL && sinks[1].pad != NULL);
+  a = strcmp (sinks[0].name, FLOW_A_NAME) == 0 ? &sinks[0] : &sinks[1];
+  b = a == &sinks[0] ? &sinks[1] : &sinks[0];
+  fail_unless_equals_string (a->name, FLOW_A_NAME);
+  fail_unless_equals_string (b->name, FLOW_B_NAME);
+
+  /* one pass, each flow on its own pad, on a common time base */
+  fail_unless_equals_int (a->n_buffers, 3);
+  fail_unless_equals_int (a->size, 100);
+  fail_unless_equals_uint64 (a->first_ts, 0);
+  fail_unless (a->eos);
+  fail_unless_equals_int (b->n_buffers, 2);
+  fail_unless_equals_int (b->size, 50);
+  fail_unless_equals_uint64 (b->first_ts, 10 * GST_MSECOND);
+  fail_unless (b->eos);
+
+  gst_harness_teardown (h);
+  flow_sink_clear (&sinks[0]);
+  flow_sink_clear (&sinks[1]);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_request_flow_pad)
+{
+  FlowSink sink = { NULL, };
+  GstHarness *h;
+  GstPad *pad;
+  GstBuffer *buf;
+  guint i;
+
+  h = gst_harness_new ("pcapparse");
+  pad = gst_element_get_request_pad (h->element, FLOW_A_NAME);
+  fail_unless (pad != NULL);
+  flow_sink_link (&sink, pad);
+
+  gst_harness_set_src_caps_str (h, "raw/x-pcap");
+  fail_unless_equals_int (gst_harness_push (h, create_two_flow_pcap ()),
+      GST_FLOW_OK);
+
+  /* the requested flow goes to its pad, the other one to the always pad */
+  fail_unless_equals_int (sink.n_buffers, 3);
+  fail_unless_equals_uint64 (sink.first_ts, GST_SECOND);
+  for (i = 0; i < 2; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless_equals_int (gst_buffer_get_size (buf), 50);
+    gst_buffer_unref (buf);
+  }
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 0);
+
+  gst_element_release_request_pad (h->element, pad);
+  gst_object_unref (pad);
+  gst_harness_teardown (h);
+  flow_sink_clear (&sink);
+}
+
+GST_END_TEST;
+
+/* pcapng with a section header, an Ethernet interface using nanosecond
+ * timestamps and one enhanced packet block */
+static GstBuffer *
+create_pcapng (void)
+{
+  const guint8 *frame = pcap_frame_with_eth_padding + 16;
+  guint frame_size = sizeof (pcap_frame_with_eth_padding) - 16;
+  guint64 ts = 1500 * GST_MSECOND;
+  GByteArray *ng = g_byte_array_new ();
+  guint8 *p;
+  guint len;
+
+  /* section header block */
+  g_byte_array_set_size (ng, 28);
+  p = ng->data;
+  GST_WRITE_UINT32_LE (p, 0x0a0d0d0a);
+  GST_WRITE_UINT32_LE (p + 4, 28);
+  GST_WRITE_UINT32_LE (p + 8, 0x1a2b3c4d);
+  GST_WRITE_UINT16_LE (p + 12, 1);
+  GST_WRITE_UINT16_LE (p + 14, 0);
+  GST_WRITE_UINT64_LE (p + 16, G_GUINT64_CONSTANT (0xffffffffffffffff));
+  GST_WRITE_UINT32_LE (p + 24, 28);
+
+  /* interface description block with if_tsresol = 9 */
+  g_byte_array_set_size (ng, 28 + 32);
+  p = ng->data + 28;
+  GST_WRITE_UINT32_LE (p, 1);
+  GST_WRITE_UINT32_LE (p + 4, 32);
+  GST_WRITE_UINT16_LE (p + 8, 1);
+  GST_WRITE_UINT16_LE (p + 10, 0);
+  GST_WRITE_UINT32_LE (p + 12, 0xffff);
+  GST_WRITE_UINT16_LE (p + 16, 9);
+  GST_WRITE_UINT16_LE (p + 18, 1);
+  GST_WRITE_UINT32_LE (p + 20, 9);
+  GST_WRITE_UINT32_LE (p + 24, 0);
+  GST_WRITE_UINT32_LE (p + 28, 32);
+
+  /* enhanced packet block, frame_size is a multiple of 4 */
+  g_byte_array_set_size (ng, 28 + 32 + 32 + frame_size);
+  p = ng->data + 28 + 32;
+  GST_WRITE_UINT32_LE (p, 6);
+  GST_WRITE_UINT32_LE (p + 4, 32 + frame_size);
+  GST_WRITE_UINT32_LE (p + 8, 0);
+  GST_WRITE_UINT32_LE (p + 12, ts >> 32);
+  GST_WRITE_UINT32_LE (p + 16, ts & 0xffffffff);
+  GST_WRITE_UINT32_LE (p + 20, frame_size);
+  GST_WRITE_UINT32_LE (p + 24, frame_size);
+  memcpy (p + 28, frame, frame_size);
+  GST_WRITE_UINT32_LE (p + 28 + frame_size, 32 + frame_size);
+
+  len = ng->len;
+
+  return gst_buffer_new_wrapped (g_byte_array_free (ng, FALSE), len);
+}
+
+GST_START_TEST (test_parse_pcapng)
+{
+  guint offset = pcap_frame_with_eth_padding_offset;
+  guint size = sizeof (pcap_frame_with_eth_padding) - offset - 2;
+  GstBuffer *out_buf;
+  GstHarness *h;
+
+  h = gst_harness_new ("pcapparse");
+  gst_harness_set_src_caps_str (h, "raw/x-pcap");
+  fail_unless_equals_int (gst_harness_push (h, create_pcapng ()),
+      GST_FLOW_OK);
+
+  out_buf = gst_harness_pull (h);
+  fail_unless_equals_int (gst_buffer_get_size (out_buf), size);
+  fail_unless (gst_buffer_memcmp (out_buf, 0,
+          pcap_frame_with_eth_padding + offset, size) == 0);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (out_buf),
+      1500 * GST_MSECOND);
+
+  gst_buffer_unref (out_buf);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* More than two of the 1 MiB blocks read in pull mode, with records split
+ * across them */
+#define PULL_N_PACKETS 2000
+#define PULL_PAYLOAD_SIZE 1300
+
+static void
+pull_handoff_cb (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
+    guint * n_buffers)
+{
+  guint8 fill = 0;
+
+  fail_unless_equals_int (gst_buffer_get_size (buffer), PULL_PAYLOAD_SIZE);
+  gst_buffer_extract (buffer, PULL_PAYLOAD_SIZE - 1, &fill, 1);
+  fail_unless_equals_int (fill, *n_buffers & 0xff);
+  (*n_buffers)++;
+}
+
+GST_START_TEST (test_parse_pull_mode)
+{
+  GByteArray *pcap = g_byte_array_new ();
+  GstElement *pipeline, *parse, *sink;
+  GstMessage *msg;
+  GstPad *pad;
+  GError *error = NULL;
+  gchar *filename, *desc;
+  guint n_buffers = 0, i;
+  gint fd;
+
+  g_byte_array_append (pcap, pcap_header, sizeof (pcap_header));
+  for (i = 0; i < PULL_N_PACKETS; i++)
+    append_udp_frame (pcap, 1000000 + i * 1000, 0x0a000001, 5004,
+        0x0a000002, 6000, i & 0xff, PULL_PAYLOAD_SIZE);
+  fail_unless (pcap->len > 2 * 1024 * 1024);
+
+  fd = g_file_open_tmp ("pcapparse-XXXXXX.pcap", &filename, &error);
+  fail_unless (fd >= 0, "%s", error ? error->message : "");
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (filename, (const gchar *) pcap->data,
+          pcap->len, NULL));
+  g_byte_array_unref (pcap);
+
+  desc = g_strdup_printf ("filesrc location=\"%s\" ! pcapparse name=parse ! "
+      "fakesink name=sink signal-handoffs=true", filename);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (pull_handoff_cb),
+      &n_buffers);
+  gst_object_unref (sink);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  /* filesrc is seekable, so pcapparse pulled the blocks itself */
+  parse = gst_bin_get_by_name (GST_BIN (pipeline), "parse");
+  pad = gst_element_get_static_pad (parse, "sink");
+  fail_unless_equals_int (GST_PAD_MODE (pad), GST_PAD_MODE_PULL);
+  gst_object_unref (pad);
+  gst_object_unref (parse);
+
+  fail_unless_equals_int (n_buffers, PULL_N_PACKETS);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_unlink (filename);
+  g_free (filename);
+}
+
+GST_END_TEST;
+
+/* A record header that doesn't parse stops the element, more data after it
+ * is not taken as the rest of a record */
+GST_START_TEST (test_parse_error_leftover)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  guint8 *data;
+
+  /* pcapng section header with an invalid block length */
+  data = g_malloc0 (24);
+  GST_WRITE_UINT32_LE (data, 0x0a0d0d0a);
+  GST_WRITE_UINT32_LE (data + 4, 13);
+  GST_WRITE_UINT32_LE (data + 8, 0x1a2b3c4d);
+
+  h = gst_harness_new ("pcapparse");
+  gst_harness_set_src_caps_str (h, "raw/x-pcap");
+  buf = gst_buffer_new_wrapped (data, 24);
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_ERROR);
+
+  buf = gst_buffer_new_allocate (NULL, 64, NULL);
+  gst_buffer_memset (buf, 0, 0, 64);
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_ERROR);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 0);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 pcapparse_suite (void)
 {
@@ -133,6 +520,11 @@ pcapparse_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_parse_frames_with_eth_padding);
   tcase_add_test (tc_chain, test_parse_zerosize_frames);
+  tcase_add_test (tc_chain, test_parse_pcapng);
+  tcase_add_test (tc_chain, test_parse_pull_mode);
+  tcase_add_test (tc_chain, test_parse_error_leftover);
+  tcase_add_test (tc_chain, test_split_flows);
+  tcase_add_test (tc_chain, test_request_flow_pad);
 
   return s;
 }
@@ -0,0 +1,278 @@
+/* GStreamer unit tests for the proxysink and proxysrc elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+#define N_BUFFERS 10
+
+typedef struct
+{
+  GstHarness *sink;
+  GstHarness *src;
+
+  /* blocks the hand-off thread in its push into proxysrc */
+  GstPad *block_pad;
+  gulong block_id;
+  GMutex lock;
+  GCond cond;
+  gboolean blocked;
+} ProxyTest;
+
+static GstPadProbeReturn
+block_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  ProxyTest *t = user_data;
+
+  g_mutex_lock (&t->lock);
+  t->blocked = TRUE;
+  g_cond_signal (&t->cond);
+  g_mutex_unlock (&t->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Links a proxysink with @props to a proxysrc whose internal queue doesn't
+ * take anything until proxy_test_unblock() is called */
+static void
+proxy_test_init (ProxyTest * t, const gchar * props)
+{
+  GstElement *sink, *queue;
+  GstPad *srcpad, *target;
+  gchar *desc;
+
+  g_mutex_init (&t->lock);
+  g_cond_init (&t->cond);
+  t->blocked = FALSE;
+
+  desc = g_strdup_printf ("proxysink %s", props);
+  t->sink = gst_harness_new_parse (desc);
+  g_free (desc);
+
+  t->src = gst_harness_new ("proxysrc");
+  sink = gst_harness_find_element (t->sink, "proxysink");
+  g_object_set (t->src->element, "proxysink", sink, NULL);
+  gst_object_unref (sink);
+
+  /* the sink pad of the queue inside proxysrc */
+  srcpad = gst_element_get_static_pad (t->src->element, "src");
+  target = gst_ghost_pad_get_target (GST_GHOST_PAD (srcpad));
+  queue = gst_pad_get_parent_element (target);
+  t->block_pad = gst_element_get_static_pad (queue, "sink");
+  gst_object_unref (queue);
+  gst_object_unref (target);
+  gst_object_unref (srcpad);
+  t->block_id = gst_pad_add_probe (t->block_pad,
+      GST_PAD_PROBE_TYPE_BLOCK | GST_PAD_PROBE_TYPE_BUFFER, block_probe, t,
+      NULL);
+
+  gst_harness_play (t->src);
+  gst_harness_set_src_caps_str (t->sink, "application/x-test");
+}
+
+static void
+proxy_test_wait_blocked (ProxyTest * t)
+{
+  g_mutex_lock (&t->lock);
+  while (!t->blocked)
+    g_cond_wait (&t->cond, &t->lock);
+  g_mutex_unlock (&t->lock);
+}
+
+static void
+proxy_test_unblock (ProxyTest * t)
+{
+  if (t->block_id) {
+    gst_pad_remove_probe (t->block_pad, t->block_id);
+    t->block_id = 0;
+  }
+}
+
+static void
+proxy_test_clear (ProxyTest * t)
+{
+  proxy_test_unblock (t);
+  gst_object_unref (t->block_pad);
+  gst_harness_teardown (t->sink);
+  gst_harness_teardown (t->src);
+  g_cond_clear (&t->cond);
+  g_mutex_clear (&t->lock);
+}
+
+static GstBuffer *
+buffer_new (guint i, gsize size, GstClockTime pts)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, size, NULL);
+
+  GST_BUFFER_OFFSET (buf) = i;
+  GST_BUFFER_PTS (buf) = pts;
+
+  return buf;
+}
+
+static guint64
+get_dropped (ProxyTest * t)
+{
+  GstElement *sink;
+  GstStructure *stats;
+  guint64 dropped;
+
+  sink = gst_harness_find_element (t->sink, "proxysink");
+  g_object_get (sink, "stats", &stats, NULL);
+  gst_object_unref (sink);
+  fail_unless (gst_structure_get_uint64 (stats, "buffers-dropped", &dropped));
+  gst_structure_free (stats);
+
+  return dropped;
+}
+
+/* Pushes N_BUFFERS while proxysrc is blocked on the first one, and checks
+ * that upstream never blocked, @expected_queued buffers were queued and the
+ * rest dropped according to leaky */
+static void
+check_queue_limit (const gchar * props, gsize size, GstClockTime pts_step,
+    gboolean leaky_downstream, guint expected_queued)
+{
+  ProxyTest t;
+  GstBuffer *buf;
+  guint i, first;
+
+  proxy_test_init (&t, props);
+
+  fail_unless_equals_int (gst_harness_push (t.sink, buffer_new (0, size, 0)),
+      GST_FLOW_OK);
+  proxy_test_wait_blocked (&t);
+
+  /* the limit is reached while the first buffer is in flight */
+  for (i = 1; i < N_BUFFERS; i++)
+    fail_unless_equals_int (gst_harness_push (t.sink, buffer_new (i, size,
+                i * pts_step)), GST_FLOW_OK);
+  fail_unless_equals_uint64 (get_dropped (&t),
+      N_BUFFERS - 1 - expected_queued);
+
+  proxy_test_unblock (&t);
+
+  /* the first one, then the oldest or the newest ones */
+  buf = gst_harness_pull (t.src);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), 0);
+  gst_buffer_unref (buf);
+  first = leaky_downstream ? N_BUFFERS - expected_queued : 1;
+  for (i = first; i < first + expected_queued; i++) {
+    buf = gst_harness_pull (t.src);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i);
+    gst_buffer_unref (buf);
+  }
+
+  proxy_test_clear (&t);
+}
+
+GST_START_TEST (test_queue_buffers)
+{
+  check_queue_limit ("max-size-buffers=2 leaky=downstream", 40, 0, TRUE, 2);
+  check_queue_limit ("max-size-buffers=2 leaky=upstream", 40, 0, FALSE, 2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_queue_bytes)
+{
+  /* full once 100 bytes are reached, so after three 40 byte buffers */
+  check_queue_limit ("max-size-bytes=100 leaky=upstream", 40, 0, FALSE, 3);
+}
+
+GST_END_TEST;
+
+/* Buffers without duration count for the distance of their timestamps */
+GST_START_TEST (test_queue_time_without_duration)
+{
+  check_queue_limit ("max-size-time=100000000 leaky=upstream", 40,
+      40 * GST_MSECOND, FALSE, 3);
+}
+
+GST_END_TEST;
+
+/* Upstream waits for space and gets everything through in order */
+GST_START_TEST (test_queue_blocking)
+{
+  ProxyTest t;
+  GstBuffer *buf;
+  guint i;
+
+  proxy_test_init (&t, "max-size-buffers=2");
+  proxy_test_unblock (&t);
+
+  for (i = 0; i < 100; i++)
+    fail_unless_equals_int (gst_harness_push (t.sink, buffer_new (i, 40,
+                GST_CLOCK_TIME_NONE)), GST_FLOW_OK);
+
+  for (i = 0; i < 100; i++) {
+    buf = gst_harness_pull (t.src);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i);
+    gst_buffer_unref (buf);
+  }
+  fail_unless_equals_uint64 (get_dropped (&t), 0);
+
+  proxy_test_clear (&t);
+}
+
+GST_END_TEST;
+
+/* Stopping doesn't wait for the proxysrc pipeline to take the buffer the
+ * hand-off thread is pushing */
+GST_START_TEST (test_stop_while_pushing)
+{
+  ProxyTest t;
+  GstElement *sink;
+
+  proxy_test_init (&t, "max-size-buffers=1");
+
+  fail_unless_equals_int (gst_harness_push (t.sink, buffer_new (0, 40, 0)),
+      GST_FLOW_OK);
+  proxy_test_wait_blocked (&t);
+
+  sink = gst_harness_find_element (t.sink, "proxysink");
+  fail_unless_equals_int (gst_element_set_state (sink, GST_STATE_READY),
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (sink);
+
+  proxy_test_clear (&t);
+}
+
+GST_END_TEST;
+
+static Suite *
+proxysink_suite (void)
+{
+  Suite *s = suite_create ("proxysink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_queue_buffers);
+  tcase_add_test (tc_chain, test_queue_bytes);
+  tcase_add_test (tc_chain, test_queue_time_without_duration);
+  tcase_add_test (tc_chain, test_queue_blocking);
+  tcase_add_test (tc_chain, test_stop_while_pushing);
+
+  return s;
+}
+
+GST_CHECK_MAIN (proxysink);
@@ -0,0 +1,263 @@
+/* GStreamer unit tests for the scenechange element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#include "benchmark.h"
+
+#define N_FRAMES 16
+#define CUT_FRAME 10
+
+static const gchar *metrics[] = { "sad", "histogram" };
+
+static GstHarness *
+scenechange_harness_new (const gchar * metric, guint subsample, gint width,
+    gint height)
+{
+  GstHarness *h;
+  gchar *caps;
+
+  h = gst_harness_new ("scenechange");
+  gst_util_set_object_arg (G_OBJECT (h->element), "metric", metric);
+  g_object_set (h->element, "subsample", subsample, NULL);
+
+  caps = g_strdup_printf ("video/x-raw,format=I420,width=%d,height=%d,"
+      "framerate=25/1", width, height);
+  gst_harness_set_src_caps_str (h, caps);
+  g_free (caps);
+
+  return h;
+}
+
+/* Make a frame of a fixed random picture with luma levels from @low to
+ * @low + 63, plus a little noise that changes with @seed */
+static GstBuffer *
+frame_new (gint width, gint height, gint low, guint32 seed)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buf;
+  GRand *picture, *noise;
+  guint8 *line;
+  gint x, y, stride;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, width, height);
+  buf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  gst_buffer_memset (buf, 0, 0x80, GST_VIDEO_INFO_SIZE (&info));
+
+  fail_unless (gst_video_frame_map (&frame, &info, buf, GST_MAP_WRITE));
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+  picture = g_rand_new_with_seed (low);
+  noise = g_rand_new_with_seed (seed);
+
+  for (y = 0; y < height; y++) {
+    line = GST_VIDEO_FRAME_COMP_DATA (&frame, 0) + y * stride;
+    for (x = 0; x < width; x++) {
+      line[x] = low + g_rand_int_range (picture, 0, 64) +
+          g_rand_int_range (noise, -2, 3);
+    }
+  }
+
+  g_rand_free (picture);
+  g_rand_free (noise);
+  gst_video_frame_unmap (&frame);
+
+  return buf;
+}
+
+/* Push N_FRAMES frames that switch to another picture at CUT_FRAME and
+ * return the timestamps of all key units requested downstream */
+static GList *
+detect_cuts (const gchar * metric, guint subsample, gint width, gint height)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstEvent *event;
+  GList *cuts = NULL;
+  guint i;
+
+  h = scenechange_harness_new (metric, subsample, width, height);
+
+  for (i = 0; i < N_FRAMES; i++) {
+    buf = frame_new (width, height, i < CUT_FRAME ? 16 : 160, i + 1);
+    GST_BUFFER_PTS (buf) = i * GST_SECOND / 25;
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  while ((event = gst_harness_try_pull_event (h))) {
+    if (gst_video_event_is_force_key_unit (event)) {
+      GstClockTime timestamp;
+
+      fail_unless (gst_video_event_parse_downstream_force_key_unit (event,
+              &timestamp, NULL, NULL, NULL, NULL));
+      cuts = g_list_append (cuts, GUINT_TO_POINTER (timestamp / GST_MSECOND));
+    }
+    gst_event_unref (event);
+  }
+
+  gst_harness_teardown (h);
+
+  return cuts;
+}
+
+static void
+check_cuts (const gchar * metric, guint subsample, gint width, gint height)
+{
+  GList *cuts;
+
+  GST_DEBUG ("testing %s, subsample %u, %dx%d", metric, subsample, width,
+      height);
+
+  cuts = detect_cuts (metric, subsample, width, height);
+  fail_unless_equals_int (g_list_length (cuts), 1);
+  fail_unless_equals_int (GPOINTER_TO_UINT (cuts->data),
+      CUT_FRAME * 1000 / 25);
+  g_list_free (cuts);
+}
+
+/* A cut to a different picture is found once, noise is not a cut */
+GST_START_TEST (test_cut)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (metrics); i++)
+    check_cuts (metrics[i], 1, 320, 240);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_subsample)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (metrics); i++) {
+    check_cuts (metrics[i], 2, 320, 240);
+    check_cuts (metrics[i], 4, 321, 241);
+  }
+}
+
+GST_END_TEST;
+
+/* The sum of differences between a black and a white 4096x2160 frame does
+ * not fit into 32 bits */
+GST_START_TEST (test_large_frame)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstEvent *event;
+  GstVideoInfo info;
+  guint i, n_cuts = 0;
+
+  h = scenechange_harness_new ("sad", 1, 4096, 2160);
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, 4096, 2160);
+
+  for (i = 0; i < N_FRAMES; i++) {
+    buf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+    gst_buffer_memset (buf, 0, 0x80, GST_VIDEO_INFO_SIZE (&info));
+    gst_buffer_memset (buf, GST_VIDEO_INFO_PLANE_OFFSET (&info, 0),
+        i < CUT_FRAME ? 0 : 255, GST_VIDEO_INFO_PLANE_OFFSET (&info, 1));
+    GST_BUFFER_PTS (buf) = i * GST_SECOND / 25;
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  while ((event = gst_harness_try_pull_event (h))) {
+    if (gst_video_event_is_force_key_unit (event))
+      n_cuts++;
+    gst_event_unref (event);
+  }
+  fail_unless_equals_int (n_cuts, 1);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define BENCH_N_FRAMES 100
+
+/* Measure the time taken for 2160p frames.  The element keeps a reference
+ * to the previous frame, so three buffers are cycled to keep every pushed
+ * buffer writable and avoid measuring copies. */
+static void
+bench_scenechange (const gchar * metric, guint subsample)
+{
+  GstHarness *h;
+  GstBuffer *in[3], *out;
+  gint64 start, end;
+  guint i;
+
+  h = scenechange_harness_new (metric, subsample, 3840, 2160);
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    in[i] = frame_new (3840, 2160, i == 2 ? 160 : 16, i + 1);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCH_N_FRAMES; i++) {
+    guint j = i % G_N_ELEMENTS (in);
+
+    GST_BUFFER_PTS (in[j]) = i * GST_SECOND / 25;
+    fail_unless_equals_int (gst_harness_push (h, in[j]), GST_FLOW_OK);
+    out = gst_harness_pull (h);
+    fail_unless (out == in[j]);
+  }
+  end = g_get_monotonic_time ();
+
+  GST_INFO ("%s, subsample %u, 2160p: %.3f ms/frame", metric, subsample,
+      (end - start) / 1000.0 / BENCH_N_FRAMES);
+
+  gst_harness_teardown (h);
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    gst_buffer_unref (in[i]);
+}
+
+GST_START_TEST (test_bench_scenechange)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (metrics); i++) {
+    bench_scenechange (metrics[i], 1);
+    bench_scenechange (metrics[i], 2);
+    bench_scenechange (metrics[i], 4);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+scenechange_suite (void)
+{
+  Suite *s = suite_create ("scenechange");
+  TCase *tc_chain = tcase_create ("general");
+  TCase *tc_bench;
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_cut);
+  tcase_add_test (tc_chain, test_subsample);
+  tcase_add_test (tc_chain, test_large_frame);
+
+  if ((tc_bench = benchmark_tcase_new (s, 120)))
+    tcase_add_test (tc_bench, test_bench_scenechange);
+
+  return s;
+}
+
+GST_CHECK_MAIN (scenechange);
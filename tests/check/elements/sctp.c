@@ -0,0 +1,380 @@
+/* GStreamer unit tests for the sctpenc and sctpdec elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+
+#define SCTP_PORT 5000
+#define TIMEOUT (10 * G_TIME_SPAN_SECOND)
+
+typedef struct _SctpTest SctpTest;
+
+/* One end of the association, an encoder and the decoder of the packets
+ * coming from the other end */
+typedef struct
+{
+  SctpTest *test;
+  GstElement *enc, *dec;
+
+  /* messages received by dec, and the number of its pads removed because
+   * the other end reset their stream */
+  GQueue received;
+  guint pads_removed;
+} SctpPeer;
+
+struct _SctpTest
+{
+  GstElement *pipeline;
+  SctpPeer peer[2];
+  GList *sink_pads;
+
+  GMutex lock;
+  GCond cond;
+  guint established;
+};
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  SctpPeer *peer = gst_pad_get_element_private (pad);
+
+  g_mutex_lock (&peer->test->lock);
+  g_queue_push_tail (&peer->received, buffer);
+  g_cond_broadcast (&peer->test->cond);
+  g_mutex_unlock (&peer->test->lock);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+on_pad_added (GstElement * dec, GstPad * pad, SctpPeer * peer)
+{
+  GstPad *sinkpad;
+
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_element_private (sinkpad, peer);
+  gst_pad_set_chain_function (sinkpad, sink_chain);
+  gst_pad_set_event_function (sinkpad, sink_event);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless_equals_int (gst_pad_link (pad, sinkpad), GST_PAD_LINK_OK);
+
+  g_mutex_lock (&peer->test->lock);
+  peer->test->sink_pads = g_list_prepend (peer->test->sink_pads, sinkpad);
+  g_mutex_unlock (&peer->test->lock);
+}
+
+static void
+on_pad_removed (GstElement * dec, GstPad * pad, SctpPeer * peer)
+{
+  g_mutex_lock (&peer->test->lock);
+  peer->pads_removed++;
+  g_cond_broadcast (&peer->test->cond);
+  g_mutex_unlock (&peer->test->lock);
+}
+
+static void
+on_established (GstElement * enc, gboolean established, SctpTest * t)
+{
+  g_mutex_lock (&t->lock);
+  if (established)
+    t->established++;
+  g_cond_broadcast (&t->cond);
+  g_mutex_unlock (&t->lock);
+}
+
+/* Two encoder/decoder pairs, each sending to the decoder of the other one,
+ * started and connected to each other */
+static void
+sctp_test_init (SctpTest * t, guint64 max_message_size)
+{
+  static guint association_id = 1;
+  gint64 end_time;
+  guint i;
+
+  memset (t, 0, sizeof (SctpTest));
+  g_mutex_init (&t->lock);
+  g_cond_init (&t->cond);
+
+  t->pipeline = gst_pipeline_new (NULL);
+  for (i = 0; i < 2; i++) {
+    SctpPeer *peer = &t->peer[i];
+
+    peer->test = t;
+    g_queue_init (&peer->received);
+
+    peer->enc = gst_element_factory_make ("sctpenc", NULL);
+    peer->dec = gst_element_factory_make ("sctpdec", NULL);
+    fail_unless (peer->enc != NULL && peer->dec != NULL);
+    g_object_set (peer->enc, "sctp-association-id", association_id,
+        "remote-sctp-port", SCTP_PORT, NULL);
+    g_object_set (peer->dec, "sctp-association-id", association_id,
+        "local-sctp-port", SCTP_PORT, "max-message-size", max_message_size,
+        NULL);
+    association_id++;
+
+    g_signal_connect (peer->enc, "sctp-association-established",
+        G_CALLBACK (on_established), t);
+    g_signal_connect (peer->dec, "pad-added", G_CALLBACK (on_pad_added),
+        peer);
+    g_signal_connect (peer->dec, "pad-removed", G_CALLBACK (on_pad_removed),
+        peer);
+    gst_bin_add_many (GST_BIN (t->pipeline), peer->enc, peer->dec, NULL);
+  }
+  fail_unless (gst_element_link (t->peer[0].enc, t->peer[1].dec));
+  fail_unless (gst_element_link (t->peer[1].enc, t->peer[0].dec));
+
+  fail_if (gst_element_set_state (t->pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+
+  end_time = g_get_monotonic_time () + TIMEOUT;
+  g_mutex_lock (&t->lock);
+  while (t->established < 2)
+    fail_unless (g_cond_wait_until (&t->cond, &t->lock, end_time),
+        "association not established");
+  g_mutex_unlock (&t->lock);
+}
+
+static void
+sctp_test_clear (SctpTest * t)
+{
+  guint i;
+
+  gst_element_set_state (t->pipeline, GST_STATE_NULL);
+  gst_object_unref (t->pipeline);
+
+  for (i = 0; i < 2; i++)
+    g_queue_foreach (&t->peer[i].received, (GFunc) gst_buffer_unref, NULL);
+  g_list_free_full (t->sink_pads, gst_object_unref);
+  g_cond_clear (&t->cond);
+  g_mutex_clear (&t->lock);
+}
+
+/* A pad pushing into stream @stream_id of the encoder of @peer */
+static GstPad *
+peer_open_stream (SctpPeer * peer, guint stream_id, guint priority)
+{
+  GstPad *srcpad, *sinkpad;
+  GstSegment segment;
+  gchar *name;
+
+  name = g_strdup_printf ("sink_%u", stream_id);
+  sinkpad = gst_element_get_request_pad (peer->enc, name);
+  g_free (name);
+  fail_unless (sinkpad != NULL);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless_equals_int (gst_pad_link (srcpad, sinkpad), GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+  gst_pad_set_active (srcpad, TRUE);
+
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("sctp-test")));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_caps (gst_caps_new_simple ("application/data",
+                  "ppid", G_TYPE_UINT, 53, "priority", G_TYPE_UINT, priority,
+                  NULL))));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  return srcpad;
+}
+
+/* The first two bytes say which message it is, the rest depends on it */
+static GstBuffer *
+message_new (guint8 stream_id, guint8 index, gsize size)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gsize i;
+
+  buf = gst_buffer_new_allocate (NULL, size, NULL);
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_WRITE));
+  map.data[0] = stream_id;
+  map.data[1] = index;
+  for (i = 2; i < size; i++)
+    map.data[i] = (i + stream_id + index) & 0xff;
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static void
+check_message (GstBuffer * buf, guint8 stream_id, guint8 index, gsize size)
+{
+  GstMapInfo map;
+  gsize i;
+
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, size);
+  for (i = 2; i < size; i++) {
+    if (map.data[i] != ((i + stream_id + index) & 0xff))
+      break;
+  }
+  fail_unless (i == size, "message %u on stream %u corrupt at byte %"
+      G_GSIZE_FORMAT, index, stream_id, i);
+  gst_buffer_unmap (buf, &map);
+}
+
+/* Takes the @n_messages received by @peer, waiting for them if needed, in
+ * an array indexed by stream and message index */
+static void
+peer_take_messages (SctpPeer * peer, guint n_messages, GstBuffer * msgs[3][4])
+{
+  gint64 end_time = g_get_monotonic_time () + TIMEOUT;
+  GstBuffer *buf;
+  guint8 header[2];
+
+  g_mutex_lock (&peer->test->lock);
+  while (g_queue_get_length (&peer->received) < n_messages)
+    fail_unless (g_cond_wait_until (&peer->test->cond, &peer->test->lock,
+            end_time), "only %u of %u messages received",
+        g_queue_get_length (&peer->received), n_messages);
+  fail_unless_equals_int (g_queue_get_length (&peer->received), n_messages);
+
+  while ((buf = g_queue_pop_head (&peer->received))) {
+    fail_unless_equals_int (gst_buffer_extract (buf, 0, header, 2), 2);
+    fail_unless (header[0] < 3 && header[1] < 4);
+    fail_unless (msgs[header[0]][header[1]] == NULL);
+    msgs[header[0]][header[1]] = buf;
+  }
+  g_mutex_unlock (&peer->test->lock);
+}
+
+#define LARGE_MESSAGE_SIZE 65536
+#define SMALL_MESSAGE_SIZE 100
+
+/* Large messages are put back together from their pieces, also while small
+ * messages on a stream with a higher priority are sent in between */
+GST_START_TEST (test_large_messages)
+{
+  SctpTest t;
+  GstPad *srcpad[3];
+  GstBuffer *msgs[3][4] = { {NULL,}, };
+  guint i, j;
+
+  sctp_test_init (&t, 0);
+
+  srcpad[1] = peer_open_stream (&t.peer[0], 1, 128);
+  srcpad[2] = peer_open_stream (&t.peer[0], 2, 256);
+  for (i = 0; i < 4; i++) {
+    fail_unless_equals_int (gst_pad_push (srcpad[1], message_new (1, i,
+                LARGE_MESSAGE_SIZE)), GST_FLOW_OK);
+    fail_unless_equals_int (gst_pad_push (srcpad[2], message_new (2, i,
+                SMALL_MESSAGE_SIZE)), GST_FLOW_OK);
+  }
+
+  peer_take_messages (&t.peer[1], 8, msgs);
+  for (i = 0; i < 4; i++) {
+    check_message (msgs[1][i], 1, i, LARGE_MESSAGE_SIZE);
+    check_message (msgs[2][i], 2, i, SMALL_MESSAGE_SIZE);
+  }
+
+  for (i = 1; i < 3; i++) {
+    gst_object_unref (srcpad[i]);
+    for (j = 0; j < 4; j++)
+      gst_buffer_unref (msgs[i][j]);
+  }
+  sctp_test_clear (&t);
+}
+
+GST_END_TEST;
+
+#define MAX_MESSAGE_SIZE 16384
+
+/* A message larger than max-message-size is dropped and the stream it came
+ * on is reset, which closes the stream on the other end too */
+GST_START_TEST (test_max_message_size)
+{
+  SctpTest t;
+  GstPad *srcpad[3], *back;
+  GstBuffer *msgs[3][4] = { {NULL,}, };
+  gint64 end_time;
+
+  sctp_test_init (&t, MAX_MESSAGE_SIZE);
+
+  /* give peer 0 a pad for stream 1, which goes away with the reset */
+  back = peer_open_stream (&t.peer[1], 1, 0);
+  fail_unless_equals_int (gst_pad_push (back, message_new (1, 0,
+              SMALL_MESSAGE_SIZE)), GST_FLOW_OK);
+  peer_take_messages (&t.peer[0], 1, msgs);
+  check_message (msgs[1][0], 1, 0, SMALL_MESSAGE_SIZE);
+  gst_buffer_unref (msgs[1][0]);
+  msgs[1][0] = NULL;
+
+  srcpad[1] = peer_open_stream (&t.peer[0], 1, 0);
+  srcpad[2] = peer_open_stream (&t.peer[0], 2, 0);
+  fail_unless_equals_int (gst_pad_push (srcpad[1], message_new (1, 0,
+              MAX_MESSAGE_SIZE)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push (srcpad[1], message_new (1, 1,
+              4 * MAX_MESSAGE_SIZE)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push (srcpad[1], message_new (1, 2,
+              SMALL_MESSAGE_SIZE)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push (srcpad[2], message_new (2, 0,
+              SMALL_MESSAGE_SIZE)), GST_FLOW_OK);
+
+  /* everything but the large message arrives, in order */
+  peer_take_messages (&t.peer[1], 3, msgs);
+  fail_unless (msgs[1][1] == NULL);
+  check_message (msgs[1][0], 1, 0, MAX_MESSAGE_SIZE);
+  check_message (msgs[1][2], 1, 2, SMALL_MESSAGE_SIZE);
+  check_message (msgs[2][0], 2, 0, SMALL_MESSAGE_SIZE);
+
+  end_time = g_get_monotonic_time () + TIMEOUT;
+  g_mutex_lock (&t.lock);
+  while (t.peer[0].pads_removed == 0)
+    fail_unless (g_cond_wait_until (&t.cond, &t.lock, end_time),
+        "stream was not reset");
+  g_mutex_unlock (&t.lock);
+  fail_unless (gst_element_get_static_pad (t.peer[0].dec, "src_1") == NULL);
+
+  gst_buffer_unref (msgs[1][0]);
+  gst_buffer_unref (msgs[1][2]);
+  gst_buffer_unref (msgs[2][0]);
+  gst_object_unref (srcpad[1]);
+  gst_object_unref (srcpad[2]);
+  gst_object_unref (back);
+  sctp_test_clear (&t);
+}
+
+GST_END_TEST;
+
+static Suite *
+sctp_suite (void)
+{
+  Suite *s = suite_create ("sctp");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_large_messages);
+  tcase_add_test (tc_chain, test_max_message_size);
+
+  return s;
+}
+
+GST_CHECK_MAIN (sctp);
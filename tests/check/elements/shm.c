@@ -26,6 +26,12 @@
 
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
+#include <gst/allocators/allocators.h>
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "benchmark.h"
 
 
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
@@ -42,7 +48,7 @@ GstElement *src, *sink;
 GstPad *sinkpad, *srcpad;
 
 static void
-setup_shm (void)
+setup_shm_full (gboolean use_memfd)
 {
   gchar *socket_path = NULL;
 
@@ -52,7 +58,8 @@ setup_shm (void)
   srcpad = gst_check_setup_src_pad (sink, &src_template);
   sinkpad = gst_check_setup_sink_pad (src, &sink_template);
 
-  g_object_set (sink, "socket-path", "shm-unit-test", NULL);
+  g_object_set (sink, "socket-path", "shm-unit-test", "use-memfd", use_memfd,
+      NULL);
 
   fail_unless (gst_element_set_state (sink, GST_STATE_PLAYING) ==
       GST_STATE_CHANGE_ASYNC);
@@ -69,6 +76,20 @@ setup_shm (void)
       GST_STATE_CHANGE_SUCCESS);
 }
 
+static void
+setup_shm (void)
+{
+  setup_shm_full (FALSE);
+}
+
+#ifdef HAVE_MEMFD_CREATE
+static void
+setup_shm_memfd (void)
+{
+  setup_shm_full (TRUE);
+}
+#endif
+
 static void
 teardown_shm (void)
 {
@@ -169,6 +190,89 @@ GST_START_TEST (test_shm_alloc)
 
 GST_END_TEST;
 
+#ifdef HAVE_MEMFD_CREATE
+/* Returns the number of buffers the only client of @shmsink has not
+ * released yet */
+static gint
+get_client_pending (GstElement * shmsink)
+{
+  GstStructure *stats;
+  const GValue *clients;
+  gint pending = -1;
+
+  g_object_get (shmsink, "client-stats", &stats, NULL);
+  clients = gst_structure_get_value (stats, "clients");
+  if (gst_value_array_get_size (clients) == 1)
+    fail_unless (gst_structure_get_int (gst_value_get_structure
+            (gst_value_array_get_value (clients, 0)), "pending-buffers",
+            &pending));
+  gst_structure_free (stats);
+
+  return pending;
+}
+
+GST_START_TEST (test_shm_memfd)
+{
+  GstBuffer *buf;
+  GstMemory *mem;
+  GstMapInfo map;
+  GstSegment segment;
+  gint i, fd, pending = -1;
+  gchar byte = 0;
+  gpointer data;
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  buf = gst_buffer_new_allocate (NULL, 4096, NULL);
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_WRITE));
+  for (i = 0; i < map.size; i++)
+    map.data[i] = i * 7;
+  gst_buffer_unmap (buf, &map);
+  fail_unless (gst_pad_push (srcpad, buf) == GST_FLOW_OK);
+
+  g_mutex_lock (&check_mutex);
+  while (buffers == NULL)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  /* the data must arrive unchanged in its own fd */
+  buf = buffers->data;
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 1);
+  mem = gst_buffer_peek_memory (buf, 0);
+  fail_unless (gst_is_fd_memory (mem));
+  fail_unless (GST_MEMORY_IS_READONLY (mem));
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, 4096);
+  for (i = 0; i < map.size; i++)
+    fail_unless_equals_int (map.data[i], (guint8) (i * 7));
+  gst_buffer_unmap (buf, &map);
+
+  /* and nobody but the writer can change it */
+  fd = gst_fd_memory_get_fd (mem);
+  fail_unless (write (fd, &byte, 1) < 0);
+  data = mmap (NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  fail_unless (data == MAP_FAILED);
+
+  /* the buffer is held by the sink until the client releases it */
+  fail_unless_equals_int (get_client_pending (sink), 1);
+  gst_check_drop_buffers ();
+  for (i = 0; i < 500; i++) {
+    pending = get_client_pending (sink);
+    if (pending == 0)
+      break;
+    g_usleep (10 * 1000);
+  }
+  fail_unless_equals_int (pending, 0);
+
+  teardown_shm ();
+}
+
+GST_END_TEST;
+#endif
+
 GST_START_TEST (test_shm_live)
 {
   GstElement *producer, *consumer;
@@ -229,6 +333,207 @@ GST_START_TEST (test_shm_live)
 
 GST_END_TEST;
 
+static guint64
+get_client_stat (GstElement * shmsink, const gchar * field, gint * n_clients)
+{
+  GstStructure *stats;
+  const GValue *clients;
+  const GstStructure *client;
+  guint64 value = 0;
+
+  g_object_get (shmsink, "client-stats", &stats, NULL);
+  fail_unless (stats != NULL);
+
+  clients = gst_structure_get_value (stats, "clients");
+  *n_clients = gst_value_array_get_size (clients);
+  if (*n_clients > 0) {
+    client = gst_value_get_structure (gst_value_array_get_value (clients, 0));
+    if (!gst_structure_get_uint64 (client, field, &value)) {
+      gint ivalue;
+      fail_unless (gst_structure_get_int (client, field, &ivalue));
+      value = ivalue;
+    }
+  }
+  gst_structure_free (stats);
+
+  return value;
+}
+
+GST_START_TEST (test_shm_client_policy_drop)
+{
+  GstElement *producer, *consumer;
+  GstElement *src, *sink, *shmsink;
+  gchar *socket_path = NULL;
+  GstStateChangeReturn state_res;
+  gint n_clients = 0;
+
+  src = gst_element_factory_make ("fakesrc", NULL);
+  g_object_set (src, "sizetype", 2, "sizemax", 1000, NULL);
+
+  shmsink = gst_element_factory_make ("shmsink", NULL);
+  g_object_set (shmsink, "socket-path", "shm-unit-test", "max-client-buffers",
+      2, "client-policy", 1 /* drop */ , NULL);
+
+  producer = gst_pipeline_new ("producer-pipeline");
+  gst_bin_add_many (GST_BIN (producer), src, shmsink, NULL);
+  fail_unless (gst_element_link (src, shmsink));
+
+  state_res = gst_element_set_state (producer, GST_STATE_PLAYING);
+  fail_unless (state_res != GST_STATE_CHANGE_FAILURE);
+
+  g_object_get (shmsink, "socket-path", &socket_path, NULL);
+  fail_unless (socket_path != NULL);
+
+  /* appsink keeps every buffer queued as nobody pulls them, so this client
+   * never releases anything */
+  src = gst_element_factory_make ("shmsrc", NULL);
+  sink = gst_element_factory_make ("appsink", NULL);
+  g_object_set (src, "is-live", TRUE, "socket-path", socket_path, NULL);
+  g_object_set (sink, "async", FALSE, "enable-last-sample", FALSE, NULL);
+
+  consumer = gst_pipeline_new ("consumer-pipeline");
+  gst_bin_add_many (GST_BIN (consumer), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  state_res = gst_element_set_state (consumer, GST_STATE_PLAYING);
+  fail_unless (state_res != GST_STATE_CHANGE_FAILURE);
+
+  /* The producer must keep going even though the client is stuck */
+  while (get_client_stat (shmsink, "buffers-dropped", &n_clients) < 10)
+    g_usleep (G_USEC_PER_SEC / 100);
+
+  fail_unless_equals_int (n_clients, 1);
+  fail_unless (get_client_stat (shmsink, "pending-buffers", &n_clients) <= 2);
+  fail_unless (get_client_stat (shmsink, "buffers-sent", &n_clients) >= 2);
+
+  state_res = gst_element_set_state (consumer, GST_STATE_NULL);
+  fail_unless (state_res != GST_STATE_CHANGE_FAILURE);
+
+  state_res = gst_element_set_state (producer, GST_STATE_NULL);
+  fail_unless (state_res != GST_STATE_CHANGE_FAILURE);
+
+  gst_object_unref (consumer);
+  gst_object_unref (producer);
+
+  g_free (socket_path);
+}
+
+GST_END_TEST;
+
+#define N_CLIENTS 8
+#define N_BUFFERS 500
+#define BUFFER_SIZE (1024 * 1024)
+
+static GMutex bench_lock;
+static GCond bench_cond;
+static guint bench_clients;
+static guint bench_received;
+
+static void
+bench_client_connected (GstElement * sink, gint fd, gpointer user_data)
+{
+  g_mutex_lock (&bench_lock);
+  bench_clients++;
+  g_cond_broadcast (&bench_cond);
+  g_mutex_unlock (&bench_lock);
+}
+
+static void
+bench_handoff (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  g_mutex_lock (&bench_lock);
+  bench_received++;
+  g_cond_broadcast (&bench_cond);
+  g_mutex_unlock (&bench_lock);
+}
+
+/* Measures the rate at which one shmsink can feed multiple shmsrc, with the
+ * result printed in the debug log. Only run as a benchmark */
+GST_START_TEST (test_bench_shm_multi_client_throughput)
+{
+  GstElement *producer, *consumers[N_CLIENTS];
+  GstElement *src, *sink;
+  gchar *socket_path = NULL;
+  GstStateChangeReturn state_res;
+  gint64 start, end;
+  gint i;
+
+  bench_clients = 0;
+  bench_received = 0;
+
+  src = gst_element_factory_make ("fakesrc", NULL);
+  g_object_set (src, "sizetype", 2, "sizemax", BUFFER_SIZE,
+      "num-buffers", N_BUFFERS, NULL);
+
+  sink = gst_element_factory_make ("shmsink", NULL);
+  g_object_set (sink, "socket-path", "shm-unit-test", "shm-size",
+      16 * BUFFER_SIZE, "sync", FALSE, NULL);
+  g_signal_connect (sink, "client-connected",
+      G_CALLBACK (bench_client_connected), NULL);
+
+  producer = gst_pipeline_new ("producer-pipeline");
+  gst_bin_add_many (GST_BIN (producer), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  state_res = gst_element_set_state (producer, GST_STATE_PAUSED);
+  fail_unless (state_res != GST_STATE_CHANGE_FAILURE);
+
+  g_object_get (sink, "socket-path", &socket_path, NULL);
+  fail_unless (socket_path != NULL);
+
+  for (i = 0; i < N_CLIENTS; i++) {
+    src = gst_element_factory_make ("shmsrc", NULL);
+    sink = gst_element_factory_make ("fakesink", NULL);
+    g_object_set (src, "socket-path", socket_path, NULL);
+    g_object_set (sink, "sync", FALSE, "async", FALSE, "signal-handoffs",
+        TRUE, NULL);
+    g_signal_connect (sink, "handoff", G_CALLBACK (bench_handoff), NULL);
+
+    consumers[i] = gst_pipeline_new (NULL);
+    gst_bin_add_many (GST_BIN (consumers[i]), src, sink, NULL);
+    fail_unless (gst_element_link (src, sink));
+
+    state_res = gst_element_set_state (consumers[i], GST_STATE_PLAYING);
+    fail_unless (state_res != GST_STATE_CHANGE_FAILURE);
+  }
+
+  g_mutex_lock (&bench_lock);
+  while (bench_clients < N_CLIENTS)
+    g_cond_wait (&bench_cond, &bench_lock);
+  g_mutex_unlock (&bench_lock);
+
+  start = g_get_monotonic_time ();
+
+  state_res = gst_element_set_state (producer, GST_STATE_PLAYING);
+  fail_unless (state_res != GST_STATE_CHANGE_FAILURE);
+
+  g_mutex_lock (&bench_lock);
+  while (bench_received < N_CLIENTS * N_BUFFERS)
+    g_cond_wait (&bench_cond, &bench_lock);
+  g_mutex_unlock (&bench_lock);
+
+  end = g_get_monotonic_time ();
+
+  GST_INFO ("%d clients received %d buffers of %d bytes in %" G_GINT64_FORMAT
+      " us, %.1f buffers/s per client", N_CLIENTS, N_BUFFERS, BUFFER_SIZE,
+      end - start, N_BUFFERS * 1000000.0 / MAX (end - start, 1));
+
+  for (i = 0; i < N_CLIENTS; i++) {
+    state_res = gst_element_set_state (consumers[i], GST_STATE_NULL);
+    fail_unless (state_res != GST_STATE_CHANGE_FAILURE);
+    gst_object_unref (consumers[i]);
+  }
+
+  state_res = gst_element_set_state (producer, GST_STATE_NULL);
+  fail_unless (state_res != GST_STATE_CHANGE_FAILURE);
+  gst_object_unref (producer);
+
+  g_free (socket_path);
+}
+
+GST_END_TEST;
+
 static Suite *
 shm_suite (void)
 {
@@ -241,10 +546,21 @@ shm_suite (void)
   tcase_add_test (tc, test_shm_alloc);
   suite_add_tcase (s, tc);
 
+#ifdef HAVE_MEMFD_CREATE
+  tc = tcase_create ("shm-memfd");
+  tcase_add_checked_fixture (tc, setup_shm_memfd, NULL);
+  tcase_add_test (tc, test_shm_memfd);
+  suite_add_tcase (s, tc);
+#endif
+
   tc = tcase_create ("shm2");
   tcase_add_test (tc, test_shm_live);
+  tcase_add_test (tc, test_shm_client_policy_drop);
   suite_add_tcase (s, tc);
 
+  if ((tc = benchmark_tcase_new (s, 120)))
+    tcase_add_test (tc, test_bench_shm_multi_client_throughput);
+
   return s;
 }
 
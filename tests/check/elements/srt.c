@@ -0,0 +1,724 @@
+/* GStreamer unit tests for the srt elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+
+#include <gst/check/gstharness.h>
+#include <gio/gio.h>
+
+#include "benchmark.h"
+
+#define PACKET_SIZE 1316
+
+typedef struct
+{
+  GstElement *pipeline;
+  gint bytes;
+
+  /* sequence numbers of the packets received, with the lock */
+  GMutex lock;
+  GHashTable *seen;
+
+  /* keeps srtsrc from reading while set */
+  GstPad *block_pad;
+  gulong block_id;
+} Receiver;
+
+GST_START_TEST (test_create_and_unref)
+{
+  GstElement *e;
+
+  e = gst_element_factory_make ("srtsink", NULL);
+  fail_unless (e != NULL);
+  gst_element_set_state (e, GST_STATE_NULL);
+  gst_object_unref (e);
+
+  e = gst_element_factory_make ("srtsrc", NULL);
+  fail_unless (e != NULL);
+  gst_element_set_state (e, GST_STATE_NULL);
+  gst_object_unref (e);
+}
+
+GST_END_TEST;
+
+static void
+caller_added_cb (GstElement * sink, gint sock, GSocketAddress * addr,
+    gint * n_callers)
+{
+  g_atomic_int_inc (n_callers);
+}
+
+static void
+caller_removed_cb (GstElement * sink, gint sock, GSocketAddress * addr,
+    gint * n_callers)
+{
+  g_atomic_int_add (n_callers, -1);
+}
+
+static void
+handoff_cb (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
+    Receiver * receiver)
+{
+  guint32 seq;
+
+  if (gst_buffer_extract (buffer, 0, &seq, sizeof (seq)) == sizeof (seq)) {
+    g_mutex_lock (&receiver->lock);
+    g_hash_table_add (receiver->seen, GUINT_TO_POINTER (GUINT32_FROM_BE (seq)));
+    g_mutex_unlock (&receiver->lock);
+  }
+
+  g_atomic_int_add (&receiver->bytes, gst_buffer_get_size (buffer));
+}
+
+/* Ports that are free right now, each test uses its own so that the tests
+ * can run in parallel */
+static void
+get_free_ports (guint * ports, guint n_ports)
+{
+  GSocket **sockets = g_new0 (GSocket *, n_ports);
+  guint i;
+
+  /* all stay bound until the last one is picked, so they differ */
+  for (i = 0; i < n_ports; i++) {
+    GInetAddress *any = g_inet_address_new_any (G_SOCKET_FAMILY_IPV4);
+    GSocketAddress *addr = g_inet_socket_address_new (any, 0);
+    GSocketAddress *bound;
+
+    sockets[i] = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+        G_SOCKET_PROTOCOL_UDP, NULL);
+    fail_unless (sockets[i] != NULL);
+    fail_unless (g_socket_bind (sockets[i], addr, FALSE, NULL));
+    bound = g_socket_get_local_address (sockets[i], NULL);
+    fail_unless (bound != NULL);
+    ports[i] =
+        g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (bound));
+
+    g_object_unref (bound);
+    g_object_unref (addr);
+    g_object_unref (any);
+  }
+
+  for (i = 0; i < n_ports; i++)
+    g_object_unref (sockets[i]);
+  g_free (sockets);
+}
+
+static guint
+get_free_port (void)
+{
+  guint port;
+
+  get_free_ports (&port, 1);
+
+  return port;
+}
+
+/* An srtsink listening on port, fed by the harness */
+static GstHarness *
+listener_harness_new (guint port, gint * n_callers)
+{
+  GstHarness *h;
+  gchar *uri;
+
+  h = gst_harness_new ("srtsink");
+  uri = g_strdup_printf ("srt://:%u?mode=listener", port);
+  g_object_set (h->element, "uri", uri, "sync", FALSE, "async", FALSE, NULL);
+  g_free (uri);
+
+  g_signal_connect (h->element, "caller-added",
+      G_CALLBACK (caller_added_cb), n_callers);
+  g_signal_connect (h->element, "caller-removed",
+      G_CALLBACK (caller_removed_cb), n_callers);
+
+  gst_harness_set_src_caps_str (h, "application/x-test");
+  gst_harness_play (h);
+
+  return h;
+}
+
+static GstPadProbeReturn
+block_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  return GST_PAD_PROBE_OK;
+}
+
+/* An srtsrc calling port, which doesn't read anything if @blocked until
+ * receiver_unblock() */
+static void
+receiver_start_full (Receiver * receiver, guint port,
+    gchar ** redundant_uris, gboolean blocked)
+{
+  GstElement *src, *fakesink;
+  gchar *desc;
+
+  desc = g_strdup_printf ("srtsrc name=src uri=srt://127.0.0.1:%u ! "
+      "fakesink name=sink sync=false signal-handoffs=true", port);
+  receiver->pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (receiver->pipeline != NULL);
+
+  src = gst_bin_get_by_name (GST_BIN (receiver->pipeline), "src");
+  g_object_set (src, "redundant-uris", redundant_uris, NULL);
+  gst_object_unref (src);
+
+  receiver->bytes = 0;
+  g_mutex_init (&receiver->lock);
+  receiver->seen = g_hash_table_new (NULL, NULL);
+  fakesink = gst_bin_get_by_name (GST_BIN (receiver->pipeline), "sink");
+  g_signal_connect (fakesink, "handoff", G_CALLBACK (handoff_cb), receiver);
+  receiver->block_pad = gst_element_get_static_pad (fakesink, "sink");
+  receiver->block_id = blocked ? gst_pad_add_probe (receiver->block_pad,
+      GST_PAD_PROBE_TYPE_BLOCK | GST_PAD_PROBE_TYPE_BUFFER, block_probe, NULL,
+      NULL) : 0;
+  gst_object_unref (fakesink);
+
+  fail_unless (gst_element_set_state (receiver->pipeline, GST_STATE_PLAYING)
+      != GST_STATE_CHANGE_FAILURE);
+}
+
+static void
+receiver_start (Receiver * receiver, guint port)
+{
+  receiver_start_full (receiver, port, NULL, FALSE);
+}
+
+static void
+receiver_unblock (Receiver * receiver)
+{
+  if (receiver->block_id) {
+    gst_pad_remove_probe (receiver->block_pad, receiver->block_id);
+    receiver->block_id = 0;
+  }
+}
+
+static gboolean
+receiver_has_seen (Receiver * receiver, guint32 seq)
+{
+  gboolean seen;
+
+  g_mutex_lock (&receiver->lock);
+  seen = g_hash_table_contains (receiver->seen, GUINT_TO_POINTER (seq));
+  g_mutex_unlock (&receiver->lock);
+
+  return seen;
+}
+
+static void
+receiver_stop (Receiver * receiver)
+{
+  receiver_unblock (receiver);
+  gst_element_set_state (receiver->pipeline, GST_STATE_NULL);
+  gst_object_unref (receiver->pipeline);
+  gst_object_unref (receiver->block_pad);
+  g_hash_table_unref (receiver->seen);
+  g_mutex_clear (&receiver->lock);
+}
+
+static void
+wait_for (gint * value, gint expected)
+{
+  gint64 deadline = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+
+  while (g_atomic_int_get (value) < expected
+      && g_get_monotonic_time () < deadline)
+    g_usleep (G_USEC_PER_SEC / 100);
+}
+
+static void
+wait_for_zero (gint * value)
+{
+  gint64 deadline = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+
+  while (g_atomic_int_get (value) > 0 && g_get_monotonic_time () < deadline)
+    g_usleep (G_USEC_PER_SEC / 100);
+}
+
+static void
+wait_for_seen (Receiver * receiver, guint32 seq)
+{
+  gint64 deadline = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+
+  while (!receiver_has_seen (receiver, seq)
+      && g_get_monotonic_time () < deadline)
+    g_usleep (G_USEC_PER_SEC / 100);
+}
+
+/* A packet starting with its big endian sequence number */
+static GstBuffer *
+packet_new (guint i)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, PACKET_SIZE, NULL);
+  guint32 seq = GUINT32_TO_BE (i);
+
+  gst_buffer_memset (buf, 0, i & 0xff, PACKET_SIZE);
+  gst_buffer_fill (buf, 0, &seq, sizeof (seq));
+
+  return buf;
+}
+
+static guint64
+get_caller_buffers_dropped (GstHarness * h)
+{
+  GstStructure *stats;
+  guint64 dropped = 0;
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "caller-buffers-dropped",
+          &dropped));
+  gst_structure_free (stats);
+
+  return dropped;
+}
+
+static guint
+get_callers (GstHarness * h)
+{
+  GstStructure *stats;
+  guint callers = 0;
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint (stats, "callers", &callers));
+  gst_structure_free (stats);
+
+  return callers;
+}
+
+#define FANOUT_N_CALLERS 3
+#define FANOUT_N_PACKETS 100
+
+GST_START_TEST (test_fanout)
+{
+  Receiver receivers[FANOUT_N_CALLERS];
+  gint n_callers = 0;
+  GstHarness *h;
+  guint port, i;
+
+  port = get_free_port ();
+  h = listener_harness_new (port, &n_callers);
+
+  for (i = 0; i < FANOUT_N_CALLERS; i++)
+    receiver_start (&receivers[i], port);
+  wait_for (&n_callers, FANOUT_N_CALLERS);
+  fail_unless_equals_int (g_atomic_int_get (&n_callers), FANOUT_N_CALLERS);
+
+  for (i = 0; i < FANOUT_N_PACKETS; i++)
+    fail_unless_equals_int (gst_harness_push (h, packet_new (i)), GST_FLOW_OK);
+
+  for (i = 0; i < FANOUT_N_CALLERS; i++) {
+    wait_for (&receivers[i].bytes, FANOUT_N_PACKETS * PACKET_SIZE);
+    fail_unless_equals_int (g_atomic_int_get (&receivers[i].bytes),
+        FANOUT_N_PACKETS * PACKET_SIZE);
+  }
+
+  for (i = 0; i < FANOUT_N_CALLERS; i++)
+    receiver_stop (&receivers[i]);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define MERGE_N_PACKETS 100
+
+/* Two senders carry the same stream, the second one keeps going alone
+ * after the first half, as if the first link went down */
+GST_START_TEST (test_redundant_merge)
+{
+  Receiver receiver;
+  gint n_callers1 = 0, n_callers2 = 0;
+  GstHarness *h1, *h2;
+  gchar *uris[2] = { NULL, NULL };
+  GstElement *src;
+  GstStructure *stats;
+  guint64 duplicates = 0;
+  guint ports[2], i;
+
+  get_free_ports (ports, 2);
+  h1 = listener_harness_new (ports[0], &n_callers1);
+  h2 = listener_harness_new (ports[1], &n_callers2);
+
+  uris[0] = g_strdup_printf ("srt://127.0.0.1:%u", ports[1]);
+  receiver_start_full (&receiver, ports[0], uris, FALSE);
+  g_free (uris[0]);
+
+  wait_for (&n_callers1, 1);
+  wait_for (&n_callers2, 1);
+  fail_unless_equals_int (g_atomic_int_get (&n_callers1), 1);
+  fail_unless_equals_int (g_atomic_int_get (&n_callers2), 1);
+
+  for (i = 0; i < MERGE_N_PACKETS; i++) {
+    if (i < MERGE_N_PACKETS / 2)
+      fail_unless_equals_int (gst_harness_push (h1, packet_new (i)),
+          GST_FLOW_OK);
+    fail_unless_equals_int (gst_harness_push (h2, packet_new (i)),
+        GST_FLOW_OK);
+  }
+
+  wait_for (&receiver.bytes, MERGE_N_PACKETS * PACKET_SIZE);
+  /* Give the late copies a chance to show up */
+  g_usleep (G_USEC_PER_SEC / 2);
+  fail_unless_equals_int (g_atomic_int_get (&receiver.bytes),
+      MERGE_N_PACKETS * PACKET_SIZE);
+
+  src = gst_bin_get_by_name (GST_BIN (receiver.pipeline), "src");
+  g_object_get (src, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "duplicates-dropped",
+          &duplicates));
+  fail_unless_equals_uint64 (duplicates, MERGE_N_PACKETS / 2);
+  gst_structure_free (stats);
+  gst_object_unref (src);
+
+  receiver_stop (&receiver);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h2);
+}
+
+GST_END_TEST;
+
+static GstStructure *
+receiver_get_stats (Receiver * receiver)
+{
+  GstElement *src;
+  GstStructure *stats;
+
+  src = gst_bin_get_by_name (GST_BIN (receiver->pipeline), "src");
+  g_object_get (src, "stats", &stats, NULL);
+  gst_object_unref (src);
+
+  return stats;
+}
+
+/* The same payload repeating in the stream is not a duplicate, only its
+ * copies on the other link are */
+GST_START_TEST (test_redundant_merge_repeated_payloads)
+{
+  Receiver receiver;
+  gint n_callers1 = 0, n_callers2 = 0;
+  GstHarness *h1, *h2;
+  gchar *uris[2] = { NULL, NULL };
+  GstStructure *stats;
+  guint64 duplicates = 0;
+  guint ports[2], i;
+
+  get_free_ports (ports, 2);
+  h1 = listener_harness_new (ports[0], &n_callers1);
+  h2 = listener_harness_new (ports[1], &n_callers2);
+
+  uris[0] = g_strdup_printf ("srt://127.0.0.1:%u", ports[1]);
+  receiver_start_full (&receiver, ports[0], uris, FALSE);
+  g_free (uris[0]);
+
+  wait_for (&n_callers1, 1);
+  wait_for (&n_callers2, 1);
+  fail_unless_equals_int (g_atomic_int_get (&n_callers1), 1);
+  fail_unless_equals_int (g_atomic_int_get (&n_callers2), 1);
+
+  /* like MPEG-TS null packets, all the same */
+  for (i = 0; i < MERGE_N_PACKETS; i++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, PACKET_SIZE, NULL);
+
+    gst_buffer_memset (buf, 0, 0xff, PACKET_SIZE);
+    fail_unless_equals_int (gst_harness_push (h1, gst_buffer_ref (buf)),
+        GST_FLOW_OK);
+    fail_unless_equals_int (gst_harness_push (h2, buf), GST_FLOW_OK);
+  }
+
+  wait_for (&receiver.bytes, MERGE_N_PACKETS * PACKET_SIZE);
+  /* Give the late copies a chance to show up */
+  g_usleep (G_USEC_PER_SEC / 2);
+  fail_unless_equals_int (g_atomic_int_get (&receiver.bytes),
+      MERGE_N_PACKETS * PACKET_SIZE);
+
+  stats = receiver_get_stats (&receiver);
+  fail_unless (gst_structure_get_uint64 (stats, "duplicates-dropped",
+          &duplicates));
+  fail_unless_equals_uint64 (duplicates, MERGE_N_PACKETS);
+  gst_structure_free (stats);
+
+  receiver_stop (&receiver);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h2);
+}
+
+GST_END_TEST;
+
+static guint
+receiver_get_links (Receiver * receiver)
+{
+  GstStructure *stats;
+  guint links = 0;
+
+  stats = receiver_get_stats (receiver);
+  fail_unless (gst_structure_get_uint (stats, "links", &links));
+  gst_structure_free (stats);
+
+  return links;
+}
+
+/* A redundant link whose sender isn't up yet is connected once it is */
+GST_START_TEST (test_redundant_reconnect)
+{
+  Receiver receiver;
+  gint n_callers1 = 0, n_callers2 = 0;
+  GstHarness *h1, *h2;
+  gchar *uris[2] = { NULL, NULL };
+  gint64 deadline;
+  guint ports[2], i;
+
+  get_free_ports (ports, 2);
+  h1 = listener_harness_new (ports[0], &n_callers1);
+
+  uris[0] = g_strdup_printf ("srt://127.0.0.1:%u", ports[1]);
+  receiver_start_full (&receiver, ports[0], uris, FALSE);
+  g_free (uris[0]);
+
+  wait_for (&n_callers1, 1);
+  fail_unless_equals_int (g_atomic_int_get (&n_callers1), 1);
+  fail_unless_equals_int (receiver_get_links (&receiver), 1);
+
+  /* the pending connection times out after 3 s and is retried */
+  h2 = listener_harness_new (ports[1], &n_callers2);
+  deadline = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+  while (receiver_get_links (&receiver) < 2
+      && g_get_monotonic_time () < deadline)
+    g_usleep (G_USEC_PER_SEC / 100);
+  fail_unless_equals_int (receiver_get_links (&receiver), 2);
+  wait_for (&n_callers2, 1);
+
+  /* and the stream comes through it alone */
+  for (i = 0; i < MERGE_N_PACKETS; i++)
+    fail_unless_equals_int (gst_harness_push (h2, packet_new (i)),
+        GST_FLOW_OK);
+  wait_for (&receiver.bytes, MERGE_N_PACKETS * PACKET_SIZE);
+  fail_unless_equals_int (g_atomic_int_get (&receiver.bytes),
+      MERGE_N_PACKETS * PACKET_SIZE);
+
+  receiver_stop (&receiver);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h2);
+}
+
+GST_END_TEST;
+
+/* Enough to fill the SRT receive and send buffers of a caller that doesn't
+ * read, with the default sizes */
+#define SLOW_CALLER_MAX_PACKETS 100000
+#define SLOW_CALLER_QUEUE_SIZE 8
+
+/* A listener with caller-queue-size and @policy, and a connected caller
+ * that doesn't read anything */
+static GstHarness *
+slow_caller_setup (Receiver * receiver, const gchar * policy,
+    gint * n_callers)
+{
+  GstHarness *h;
+  guint port;
+
+  port = get_free_port ();
+  h = listener_harness_new (port, n_callers);
+  g_object_set (h->element, "caller-queue-size", SLOW_CALLER_QUEUE_SIZE,
+      NULL);
+  gst_util_set_object_arg (G_OBJECT (h->element), "caller-drop-policy",
+      policy);
+
+  receiver_start_full (receiver, port, NULL, TRUE);
+  wait_for (n_callers, 1);
+  fail_unless_equals_int (g_atomic_int_get (n_callers), 1);
+
+  return h;
+}
+
+/* Pushes packets until the queue of the slow caller overflowed, and returns
+ * the sequence number of the packet whose push made it overflow */
+static guint
+push_until_dropped (GstHarness * h)
+{
+  guint i;
+
+  for (i = 0; i < SLOW_CALLER_MAX_PACKETS; i++) {
+    fail_unless_equals_int (gst_harness_push (h, packet_new (i)), GST_FLOW_OK);
+    if (get_caller_buffers_dropped (h) > 0)
+      return i;
+  }
+
+  fail ("caller queue never overflowed");
+  return 0;
+}
+
+/* The packet that doesn't fit into the full queue is dropped, the ones
+ * queued before are sent once the caller reads again */
+GST_START_TEST (test_caller_drop_newest)
+{
+  Receiver receiver;
+  gint n_callers = 0;
+  GstHarness *h;
+  guint overflow;
+
+  h = slow_caller_setup (&receiver, "drop-newest", &n_callers);
+
+  overflow = push_until_dropped (h);
+  fail_unless_equals_uint64 (get_caller_buffers_dropped (h), 1);
+  fail_unless (overflow >= SLOW_CALLER_QUEUE_SIZE);
+
+  receiver_unblock (&receiver);
+  wait_for_seen (&receiver, overflow - 1);
+  fail_unless (receiver_has_seen (&receiver, overflow - 1));
+  fail_if (receiver_has_seen (&receiver, overflow));
+
+  receiver_stop (&receiver);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* The oldest queued packet makes room for the new one */
+GST_START_TEST (test_caller_drop_oldest)
+{
+  Receiver receiver;
+  gint n_callers = 0;
+  GstHarness *h;
+  guint overflow;
+
+  h = slow_caller_setup (&receiver, "drop-oldest", &n_callers);
+
+  overflow = push_until_dropped (h);
+  fail_unless_equals_uint64 (get_caller_buffers_dropped (h), 1);
+  fail_unless (overflow >= SLOW_CALLER_QUEUE_SIZE);
+
+  receiver_unblock (&receiver);
+  wait_for_seen (&receiver, overflow);
+  fail_unless (receiver_has_seen (&receiver, overflow));
+
+  receiver_stop (&receiver);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* The slow caller is disconnected instead, and nothing is dropped */
+GST_START_TEST (test_caller_disconnect)
+{
+  Receiver receiver;
+  gint n_callers = 0;
+  GstHarness *h;
+  guint i;
+
+  h = slow_caller_setup (&receiver, "disconnect", &n_callers);
+
+  /* with no caller left, srtsink would wait for the next one */
+  for (i = 0; i < SLOW_CALLER_MAX_PACKETS && get_callers (h) > 0; i++)
+    fail_unless_equals_int (gst_harness_push (h, packet_new (i)), GST_FLOW_OK);
+  fail_unless_equals_int (get_callers (h), 0);
+
+  /* the sender thread disconnects it asynchronously */
+  wait_for_zero (&n_callers);
+
+  fail_unless_equals_int (g_atomic_int_get (&n_callers), 0);
+  fail_unless_equals_uint64 (get_caller_buffers_dropped (h), 0);
+
+  receiver_stop (&receiver);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define BENCH_N_PACKETS 5000
+
+/* Pushes packets into a listening srtsink with n_callers local srtsrc
+ * connected, reporting how long the streaming thread was blocked and how
+ * much CPU the whole fan-out took until every caller got the data */
+static void
+bench_fanout (guint n_callers)
+{
+  Receiver *receivers = g_new0 (Receiver, n_callers);
+  gint64 start, pushed, end, cpu_start, cpu_end;
+  gint connected = 0;
+  GstHarness *h;
+  guint port, i;
+
+  port = get_free_port ();
+  h = listener_harness_new (port, &connected);
+  g_object_set (h->element, "caller-queue-size", 0, NULL);
+
+  for (i = 0; i < n_callers; i++)
+    receiver_start (&receivers[i], port);
+  wait_for (&connected, n_callers);
+  fail_unless_equals_int (g_atomic_int_get (&connected), n_callers);
+
+  start = g_get_monotonic_time ();
+  cpu_start = benchmark_cpu_time ();
+  for (i = 0; i < BENCH_N_PACKETS; i++)
+    fail_unless_equals_int (gst_harness_push (h, packet_new (i)), GST_FLOW_OK);
+  pushed = g_get_monotonic_time ();
+
+  for (i = 0; i < n_callers; i++)
+    wait_for (&receivers[i].bytes, BENCH_N_PACKETS * PACKET_SIZE);
+  end = g_get_monotonic_time ();
+  cpu_end = benchmark_cpu_time ();
+
+  GST_INFO ("%u callers: pushed %u packets in %" G_GINT64_FORMAT " us, "
+      "all received after %" G_GINT64_FORMAT " us (%.1f Mbit/s per caller), "
+      "%" G_GINT64_FORMAT " us CPU", n_callers, BENCH_N_PACKETS,
+      pushed - start, end - start,
+      BENCH_N_PACKETS * PACKET_SIZE * 8.0 / MAX (end - start, 1),
+      cpu_end - cpu_start);
+
+  for (i = 0; i < n_callers; i++) {
+    GST_INFO ("caller %u received %d bytes", i, receivers[i].bytes);
+    receiver_stop (&receivers[i]);
+  }
+  gst_harness_teardown (h);
+  g_free (receivers);
+}
+
+GST_START_TEST (test_bench_fanout)
+{
+  bench_fanout (1);
+  bench_fanout (4);
+  bench_fanout (16);
+}
+
+GST_END_TEST;
+
+static Suite *
+srt_suite (void)
+{
+  Suite *s = suite_create ("srt");
+  TCase *tc_chain = tcase_create ("general");
+  TCase *tc_bench;
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_create_and_unref);
+  tcase_add_test (tc_chain, test_fanout);
+  tcase_add_test (tc_chain, test_redundant_merge);
+  tcase_add_test (tc_chain, test_redundant_merge_repeated_payloads);
+  tcase_add_test (tc_chain, test_redundant_reconnect);
+  tcase_add_test (tc_chain, test_caller_drop_newest);
+  tcase_add_test (tc_chain, test_caller_drop_oldest);
+  tcase_add_test (tc_chain, test_caller_disconnect);
+
+  if ((tc_bench = benchmark_tcase_new (s, 120)))
+    tcase_add_test (tc_bench, test_bench_fanout);
+
+  return s;
+}
+
+GST_CHECK_MAIN (srt);
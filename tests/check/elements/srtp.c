@@ -31,6 +31,8 @@
 
 #include <gst/check/gstharness.h>
 
+#include "benchmark.h"
+
 GST_START_TEST (test_create_and_unref)
 {
   GstElement *e;
@@ -341,11 +343,208 @@ GST_END_TEST;
 
 #endif
 
+#define LIST_KEY "012345678901234567890123456789012345678901234567890123456789"
+#define LIST_SSRC 1356955624U
+#define LIST_PAYLOAD_SIZE 160
+#define LIST_CAPS_RTP "application/x-rtp, payload=(int)8, ssrc=(uint)1356955624"
+
+/* srtpenc ! srtpdec in a bin with static "sink" and "src" ghost pads */
+static GstHarness *
+roundtrip_harness_new (void)
+{
+  GstElement *bin, *enc, *dec;
+  GstPad *pad;
+
+  bin = gst_bin_new (NULL);
+  enc = gst_element_factory_make ("srtpenc", NULL);
+  dec = gst_element_factory_make ("srtpdec", NULL);
+  fail_unless (enc != NULL && dec != NULL);
+  gst_util_set_object_arg (G_OBJECT (enc), "key", LIST_KEY);
+  gst_bin_add_many (GST_BIN (bin), enc, dec, NULL);
+
+  pad = gst_element_get_request_pad (enc, "rtp_sink_0");
+  fail_unless (pad != NULL);
+  gst_element_add_pad (bin, gst_ghost_pad_new ("sink", pad));
+  gst_object_unref (pad);
+
+  fail_unless (gst_element_link_pads (enc, "rtp_src_0", dec, "rtp_sink"));
+
+  pad = gst_element_get_static_pad (dec, "rtp_src");
+  gst_element_add_pad (bin, gst_ghost_pad_new ("src", pad));
+  gst_object_unref (pad);
+
+  return gst_harness_new_with_element (bin, "sink", "src");
+}
+
+/* RTP packet with enough padding after it to be protected in place, if
+ * @tailroom is set */
+static GstBuffer *
+list_rtp_buffer_new (guint16 seq, gboolean tailroom)
+{
+  GstAllocationParams params;
+  GstBuffer *buf;
+  GstMapInfo map;
+
+  gst_allocation_params_init (&params);
+  if (tailroom)
+    params.padding = 64;
+
+  buf = gst_buffer_new_allocate (NULL, 12 + LIST_PAYLOAD_SIZE, &params);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, seq & 0xff, map.size);
+  map.data[0] = 0x80;
+  map.data[1] = 8;
+  GST_WRITE_UINT16_BE (map.data + 2, seq);
+  GST_WRITE_UINT32_BE (map.data + 4, seq * 160);
+  GST_WRITE_UINT32_BE (map.data + 8, LIST_SSRC);
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static gpointer
+buffer_data_ptr (GstBuffer * buf)
+{
+  GstMapInfo map;
+  gpointer data;
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  data = map.data;
+  gst_buffer_unmap (buf, &map);
+
+  return data;
+}
+
+GST_START_TEST (test_buffer_list_in_place)
+{
+  GstHarness *h = roundtrip_harness_new ();
+  GstBufferList *list;
+  GstBuffer *buf, *ref;
+  gpointer data[8];
+  guint i;
+
+  gst_harness_set_src_caps_str (h, LIST_CAPS_RTP);
+
+  /* buffers with tailroom go through both elements without being copied,
+   * the others still make it through */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (data); i++) {
+    buf = list_rtp_buffer_new (i, i % 2 == 0);
+    data[i] = buffer_data_ptr (buf);
+    gst_buffer_list_add (list, buf);
+  }
+  fail_unless_equals_int (gst_pad_push_list (h->srcpad, list), GST_FLOW_OK);
+
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h),
+      G_N_ELEMENTS (data));
+  for (i = 0; i < G_N_ELEMENTS (data); i++) {
+    buf = gst_harness_pull (h);
+    ref = list_rtp_buffer_new (i, FALSE);
+    fail_unless_equals_int (gst_buffer_get_size (buf),
+        gst_buffer_get_size (ref));
+    fail_unless (gst_buffer_memcmp (buf, 0, buffer_data_ptr (ref),
+            gst_buffer_get_size (ref)) == 0);
+    if (i % 2 == 0)
+      fail_unless (buffer_data_ptr (buf) == data[i]);
+    gst_buffer_unref (ref);
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_allocation_tailroom)
+{
+  GstHarness *h = roundtrip_harness_new ();
+  GstAllocationParams params;
+  GstQuery *query;
+  GstCaps *caps;
+
+  gst_harness_set_src_caps_str (h, LIST_CAPS_RTP);
+
+  caps = gst_caps_from_string (LIST_CAPS_RTP);
+  query = gst_query_new_allocation (caps, TRUE);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_pad_peer_query (h->srcpad, query));
+  fail_unless (gst_query_get_n_allocation_params (query) > 0);
+  gst_query_parse_nth_allocation_param (query, 0, NULL, &params);
+  fail_unless (params.padding > 0);
+  gst_query_unref (query);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define BENCH_RATE 10000
+#define BENCH_LIST_SIZE 10
+
+/* One second worth of packets of a 10k packets/s stream, pushed as fast as
+ * possible through srtpenc ! srtpdec, either one by one or as lists of 1ms
+ * worth of packets, reporting how much of a CPU such a stream needs */
+static void
+bench_run (gboolean use_lists, gboolean tailroom)
+{
+  GstHarness *h = roundtrip_harness_new ();
+  GstBufferList *list = NULL;
+  gint64 start, end, cpu_start, cpu_end;
+  guint i;
+
+  gst_harness_set_src_caps_str (h, LIST_CAPS_RTP);
+  gst_harness_set_drop_buffers (h, TRUE);
+
+  cpu_start = benchmark_cpu_time ();
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCH_RATE; i++) {
+    GstBuffer *buf = list_rtp_buffer_new (i, tailroom);
+
+    if (!use_lists) {
+      fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+      continue;
+    }
+
+    if (!list)
+      list = gst_buffer_list_new_sized (BENCH_LIST_SIZE);
+    gst_buffer_list_add (list, buf);
+    if (gst_buffer_list_length (list) == BENCH_LIST_SIZE) {
+      fail_unless_equals_int (gst_pad_push_list (h->srcpad, list),
+          GST_FLOW_OK);
+      list = NULL;
+    }
+  }
+  end = g_get_monotonic_time ();
+  cpu_end = benchmark_cpu_time ();
+
+  GST_INFO ("%s%s: %u packets in %" G_GINT64_FORMAT " us, %.0f packets/s, "
+      "%.1f%% CPU at %u packets/s", use_lists ? "lists" : "buffers",
+      tailroom ? " with tailroom" : "", BENCH_RATE, end - start,
+      BENCH_RATE * (gdouble) G_USEC_PER_SEC / MAX (end - start, 1),
+      (cpu_end - cpu_start) * 100.0 / G_USEC_PER_SEC, BENCH_RATE);
+
+  if (list)
+    gst_buffer_list_unref (list);
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_bench_buffer_list)
+{
+  bench_run (FALSE, FALSE);
+  bench_run (FALSE, TRUE);
+  bench_run (TRUE, FALSE);
+  bench_run (TRUE, TRUE);
+}
+
+GST_END_TEST;
+
 static Suite *
 srtp_suite (void)
 {
   Suite *s = suite_create ("srtp");
   TCase *tc_chain = tcase_create ("general");
+  TCase *tc_bench;
 
   suite_add_tcase (s, tc_chain);
   tcase_set_timeout (tc_chain, 180);
@@ -356,6 +555,11 @@ srtp_suite (void)
   tcase_add_test (tc_chain, test_simple_mki);
   tcase_add_test (tc_chain, test_srtpdec_multiple_mki);
 #endif
+  tcase_add_test (tc_chain, test_buffer_list_in_place);
+  tcase_add_test (tc_chain, test_allocation_tailroom);
+
+  if ((tc_bench = benchmark_tcase_new (s, 60)))
+    tcase_add_test (tc_bench, test_bench_buffer_list);
 
   return s;
 }
@@ -33,6 +33,7 @@
 #include "../../../ext/webrtc/webrtcsdp.c"
 #include "../../../ext/webrtc/utils.h"
 #include "../../../ext/webrtc/utils.c"
+#include "benchmark.h"
 
 #define OPUS_RTP_CAPS(pt) "application/x-rtp,payload=" G_STRINGIFY(pt) ",encoding-name=OPUS,media=audio,clock-rate=48000,ssrc=(uint)3384078950"
 #define VP8_RTP_CAPS(pt) "application/x-rtp,payload=" G_STRINGIFY(pt) ",encoding-name=VP8,media=video,clock-rate=90000,ssrc=(uint)3484078950"
@@ -1342,6 +1343,100 @@ GST_START_TEST (test_session_stats)
 
 GST_END_TEST;
 
+static void
+_bus_stats_message (struct test_webrtc *t, GstBus * bus, GstMessage * msg,
+    gpointer user_data)
+{
+  _bus_no_errors (t, bus, msg, user_data);
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ELEMENT
+      && GST_MESSAGE_SRC (msg) == GST_OBJECT (t->webrtc1)
+      && gst_message_has_name (msg, "application/x-webrtc-stats")) {
+    validate_stats (gst_message_get_structure (msg));
+    test_webrtc_signal_state_unlocked (t, STATE_CUSTOM);
+  }
+}
+
+GST_START_TEST (test_session_stats_interval)
+{
+  struct test_webrtc *t = create_audio_test ();
+
+  /* test that stats are periodically posted on the bus */
+
+  t->on_offer_created = NULL;
+  t->on_answer_created = NULL;
+  t->bus_message = _bus_stats_message;
+  g_object_set (t->webrtc1, "stats-interval", 10 * GST_MSECOND,
+      "stats-cache-time", GST_SECOND, NULL);
+
+  fail_if (gst_element_set_state (t->webrtc1,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (t->webrtc2,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+
+  test_webrtc_create_offer (t, t->webrtc1);
+
+  test_webrtc_wait_for_state_mask (t, 1 << STATE_CUSTOM);
+
+  test_webrtc_free (t);
+}
+
+GST_END_TEST;
+
+static void
+check_stats_posted (GstBus * bus, GstElement * webrtc)
+{
+  GstMessage *msg;
+
+  msg = gst_bus_timed_pop_filtered (bus, GST_SECOND, GST_MESSAGE_ELEMENT);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT (webrtc));
+  gst_message_unref (msg);
+}
+
+/* The stats timer only runs while the peerconnection thread does, and it
+ * never keeps webrtcbin alive */
+GST_START_TEST (test_session_stats_interval_states)
+{
+  GstElement *webrtc = gst_element_factory_make ("webrtcbin", NULL);
+  GstBus *bus = gst_bus_new ();
+  gpointer weak = webrtc;
+
+  g_object_add_weak_pointer (G_OBJECT (webrtc), &weak);
+  gst_element_set_bus (webrtc, bus);
+
+  /* set in NULL, armed in READY */
+  g_object_set (webrtc, "stats-interval", 10 * GST_MSECOND, NULL);
+  fail_unless (gst_bus_pop (bus) == NULL);
+  fail_if (gst_element_set_state (webrtc,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  check_stats_posted (bus, webrtc);
+
+  /* and again after going through NULL */
+  fail_if (gst_element_set_state (webrtc,
+          GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE);
+  gst_bus_set_flushing (bus, TRUE);
+  gst_bus_set_flushing (bus, FALSE);
+  fail_if (gst_element_set_state (webrtc,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  check_stats_posted (bus, webrtc);
+
+  /* changed while running */
+  g_object_set (webrtc, "stats-interval", 20 * GST_MSECOND, NULL);
+  check_stats_posted (bus, webrtc);
+
+  fail_if (gst_element_set_state (webrtc,
+          GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE);
+  g_object_set (webrtc, "stats-interval", 10 * GST_MSECOND, NULL);
+  gst_object_unref (webrtc);
+  fail_unless (weak == NULL);
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_object_unref (bus);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_add_transceiver)
 {
   struct test_webrtc *t = test_webrtc_new ();
@@ -2336,11 +2431,487 @@ GST_START_TEST (test_bundle_audio_video_data)
 
 GST_END_TEST;
 
+/* Loopback benchmark: pairs of webrtcbin connected with ICE over the
+ * loopback interface, DTLS-SRTP and a data channel. Results are logged with
+ * GST_INFO, nothing is checked apart from the data channel being reliable */
+#define BENCH_MAX_PEERS 4
+#define BENCH_N_PACKETS 2000
+#define BENCH_PAYLOAD_SIZE 160
+#define BENCH_SSRC 3384078950U
+#define BENCH_MESSAGE_SIZE 16384
+#define BENCH_N_MESSAGES 64
+#define BENCH_TIMEOUT (30 * G_TIME_SPAN_SECOND)
+
+struct bench_peer
+{
+  struct test_webrtc *t;
+  GstHarness *h;
+  GObject *channel;
+  gint64 start_time;
+  gint64 setup_time;
+  guint16 seq;
+  guint media_received;
+  guint64 data_received;
+};
+
+static GMutex bench_lock;
+static GCond bench_cond;
+
+static GstBuffer *
+bench_rtp_buffer_new (struct bench_peer *peer)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint16 seq = peer->seq++;
+
+  buf = gst_buffer_new_allocate (NULL, 12 + BENCH_PAYLOAD_SIZE, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+  map.data[0] = 0x80;
+  map.data[1] = 96;
+  GST_WRITE_UINT16_BE (map.data + 2, seq);
+  GST_WRITE_UINT32_BE (map.data + 4, seq * 960);
+  GST_WRITE_UINT32_BE (map.data + 8, BENCH_SSRC);
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static GstPadProbeReturn
+bench_count_media (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  struct bench_peer *peer = user_data;
+  guint n = 1;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    n = gst_buffer_list_length (GST_PAD_PROBE_INFO_BUFFER_LIST (info));
+
+  g_mutex_lock (&bench_lock);
+  peer->media_received += n;
+  g_cond_broadcast (&bench_cond);
+  g_mutex_unlock (&bench_lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+bench_pad_added (struct test_webrtc *t, GstElement * element, GstPad * pad,
+    gpointer user_data)
+{
+  if (GST_PAD_DIRECTION (pad) != GST_PAD_SRC)
+    return;
+
+  gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      bench_count_media, user_data, NULL);
+  _pad_added_fakesink (t, element, pad, NULL);
+}
+
+static void
+bench_on_message_data (GObject * channel, GBytes * data,
+    struct bench_peer *peer)
+{
+  g_mutex_lock (&bench_lock);
+  peer->data_received += g_bytes_get_size (data);
+  g_cond_broadcast (&bench_cond);
+  g_mutex_unlock (&bench_lock);
+}
+
+static void
+bench_have_data_channel (struct test_webrtc *t, GstElement * element,
+    GObject * our, gpointer user_data)
+{
+  struct bench_peer *peer = user_data;
+
+  g_signal_connect (our, "on-message-data",
+      G_CALLBACK (bench_on_message_data), peer);
+
+  g_mutex_lock (&bench_lock);
+  peer->setup_time = g_get_monotonic_time () - peer->start_time;
+  g_cond_broadcast (&bench_cond);
+  g_mutex_unlock (&bench_lock);
+}
+
+static struct bench_peer *
+bench_peer_new (gboolean shared_threads)
+{
+  struct bench_peer *peer = g_new0 (struct bench_peer, 1);
+  struct test_webrtc *t = test_webrtc_new ();
+  GstCaps *caps;
+
+  peer->t = t;
+  peer->setup_time = -1;
+
+  gst_util_set_object_arg (G_OBJECT (t->webrtc1), "bundle-policy",
+      "max-bundle");
+  gst_util_set_object_arg (G_OBJECT (t->webrtc2), "bundle-policy",
+      "max-bundle");
+  g_object_set (t->webrtc1, "shared-threads", shared_threads, NULL);
+  g_object_set (t->webrtc2, "shared-threads", shared_threads, NULL);
+
+  t->on_negotiation_needed = NULL;
+  t->on_offer_created = NULL;
+  t->on_answer_created = NULL;
+  t->on_ice_candidate = NULL;
+  t->on_pad_added = bench_pad_added;
+  t->pad_added_data = peer;
+  t->on_data_channel = bench_have_data_channel;
+  t->data_channel_data = peer;
+
+  peer->h = gst_harness_new_with_element (t->webrtc1, "sink_0", NULL);
+  caps = gst_caps_from_string (OPUS_RTP_CAPS (96));
+  gst_harness_set_src_caps (peer->h, caps);
+  t->harnesses = g_list_prepend (t->harnesses, peer->h);
+
+  fail_if (gst_element_set_state (t->webrtc1,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (t->webrtc2,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+
+  g_signal_emit_by_name (t->webrtc1, "create-data-channel", "bench", NULL,
+      &peer->channel);
+  g_assert_nonnull (peer->channel);
+  g_signal_connect (peer->channel, "on-error",
+      G_CALLBACK (on_channel_error_not_reached), NULL);
+
+  fail_if (gst_element_set_state (t->webrtc1,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (t->webrtc2,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+
+  peer->start_time = g_get_monotonic_time ();
+  test_webrtc_create_offer (t, t->webrtc1);
+
+  return peer;
+}
+
+static void
+bench_peer_free (struct bench_peer *peer)
+{
+  g_signal_handlers_disconnect_by_data (peer->channel, NULL);
+  g_object_unref (peer->channel);
+  test_webrtc_free (peer->t);
+  g_free (peer);
+}
+
+static guint
+count_threads (void)
+{
+  guint n_threads = 0;
+#ifdef G_OS_UNIX
+  GDir *dir;
+
+  if ((dir = g_dir_open ("/proc/self/task", 0, NULL))) {
+    while (g_dir_read_name (dir))
+      n_threads++;
+    g_dir_close (dir);
+  }
+#endif
+  return n_threads;
+}
+
+static gboolean
+bench_wait_setup (struct bench_peer **peers, guint n_peers)
+{
+  gint64 deadline = g_get_monotonic_time () + BENCH_TIMEOUT;
+  guint i, n_done;
+
+  g_mutex_lock (&bench_lock);
+  do {
+    for (i = 0, n_done = 0; i < n_peers; i++)
+      if (peers[i]->setup_time >= 0)
+        n_done++;
+  } while (n_done < n_peers
+      && g_cond_wait_until (&bench_cond, &bench_lock, deadline));
+  g_mutex_unlock (&bench_lock);
+
+  return n_done == n_peers;
+}
+
+static void
+bench_run (guint n_peers)
+{
+  struct bench_peer *peers[BENCH_MAX_PEERS];
+  guint8 *message_data;
+  GBytes *message;
+  gint64 start, end, cpu_start, cpu_end, deadline, setup_total = 0;
+  gint64 setup_max = 0;
+  guint64 media_total = 0, data_total;
+  guint i, j;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < n_peers; i++)
+    peers[i] = bench_peer_new (FALSE);
+
+  /* Setup: ICE, DTLS and SCTP are done once the remote sees the channel */
+  fail_unless (bench_wait_setup (peers, n_peers));
+  end = g_get_monotonic_time ();
+
+  for (i = 0; i < n_peers; i++) {
+    setup_total += peers[i]->setup_time;
+    setup_max = MAX (setup_max, peers[i]->setup_time);
+  }
+  GST_INFO ("%u peers: setup %" G_GINT64_FORMAT " us average, %"
+      G_GINT64_FORMAT " us max, %" G_GINT64_FORMAT " us for all", n_peers,
+      setup_total / n_peers, setup_max, end - start);
+
+  /* Wait until media flows on all peers */
+  deadline = g_get_monotonic_time () + BENCH_TIMEOUT;
+  for (i = 0; i < n_peers; i++) {
+    while (g_get_monotonic_time () < deadline) {
+      guint received;
+
+      gst_harness_push (peers[i]->h, bench_rtp_buffer_new (peers[i]));
+      g_mutex_lock (&bench_lock);
+      received = peers[i]->media_received;
+      g_mutex_unlock (&bench_lock);
+      if (received > 0)
+        break;
+      g_usleep (10000);
+    }
+  }
+
+  /* Media: RTP packets through rtpbin, SRTP, DTLS and nice */
+  g_mutex_lock (&bench_lock);
+  for (i = 0; i < n_peers; i++)
+    peers[i]->media_received = 0;
+  g_mutex_unlock (&bench_lock);
+
+  cpu_start = benchmark_cpu_time ();
+  start = g_get_monotonic_time ();
+  for (j = 0; j < BENCH_N_PACKETS; j++)
+    for (i = 0; i < n_peers; i++)
+      gst_harness_push (peers[i]->h, bench_rtp_buffer_new (peers[i]));
+
+  /* UDP may drop packets, so don't wait for all of them forever */
+  deadline = g_get_monotonic_time () + G_TIME_SPAN_SECOND;
+  g_mutex_lock (&bench_lock);
+  do {
+    for (i = 0, media_total = 0; i < n_peers; i++)
+      media_total += peers[i]->media_received;
+  } while (media_total < n_peers * BENCH_N_PACKETS
+      && g_cond_wait_until (&bench_cond, &bench_lock, deadline));
+  g_mutex_unlock (&bench_lock);
+  end = g_get_monotonic_time ();
+  cpu_end = benchmark_cpu_time ();
+
+  GST_INFO ("%u peers: received %" G_GUINT64_FORMAT " of %u RTP packets in %"
+      G_GINT64_FORMAT " us, %.0f packets/s per stream, %.1f%% CPU per "
+      "stream", n_peers, media_total, n_peers * BENCH_N_PACKETS, end - start,
+      media_total * (gdouble) G_USEC_PER_SEC / MAX (end - start, 1) / n_peers,
+      (cpu_end - cpu_start) * 100.0 / MAX (end - start, 1) / n_peers);
+
+  /* Data channel: SCTP over DTLS */
+  message_data = g_malloc0 (BENCH_MESSAGE_SIZE);
+  message = g_bytes_new_take (message_data, BENCH_MESSAGE_SIZE);
+  data_total = (guint64) n_peers * BENCH_N_MESSAGES * BENCH_MESSAGE_SIZE;
+
+  cpu_start = benchmark_cpu_time ();
+  start = g_get_monotonic_time ();
+  for (j = 0; j < BENCH_N_MESSAGES; j++)
+    for (i = 0; i < n_peers; i++)
+      g_signal_emit_by_name (peers[i]->channel, "send-data", message);
+
+  deadline = g_get_monotonic_time () + BENCH_TIMEOUT;
+  g_mutex_lock (&bench_lock);
+  do {
+    guint64 received = 0;
+
+    for (i = 0; i < n_peers; i++)
+      received += peers[i]->data_received;
+    if (received >= data_total)
+      break;
+  } while (g_cond_wait_until (&bench_cond, &bench_lock, deadline));
+  for (i = 0; i < n_peers; i++)
+    fail_unless_equals_uint64 (peers[i]->data_received,
+        (guint64) BENCH_N_MESSAGES * BENCH_MESSAGE_SIZE);
+  g_mutex_unlock (&bench_lock);
+  end = g_get_monotonic_time ();
+  cpu_end = benchmark_cpu_time ();
+
+  GST_INFO ("%u peers: %" G_GUINT64_FORMAT " data channel bytes in %"
+      G_GINT64_FORMAT " us, %.2f MB/s per channel, %.1f%% CPU per channel",
+      n_peers, data_total, end - start,
+      data_total / (gdouble) MAX (end - start, 1) / n_peers,
+      (cpu_end - cpu_start) * 100.0 / MAX (end - start, 1) / n_peers);
+
+  g_bytes_unref (message);
+  for (i = 0; i < n_peers; i++)
+    bench_peer_free (peers[i]);
+}
+
+GST_START_TEST (test_bench_loopback)
+{
+  guint n_peers;
+
+  for (n_peers = 1; n_peers <= BENCH_MAX_PEERS; n_peers *= 2)
+    bench_run (n_peers);
+}
+
+GST_END_TEST;
+
+#define BENCH_N_GET_STATS 1000
+
+static gint64
+bench_get_stats (GstElement * webrtc)
+{
+  gint64 start = g_get_monotonic_time ();
+  guint i;
+
+  for (i = 0; i < BENCH_N_GET_STATS; i++) {
+    GstPromise *p = gst_promise_new ();
+
+    g_signal_emit_by_name (webrtc, "get-stats", NULL, p);
+    fail_unless_equals_int (gst_promise_wait (p), GST_PROMISE_RESULT_REPLIED);
+    gst_promise_unref (p);
+  }
+
+  return g_get_monotonic_time () - start;
+}
+
+GST_START_TEST (test_bench_get_stats)
+{
+  struct test_webrtc *t = create_audio_test ();
+  gint64 full, cached;
+
+  t->on_offer_created = NULL;
+  t->on_answer_created = NULL;
+
+  fail_if (gst_element_set_state (t->webrtc1,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (t->webrtc2,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+
+  test_webrtc_create_offer (t, t->webrtc1);
+  test_webrtc_wait_for_answer_error_eos (t);
+  fail_unless_equals_int (STATE_ANSWER_CREATED, t->state);
+
+  full = bench_get_stats (t->webrtc1);
+  g_object_set (t->webrtc1, "stats-cache-time", G_MAXUINT64, NULL);
+  cached = bench_get_stats (t->webrtc1);
+
+  GST_INFO ("get-stats: %.2f us per call with full updates, %.2f us with "
+      "cached snapshots", full / (gdouble) BENCH_N_GET_STATS,
+      cached / (gdouble) BENCH_N_GET_STATS);
+
+  test_webrtc_free (t);
+}
+
+GST_END_TEST;
+
+#define BENCH_MAX_SCALING_PEERS 16
+
+static void
+bench_scaling_run (guint n_peers, gboolean shared_threads)
+{
+  struct bench_peer *peers[BENCH_MAX_SCALING_PEERS];
+  gint64 start, end, cpu_start, cpu_end;
+  guint i, n_threads_start, n_threads;
+
+  n_threads_start = count_threads ();
+  cpu_start = benchmark_cpu_time ();
+  start = g_get_monotonic_time ();
+  for (i = 0; i < n_peers; i++)
+    peers[i] = bench_peer_new (shared_threads);
+  fail_unless (bench_wait_setup (peers, n_peers));
+  end = g_get_monotonic_time ();
+  cpu_end = benchmark_cpu_time ();
+  n_threads = count_threads () - n_threads_start;
+
+  GST_INFO ("%u peers, %s threads: %u new threads (%.1f per webrtcbin), "
+      "setup took %" G_GINT64_FORMAT " us and %" G_GINT64_FORMAT " us CPU",
+      n_peers, shared_threads ? "shared" : "dedicated", n_threads,
+      n_threads / (gdouble) (2 * n_peers), end - start, cpu_end - cpu_start);
+
+  for (i = 0; i < n_peers; i++)
+    bench_peer_free (peers[i]);
+}
+
+GST_START_TEST (test_bench_shared_threads)
+{
+  guint n_peers;
+
+  for (n_peers = 1; n_peers <= BENCH_MAX_SCALING_PEERS; n_peers *= 2) {
+    bench_scaling_run (n_peers, FALSE);
+    bench_scaling_run (n_peers, TRUE);
+  }
+}
+
+GST_END_TEST;
+
+/* Threads of stopped main loops exit on their own, wait for them to be
+ * gone */
+static guint
+count_settled_threads (void)
+{
+  guint n_threads, prev;
+
+  n_threads = count_threads ();
+  do {
+    prev = n_threads;
+    g_usleep (50 * 1000);
+    n_threads = count_threads ();
+  } while (n_threads != prev);
+
+  return n_threads;
+}
+
+/* The number of threads started by @n_bins webrtcbins in READY */
+static gint
+count_webrtcbin_threads (guint n_bins, gboolean shared_threads)
+{
+  GstElement **bins = g_new0 (GstElement *, n_bins);
+  guint i, n_start;
+  gint n_threads;
+
+  n_start = count_settled_threads ();
+  for (i = 0; i < n_bins; i++) {
+    bins[i] = gst_element_factory_make ("webrtcbin", NULL);
+    g_object_set (bins[i], "shared-threads", shared_threads, NULL);
+    fail_if (gst_element_set_state (bins[i],
+            GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  }
+  n_threads = (gint) count_settled_threads () - (gint) n_start;
+
+  for (i = 0; i < n_bins; i++) {
+    gst_element_set_state (bins[i], GST_STATE_NULL);
+    gst_object_unref (bins[i]);
+  }
+  g_free (bins);
+
+  return n_threads;
+}
+
+/* With shared-threads the peerconnection and ICE threads come from pools
+ * of one thread per CPU, instead of two threads per webrtcbin */
+GST_START_TEST (test_shared_threads)
+{
+  guint n_cpus = g_get_num_processors ();
+  guint n_bins = n_cpus + 2;
+  gint shared, dedicated;
+
+  if (count_threads () == 0) {
+    GST_INFO ("can't count the threads of the process, skipping");
+    return;
+  }
+
+  shared = count_webrtcbin_threads (n_bins, TRUE);
+  dedicated = count_webrtcbin_threads (n_bins, FALSE);
+  GST_INFO ("%u webrtcbins: %d threads shared, %d dedicated", n_bins,
+      shared, dedicated);
+
+  fail_unless (shared + 2 * (gint) (n_bins - n_cpus) <= dedicated,
+      "%d threads with shared-threads, %d without", shared, dedicated);
+}
+
+GST_END_TEST;
+
 static Suite *
 webrtcbin_suite (void)
 {
   Suite *s = suite_create ("webrtcbin");
   TCase *tc = tcase_create ("general");
+  TCase *tc_bench;
   GstPluginFeature *nicesrc, *nicesink, *dtlssrtpdec, *dtlssrtpenc;
   GstPluginFeature *sctpenc, *sctpdec;
   GstRegistry *registry;
@@ -2353,11 +2924,14 @@ webrtcbin_suite (void)
   sctpenc = gst_registry_lookup_feature (registry, "sctpenc");
   sctpdec = gst_registry_lookup_feature (registry, "sctpdec");
 
+  suite_add_tcase (s, tc);
   tcase_add_test (tc, test_no_nice_elements_request_pad);
   tcase_add_test (tc, test_no_nice_elements_state_change);
   if (nicesrc && nicesink && dtlssrtpenc && dtlssrtpdec) {
     tcase_add_test (tc, test_sdp_no_media);
     tcase_add_test (tc, test_session_stats);
+    tcase_add_test (tc, test_session_stats_interval);
+    tcase_add_test (tc, test_session_stats_interval_states);
     tcase_add_test (tc, test_audio);
     tcase_add_test (tc, test_audio_video);
     tcase_add_test (tc, test_media_direction);
@@ -2370,6 +2944,11 @@ webrtcbin_suite (void)
     tcase_add_test (tc, test_bundle_audio_video_max_bundle_max_bundle);
     tcase_add_test (tc, test_bundle_audio_video_max_bundle_none);
     tcase_add_test (tc, test_bundle_audio_video_max_compat_max_bundle);
+    tcase_add_test (tc, test_shared_threads);
+
+    tc_bench = benchmark_tcase_new (s, 120);
+    if (tc_bench)
+      tcase_add_test (tc_bench, test_bench_get_stats);
     if (sctpenc && sctpdec) {
       tcase_add_test (tc, test_data_channel_create);
       tcase_add_test (tc, test_data_channel_remote_notify);
@@ -2380,6 +2959,11 @@ webrtcbin_suite (void)
       tcase_add_test (tc, test_data_channel_max_message_size);
       tcase_add_test (tc, test_data_channel_pre_negotiated);
       tcase_add_test (tc, test_bundle_audio_video_data);
+
+      if (tc_bench) {
+        tcase_add_test (tc_bench, test_bench_loopback);
+        tcase_add_test (tc_bench, test_bench_shared_threads);
+      }
     } else {
       GST_WARNING ("Some required elements were not found. "
           "All datachannel are disabled. sctpenc %p, sctpdec %p", sctpenc,
@@ -2405,8 +2989,6 @@ webrtcbin_suite (void)
   if (sctpdec)
     gst_object_unref (sctpdec);
 
-  suite_add_tcase (s, tc);
-
   return s;
 }
 
@@ -0,0 +1,401 @@
+/* GStreamer unit tests for the yadif deinterlacer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#include <string.h>
+
+#include "benchmark.h"
+
+static const gchar *formats[] = {
+  "I420", "Y42B", "Y444", "YUY2", "UYVY", "NV12",
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+  "I420_10LE", "I422_10LE", "Y444_10LE", "P010_10LE",
+#else
+  "I420_10BE", "I422_10BE", "Y444_10BE", "P010_10BE",
+#endif
+};
+
+static GstHarness *
+yadif_harness_new (const gchar * format, gint width, gint height,
+    guint n_threads)
+{
+  GstHarness *h;
+  gchar *caps;
+
+  h = gst_harness_new ("yadif");
+  g_object_set (h->element, "n-threads", n_threads, NULL);
+
+  caps = g_strdup_printf ("video/x-raw,format=%s,width=%d,height=%d,"
+      "framerate=30/1,interlace-mode=interleaved", format, width, height);
+  gst_harness_set_src_caps_str (h, caps);
+  g_free (caps);
+
+  return h;
+}
+
+static GstBuffer *
+frame_new (const gchar * format, gint width, gint height, guint32 seed)
+{
+  GstVideoInfo info;
+  GstBuffer *buf;
+  GstMapInfo map;
+  GRand *rand;
+  gsize i;
+
+  gst_video_info_set_format (&info, gst_video_format_from_string (format),
+      width, height);
+  buf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  if (seed == 0) {
+    memset (map.data, 0x50, map.size);
+  } else {
+    rand = g_rand_new_with_seed (seed);
+    for (i = 0; i < map.size; i++)
+      map.data[i] = g_rand_int (rand);
+    g_rand_free (rand);
+  }
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static GstBuffer *
+deinterlace (const gchar * format, gint width, gint height, guint n_threads,
+    guint32 seed)
+{
+  GstHarness *h;
+  GstBuffer *out;
+
+  h = yadif_harness_new (format, width, height, n_threads);
+  out = gst_harness_push_and_pull (h, frame_new (format, width, height, seed));
+  fail_unless (out != NULL);
+  gst_harness_teardown (h);
+
+  return out;
+}
+
+/* A flat picture has to come out unchanged in every format */
+GST_START_TEST (test_formats)
+{
+  GstBuffer *in, *out;
+  GstMapInfo map;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    GST_DEBUG ("testing %s", formats[i]);
+
+    in = frame_new (formats[i], 64, 48, 0);
+    out = deinterlace (formats[i], 64, 48, 1, 0);
+
+    gst_buffer_map (in, &map, GST_MAP_READ);
+    fail_unless_equals_int (gst_buffer_get_size (out), map.size);
+    fail_unless (gst_buffer_memcmp (out, 0, map.data, map.size) == 0,
+        "%s output differs from the flat input", formats[i]);
+    gst_buffer_unmap (in, &map);
+
+    gst_buffer_unref (in);
+    gst_buffer_unref (out);
+  }
+}
+
+GST_END_TEST;
+
+/* Splitting the frame over threads must not change the output */
+GST_START_TEST (test_threads)
+{
+  GstBuffer *single, *threaded;
+  GstMapInfo map;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    GST_DEBUG ("testing %s", formats[i]);
+
+    single = deinterlace (formats[i], 352, 288, 1, i + 1);
+    threaded = deinterlace (formats[i], 352, 288, 4, i + 1);
+
+    gst_buffer_map (single, &map, GST_MAP_READ);
+    fail_unless_equals_int (gst_buffer_get_size (threaded), map.size);
+    fail_unless (gst_buffer_memcmp (threaded, 0, map.data, map.size) == 0,
+        "%s threaded output differs", formats[i]);
+    gst_buffer_unmap (single, &map);
+
+    gst_buffer_unref (single);
+    gst_buffer_unref (threaded);
+  }
+}
+
+GST_END_TEST;
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define FORMAT_10(f) f "_10LE"
+#else
+#define FORMAT_10(f) f "_10BE"
+#endif
+
+/* The 10 bit formats go through the C kernel and the 8 bit ones through the
+ * SIMD kernel picked for the CPU, if any */
+static const gchar *simd_formats[][2] = {
+  {"I420", FORMAT_10 ("I420")},
+  {"Y42B", FORMAT_10 ("I422")},
+  {"Y444", FORMAT_10 ("Y444")},
+};
+
+/* Room around the frames, the kernels read a few samples before the first
+ * line and after the last one */
+#define FRAME_PADDING 64
+
+/* A frame of random 8 bit samples, also in 16 bit formats, with zeroes
+ * around it */
+static GstBuffer *
+frame_new_8bit (const gchar * format, gint width, gint height, guint32 seed)
+{
+  GstVideoInfo info;
+  GstBuffer *buf;
+  GstMapInfo map;
+  GRand *rand;
+  gboolean wide;
+  gsize i, size;
+
+  gst_video_info_set_format (&info, gst_video_format_from_string (format),
+      width, height);
+  size = GST_VIDEO_INFO_SIZE (&info);
+  wide = GST_VIDEO_FORMAT_INFO_BITS (info.finfo) > 8;
+  buf = gst_buffer_new_allocate (NULL, size + 2 * FRAME_PADDING, NULL);
+
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+  rand = g_rand_new_with_seed (seed);
+  for (i = 0; i < (wide ? size / 2 : size); i++) {
+    guint8 v = g_rand_int_range (rand, 0, 256);
+
+    if (wide)
+      ((guint16 *) (map.data + FRAME_PADDING))[i] = v;
+    else
+      map.data[FRAME_PADDING + i] = v;
+  }
+  g_rand_free (rand);
+  gst_buffer_unmap (buf, &map);
+
+  gst_buffer_resize (buf, FRAME_PADDING, size);
+
+  return buf;
+}
+
+#define SIMD_N_FRAMES 3
+
+/* The SIMD kernels have to give the same result as the C one, on the same
+ * samples and with the same strides in samples */
+GST_START_TEST (test_simd_matches_c)
+{
+  GstHarness *h8, *h16;
+  GstBuffer *out8, *out16;
+  GstMapInfo map8, map16;
+  guint i, j;
+  gsize k;
+
+  for (i = 0; i < G_N_ELEMENTS (simd_formats); i++) {
+    const gchar *f8 = simd_formats[i][0], *f16 = simd_formats[i][1];
+
+    GST_DEBUG ("testing %s against %s", f8, f16);
+
+    /* the chroma lines don't end on a vector boundary either */
+    h8 = yadif_harness_new (f8, 200, 120, 1);
+    h16 = yadif_harness_new (f16, 200, 120, 1);
+
+    for (j = 0; j < SIMD_N_FRAMES; j++) {
+      out8 = gst_harness_push_and_pull (h8, frame_new_8bit (f8, 200, 120,
+              j + 1));
+      out16 = gst_harness_push_and_pull (h16, frame_new_8bit (f16, 200, 120,
+              j + 1));
+      fail_unless (out8 != NULL && out16 != NULL);
+
+      gst_buffer_map (out8, &map8, GST_MAP_READ);
+      gst_buffer_map (out16, &map16, GST_MAP_READ);
+      fail_unless_equals_int (map16.size, 2 * map8.size);
+      for (k = 0; k < map8.size; k++) {
+        if (map8.data[k] != ((guint16 *) map16.data)[k])
+          break;
+      }
+      fail_unless (k == map8.size, "%s differs from %s at sample %"
+          G_GSIZE_FORMAT " of frame %u", f8, f16, k, j);
+      gst_buffer_unmap (out16, &map16);
+      gst_buffer_unmap (out8, &map8);
+
+      gst_buffer_unref (out8);
+      gst_buffer_unref (out16);
+    }
+
+    gst_harness_teardown (h8);
+    gst_harness_teardown (h16);
+  }
+}
+
+GST_END_TEST;
+
+/* Lines shorter than a vector of the SIMD kernels, a flat picture still
+ * comes out unchanged */
+GST_START_TEST (test_tiny_frames)
+{
+  static const gint sizes[][2] = { {4, 4}, {6, 4}, {12, 8}, {14, 6} };
+  GstBuffer *in, *out;
+  GstMapInfo map;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    gint width = sizes[i][0], height = sizes[i][1];
+
+    GST_DEBUG ("testing %dx%d", width, height);
+
+    in = frame_new ("I420", width, height, 0);
+    out = deinterlace ("I420", width, height, 1, 0);
+
+    gst_buffer_map (in, &map, GST_MAP_READ);
+    fail_unless_equals_int (gst_buffer_get_size (out), map.size);
+    fail_unless (gst_buffer_memcmp (out, 0, map.data, map.size) == 0,
+        "%dx%d output differs from the flat input", width, height);
+    gst_buffer_unmap (in, &map);
+
+    gst_buffer_unref (in);
+    gst_buffer_unref (out);
+
+    /* and random content doesn't read beyond the frame */
+    gst_buffer_unref (deinterlace ("I420", width, height, 1, i + 1));
+  }
+}
+
+GST_END_TEST;
+
+/* Every input frame comes out as two frames with half the duration, the
+ * last one only after EOS */
+GST_START_TEST (test_field_rate)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstCaps *caps;
+  GstStructure *s;
+  gint fps_n, fps_d;
+  guint i;
+
+  h = gst_harness_new ("yadif");
+  g_object_set (h->element, "field-rate", TRUE, "n-threads", 2, NULL);
+  gst_harness_set_src_caps_str (h, "video/x-raw,format=I420,width=320,"
+      "height=240,framerate=25/1,interlace-mode=interleaved");
+
+  for (i = 0; i < 3; i++) {
+    buf = frame_new ("I420", 320, 240, i + 1);
+    GST_BUFFER_PTS (buf) = i * 40 * GST_MSECOND;
+    GST_BUFFER_DURATION (buf) = 40 * GST_MSECOND;
+    GST_BUFFER_FLAG_SET (buf, GST_VIDEO_BUFFER_FLAG_INTERLACED |
+        GST_VIDEO_BUFFER_FLAG_TFF);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  /* the last frame waits for its successor */
+  fail_unless_equals_int (gst_harness_buffers_received (h), 4);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_received (h), 6);
+
+  for (i = 0; i < 6; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), i * 20 * GST_MSECOND);
+    fail_unless_equals_uint64 (GST_BUFFER_DURATION (buf), 20 * GST_MSECOND);
+    fail_if (GST_BUFFER_FLAG_IS_SET (buf, GST_VIDEO_BUFFER_FLAG_INTERLACED));
+    gst_buffer_unref (buf);
+  }
+
+  caps = gst_pad_get_current_caps (h->sinkpad);
+  s = gst_caps_get_structure (caps, 0);
+  fail_unless (gst_structure_get_fraction (s, "framerate", &fps_n, &fps_d));
+  fail_unless_equals_int (fps_n, 50);
+  fail_unless_equals_int (fps_d, 1);
+  gst_caps_unref (caps);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define BENCH_N_FRAMES 100
+
+static void
+bench_deinterlace (const gchar * format, guint n_threads)
+{
+  GstHarness *h;
+  GstBuffer *in, *out;
+  gint64 start, end;
+  guint i;
+
+  h = yadif_harness_new (format, 1920, 1080, n_threads);
+  in = frame_new (format, 1920, 1080, 42);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCH_N_FRAMES; i++) {
+    out = gst_harness_push_and_pull (h, gst_buffer_ref (in));
+    fail_unless (out != NULL);
+    gst_buffer_unref (out);
+  }
+  end = g_get_monotonic_time ();
+
+  GST_INFO ("%s 1080i, %u threads: %.2f ms/frame", format, n_threads,
+      (end - start) / 1000.0 / BENCH_N_FRAMES);
+
+  gst_buffer_unref (in);
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_bench_deinterlace)
+{
+  bench_deinterlace ("I420", 1);
+  bench_deinterlace ("I420", 0);
+  bench_deinterlace ("YUY2", 1);
+  bench_deinterlace ("YUY2", 0);
+  bench_deinterlace (formats[G_N_ELEMENTS (formats) - 4], 1);
+  bench_deinterlace (formats[G_N_ELEMENTS (formats) - 4], 0);
+}
+
+GST_END_TEST;
+
+static Suite *
+yadif_suite (void)
+{
+  Suite *s = suite_create ("yadif");
+  TCase *tc_chain = tcase_create ("general");
+  TCase *tc_bench;
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_formats);
+  tcase_add_test (tc_chain, test_threads);
+  tcase_add_test (tc_chain, test_simd_matches_c);
+  tcase_add_test (tc_chain, test_tiny_frames);
+  tcase_add_test (tc_chain, test_field_rate);
+
+  if ((tc_bench = benchmark_tcase_new (s, 120)))
+    tcase_add_test (tc_bench, test_bench_deinterlace);
+
+  return s;
+}
+
+GST_CHECK_MAIN (yadif);
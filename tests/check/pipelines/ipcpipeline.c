@@ -64,6 +64,7 @@ typedef enum
   TEST_FEATURE_SPLIT_SINKS = 0x1,       /* separate audio and video sink processes */
   TEST_FEATURE_RECOVERY_SLAVE_PROCESS = 0x2,
   TEST_FEATURE_RECOVERY_MASTER_PROCESS = 0x4,
+  TEST_FEATURE_SOCKETS = 0x8,   /* unix sockets instead of pipes, to pass fds */
 
   TEST_FEATURE_HAS_VIDEO = 0x10,
   TEST_FEATURE_LIVE = 0x20,     /* sets is-live=true in {audio,video}testsrc */
@@ -736,6 +737,18 @@ stop_listening_for_unwind (void)
   sigaction (SIGUSR1, &sa, NULL);
 }
 
+static int
+nonblocking_socketpair (int fds[2])
+{
+  int ret = socketpair (PF_UNIX, SOCK_STREAM, 0, fds);
+  if (ret < 0)
+    return ret;
+  ret = fcntl (fds[0], F_SETFL, O_NONBLOCK);
+  if (ret < 0)
+    return ret;
+  return fcntl (fds[1], F_SETFL, O_NONBLOCK);
+}
+
 #define TEST_BASE(...) test_base(__FUNCTION__,##__VA_ARGS__)
 
 /*
@@ -791,10 +804,17 @@ test_base (const char *name, TestFeatures features,
 
   weak_refs = NULL;
 
-  FAIL_IF (pipe2 (pipesfa, O_NONBLOCK) < 0);
-  FAIL_IF (pipe2 (pipesba, O_NONBLOCK) < 0);
-  FAIL_IF (pipe2 (pipesfv, O_NONBLOCK) < 0);
-  FAIL_IF (pipe2 (pipesbv, O_NONBLOCK) < 0);
+  if (features & TEST_FEATURE_SOCKETS) {
+    FAIL_IF (nonblocking_socketpair (pipesfa) < 0);
+    FAIL_IF (nonblocking_socketpair (pipesba) < 0);
+    FAIL_IF (nonblocking_socketpair (pipesfv) < 0);
+    FAIL_IF (nonblocking_socketpair (pipesbv) < 0);
+  } else {
+    FAIL_IF (pipe2 (pipesfa, O_NONBLOCK) < 0);
+    FAIL_IF (pipe2 (pipesba, O_NONBLOCK) < 0);
+    FAIL_IF (pipe2 (pipesfv, O_NONBLOCK) < 0);
+    FAIL_IF (pipe2 (pipesbv, O_NONBLOCK) < 0);
+  }
   FAIL_IF (socketpair (PF_UNIX, SOCK_STREAM, 0, ctlsock) < 0);
 
   FAIL_IF (pipesfa[0] < 0);
@@ -2189,6 +2209,442 @@ GST_START_TEST (test_live_av_2_upstream_query)
 
 GST_END_TEST;
 
+/**** query cache test ****/
+
+typedef struct
+{
+  gboolean got_state_changed_to_playing;
+  gboolean got_same_caps;
+  guint64 cache_hits;
+  guint64 buffer_rtt_count;
+  guint64 buffer_rtt_histogram_total;
+} query_cache_master_data;
+
+static gboolean
+send_cached_queries (gpointer user_data)
+{
+  test_data *td = user_data;
+  query_cache_master_data *d = td->md;
+  GstElement *ipcpipelinesink;
+  GstStructure *stats;
+  const GValue *histogram;
+  GstCaps *caps1, *caps2;
+  GstPad *pad;
+  guint n;
+
+  ipcpipelinesink = gst_bin_get_by_name (GST_BIN (td->p), "aipcpipelinesink");
+  FAIL_UNLESS (ipcpipelinesink);
+  pad = gst_element_get_static_pad (ipcpipelinesink, "sink");
+  FAIL_UNLESS (pad);
+
+  /* the second one is answered without asking the slave */
+  caps1 = gst_pad_query_caps (pad, NULL);
+  caps2 = gst_pad_query_caps (pad, NULL);
+  d->got_same_caps = gst_caps_is_equal (caps1, caps2);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+  gst_object_unref (pad);
+
+  g_object_get (ipcpipelinesink, "stats", &stats, NULL);
+  FAIL_UNLESS (stats);
+  FAIL_UNLESS (gst_structure_get_uint64 (stats, "query-cache-hits",
+          &d->cache_hits));
+  FAIL_UNLESS (gst_structure_get_uint64 (stats, "buffer-rtt-count",
+          &d->buffer_rtt_count));
+  histogram = gst_structure_get_value (stats, "buffer-rtt-histogram");
+  FAIL_UNLESS (histogram);
+  for (n = 0; n < gst_value_array_get_size (histogram); n++)
+    d->buffer_rtt_histogram_total +=
+        g_value_get_uint64 (gst_value_array_get_value (histogram, n));
+  gst_structure_free (stats);
+  gst_object_unref (ipcpipelinesink);
+
+  g_timeout_add (STEP_AT, (GSourceFunc) stop_pipeline, td->p);
+  return FALSE;
+}
+
+static void
+query_cache_on_state_changed (gpointer user_data)
+{
+  test_data *td = user_data;
+  query_cache_master_data *d = td->md;
+
+  if (!d->got_state_changed_to_playing) {
+    d->got_state_changed_to_playing = TRUE;
+    gst_object_ref (td->p);
+    g_timeout_add (QUERY_AT, (GSourceFunc) send_cached_queries, td);
+  }
+}
+
+static void
+query_cache_source (GstElement * source, gpointer user_data)
+{
+  test_data *td = user_data;
+  GstElement *ipcpipelinesink;
+  GstStateChangeReturn ret;
+
+  ipcpipelinesink = gst_bin_get_by_name (GST_BIN (source), "aipcpipelinesink");
+  FAIL_UNLESS (ipcpipelinesink);
+  g_object_set (ipcpipelinesink, "cache-queries", TRUE, "buffer-window", 4,
+      NULL);
+  gst_object_unref (ipcpipelinesink);
+
+  td->state_changed_cb = query_cache_on_state_changed;
+  td->state_target = GST_STATE_PLAYING;
+  ret = gst_element_set_state (source, GST_STATE_PLAYING);
+  FAIL_UNLESS (ret == GST_STATE_CHANGE_ASYNC);
+}
+
+static void
+check_success_source_query_cache (gpointer user_data)
+{
+  test_data *td = user_data;
+  query_cache_master_data *d = td->md;
+
+  FAIL_UNLESS (d->got_state_changed_to_playing);
+  FAIL_UNLESS (d->got_same_caps);
+  FAIL_UNLESS (d->cache_hits >= 1);
+  FAIL_UNLESS (d->buffer_rtt_count > 0);
+  FAIL_UNLESS (d->buffer_rtt_histogram_total == d->buffer_rtt_count);
+}
+
+GST_START_TEST (test_empty_query_cache)
+{
+  query_cache_master_data md = { 0 };
+
+  TEST_BASE (TEST_FEATURE_TEST_SOURCE, query_cache_source, NULL,
+      check_success_source_query_cache, NULL, NULL, &md, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_live_a_query_cache)
+{
+  query_cache_master_data md = { 0 };
+
+  TEST_BASE (TEST_FEATURE_LIVE_A_SOURCE, query_cache_source, NULL,
+      check_success_source_query_cache, NULL, NULL, &md, NULL);
+}
+
+GST_END_TEST;
+
+/**** memfd test ****/
+
+typedef struct
+{
+  gboolean got_state_changed_to_playing;
+  guint64 buffer_rtt_count;
+} memfd_master_data;
+
+typedef struct
+{
+  guint n_buffers;
+  guint n_fd_buffers;
+} memfd_slave_data;
+
+static gboolean
+memfd_stop (gpointer user_data)
+{
+  test_data *td = user_data;
+  memfd_master_data *d = td->md;
+  GstElement *ipcpipelinesink;
+  GstStructure *stats;
+
+  ipcpipelinesink = gst_bin_get_by_name (GST_BIN (td->p), "aipcpipelinesink");
+  FAIL_UNLESS (ipcpipelinesink);
+  g_object_get (ipcpipelinesink, "stats", &stats, NULL);
+  FAIL_UNLESS (stats);
+  FAIL_UNLESS (gst_structure_get_uint64 (stats, "buffer-rtt-count",
+          &d->buffer_rtt_count));
+  gst_structure_free (stats);
+  gst_object_unref (ipcpipelinesink);
+
+  return stop_pipeline (td->p);
+}
+
+static void
+memfd_on_state_changed (gpointer user_data)
+{
+  test_data *td = user_data;
+  memfd_master_data *d = td->md;
+
+  if (!d->got_state_changed_to_playing) {
+    d->got_state_changed_to_playing = TRUE;
+    gst_object_ref (td->p);
+    g_timeout_add (STOP_AT, (GSourceFunc) memfd_stop, td);
+  }
+}
+
+static void
+memfd_source (GstElement * source, gpointer user_data)
+{
+  test_data *td = user_data;
+  GstElement *ipcpipelinesink;
+  GstStateChangeReturn ret;
+  gboolean use_memfd;
+
+  ipcpipelinesink = gst_bin_get_by_name (GST_BIN (source), "aipcpipelinesink");
+  FAIL_UNLESS (ipcpipelinesink);
+  g_object_set (ipcpipelinesink, "use-memfd", TRUE, "buffer-window", 4, NULL);
+  g_object_get (ipcpipelinesink, "use-memfd", &use_memfd, NULL);
+  FAIL_UNLESS (use_memfd);
+  gst_object_unref (ipcpipelinesink);
+
+  td->state_changed_cb = memfd_on_state_changed;
+  td->state_target = GST_STATE_PLAYING;
+  ret = gst_element_set_state (source, GST_STATE_PLAYING);
+  FAIL_UNLESS (ret == GST_STATE_CHANGE_ASYNC);
+}
+
+static GstPadProbeReturn
+memfd_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  test_data *td = user_data;
+  memfd_slave_data *d = td->sd;
+  GstBuffer *buffer;
+  GstMemory *mem;
+
+  if (GST_IS_BUFFER (info->data)) {
+    buffer = GST_BUFFER (info->data);
+    d->n_buffers++;
+    if (gst_buffer_n_memory (buffer) == 1) {
+      mem = gst_buffer_peek_memory (buffer, 0);
+      /* the pages are shared with the sender and must not be written to */
+      if (gst_memory_is_type (mem, "fd") && GST_MEMORY_IS_READONLY (mem))
+        d->n_fd_buffers++;
+    }
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+hook_memfd_probe (const GValue * v, gpointer user_data)
+{
+  hook_probe (v, memfd_probe, user_data);
+}
+
+static void
+setup_sink_memfd (GstElement * sink, void *user_data)
+{
+  GstIterator *it;
+
+  it = gst_bin_iterate_sinks (GST_BIN (sink));
+  while (gst_iterator_foreach (it, hook_memfd_probe, user_data))
+    gst_iterator_resync (it);
+  gst_iterator_free (it);
+}
+
+static void
+check_success_source_memfd (gpointer user_data)
+{
+  test_data *td = user_data;
+  memfd_master_data *d = td->md;
+
+  FAIL_UNLESS (d->got_state_changed_to_playing);
+  FAIL_UNLESS (d->buffer_rtt_count > 0);
+}
+
+static void
+check_success_sink_memfd (gpointer user_data)
+{
+  test_data *td = user_data;
+  memfd_slave_data *d = td->sd;
+
+  /* every buffer came as a passed fd, none was copied over the socket */
+  FAIL_UNLESS (d->n_buffers > 0);
+  FAIL_UNLESS_EQUALS_INT (d->n_fd_buffers, d->n_buffers);
+}
+
+GST_START_TEST (test_empty_memfd)
+{
+  memfd_master_data md = { 0 };
+  memfd_slave_data sd = { 0 };
+
+  TEST_BASE (TEST_FEATURE_TEST_SOURCE | TEST_FEATURE_SOCKETS, memfd_source,
+      setup_sink_memfd, check_success_source_memfd, check_success_sink_memfd,
+      NULL, &md, &sd);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_live_a_memfd)
+{
+  memfd_master_data md = { 0 };
+  memfd_slave_data sd = { 0 };
+
+  TEST_BASE (TEST_FEATURE_LIVE_A_SOURCE | TEST_FEATURE_SOCKETS, memfd_source,
+      setup_sink_memfd, check_success_source_memfd, check_success_sink_memfd,
+      NULL, &md, &sd);
+}
+
+GST_END_TEST;
+
+/**** buffer window test ****/
+
+typedef struct
+{
+  gboolean got_state_changed_to_playing;
+  guint64 buffer_rtt_count[2];
+} buffer_window_master_data;
+
+typedef struct
+{
+  guint n_buffers;
+} buffer_window_slave_data;
+
+static guint64
+get_buffer_rtt_count (GstElement * ipcpipelinesink)
+{
+  GstStructure *stats;
+  guint64 count;
+
+  g_object_get (ipcpipelinesink, "stats", &stats, NULL);
+  FAIL_UNLESS (stats);
+  FAIL_UNLESS (gst_structure_get_uint64 (stats, "buffer-rtt-count", &count));
+  gst_structure_free (stats);
+
+  return count;
+}
+
+static gboolean
+buffer_window_stop (gpointer user_data)
+{
+  test_data *td = user_data;
+  buffer_window_master_data *d = td->md;
+  GstElement *ipcpipelinesink;
+
+  ipcpipelinesink = gst_bin_get_by_name (GST_BIN (td->p), "aipcpipelinesink");
+  FAIL_UNLESS (ipcpipelinesink);
+  d->buffer_rtt_count[1] = get_buffer_rtt_count (ipcpipelinesink);
+  gst_object_unref (ipcpipelinesink);
+
+  return stop_pipeline (td->p);
+}
+
+static gboolean
+buffer_window_close (gpointer user_data)
+{
+  test_data *td = user_data;
+  buffer_window_master_data *d = td->md;
+  GstElement *ipcpipelinesink;
+
+  /* the acks still pending from the window must be collected by the
+   * following buffers and events, and buffers keep flowing */
+  ipcpipelinesink = gst_bin_get_by_name (GST_BIN (td->p), "aipcpipelinesink");
+  FAIL_UNLESS (ipcpipelinesink);
+  g_object_set (ipcpipelinesink, "buffer-window", 0, NULL);
+  d->buffer_rtt_count[0] = get_buffer_rtt_count (ipcpipelinesink);
+  gst_object_unref (ipcpipelinesink);
+
+  g_timeout_add (STOP_AT, (GSourceFunc) buffer_window_stop, td);
+  return FALSE;
+}
+
+static void
+buffer_window_on_state_changed (gpointer user_data)
+{
+  test_data *td = user_data;
+  buffer_window_master_data *d = td->md;
+
+  if (!d->got_state_changed_to_playing) {
+    d->got_state_changed_to_playing = TRUE;
+    gst_object_ref (td->p);
+    g_timeout_add (STOP_AT, (GSourceFunc) buffer_window_close, td);
+  }
+}
+
+static void
+buffer_window_source (GstElement * source, gpointer user_data)
+{
+  test_data *td = user_data;
+  GstElement *ipcpipelinesink;
+  GstStateChangeReturn ret;
+
+  ipcpipelinesink = gst_bin_get_by_name (GST_BIN (source), "aipcpipelinesink");
+  FAIL_UNLESS (ipcpipelinesink);
+  g_object_set (ipcpipelinesink, "buffer-window", 8, NULL);
+  gst_object_unref (ipcpipelinesink);
+
+  td->state_changed_cb = buffer_window_on_state_changed;
+  td->state_target = GST_STATE_PLAYING;
+  ret = gst_element_set_state (source, GST_STATE_PLAYING);
+  FAIL_UNLESS (ret == GST_STATE_CHANGE_ASYNC);
+}
+
+static GstPadProbeReturn
+buffer_window_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  test_data *td = user_data;
+  buffer_window_slave_data *d = td->sd;
+
+  if (GST_IS_BUFFER (info->data))
+    d->n_buffers++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+hook_buffer_window_probe (const GValue * v, gpointer user_data)
+{
+  hook_probe (v, buffer_window_probe, user_data);
+}
+
+static void
+setup_sink_buffer_window (GstElement * sink, void *user_data)
+{
+  GstIterator *it;
+
+  it = gst_bin_iterate_sinks (GST_BIN (sink));
+  while (gst_iterator_foreach (it, hook_buffer_window_probe, user_data))
+    gst_iterator_resync (it);
+  gst_iterator_free (it);
+}
+
+static void
+check_success_source_buffer_window (gpointer user_data)
+{
+  test_data *td = user_data;
+  buffer_window_master_data *d = td->md;
+
+  FAIL_UNLESS (d->got_state_changed_to_playing);
+  FAIL_UNLESS (d->buffer_rtt_count[0] > 0);
+  FAIL_UNLESS (d->buffer_rtt_count[1] > d->buffer_rtt_count[0]);
+}
+
+static void
+check_success_sink_buffer_window (gpointer user_data)
+{
+  test_data *td = user_data;
+  buffer_window_slave_data *d = td->sd;
+
+  FAIL_UNLESS (d->n_buffers > 0);
+}
+
+GST_START_TEST (test_empty_buffer_window)
+{
+  buffer_window_master_data md = { 0 };
+  buffer_window_slave_data sd = { 0 };
+
+  TEST_BASE (TEST_FEATURE_TEST_SOURCE, buffer_window_source,
+      setup_sink_buffer_window, check_success_source_buffer_window,
+      check_success_sink_buffer_window, NULL, &md, &sd);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_live_a_buffer_window)
+{
+  buffer_window_master_data md = { 0 };
+  buffer_window_slave_data sd = { 0 };
+
+  TEST_BASE (TEST_FEATURE_LIVE_A_SOURCE, buffer_window_source,
+      setup_sink_buffer_window, check_success_source_buffer_window,
+      check_success_sink_buffer_window, NULL, &md, &sd);
+}
+
+GST_END_TEST;
+
 /**** message test ****/
 
 typedef struct
@@ -5891,6 +6347,30 @@ ipcpipeline_suite (void)
     tcase_add_test (tc_chain, test_live_av_2_upstream_query);
   }
 
+  /* query_cache tests enable the query cache and the buffer window on
+     ipcpipelinesink, send the same caps query twice and check the second
+     one was answered from the cache, and that round trips were counted. */
+  if (1) {
+    tcase_add_test (tc_chain, test_empty_query_cache);
+    tcase_add_test (tc_chain, test_live_a_query_cache);
+  }
+
+  /* memfd tests pass buffers as memfd over unix sockets, with a buffer
+     window, and check that the slave only got fd backed buffers. */
+#ifdef HAVE_MEMFD_CREATE
+  if (1) {
+    tcase_add_test (tc_chain, test_empty_memfd);
+    tcase_add_test (tc_chain, test_live_a_memfd);
+  }
+#endif
+
+  /* buffer_window tests close the buffer window while buffers are in
+     flight, and check that buffers keep flowing and the pipeline stops. */
+  if (1) {
+    tcase_add_test (tc_chain, test_empty_buffer_window);
+    tcase_add_test (tc_chain, test_live_a_buffer_window);
+  }
+
   /* message tests send a sink message downstream, which causes
      the sinks to reply with the embedded event, which is checked.
      This is not possible when elements go into pull mode. */